@@ -9,6 +9,7 @@ protobuf_test_support = [
     "quic/test_tools/send_algorithm_test_result.proto",
 ]
 quiche_core_hdrs = [
+    "balsa/balsa_buffer_block_pool.h",
     "balsa/balsa_enums.h",
     "balsa/balsa_frame.h",
     "balsa/balsa_headers.h",
@@ -107,6 +108,7 @@ quiche_core_hdrs = [
     "http2/hpack/http2_hpack_constants.h",
     "http2/hpack/huffman/hpack_huffman_decoder.h",
     "http2/hpack/huffman/hpack_huffman_encoder.h",
+    "http2/hpack/huffman/hpack_huffman_literal_cache.h",
     "http2/hpack/huffman/huffman_spec_tables.h",
     "http2/hpack/varint/hpack_varint_decoder.h",
     "http2/hpack/varint/hpack_varint_encoder.h",
@@ -126,12 +128,15 @@ quiche_core_hdrs = [
     "quic/core/congestion_control/hybrid_slow_start.h",
     "quic/core/congestion_control/loss_detection_interface.h",
     "quic/core/congestion_control/pacing_sender.h",
+    "quic/core/congestion_control/pcc_sender.h",
     "quic/core/congestion_control/prr_sender.h",
     "quic/core/congestion_control/rtt_stats.h",
     "quic/core/congestion_control/send_algorithm_interface.h",
     "quic/core/congestion_control/tcp_cubic_sender_bytes.h",
     "quic/core/congestion_control/uber_loss_algorithm.h",
     "quic/core/congestion_control/windowed_filter.h",
+    "quic/core/connection_id_generator.h",
+    "quic/core/crypto/address_token_crypter.h",
     "quic/core/crypto/aead_base_decrypter.h",
     "quic/core/crypto/aead_base_encrypter.h",
     "quic/core/crypto/aes_128_gcm_12_decrypter.h",
@@ -179,11 +184,15 @@ quiche_core_hdrs = [
     "quic/core/crypto/quic_encrypter.h",
     "quic/core/crypto/quic_hkdf.h",
     "quic/core/crypto/quic_random.h",
+    "quic/core/crypto/sharded_quic_client_session_cache.h",
+    "quic/core/crypto/tls_cert_compression.h",
     "quic/core/crypto/tls_client_connection.h",
+    "quic/core/crypto/tls_client_hello_parser.h",
     "quic/core/crypto/tls_connection.h",
     "quic/core/crypto/tls_server_connection.h",
     "quic/core/crypto/transport_parameters.h",
     "quic/core/crypto/web_transport_fingerprint_proof_verifier.h",
+    "quic/core/crypto/zero_rtt_replay_filter.h",
     "quic/core/frames/quic_ack_frame.h",
     "quic/core/frames/quic_ack_frequency_frame.h",
     "quic/core/frames/quic_blocked_frame.h",
@@ -245,6 +254,7 @@ quiche_core_hdrs = [
     "quic/core/qpack/qpack_decoder_stream_receiver.h",
     "quic/core/qpack/qpack_decoder_stream_sender.h",
     "quic/core/qpack/qpack_encoder.h",
+    "quic/core/qpack/qpack_encoder_strategy.h",
     "quic/core/qpack/qpack_encoder_stream_receiver.h",
     "quic/core/qpack/qpack_encoder_stream_sender.h",
     "quic/core/qpack/qpack_header_table.h",
@@ -265,6 +275,7 @@ quiche_core_hdrs = [
     "quic/core/quic_alarm_factory.h",
     "quic/core/quic_arena_scoped_ptr.h",
     "quic/core/quic_bandwidth.h",
+    "quic/core/quic_binary_trace_visitor.h",
     "quic/core/quic_blocked_writer_interface.h",
     "quic/core/quic_buffered_packet_store.h",
     "quic/core/quic_chaos_protector.h",
@@ -278,6 +289,7 @@ quiche_core_hdrs = [
     "quic/core/quic_connection_stats.h",
     "quic/core/quic_constants.h",
     "quic/core/quic_control_frame_manager.h",
+    "quic/core/quic_cpu_profiler.h",
     "quic/core/quic_crypto_client_handshaker.h",
     "quic/core/quic_crypto_client_stream.h",
     "quic/core/quic_crypto_handshaker.h",
@@ -306,11 +318,13 @@ quiche_core_hdrs = [
     "quic/core/quic_packet_writer.h",
     "quic/core/quic_packet_writer_wrapper.h",
     "quic/core/quic_packets.h",
+    "quic/core/quic_path_scheduler.h",
     "quic/core/quic_path_validator.h",
     "quic/core/quic_ping_manager.h",
     "quic/core/quic_process_packet_interface.h",
     "quic/core/quic_protocol_flags_list.h",
     "quic/core/quic_received_packet_manager.h",
+    "quic/core/quic_retry_policy.h",
     "quic/core/quic_sent_packet_manager.h",
     "quic/core/quic_server_id.h",
     "quic/core/quic_session.h",
@@ -366,6 +380,7 @@ quiche_core_hdrs = [
     "spdy/core/hpack/hpack_encoder.h",
     "spdy/core/hpack/hpack_entry.h",
     "spdy/core/hpack/hpack_header_table.h",
+    "spdy/core/hpack/hpack_indexing_policy.h",
     "spdy/core/hpack/hpack_output_stream.h",
     "spdy/core/hpack/hpack_static_table.h",
     "spdy/core/http2_frame_decoder_adapter.h",
@@ -389,6 +404,7 @@ quiche_core_hdrs = [
     "spdy/core/zero_copy_output_buffer.h",
 ]
 quiche_core_srcs = [
+    "balsa/balsa_buffer_block_pool.cc",
     "balsa/balsa_enums.cc",
     "balsa/balsa_frame.cc",
     "balsa/balsa_headers.cc",
@@ -452,6 +468,7 @@ quiche_core_srcs = [
     "http2/hpack/http2_hpack_constants.cc",
     "http2/hpack/huffman/hpack_huffman_decoder.cc",
     "http2/hpack/huffman/hpack_huffman_encoder.cc",
+    "http2/hpack/huffman/hpack_huffman_literal_cache.cc",
     "http2/hpack/huffman/huffman_spec_tables.cc",
     "http2/hpack/varint/hpack_varint_decoder.cc",
     "http2/hpack/varint/hpack_varint_encoder.cc",
@@ -470,11 +487,13 @@ quiche_core_srcs = [
     "quic/core/congestion_control/general_loss_algorithm.cc",
     "quic/core/congestion_control/hybrid_slow_start.cc",
     "quic/core/congestion_control/pacing_sender.cc",
+    "quic/core/congestion_control/pcc_sender.cc",
     "quic/core/congestion_control/prr_sender.cc",
     "quic/core/congestion_control/rtt_stats.cc",
     "quic/core/congestion_control/send_algorithm_interface.cc",
     "quic/core/congestion_control/tcp_cubic_sender_bytes.cc",
     "quic/core/congestion_control/uber_loss_algorithm.cc",
+    "quic/core/crypto/address_token_crypter.cc",
     "quic/core/crypto/aead_base_decrypter.cc",
     "quic/core/crypto/aead_base_encrypter.cc",
     "quic/core/crypto/aes_128_gcm_12_decrypter.cc",
@@ -518,11 +537,15 @@ quiche_core_srcs = [
     "quic/core/crypto/quic_encrypter.cc",
     "quic/core/crypto/quic_hkdf.cc",
     "quic/core/crypto/quic_random.cc",
+    "quic/core/crypto/sharded_quic_client_session_cache.cc",
+    "quic/core/crypto/tls_cert_compression.cc",
     "quic/core/crypto/tls_client_connection.cc",
+    "quic/core/crypto/tls_client_hello_parser.cc",
     "quic/core/crypto/tls_connection.cc",
     "quic/core/crypto/tls_server_connection.cc",
     "quic/core/crypto/transport_parameters.cc",
     "quic/core/crypto/web_transport_fingerprint_proof_verifier.cc",
+    "quic/core/crypto/zero_rtt_replay_filter.cc",
     "quic/core/frames/quic_ack_frame.cc",
     "quic/core/frames/quic_ack_frequency_frame.cc",
     "quic/core/frames/quic_blocked_frame.cc",
@@ -576,6 +599,7 @@ quiche_core_srcs = [
     "quic/core/qpack/qpack_decoder_stream_receiver.cc",
     "quic/core/qpack/qpack_decoder_stream_sender.cc",
     "quic/core/qpack/qpack_encoder.cc",
+    "quic/core/qpack/qpack_encoder_strategy.cc",
     "quic/core/qpack/qpack_encoder_stream_receiver.cc",
     "quic/core/qpack/qpack_encoder_stream_sender.cc",
     "quic/core/qpack/qpack_header_table.cc",
@@ -592,6 +616,7 @@ quiche_core_srcs = [
     "quic/core/quic_ack_listener_interface.cc",
     "quic/core/quic_alarm.cc",
     "quic/core/quic_bandwidth.cc",
+    "quic/core/quic_binary_trace_visitor.cc",
     "quic/core/quic_buffered_packet_store.cc",
     "quic/core/quic_chaos_protector.cc",
     "quic/core/quic_clock.cc",
@@ -604,6 +629,7 @@ quiche_core_srcs = [
     "quic/core/quic_connection_stats.cc",
     "quic/core/quic_constants.cc",
     "quic/core/quic_control_frame_manager.cc",
+    "quic/core/quic_cpu_profiler.cc",
     "quic/core/quic_crypto_client_handshaker.cc",
     "quic/core/quic_crypto_client_stream.cc",
     "quic/core/quic_crypto_handshaker.cc",
@@ -625,9 +651,11 @@ quiche_core_srcs = [
     "quic/core/quic_packet_number.cc",
     "quic/core/quic_packet_writer_wrapper.cc",
     "quic/core/quic_packets.cc",
+    "quic/core/quic_path_scheduler.cc",
     "quic/core/quic_path_validator.cc",
     "quic/core/quic_ping_manager.cc",
     "quic/core/quic_received_packet_manager.cc",
+    "quic/core/quic_retry_policy.cc",
     "quic/core/quic_sent_packet_manager.cc",
     "quic/core/quic_server_id.cc",
     "quic/core/quic_session.cc",
@@ -663,6 +691,7 @@ quiche_core_srcs = [
     "spdy/core/hpack/hpack_encoder.cc",
     "spdy/core/hpack/hpack_entry.cc",
     "spdy/core/hpack/hpack_header_table.cc",
+    "spdy/core/hpack/hpack_indexing_policy.cc",
     "spdy/core/hpack/hpack_output_stream.cc",
     "spdy/core/hpack/hpack_static_table.cc",
     "spdy/core/http2_frame_decoder_adapter.cc",
@@ -686,6 +715,7 @@ quiche_tool_support_hdrs = [
     "common/platform/api/quiche_system_event_loop.h",
     "quic/platform/api/quic_default_proof_providers.h",
     "quic/tools/fake_proof_verifier.h",
+    "quic/tools/persistent_session_cache.h",
     "quic/tools/quic_backend_response.h",
     "quic/tools/quic_client_base.h",
     "quic/tools/quic_memory_cache_backend.h",
@@ -700,11 +730,13 @@ quiche_tool_support_hdrs = [
     "quic/tools/quic_spdy_server_base.h",
     "quic/tools/quic_tcp_like_trace_converter.h",
     "quic/tools/quic_url.h",
+    "quic/tools/shared_memory_ticket_crypter.h",
     "quic/tools/simple_ticket_crypter.h",
     "quic/tools/web_transport_test_visitors.h",
 ]
 quiche_tool_support_srcs = [
     "common/platform/api/quiche_file_utils.cc",
+    "quic/tools/persistent_session_cache.cc",
     "quic/tools/quic_backend_response.cc",
     "quic/tools/quic_client_base.cc",
     "quic/tools/quic_memory_cache_backend.cc",
@@ -717,6 +749,7 @@ quiche_tool_support_srcs = [
     "quic/tools/quic_spdy_client_base.cc",
     "quic/tools/quic_tcp_like_trace_converter.cc",
     "quic/tools/quic_url.cc",
+    "quic/tools/shared_memory_ticket_crypter.cc",
     "quic/tools/simple_ticket_crypter.cc",
 ]
 quiche_test_support_hdrs = [
@@ -760,6 +793,7 @@ quiche_test_support_hdrs = [
     "quic/test_tools/first_flight.h",
     "quic/test_tools/limited_mtu_test_writer.h",
     "quic/test_tools/mock_clock.h",
+    "quic/test_tools/mock_connection_id_generator.h",
     "quic/test_tools/mock_quic_client_promised_info.h",
     "quic/test_tools/mock_quic_dispatcher.h",
     "quic/test_tools/mock_quic_session_visitor.h",
@@ -816,11 +850,13 @@ quiche_test_support_hdrs = [
     "quic/test_tools/simulator/queue.h",
     "quic/test_tools/simulator/quic_endpoint.h",
     "quic/test_tools/simulator/quic_endpoint_base.h",
+    "quic/test_tools/simulator/simulation_sweep.h",
     "quic/test_tools/simulator/simulator.h",
     "quic/test_tools/simulator/switch.h",
     "quic/test_tools/simulator/traffic_policer.h",
     "quic/test_tools/test_certificates.h",
     "quic/test_tools/test_ticket_crypter.h",
+    "quic/test_tools/test_tls_session.h",
     "quic/test_tools/web_transport_resets_backend.h",
     "quic/test_tools/web_transport_test_tools.h",
     "spdy/test_tools/mock_spdy_framer_visitor.h",
@@ -910,11 +946,13 @@ quiche_test_support_srcs = [
     "quic/test_tools/simulator/queue.cc",
     "quic/test_tools/simulator/quic_endpoint.cc",
     "quic/test_tools/simulator/quic_endpoint_base.cc",
+    "quic/test_tools/simulator/simulation_sweep.cc",
     "quic/test_tools/simulator/simulator.cc",
     "quic/test_tools/simulator/switch.cc",
     "quic/test_tools/simulator/traffic_policer.cc",
     "quic/test_tools/test_certificates.cc",
     "quic/test_tools/test_ticket_crypter.cc",
+    "quic/test_tools/test_tls_session.cc",
     "quic/test_tools/web_transport_resets_backend.cc",
     "spdy/test_tools/mock_spdy_framer_visitor.cc",
     "spdy/test_tools/spdy_test_utils.cc",
@@ -954,6 +992,7 @@ epoll_tool_support_hdrs = [
     "quic/platform/api/quic_udp_socket_platform_api.h",
     "quic/tools/quic_client.h",
     "quic/tools/quic_client_epoll_network_helper.h",
+    "quic/tools/quic_lb_forwarder.h",
     "quic/tools/quic_server.h",
 ]
 epoll_tool_support_srcs = [
@@ -982,6 +1021,7 @@ epoll_tool_support_srcs = [
     "quic/masque/masque_utils.cc",
     "quic/tools/quic_client.cc",
     "quic/tools/quic_client_epoll_network_helper.cc",
+    "quic/tools/quic_lb_forwarder.cc",
     "quic/tools/quic_server.cc",
 ]
 epoll_test_support_hdrs = [
@@ -1010,6 +1050,7 @@ quiche_tests_hdrs = [
 
 ]
 quiche_tests_srcs = [
+    "balsa/balsa_buffer_block_pool_test.cc",
     "balsa/balsa_frame_test.cc",
     "balsa/balsa_headers_test.cc",
     "balsa/header_properties_test.cc",
@@ -1075,6 +1116,7 @@ quiche_tests_srcs = [
     "http2/hpack/http2_hpack_constants_test.cc",
     "http2/hpack/huffman/hpack_huffman_decoder_test.cc",
     "http2/hpack/huffman/hpack_huffman_encoder_test.cc",
+    "http2/hpack/huffman/hpack_huffman_literal_cache_test.cc",
     "http2/hpack/huffman/hpack_huffman_transcoder_test.cc",
     "http2/hpack/varint/hpack_varint_decoder_test.cc",
     "http2/hpack/varint/hpack_varint_encoder_test.cc",
@@ -1093,12 +1135,14 @@ quiche_tests_srcs = [
     "quic/core/congestion_control/general_loss_algorithm_test.cc",
     "quic/core/congestion_control/hybrid_slow_start_test.cc",
     "quic/core/congestion_control/pacing_sender_test.cc",
+    "quic/core/congestion_control/pcc_sender_test.cc",
     "quic/core/congestion_control/prr_sender_test.cc",
     "quic/core/congestion_control/rtt_stats_test.cc",
     "quic/core/congestion_control/send_algorithm_test.cc",
     "quic/core/congestion_control/tcp_cubic_sender_bytes_test.cc",
     "quic/core/congestion_control/uber_loss_algorithm_test.cc",
     "quic/core/congestion_control/windowed_filter_test.cc",
+    "quic/core/crypto/address_token_crypter_test.cc",
     "quic/core/crypto/aes_128_gcm_12_decrypter_test.cc",
     "quic/core/crypto/aes_128_gcm_12_encrypter_test.cc",
     "quic/core/crypto/aes_128_gcm_decrypter_test.cc",
@@ -1130,8 +1174,12 @@ quiche_tests_srcs = [
     "quic/core/crypto/quic_crypto_server_config_test.cc",
     "quic/core/crypto/quic_hkdf_test.cc",
     "quic/core/crypto/quic_random_test.cc",
+    "quic/core/crypto/sharded_quic_client_session_cache_test.cc",
+    "quic/core/crypto/tls_cert_compression_test.cc",
+    "quic/core/crypto/tls_client_hello_parser_test.cc",
     "quic/core/crypto/transport_parameters_test.cc",
     "quic/core/crypto/web_transport_fingerprint_proof_verifier_test.cc",
+    "quic/core/crypto/zero_rtt_replay_filter_test.cc",
     "quic/core/frames/quic_frames_test.cc",
     "quic/core/http/capsule_test.cc",
     "quic/core/http/http_decoder_test.cc",
@@ -1157,6 +1205,7 @@ quiche_tests_srcs = [
     "quic/core/qpack/qpack_decoder_stream_receiver_test.cc",
     "quic/core/qpack/qpack_decoder_stream_sender_test.cc",
     "quic/core/qpack/qpack_decoder_test.cc",
+    "quic/core/qpack/qpack_encoder_strategy_test.cc",
     "quic/core/qpack/qpack_encoder_stream_receiver_test.cc",
     "quic/core/qpack/qpack_encoder_stream_sender_test.cc",
     "quic/core/qpack/qpack_encoder_test.cc",
@@ -1173,6 +1222,7 @@ quiche_tests_srcs = [
     "quic/core/quic_alarm_test.cc",
     "quic/core/quic_arena_scoped_ptr_test.cc",
     "quic/core/quic_bandwidth_test.cc",
+    "quic/core/quic_binary_trace_visitor_test.cc",
     "quic/core/quic_buffered_packet_store_test.cc",
     "quic/core/quic_chaos_protector_test.cc",
     "quic/core/quic_coalesced_packet_test.cc",
@@ -1182,6 +1232,7 @@ quiche_tests_srcs = [
     "quic/core/quic_connection_id_test.cc",
     "quic/core/quic_connection_test.cc",
     "quic/core/quic_control_frame_manager_test.cc",
+    "quic/core/quic_cpu_profiler_test.cc",
     "quic/core/quic_crypto_client_handshaker_test.cc",
     "quic/core/quic_crypto_client_stream_test.cc",
     "quic/core/quic_crypto_server_stream_test.cc",
@@ -1203,9 +1254,11 @@ quiche_tests_srcs = [
     "quic/core/quic_packet_creator_test.cc",
     "quic/core/quic_packet_number_test.cc",
     "quic/core/quic_packets_test.cc",
+    "quic/core/quic_path_scheduler_test.cc",
     "quic/core/quic_path_validator_test.cc",
     "quic/core/quic_ping_manager_test.cc",
     "quic/core/quic_received_packet_manager_test.cc",
+    "quic/core/quic_retry_policy_test.cc",
     "quic/core/quic_sent_packet_manager_test.cc",
     "quic/core/quic_server_id_test.cc",
     "quic/core/quic_session_test.cc",
@@ -1237,15 +1290,19 @@ quiche_tests_srcs = [
     "quic/test_tools/quic_test_utils_test.cc",
     "quic/test_tools/simple_session_notifier_test.cc",
     "quic/test_tools/simulator/quic_endpoint_test.cc",
+    "quic/test_tools/simulator/simulation_sweep_test.cc",
     "quic/test_tools/simulator/simulator_test.cc",
+    "quic/tools/persistent_session_cache_test.cc",
     "quic/tools/quic_memory_cache_backend_test.cc",
     "quic/tools/quic_tcp_like_trace_converter_test.cc",
+    "quic/tools/shared_memory_ticket_crypter_test.cc",
     "quic/tools/simple_ticket_crypter_test.cc",
     "spdy/core/array_output_buffer_test.cc",
     "spdy/core/hpack/hpack_decoder_adapter_test.cc",
     "spdy/core/hpack/hpack_encoder_test.cc",
     "spdy/core/hpack/hpack_entry_test.cc",
     "spdy/core/hpack/hpack_header_table_test.cc",
+    "spdy/core/hpack/hpack_indexing_policy_test.cc",
     "spdy/core/hpack/hpack_output_stream_test.cc",
     "spdy/core/hpack/hpack_round_trip_test.cc",
     "spdy/core/hpack/hpack_static_table_test.cc",
@@ -1280,6 +1337,7 @@ epoll_tests_srcs = [
     "quic/core/quic_epoll_connection_helper_test.cc",
     "quic/core/quic_linux_socket_utils_test.cc",
     "quic/tools/quic_client_test.cc",
+    "quic/tools/quic_lb_forwarder_test.cc",
     "quic/tools/quic_server_test.cc",
     "quic/tools/quic_simple_server_session_test.cc",
     "quic/tools/quic_simple_server_stream_test.cc",
@@ -1308,17 +1366,25 @@ cli_tools_hdrs = [
     "quic/tools/quic_toy_server.h",
 ]
 cli_tools_srcs = [
+    "balsa/balsa_frame_benchmark_bin.cc",
+    "http2/decoder/http2_frame_decoder_benchmark_bin.cc",
     "quic/masque/masque_client_bin.cc",
     "quic/masque/masque_server_bin.cc",
+    "quic/test_tools/simulator/simulator_benchmark_bin.cc",
     "quic/tools/crypto_message_printer_bin.cc",
     "quic/tools/qpack_offline_decoder_bin.cc",
+    "quic/tools/quic_chlo_extractor_benchmark_bin.cc",
     "quic/tools/quic_client_bin.cc",
     "quic/tools/quic_client_interop_test_bin.cc",
     "quic/tools/quic_epoll_client_factory.cc",
     "quic/tools/quic_epoll_server_factory.cc",
+    "quic/tools/quic_handshake_benchmark_bin.cc",
+    "quic/tools/quic_lb_decoder_benchmark_bin.cc",
+    "quic/tools/quic_lb_forwarder_bin.cc",
     "quic/tools/quic_packet_printer_bin.cc",
     "quic/tools/quic_reject_reason_decoder_bin.cc",
     "quic/tools/quic_server_bin.cc",
+    "quic/tools/quic_throughput_benchmark_bin.cc",
     "quic/tools/quic_toy_client.cc",
     "quic/tools/quic_toy_server.cc",
 ]
@@ -1415,6 +1481,7 @@ load_balancer_hdrs = [
     "quic/load_balancer/load_balancer_config.h",
     "quic/load_balancer/load_balancer_decoder.h",
     "quic/load_balancer/load_balancer_encoder.h",
+    "quic/load_balancer/load_balancer_router.h",
     "quic/load_balancer/load_balancer_server_id.h",
     "quic/load_balancer/load_balancer_server_id_map.h",
 ]
@@ -1425,6 +1492,8 @@ load_balancer_srcs = [
     "quic/load_balancer/load_balancer_decoder_test.cc",
     "quic/load_balancer/load_balancer_encoder.cc",
     "quic/load_balancer/load_balancer_encoder_test.cc",
+    "quic/load_balancer/load_balancer_router.cc",
+    "quic/load_balancer/load_balancer_router_test.cc",
     "quic/load_balancer/load_balancer_server_id.cc",
     "quic/load_balancer/load_balancer_server_id_map_test.cc",
     "quic/load_balancer/load_balancer_server_id_test.cc",
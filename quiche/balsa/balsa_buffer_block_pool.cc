@@ -0,0 +1,48 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/balsa/balsa_buffer_block_pool.h"
+
+#include <algorithm>
+#include <memory>
+#include <utility>
+
+#include "quiche/common/platform/api/quiche_logging.h"
+
+namespace quiche {
+
+BalsaBufferBlockPool::BalsaBufferBlockPool(size_t block_size,
+                                           size_t max_free_blocks)
+    : block_size_(block_size), max_free_blocks_(max_free_blocks) {
+  free_blocks_.reserve(max_free_blocks_);
+}
+
+std::unique_ptr<char[]> BalsaBufferBlockPool::Allocate() {
+  if (free_blocks_.empty()) {
+    ++num_allocations_;
+    return std::make_unique<char[]>(block_size_);
+  }
+  ++num_reuses_;
+  std::unique_ptr<char[]> block = std::move(free_blocks_.back());
+  free_blocks_.pop_back();
+  return block;
+}
+
+void BalsaBufferBlockPool::Release(std::unique_ptr<char[]> block) {
+  QUICHE_DCHECK(block != nullptr);
+  if (block == nullptr || free_blocks_.size() >= max_free_blocks_) {
+    return;
+  }
+  free_blocks_.push_back(std::move(block));
+  free_blocks_high_water_mark_ =
+      std::max(free_blocks_high_water_mark_, free_blocks_.size());
+}
+
+void BalsaBufferBlockPool::Trim(size_t max_free_blocks) {
+  if (free_blocks_.size() > max_free_blocks) {
+    free_blocks_.resize(max_free_blocks);
+  }
+}
+
+}  // namespace quiche
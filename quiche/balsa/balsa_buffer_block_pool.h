@@ -0,0 +1,74 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_BALSA_BALSA_BUFFER_BLOCK_POOL_H_
+#define QUICHE_BALSA_BALSA_BUFFER_BLOCK_POOL_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "quiche/common/platform/api/quiche_export.h"
+
+namespace quiche {
+
+// A free list of fixed-size storage blocks for BalsaBuffer.
+//
+// On a keep-alive connection every request parsed by BalsaFrame needs header
+// storage, and BalsaHeaders::Clear() releases all of it.  Attaching a pool to
+// the BalsaHeaders objects of a connection (or of every connection served by a
+// thread) lets cleared blocks be handed to the next message instead of going
+// back to the allocator.
+//
+// The pool retains at most `max_free_blocks` unused blocks; blocks released
+// beyond that are freed.  The pool is not thread-safe: share it per thread or
+// per connection, and make sure it outlives every BalsaBuffer that uses it.
+class QUICHE_EXPORT_PRIVATE BalsaBufferBlockPool {
+ public:
+  static constexpr size_t kDefaultMaxFreeBlocks = 64;
+
+  explicit BalsaBufferBlockPool(size_t block_size)
+      : BalsaBufferBlockPool(block_size, kDefaultMaxFreeBlocks) {}
+  BalsaBufferBlockPool(size_t block_size, size_t max_free_blocks);
+
+  BalsaBufferBlockPool(const BalsaBufferBlockPool&) = delete;
+  BalsaBufferBlockPool& operator=(const BalsaBufferBlockPool&) = delete;
+
+  // Returns a block of block_size() bytes, reusing a free one if available.
+  std::unique_ptr<char[]> Allocate();
+
+  // Returns `block`, which must be block_size() bytes long, to the pool.  The
+  // block is freed if the pool already retains max_free_blocks() blocks.
+  void Release(std::unique_ptr<char[]> block);
+
+  // Frees unused blocks until at most `max_free_blocks` remain.
+  void Trim(size_t max_free_blocks);
+
+  size_t block_size() const { return block_size_; }
+  size_t max_free_blocks() const { return max_free_blocks_; }
+  size_t num_free_blocks() const { return free_blocks_.size(); }
+
+  // The largest number of unused blocks retained at any one time.
+  size_t free_blocks_high_water_mark() const {
+    return free_blocks_high_water_mark_;
+  }
+
+  // Number of Allocate() calls that had to go to the heap.
+  uint64_t num_allocations() const { return num_allocations_; }
+  // Number of Allocate() calls that were served from the free list.
+  uint64_t num_reuses() const { return num_reuses_; }
+
+ private:
+  const size_t block_size_;
+  const size_t max_free_blocks_;
+  std::vector<std::unique_ptr<char[]>> free_blocks_;
+  size_t free_blocks_high_water_mark_ = 0;
+  uint64_t num_allocations_ = 0;
+  uint64_t num_reuses_ = 0;
+};
+
+}  // namespace quiche
+
+#endif  // QUICHE_BALSA_BALSA_BUFFER_BLOCK_POOL_H_
@@ -0,0 +1,61 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/balsa/balsa_buffer_block_pool.h"
+
+#include <memory>
+#include <utility>
+
+#include "quiche/common/platform/api/quiche_test.h"
+
+namespace quiche {
+namespace test {
+namespace {
+
+TEST(BalsaBufferBlockPoolTest, AllocateAndRelease) {
+  BalsaBufferBlockPool pool(16, 2);
+  EXPECT_EQ(16u, pool.block_size());
+  EXPECT_EQ(2u, pool.max_free_blocks());
+  EXPECT_EQ(0u, pool.num_free_blocks());
+
+  std::unique_ptr<char[]> block1 = pool.Allocate();
+  std::unique_ptr<char[]> block2 = pool.Allocate();
+  ASSERT_NE(nullptr, block1);
+  ASSERT_NE(nullptr, block2);
+  EXPECT_EQ(2u, pool.num_allocations());
+  EXPECT_EQ(0u, pool.num_reuses());
+
+  const char* block1_ptr = block1.get();
+  pool.Release(std::move(block1));
+  EXPECT_EQ(1u, pool.num_free_blocks());
+
+  std::unique_ptr<char[]> block3 = pool.Allocate();
+  EXPECT_EQ(block1_ptr, block3.get());
+  EXPECT_EQ(2u, pool.num_allocations());
+  EXPECT_EQ(1u, pool.num_reuses());
+  EXPECT_EQ(0u, pool.num_free_blocks());
+}
+
+TEST(BalsaBufferBlockPoolTest, RetainsAtMostMaxFreeBlocks) {
+  BalsaBufferBlockPool pool(16, 2);
+  std::unique_ptr<char[]> block1 = pool.Allocate();
+  std::unique_ptr<char[]> block2 = pool.Allocate();
+  std::unique_ptr<char[]> block3 = pool.Allocate();
+  pool.Release(std::move(block1));
+  pool.Release(std::move(block2));
+  pool.Release(std::move(block3));
+  EXPECT_EQ(2u, pool.num_free_blocks());
+  EXPECT_EQ(2u, pool.free_blocks_high_water_mark());
+
+  pool.Trim(1);
+  EXPECT_EQ(1u, pool.num_free_blocks());
+  EXPECT_EQ(2u, pool.free_blocks_high_water_mark());
+
+  pool.Trim(0);
+  EXPECT_EQ(0u, pool.num_free_blocks());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quiche
@@ -51,7 +51,13 @@ constexpr absl::string_view kTransferEncoding = "transfer-encoding";
 
 }  // namespace
 
-void BalsaFrame::Reset() {
+void BalsaFrame::Reset() { ResetInternal(/*retain_header_storage=*/false); }
+
+void BalsaFrame::ResetForNextMessage() {
+  ResetInternal(/*retain_header_storage=*/true);
+}
+
+void BalsaFrame::ResetInternal(bool retain_header_storage) {
   last_char_was_slash_r_ = false;
   saw_non_newline_char_ = false;
   start_was_space_ = true;
@@ -72,16 +78,25 @@ void BalsaFrame::Reset() {
   invalid_chars_.clear();
   lines_.clear();
   if (continue_headers_ != nullptr) {
-    continue_headers_->Clear();
+    ClearHeaders(continue_headers_, retain_header_storage);
   }
   if (headers_ != nullptr) {
-    headers_->Clear();
+    ClearHeaders(headers_, retain_header_storage);
   }
   trailer_lines_.clear();
   start_of_trailer_line_ = 0;
   trailer_length_ = 0;
   if (trailer_ != nullptr) {
-    trailer_->Clear();
+    ClearHeaders(trailer_, retain_header_storage);
+  }
+}
+
+void BalsaFrame::ClearHeaders(BalsaHeaders* headers,
+                              bool retain_header_storage) {
+  if (retain_header_storage) {
+    headers->Reset();
+  } else {
+    headers->Clear();
   }
 }
 
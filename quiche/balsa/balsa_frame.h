@@ -76,6 +76,13 @@ class QUICHE_EXPORT_PRIVATE BalsaFrame : public FramerInterface {
   // attached header object (but doesn't change the pointer value headers_).
   void Reset();
 
+  // Like Reset(), but recycles the storage of the attached headers, continue
+  // headers and trailer (see BalsaHeaders::Reset()) instead of freeing it.
+  // Intended to be called between messages on a keep-alive connection, so
+  // that parsing the next message does not need to allocate header storage.
+  // Any string_view obtained from the previous message is invalidated.
+  void ResetForNextMessage();
+
   // The method set_balsa_headers clears the headers provided and attaches them
   // to the framer.  This is a required step before the framer will process any
   // input message data.
@@ -269,6 +276,9 @@ class QUICHE_EXPORT_PRIVATE BalsaFrame : public FramerInterface {
   bool FindColonsAndParseIntoKeyValue(const Lines& lines, bool is_trailer,
                                       BalsaHeaders* headers);
 
+  void ResetInternal(bool retain_header_storage);
+  static void ClearHeaders(BalsaHeaders* headers, bool retain_header_storage);
+
   void HandleError(BalsaFrameEnums::ErrorCode error_code);
   void HandleWarning(BalsaFrameEnums::ErrorCode error_code);
 
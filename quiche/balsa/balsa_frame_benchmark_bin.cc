@@ -0,0 +1,133 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how many requests per second a single BalsaFrame can parse on a
+// keep-alive connection, with and without recycling header storage between
+// requests.
+//
+// Usage: balsa_frame_benchmark [--requests=N] [--extra_headers=N]
+
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "quiche/balsa/balsa_buffer_block_pool.h"
+#include "quiche/balsa/balsa_frame.h"
+#include "quiche/balsa/balsa_headers.h"
+#include "quiche/common/platform/api/quiche_command_line_flags.h"
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, requests, 1000000,
+                                "Number of requests to parse per mode.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, extra_headers, 8,
+    "Number of extra headers added to every request, in addition to a "
+    "typical set of browser request headers.");
+
+namespace quiche {
+namespace {
+
+enum class ResetMode {
+  // BalsaFrame::Reset(), header storage goes back to the allocator.
+  kClear,
+  // BalsaFrame::Reset(), header storage goes back to a block pool.
+  kClearWithPool,
+  // BalsaFrame::ResetForNextMessage(), header storage is kept in place.
+  kRecycle,
+};
+
+const char* ResetModeToString(ResetMode mode) {
+  switch (mode) {
+    case ResetMode::kClear:
+      return "Reset";
+    case ResetMode::kClearWithPool:
+      return "Reset with block pool";
+    case ResetMode::kRecycle:
+      return "ResetForNextMessage";
+  }
+  return "unknown";
+}
+
+std::string BuildRequest(int extra_headers) {
+  std::string request =
+      "GET /index.html?query=1 HTTP/1.1\r\n"
+      "host: www.example.com\r\n"
+      "user-agent: Mozilla/5.0 (X11; Linux x86_64) AppleWebKit/537.36\r\n"
+      "accept: text/html,application/xhtml+xml,application/xml;q=0.9\r\n"
+      "accept-encoding: gzip, deflate, br\r\n"
+      "accept-language: en-US,en;q=0.9\r\n"
+      "cookie: session=0123456789abcdef0123456789abcdef\r\n";
+  for (int i = 0; i < extra_headers; ++i) {
+    absl::StrAppend(&request, "x-extra-header-", i, ": value-", i, "\r\n");
+  }
+  absl::StrAppend(&request, "\r\n");
+  return request;
+}
+
+void RunBenchmark(ResetMode mode, const std::string& request, int requests) {
+  BalsaBufferBlockPool pool(BalsaBuffer::kDefaultBlocksize);
+  BalsaHeaders headers;
+  if (mode != ResetMode::kClear) {
+    headers.set_block_pool(&pool);
+  }
+  BalsaFrame framer;
+  framer.set_is_request(true);
+  framer.set_balsa_headers(&headers);
+
+  const absl::Time start = absl::Now();
+  for (int i = 0; i < requests; ++i) {
+    framer.ProcessInput(request.data(), request.size());
+    if (!framer.MessageFullyRead()) {
+      std::cerr << "Failed to parse request: "
+                << BalsaFrameEnums::ErrorCodeToString(framer.ErrorCode())
+                << std::endl;
+      return;
+    }
+    if (mode == ResetMode::kRecycle) {
+      framer.ResetForNextMessage();
+    } else {
+      framer.Reset();
+    }
+  }
+  const double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+
+  std::cout << ResetModeToString(mode) << ": " << requests / seconds
+            << " requests/s, "
+            << (seconds * 1e9 / requests) << " ns/request";
+  if (mode != ResetMode::kClear) {
+    std::cout << ", " << pool.num_allocations() << " block allocations, "
+              << pool.num_reuses() << " block reuses";
+  }
+  std::cout << std::endl;
+}
+
+}  // namespace
+}  // namespace quiche
+
+int main(int argc, char* argv[]) {
+  const char* usage =
+      "Usage: balsa_frame_benchmark [--requests=N] [--extra_headers=N]";
+  std::vector<std::string> args =
+      quiche::QuicheParseCommandLineFlags(usage, argc, argv);
+  if (!args.empty()) {
+    quiche::QuichePrintCommandLineFlagHelp(usage);
+    return 1;
+  }
+
+  const int requests = quiche::GetQuicheCommandLineFlag(FLAGS_requests);
+  const std::string request = quiche::BuildRequest(
+      quiche::GetQuicheCommandLineFlag(FLAGS_extra_headers));
+  std::cout << "Parsing " << requests << " requests of " << request.size()
+            << " bytes" << std::endl;
+  for (quiche::ResetMode mode :
+       {quiche::ResetMode::kClear, quiche::ResetMode::kClearWithPool,
+        quiche::ResetMode::kRecycle}) {
+    quiche::RunBenchmark(mode, request, requests);
+  }
+  return 0;
+}
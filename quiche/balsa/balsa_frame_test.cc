@@ -21,6 +21,7 @@
 #include "absl/strings/str_format.h"
 #include "absl/strings/str_replace.h"
 #include "absl/strings/string_view.h"
+#include "quiche/balsa/balsa_buffer_block_pool.h"
 #include "quiche/balsa/balsa_enums.h"
 #include "quiche/balsa/balsa_headers.h"
 #include "quiche/balsa/balsa_visitor_interface.h"
@@ -3700,6 +3701,82 @@ TEST_F(HTTPBalsaFrameTest, Support100ContinueRunTogether) {
   EXPECT_EQ(BalsaFrameEnums::BALSA_NO_ERROR, balsa_frame_.ErrorCode());
 }
 
+// Parses `count` copies of a request on one framer, the way a keep-alive
+// connection would, and returns the number of header storage blocks that had
+// to be allocated from the heap.
+uint64_t CountBlockAllocationsForKeepAliveRequests(bool recycle, int count) {
+  const std::string request =
+      "POST /upload HTTP/1.1\r\n"
+      "host: www.example.com\r\n"
+      "user-agent: Mozilla/5.0 (X11; Linux x86_64)\r\n"
+      "content-length: 3\r\n"
+      "\r\n"
+      "foo";
+
+  BalsaBufferBlockPool pool(BalsaBuffer::kDefaultBlocksize);
+  BalsaHeaders headers;
+  headers.set_block_pool(&pool);
+  BalsaFrame framer;
+  framer.set_is_request(true);
+  framer.set_balsa_headers(&headers);
+  for (int i = 0; i < count; ++i) {
+    size_t consumed = 0;
+    while (consumed < request.size() && !framer.Error()) {
+      consumed += framer.ProcessInput(request.data() + consumed,
+                                      request.size() - consumed);
+    }
+    EXPECT_TRUE(framer.MessageFullyRead());
+    EXPECT_EQ("www.example.com", headers.GetHeader("host"));
+    if (recycle) {
+      framer.ResetForNextMessage();
+    } else {
+      framer.Reset();
+    }
+  }
+  return pool.num_allocations();
+}
+
+TEST(HTTPBalsaFrame, KeepAliveRequestsReuseHeaderStorage) {
+  const uint64_t allocations_for_one =
+      CountBlockAllocationsForKeepAliveRequests(/*recycle=*/true, 1);
+  EXPECT_LT(0u, allocations_for_one);
+  EXPECT_EQ(allocations_for_one,
+            CountBlockAllocationsForKeepAliveRequests(/*recycle=*/true, 100));
+  // Even when the framer frees header storage, the pool catches it.
+  EXPECT_EQ(allocations_for_one,
+            CountBlockAllocationsForKeepAliveRequests(/*recycle=*/false, 100));
+}
+
+TEST_F(HTTPBalsaFrameTest, ResetForNextMessageRecyclesTrailer) {
+  const std::string response =
+      "HTTP/1.1 200 OK\r\n"
+      "transfer-encoding: chunked\r\n"
+      "\r\n"
+      "3\r\n"
+      "foo\r\n"
+      "0\r\n"
+      "trailer-key: trailer-value\r\n"
+      "\r\n";
+
+  balsa_frame_.set_is_request(false);
+  balsa_frame_.set_balsa_trailer(&trailer_);
+  for (int i = 0; i < 3; ++i) {
+    size_t consumed = 0;
+    while (consumed < response.size() && !balsa_frame_.Error()) {
+      consumed += balsa_frame_.ProcessInput(response.data() + consumed,
+                                            response.size() - consumed);
+    }
+    ASSERT_TRUE(balsa_frame_.MessageFullyRead());
+    EXPECT_EQ("200", headers_.response_code());
+    EXPECT_EQ("trailer-value", trailer_.GetHeader("trailer-key"));
+    balsa_frame_.ResetForNextMessage();
+    EXPECT_TRUE(headers_.IsEmpty());
+    EXPECT_TRUE(trailer_.IsEmpty());
+    EXPECT_EQ(BalsaFrameEnums::READING_HEADER_AND_FIRSTLINE,
+              balsa_frame_.ParseState());
+  }
+}
+
 }  // namespace
 
 }  // namespace test
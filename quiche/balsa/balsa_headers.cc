@@ -230,6 +230,24 @@ void BalsaHeaders::Clear() {
   header_lines_.shrink_to_fit();
 }
 
+void BalsaHeaders::Reset() {
+  balsa_buffer_.Reset();
+  transfer_encoding_is_chunked_ = false;
+  content_length_ = 0;
+  content_length_status_ = BalsaHeadersEnums::NO_CONTENT_LENGTH;
+  parsed_response_code_ = 0;
+  firstline_buffer_base_idx_ = 0;
+  whitespace_1_idx_ = 0;
+  non_whitespace_1_idx_ = 0;
+  whitespace_2_idx_ = 0;
+  non_whitespace_2_idx_ = 0;
+  whitespace_3_idx_ = 0;
+  non_whitespace_3_idx_ = 0;
+  whitespace_4_idx_ = 0;
+  // Unlike Clear(), keep the capacity of header_lines_.
+  header_lines_.clear();
+}
+
 void BalsaHeaders::CopyFrom(const BalsaHeaders& other) {
   // Protect against copying with self.
   if (this == &other) {
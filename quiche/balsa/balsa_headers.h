@@ -24,6 +24,7 @@
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "quiche/balsa/balsa_buffer_block_pool.h"
 #include "quiche/balsa/balsa_enums.h"
 #include "quiche/balsa/header_api.h"
 #include "quiche/balsa/standard_header_map.h"
@@ -130,8 +131,39 @@ class QUICHE_EXPORT_PRIVATE BalsaBuffer {
 
   BalsaBuffer(const BalsaBuffer&) = delete;
   BalsaBuffer& operator=(const BalsaBuffer&) = delete;
-  BalsaBuffer(BalsaBuffer&&) = default;
-  BalsaBuffer& operator=(BalsaBuffer&&) = default;
+
+  BalsaBuffer(BalsaBuffer&& other)
+      : blocks_(std::move(other.blocks_)),
+        blocksize_(other.blocksize_),
+        can_write_to_contiguous_buffer_(other.can_write_to_contiguous_buffer_),
+        block_pool_(other.block_pool_) {
+    other.blocks_.clear();
+  }
+
+  BalsaBuffer& operator=(BalsaBuffer&& other) {
+    if (this != &other) {
+      ReleaseBlocks();
+      blocks_ = std::move(other.blocks_);
+      other.blocks_.clear();
+      blocksize_ = other.blocksize_;
+      can_write_to_contiguous_buffer_ = other.can_write_to_contiguous_buffer_;
+      block_pool_ = other.block_pool_;
+    }
+    return *this;
+  }
+
+  ~BalsaBuffer() { ReleaseBlocks(); }
+
+  // Attaches a pool from which blocks of blocksize() bytes are allocated, and
+  // to which they are returned by Clear() and on destruction.  The pool is not
+  // owned and must outlive this object.  Blocks of any other size, such as the
+  // grown first block, bypass the pool.  Passing nullptr detaches the pool.
+  void set_block_pool(BalsaBufferBlockPool* block_pool) {
+    QUICHE_DCHECK(block_pool == nullptr ||
+                  block_pool->block_size() == blocksize_);
+    block_pool_ = block_pool;
+  }
+  BalsaBufferBlockPool* block_pool() const { return block_pool_; }
 
   // Returns the total amount of memory reserved by the buffer blocks.
   size_t GetTotalBufferBlockSize() const {
@@ -216,6 +248,7 @@ class QUICHE_EXPORT_PRIVATE BalsaBuffer {
         memcpy(new_storage.get(), old_storage, old_storage_size_used);
       }
       memcpy(new_storage.get() + old_storage_size_used, sp.data(), sp.size());
+      ReleaseBlock(&blocks_[0]);
       blocks_[0].buffer = std::move(new_storage);
       blocks_[0].bytes_free = new_storage_size - old_storage_size_used;
       blocks_[0].buffer_size = new_storage_size;
@@ -268,11 +301,39 @@ class QUICHE_EXPORT_PRIVATE BalsaBuffer {
   }
 
   void Clear() {
+    ReleaseBlocks();
     blocks_.clear();
     blocks_.shrink_to_fit();
     can_write_to_contiguous_buffer_ = true;
   }
 
+  // Like Clear(), but keeps the allocated blocks so that the next message can
+  // be stored without allocating.  The retained capacity is the high-water
+  // mark of the messages stored since construction or the last Clear(): the
+  // first (contiguous) block keeps whatever size it has grown to, and every
+  // other block of blocksize() bytes is kept.  Oversized blocks reserved for
+  // single large header lines are released.
+  //
+  // As with Clear(), all pointers into the buffer are invalidated.
+  void Reset() {
+    Blocks::size_type num_retained = 0;
+    for (Blocks::size_type i = 0; i < blocks_.size(); ++i) {
+      BufferBlock& block = blocks_[i];
+      if (i > 0 &&
+          (block.buffer == nullptr || block.buffer_size != blocksize_)) {
+        ReleaseBlock(&block);
+        continue;
+      }
+      block.bytes_free = block.buffer_size;
+      if (num_retained != i) {
+        blocks_[num_retained] = std::move(block);
+      }
+      ++num_retained;
+    }
+    blocks_.resize(num_retained);
+    can_write_to_contiguous_buffer_ = true;
+  }
+
   void CopyFrom(const BalsaBuffer& b) {
     blocks_.resize(b.blocks_.size());
     for (Blocks::size_type i = 0; i < blocks_.size(); ++i) {
@@ -307,13 +368,36 @@ class QUICHE_EXPORT_PRIVATE BalsaBuffer {
   size_t bytes_used(size_t idx) const { return blocks_[idx].bytes_used(); }
 
  private:
-  BufferBlock AllocBlock() { return AllocCustomBlock(blocksize_); }
+  BufferBlock AllocBlock() {
+    if (block_pool_ != nullptr && block_pool_->block_size() == blocksize_) {
+      return BufferBlock{block_pool_->Allocate(), blocksize_, blocksize_};
+    }
+    return AllocCustomBlock(blocksize_);
+  }
 
   BufferBlock AllocCustomBlock(size_t blocksize) {
     return BufferBlock{absl::make_unique<char[]>(blocksize), blocksize,
                        blocksize};
   }
 
+  // Hands the storage of `block` back to the pool if it came from there.
+  void ReleaseBlock(BufferBlock* block) {
+    if (block_pool_ != nullptr && block->buffer != nullptr &&
+        block->buffer_size == block_pool_->block_size()) {
+      block_pool_->Release(std::move(block->buffer));
+    }
+    block->buffer = nullptr;
+  }
+
+  void ReleaseBlocks() {
+    if (block_pool_ == nullptr) {
+      return;
+    }
+    for (BufferBlock& block : blocks_) {
+      ReleaseBlock(&block);
+    }
+  }
+
   // A container of BufferBlocks
   Blocks blocks_;
 
@@ -328,6 +412,9 @@ class QUICHE_EXPORT_PRIVATE BalsaBuffer {
   // not be changing in order to provide the user with StringPieces which
   // continue to be valid.
   bool can_write_to_contiguous_buffer_;
+
+  // Not owned.  If set, blocks of blocksize_ bytes are recycled through it.
+  BalsaBufferBlockPool* block_pool_ = nullptr;
 };
 
 ////////////////////////////////////////////////////////////////////////////////
@@ -475,6 +562,18 @@ class QUICHE_EXPORT_PRIVATE BalsaHeaders : public HeaderApi {
 
   void Clear();
 
+  // Like Clear(), but keeps the header storage allocated for the previous
+  // message so that the next message on the same connection can be stored
+  // without allocating.  See BalsaBuffer::Reset().
+  void Reset();
+
+  // Attaches a pool that the header storage blocks are allocated from and
+  // returned to.  The pool must have a block size equal to the block size this
+  // object was constructed with, and must outlive this object.
+  void set_block_pool(BalsaBufferBlockPool* block_pool) {
+    balsa_buffer_.set_block_pool(block_pool);
+  }
+
   // Explicit copy functions to avoid risk of accidental copies.
   BalsaHeaders Copy() const {
     BalsaHeaders copy;
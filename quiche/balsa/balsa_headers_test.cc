@@ -22,6 +22,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/str_format.h"
 #include "absl/strings/string_view.h"
+#include "quiche/balsa/balsa_buffer_block_pool.h"
 #include "quiche/balsa/balsa_enums.h"
 #include "quiche/balsa/balsa_frame.h"
 #include "quiche/balsa/simple_buffer.h"
@@ -212,6 +213,104 @@ TEST_F(BalsaBufferTest, ClearWorksWhenLargerThanBlocksize) {
   EXPECT_EQ(0u, buffer_->num_blocks());
 }
 
+TEST_F(BalsaBufferTest, ResetKeepsCapacity) {
+  CreateBuffer(10);
+
+  std::string data1 = "foobarbaz01lkjasdlkjasdlkjasd";
+  buffer_->WriteToContiguousBuffer(data1);
+  buffer_->NoMoreWriteToContiguousBuffer();
+  std::string data2 = "12345";
+  Write(data2, nullptr);
+  std::string data3 = "6789";
+  Write(data3, nullptr);
+
+  const size_t total_size = buffer_->GetTotalBufferBlockSize();
+  const BalsaBuffer::Blocks::size_type num_blocks = buffer_->num_blocks();
+  const char* first_block = buffer_->StartOfFirstBlock();
+
+  buffer_->Reset();
+
+  EXPECT_TRUE(buffer_->can_write_to_contiguous_buffer());
+  EXPECT_EQ(0u, buffer_->GetTotalBytesUsed());
+  EXPECT_EQ(total_size, buffer_->GetTotalBufferBlockSize());
+  EXPECT_EQ(num_blocks, buffer_->num_blocks());
+
+  // Storing the same message again neither grows nor moves the first block.
+  buffer_->WriteToContiguousBuffer(data1);
+  buffer_->NoMoreWriteToContiguousBuffer();
+  Write(data2, nullptr);
+  Write(data3, nullptr);
+  EXPECT_EQ(first_block, buffer_->StartOfFirstBlock());
+  EXPECT_EQ(total_size, buffer_->GetTotalBufferBlockSize());
+  EXPECT_EQ(data1, absl::string_view(buffer_->StartOfFirstBlock(),
+                                     buffer_->GetReadableBytesOfFirstBlock()));
+}
+
+TEST_F(BalsaBufferTest, ResetReleasesOversizedBlocks) {
+  CreateBuffer(10);
+
+  buffer_->WriteToContiguousBuffer("foo");
+  buffer_->NoMoreWriteToContiguousBuffer();
+  // Fills up the first block.
+  Write("1234567", nullptr);
+  Write("12345", nullptr);
+  Write("a value that is longer than the block size", nullptr);
+  ASSERT_EQ(3u, buffer_->num_blocks());
+
+  buffer_->Reset();
+
+  ASSERT_EQ(2u, buffer_->num_blocks());
+  EXPECT_EQ(10u, buffer_->buffer_size(0));
+  EXPECT_EQ(10u, buffer_->buffer_size(1));
+}
+
+TEST_F(BalsaBufferTest, ClearReturnsBlocksToPool) {
+  BalsaBufferBlockPool pool(10);
+  CreateBuffer(10);
+  buffer_->set_block_pool(&pool);
+
+  buffer_->WriteToContiguousBuffer("foo");
+  buffer_->NoMoreWriteToContiguousBuffer();
+  Write("1234567", nullptr);
+  Write("12345", nullptr);
+  Write("678901", nullptr);
+  EXPECT_EQ(3u, pool.num_allocations());
+  EXPECT_EQ(0u, pool.num_free_blocks());
+
+  buffer_->Clear();
+  EXPECT_EQ(3u, pool.num_free_blocks());
+
+  buffer_->WriteToContiguousBuffer("foo");
+  buffer_->NoMoreWriteToContiguousBuffer();
+  Write("1234567", nullptr);
+  Write("12345", nullptr);
+  Write("678901", nullptr);
+  EXPECT_EQ(3u, pool.num_allocations());
+  EXPECT_EQ(3u, pool.num_reuses());
+
+  // Blocks are also returned when the buffer goes away.
+  buffer_.reset();
+  EXPECT_EQ(3u, pool.num_free_blocks());
+}
+
+TEST_F(BalsaBufferTest, PoolBypassedForOtherBlockSizes) {
+  BalsaBufferBlockPool pool(10);
+  CreateBuffer(10);
+  buffer_->set_block_pool(&pool);
+
+  // The first block grows beyond the block size, and the oversized block
+  // reserved below is never pooled.
+  buffer_->WriteToContiguousBuffer("foobarbaz01lkjasdlkjasdlkjasd");
+  buffer_->NoMoreWriteToContiguousBuffer();
+  Write("a value that is longer than the block size", nullptr);
+  EXPECT_EQ(1u, pool.num_allocations());
+  // The original first block went back to the pool when the first block grew.
+  EXPECT_EQ(1u, pool.num_free_blocks());
+
+  buffer_->Clear();
+  EXPECT_EQ(1u, pool.num_free_blocks());
+}
+
 TEST_F(BalsaBufferTest, ContiguousWriteSmallerThanBlocksize) {
   CreateBuffer(1024);
 
@@ -2406,6 +2505,33 @@ TEST(BalsaHeaders, Clear) {
   EXPECT_TRUE(headers.IsEmpty());
 }
 
+TEST(BalsaHeaders, Reset) {
+  BalsaBufferBlockPool pool(BalsaBuffer::kDefaultBlocksize);
+  BalsaHeaders headers;
+  headers.set_block_pool(&pool);
+  headers.SetRequestFirstlineFromStringPieces("GET", "/", "HTTP/1.0");
+  headers.AppendHeader("key1", "value1");
+  headers.AppendHeader("key2", "value2");
+  const uint64_t num_allocations = pool.num_allocations();
+  EXPECT_LT(0u, num_allocations);
+
+  headers.Reset();
+  EXPECT_TRUE(headers.first_line().empty());
+  EXPECT_EQ(headers.lines().begin(), headers.lines().end());
+  EXPECT_TRUE(headers.IsEmpty());
+  EXPECT_EQ(BalsaHeadersEnums::NO_CONTENT_LENGTH,
+            headers.content_length_status());
+
+  headers.SetRequestFirstlineFromStringPieces("POST", "/", "HTTP/1.1");
+  headers.AppendHeader("key3", "value3");
+  EXPECT_EQ("POST / HTTP/1.1", headers.first_line());
+  EXPECT_EQ("value3", headers.GetHeader("key3"));
+  EXPECT_FALSE(headers.HasHeader("key1"));
+  // The storage retained by Reset() was reused; nothing came from the pool.
+  EXPECT_EQ(num_allocations, pool.num_allocations());
+  EXPECT_EQ(0u, pool.num_reuses());
+}
+
 TEST(BalsaHeaders,
      TestSetFromStringPiecesWithInitialFirstlineInHeaderStreamAndNewToo) {
   BalsaHeaders headers = CreateHTTPHeaders(false,
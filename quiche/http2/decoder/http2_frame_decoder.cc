@@ -32,7 +32,8 @@ std::ostream& operator<<(std::ostream& out, Http2FrameDecoder::State v) {
 
 Http2FrameDecoder::Http2FrameDecoder(Http2FrameDecoderListener* listener)
     : state_(State::kStartDecodingHeader),
-      maximum_payload_size_(Http2SettingsInfo::DefaultMaxFrameSize()) {
+      maximum_payload_size_(Http2SettingsInfo::DefaultMaxFrameSize()),
+      data_frame_fast_path_enabled_(true) {
   set_listener(listener);
 }
 
@@ -105,6 +106,13 @@ DecodeStatus Http2FrameDecoder::StartDecodingPayload(DecodeBuffer* db) {
     return DecodeStatus::kDecodeError;
   }
 
+  // Large transfers are dominated by DATA frames, which are usually unpadded
+  // and, with large enough transport reads, fully present in the buffer.
+  if (header.type == Http2FrameType::DATA && data_frame_fast_path_enabled_ &&
+      !header.IsPadded() && db->Remaining() >= header.payload_length) {
+    return DecodeDataFrame(db);
+  }
+
   // The decode buffer can extend across many frames. Make sure that the
   // buffer we pass to the start method that is specific to the frame type
   // does not exend beyond this frame.
@@ -176,6 +184,17 @@ DecodeStatus Http2FrameDecoder::StartDecodingPayload(DecodeBuffer* db) {
   }
 }
 
+DecodeStatus Http2FrameDecoder::DecodeDataFrame(DecodeBuffer* db) {
+  RetainFlags(Http2FrameFlag::END_STREAM | Http2FrameFlag::PADDED);
+  const Http2FrameHeader& header = frame_header();
+  QUICHE_DCHECK(!header.IsPadded());
+  QUICHE_DCHECK_LE(header.payload_length, db->Remaining());
+  listener()->OnDataFrame(header, db->cursor(), header.payload_length);
+  db->AdvanceCursor(header.payload_length);
+  state_ = State::kStartDecodingHeader;
+  return DecodeStatus::kDecodeDone;
+}
+
 DecodeStatus Http2FrameDecoder::ResumeDecodingPayload(DecodeBuffer* db) {
   // The decode buffer can extend across many frames. Make sure that the
   // buffer we pass to the start method that is specific to the frame type
@@ -63,6 +63,16 @@ class QUICHE_EXPORT_PRIVATE Http2FrameDecoder {
   void set_maximum_payload_size(size_t v) { maximum_payload_size_ = v; }
   size_t maximum_payload_size() const { return maximum_payload_size_; }
 
+  // If enabled (the default), an unpadded DATA frame whose payload is entirely
+  // in the decode buffer is reported with a single call to the listener's
+  // OnDataFrame method, bypassing the DATA payload decoder.
+  void set_data_frame_fast_path_enabled(bool v) {
+    data_frame_fast_path_enabled_ = v;
+  }
+  bool data_frame_fast_path_enabled() const {
+    return data_frame_fast_path_enabled_;
+  }
+
   // Decodes the input up to the next frame boundary (i.e. at most one frame).
   //
   // Returns kDecodeDone if it decodes the final byte of a frame, OR if there
@@ -133,6 +143,10 @@ class QUICHE_EXPORT_PRIVATE Http2FrameDecoder {
   DecodeStatus ResumeDecodingPayload(DecodeBuffer* db);
   DecodeStatus DiscardPayload(DecodeBuffer* db);
 
+  // Decodes a DATA frame whose payload is entirely in |db|. The frame header
+  // must have been decoded and validated, and the frame must not be padded.
+  DecodeStatus DecodeDataFrame(DecodeBuffer* db);
+
   const Http2FrameHeader& frame_header() const {
     return frame_decoder_state_.frame_header();
   }
@@ -205,6 +219,7 @@ class QUICHE_EXPORT_PRIVATE Http2FrameDecoder {
 
   State state_;
   size_t maximum_payload_size_;
+  bool data_frame_fast_path_enabled_;
 
   // Listener used whenever caller passes nullptr to set_listener.
   Http2FrameDecoderNoOpListener no_op_listener_;
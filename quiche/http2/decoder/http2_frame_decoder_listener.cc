@@ -6,6 +6,15 @@
 
 namespace http2 {
 
+void Http2FrameDecoderListener::OnDataFrame(const Http2FrameHeader& header,
+                                            const char* data, size_t len) {
+  OnDataStart(header);
+  if (len > 0) {
+    OnDataPayload(data, len);
+  }
+  OnDataEnd();
+}
+
 bool Http2FrameDecoderNoOpListener::OnFrameHeader(
     const Http2FrameHeader& /*header*/) {
   return true;
@@ -82,6 +82,14 @@ class QUICHE_EXPORT_PRIVATE Http2FrameDecoderListener {
   // If header.IsEndStream() == true, this is the last data for the stream.
   virtual void OnDataEnd() = 0;
 
+  // Called instead of OnDataStart, OnDataPayload and OnDataEnd when an entire
+  // unpadded DATA frame is available in the decode buffer, with |data| holding
+  // all |len| bytes of the payload, which may be empty. The default
+  // implementation makes those three calls; listeners that handle the whole
+  // frame at once can override it to avoid per-chunk bookkeeping.
+  virtual void OnDataFrame(const Http2FrameHeader& header, const char* data,
+                           size_t len);
+
   // Called once the common frame header has been decoded for a HEADERS frame,
   // before examining the frame's payload, after which:
   //   OnPadLength will be called if header.IsPadded() is true, i.e. if the
@@ -328,6 +336,8 @@ class QUICHE_EXPORT_PRIVATE Http2FrameDecoderNoOpListener
   void OnDataStart(const Http2FrameHeader& /*header*/) override {}
   void OnDataPayload(const char* /*data*/, size_t /*len*/) override {}
   void OnDataEnd() override {}
+  void OnDataFrame(const Http2FrameHeader& /*header*/, const char* /*data*/,
+                   size_t /*len*/) override {}
   void OnHeadersStart(const Http2FrameHeader& /*header*/) override {}
   void OnHeadersPriority(const Http2PriorityFields& /*priority*/) override {}
   void OnHpackFragment(const char* /*data*/, size_t /*len*/) override {}
@@ -914,6 +914,107 @@ TEST_F(Http2FrameDecoderTest, WindowUpdateTooLong) {
   EXPECT_TRUE(DecodePayloadExpectingFrameSizeError(kFrameData, header));
 }
 
+////////////////////////////////////////////////////////////////////////////////
+// Tests of the DATA frame fast path.
+
+// Records which of the DATA frame callbacks are called.
+class DataFrameListener : public Http2FrameDecoderNoOpListener {
+ public:
+  void OnDataStart(const Http2FrameHeader& /*header*/) override {
+    ++data_start_count;
+  }
+  void OnDataPayload(const char* data, size_t len) override {
+    payload.append(data, len);
+  }
+  void OnDataFrame(const Http2FrameHeader& header, const char* data,
+                   size_t len) override {
+    ++data_frame_count;
+    frame_header = header;
+    payload.append(data, len);
+  }
+
+  size_t data_start_count = 0;
+  size_t data_frame_count = 0;
+  Http2FrameHeader frame_header;
+  std::string payload;
+};
+
+constexpr char kDataFrame[] = {
+    '\x00', '\x00', '\x03',          // Payload length: 3
+    '\x00',                          // DATA
+    '\x81',                          // Flags: END_STREAM | 0x80
+    '\x00', '\x00', '\x00', '\x01',  // Stream ID: 1
+    'a',    'b',    'c',             // Data
+    '\x00', '\x00',                  // Start of the next frame.
+};
+
+TEST(Http2FrameDecoderDataFastPathTest, WholeFrame) {
+  DataFrameListener listener;
+  Http2FrameDecoder decoder(&listener);
+  EXPECT_TRUE(decoder.data_frame_fast_path_enabled());
+
+  DecodeBuffer db(kDataFrame, sizeof(kDataFrame));
+  EXPECT_EQ(DecodeStatus::kDecodeDone, decoder.DecodeFrame(&db));
+  // The next frame has not been touched.
+  EXPECT_EQ(2u, db.Remaining());
+
+  EXPECT_EQ(1u, listener.data_frame_count);
+  EXPECT_EQ(0u, listener.data_start_count);
+  EXPECT_EQ(Http2FrameHeader(3, Http2FrameType::DATA,
+                             Http2FrameFlag::END_STREAM, 1),
+            listener.frame_header);
+  EXPECT_EQ("abc", listener.payload);
+}
+
+TEST(Http2FrameDecoderDataFastPathTest, PartialFrame) {
+  DataFrameListener listener;
+  Http2FrameDecoder decoder(&listener);
+
+  DecodeBuffer db1(kDataFrame, 10);
+  EXPECT_EQ(DecodeStatus::kDecodeInProgress, decoder.DecodeFrame(&db1));
+  DecodeBuffer db2(kDataFrame + 10, 2);
+  EXPECT_EQ(DecodeStatus::kDecodeDone, decoder.DecodeFrame(&db2));
+
+  EXPECT_EQ(0u, listener.data_frame_count);
+  EXPECT_EQ(1u, listener.data_start_count);
+  EXPECT_EQ("abc", listener.payload);
+}
+
+TEST(Http2FrameDecoderDataFastPathTest, PaddedFrame) {
+  const char kFrameData[] = {
+      '\x00', '\x00', '\x05',          // Payload length: 5
+      '\x00',                          // DATA
+      '\x08',                          // Flags: PADDED
+      '\x00', '\x00', '\x00', '\x01',  // Stream ID: 1
+      '\x01',                          // Pad length: 1
+      'a',    'b',    'c',             // Data
+      '\x00',                          // Padding
+  };
+  DataFrameListener listener;
+  Http2FrameDecoder decoder(&listener);
+
+  DecodeBuffer db(kFrameData, sizeof(kFrameData));
+  EXPECT_EQ(DecodeStatus::kDecodeDone, decoder.DecodeFrame(&db));
+
+  EXPECT_EQ(0u, listener.data_frame_count);
+  EXPECT_EQ(1u, listener.data_start_count);
+  EXPECT_EQ("abc", listener.payload);
+}
+
+TEST(Http2FrameDecoderDataFastPathTest, Disabled) {
+  DataFrameListener listener;
+  Http2FrameDecoder decoder(&listener);
+  decoder.set_data_frame_fast_path_enabled(false);
+
+  DecodeBuffer db(kDataFrame, sizeof(kDataFrame));
+  EXPECT_EQ(DecodeStatus::kDecodeDone, decoder.DecodeFrame(&db));
+  EXPECT_EQ(2u, db.Remaining());
+
+  EXPECT_EQ(0u, listener.data_frame_count);
+  EXPECT_EQ(1u, listener.data_start_count);
+  EXPECT_EQ("abc", listener.payload);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace http2
@@ -23,6 +23,10 @@ void HpackDecoder::set_max_string_size_bytes(size_t max_string_size_bytes) {
   entry_buffer_.set_max_string_size_bytes(max_string_size_bytes);
 }
 
+void HpackDecoder::set_huffman_literal_cache(HpackHuffmanLiteralCache* cache) {
+  entry_buffer_.set_huffman_literal_cache(cache);
+}
+
 void HpackDecoder::ApplyHeaderTableSizeSetting(uint32_t max_header_table_size) {
   decoder_state_.ApplyHeaderTableSizeSetting(max_header_table_size);
 }
@@ -55,6 +55,11 @@ class QUICHE_EXPORT_PRIVATE HpackDecoder {
   // as the upper bound for individual strings.
   void set_max_string_size_bytes(size_t max_string_size_bytes);
 
+  // Enables caching of decoded Huffman encoded literals in |cache|, which may
+  // be shared with other decoders, including on other threads.  |cache| must
+  // outlive this object.
+  void set_huffman_literal_cache(HpackHuffmanLiteralCache* cache);
+
   // ApplyHeaderTableSizeSetting notifies this object that this endpoint has
   // received a SETTINGS ACK frame acknowledging an earlier SETTINGS frame from
   // this endpoint specifying a new value for SETTINGS_HEADER_TABLE_SIZE (the
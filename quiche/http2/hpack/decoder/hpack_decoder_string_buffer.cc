@@ -50,7 +50,9 @@ std::ostream& operator<<(std::ostream& out,
 }
 
 HpackDecoderStringBuffer::HpackDecoderStringBuffer()
-    : remaining_len_(0),
+    : huffman_literal_cache_(nullptr),
+      len_(0),
+      remaining_len_(0),
       is_huffman_encoded_(false),
       state_(State::RESET),
       backing_(Backing::RESET) {}
@@ -76,6 +78,7 @@ void HpackDecoderStringBuffer::OnStart(bool huffman_encoded, size_t len) {
   QUICHE_DVLOG(2) << "HpackDecoderStringBuffer::OnStart";
   QUICHE_DCHECK_EQ(state_, State::RESET);
 
+  len_ = len;
   remaining_len_ = len;
   is_huffman_encoded_ = huffman_encoded;
   state_ = State::COLLECTING;
@@ -114,6 +117,20 @@ bool HpackDecoderStringBuffer::OnData(const char* data, size_t len) {
 
   if (is_huffman_encoded_) {
     QUICHE_DCHECK_EQ(backing_, Backing::BUFFERED);
+    if (huffman_literal_cache_ != nullptr && len == len_) {
+      // The whole string is available, so the cache can be used.
+      const absl::string_view encoded(data, len);
+      if (huffman_literal_cache_->Lookup(encoded, &buffer_)) {
+        return true;
+      }
+      if (!decoder_.Decode(encoded, &buffer_)) {
+        return false;
+      }
+      if (decoder_.InputProperlyTerminated()) {
+        huffman_literal_cache_->Insert(encoded, buffer_);
+      }
+      return true;
+    }
     return decoder_.Decode(absl::string_view(data, len), &buffer_);
   }
 
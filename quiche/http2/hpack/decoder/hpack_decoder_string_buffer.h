@@ -16,6 +16,7 @@
 
 #include "absl/strings/string_view.h"
 #include "quiche/http2/hpack/huffman/hpack_huffman_decoder.h"
+#include "quiche/http2/hpack/huffman/hpack_huffman_literal_cache.h"
 #include "quiche/common/platform/api/quiche_export.h"
 
 namespace http2 {
@@ -31,6 +32,13 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderStringBuffer {
   HpackDecoderStringBuffer(const HpackDecoderStringBuffer&) = delete;
   HpackDecoderStringBuffer& operator=(const HpackDecoderStringBuffer&) = delete;
 
+  // Huffman encoded strings received whole in a single call to OnData are
+  // looked up in and added to |cache|, which must outlive this object.
+  // Disabled if |cache| is nullptr, which is the default.
+  void set_huffman_literal_cache(HpackHuffmanLiteralCache* cache) {
+    huffman_literal_cache_ = cache;
+  }
+
   void Reset();
   void Set(absl::string_view value, bool is_static);
 
@@ -80,6 +88,12 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderStringBuffer {
   // The decoder to use if the string is Huffman encoded.
   HpackHuffmanDecoder decoder_;
 
+  // Cache of decoded Huffman encoded strings, or nullptr.
+  HpackHuffmanLiteralCache* huffman_literal_cache_;
+
+  // Length of the string passed to OnStart.
+  size_t len_;
+
   // Count of bytes not yet passed to OnData.
   size_t remaining_len_;
 
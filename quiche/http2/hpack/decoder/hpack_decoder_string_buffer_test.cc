@@ -243,6 +243,49 @@ TEST_F(HpackDecoderStringBufferTest, InvalidHuffmanOnEnd) {
   QUICHE_LOG(INFO) << buf_;
 }
 
+TEST_F(HpackDecoderStringBufferTest, HuffmanLiteralCache) {
+  std::string encoded = absl::HexStringToBytes("f1e3c2e5f23a6ba0ab90f4ff");
+  absl::string_view decoded("www.example.com");
+  HpackHuffmanLiteralCache cache;
+  buf_.set_huffman_literal_cache(&cache);
+
+  // Split strings are not cached.
+  buf_.OnStart(/*huffman_encoded*/ true, encoded.size());
+  EXPECT_TRUE(buf_.OnData(encoded.data(), 5));
+  EXPECT_TRUE(buf_.OnData(encoded.data() + 5, encoded.size() - 5));
+  EXPECT_TRUE(buf_.OnEnd());
+  EXPECT_EQ(decoded, buf_.str());
+  buf_.Reset();
+  std::string cached;
+  EXPECT_FALSE(cache.Lookup(encoded, &cached));
+
+  // Whole strings are.
+  buf_.OnStart(/*huffman_encoded*/ true, encoded.size());
+  EXPECT_TRUE(buf_.OnData(encoded.data(), encoded.size()));
+  EXPECT_TRUE(buf_.OnEnd());
+  EXPECT_EQ(decoded, buf_.str());
+  buf_.Reset();
+  EXPECT_TRUE(cache.Lookup(encoded, &cached));
+  EXPECT_EQ(decoded, cached);
+
+  // A cache hit produces the same result.
+  buf_.OnStart(/*huffman_encoded*/ true, encoded.size());
+  EXPECT_TRUE(buf_.OnData(encoded.data(), encoded.size()));
+  EXPECT_EQ(backing(), Backing::BUFFERED);
+  EXPECT_TRUE(buf_.OnEnd());
+  EXPECT_EQ(state(), State::COMPLETE);
+  EXPECT_EQ(decoded, buf_.str());
+  EXPECT_EQ(decoded, buf_.ReleaseString());
+
+  // Improperly terminated strings are not cached, and still fail.
+  std::string invalid = absl::HexStringToBytes("00");
+  buf_.OnStart(/*huffman_encoded*/ true, invalid.size());
+  EXPECT_TRUE(buf_.OnData(invalid.data(), invalid.size()));
+  EXPECT_FALSE(buf_.OnEnd());
+  cached.clear();
+  EXPECT_FALSE(cache.Lookup(invalid, &cached));
+}
+
 // TODO(jamessynge): Add tests for ReleaseString().
 
 }  // namespace
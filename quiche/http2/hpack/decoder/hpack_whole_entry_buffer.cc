@@ -28,6 +28,12 @@ void HpackWholeEntryBuffer::set_max_string_size_bytes(
   max_string_size_bytes_ = max_string_size_bytes;
 }
 
+void HpackWholeEntryBuffer::set_huffman_literal_cache(
+    HpackHuffmanLiteralCache* cache) {
+  name_.set_huffman_literal_cache(cache);
+  value_.set_huffman_literal_cache(cache);
+}
+
 void HpackWholeEntryBuffer::BufferStringsIfUnbuffered() {
   name_.BufferStringIfUnbuffered();
   value_.BufferStringIfUnbuffered();
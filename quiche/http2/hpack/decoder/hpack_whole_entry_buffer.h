@@ -52,6 +52,10 @@ class QUICHE_EXPORT_PRIVATE HpackWholeEntryBuffer
   // a single header entry?
   void set_max_string_size_bytes(size_t max_string_size_bytes);
 
+  // Enables caching of decoded Huffman encoded names and values in |cache|,
+  // which must outlive this object.  See HpackHuffmanLiteralCache.
+  void set_huffman_literal_cache(HpackHuffmanLiteralCache* cache);
+
   // Ensure that decoded strings pointed to by the HpackDecoderStringBuffer
   // instances name_ and value_ are buffered, which allows any underlying
   // transport buffer to be freed or reused without overwriting the decoded
@@ -0,0 +1,135 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/http2/hpack/huffman/hpack_huffman_literal_cache.h"
+
+#include <cstring>
+
+#include "absl/hash/hash.h"
+
+namespace http2 {
+namespace {
+
+size_t RoundUpToPowerOfTwo(size_t n) {
+  size_t result = 1;
+  while (result < n) {
+    result <<= 1;
+  }
+  return result;
+}
+
+}  // namespace
+
+HpackHuffmanLiteralCache::HpackHuffmanLiteralCache(size_t num_slots)
+    : mask_(RoundUpToPowerOfTwo(num_slots) - 1),
+      slots_(new Slot[mask_ + 1]) {
+  for (size_t i = 0; i <= mask_; ++i) {
+    for (std::atomic<uint64_t>& word : slots_[i].words) {
+      word.store(0, std::memory_order_relaxed);
+    }
+  }
+}
+
+HpackHuffmanLiteralCache::~HpackHuffmanLiteralCache() = default;
+
+// static
+HpackHuffmanLiteralCache* HpackHuffmanLiteralCache::GlobalInstance() {
+  static HpackHuffmanLiteralCache* const instance =
+      new HpackHuffmanLiteralCache();
+  return instance;
+}
+
+bool HpackHuffmanLiteralCache::Lookup(absl::string_view encoded,
+                                      std::string* decoded) const {
+  if (encoded.empty() || encoded.size() > kSlotBytes) {
+    return false;
+  }
+  const Slot& slot = SlotFor(encoded);
+  const uint32_t sequence = slot.sequence.load(std::memory_order_acquire);
+  if (sequence & 1) {
+    return false;
+  }
+  const uint32_t lengths = slot.lengths.load(std::memory_order_relaxed);
+  const size_t encoded_length = lengths & 0xffff;
+  const size_t decoded_length = lengths >> 16;
+  if (encoded_length != encoded.size() ||
+      encoded_length + decoded_length > kSlotBytes) {
+    return false;
+  }
+
+  uint64_t copy[kSlotWords];
+  const size_t num_words =
+      (encoded_length + decoded_length + sizeof(uint64_t) - 1) /
+      sizeof(uint64_t);
+  for (size_t i = 0; i < num_words; ++i) {
+    copy[i] = slot.words[i].load(std::memory_order_relaxed);
+  }
+  std::atomic_thread_fence(std::memory_order_acquire);
+  if (slot.sequence.load(std::memory_order_relaxed) != sequence) {
+    return false;
+  }
+
+  const char* bytes = reinterpret_cast<const char*>(copy);
+  if (absl::string_view(bytes, encoded_length) != encoded) {
+    return false;
+  }
+  decoded->append(bytes + encoded_length, decoded_length);
+  return true;
+}
+
+void HpackHuffmanLiteralCache::Insert(absl::string_view encoded,
+                                      absl::string_view decoded) {
+  if (encoded.empty() || encoded.size() + decoded.size() > kSlotBytes) {
+    return;
+  }
+  Slot& slot = SlotFor(encoded);
+  uint32_t sequence = slot.sequence.load(std::memory_order_relaxed);
+  if ((sequence & 1) ||
+      !slot.sequence.compare_exchange_strong(sequence, sequence + 1,
+                                             std::memory_order_relaxed)) {
+    // Another thread is writing to this slot.
+    return;
+  }
+  std::atomic_thread_fence(std::memory_order_release);
+
+  uint64_t copy[kSlotWords];
+  char* bytes = reinterpret_cast<char*>(copy);
+  memcpy(bytes, encoded.data(), encoded.size());
+  memcpy(bytes + encoded.size(), decoded.data(), decoded.size());
+  const size_t total_length = encoded.size() + decoded.size();
+  memset(bytes + total_length, 0, sizeof(copy) - total_length);
+  const size_t num_words =
+      (total_length + sizeof(uint64_t) - 1) / sizeof(uint64_t);
+  for (size_t i = 0; i < num_words; ++i) {
+    slot.words[i].store(copy[i], std::memory_order_relaxed);
+  }
+  slot.lengths.store(
+      static_cast<uint32_t>(encoded.size() | (decoded.size() << 16)),
+      std::memory_order_relaxed);
+
+  slot.sequence.store(sequence + 2, std::memory_order_release);
+}
+
+bool HpackHuffmanLiteralCache::Decode(absl::string_view encoded,
+                                      HpackHuffmanDecoder* decoder,
+                                      std::string* decoded) {
+  if (Lookup(encoded, decoded)) {
+    return true;
+  }
+  const size_t original_size = decoded->size();
+  decoder->Reset();
+  if (!decoder->Decode(encoded, decoded) ||
+      !decoder->InputProperlyTerminated()) {
+    return false;
+  }
+  Insert(encoded, absl::string_view(*decoded).substr(original_size));
+  return true;
+}
+
+HpackHuffmanLiteralCache::Slot& HpackHuffmanLiteralCache::SlotFor(
+    absl::string_view encoded) const {
+  return slots_[absl::Hash<absl::string_view>()(encoded) & mask_];
+}
+
+}  // namespace http2
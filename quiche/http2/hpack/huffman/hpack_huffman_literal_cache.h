@@ -0,0 +1,93 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_LITERAL_CACHE_H_
+#define QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_LITERAL_CACHE_H_
+
+// HpackHuffmanLiteralCache remembers recently decoded Huffman encoded
+// literals, keyed by their encoded bytes, so that a literal sent
+// byte-for-byte identically on many connections (e.g. the user-agent or accept
+// header of a popular browser) is decoded only once.  It can be shared by any
+// number of HPACK and QPACK decoders on any number of threads.
+//
+// The cache is a fixed size, direct mapped table of slots, so its memory use is
+// bounded and independent of the input.  Each slot is protected by a sequence
+// counter: lookups never block or write to shared memory, and a lookup that
+// races with an insertion into the same slot reports a miss instead of
+// retrying.  Insertions that find the slot being written by another thread are
+// dropped.
+
+#include <stddef.h>
+
+#include <atomic>
+#include <cstdint>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quiche/http2/hpack/huffman/hpack_huffman_decoder.h"
+#include "quiche/common/platform/api/quiche_export.h"
+
+namespace http2 {
+
+class QUICHE_EXPORT_PRIVATE HpackHuffmanLiteralCache {
+ public:
+  // Number of bytes available in each slot for the encoded string followed by
+  // the decoded string.  Longer literals are not cached.
+  static constexpr size_t kSlotBytes = 128;
+
+  // Default number of slots, using about 136 KB.
+  static constexpr size_t kDefaultNumSlots = 1024;
+
+  // |num_slots| is rounded up to a power of two.
+  explicit HpackHuffmanLiteralCache(size_t num_slots = kDefaultNumSlots);
+  ~HpackHuffmanLiteralCache();
+
+  HpackHuffmanLiteralCache(const HpackHuffmanLiteralCache&) = delete;
+  HpackHuffmanLiteralCache& operator=(const HpackHuffmanLiteralCache&) =
+      delete;
+
+  // Returns an instance shared by the whole process.  It is never destroyed.
+  static HpackHuffmanLiteralCache* GlobalInstance();
+
+  // If the decoding of |encoded| is cached, appends it to |*decoded| and
+  // returns true.  Otherwise returns false and leaves |*decoded| unchanged.
+  bool Lookup(absl::string_view encoded, std::string* decoded) const;
+
+  // Caches |decoded| as the decoding of |encoded|, replacing whatever shares
+  // its slot.  |decoded| must be the complete and valid decoding of |encoded|.
+  void Insert(absl::string_view encoded, absl::string_view decoded);
+
+  // Appends the decoding of the complete Huffman encoded string |encoded| to
+  // |*decoded|, using |*decoder| on a cache miss.  Returns false if |encoded|
+  // is not properly encoded and terminated, in which case the content of
+  // |*decoded| is unspecified.
+  bool Decode(absl::string_view encoded, HpackHuffmanDecoder* decoder,
+              std::string* decoded);
+
+  size_t num_slots() const { return mask_ + 1; }
+
+ private:
+  static constexpr size_t kSlotWords = kSlotBytes / sizeof(uint64_t);
+
+  // The contents of a slot are stored in atomic words so that a reader racing
+  // with a writer reads stale or torn, but well defined, values, which the
+  // sequence check then discards.
+  struct Slot {
+    // Odd while an insertion is in progress.
+    std::atomic<uint32_t> sequence{0};
+    // Encoded length in the low 16 bits, decoded length in the high 16 bits.
+    std::atomic<uint32_t> lengths{0};
+    std::atomic<uint64_t> words[kSlotWords];
+  };
+
+  Slot& SlotFor(absl::string_view encoded) const;
+
+  const size_t mask_;
+  std::unique_ptr<Slot[]> slots_;
+};
+
+}  // namespace http2
+
+#endif  // QUICHE_HTTP2_HPACK_HUFFMAN_HPACK_HUFFMAN_LITERAL_CACHE_H_
@@ -0,0 +1,171 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/http2/hpack/huffman/hpack_huffman_literal_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/http2/hpack/huffman/hpack_huffman_encoder.h"
+#include "quiche/common/platform/api/quiche_test.h"
+#include "quiche/common/platform/api/quiche_thread.h"
+
+namespace http2 {
+namespace test {
+namespace {
+
+std::string Encode(absl::string_view plain) {
+  std::string encoded;
+  HuffmanEncodeFast(plain, HuffmanSize(plain), &encoded);
+  return encoded;
+}
+
+TEST(HpackHuffmanLiteralCacheTest, InsertAndLookup) {
+  HpackHuffmanLiteralCache cache;
+  const std::string encoded = Encode("text/html");
+
+  std::string decoded = "prefix";
+  EXPECT_FALSE(cache.Lookup(encoded, &decoded));
+  EXPECT_EQ("prefix", decoded);
+
+  cache.Insert(encoded, "text/html");
+  EXPECT_TRUE(cache.Lookup(encoded, &decoded));
+  EXPECT_EQ("prefixtext/html", decoded);
+
+  // Only identical encoded bytes match.
+  decoded.clear();
+  EXPECT_FALSE(cache.Lookup(Encode("text/htm"), &decoded));
+  EXPECT_FALSE(cache.Lookup(Encode("text/htmll"), &decoded));
+  EXPECT_TRUE(decoded.empty());
+}
+
+TEST(HpackHuffmanLiteralCacheTest, NumSlots) {
+  EXPECT_EQ(HpackHuffmanLiteralCache::kDefaultNumSlots,
+            HpackHuffmanLiteralCache().num_slots());
+  EXPECT_EQ(1u, HpackHuffmanLiteralCache(1).num_slots());
+  EXPECT_EQ(8u, HpackHuffmanLiteralCache(5).num_slots());
+}
+
+TEST(HpackHuffmanLiteralCacheTest, CollidingEntryIsReplaced) {
+  HpackHuffmanLiteralCache cache(1);
+  const std::string encoded1 = Encode("gzip, deflate");
+  const std::string encoded2 = Encode("en-US,en;q=0.9");
+
+  cache.Insert(encoded1, "gzip, deflate");
+  cache.Insert(encoded2, "en-US,en;q=0.9");
+
+  std::string decoded;
+  EXPECT_FALSE(cache.Lookup(encoded1, &decoded));
+  EXPECT_TRUE(cache.Lookup(encoded2, &decoded));
+  EXPECT_EQ("en-US,en;q=0.9", decoded);
+}
+
+TEST(HpackHuffmanLiteralCacheTest, LongLiteralsAreNotCached) {
+  HpackHuffmanLiteralCache cache;
+  const std::string plain(HpackHuffmanLiteralCache::kSlotBytes, 'a');
+  const std::string encoded = Encode(plain);
+
+  cache.Insert(encoded, plain);
+  std::string decoded;
+  EXPECT_FALSE(cache.Lookup(encoded, &decoded));
+
+  // The longest such literal that fits.
+  const std::string short_plain = plain.substr(0, 78);
+  const std::string short_encoded = Encode(short_plain);
+  ASSERT_GE(HpackHuffmanLiteralCache::kSlotBytes,
+            short_encoded.size() + short_plain.size());
+  ASSERT_LT(HpackHuffmanLiteralCache::kSlotBytes,
+            Encode(plain.substr(0, 79)).size() + 79);
+  cache.Insert(short_encoded, short_plain);
+  EXPECT_TRUE(cache.Lookup(short_encoded, &decoded));
+  EXPECT_EQ(short_plain, decoded);
+}
+
+TEST(HpackHuffmanLiteralCacheTest, Decode) {
+  HpackHuffmanLiteralCache cache;
+  HpackHuffmanDecoder decoder;
+  const std::string plain = "Mozilla/5.0 (X11; Linux x86_64)";
+  const std::string encoded = Encode(plain);
+
+  std::string decoded;
+  EXPECT_TRUE(cache.Decode(encoded, &decoder, &decoded));
+  EXPECT_EQ(plain, decoded);
+
+  // The second time, the result comes from the cache.
+  decoded.clear();
+  EXPECT_TRUE(cache.Lookup(encoded, &decoded));
+  EXPECT_EQ(plain, decoded);
+  decoded.clear();
+  EXPECT_TRUE(cache.Decode(encoded, &decoder, &decoded));
+  EXPECT_EQ(plain, decoded);
+}
+
+TEST(HpackHuffmanLiteralCacheTest, DecodeError) {
+  HpackHuffmanLiteralCache cache;
+  HpackHuffmanDecoder decoder;
+
+  // More than 7 bits of padding.
+  const std::string encoded = Encode("a") + "\xff";
+  std::string decoded;
+  EXPECT_FALSE(cache.Decode(encoded, &decoder, &decoded));
+
+  // Errors are not cached.
+  decoded.clear();
+  EXPECT_FALSE(cache.Lookup(encoded, &decoded));
+}
+
+class LookupThread : public quiche::QuicheThread {
+ public:
+  LookupThread(HpackHuffmanLiteralCache* cache,
+               const std::vector<std::string>* plain)
+      : QuicheThread("LookupThread"), cache_(cache), plain_(plain) {}
+
+  void Run() override {
+    HpackHuffmanDecoder decoder;
+    for (int i = 0; i < 1000; ++i) {
+      for (const std::string& plain : *plain_) {
+        std::string decoded;
+        if (!cache_->Decode(Encode(plain), &decoder, &decoded) ||
+            decoded != plain) {
+          ++errors_;
+        }
+      }
+    }
+  }
+
+  int errors() const { return errors_; }
+
+ private:
+  HpackHuffmanLiteralCache* const cache_;
+  const std::vector<std::string>* const plain_;
+  int errors_ = 0;
+};
+
+// Lookups racing with insertions into the same slots never return a torn
+// entry.
+TEST(HpackHuffmanLiteralCacheTest, ConcurrentAccess) {
+  HpackHuffmanLiteralCache cache(4);
+  std::vector<std::string> plain;
+  for (int i = 0; i < 16; ++i) {
+    plain.push_back(absl::StrCat("value-", i, std::string(i * 4, 'x')));
+  }
+
+  std::vector<std::unique_ptr<LookupThread>> threads;
+  for (int i = 0; i < 4; ++i) {
+    threads.push_back(std::make_unique<LookupThread>(&cache, &plain));
+  }
+  for (auto& thread : threads) {
+    thread->Start();
+  }
+  for (auto& thread : threads) {
+    thread->Join();
+    EXPECT_EQ(0, thread->errors());
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace http2
@@ -5,6 +5,8 @@
 #include "quiche/quic/core/congestion_control/bandwidth_sampler.h"
 
 #include <algorithm>
+#include <cstdint>
+#include <limits>
 
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
@@ -14,6 +16,40 @@
 
 namespace quic {
 
+namespace {
+
+bool FitsInUint32(uint64_t value) {
+  return value <= std::numeric_limits<uint32_t>::max();
+}
+
+// The offsets of the most recently acknowledged packet only overflow if
+// nothing was acked for over an hour, or if 4 GiB were sent after it, which the
+// congestion window prevents.  They saturate rather than start a new epoch.
+uint32_t SaturatedOffset(uint64_t value) {
+  return FitsInUint32(value) ? value : std::numeric_limits<uint32_t>::max();
+}
+
+uint32_t TimeOffsetUs(QuicTime from, QuicTime to) {
+  if (from == QuicTime::Zero()) {
+    // QuicTime::Zero() means that the sampler did not know the time.
+    return std::numeric_limits<uint32_t>::max();
+  }
+  const int64_t offset = (to - from).ToMicroseconds();
+  if (offset <= 0) {
+    return 0;
+  }
+  return std::min<uint64_t>(offset, std::numeric_limits<uint32_t>::max() - 1);
+}
+
+QuicTime TimeBefore(QuicTime time, uint32_t offset_us) {
+  if (offset_us == std::numeric_limits<uint32_t>::max()) {
+    return QuicTime::Zero();
+  }
+  return time - QuicTime::Delta::FromMicroseconds(offset_us);
+}
+
+}  // namespace
+
 std::ostream& operator<<(std::ostream& os, const SendTimeState& s) {
   os << "{valid:" << s.is_valid << ", app_limited:" << s.is_app_limited
      << ", total_sent:" << s.total_bytes_sent
@@ -142,6 +178,7 @@ BandwidthSampler::BandwidthSampler(
       last_acked_packet_ack_time_(QuicTime::Zero()),
       is_app_limited_(true),
       connection_state_map_(),
+      first_state_origin_epoch_(0),
       max_tracked_packets_(GetQuicFlag(FLAGS_quic_max_tracked_packet_count)),
       unacked_packet_map_(unacked_packet_map),
       max_ack_height_tracker_(max_height_tracker_window_length),
@@ -163,6 +200,8 @@ BandwidthSampler::BandwidthSampler(const BandwidthSampler& other)
       is_app_limited_(other.is_app_limited_),
       end_of_app_limited_phase_(other.end_of_app_limited_phase_),
       connection_state_map_(other.connection_state_map_),
+      state_origins_(other.state_origins_),
+      first_state_origin_epoch_(other.first_state_origin_epoch_),
       recent_ack_points_(other.recent_ack_points_),
       a0_candidates_(other.a0_candidates_),
       max_tracked_packets_(other.max_tracked_packets_),
@@ -257,8 +296,9 @@ void BandwidthSampler::OnPacketSent(
     }
   }
 
-  bool success = connection_state_map_.Emplace(packet_number, sent_time, bytes,
-                                               bytes_in_flight + bytes, *this);
+  bool success = connection_state_map_.Emplace(
+      packet_number,
+      PackConnectionState(sent_time, bytes, bytes_in_flight + bytes));
   QUIC_BUG_IF(quic_bug_10437_3, !success)
       << "BandwidthSampler failed to insert the packet "
          "into the map, most likely because it's already "
@@ -267,7 +307,7 @@ void BandwidthSampler::OnPacketSent(
 
 void BandwidthSampler::OnPacketNeutered(QuicPacketNumber packet_number) {
   connection_state_map_.Remove(
-      packet_number, [&](const ConnectionStateOnSentPacket& sent_packet) {
+      packet_number, [&](const PackedConnectionState& sent_packet) {
         QUIC_CODE_COUNT(quic_bandwidth_sampler_packet_neutered);
         total_bytes_neutered_ += sent_packet.size;
       });
@@ -381,14 +421,14 @@ QuicByteCount BandwidthSampler::OnAckEventEnd(
 BandwidthSample BandwidthSampler::OnPacketAcknowledged(
     QuicTime ack_time, QuicPacketNumber packet_number) {
   last_acked_packet_ = packet_number;
-  ConnectionStateOnSentPacket* sent_packet_pointer =
+  const PackedConnectionState* sent_packet_pointer =
       connection_state_map_.GetEntry(packet_number);
   if (sent_packet_pointer == nullptr) {
     // See the TODO below.
     return BandwidthSample();
   }
-  BandwidthSample sample =
-      OnPacketAcknowledgedInner(ack_time, packet_number, *sent_packet_pointer);
+  BandwidthSample sample = OnPacketAcknowledgedInner(
+      ack_time, packet_number, UnpackConnectionState(*sent_packet_pointer));
   return sample;
 }
 
@@ -528,10 +568,11 @@ SendTimeState BandwidthSampler::OnPacketLost(QuicPacketNumber packet_number,
   SendTimeState send_time_state;
 
   total_bytes_lost_ += bytes_lost;
-  ConnectionStateOnSentPacket* sent_packet_pointer =
+  const PackedConnectionState* sent_packet_pointer =
       connection_state_map_.GetEntry(packet_number);
   if (sent_packet_pointer != nullptr) {
-    SentPacketToSendTimeState(*sent_packet_pointer, &send_time_state);
+    SentPacketToSendTimeState(UnpackConnectionState(*sent_packet_pointer),
+                              &send_time_state);
   }
 
   return send_time_state;
@@ -544,6 +585,103 @@ void BandwidthSampler::SentPacketToSendTimeState(
   send_time_state->is_valid = true;
 }
 
+BandwidthSampler::PackedConnectionState
+BandwidthSampler::PackConnectionState(QuicTime sent_time, QuicByteCount size,
+                                      QuicByteCount bytes_in_flight) {
+  RemoveUnusedStateOrigins();
+  bool fits_in_epoch = false;
+  if (!state_origins_.empty()) {
+    const StateOrigin& origin = state_origins_.back();
+    fits_in_epoch =
+        sent_time >= origin.sent_time &&
+        FitsInUint32((sent_time - origin.sent_time).ToMicroseconds()) &&
+        FitsInUint32(total_bytes_sent_ - origin.total_bytes_sent) &&
+        FitsInUint32(total_bytes_acked_ - origin.total_bytes_acked) &&
+        FitsInUint32(total_bytes_lost_ - origin.total_bytes_lost);
+  }
+  if (!fits_in_epoch) {
+    if (state_origins_.size() > std::numeric_limits<uint8_t>::max()) {
+      QUIC_BUG(quic_bandwidth_sampler_too_many_epochs)
+          << "BandwidthSampler tracks packets from too many epochs.  First "
+             "tracked: "
+          << connection_state_map_.first_packet()
+          << "; last tracked: " << connection_state_map_.last_packet();
+      connection_state_map_.RemoveUpTo(connection_state_map_.last_packet() +
+                                       1);
+      state_origins_.clear();
+    }
+    state_origins_.push_back(StateOrigin{sent_time, total_bytes_sent_,
+                                         total_bytes_acked_,
+                                         total_bytes_lost_});
+  }
+
+  const StateOrigin& origin = state_origins_.back();
+  QUICHE_DCHECK_LE(size, std::numeric_limits<QuicPacketLength>::max());
+  QUICHE_DCHECK(FitsInUint32(bytes_in_flight));
+  PackedConnectionState packed;
+  packed.sent_time_offset_us = (sent_time - origin.sent_time).ToMicroseconds();
+  packed.total_bytes_sent_offset = total_bytes_sent_ - origin.total_bytes_sent;
+  packed.total_bytes_acked_offset =
+      total_bytes_acked_ - origin.total_bytes_acked;
+  packed.total_bytes_lost_offset = total_bytes_lost_ - origin.total_bytes_lost;
+  packed.bytes_in_flight = SaturatedOffset(bytes_in_flight);
+  packed.bytes_sent_after_last_acked_packet = SaturatedOffset(
+      total_bytes_sent_ - total_bytes_sent_at_last_acked_packet_);
+  packed.time_after_last_acked_packet_sent_us =
+      TimeOffsetUs(last_acked_packet_sent_time_, sent_time);
+  packed.time_after_last_acked_packet_ack_us =
+      TimeOffsetUs(last_acked_packet_ack_time_, sent_time);
+  packed.size = size;
+  packed.epoch = first_state_origin_epoch_ + state_origins_.size() - 1;
+  packed.is_app_limited = is_app_limited_;
+  return packed;
+}
+
+BandwidthSampler::ConnectionStateOnSentPacket
+BandwidthSampler::UnpackConnectionState(
+    const PackedConnectionState& packed) const {
+  const uint8_t index = packed.epoch - first_state_origin_epoch_;
+  QUICHE_DCHECK_LT(index, state_origins_.size());
+  const StateOrigin& origin = state_origins_[index];
+
+  ConnectionStateOnSentPacket state;
+  state.sent_time =
+      origin.sent_time +
+      QuicTime::Delta::FromMicroseconds(packed.sent_time_offset_us);
+  state.size = packed.size;
+  state.send_time_state = SendTimeState(
+      packed.is_app_limited,
+      origin.total_bytes_sent + packed.total_bytes_sent_offset,
+      origin.total_bytes_acked + packed.total_bytes_acked_offset,
+      origin.total_bytes_lost + packed.total_bytes_lost_offset,
+      packed.bytes_in_flight);
+  state.total_bytes_sent_at_last_acked_packet =
+      state.send_time_state.total_bytes_sent -
+      packed.bytes_sent_after_last_acked_packet;
+  state.last_acked_packet_sent_time =
+      TimeBefore(state.sent_time, packed.time_after_last_acked_packet_sent_us);
+  state.last_acked_packet_ack_time =
+      TimeBefore(state.sent_time, packed.time_after_last_acked_packet_ack_us);
+  return state;
+}
+
+void BandwidthSampler::RemoveUnusedStateOrigins() {
+  if (connection_state_map_.IsEmpty()) {
+    state_origins_.clear();
+    return;
+  }
+  const PackedConnectionState* first =
+      connection_state_map_.GetEntry(connection_state_map_.first_packet());
+  if (first == nullptr) {
+    return;
+  }
+  while (state_origins_.size() > 1 &&
+         first_state_origin_epoch_ != first->epoch) {
+    state_origins_.pop_front();
+    ++first_state_origin_epoch_;
+  }
+}
+
 void BandwidthSampler::OnAppLimited() {
   is_app_limited_ = true;
   end_of_app_limited_phase_ = last_sent_packet_;
@@ -5,6 +5,8 @@
 #ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_BANDWIDTH_SAMPLER_H_
 #define QUICHE_QUIC_CORE_CONGESTION_CONTROL_BANDWIDTH_SAMPLER_H_
 
+#include <cstdint>
+
 #include "quiche/quic/core/congestion_control/send_algorithm_interface.h"
 #include "quiche/quic/core/congestion_control/windowed_filter.h"
 #include "quiche/quic/core/packet_number_indexed_queue.h"
@@ -453,7 +455,7 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
   // ConnectionStateOnSentPacket represents the information about a sent packet
   // and the state of the connection at the moment the packet was sent,
   // specifically the information about the most recently acknowledged packet at
-  // that moment.
+  // that moment.  It is stored as a PackedConnectionState.
   struct QUIC_EXPORT_PRIVATE ConnectionStateOnSentPacket {
     // Time at which the packet is sent.
     QuicTime sent_time;
@@ -477,24 +479,6 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
     // packet is acked or lost.
     SendTimeState send_time_state;
 
-    // Snapshot constructor. Records the current state of the bandwidth
-    // sampler.
-    // |bytes_in_flight| is the bytes in flight right after the packet is sent.
-    ConnectionStateOnSentPacket(QuicTime sent_time, QuicByteCount size,
-                                QuicByteCount bytes_in_flight,
-                                const BandwidthSampler& sampler)
-        : sent_time(sent_time),
-          size(size),
-          total_bytes_sent_at_last_acked_packet(
-              sampler.total_bytes_sent_at_last_acked_packet_),
-          last_acked_packet_sent_time(sampler.last_acked_packet_sent_time_),
-          last_acked_packet_ack_time(sampler.last_acked_packet_ack_time_),
-          send_time_state(sampler.is_app_limited_, sampler.total_bytes_sent_,
-                          sampler.total_bytes_acked_, sampler.total_bytes_lost_,
-                          bytes_in_flight) {}
-
-    // Default constructor.  Required to put this structure into
-    // PacketNumberIndexedQueue.
     ConnectionStateOnSentPacket()
         : sent_time(QuicTime::Zero()),
           size(0),
@@ -514,6 +498,48 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
     }
   };
 
+  // The origin of the times and byte counters of the packets sent during an
+  // epoch.  A new epoch starts whenever the offset of a packet from the
+  // current origin does not fit into 32 bits, i.e. after about 71 minutes or
+  // 4 GiB.
+  struct QUIC_NO_EXPORT StateOrigin {
+    QuicTime sent_time;
+    QuicByteCount total_bytes_sent;
+    QuicByteCount total_bytes_acked;
+    QuicByteCount total_bytes_lost;
+  };
+
+  // The ConnectionStateOnSentPacket of a packet in flight, in 36 bytes instead
+  // of 80.  The connection-wide times and counters are stored as offsets from
+  // the StateOrigin of |epoch|.  Those of the most recently acknowledged packet
+  // are stored relative to this packet, as they are always older and close.
+  struct QUIC_NO_EXPORT PackedConnectionState {
+    uint32_t sent_time_offset_us;
+    uint32_t total_bytes_sent_offset;
+    uint32_t total_bytes_acked_offset;
+    uint32_t total_bytes_lost_offset;
+    uint32_t bytes_in_flight;
+    // Bytes sent since the last acked packet was sent, including this packet.
+    uint32_t bytes_sent_after_last_acked_packet;
+    // Time since the last acked packet was sent, and since it was acked, or
+    // the maximum value if the sampler did not know that time.
+    uint32_t time_after_last_acked_packet_sent_us;
+    uint32_t time_after_last_acked_packet_ack_us;
+    QuicPacketLength size;
+    uint8_t epoch;
+    bool is_app_limited;
+  };
+
+  // Encodes the current state of the sampler for a packet sent at |sent_time|,
+  // starting a new epoch if needed.
+  PackedConnectionState PackConnectionState(QuicTime sent_time,
+                                            QuicByteCount size,
+                                            QuicByteCount bytes_in_flight);
+  ConnectionStateOnSentPacket UnpackConnectionState(
+      const PackedConnectionState& packed) const;
+  // Drops the origins of the epochs that no tracked packet was sent in.
+  void RemoveUnusedStateOrigins();
+
   BandwidthSample OnPacketAcknowledged(QuicTime ack_time,
                                        QuicPacketNumber packet_number);
 
@@ -578,7 +604,11 @@ class QUIC_EXPORT_PRIVATE BandwidthSampler : public BandwidthSamplerInterface {
 
   // Record of the connection state at the point where each packet in flight was
   // sent, indexed by the packet number.
-  PacketNumberIndexedQueue<ConnectionStateOnSentPacket> connection_state_map_;
+  PacketNumberIndexedQueue<PackedConnectionState> connection_state_map_;
+  // Origins of the epochs of the packets in |connection_state_map_|, oldest
+  // first.  The epoch of the front one is |first_state_origin_epoch_|.
+  quiche::QuicheCircularDeque<StateOrigin> state_origins_;
+  uint8_t first_state_origin_epoch_;
 
   RecentAckPoints recent_ack_points_;
   quiche::QuicheCircularDeque<AckPoint> a0_candidates_;
@@ -28,6 +28,10 @@ class BandwidthSamplerPeer {
                                      QuicPacketNumber packet_number) {
     return sampler.connection_state_map_.GetEntry(packet_number)->size;
   }
+
+  static size_t GetNumberOfEpochs(const BandwidthSampler& sampler) {
+    return sampler.state_origins_.size();
+  }
 };
 
 const QuicByteCount kRegularPacketSize = 1280;
@@ -581,6 +585,38 @@ TEST_P(BandwidthSamplerTest, RemoveObsoletePackets) {
   EXPECT_EQ(0u, BandwidthSamplerPeer::GetNumberOfTrackedPackets(sampler_));
 }
 
+// Packets sent over 2^32 microseconds apart are stored relative to different
+// origins.
+TEST_P(BandwidthSamplerTest, SendTimeStateAcrossEpochs) {
+  const QuicTime::Delta epoch_length = QuicTime::Delta::FromSeconds(72 * 60);
+  SendPacket(1);
+  clock_.AdvanceTime(epoch_length);
+  SendPacket(2);
+  EXPECT_EQ(2u, BandwidthSamplerPeer::GetNumberOfEpochs(sampler_));
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10));
+
+  LosePacket(1);
+  sampler_.RemoveObsoletePackets(QuicPacketNumber(2));
+  SendPacket(3);
+  // Packet 1 was the only one sent in the first epoch.
+  EXPECT_EQ(1u, BandwidthSamplerPeer::GetNumberOfEpochs(sampler_));
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(10));
+
+  BandwidthSample sample = AckPacketInner(2);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(20), sample.rtt);
+  EXPECT_EQ(PacketsToBytes(2), sample.state_at_send.total_bytes_sent);
+  EXPECT_EQ(0u, sample.state_at_send.total_bytes_lost);
+  EXPECT_EQ(PacketsToBytes(2), sample.state_at_send.bytes_in_flight);
+
+  sample = AckPacketInner(3);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(10), sample.rtt);
+  EXPECT_EQ(PacketsToBytes(3), sample.state_at_send.total_bytes_sent);
+  EXPECT_EQ(PacketsToBytes(1), sample.state_at_send.total_bytes_lost);
+  EXPECT_EQ(PacketsToBytes(2), sample.state_at_send.bytes_in_flight);
+  sampler_.RemoveObsoletePackets(QuicPacketNumber(4));
+  EXPECT_EQ(0u, BandwidthSamplerPeer::GetNumberOfTrackedPackets(sampler_));
+}
+
 TEST_P(BandwidthSamplerTest, NeuterPacket) {
   SendPacket(1);
   EXPECT_EQ(0u, sampler_.total_bytes_neutered());
@@ -0,0 +1,631 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/congestion_control/pcc_sender.h"
+
+#include <algorithm>
+#include <cmath>
+#include <sstream>
+#include <string>
+#include <utility>
+
+#include "quiche/quic/core/congestion_control/rtt_stats.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Parameters of the utility function, from the PCC Vivace paper.
+const float kUtilityExponent = 0.9f;
+const float kLatencyCoefficient = 900.0f;
+const float kLossCoefficient = 11.35f;
+// RTT gradients of a smaller magnitude are treated as noise.
+const float kRttGradientTolerance = 0.01f;
+
+// PROBING sends |kNumProbingPairs| pairs of MIs, at the current rate times
+// 1 + kProbingStepSize and 1 - kProbingStepSize, in random order.
+const float kProbingStepSize = 0.05f;
+const size_t kNumProbingPairs = 2;
+
+// Converts a utility gradient, in utility per Mbps, into a rate change in
+// Mbps.
+const float kRateChangeFactor = 1.0f;
+// Bounds a single rate change, as a fraction of the current rate.  The bound
+// grows by |kRateChangeAllowanceIncrement| after each consecutive change in
+// the same direction.
+const float kInitialRateChangeAllowance = 0.05f;
+const float kRateChangeAllowanceIncrement = 0.1f;
+
+// An MI lasts at least one smoothed RTT, and long enough to send this many
+// packets.
+const QuicPacketCount kMinPacketsPerMonitorInterval = 10;
+// An MI whose packets are not all acked or lost this many smoothed RTTs after
+// it ended is scored with the packets accounted for so far.
+const int kMonitorIntervalTimeoutRtts = 4;
+// Bounds the number of MIs tracked when acks stop arriving.
+const size_t kMaxMonitorIntervals = 100;
+
+const QuicByteCount kMinimumCongestionWindow = 4 * kMaxSegmentSize;
+// Outside of STARTING, the congestion window only stops the sender when acks
+// stop arriving, so it is well above the rate times the RTT.
+const float kCongestionWindowGain = 2.0f;
+// Limits how much STARTING overshoots the bandwidth, as BBR does in STARTUP.
+const float kStartingCongestionWindowGain = 2.885f;
+// STARTING ends after this many consecutive MIs score below the best one
+// while showing congestion: a growing RTT, or a loss rate above
+// |kStartingLossRateThreshold|.  The MIs of STARTING are too short for their
+// loss rate to tell random loss apart from congestion below that.
+const size_t kStartingDecreasesBeforeExit = 2;
+const float kStartingLossRateThreshold = 0.1f;
+
+// The length of the bandwidth filter, in round trips.
+const QuicRoundTripCount kBandwidthWindowSize = 10;
+// STARTING ends when the bandwidth estimate grows by less than
+// |kStartingGrowthTarget| for this many round trips.
+const float kStartingGrowthTarget = 1.25f;
+const QuicRoundTripCount kRoundTripsWithoutGrowthBeforeExitingStarting = 3;
+
+float ToMbps(QuicBandwidth bandwidth) {
+  return bandwidth.ToBitsPerSecond() / 1e6f;
+}
+
+QuicBandwidth MinimumSendingRate() {
+  return QuicBandwidth::FromBytesPerSecond(2 * kMaxSegmentSize);
+}
+
+// Returns the slope of the least-squares line through |samples|, or zero if
+// there are not enough samples to fit one.
+float RttGradient(const std::vector<std::pair<int64_t, int64_t>>& samples) {
+  if (samples.size() < 2) {
+    return 0;
+  }
+  double mean_time = 0;
+  double mean_rtt = 0;
+  for (const auto& sample : samples) {
+    mean_time += sample.first;
+    mean_rtt += sample.second;
+  }
+  mean_time /= samples.size();
+  mean_rtt /= samples.size();
+
+  double covariance = 0;
+  double variance = 0;
+  for (const auto& sample : samples) {
+    covariance += (sample.first - mean_time) * (sample.second - mean_rtt);
+    variance += (sample.first - mean_time) * (sample.first - mean_time);
+  }
+  if (variance == 0) {
+    return 0;
+  }
+  return covariance / variance;
+}
+
+float LossRate(const PccSender::MonitorInterval& interval) {
+  const QuicByteCount bytes_accounted =
+      interval.bytes_acked + interval.bytes_lost;
+  if (bytes_accounted == 0) {
+    return 0;
+  }
+  return static_cast<float>(interval.bytes_lost) / bytes_accounted;
+}
+
+std::string ModeToString(PccSender::Mode mode) {
+  switch (mode) {
+    case PccSender::STARTING:
+      return "STARTING";
+    case PccSender::PROBING:
+      return "PROBING";
+    case PccSender::DECISION_MADE:
+      return "DECISION_MADE";
+  }
+  return "???";
+}
+
+}  // namespace
+
+PccSender::PccSender(const RttStats* rtt_stats,
+                     const QuicUnackedPacketMap* unacked_packets,
+                     QuicPacketCount initial_congestion_window,
+                     QuicPacketCount max_congestion_window, QuicRandom* random,
+                     QuicConnectionStats* stats)
+    : rtt_stats_(rtt_stats),
+      unacked_packets_(unacked_packets),
+      random_(random),
+      stats_(stats),
+      mode_(STARTING),
+      sending_rate_(QuicBandwidth::FromBytesAndTimeDelta(
+          initial_congestion_window * kDefaultTCPMSS,
+          rtt_stats->SmoothedOrInitialRtt())),
+      rate_change_amplifier_(0),
+      rate_change_proportion_allowance_(kInitialRateChangeAllowance),
+      sampler_(unacked_packets, kBandwidthWindowSize),
+      max_bandwidth_(kBandwidthWindowSize, QuicBandwidth::Zero(), 0),
+      round_trip_count_(0),
+      has_non_app_limited_sample_(false),
+      bandwidth_at_last_round_(QuicBandwidth::Zero()),
+      rounds_without_bandwidth_gain_(0),
+      initial_congestion_window_(initial_congestion_window * kDefaultTCPMSS),
+      max_congestion_window_(max_congestion_window * kDefaultTCPMSS) {}
+
+PccSender::~PccSender() {}
+
+bool PccSender::InSlowStart() const { return mode_ == STARTING; }
+
+bool PccSender::InRecovery() const { return false; }
+
+bool PccSender::ShouldSendProbingPacket() const { return false; }
+
+void PccSender::SetFromConfig(const QuicConfig& /*config*/,
+                              Perspective /*perspective*/) {}
+
+void PccSender::ApplyConnectionOptions(
+    const QuicTagVector& /*connection_options*/) {}
+
+void PccSender::AdjustNetworkParameters(const NetworkParams& params) {
+  if (mode_ != STARTING || params.bandwidth.IsZero()) {
+    return;
+  }
+  // The rate is already known, so start learning from it instead of
+  // doubling.
+  SetSendingRate(params.bandwidth);
+  EnterProbing();
+}
+
+void PccSender::SetInitialCongestionWindowInPackets(
+    QuicPacketCount congestion_window) {
+  if (mode_ != STARTING || !monitor_intervals_.empty() ||
+      !utilities_.empty()) {
+    return;
+  }
+  initial_congestion_window_ = congestion_window * kDefaultTCPMSS;
+  sending_rate_ = QuicBandwidth::FromBytesAndTimeDelta(
+      initial_congestion_window_, rtt_stats_->SmoothedOrInitialRtt());
+}
+
+void PccSender::OnCongestionEvent(bool rtt_updated,
+                                  QuicByteCount /*prior_in_flight*/,
+                                  QuicTime event_time,
+                                  const AckedPacketVector& acked_packets,
+                                  const LostPacketVector& lost_packets) {
+  const QuicByteCount total_bytes_acked_before = sampler_.total_bytes_acked();
+  bool is_round_start = false;
+  if (!acked_packets.empty()) {
+    is_round_start =
+        UpdateRoundTripCounter(acked_packets.rbegin()->packet_number);
+  }
+
+  BandwidthSamplerInterface::CongestionEventSample sample =
+      sampler_.OnCongestionEvent(event_time, acked_packets, lost_packets,
+                                 max_bandwidth_.GetBest(),
+                                 QuicBandwidth::Infinite(), round_trip_count_);
+  if (sample.last_packet_send_state.is_valid) {
+    has_non_app_limited_sample_ |=
+        !sample.last_packet_send_state.is_app_limited;
+    if (stats_) {
+      stats_->has_non_app_limited_sample = has_non_app_limited_sample_;
+    }
+  }
+  if (total_bytes_acked_before != sampler_.total_bytes_acked() &&
+      (!sample.sample_is_app_limited ||
+       sample.sample_max_bandwidth > max_bandwidth_.GetBest())) {
+    max_bandwidth_.Update(sample.sample_max_bandwidth, round_trip_count_);
+  }
+  if (mode_ == STARTING && is_round_start) {
+    CheckIfFullBandwidthReached(sample.last_packet_send_state);
+  }
+
+  for (const AckedPacket& packet : acked_packets) {
+    MonitorInterval* interval = FindMonitorInterval(packet.packet_number);
+    if (interval != nullptr) {
+      interval->bytes_acked += packet.bytes_acked;
+    }
+  }
+  for (const LostPacket& packet : lost_packets) {
+    MonitorInterval* interval = FindMonitorInterval(packet.packet_number);
+    if (interval != nullptr) {
+      interval->bytes_lost += packet.bytes_lost;
+    }
+  }
+  if (rtt_updated && !acked_packets.empty()) {
+    MonitorInterval* interval =
+        FindMonitorInterval(acked_packets.rbegin()->packet_number);
+    if (interval != nullptr) {
+      interval->rtt_samples.emplace_back(
+          (event_time - interval->start_time).ToMicroseconds(),
+          rtt_stats_->latest_rtt().ToMicroseconds());
+    }
+  }
+
+  ProcessCompletedMonitorIntervals(event_time);
+  sampler_.RemoveObsoletePackets(unacked_packets_->GetLeastUnacked());
+}
+
+void PccSender::OnPacketSent(QuicTime sent_time, QuicByteCount bytes_in_flight,
+                             QuicPacketNumber packet_number,
+                             QuicByteCount bytes,
+                             HasRetransmittableData is_retransmittable) {
+  last_sent_packet_ = packet_number;
+  sampler_.OnPacketSent(sent_time, packet_number, bytes, bytes_in_flight,
+                        is_retransmittable);
+  if (is_retransmittable != HAS_RETRANSMITTABLE_DATA) {
+    // Not in flight, so it will never be reported as acked or lost.
+    return;
+  }
+
+  if (monitor_intervals_.empty() ||
+      sent_time >= monitor_intervals_.back().end_time) {
+    StartMonitorInterval(sent_time);
+  }
+  MonitorInterval& interval = monitor_intervals_.back();
+  if (!interval.first_packet_number.IsInitialized()) {
+    interval.first_packet_number = packet_number;
+  }
+  interval.last_packet_number = packet_number;
+  interval.bytes_sent += bytes;
+}
+
+void PccSender::OnPacketNeutered(QuicPacketNumber packet_number) {
+  sampler_.OnPacketNeutered(packet_number);
+  MonitorInterval* interval = FindMonitorInterval(packet_number);
+  if (interval != nullptr && unacked_packets_->IsUnacked(packet_number)) {
+    const QuicByteCount bytes =
+        unacked_packets_->GetTransmissionInfo(packet_number).bytes_sent;
+    interval->bytes_sent -= std::min(bytes, interval->bytes_sent);
+  }
+}
+
+bool PccSender::CanSend(QuicByteCount bytes_in_flight) {
+  return bytes_in_flight < GetCongestionWindow();
+}
+
+QuicBandwidth PccSender::PacingRate(QuicByteCount /*bytes_in_flight*/) const {
+  if (monitor_intervals_.empty()) {
+    return sending_rate_;
+  }
+  return monitor_intervals_.back().sending_rate;
+}
+
+QuicBandwidth PccSender::BandwidthEstimate() const {
+  return max_bandwidth_.GetBest();
+}
+
+QuicByteCount PccSender::GetCongestionWindow() const {
+  QuicByteCount congestion_window;
+  if (mode_ == STARTING) {
+    congestion_window = std::max(
+        initial_congestion_window_,
+        kStartingCongestionWindowGain * max_bandwidth_.GetBest() *
+            rtt_stats_->MinOrInitialRtt());
+  } else {
+    congestion_window = std::max(
+        kMinimumCongestionWindow, kCongestionWindowGain * PacingRate(0) *
+                                      rtt_stats_->SmoothedOrInitialRtt());
+  }
+  return std::min(congestion_window, max_congestion_window_);
+}
+
+QuicByteCount PccSender::GetSlowStartThreshold() const { return 0; }
+
+CongestionControlType PccSender::GetCongestionControlType() const {
+  return kPCC;
+}
+
+std::string PccSender::GetDebugState() const {
+  std::ostringstream stream;
+  stream << "Mode: " << mode_ << std::endl;
+  stream << "Sending rate: " << sending_rate_ << std::endl;
+  stream << "Pacing rate: " << PacingRate(0) << std::endl;
+  stream << "Bandwidth estimate: " << BandwidthEstimate() << std::endl;
+  stream << "Congestion window: " << GetCongestionWindow() << " bytes"
+         << std::endl;
+  stream << "Monitor intervals: " << monitor_intervals_.size() << std::endl;
+  stream << "Rate change amplifier: " << rate_change_amplifier_ << std::endl;
+  return stream.str();
+}
+
+void PccSender::OnApplicationLimited(QuicByteCount bytes_in_flight) {
+  if (bytes_in_flight >= GetCongestionWindow()) {
+    return;
+  }
+  sampler_.OnAppLimited();
+  if (!monitor_intervals_.empty()) {
+    monitor_intervals_.back().is_app_limited = true;
+  }
+}
+
+void PccSender::PopulateConnectionStats(QuicConnectionStats* stats) const {
+  stats->num_ack_aggregation_epochs = sampler_.num_ack_aggregation_epochs();
+}
+
+// static
+float PccSender::ComputeUtility(const MonitorInterval& interval) {
+  const float rate = ToMbps(interval.sending_rate);
+  const float loss_rate = LossRate(interval);
+  float rtt_gradient = RttGradient(interval.rtt_samples);
+  if (std::abs(rtt_gradient) < kRttGradientTolerance) {
+    rtt_gradient = 0;
+  }
+  return std::pow(rate, kUtilityExponent) -
+         kLatencyCoefficient * rate * rtt_gradient -
+         kLossCoefficient * rate * loss_rate;
+}
+
+QuicTime::Delta PccSender::MonitorIntervalDuration(QuicBandwidth rate) const {
+  return std::max(
+      rtt_stats_->SmoothedOrInitialRtt(),
+      rate.TransferTime(kMinPacketsPerMonitorInterval * kDefaultTCPMSS));
+}
+
+void PccSender::StartMonitorInterval(QuicTime sent_time) {
+  if (monitor_intervals_.size() >= kMaxMonitorIntervals) {
+    const bool is_useful = monitor_intervals_.front().is_useful;
+    monitor_intervals_.pop_front();
+    if (is_useful) {
+      OnUsefulIntervalDiscarded();
+    }
+  }
+
+  QuicBandwidth rate = sending_rate_;
+  bool is_useful = false;
+  if (mode_ == STARTING) {
+    if (monitor_intervals_.empty() && utilities_.empty()) {
+      // The first MI: the handshake may have measured the RTT by now.
+      rate = QuicBandwidth::FromBytesAndTimeDelta(
+          initial_congestion_window_, rtt_stats_->SmoothedOrInitialRtt());
+    } else if (!monitor_intervals_.empty() &&
+               !monitor_intervals_.back().is_app_limited) {
+      // Doubling beyond what the congestion window lets through would not
+      // change the utility.
+      rate = sending_rate_ * 2;
+      if (!max_bandwidth_.GetBest().IsZero()) {
+        rate = std::min(rate, std::max(sending_rate_,
+                                       kStartingCongestionWindowGain *
+                                           max_bandwidth_.GetBest()));
+      }
+    }
+    SetSendingRate(rate);
+    rate = sending_rate_;
+    is_useful = true;
+  } else if (!pending_rates_.empty()) {
+    rate = pending_rates_.front();
+    pending_rates_.pop_front();
+    is_useful = true;
+  }
+
+  MonitorInterval interval;
+  interval.sending_rate = rate;
+  interval.is_useful = is_useful;
+  interval.start_time = sent_time;
+  interval.end_time = sent_time + MonitorIntervalDuration(rate);
+  monitor_intervals_.push_back(std::move(interval));
+}
+
+PccSender::MonitorInterval* PccSender::FindMonitorInterval(
+    QuicPacketNumber packet_number) {
+  for (MonitorInterval& interval : monitor_intervals_) {
+    if (!interval.first_packet_number.IsInitialized() ||
+        packet_number < interval.first_packet_number) {
+      return nullptr;
+    }
+    if (packet_number <= interval.last_packet_number) {
+      return &interval;
+    }
+  }
+  return nullptr;
+}
+
+void PccSender::ProcessCompletedMonitorIntervals(QuicTime now) {
+  const QuicTime::Delta timeout =
+      kMonitorIntervalTimeoutRtts * rtt_stats_->SmoothedOrInitialRtt();
+  // The last MI is still being sent.
+  while (monitor_intervals_.size() > 1) {
+    const MonitorInterval& front = monitor_intervals_.front();
+    if (front.bytes_acked + front.bytes_lost < front.bytes_sent &&
+        now < front.end_time + timeout) {
+      return;
+    }
+    MonitorInterval interval = std::move(monitor_intervals_.front());
+    monitor_intervals_.pop_front();
+    if (!interval.is_useful) {
+      continue;
+    }
+    if (interval.is_app_limited || interval.bytes_sent == 0) {
+      OnUsefulIntervalDiscarded();
+      continue;
+    }
+    const float utility = ComputeUtility(interval);
+    QUIC_DVLOG(1) << "PCC " << mode_ << ": MI at " << interval.sending_rate
+                  << " has utility " << utility;
+    const bool shows_congestion =
+        RttGradient(interval.rtt_samples) > kRttGradientTolerance ||
+        LossRate(interval) > kStartingLossRateThreshold;
+    OnUtilityAvailable({interval.sending_rate, utility, shows_congestion});
+  }
+}
+
+void PccSender::OnUtilityAvailable(const UtilityInfo& info) {
+  switch (mode_) {
+    case STARTING: {
+      // |utilities_| holds the best MI so far, followed by the congested MIs
+      // that did worse than it.
+      if (utilities_.empty() || info.utility >= utilities_.front().utility) {
+        utilities_.clear();
+        utilities_.push_back(info);
+        return;
+      }
+      if (!info.shows_congestion) {
+        utilities_.erase(utilities_.begin() + 1, utilities_.end());
+        return;
+      }
+      utilities_.push_back(info);
+      if (utilities_.size() <= kStartingDecreasesBeforeExit) {
+        return;
+      }
+      // The bottleneck is below the rate of the last MI.  Continue from the
+      // delivery rate, which unlike the rates of the MIs sent since the best
+      // one is not inflated by the queue they built.
+      QuicBandwidth rate = utilities_.front().sending_rate;
+      if (!max_bandwidth_.GetBest().IsZero()) {
+        rate = std::min(max_bandwidth_.GetBest(), info.sending_rate);
+      }
+      QUIC_DVLOG(1) << "Leaving STARTING at " << rate << ", best MI at "
+                    << utilities_.front().sending_rate << ", last MI at "
+                    << info.sending_rate;
+      SetSendingRate(rate);
+      EnterProbing();
+      return;
+    }
+    case PROBING: {
+      utilities_.push_back(info);
+      if (utilities_.size() < 2 * kNumProbingPairs) {
+        return;
+      }
+      // Only move the rate if all pairs agree on the direction.
+      float gradient_sum = 0;
+      int direction = 0;
+      for (size_t i = 0; i + 1 < utilities_.size(); i += 2) {
+        const UtilityInfo& first = utilities_[i];
+        const UtilityInfo& second = utilities_[i + 1];
+        const float gradient =
+            (first.utility - second.utility) /
+            (ToMbps(first.sending_rate) - ToMbps(second.sending_rate));
+        const int pair_direction = gradient > 0 ? 1 : -1;
+        if (direction != 0 && pair_direction != direction) {
+          EnterProbing();
+          return;
+        }
+        direction = pair_direction;
+        gradient_sum += gradient;
+      }
+      EnterDecisionMade(gradient_sum / kNumProbingPairs);
+      return;
+    }
+    case DECISION_MADE: {
+      const UtilityInfo reference = utilities_.back();
+      const float rate_difference =
+          ToMbps(info.sending_rate) - ToMbps(reference.sending_rate);
+      if (info.utility <= reference.utility || rate_difference == 0) {
+        // The last change did not help: go back to the previous rate and
+        // probe again.
+        SetSendingRate(reference.sending_rate);
+        EnterProbing();
+        return;
+      }
+      ++rate_change_amplifier_;
+      rate_change_proportion_allowance_ += kRateChangeAllowanceIncrement;
+      utilities_.clear();
+      utilities_.push_back(info);
+      SetSendingRate(ComputeRateChange(
+          (info.utility - reference.utility) / rate_difference));
+      pending_rates_.clear();
+      pending_rates_.push_back(sending_rate_);
+      EndCurrentMonitorInterval();
+      return;
+    }
+  }
+}
+
+void PccSender::OnUsefulIntervalDiscarded() {
+  if (mode_ != STARTING) {
+    EnterProbing();
+  }
+}
+
+void PccSender::EnterProbing() {
+  mode_ = PROBING;
+  DiscardUsefulIntervals();
+  for (size_t i = 0; i < kNumProbingPairs; ++i) {
+    const QuicBandwidth higher = sending_rate_ * (1 + kProbingStepSize);
+    const QuicBandwidth lower = sending_rate_ * (1 - kProbingStepSize);
+    const bool higher_first = random_->RandUint64() % 2 == 0;
+    pending_rates_.push_back(higher_first ? higher : lower);
+    pending_rates_.push_back(higher_first ? lower : higher);
+  }
+}
+
+void PccSender::EnterDecisionMade(float gradient) {
+  float average_utility = 0;
+  for (const UtilityInfo& info : utilities_) {
+    average_utility += info.utility;
+  }
+  average_utility /= utilities_.size();
+
+  mode_ = DECISION_MADE;
+  DiscardUsefulIntervals();
+  // The probes were centered on the current rate.
+  utilities_.push_back({sending_rate_, average_utility, false});
+  rate_change_amplifier_ = 1;
+  rate_change_proportion_allowance_ = kInitialRateChangeAllowance;
+  SetSendingRate(ComputeRateChange(gradient));
+  pending_rates_.push_back(sending_rate_);
+}
+
+void PccSender::DiscardUsefulIntervals() {
+  for (MonitorInterval& interval : monitor_intervals_) {
+    interval.is_useful = false;
+  }
+  pending_rates_.clear();
+  utilities_.clear();
+  EndCurrentMonitorInterval();
+}
+
+void PccSender::EndCurrentMonitorInterval() {
+  if (!monitor_intervals_.empty()) {
+    monitor_intervals_.back().end_time = monitor_intervals_.back().start_time;
+  }
+}
+
+QuicBandwidth PccSender::ComputeRateChange(float gradient) {
+  const float rate = ToMbps(sending_rate_);
+  const float max_change = rate_change_proportion_allowance_ * rate;
+  const float change = std::clamp(
+      kRateChangeFactor * rate_change_amplifier_ * gradient, -max_change,
+      max_change);
+  return QuicBandwidth::FromBitsPerSecond(
+      static_cast<int64_t>((rate + change) * 1e6));
+}
+
+void PccSender::SetSendingRate(QuicBandwidth rate) {
+  sending_rate_ = std::max(rate, MinimumSendingRate());
+}
+
+bool PccSender::UpdateRoundTripCounter(QuicPacketNumber last_acked_packet) {
+  if (!current_round_trip_end_.IsInitialized() ||
+      last_acked_packet > current_round_trip_end_) {
+    round_trip_count_++;
+    current_round_trip_end_ = last_sent_packet_;
+    return true;
+  }
+  return false;
+}
+
+void PccSender::CheckIfFullBandwidthReached(
+    const SendTimeState& last_packet_send_state) {
+  if (last_packet_send_state.is_app_limited) {
+    return;
+  }
+  const QuicBandwidth target = bandwidth_at_last_round_ * kStartingGrowthTarget;
+  if (max_bandwidth_.GetBest() >= target) {
+    bandwidth_at_last_round_ = max_bandwidth_.GetBest();
+    rounds_without_bandwidth_gain_ = 0;
+    return;
+  }
+  if (++rounds_without_bandwidth_gain_ <
+      kRoundTripsWithoutGrowthBeforeExitingStarting) {
+    return;
+  }
+  QUIC_DVLOG(1) << "PCC leaves STARTING at " << max_bandwidth_.GetBest()
+                << " after the bandwidth stopped growing";
+  SetSendingRate(max_bandwidth_.GetBest());
+  EnterProbing();
+}
+
+std::ostream& operator<<(std::ostream& os, const PccSender::Mode& mode) {
+  os << ModeToString(mode);
+  return os;
+}
+
+}  // namespace quic
@@ -0,0 +1,226 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// PCC (Performance-oriented Congestion Control) Vivace sender.
+
+#ifndef QUICHE_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
+#define QUICHE_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
+
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "quiche/quic/core/congestion_control/bandwidth_sampler.h"
+#include "quiche/quic/core/congestion_control/send_algorithm_interface.h"
+#include "quiche/quic/core/congestion_control/windowed_filter.h"
+#include "quiche/quic/core/crypto/quic_random.h"
+#include "quiche/quic/core/quic_bandwidth.h"
+#include "quiche/quic/core/quic_packet_number.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/core/quic_unacked_packet_map.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/common/quiche_circular_deque.h"
+
+namespace quic {
+
+class RttStats;
+
+// PccSender implements PCC Vivace, a rate-based congestion control algorithm
+// that learns its sending rate online.  Time is divided into monitor
+// intervals (MIs) of about one RTT, each sent at a fixed rate.  Once all the
+// packets of an MI are acked or lost, the MI is scored with the utility
+// function
+//
+//   u(r) = r^0.9 - 900 * r * d(RTT)/dt - 11.35 * r * loss_rate
+//
+// where r is the sending rate in Mbps and d(RTT)/dt is the slope of the RTT
+// samples taken during the MI.  The sender then moves its rate in the
+// direction of the utility gradient, which it estimates by sending pairs of
+// MIs slightly above and below the current rate.
+//
+// Because random loss below ~5% lowers the utility of neighbouring rates
+// almost equally, it barely moves the rate, unlike loss-based algorithms.
+//
+// PCC relies on pacing in order to function properly.  Do not use PCC when
+// pacing is disabled.
+class QUIC_EXPORT_PRIVATE PccSender : public SendAlgorithmInterface {
+ public:
+  enum Mode {
+    // Doubles the rate every MI until the utility decreases, or the delivery
+    // rate stops growing.
+    STARTING,
+    // Sends pairs of MIs at slightly higher and lower rates than the current
+    // one to find the direction of the utility gradient.
+    PROBING,
+    // Moves the rate in the direction found by PROBING, in increasingly large
+    // steps, for as long as the utility keeps improving.
+    DECISION_MADE,
+  };
+
+  // The outcome of a monitor interval, exported for debugging and testing.
+  struct QUIC_EXPORT_PRIVATE MonitorInterval {
+    QuicBandwidth sending_rate = QuicBandwidth::Zero();
+    // True if the utility of this MI is used to change the sending rate.
+    bool is_useful = false;
+    // Set when the application did not have enough data to send at
+    // |sending_rate|, which makes the utility meaningless.
+    bool is_app_limited = false;
+    QuicTime start_time = QuicTime::Zero();
+    QuicTime end_time = QuicTime::Zero();
+    QuicPacketNumber first_packet_number;
+    QuicPacketNumber last_packet_number;
+    QuicByteCount bytes_sent = 0;
+    QuicByteCount bytes_acked = 0;
+    QuicByteCount bytes_lost = 0;
+    // RTT samples taken while the packets of this MI were acked, as
+    // (time since |start_time| in microseconds, RTT in microseconds).
+    std::vector<std::pair<int64_t, int64_t>> rtt_samples;
+  };
+
+  PccSender(const RttStats* rtt_stats,
+            const QuicUnackedPacketMap* unacked_packets,
+            QuicPacketCount initial_congestion_window,
+            QuicPacketCount max_congestion_window, QuicRandom* random,
+            QuicConnectionStats* stats);
+  PccSender(const PccSender&) = delete;
+  PccSender& operator=(const PccSender&) = delete;
+  ~PccSender() override;
+
+  // Start implementation of SendAlgorithmInterface.
+  bool InSlowStart() const override;
+  bool InRecovery() const override;
+  bool ShouldSendProbingPacket() const override;
+
+  void SetFromConfig(const QuicConfig& config,
+                     Perspective perspective) override;
+  void ApplyConnectionOptions(const QuicTagVector& connection_options) override;
+
+  void AdjustNetworkParameters(const NetworkParams& params) override;
+  void SetInitialCongestionWindowInPackets(
+      QuicPacketCount congestion_window) override;
+  void OnCongestionEvent(bool rtt_updated, QuicByteCount prior_in_flight,
+                         QuicTime event_time,
+                         const AckedPacketVector& acked_packets,
+                         const LostPacketVector& lost_packets) override;
+  void OnPacketSent(QuicTime sent_time, QuicByteCount bytes_in_flight,
+                    QuicPacketNumber packet_number, QuicByteCount bytes,
+                    HasRetransmittableData is_retransmittable) override;
+  void OnPacketNeutered(QuicPacketNumber packet_number) override;
+  void OnRetransmissionTimeout(bool /*packets_retransmitted*/) override {}
+  void OnConnectionMigration() override {}
+  bool CanSend(QuicByteCount bytes_in_flight) override;
+  QuicBandwidth PacingRate(QuicByteCount bytes_in_flight) const override;
+  QuicBandwidth BandwidthEstimate() const override;
+  bool HasGoodBandwidthEstimateForResumption() const override {
+    return has_non_app_limited_sample_;
+  }
+  QuicByteCount GetCongestionWindow() const override;
+  QuicByteCount GetSlowStartThreshold() const override;
+  CongestionControlType GetCongestionControlType() const override;
+  std::string GetDebugState() const override;
+  void OnApplicationLimited(QuicByteCount bytes_in_flight) override;
+  void PopulateConnectionStats(QuicConnectionStats* stats) const override;
+  // End implementation of SendAlgorithmInterface.
+
+  // Returns the utility of a completed MI.  Exposed for testing.
+  static float ComputeUtility(const MonitorInterval& interval);
+
+  Mode mode() const { return mode_; }
+  QuicBandwidth sending_rate() const { return sending_rate_; }
+
+ private:
+  using MaxBandwidthFilter =
+      WindowedFilter<QuicBandwidth, MaxFilter<QuicBandwidth>,
+                     QuicRoundTripCount, QuicRoundTripCount>;
+
+  // A completed useful MI, reduced to what the rate control needs.
+  struct UtilityInfo {
+    QuicBandwidth sending_rate;
+    float utility;
+    // Whether the RTT grew or many packets were lost during the MI.
+    bool shows_congestion;
+  };
+
+  // Duration of an MI sent at |rate|.
+  QuicTime::Delta MonitorIntervalDuration(QuicBandwidth rate) const;
+  // Starts a new MI at |sent_time|, at the rate chosen by the current mode.
+  void StartMonitorInterval(QuicTime sent_time);
+  // Returns the MI that |packet_number| was sent in, or nullptr if it belongs
+  // to an MI that has been discarded.
+  MonitorInterval* FindMonitorInterval(QuicPacketNumber packet_number);
+  // Pops the MIs at the front of the queue whose packets are all acked or
+  // lost, feeding the useful ones to the rate control.
+  void ProcessCompletedMonitorIntervals(QuicTime now);
+  void OnUtilityAvailable(const UtilityInfo& info);
+  // Called when a useful MI cannot be scored, e.g. because it was
+  // app-limited.
+  void OnUsefulIntervalDiscarded();
+
+  void EnterProbing();
+  // Enters DECISION_MADE from PROBING, where the average utility gradient of
+  // the probes was |gradient|.
+  void EnterDecisionMade(float gradient);
+  // Stops using the utilities of the MIs sent so far.
+  void DiscardUsefulIntervals();
+  // Makes the next packet start a new MI, so that a new rate applies
+  // immediately.
+  void EndCurrentMonitorInterval();
+  // Returns |sending_rate_| moved by |gradient| (utility per Mbps), limited
+  // by the current step size.
+  QuicBandwidth ComputeRateChange(float gradient);
+  void SetSendingRate(QuicBandwidth rate);
+
+  // Updates the round-trip counter if a round-trip has passed.  Returns true if
+  // the counter has been advanced.
+  bool UpdateRoundTripCounter(QuicPacketNumber last_acked_packet);
+  // Leaves STARTING once the delivery rate stops growing, in case the
+  // congestion window keeps the utility from decreasing.
+  void CheckIfFullBandwidthReached(const SendTimeState& last_packet_send_state);
+
+  const RttStats* rtt_stats_;
+  const QuicUnackedPacketMap* unacked_packets_;
+  QuicRandom* random_;
+  QuicConnectionStats* stats_;
+
+  Mode mode_;
+  // The rate at which MIs are sent when they are not probing.
+  QuicBandwidth sending_rate_;
+
+  // MIs whose packets are not all acked or lost yet, oldest first.  The last
+  // one is the MI being sent.
+  quiche::QuicheCircularDeque<MonitorInterval> monitor_intervals_;
+  // Rates of the useful MIs to send next, before reverting to non-useful MIs
+  // at |sending_rate_|.
+  quiche::QuicheCircularDeque<QuicBandwidth> pending_rates_;
+  // Utilities of the useful MIs completed in the current mode.
+  std::vector<UtilityInfo> utilities_;
+  // Number of consecutive rate changes in the same direction in
+  // DECISION_MADE, which amplifies the next change.
+  int rate_change_amplifier_;
+  // Upper bound of a single rate change, as a fraction of the current rate.
+  float rate_change_proportion_allowance_;
+
+  // Delivery rate samples from the bandwidth sampler are used to pick the
+  // rate when leaving STARTING and as the bandwidth estimate.
+  BandwidthSampler sampler_;
+  MaxBandwidthFilter max_bandwidth_;
+  QuicRoundTripCount round_trip_count_;
+  QuicPacketNumber last_sent_packet_;
+  QuicPacketNumber current_round_trip_end_;
+  bool has_non_app_limited_sample_;
+  QuicBandwidth bandwidth_at_last_round_;
+  QuicRoundTripCount rounds_without_bandwidth_gain_;
+
+  QuicByteCount initial_congestion_window_;
+  QuicByteCount max_congestion_window_;
+};
+
+QUIC_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
+                                             const PccSender::Mode& mode);
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONGESTION_CONTROL_PCC_SENDER_H_
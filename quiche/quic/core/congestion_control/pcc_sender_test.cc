@@ -0,0 +1,246 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/congestion_control/pcc_sender.h"
+
+#include <cmath>
+#include <cstdint>
+#include <vector>
+
+#include "quiche/quic/core/congestion_control/rtt_stats.h"
+#include "quiche/quic/core/quic_bandwidth.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_packets.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/core/quic_unacked_packet_map.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+#include "quiche/quic/test_tools/mock_random.h"
+#include "quiche/quic/test_tools/simulator/simulation_sweep.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicPacketCount kInitialCongestionWindowPackets = 10;
+const QuicPacketCount kMaxCongestionWindowPackets = 10000;
+
+PccSender::MonitorInterval MakeInterval(QuicBandwidth rate,
+                                        QuicByteCount bytes_acked,
+                                        QuicByteCount bytes_lost) {
+  PccSender::MonitorInterval interval;
+  interval.sending_rate = rate;
+  interval.bytes_sent = bytes_acked + bytes_lost;
+  interval.bytes_acked = bytes_acked;
+  interval.bytes_lost = bytes_lost;
+  return interval;
+}
+
+// Adds RTT samples taken every 10ms over 100ms, starting at 100ms and growing
+// by |slope| per unit of time.
+void AddRttSamples(float slope, PccSender::MonitorInterval* interval) {
+  for (int64_t time = 0; time <= 100000; time += 10000) {
+    interval->rtt_samples.push_back(
+        {time, 100000 + static_cast<int64_t>(slope * time)});
+  }
+}
+
+class PccSenderUtilityTest : public QuicTest {};
+
+TEST_F(PccSenderUtilityTest, Lossless) {
+  PccSender::MonitorInterval interval =
+      MakeInterval(QuicBandwidth::FromKBitsPerSecond(10000), 100000, 0);
+  AddRttSamples(0, &interval);
+  EXPECT_FLOAT_EQ(std::pow(10.0f, 0.9f),
+                  PccSender::ComputeUtility(interval));
+}
+
+TEST_F(PccSenderUtilityTest, Loss) {
+  const PccSender::MonitorInterval interval =
+      MakeInterval(QuicBandwidth::FromKBitsPerSecond(10000), 90000, 10000);
+  EXPECT_FLOAT_EQ(std::pow(10.0f, 0.9f) - 11.35f * 10 * 0.1f,
+                  PccSender::ComputeUtility(interval));
+}
+
+TEST_F(PccSenderUtilityTest, GrowingRtt) {
+  PccSender::MonitorInterval interval =
+      MakeInterval(QuicBandwidth::FromKBitsPerSecond(10000), 100000, 0);
+  AddRttSamples(0.05f, &interval);
+  EXPECT_NEAR(std::pow(10.0f, 0.9f) - 900 * 10 * 0.05f,
+              PccSender::ComputeUtility(interval), 0.01f);
+}
+
+// RTT gradients that small are noise, e.g. from the ack delay.
+TEST_F(PccSenderUtilityTest, SmallRttGradientIgnored) {
+  PccSender::MonitorInterval interval =
+      MakeInterval(QuicBandwidth::FromKBitsPerSecond(10000), 100000, 0);
+  AddRttSamples(0.005f, &interval);
+  EXPECT_FLOAT_EQ(std::pow(10.0f, 0.9f),
+                  PccSender::ComputeUtility(interval));
+}
+
+TEST_F(PccSenderUtilityTest, UtilityPeaksBelowCongestedRate) {
+  // A faster MI that only adds loss scores worse than a slower lossless one.
+  const PccSender::MonitorInterval lossless =
+      MakeInterval(QuicBandwidth::FromKBitsPerSecond(10000), 100000, 0);
+  const PccSender::MonitorInterval lossy =
+      MakeInterval(QuicBandwidth::FromKBitsPerSecond(20000), 100000, 100000);
+  EXPECT_GT(PccSender::ComputeUtility(lossless),
+            PccSender::ComputeUtility(lossy));
+}
+
+class PccSenderTest : public QuicTest {
+ protected:
+  PccSenderTest()
+      : unacked_packets_(Perspective::IS_SERVER),
+        sender_(&rtt_stats_, &unacked_packets_,
+                kInitialCongestionWindowPackets, kMaxCongestionWindowPackets,
+                &random_, &stats_) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  }
+
+  void SendPacket() {
+    sender_.OnPacketSent(clock_.Now(), bytes_in_flight_,
+                         QuicPacketNumber(++packet_number_), kDefaultTCPMSS,
+                         HAS_RETRANSMITTABLE_DATA);
+    bytes_in_flight_ += kDefaultTCPMSS;
+  }
+
+  QuicBandwidth InitialRate() const {
+    return QuicBandwidth::FromBytesAndTimeDelta(
+        kInitialCongestionWindowPackets * kDefaultTCPMSS,
+        rtt_stats_.SmoothedOrInitialRtt());
+  }
+
+  MockClock clock_;
+  RttStats rtt_stats_;
+  QuicUnackedPacketMap unacked_packets_;
+  MockRandom random_;
+  QuicConnectionStats stats_;
+  PccSender sender_;
+  uint64_t packet_number_ = 0;
+  QuicByteCount bytes_in_flight_ = 0;
+};
+
+TEST_F(PccSenderTest, InitialState) {
+  EXPECT_EQ(PccSender::STARTING, sender_.mode());
+  EXPECT_TRUE(sender_.InSlowStart());
+  EXPECT_FALSE(sender_.InRecovery());
+  EXPECT_EQ(kPCC, sender_.GetCongestionControlType());
+  EXPECT_EQ(InitialRate(), sender_.PacingRate(0));
+  EXPECT_EQ(kInitialCongestionWindowPackets * kDefaultTCPMSS,
+            sender_.GetCongestionWindow());
+  EXPECT_TRUE(sender_.CanSend(0));
+}
+
+TEST_F(PccSenderTest, StartingDoublesRateEveryMonitorInterval) {
+  SendPacket();
+  EXPECT_EQ(InitialRate(), sender_.PacingRate(bytes_in_flight_));
+
+  // An MI lasts at least one RTT.
+  clock_.AdvanceTime(rtt_stats_.SmoothedOrInitialRtt());
+  SendPacket();
+  EXPECT_EQ(InitialRate() * 2, sender_.PacingRate(bytes_in_flight_));
+
+  clock_.AdvanceTime(rtt_stats_.SmoothedOrInitialRtt());
+  SendPacket();
+  EXPECT_EQ(InitialRate() * 4, sender_.PacingRate(bytes_in_flight_));
+  EXPECT_EQ(PccSender::STARTING, sender_.mode());
+}
+
+TEST_F(PccSenderTest, StartingKeepsRateAfterAppLimitedInterval) {
+  SendPacket();
+  sender_.OnApplicationLimited(bytes_in_flight_);
+  clock_.AdvanceTime(rtt_stats_.SmoothedOrInitialRtt());
+  SendPacket();
+  EXPECT_EQ(InitialRate(), sender_.PacingRate(bytes_in_flight_));
+}
+
+TEST_F(PccSenderTest, AdjustNetworkParametersLeavesStarting) {
+  const QuicBandwidth bandwidth = QuicBandwidth::FromKBitsPerSecond(5000);
+  sender_.AdjustNetworkParameters(SendAlgorithmInterface::NetworkParams(
+      bandwidth, QuicTime::Delta::FromMilliseconds(100), false));
+  EXPECT_EQ(PccSender::PROBING, sender_.mode());
+  EXPECT_EQ(bandwidth, sender_.sending_rate());
+  EXPECT_FALSE(sender_.InSlowStart());
+
+  // PROBING sends MIs slightly above and below the current rate.
+  SendPacket();
+  const QuicBandwidth probing_rate = sender_.PacingRate(bytes_in_flight_);
+  EXPECT_NE(bandwidth, probing_rate);
+  EXPECT_LE(bandwidth * 0.95, probing_rate);
+  EXPECT_GE(bandwidth * 1.05, probing_rate);
+}
+
+// The scenarios below run whole transfers in the simulator, on links where
+// PCC is expected to be efficient.
+simulator::SweepScenario LossyLinkScenario() {
+  simulator::SweepScenario scenario;
+  scenario.congestion_control = kPCC;
+  scenario.bandwidth = QuicBandwidth::FromKBitsPerSecond(20000);
+  scenario.rtt = QuicTime::Delta::FromMilliseconds(100);
+  scenario.transfer_bytes = 30 * 1000 * 1000;
+  scenario.max_duration = QuicTime::Delta::FromSeconds(60);
+  scenario.seed = 1;
+  return scenario;
+}
+
+class PccSenderSimulatorTest : public QuicTest {};
+
+TEST_F(PccSenderSimulatorTest, HighBdpLinkWithRandomLoss) {
+  simulator::SweepScenario scenario = LossyLinkScenario();
+  scenario.bandwidth = QuicBandwidth::FromKBitsPerSecond(50000);
+  scenario.rtt = QuicTime::Delta::FromMilliseconds(200);
+  scenario.loss_rate = 0.01;
+  const simulator::SweepResult result = simulator::RunSweepScenario(scenario);
+  EXPECT_TRUE(result.completed);
+  EXPECT_LE(scenario.bandwidth * 0.7, result.goodput);
+}
+
+TEST_F(PccSenderSimulatorTest, ShallowBufferWithRandomLoss) {
+  simulator::SweepScenario scenario = LossyLinkScenario();
+  scenario.buffer_bdp = 0.5;
+  scenario.loss_rate = 0.02;
+  const simulator::SweepResult result = simulator::RunSweepScenario(scenario);
+  EXPECT_TRUE(result.completed);
+  EXPECT_LE(scenario.bandwidth * 0.7, result.goodput);
+}
+
+// PCC stops growing the rate as soon as the RTT does, so it keeps a deep
+// buffer nearly empty.
+TEST_F(PccSenderSimulatorTest, DeepBuffer) {
+  simulator::SweepScenario scenario = LossyLinkScenario();
+  scenario.buffer_bdp = 4;
+  const simulator::SweepResult result = simulator::RunSweepScenario(scenario);
+  EXPECT_TRUE(result.completed);
+  EXPECT_LE(scenario.bandwidth * 0.8, result.goodput);
+  EXPECT_GT(1.5f, result.p50_rtt_inflation);
+}
+
+// Above the 2% loss rate at which BBRv2 bounds its inflight, random loss costs
+// BBRv2 much more throughput than PCC.
+TEST_F(PccSenderSimulatorTest, ComparedWithBbr2UnderRandomLoss) {
+  simulator::SweepMatrix matrix;
+  matrix.base = LossyLinkScenario();
+  matrix.base.name = "random_loss";
+  matrix.loss_rates = {0.03};
+  matrix.congestion_controls = {kPCC, kBBRv2};
+  const std::vector<simulator::SweepResult> results =
+      simulator::RunSweep(matrix.Expand(), 2);
+  ASSERT_EQ(2u, results.size());
+  QUIC_LOG(INFO) << "\n" << simulator::SweepResultsToCsv(results);
+
+  const simulator::SweepResult& pcc = results[0];
+  const simulator::SweepResult& bbr2 = results[1];
+  ASSERT_EQ(kPCC, pcc.scenario.congestion_control);
+  ASSERT_EQ(kBBRv2, bbr2.scenario.congestion_control);
+  EXPECT_TRUE(pcc.completed);
+  EXPECT_LE(matrix.base.bandwidth * 0.7, pcc.goodput);
+  EXPECT_LT(bbr2.goodput, pcc.goodput);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -4,9 +4,10 @@
 
 #include "quiche/quic/core/congestion_control/send_algorithm_interface.h"
 
-#include "absl/base/attributes.h"
+#include "absl/container/flat_hash_map.h"
 #include "quiche/quic/core/congestion_control/bbr2_sender.h"
 #include "quiche/quic/core/congestion_control/bbr_sender.h"
+#include "quiche/quic/core/congestion_control/pcc_sender.h"
 #include "quiche/quic/core/congestion_control/tcp_cubic_sender_bytes.h"
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
@@ -17,6 +18,18 @@ namespace quic {
 
 class RttStats;
 
+namespace {
+
+using FactoryMap = absl::flat_hash_map<CongestionControlType,
+                                       SendAlgorithmInterface::Factory>;
+
+FactoryMap& RegisteredFactories() {
+  static FactoryMap* factories = new FactoryMap();
+  return *factories;
+}
+
+}  // namespace
+
 // Factory for send side congestion control algorithm.
 SendAlgorithmInterface* SendAlgorithmInterface::Create(
     const QuicClock* clock, const RttStats* rtt_stats,
@@ -26,6 +39,20 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
     SendAlgorithmInterface* old_send_algorithm) {
   QuicPacketCount max_congestion_window =
       GetQuicFlag(FLAGS_quic_max_congestion_window);
+  const FactoryMap& factories = RegisteredFactories();
+  auto it = factories.find(congestion_control_type);
+  if (it != factories.end()) {
+    CreateParams params;
+    params.clock = clock;
+    params.rtt_stats = rtt_stats;
+    params.unacked_packets = unacked_packets;
+    params.random = random;
+    params.stats = stats;
+    params.initial_congestion_window = initial_congestion_window;
+    params.max_congestion_window = max_congestion_window;
+    params.old_send_algorithm = old_send_algorithm;
+    return it->second(params);
+  }
   switch (congestion_control_type) {
     case kGoogCC:  // GoogCC is not supported by quic/core, fall back to BBR.
     case kBBR:
@@ -41,8 +68,9 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
               ? static_cast<BbrSender*>(old_send_algorithm)
               : nullptr);
     case kPCC:
-      // PCC is currently not supported, fall back to CUBIC instead.
-      ABSL_FALLTHROUGH_INTENDED;
+      return new PccSender(rtt_stats, unacked_packets,
+                           initial_congestion_window, max_congestion_window,
+                           random, stats);
     case kCubicBytes:
       return new TcpCubicSenderBytes(
           clock, rtt_stats, false /* don't use Reno */,
@@ -55,4 +83,14 @@ SendAlgorithmInterface* SendAlgorithmInterface::Create(
   return nullptr;
 }
 
+// static
+void SendAlgorithmInterface::RegisterFactory(
+    CongestionControlType congestion_control_type, Factory factory) {
+  if (factory == nullptr) {
+    RegisteredFactories().erase(congestion_control_type);
+    return;
+  }
+  RegisteredFactories()[congestion_control_type] = factory;
+}
+
 }  // namespace quic
@@ -55,6 +55,21 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
     bool is_rtt_trusted = false;
   };
 
+  // Arguments passed to a Factory.
+  struct QUIC_NO_EXPORT CreateParams {
+    const QuicClock* clock = nullptr;
+    const RttStats* rtt_stats = nullptr;
+    const QuicUnackedPacketMap* unacked_packets = nullptr;
+    QuicRandom* random = nullptr;
+    QuicConnectionStats* stats = nullptr;
+    QuicPacketCount initial_congestion_window = 0;
+    QuicPacketCount max_congestion_window = 0;
+    // The algorithm being replaced, if any.  It is deleted after the new one
+    // is created.
+    SendAlgorithmInterface* old_send_algorithm = nullptr;
+  };
+  using Factory = SendAlgorithmInterface* (*)(const CreateParams& params);
+
   static SendAlgorithmInterface* Create(
       const QuicClock* clock, const RttStats* rtt_stats,
       const QuicUnackedPacketMap* unacked_packets, CongestionControlType type,
@@ -62,6 +77,12 @@ class QUIC_EXPORT_PRIVATE SendAlgorithmInterface {
       QuicPacketCount initial_congestion_window,
       SendAlgorithmInterface* old_send_algorithm);
 
+  // Makes Create() use |factory| for |type|, which lets embedders plug in
+  // their own implementation of an algorithm.  A null |factory| restores the
+  // built-in one.  Not thread-safe: call at startup, before any connection is
+  // created.
+  static void RegisterFactory(CongestionControlType type, Factory factory);
+
   virtual ~SendAlgorithmInterface() {}
 
   virtual void SetFromConfig(const QuicConfig& config,
@@ -11,11 +11,13 @@
 #include "absl/strings/str_cat.h"
 #include "quiche/quic/core/congestion_control/rtt_stats.h"
 #include "quiche/quic/core/congestion_control/send_algorithm_interface.h"
+#include "quiche/quic/core/congestion_control/tcp_cubic_sender_bytes.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/core/quic_utils.h"
 #include "quiche/quic/platform/api/quic_logging.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/mock_clock.h"
+#include "quiche/quic/test_tools/mock_random.h"
 #include "quiche/quic/test_tools/quic_config_peer.h"
 #include "quiche/quic/test_tools/quic_connection_peer.h"
 #include "quiche/quic/test_tools/quic_sent_packet_manager_peer.h"
@@ -359,5 +361,44 @@ TEST_P(SendAlgorithmTest, LowRTTTransfer) {
   PrintTransferStats();
 }
 
+SendAlgorithmInterface* CreateRenoInsteadOfPcc(
+    const SendAlgorithmInterface::CreateParams& params) {
+  return new TcpCubicSenderBytes(params.clock, params.rtt_stats,
+                                 /*reno=*/true,
+                                 params.initial_congestion_window,
+                                 params.max_congestion_window, params.stats);
+}
+
+class SendAlgorithmFactoryTest : public QuicTest {
+ protected:
+  SendAlgorithmFactoryTest() : unacked_packets_(Perspective::IS_CLIENT) {}
+
+  std::unique_ptr<SendAlgorithmInterface> Create(CongestionControlType type) {
+    return std::unique_ptr<SendAlgorithmInterface>(
+        SendAlgorithmInterface::Create(&clock_, &rtt_stats_, &unacked_packets_,
+                                       type, &random_, &stats_,
+                                       kInitialCongestionWindowPackets,
+                                       nullptr));
+  }
+
+  MockClock clock_;
+  RttStats rtt_stats_;
+  QuicUnackedPacketMap unacked_packets_;
+  MockRandom random_;
+  QuicConnectionStats stats_;
+};
+
+TEST_F(SendAlgorithmFactoryTest, RegisteredFactoryReplacesBuiltIn) {
+  EXPECT_EQ(kPCC, Create(kPCC)->GetCongestionControlType());
+
+  SendAlgorithmInterface::RegisterFactory(kPCC, &CreateRenoInsteadOfPcc);
+  EXPECT_EQ(kRenoBytes, Create(kPCC)->GetCongestionControlType());
+  // Other types keep their built-in implementation.
+  EXPECT_EQ(kCubicBytes, Create(kCubicBytes)->GetCongestionControlType());
+
+  SendAlgorithmInterface::RegisterFactory(kPCC, nullptr);
+  EXPECT_EQ(kPCC, Create(kPCC)->GetCongestionControlType());
+}
+
 }  // namespace test
 }  // namespace quic
@@ -0,0 +1,51 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CONNECTION_ID_GENERATOR_H_
+#define QUICHE_QUIC_CORE_CONNECTION_ID_GENERATOR_H_
+
+#include "absl/types/optional.h"
+#include "quiche/quic/core/quic_connection_id.h"
+#include "quiche/quic/core/quic_versions.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Generates the connection IDs of server connections, e.g. to encode routing
+// information for a load balancer in them. Set on QuicDispatcher, which uses
+// it to replace the connection IDs chosen by clients and hands it to the
+// connections it creates, which use it for the connection IDs they issue in
+// NEW_CONNECTION_ID frames.
+class QUIC_EXPORT_PRIVATE ConnectionIdGeneratorInterface {
+ public:
+  virtual ~ConnectionIdGeneratorInterface() = default;
+
+  // Returns a new connection ID for a connection which currently uses
+  // |original|, or nullopt if it cannot generate one, in which case the
+  // connection generates one itself.
+  virtual absl::optional<QuicConnectionId> GenerateNextConnectionId(
+      const QuicConnectionId& original) = 0;
+
+  // Returns the connection ID the server uses instead of |original|, the
+  // destination connection ID of the first packets of a new |version|
+  // connection, or nullopt to keep |original|. This MUST be deterministic:
+  // QuicDispatcher calls it again to find the connection of the packets the
+  // client keeps sending to |original| during the handshake.
+  virtual absl::optional<QuicConnectionId> MaybeReplaceConnectionId(
+      const QuicConnectionId& original, const ParsedQuicVersion& version) = 0;
+
+  // Returns what MaybeReplaceConnectionId() returned for |original| before its
+  // result last changed, e.g. because the generator switched to another
+  // QUIC-LB config, or nullopt. QuicDispatcher also looks connections up by
+  // this ID, so that the change does not strand the handshakes in flight.
+  virtual absl::optional<QuicConnectionId> GetPreviousReplacementConnectionId(
+      const QuicConnectionId& /*original*/,
+      const ParsedQuicVersion& /*version*/) {
+    return absl::nullopt;
+  }
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CONNECTION_ID_GENERATOR_H_
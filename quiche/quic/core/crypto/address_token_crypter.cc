@@ -0,0 +1,143 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/address_token_crypter.h"
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/core/crypto/crypto_utils.h"
+#include "quiche/quic/core/proto/source_address_token_proto.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_data_reader.h"
+#include "quiche/quic/core/quic_data_writer.h"
+#include "quiche/quic/platform/api/quic_bug_tracker.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Starts the plaintext of retry tokens. The token prefix is not
+// authenticated, and NEW_TOKEN tokens are sealed by the same boxer, so the
+// token type is also part of the sealed plaintext.
+constexpr char kRetryTokenLabel[] = "QUIC retry";
+constexpr size_t kRetryTokenLabelLength = sizeof(kRetryTokenLabel) - 1;
+
+// Label, issue time, length-prefixed IPv6 address, and two length-prefixed
+// connection IDs.
+const size_t kMaxRetryTokenPlaintextLength =
+    kRetryTokenLabelLength + sizeof(uint64_t) + 1 + 16 +
+    2 * (kConnectionIdLengthSize + kQuicMaxConnectionIdWithLengthPrefixLength);
+
+}  // namespace
+
+AddressTokenCrypter::AddressTokenCrypter(
+    const QuicCryptoServerConfig* crypto_config)
+    : crypto_config_(crypto_config) {}
+
+std::string AddressTokenCrypter::MintRetryToken(
+    const QuicIpAddress& client_address,
+    QuicConnectionId original_destination_connection_id,
+    QuicConnectionId retry_source_connection_id, QuicWallTime now,
+    QuicRandom* random) const {
+  // Plaintext: label, issue time, client address, original destination
+  // connection ID and retry source connection ID.
+  const std::string packed_address =
+      client_address.Normalized().ToPackedString();
+  char plaintext[kMaxRetryTokenPlaintextLength];
+  QuicDataWriter writer(sizeof(plaintext), plaintext);
+  if (!writer.WriteStringPiece(
+          absl::string_view(kRetryTokenLabel, kRetryTokenLabelLength)) ||
+      !writer.WriteUInt64(now.ToUNIXMicroseconds()) ||
+      !writer.WriteUInt8(packed_address.length()) ||
+      !writer.WriteStringPiece(packed_address) ||
+      !writer.WriteLengthPrefixedConnectionId(
+          original_destination_connection_id) ||
+      !writer.WriteLengthPrefixedConnectionId(retry_source_connection_id)) {
+    QUIC_BUG(quic_bug_12781_1) << "Failed to serialize retry token";
+    return std::string();
+  }
+  return absl::StrCat(std::string(1, static_cast<char>(kRetryTokenPrefix)),
+                      crypto_config_->source_address_token_boxer().Box(
+                          random, absl::string_view(writer.data(),
+                                                    writer.length())));
+}
+
+absl::optional<AddressTokenCrypter::RetryToken>
+AddressTokenCrypter::ValidateRetryToken(absl::string_view token,
+                                        const QuicIpAddress& client_address,
+                                        QuicWallTime now) const {
+  if (!IsRetryToken(token)) {
+    return absl::nullopt;
+  }
+  token.remove_prefix(1);
+  std::string storage;
+  absl::string_view plaintext;
+  if (!crypto_config_->source_address_token_boxer().Unbox(token, &storage,
+                                                         &plaintext)) {
+    QUIC_DVLOG(1) << "Failed to decrypt retry token";
+    return absl::nullopt;
+  }
+  // A token of another type sealed by the same boxer, such as a NEW_TOKEN
+  // token whose prefix was changed, unboxes successfully.
+  QuicDataReader reader(plaintext);
+  absl::string_view label;
+  uint64_t issue_time_us;
+  absl::string_view packed_address;
+  RetryToken result;
+  if (!reader.ReadStringPiece(&label, kRetryTokenLabelLength) ||
+      label != absl::string_view(kRetryTokenLabel, kRetryTokenLabelLength) ||
+      !reader.ReadUInt64(&issue_time_us) ||
+      !reader.ReadStringPiece8(&packed_address) ||
+      !reader.ReadLengthPrefixedConnectionId(
+          &result.original_destination_connection_id) ||
+      !reader.ReadLengthPrefixedConnectionId(
+          &result.retry_source_connection_id) ||
+      !reader.IsDoneReading()) {
+    QUIC_DVLOG(1) << "Failed to parse retry token";
+    return absl::nullopt;
+  }
+  if (packed_address != client_address.Normalized().ToPackedString()) {
+    QUIC_DVLOG(1) << "Retry token minted for another address";
+    return absl::nullopt;
+  }
+  // Retry tokens may be minted by another server, so tolerate clock skew.
+  if (now.AbsoluteDifference(QuicWallTime::FromUNIXMicroseconds(
+          issue_time_us)) > kRetryTokenLifetime) {
+    QUIC_DVLOG(1) << "Retry token expired";
+    return absl::nullopt;
+  }
+  return result;
+}
+
+bool AddressTokenCrypter::ValidateNewToken(absl::string_view token,
+                                           const QuicIpAddress& client_address,
+                                           QuicWallTime now) const {
+  if (token.empty() || static_cast<uint8_t>(token[0]) != kAddressTokenPrefix) {
+    return false;
+  }
+  token.remove_prefix(1);
+  SourceAddressTokens tokens;
+  HandshakeFailureReason reason = crypto_config_->ParseSourceAddressToken(
+      crypto_config_->source_address_token_boxer(), token, tokens);
+  if (reason != HANDSHAKE_OK) {
+    QUIC_DVLOG(1) << "Failed to parse address token: "
+                  << CryptoUtils::HandshakeFailureReasonToString(reason);
+    return false;
+  }
+  reason = crypto_config_->ValidateSourceAddressTokens(
+      tokens, client_address, now, /*cached_network_params=*/nullptr);
+  if (reason != HANDSHAKE_OK) {
+    QUIC_DVLOG(1) << "Failed to validate address token: "
+                  << CryptoUtils::HandshakeFailureReasonToString(reason);
+    return false;
+  }
+  return true;
+}
+
+// static
+bool AddressTokenCrypter::IsRetryToken(absl::string_view token) {
+  return !token.empty() && static_cast<uint8_t>(token[0]) == kRetryTokenPrefix;
+}
+
+}  // namespace quic
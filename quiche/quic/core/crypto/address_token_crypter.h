@@ -0,0 +1,79 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_ADDRESS_TOKEN_CRYPTER_H_
+#define QUICHE_QUIC_CORE_CRYPTO_ADDRESS_TOKEN_CRYPTER_H_
+
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "quiche/quic/core/crypto/quic_crypto_server_config.h"
+#include "quiche/quic/core/crypto/quic_random.h"
+#include "quiche/quic/core/quic_connection_id.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/quic/platform/api/quic_ip_address.h"
+
+namespace quic {
+
+// AddressTokenCrypter mints and validates the tokens a server uses to validate
+// client addresses without keeping per-connection state: the tokens sent in
+// RETRY packets, and the tokens sent in NEW_TOKEN frames. Both are protected
+// with the source address token keys of |crypto_config|, so they are rotated
+// with QuicCryptoServerConfig::SetSourceAddressTokenKeys(), and tokens minted
+// by one server of a fleet sharing the keys are accepted by the others.
+//
+// NEW_TOKEN tokens are minted by QuicSession; this class only validates them,
+// so that QuicDispatcher can skip the RETRY for clients presenting one.
+class QUIC_EXPORT_PRIVATE AddressTokenCrypter {
+ public:
+  // The connection IDs carried by a valid retry token.
+  struct QUIC_EXPORT_PRIVATE RetryToken {
+    // Destination connection ID of the client Initial which was retried.
+    QuicConnectionId original_destination_connection_id;
+    // Source connection ID of the RETRY packet, which the client uses as the
+    // destination connection ID of its new Initial.
+    QuicConnectionId retry_source_connection_id;
+  };
+
+  // |crypto_config| must outlive this object.
+  explicit AddressTokenCrypter(const QuicCryptoServerConfig* crypto_config);
+  AddressTokenCrypter(const AddressTokenCrypter&) = delete;
+  AddressTokenCrypter& operator=(const AddressTokenCrypter&) = delete;
+
+  // Returns a token for a RETRY packet sent to |client_address| at |now|.
+  std::string MintRetryToken(
+      const QuicIpAddress& client_address,
+      QuicConnectionId original_destination_connection_id,
+      QuicConnectionId retry_source_connection_id, QuicWallTime now,
+      QuicRandom* random) const;
+
+  // Returns the contents of |token| if it is a retry token minted for
+  // |client_address| no longer than kRetryTokenLifetime before |now|.
+  absl::optional<RetryToken> ValidateRetryToken(
+      absl::string_view token, const QuicIpAddress& client_address,
+      QuicWallTime now) const;
+
+  // Returns true if |token| is a valid and timely NEW_TOKEN token for
+  // |client_address|.
+  bool ValidateNewToken(absl::string_view token,
+                        const QuicIpAddress& client_address,
+                        QuicWallTime now) const;
+
+  // Returns true if |token| was minted by MintRetryToken() rather than sent in
+  // a NEW_TOKEN frame. Does not validate |token|.
+  static bool IsRetryToken(absl::string_view token);
+
+  // Clients echo retry tokens right away, so they expire quickly.
+  static constexpr QuicTime::Delta kRetryTokenLifetime =
+      QuicTime::Delta::FromSeconds(10);
+
+ private:
+  const QuicCryptoServerConfig* crypto_config_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_ADDRESS_TOKEN_CRYPTER_H_
@@ -0,0 +1,163 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/address_token_crypter.h"
+
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/core/proto/source_address_token_proto.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/crypto_test_utils.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+class AddressTokenCrypterTest : public QuicTest {
+ protected:
+  AddressTokenCrypterTest()
+      : crypto_config_(QuicCryptoServerConfig::TESTING,
+                       QuicRandom::GetInstance(),
+                       crypto_test_utils::ProofSourceForTesting(),
+                       KeyExchangeSource::Default()),
+        crypter_(&crypto_config_),
+        now_(QuicWallTime::FromUNIXSeconds(1600000000)),
+        odcid_(TestConnectionId(1)),
+        rscid_(TestConnectionId(2)) {
+    QUICHE_CHECK(client_address_.FromString("192.0.2.33"));
+    QUICHE_CHECK(other_address_.FromString("192.0.2.34"));
+  }
+
+  std::string MintRetryToken() {
+    return crypter_.MintRetryToken(client_address_, odcid_, rscid_, now_,
+                                   QuicRandom::GetInstance());
+  }
+
+  QuicCryptoServerConfig crypto_config_;
+  AddressTokenCrypter crypter_;
+  QuicWallTime now_;
+  QuicConnectionId odcid_;
+  QuicConnectionId rscid_;
+  QuicIpAddress client_address_;
+  QuicIpAddress other_address_;
+};
+
+TEST_F(AddressTokenCrypterTest, RetryToken) {
+  const std::string token = MintRetryToken();
+  EXPECT_TRUE(AddressTokenCrypter::IsRetryToken(token));
+  absl::optional<AddressTokenCrypter::RetryToken> contents =
+      crypter_.ValidateRetryToken(token, client_address_, now_);
+  ASSERT_TRUE(contents.has_value());
+  EXPECT_EQ(odcid_, contents->original_destination_connection_id);
+  EXPECT_EQ(rscid_, contents->retry_source_connection_id);
+
+  // The IPv4-mapped form of the client address is accepted.
+  EXPECT_TRUE(crypter_
+                  .ValidateRetryToken(token, client_address_.DualStacked(),
+                                      now_)
+                  .has_value());
+  EXPECT_FALSE(
+      crypter_.ValidateRetryToken(token, other_address_, now_).has_value());
+  // A retry token is not a NEW_TOKEN token.
+  EXPECT_FALSE(crypter_.ValidateNewToken(token, client_address_, now_));
+}
+
+TEST_F(AddressTokenCrypterTest, RetryTokenExpiry) {
+  const std::string token = MintRetryToken();
+  const QuicTime::Delta lifetime = AddressTokenCrypter::kRetryTokenLifetime;
+  EXPECT_TRUE(crypter_
+                  .ValidateRetryToken(token, client_address_,
+                                      now_.Add(lifetime))
+                  .has_value());
+  EXPECT_FALSE(crypter_
+                   .ValidateRetryToken(
+                       token, client_address_,
+                       now_.Add(lifetime + QuicTime::Delta::FromSeconds(1)))
+                   .has_value());
+  // Minted by a server whose clock is ahead.
+  EXPECT_TRUE(crypter_
+                  .ValidateRetryToken(token, client_address_,
+                                      now_.Subtract(lifetime))
+                  .has_value());
+  EXPECT_FALSE(crypter_
+                   .ValidateRetryToken(
+                       token, client_address_,
+                       now_.Subtract(lifetime +
+                                     QuicTime::Delta::FromSeconds(1)))
+                   .has_value());
+}
+
+TEST_F(AddressTokenCrypterTest, TamperedRetryToken) {
+  std::string token = MintRetryToken();
+  token[token.length() / 2] ^= 1;
+  EXPECT_FALSE(
+      crypter_.ValidateRetryToken(token, client_address_, now_).has_value());
+  EXPECT_FALSE(
+      crypter_.ValidateRetryToken("", client_address_, now_).has_value());
+  EXPECT_FALSE(crypter_
+                   .ValidateRetryToken(std::string(1, kRetryTokenPrefix),
+                                       client_address_, now_)
+                   .has_value());
+}
+
+TEST_F(AddressTokenCrypterTest, RetryTokenKeyRotation) {
+  const std::string token = MintRetryToken();
+  const std::string old_key(CryptoSecretBoxer::GetKeySize(), 'o');
+  const std::string new_key(CryptoSecretBoxer::GetKeySize(), 'n');
+
+  crypto_config_.SetSourceAddressTokenKeys({old_key});
+  const std::string old_token = MintRetryToken();
+  EXPECT_FALSE(
+      crypter_.ValidateRetryToken(token, client_address_, now_).has_value());
+
+  // Tokens minted with the previous key are still accepted while it is listed.
+  crypto_config_.SetSourceAddressTokenKeys({new_key, old_key});
+  EXPECT_TRUE(crypter_.ValidateRetryToken(old_token, client_address_, now_)
+                  .has_value());
+  crypto_config_.SetSourceAddressTokenKeys({new_key});
+  EXPECT_FALSE(crypter_.ValidateRetryToken(old_token, client_address_, now_)
+                   .has_value());
+}
+
+TEST_F(AddressTokenCrypterTest, NewToken) {
+  const std::string token =
+      absl::StrCat(std::string(1, kAddressTokenPrefix),
+                   crypto_config_.NewSourceAddressToken(
+                       crypto_config_.source_address_token_boxer(),
+                       SourceAddressTokens(), client_address_,
+                       QuicRandom::GetInstance(), now_, nullptr));
+  EXPECT_FALSE(AddressTokenCrypter::IsRetryToken(token));
+  EXPECT_TRUE(crypter_.ValidateNewToken(token, client_address_, now_));
+  EXPECT_FALSE(crypter_.ValidateNewToken(token, other_address_, now_));
+  EXPECT_FALSE(
+      crypter_.ValidateRetryToken(token, client_address_, now_).has_value());
+  EXPECT_FALSE(crypter_.ValidateNewToken("", client_address_, now_));
+}
+
+TEST_F(AddressTokenCrypterTest, NewTokenWithRetryTokenPrefix) {
+  std::string token =
+      absl::StrCat(std::string(1, kAddressTokenPrefix),
+                   crypto_config_.NewSourceAddressToken(
+                       crypto_config_.source_address_token_boxer(),
+                       SourceAddressTokens(), client_address_,
+                       QuicRandom::GetInstance(), now_, nullptr));
+  // The prefix is not authenticated, so the token still unboxes, but its
+  // plaintext is not that of a retry token.
+  token[0] = kRetryTokenPrefix;
+  EXPECT_TRUE(AddressTokenCrypter::IsRetryToken(token));
+  EXPECT_FALSE(
+      crypter_.ValidateRetryToken(token, client_address_, now_).has_value());
+
+  // And conversely.
+  std::string retry_token = MintRetryToken();
+  retry_token[0] = kAddressTokenPrefix;
+  EXPECT_FALSE(crypter_.ValidateNewToken(retry_token, client_address_, now_));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
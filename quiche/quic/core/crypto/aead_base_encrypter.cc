@@ -135,6 +135,52 @@ bool AeadBaseEncrypter::EncryptPacket(uint64_t packet_number,
   // TODO(ianswett): Introduce a check to ensure that we don't encrypt with the
   // same packet number twice.
   alignas(4) char nonce_buffer[kMaxNonceSize];
+  FillNonce(packet_number, nonce_buffer);
+
+  if (!Encrypt(absl::string_view(nonce_buffer, nonce_size_), associated_data,
+               plaintext, reinterpret_cast<unsigned char*>(output))) {
+    return false;
+  }
+  *output_length = ciphertext_size;
+  return true;
+}
+
+bool AeadBaseEncrypter::EncryptPacketWithExtraPlaintext(
+    uint64_t packet_number, absl::string_view associated_data,
+    absl::string_view plaintext, absl::string_view extra_plaintext,
+    char* output, size_t* output_length, size_t max_output_length) {
+  size_t ciphertext_size =
+      GetCiphertextSize(plaintext.length() + extra_plaintext.length());
+  if (max_output_length < ciphertext_size) {
+    return false;
+  }
+  alignas(4) char nonce_buffer[kMaxNonceSize];
+  FillNonce(packet_number, nonce_buffer);
+
+  // |plaintext| is encrypted to the start of |output|, and |extra_plaintext|
+  // is encrypted right after it, followed by the tag.
+  uint8_t* out = reinterpret_cast<uint8_t*>(output);
+  uint8_t* out_tag = out + plaintext.length();
+  size_t out_tag_length;
+  if (!EVP_AEAD_CTX_seal_scatter(
+          ctx_.get(), out, out_tag, &out_tag_length,
+          max_output_length - plaintext.length(),
+          reinterpret_cast<const uint8_t*>(nonce_buffer), nonce_size_,
+          reinterpret_cast<const uint8_t*>(plaintext.data()), plaintext.size(),
+          reinterpret_cast<const uint8_t*>(extra_plaintext.data()),
+          extra_plaintext.size(),
+          reinterpret_cast<const uint8_t*>(associated_data.data()),
+          associated_data.size())) {
+    DLogOpenSslErrors();
+    return false;
+  }
+  QUICHE_DCHECK_EQ(ciphertext_size, plaintext.length() + out_tag_length);
+  *output_length = ciphertext_size;
+  return true;
+}
+
+void AeadBaseEncrypter::FillNonce(uint64_t packet_number,
+                                  char* nonce_buffer) const {
   memcpy(nonce_buffer, iv_, nonce_size_);
   size_t prefix_len = nonce_size_ - sizeof(packet_number);
   if (use_ietf_nonce_construction_) {
@@ -145,13 +191,6 @@ bool AeadBaseEncrypter::EncryptPacket(uint64_t packet_number,
   } else {
     memcpy(nonce_buffer + prefix_len, &packet_number, sizeof(packet_number));
   }
-
-  if (!Encrypt(absl::string_view(nonce_buffer, nonce_size_), associated_data,
-               plaintext, reinterpret_cast<unsigned char*>(output))) {
-    return false;
-  }
-  *output_length = ciphertext_size;
-  return true;
 }
 
 size_t AeadBaseEncrypter::GetKeySize() const { return key_size_; }
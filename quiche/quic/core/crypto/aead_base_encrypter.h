@@ -33,6 +33,12 @@ class QUIC_EXPORT_PRIVATE AeadBaseEncrypter : public QuicEncrypter {
   bool EncryptPacket(uint64_t packet_number, absl::string_view associated_data,
                      absl::string_view plaintext, char* output,
                      size_t* output_length, size_t max_output_length) override;
+  bool EncryptPacketWithExtraPlaintext(uint64_t packet_number,
+                                       absl::string_view associated_data,
+                                       absl::string_view plaintext,
+                                       absl::string_view extra_plaintext,
+                                       char* output, size_t* output_length,
+                                       size_t max_output_length) override;
   size_t GetKeySize() const override;
   size_t GetNoncePrefixSize() const override;
   size_t GetIVSize() const override;
@@ -54,6 +60,10 @@ class QUIC_EXPORT_PRIVATE AeadBaseEncrypter : public QuicEncrypter {
   enum : size_t { kMaxNonceSize = 12 };
 
  private:
+  // Writes the nonce for |packet_number| to |nonce_buffer|, which must hold
+  // at least kMaxNonceSize bytes.
+  void FillNonce(uint64_t packet_number, char* nonce_buffer) const;
+
   const EVP_AEAD* const aead_alg_;
   const size_t key_size_;
   const size_t auth_tag_size_;
@@ -9,6 +9,8 @@
 
 #include "absl/base/macros.h"
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/core/quic_constants.h"
 #include "quiche/quic/core/quic_utils.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
@@ -287,5 +289,35 @@ TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMask) {
       expected_mask.size());
 }
 
+TEST_F(Aes128GcmDecrypterTest, GenerateHeaderProtectionMasks) {
+  Aes128GcmDecrypter decrypter;
+  std::string key = absl::HexStringToBytes("d9132370cb18476ab833649cf080d970");
+  ASSERT_TRUE(decrypter.SetHeaderProtectionKey(key));
+  std::string samples = absl::StrCat(
+      absl::HexStringToBytes("d1d7998068517adb769b48b924a32c47"),
+      std::string(kHeaderProtectionSampleLength, 'a'),
+      std::string(kHeaderProtectionSampleLength, 'b'));
+  std::string masks(samples.size(), 0);
+  ASSERT_TRUE(decrypter.GenerateHeaderProtectionMasks(samples, &masks[0]));
+  std::string expected_mask =
+      absl::HexStringToBytes("b132c37d6164da4ea4dc9b763aceec27");
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", masks.data(), expected_mask.size(),
+      expected_mask.data(), expected_mask.size());
+  // Each mask is the one computed from its sample alone.
+  for (size_t offset = 0; offset < samples.size();
+       offset += kHeaderProtectionSampleLength) {
+    QuicDataReader sample_reader(
+        samples.data() + offset, kHeaderProtectionSampleLength);
+    std::string mask = decrypter.GenerateHeaderProtectionMask(&sample_reader);
+    quiche::test::CompareCharArraysWithHexError(
+        "header protection mask", masks.data() + offset, mask.size(),
+        mask.data(), mask.size());
+  }
+
+  EXPECT_FALSE(decrypter.GenerateHeaderProtectionMasks(
+      absl::string_view(samples).substr(1), &masks[0]));
+}
+
 }  // namespace test
 }  // namespace quic
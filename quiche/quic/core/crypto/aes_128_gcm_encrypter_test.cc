@@ -241,6 +241,34 @@ TEST_F(Aes128GcmEncrypterTest, EncryptPacket) {
                                               out.size(), ct.data(), ct.size());
 }
 
+TEST_F(Aes128GcmEncrypterTest, EncryptPacketWithExtraPlaintext) {
+  std::string key = absl::HexStringToBytes("d95a145250826c25a77b6a84fd4d34fc");
+  std::string iv = absl::HexStringToBytes("50c4431ebb18283448e276e2");
+  uint64_t packet_num = 0x13278f44;
+  std::string aad =
+      absl::HexStringToBytes("875d49f64a70c9cbe713278f44ff000005");
+  std::string pt = absl::HexStringToBytes("aa0003a250bd000000000001");
+  std::string ct = absl::HexStringToBytes(
+      "7dd4708b989ee7d38a013e3656e9b37beefd05808fe1ab41e3b4f2c0");
+
+  Aes128GcmEncrypter encrypter;
+  ASSERT_TRUE(encrypter.SetKey(key));
+  ASSERT_TRUE(encrypter.SetIV(iv));
+  for (size_t split = 0; split <= pt.size(); ++split) {
+    // The first |split| bytes of the plaintext are encrypted in place.
+    std::vector<char> out(ct.size());
+    memcpy(out.data(), pt.data(), split);
+    size_t out_size;
+    ASSERT_TRUE(encrypter.EncryptPacketWithExtraPlaintext(
+        packet_num, aad, absl::string_view(out.data(), split),
+        absl::string_view(pt).substr(split), out.data(), &out_size,
+        out.size()));
+    EXPECT_EQ(out_size, out.size());
+    quiche::test::CompareCharArraysWithHexError(
+        "ciphertext", out.data(), out.size(), ct.data(), ct.size());
+  }
+}
+
 TEST_F(Aes128GcmEncrypterTest, GetMaxPlaintextSize) {
   Aes128GcmEncrypter encrypter;
   EXPECT_EQ(1000u, encrypter.GetMaxPlaintextSize(1016));
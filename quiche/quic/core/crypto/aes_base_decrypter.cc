@@ -6,6 +6,8 @@
 
 #include "absl/strings/string_view.h"
 #include "openssl/aes.h"
+#include "openssl/cipher.h"
+#include "quiche/quic/core/quic_constants.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
 
 namespace quic {
@@ -20,6 +22,15 @@ bool AesBaseDecrypter::SetHeaderProtectionKey(absl::string_view key) {
     QUIC_BUG(quic_bug_10649_2) << "Unexpected failure of AES_set_encrypt_key";
     return false;
   }
+  const EVP_CIPHER* cipher =
+      key.size() == 16 ? EVP_aes_128_ecb() : EVP_aes_256_ecb();
+  if (!EVP_EncryptInit_ex(pne_ctx_.get(), cipher, nullptr,
+                          reinterpret_cast<const uint8_t*>(key.data()),
+                          nullptr) ||
+      !EVP_CIPHER_CTX_set_padding(pne_ctx_.get(), 0)) {
+    QUIC_BUG(quic_bug_10649_3) << "Unexpected failure of EVP_EncryptInit_ex";
+    return false;
+  }
   return true;
 }
 
@@ -36,6 +47,25 @@ std::string AesBaseDecrypter::GenerateHeaderProtectionMask(
   return out;
 }
 
+bool AesBaseDecrypter::GenerateHeaderProtectionMasks(absl::string_view samples,
+                                                     char* masks) {
+  static_assert(kHeaderProtectionSampleLength == AES_BLOCK_SIZE,
+                "Each sample must be a single AES block");
+  if (samples.size() % AES_BLOCK_SIZE != 0 ||
+      EVP_CIPHER_CTX_cipher(pne_ctx_.get()) == nullptr) {
+    return false;
+  }
+  // Without padding, ECB mode encrypts whole blocks right away.
+  int out_length = 0;
+  if (!EVP_EncryptUpdate(pne_ctx_.get(), reinterpret_cast<uint8_t*>(masks),
+                         &out_length,
+                         reinterpret_cast<const uint8_t*>(samples.data()),
+                         samples.size())) {
+    return false;
+  }
+  return static_cast<size_t>(out_length) == samples.size();
+}
+
 QuicPacketCount AesBaseDecrypter::GetIntegrityLimit() const {
   // For AEAD_AES_128_GCM ... endpoints that do not attempt to remove
   // protection from packets larger than 2^11 bytes can attempt to remove
@@ -9,6 +9,7 @@
 
 #include "absl/strings/string_view.h"
 #include "openssl/aes.h"
+#include "openssl/cipher.h"
 #include "quiche/quic/core/crypto/aead_base_decrypter.h"
 #include "quiche/quic/platform/api/quic_export.h"
 
@@ -21,11 +22,16 @@ class QUIC_EXPORT_PRIVATE AesBaseDecrypter : public AeadBaseDecrypter {
   bool SetHeaderProtectionKey(absl::string_view key) override;
   std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) override;
+  bool GenerateHeaderProtectionMasks(absl::string_view samples,
+                                     char* masks) override;
   QuicPacketCount GetIntegrityLimit() const override;
 
  private:
   // The key used for packet number encryption.
   AES_KEY pne_key_;
+  // The same key, set up for AES-ECB encryption of several samples at once,
+  // which BoringSSL pipelines across AES blocks.
+  bssl::ScopedEVP_CIPHER_CTX pne_ctx_;
 };
 
 }  // namespace quic
@@ -8,7 +8,9 @@
 #include <string>
 
 #include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
+#include "quiche/quic/core/quic_constants.h"
 #include "quiche/quic/core/quic_utils.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
@@ -184,5 +186,26 @@ TEST_F(ChaCha20Poly1305TlsDecrypterTest, GenerateHeaderProtectionMask) {
       expected_mask.size());
 }
 
+TEST_F(ChaCha20Poly1305TlsDecrypterTest, GenerateHeaderProtectionMasks) {
+  ChaCha20Poly1305TlsDecrypter decrypter;
+  std::string key = absl::HexStringToBytes(
+      "6a067f432787bd6034dd3f08f07fc9703a27e58c70e2d88d948b7f6489923cc7");
+  ASSERT_TRUE(decrypter.SetHeaderProtectionKey(key));
+  std::string samples =
+      absl::StrCat(std::string(kHeaderProtectionSampleLength, 'a'),
+                   absl::HexStringToBytes("1210d91cceb45c716b023f492c29e612"));
+  std::string masks(samples.size(), 0);
+  ASSERT_TRUE(decrypter.GenerateHeaderProtectionMasks(samples, &masks[0]));
+  std::string expected_mask = absl::HexStringToBytes("1cc2cd98dc");
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", masks.data() + kHeaderProtectionSampleLength,
+      expected_mask.size(), expected_mask.data(), expected_mask.size());
+  QuicDataReader sample_reader(samples.data(), kHeaderProtectionSampleLength);
+  std::string mask = decrypter.GenerateHeaderProtectionMask(&sample_reader);
+  quiche::test::CompareCharArraysWithHexError(
+      "header protection mask", masks.data(), mask.size(), mask.data(),
+      mask.size());
+}
+
 }  // namespace test
 }  // namespace quic
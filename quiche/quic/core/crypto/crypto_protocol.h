@@ -196,6 +196,9 @@ const QuicTag kAFF1 = TAG('A', 'F', 'F', '1');   // Use SRTT in building
                                                  // AckFrequencyFrame.
 const QuicTag kAFF2 = TAG('A', 'F', 'F', '2');   // Send AckFrequencyFrame upon
                                                  // handshake completion.
+const QuicTag kAFF3 = TAG('A', 'F', 'F', '3');   // Adapt AckFrequencyFrame to
+                                                 // the bandwidth-delay product
+                                                 // and reordering.
 const QuicTag kSSLR = TAG('S', 'S', 'L', 'R');   // Slow Start Large Reduction.
 const QuicTag kNPRR = TAG('N', 'P', 'R', 'R');   // Pace at unity instead of PRR
 const QuicTag k2RTO = TAG('2', 'R', 'T', 'O');   // Close connection on 2 RTOs
@@ -286,7 +289,12 @@ const QuicTag kRVCM = TAG('R', 'V', 'C', 'M');   // Validate the new address
 const QuicTag kTCID = TAG('T', 'C', 'I', 'D');   // Connection ID truncation.
 
 // Multipath option.
-const QuicTag kMPTH = TAG('M', 'P', 'T', 'H');   // Enable multipath.
+const QuicTag kMPTH = TAG('M', 'P', 'T', 'H');   // Enable multipath, send
+                                                 // on the min RTT path.
+const QuicTag kMPRR = TAG('M', 'P', 'R', 'R');   // Enable multipath, send
+                                                 // round robin.
+const QuicTag kMPRD = TAG('M', 'P', 'R', 'D');   // Enable multipath, send
+                                                 // redundantly.
 
 const QuicTag kNCMR = TAG('N', 'C', 'M', 'R');   // Do not attempt connection
                                                  // migration.
@@ -338,12 +338,28 @@ void CryptoUtils::CreateInitialObfuscators(Perspective perspective,
 bool CryptoUtils::ValidateRetryIntegrityTag(
     ParsedQuicVersion version, QuicConnectionId original_connection_id,
     absl::string_view retry_without_tag, absl::string_view integrity_tag) {
-  unsigned char computed_integrity_tag[kRetryIntegrityTagLength];
+  char computed_integrity_tag[kRetryIntegrityTagLength];
   if (integrity_tag.length() != ABSL_ARRAYSIZE(computed_integrity_tag)) {
     QUIC_BUG(quic_bug_10699_4)
         << "Invalid retry integrity tag length " << integrity_tag.length();
     return false;
   }
+  if (!ComputeRetryIntegrityTag(version, original_connection_id,
+                                retry_without_tag, computed_integrity_tag)) {
+    return false;
+  }
+  if (CRYPTO_memcmp(computed_integrity_tag, integrity_tag.data(),
+                    ABSL_ARRAYSIZE(computed_integrity_tag)) != 0) {
+    QUIC_DLOG(ERROR) << "Failed to validate retry integrity tag";
+    return false;
+  }
+  return true;
+}
+
+// static
+bool CryptoUtils::ComputeRetryIntegrityTag(
+    ParsedQuicVersion version, QuicConnectionId original_connection_id,
+    absl::string_view retry_without_tag, char* integrity_tag) {
   char retry_pseudo_packet[kMaxIncomingPacketSize + 256];
   QuicDataWriter writer(ABSL_ARRAYSIZE(retry_pseudo_packet),
                         retry_pseudo_packet);
@@ -368,15 +384,10 @@ bool CryptoUtils::ValidateRetryIntegrityTag(
   absl::string_view associated_data(writer.data(), writer.length());
   absl::string_view plaintext;  // Plaintext is empty.
   if (!crypter.Encrypt(nonce, associated_data, plaintext,
-                       computed_integrity_tag)) {
+                       reinterpret_cast<unsigned char*>(integrity_tag))) {
     QUIC_BUG(quic_bug_10699_7) << "Failed to compute retry integrity tag";
     return false;
   }
-  if (CRYPTO_memcmp(computed_integrity_tag, integrity_tag.data(),
-                    ABSL_ARRAYSIZE(computed_integrity_tag)) != 0) {
-    QUIC_DLOG(ERROR) << "Failed to validate retry integrity tag";
-    return false;
-  }
   return true;
 }
 
@@ -128,6 +128,14 @@ class QUIC_EXPORT_PRIVATE CryptoUtils {
                                         absl::string_view retry_without_tag,
                                         absl::string_view integrity_tag);
 
+  // Computes the retry integrity tag of a retry packet sent in response to a
+  // packet with destination connection ID |original_connection_id|, and writes
+  // it to |integrity_tag|, which must be kRetryIntegrityTagLength bytes long.
+  static bool ComputeRetryIntegrityTag(ParsedQuicVersion version,
+                                       QuicConnectionId original_connection_id,
+                                       absl::string_view retry_without_tag,
+                                       char* integrity_tag);
+
   // Generates the connection nonce. The nonce is formed as:
   //   <4 bytes> current time
   //   <8 bytes> |orbit| (or random if |orbit| is empty)
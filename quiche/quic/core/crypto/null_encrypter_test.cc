@@ -84,6 +84,22 @@ TEST_F(NullEncrypterTest, EncryptServer) {
       reinterpret_cast<const char*>(expected), ABSL_ARRAYSIZE(expected));
 }
 
+TEST_F(NullEncrypterTest, EncryptPacketWithExtraPlaintext) {
+  char expected[256];
+  size_t expected_len = 0;
+  NullEncrypter encrypter(Perspective::IS_CLIENT);
+  ASSERT_TRUE(encrypter.EncryptPacket(0, "hello world!", "goodbye!", expected,
+                                      &expected_len, 256));
+
+  char encrypted[256];
+  size_t encrypted_len = 0;
+  ASSERT_TRUE(encrypter.EncryptPacketWithExtraPlaintext(
+      0, "hello world!", "good", "bye!", encrypted, &encrypted_len, 256));
+  quiche::test::CompareCharArraysWithHexError("encrypted data", encrypted,
+                                              encrypted_len, expected,
+                                              expected_len);
+}
+
 TEST_F(NullEncrypterTest, GetMaxPlaintextSize) {
   NullEncrypter encrypter(Perspective::IS_CLIENT);
   EXPECT_EQ(1000u, encrypter.GetMaxPlaintextSize(1012));
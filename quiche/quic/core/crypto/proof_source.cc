@@ -17,17 +17,23 @@ CryptoBuffers::~CryptoBuffers() {
 }
 
 ProofSource::Chain::Chain(const std::vector<std::string>& certs)
-    : certs(certs) {}
+    : certs(certs) {
+  crypto_buffers_.reserve(certs.size());
+  for (const std::string& cert : certs) {
+    crypto_buffers_.push_back(bssl::UniquePtr<CRYPTO_BUFFER>(
+        CRYPTO_BUFFER_new(reinterpret_cast<const uint8_t*>(cert.data()),
+                          cert.length(), nullptr)));
+  }
+}
 
 ProofSource::Chain::~Chain() {}
 
 CryptoBuffers ProofSource::Chain::ToCryptoBuffers() const {
   CryptoBuffers crypto_buffers;
-  crypto_buffers.value.reserve(certs.size());
-  for (size_t i = 0; i < certs.size(); i++) {
-    crypto_buffers.value.push_back(
-        CRYPTO_BUFFER_new(reinterpret_cast<const uint8_t*>(certs[i].data()),
-                          certs[i].length(), nullptr));
+  crypto_buffers.value.reserve(crypto_buffers_.size());
+  for (const bssl::UniquePtr<CRYPTO_BUFFER>& buffer : crypto_buffers_) {
+    CRYPTO_BUFFER_up_ref(buffer.get());
+    crypto_buffers.value.push_back(buffer.get());
   }
   return crypto_buffers;
 }
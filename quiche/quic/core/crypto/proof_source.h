@@ -46,12 +46,18 @@ class QUIC_EXPORT_PRIVATE ProofSource {
     Chain(const Chain&) = delete;
     Chain& operator=(const Chain&) = delete;
 
+    // Returns new references to CRYPTO_BUFFERs holding |certs|. The buffers
+    // are created once with the chain and shared by every handshake which
+    // uses it, rather than copied for each one.
     CryptoBuffers ToCryptoBuffers() const;
 
     const std::vector<std::string> certs;
 
    protected:
     ~Chain() override;
+
+   private:
+    std::vector<bssl::UniquePtr<CRYPTO_BUFFER>> crypto_buffers_;
   };
 
   // Details is an abstract class which acts as a container for any
@@ -220,6 +226,17 @@ class QUIC_EXPORT_PRIVATE ProofSource {
     // vector.
     virtual void Decrypt(absl::string_view in,
                          std::shared_ptr<DecryptCallback> callback) = 0;
+
+    // Called with the encrypted ticket of each ClientHello which offers early
+    // data, once Decrypt succeeded. Returns false if the ticket was already
+    // used for early data, in which case the server rejects the early data
+    // and completes a 1-RTT handshake; clients use each ticket once (RFC 8446
+    // section 8.1). Implementations whose tickets can be resumed by several
+    // servers should check tickets against state shared by those servers.
+    // The default implementation accepts all tickets.
+    virtual bool ShouldAcceptEarlyData(absl::string_view /*ticket*/) {
+      return true;
+    }
   };
 
   // Returns the TicketCrypter used for encrypting and decrypting TLS
@@ -137,6 +137,19 @@ TEST_F(ProofSourceX509Test, TlsSignature) {
                                     "Test data", std::make_unique<Callback>());
 }
 
+TEST_F(ProofSourceX509Test, ChainSharesCryptoBuffers) {
+  CryptoBuffers first = test_chain_->ToCryptoBuffers();
+  CryptoBuffers second = test_chain_->ToCryptoBuffers();
+  ASSERT_EQ(1u, first.value.size());
+  ASSERT_EQ(1u, second.value.size());
+  EXPECT_EQ(first.value[0], second.value[0]);
+  EXPECT_EQ(kTestCertificate,
+            absl::string_view(
+                reinterpret_cast<const char*>(
+                    CRYPTO_BUFFER_data(first.value[0])),
+                CRYPTO_BUFFER_len(first.value[0])));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -281,6 +281,8 @@ QuicCryptoServerConfig::QuicCryptoServerConfig(
       proof_source_(std::move(proof_source)),
       key_exchange_source_(std::move(key_exchange_source)),
       ssl_ctx_(TlsServerConnection::CreateSslCtx(proof_source_.get())),
+      tls_compressed_certs_cache_(
+          TlsCompressedCertsCache::kTlsCompressedCertsCacheSize),
       source_address_token_future_secs_(3600),
       source_address_token_lifetime_secs_(86400),
       enable_serving_sct_(false),
@@ -22,6 +22,7 @@
 #include "quiche/quic/core/crypto/proof_source.h"
 #include "quiche/quic/core/crypto/quic_compressed_certs_cache.h"
 #include "quiche/quic/core/crypto/quic_crypto_proof.h"
+#include "quiche/quic/core/crypto/tls_cert_compression.h"
 #include "quiche/quic/core/proto/cached_network_parameters_proto.h"
 #include "quiche/quic/core/proto/source_address_token_proto.h"
 #include "quiche/quic/core/quic_time.h"
@@ -439,6 +440,12 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
 
   SSL_CTX* ssl_ctx() const;
 
+  // Returns the cache of compressed TLS Certificate messages. The cache is
+  // thread safe, so it may be used through a const config.
+  TlsCompressedCertsCache* tls_compressed_certs_cache() const {
+    return &tls_compressed_certs_cache_;
+  }
+
   // Pre-shared key used during the handshake.
   const std::string& pre_shared_key() const { return pre_shared_key_; }
   void set_pre_shared_key(absl::string_view psk) {
@@ -895,6 +902,10 @@ class QUIC_EXPORT_PRIVATE QuicCryptoServerConfig {
   // ssl_ctx_ contains the server configuration for doing TLS handshakes.
   bssl::UniquePtr<SSL_CTX> ssl_ctx_;
 
+  // tls_compressed_certs_cache_ caches the compressed Certificate messages
+  // sent in TLS handshakes which negotiate certificate compression.
+  mutable TlsCompressedCertsCache tls_compressed_certs_cache_;
+
   // These fields store configuration values. See the comments for their
   // respective setter functions.
   uint32_t source_address_token_future_secs_;
@@ -4,6 +4,7 @@
 
 #include "quiche/quic/core/crypto/quic_decrypter.h"
 
+#include <cstring>
 #include <string>
 #include <utility>
 
@@ -17,6 +18,7 @@
 #include "quiche/quic/core/crypto/crypto_protocol.h"
 #include "quiche/quic/core/crypto/null_decrypter.h"
 #include "quiche/quic/core/crypto/quic_hkdf.h"
+#include "quiche/quic/core/quic_constants.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
 #include "quiche/quic/platform/api/quic_logging.h"
 
@@ -60,6 +62,24 @@ std::unique_ptr<QuicDecrypter> QuicDecrypter::CreateFromCipherSuite(
   }
 }
 
+bool QuicDecrypter::GenerateHeaderProtectionMasks(absl::string_view samples,
+                                                  char* masks) {
+  if (samples.size() % kHeaderProtectionSampleLength != 0) {
+    return false;
+  }
+  for (size_t offset = 0; offset < samples.size();
+       offset += kHeaderProtectionSampleLength) {
+    QuicDataReader sample_reader(
+        samples.substr(offset, kHeaderProtectionSampleLength));
+    std::string mask = GenerateHeaderProtectionMask(&sample_reader);
+    if (mask.empty() || mask.size() > kHeaderProtectionSampleLength) {
+      return false;
+    }
+    memcpy(masks + offset, mask.data(), mask.size());
+  }
+  return true;
+}
+
 // static
 void QuicDecrypter::DiversifyPreliminaryKey(absl::string_view preliminary_key,
                                             absl::string_view nonce_prefix,
@@ -68,6 +68,16 @@ class QUIC_EXPORT_PRIVATE QuicDecrypter : public QuicCrypter {
   virtual std::string GenerateHeaderProtectionMask(
       QuicDataReader* sample_reader) = 0;
 
+  // Generates the header protection masks of several packets at once.
+  // |samples| is the concatenation of their kHeaderProtectionSampleLength byte
+  // samples, and the mask of the i-th sample is written to |masks| at offset
+  // i * kHeaderProtectionSampleLength; at least its first 5 bytes are valid.
+  // |masks| must be as long as |samples|. Returns false on failure. The default
+  // implementation calls GenerateHeaderProtectionMask() for each sample;
+  // decrypters which can compute independent masks in parallel override it.
+  virtual bool GenerateHeaderProtectionMasks(absl::string_view samples,
+                                             char* masks);
+
   // The ID of the cipher. Return 0x03000000 ORed with the 'cryptographic suite
   // selector'.
   virtual uint32_t cipher_id() const = 0;
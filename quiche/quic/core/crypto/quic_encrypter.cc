@@ -4,6 +4,7 @@
 
 #include "quiche/quic/core/crypto/quic_encrypter.h"
 
+#include <cstring>
 #include <utility>
 
 #include "openssl/tls1.h"
@@ -57,4 +58,24 @@ std::unique_ptr<QuicEncrypter> QuicEncrypter::CreateFromCipherSuite(
   }
 }
 
+bool QuicEncrypter::EncryptPacketWithExtraPlaintext(
+    uint64_t packet_number, absl::string_view associated_data,
+    absl::string_view plaintext, absl::string_view extra_plaintext,
+    char* output, size_t* output_length, size_t max_output_length) {
+  const size_t plaintext_length = plaintext.length() + extra_plaintext.length();
+  if (max_output_length < plaintext_length) {
+    return false;
+  }
+  if (!plaintext.empty() && plaintext.data() != output) {
+    memcpy(output, plaintext.data(), plaintext.length());
+  }
+  if (!extra_plaintext.empty()) {
+    memcpy(output + plaintext.length(), extra_plaintext.data(),
+           extra_plaintext.length());
+  }
+  return EncryptPacket(packet_number, associated_data,
+                       absl::string_view(output, plaintext_length), output,
+                       output_length, max_output_length);
+}
+
 }  // namespace quic
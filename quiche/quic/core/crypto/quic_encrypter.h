@@ -41,6 +41,18 @@ class QUIC_EXPORT_PRIVATE QuicEncrypter : public QuicCrypter {
                              size_t* output_length,
                              size_t max_output_length) = 0;
 
+  // Like EncryptPacket, but the plaintext is |plaintext| followed by
+  // |extra_plaintext|.  Implementations may read |extra_plaintext| directly,
+  // so that it is only ever written to |output| as ciphertext.  |plaintext|
+  // must either start at |output| or not overlap with it, and
+  // |extra_plaintext| must not overlap with |output|.  The default
+  // implementation copies |extra_plaintext| after |plaintext| in |output| and
+  // calls EncryptPacket.
+  virtual bool EncryptPacketWithExtraPlaintext(
+      uint64_t packet_number, absl::string_view associated_data,
+      absl::string_view plaintext, absl::string_view extra_plaintext,
+      char* output, size_t* output_length, size_t max_output_length);
+
   // Takes a |sample| of ciphertext and uses the header protection key to
   // generate a mask to use for header protection, and returns that mask. On
   // success, the mask will be at least 5 bytes long; on failure the string will
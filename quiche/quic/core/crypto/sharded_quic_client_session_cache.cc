@@ -0,0 +1,98 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/sharded_quic_client_session_cache.h"
+
+#include <utility>
+
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+const size_t kDefaultNumShards = 16;
+const size_t kDefaultMaxEntries = 1024;
+
+}  // namespace
+
+ShardedQuicClientSessionCache::ShardedQuicClientSessionCache()
+    : ShardedQuicClientSessionCache(kDefaultNumShards, kDefaultMaxEntries) {}
+
+ShardedQuicClientSessionCache::ShardedQuicClientSessionCache(
+    size_t num_shards, size_t max_entries) {
+  QUICHE_DCHECK_LT(0u, num_shards);
+  if (num_shards == 0) {
+    num_shards = 1;
+  }
+  const size_t max_entries_per_shard =
+      (max_entries + num_shards - 1) / num_shards;
+  shards_.reserve(num_shards);
+  for (size_t i = 0; i < num_shards; ++i) {
+    shards_.push_back(std::make_unique<Shard>(max_entries_per_shard));
+  }
+}
+
+ShardedQuicClientSessionCache::~ShardedQuicClientSessionCache() = default;
+
+void ShardedQuicClientSessionCache::Insert(
+    const QuicServerId& server_id, bssl::UniquePtr<SSL_SESSION> session,
+    const TransportParameters& params,
+    const ApplicationState* application_state) {
+  Shard& shard = ShardFor(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  shard.cache.Insert(server_id, std::move(session), params, application_state);
+}
+
+std::unique_ptr<QuicResumptionState> ShardedQuicClientSessionCache::Lookup(
+    const QuicServerId& server_id, QuicWallTime now, const SSL_CTX* ctx) {
+  // Lookup pops a session from the entry, so it needs an exclusive lock.
+  Shard& shard = ShardFor(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  return shard.cache.Lookup(server_id, now, ctx);
+}
+
+void ShardedQuicClientSessionCache::ClearEarlyData(
+    const QuicServerId& server_id) {
+  Shard& shard = ShardFor(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  shard.cache.ClearEarlyData(server_id);
+}
+
+void ShardedQuicClientSessionCache::OnNewTokenReceived(
+    const QuicServerId& server_id, absl::string_view token) {
+  Shard& shard = ShardFor(server_id);
+  QuicWriterMutexLock lock(&shard.mutex);
+  shard.cache.OnNewTokenReceived(server_id, token);
+}
+
+void ShardedQuicClientSessionCache::RemoveExpiredEntries(QuicWallTime now) {
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    QuicWriterMutexLock lock(&shard->mutex);
+    shard->cache.RemoveExpiredEntries(now);
+  }
+}
+
+void ShardedQuicClientSessionCache::Clear() {
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    QuicWriterMutexLock lock(&shard->mutex);
+    shard->cache.Clear();
+  }
+}
+
+size_t ShardedQuicClientSessionCache::size() const {
+  size_t size = 0;
+  for (const std::unique_ptr<Shard>& shard : shards_) {
+    QuicReaderMutexLock lock(&shard->mutex);
+    size += shard->cache.size();
+  }
+  return size;
+}
+
+ShardedQuicClientSessionCache::Shard& ShardedQuicClientSessionCache::ShardFor(
+    const QuicServerId& server_id) {
+  return *shards_[QuicServerIdHash()(server_id) % shards_.size()];
+}
+
+}  // namespace quic
@@ -0,0 +1,72 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_SHARDED_QUIC_CLIENT_SESSION_CACHE_H_
+#define QUICHE_QUIC_CORE_CRYPTO_SHARDED_QUIC_CLIENT_SESSION_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+#include "quiche/quic/core/crypto/quic_client_session_cache.h"
+#include "quiche/quic/core/crypto/quic_crypto_client_config.h"
+#include "quiche/quic/core/quic_server_id.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// ShardedQuicClientSessionCache is a thread safe SessionCache for clients
+// which run connections on many threads. Server IDs are spread over a fixed
+// number of shards, each a QuicClientSessionCache with its own lock and LRU
+// order, so that connections to different servers rarely contend.
+class QUIC_EXPORT_PRIVATE ShardedQuicClientSessionCache : public SessionCache {
+ public:
+  ShardedQuicClientSessionCache();
+  // Keeps up to |max_entries| server IDs in total, split evenly over
+  // |num_shards| shards.
+  ShardedQuicClientSessionCache(size_t num_shards, size_t max_entries);
+  ~ShardedQuicClientSessionCache() override;
+
+  void Insert(const QuicServerId& server_id,
+              bssl::UniquePtr<SSL_SESSION> session,
+              const TransportParameters& params,
+              const ApplicationState* application_state) override;
+
+  std::unique_ptr<QuicResumptionState> Lookup(const QuicServerId& server_id,
+                                              QuicWallTime now,
+                                              const SSL_CTX* ctx) override;
+
+  void ClearEarlyData(const QuicServerId& server_id) override;
+
+  void OnNewTokenReceived(const QuicServerId& server_id,
+                          absl::string_view token) override;
+
+  // Removes expired entries one shard at a time, so that lookups on the other
+  // shards can proceed meanwhile.
+  void RemoveExpiredEntries(QuicWallTime now) override;
+
+  void Clear() override;
+
+  // Returns the number of server IDs in all shards.
+  size_t size() const;
+
+  size_t num_shards() const { return shards_.size(); }
+
+ private:
+  struct QUIC_EXPORT_PRIVATE Shard {
+    explicit Shard(size_t max_entries) : cache(max_entries) {}
+
+    mutable QuicMutex mutex;
+    QuicClientSessionCache cache QUIC_GUARDED_BY(mutex);
+  };
+
+  Shard& ShardFor(const QuicServerId& server_id);
+
+  std::vector<std::unique_ptr<Shard>> shards_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_SHARDED_QUIC_CLIENT_SESSION_CACHE_H_
@@ -0,0 +1,182 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/sharded_quic_client_session_cache.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/platform/api/quic_thread.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+#include "quiche/quic/test_tools/test_tls_session.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicTime::Delta kTimeout = QuicTime::Delta::FromSeconds(1000);
+
+QuicServerId MakeServerId(int i) {
+  return QuicServerId(absl::StrCat("server", i, ".example.com"), 443);
+}
+
+class ShardedQuicClientSessionCacheTest : public QuicTest {
+ public:
+  ShardedQuicClientSessionCacheTest() : ssl_ctx_(SSL_CTX_new(TLS_method())) {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+    params_.perspective = Perspective::IS_SERVER;
+    params_.initial_max_data.set_value(100);
+  }
+
+ protected:
+  bssl::UniquePtr<SSL_SESSION> MakeTestSession(
+      QuicTime::Delta timeout = kTimeout) {
+    bssl::UniquePtr<SSL_SESSION> session = MakeTestTlsSession(ssl_ctx_.get());
+    SSL_SESSION_set_time(session.get(), clock_.WallNow().ToUNIXSeconds());
+    SSL_SESSION_set_timeout(session.get(), timeout.ToSeconds());
+    return session;
+  }
+
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  MockClock clock_;
+  TransportParameters params_;
+};
+
+TEST_F(ShardedQuicClientSessionCacheTest, InsertAndLookup) {
+  ShardedQuicClientSessionCache cache;
+  std::vector<SSL_SESSION*> sessions;
+  for (int i = 0; i < 100; ++i) {
+    bssl::UniquePtr<SSL_SESSION> session = MakeTestSession();
+    sessions.push_back(session.get());
+    cache.Insert(MakeServerId(i), std::move(session), params_, nullptr);
+  }
+  EXPECT_EQ(100u, cache.size());
+
+  for (int i = 0; i < 100; ++i) {
+    std::unique_ptr<QuicResumptionState> state =
+        cache.Lookup(MakeServerId(i), clock_.WallNow(), ssl_ctx_.get());
+    ASSERT_NE(nullptr, state);
+    EXPECT_EQ(sessions[i], state->tls_session.get());
+    EXPECT_EQ(params_, *state->transport_params);
+  }
+  EXPECT_EQ(nullptr,
+            cache.Lookup(MakeServerId(0), clock_.WallNow(), ssl_ctx_.get()));
+}
+
+TEST_F(ShardedQuicClientSessionCacheTest, TokenAndEarlyData) {
+  ShardedQuicClientSessionCache cache;
+  const QuicServerId server_id = MakeServerId(0);
+  cache.Insert(server_id, MakeTestSession(), params_, nullptr);
+  cache.OnNewTokenReceived(server_id, "token");
+  cache.ClearEarlyData(server_id);
+
+  std::unique_ptr<QuicResumptionState> state =
+      cache.Lookup(server_id, clock_.WallNow(), ssl_ctx_.get());
+  ASSERT_NE(nullptr, state);
+  EXPECT_EQ("token", state->token);
+  EXPECT_FALSE(SSL_SESSION_early_data_capable(state->tls_session.get()));
+}
+
+TEST_F(ShardedQuicClientSessionCacheTest, MaxEntries) {
+  ShardedQuicClientSessionCache cache(/*num_shards=*/4, /*max_entries=*/8);
+  for (int i = 0; i < 100; ++i) {
+    cache.Insert(MakeServerId(i), MakeTestSession(), params_, nullptr);
+  }
+  EXPECT_GE(8u, cache.size());
+  // The most recently inserted server ID is still present.
+  EXPECT_NE(nullptr,
+            cache.Lookup(MakeServerId(99), clock_.WallNow(), ssl_ctx_.get()));
+}
+
+TEST_F(ShardedQuicClientSessionCacheTest, RemoveExpiredEntries) {
+  ShardedQuicClientSessionCache cache;
+  for (int i = 0; i < 10; ++i) {
+    cache.Insert(MakeServerId(i), MakeTestSession(), params_, nullptr);
+  }
+  for (int i = 10; i < 20; ++i) {
+    cache.Insert(MakeServerId(i), MakeTestSession(3 * kTimeout), params_,
+                 nullptr);
+  }
+  clock_.AdvanceTime(2 * kTimeout);
+  cache.RemoveExpiredEntries(clock_.WallNow());
+  EXPECT_EQ(10u, cache.size());
+  EXPECT_EQ(nullptr,
+            cache.Lookup(MakeServerId(0), clock_.WallNow(), ssl_ctx_.get()));
+  EXPECT_NE(nullptr,
+            cache.Lookup(MakeServerId(10), clock_.WallNow(), ssl_ctx_.get()));
+
+  cache.Clear();
+  EXPECT_EQ(0u, cache.size());
+}
+
+class InsertAndLookupThread : public QuicThread {
+ public:
+  InsertAndLookupThread(ShardedQuicClientSessionCache* cache,
+                        std::vector<bssl::UniquePtr<SSL_SESSION>> sessions,
+                        const TransportParameters& params, QuicWallTime now,
+                        int first_server)
+      : QuicThread("InsertAndLookupThread"),
+        cache_(cache),
+        sessions_(std::move(sessions)),
+        params_(params),
+        now_(now),
+        first_server_(first_server) {}
+
+  int num_found() const { return num_found_; }
+
+ protected:
+  void Run() override {
+    const int num_servers = sessions_.size();
+    for (int i = 0; i < num_servers; ++i) {
+      cache_->Insert(MakeServerId(first_server_ + i), std::move(sessions_[i]),
+                     params_, nullptr);
+    }
+    for (int i = 0; i < num_servers; ++i) {
+      if (cache_->Lookup(MakeServerId(first_server_ + i), now_, nullptr) !=
+          nullptr) {
+        ++num_found_;
+      }
+    }
+  }
+
+ private:
+  ShardedQuicClientSessionCache* cache_;
+  std::vector<bssl::UniquePtr<SSL_SESSION>> sessions_;
+  const TransportParameters params_;
+  const QuicWallTime now_;
+  const int first_server_;
+  int num_found_ = 0;
+};
+
+TEST_F(ShardedQuicClientSessionCacheTest, ConcurrentAccess) {
+  constexpr int kNumThreads = 4;
+  constexpr int kNumServersPerThread = 100;
+  ShardedQuicClientSessionCache cache;
+  std::vector<std::unique_ptr<InsertAndLookupThread>> threads;
+  for (int i = 0; i < kNumThreads; ++i) {
+    std::vector<bssl::UniquePtr<SSL_SESSION>> sessions;
+    for (int j = 0; j < kNumServersPerThread; ++j) {
+      sessions.push_back(MakeTestSession());
+    }
+    threads.push_back(std::make_unique<InsertAndLookupThread>(
+        &cache, std::move(sessions), params_, clock_.WallNow(),
+        i * kNumServersPerThread));
+  }
+  for (auto& thread : threads) {
+    thread->Start();
+  }
+  for (auto& thread : threads) {
+    thread->Join();
+  }
+  for (auto& thread : threads) {
+    EXPECT_EQ(kNumServersPerThread, thread->num_found());
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
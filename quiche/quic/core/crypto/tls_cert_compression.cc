@@ -0,0 +1,95 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/tls_cert_compression.h"
+
+#include <memory>
+#include <string>
+
+#include "quiche/quic/platform/api/quic_logging.h"
+#include "zlib.h"
+
+namespace quic {
+
+const size_t TlsCompressedCertsCache::kTlsCompressedCertsCacheSize = 225;
+
+bool TlsCompressCertificate(absl::string_view certificate_message,
+                            std::string* compressed) {
+  uLongf compressed_size = compressBound(certificate_message.size());
+  compressed->resize(compressed_size);
+  // The result is cached by servers, so spend the extra cycles on the
+  // smallest output.
+  if (compress2(reinterpret_cast<Bytef*>(&(*compressed)[0]), &compressed_size,
+                reinterpret_cast<const Bytef*>(certificate_message.data()),
+                certificate_message.size(), Z_BEST_COMPRESSION) != Z_OK) {
+    QUIC_DLOG(ERROR) << "Failed to compress certificate message of "
+                     << certificate_message.size() << " bytes";
+    compressed->clear();
+    return false;
+  }
+  compressed->resize(compressed_size);
+  return true;
+}
+
+bool TlsDecompressCertificate(absl::string_view compressed,
+                              absl::Span<uint8_t> out) {
+  uLongf decompressed_size = out.size();
+  if (uncompress(out.data(), &decompressed_size,
+                 reinterpret_cast<const Bytef*>(compressed.data()),
+                 compressed.size()) != Z_OK) {
+    // This includes Z_BUF_ERROR, returned if the stream inflates to more
+    // than |out.size()| bytes.
+    QUIC_DLOG(ERROR) << "Failed to decompress certificate message";
+    return false;
+  }
+  if (decompressed_size != out.size()) {
+    QUIC_DLOG(ERROR) << "Decompressed certificate message has "
+                     << decompressed_size << " bytes, expected " << out.size();
+    return false;
+  }
+  return true;
+}
+
+TlsCompressedCertsCache::TlsCompressedCertsCache(size_t max_num_chains)
+    : cache_(max_num_chains) {}
+
+TlsCompressedCertsCache::~TlsCompressedCertsCache() {}
+
+bool TlsCompressedCertsCache::GetOrCompress(
+    const ProofSource::Chain* chain, absl::string_view certificate_message,
+    std::string* compressed) {
+  {
+    QuicWriterMutexLock lock(&mutex_);
+    auto it = cache_.Lookup(chain);
+    if (it != cache_.end() &&
+        it->second->certificate_message == certificate_message) {
+      *compressed = it->second->compressed;
+      return true;
+    }
+  }
+
+  // Compress outside of the lock so that a miss does not stall handshakes
+  // using other chains.
+  if (!TlsCompressCertificate(certificate_message, compressed)) {
+    return false;
+  }
+  auto cached_cert = std::make_unique<CachedCert>();
+  cached_cert->certificate_message = std::string(certificate_message);
+  cached_cert->compressed = *compressed;
+  QuicWriterMutexLock lock(&mutex_);
+  cache_.Insert(chain, std::move(cached_cert));
+  return true;
+}
+
+size_t TlsCompressedCertsCache::MaxSize() {
+  QuicReaderMutexLock lock(&mutex_);
+  return cache_.MaxSize();
+}
+
+size_t TlsCompressedCertsCache::Size() {
+  QuicReaderMutexLock lock(&mutex_);
+  return cache_.Size();
+}
+
+}  // namespace quic
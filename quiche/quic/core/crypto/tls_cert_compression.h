@@ -0,0 +1,81 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSION_H_
+#define QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSION_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "quiche/quic/core/crypto/proof_source.h"
+#include "quiche/quic/core/quic_lru_cache.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// The CertificateCompressionAlgorithm code point of zlib, see RFC 8879
+// section 3.
+inline constexpr uint16_t kTlsCertCompressionAlgorithmZlib = 1;
+
+// Compresses the TLS Certificate message |certificate_message| with zlib and
+// writes the result to |compressed|. Returns false on failure.
+QUIC_EXPORT_PRIVATE bool TlsCompressCertificate(
+    absl::string_view certificate_message, std::string* compressed);
+
+// Decompresses the zlib stream |compressed| into |out|. Returns false unless
+// the stream decompresses to exactly |out.size()| bytes, which is the length
+// the peer announced in its CompressedCertificate message.
+QUIC_EXPORT_PRIVATE bool TlsDecompressCertificate(absl::string_view compressed,
+                                                  absl::Span<uint8_t> out);
+
+// TlsCompressedCertsCache remembers the compressed Certificate message sent
+// for each of the most recently used certificate chains, so that a server only
+// pays the compression cost once per chain. It is thread safe.
+class QUIC_EXPORT_PRIVATE TlsCompressedCertsCache {
+ public:
+  explicit TlsCompressedCertsCache(size_t max_num_chains);
+  TlsCompressedCertsCache(const TlsCompressedCertsCache&) = delete;
+  TlsCompressedCertsCache& operator=(const TlsCompressedCertsCache&) = delete;
+  ~TlsCompressedCertsCache();
+
+  // Writes the compressed form of |certificate_message|, which is the
+  // Certificate message built from |chain|, to |compressed|. The compressed
+  // form is served from the cache if |chain| was seen with the same message
+  // before; otherwise it is computed and cached. |chain| is only used as the
+  // cache key and is never dereferenced. Returns false on failure.
+  bool GetOrCompress(const ProofSource::Chain* chain,
+                     absl::string_view certificate_message,
+                     std::string* compressed);
+
+  // Returns max number of cache entries the cache can carry.
+  size_t MaxSize();
+
+  // Returns current number of cache entries in the cache.
+  size_t Size();
+
+  // Default size of the TlsCompressedCertsCache, matching the size of
+  // QuicCompressedCertsCache.
+  static const size_t kTlsCompressedCertsCacheSize;
+
+ private:
+  struct QUIC_EXPORT_PRIVATE CachedCert {
+    // The uncompressed Certificate message. It also carries the per
+    // certificate extensions, e.g. OCSP responses, so a hit is only a hit if
+    // it is identical to the message being compressed.
+    std::string certificate_message;
+    std::string compressed;
+  };
+
+  QuicMutex mutex_;
+  QuicLRUCache<const ProofSource::Chain*, CachedCert> cache_
+      QUIC_GUARDED_BY(mutex_);
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_TLS_CERT_COMPRESSION_H_
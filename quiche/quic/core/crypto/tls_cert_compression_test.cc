@@ -0,0 +1,112 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/tls_cert_compression.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+std::string CertificateMessage(const std::string& fill) {
+  std::string message;
+  for (int i = 0; i < 100; ++i) {
+    absl::StrAppend(&message, fill, i);
+  }
+  return message;
+}
+
+class TlsCertCompressionTest : public QuicTest {};
+
+TEST_F(TlsCertCompressionTest, RoundTrip) {
+  const std::string message = CertificateMessage("certificate");
+  std::string compressed;
+  ASSERT_TRUE(TlsCompressCertificate(message, &compressed));
+  EXPECT_LT(compressed.size(), message.size());
+
+  std::vector<uint8_t> decompressed(message.size());
+  ASSERT_TRUE(TlsDecompressCertificate(compressed,
+                                       absl::MakeSpan(decompressed)));
+  EXPECT_EQ(message, std::string(decompressed.begin(), decompressed.end()));
+}
+
+TEST_F(TlsCertCompressionTest, DecompressWrongLength) {
+  const std::string message = CertificateMessage("certificate");
+  std::string compressed;
+  ASSERT_TRUE(TlsCompressCertificate(message, &compressed));
+
+  std::vector<uint8_t> too_short(message.size() - 1);
+  EXPECT_FALSE(TlsDecompressCertificate(compressed, absl::MakeSpan(too_short)));
+  std::vector<uint8_t> too_long(message.size() + 1);
+  EXPECT_FALSE(TlsDecompressCertificate(compressed, absl::MakeSpan(too_long)));
+}
+
+TEST_F(TlsCertCompressionTest, DecompressGarbage) {
+  std::vector<uint8_t> out(100);
+  EXPECT_FALSE(TlsDecompressCertificate("not a zlib stream",
+                                        absl::MakeSpan(out)));
+}
+
+TEST_F(TlsCertCompressionTest, CacheHit) {
+  TlsCompressedCertsCache cache(
+      TlsCompressedCertsCache::kTlsCompressedCertsCacheSize);
+  quiche::QuicheReferenceCountedPointer<ProofSource::Chain> chain(
+      new ProofSource::Chain(std::vector<std::string>{"leaf", "root"}));
+  const std::string message = CertificateMessage("certificate");
+
+  std::string compressed1;
+  ASSERT_TRUE(cache.GetOrCompress(chain.get(), message, &compressed1));
+  EXPECT_EQ(1u, cache.Size());
+  std::string compressed2;
+  ASSERT_TRUE(cache.GetOrCompress(chain.get(), message, &compressed2));
+  EXPECT_EQ(1u, cache.Size());
+  EXPECT_EQ(compressed1, compressed2);
+}
+
+TEST_F(TlsCertCompressionTest, CacheMissOnDifferentMessage) {
+  TlsCompressedCertsCache cache(
+      TlsCompressedCertsCache::kTlsCompressedCertsCacheSize);
+  quiche::QuicheReferenceCountedPointer<ProofSource::Chain> chain(
+      new ProofSource::Chain(std::vector<std::string>{"leaf", "root"}));
+
+  // The same chain with a different OCSP response yields a different message,
+  // which must not be answered from the cache.
+  std::string compressed;
+  ASSERT_TRUE(cache.GetOrCompress(chain.get(), CertificateMessage("ocsp1"),
+                                  &compressed));
+  ASSERT_TRUE(cache.GetOrCompress(chain.get(), CertificateMessage("ocsp2"),
+                                  &compressed));
+  EXPECT_EQ(1u, cache.Size());
+
+  std::vector<uint8_t> decompressed(CertificateMessage("ocsp2").size());
+  ASSERT_TRUE(TlsDecompressCertificate(compressed,
+                                       absl::MakeSpan(decompressed)));
+  EXPECT_EQ(CertificateMessage("ocsp2"),
+            std::string(decompressed.begin(), decompressed.end()));
+}
+
+TEST_F(TlsCertCompressionTest, CacheEviction) {
+  TlsCompressedCertsCache cache(1);
+  quiche::QuicheReferenceCountedPointer<ProofSource::Chain> chain1(
+      new ProofSource::Chain(std::vector<std::string>{"leaf1"}));
+  quiche::QuicheReferenceCountedPointer<ProofSource::Chain> chain2(
+      new ProofSource::Chain(std::vector<std::string>{"leaf2"}));
+
+  std::string compressed;
+  ASSERT_TRUE(cache.GetOrCompress(chain1.get(), CertificateMessage("a"),
+                                  &compressed));
+  ASSERT_TRUE(cache.GetOrCompress(chain2.get(), CertificateMessage("b"),
+                                  &compressed));
+  EXPECT_EQ(1u, cache.MaxSize());
+  EXPECT_EQ(1u, cache.Size());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,220 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/tls_client_hello_parser.h"
+
+namespace quic {
+
+namespace {
+
+// Handshake message type of a ClientHello, RFC 8446 section 4.
+const uint8_t kClientHelloType = 1;
+const size_t kHandshakeHeaderLength = 4;
+const size_t kRandomLength = 32;
+const size_t kMaxSessionIdLength = 32;
+
+// Extension codepoints, RFC 8446 section 4.2 and RFC 9001 section 8.2.
+const uint16_t kServerNameExtension = 0;
+const uint16_t kAlpnExtension = 16;
+const uint16_t kPreSharedKeyExtension = 41;
+const uint16_t kEarlyDataExtension = 42;
+const uint16_t kKeyShareExtension = 51;
+const uint16_t kQuicTransportParametersExtension = 0x39;
+const uint16_t kLegacyQuicTransportParametersExtension = 0xffa5;
+
+// The only name type defined by RFC 6066.
+const uint8_t kHostNameType = 0;
+
+}  // namespace
+
+// static
+size_t TlsClientHelloParser::MessageLength(absl::string_view data) {
+  QuicDataReader reader(data);
+  uint8_t type;
+  uint32_t length;
+  if (!reader.ReadUInt8(&type) || !reader.ReadUInt24(&length)) {
+    return 0;
+  }
+  return kHandshakeHeaderLength + length;
+}
+
+TlsClientHelloParser::Result TlsClientHelloParser::Parse(
+    absl::string_view data) {
+  *this = TlsClientHelloParser();
+
+  const size_t message_length = MessageLength(data);
+  if (message_length == 0 || data.length() < message_length) {
+    if (!data.empty() && static_cast<uint8_t>(data[0]) != kClientHelloType) {
+      return Error("Not a ClientHello");
+    }
+    return Result::kIncomplete;
+  }
+  if (static_cast<uint8_t>(data[0]) != kClientHelloType) {
+    return Error("Not a ClientHello");
+  }
+
+  QuicDataReader reader(data.data() + kHandshakeHeaderLength,
+                        message_length - kHandshakeHeaderLength);
+  uint16_t legacy_version;
+  absl::string_view session_id;
+  absl::string_view cipher_suites;
+  absl::string_view compression_methods;
+  if (!reader.ReadUInt16(&legacy_version) || !reader.Seek(kRandomLength) ||
+      !reader.ReadStringPiece8(&session_id) ||
+      session_id.length() > kMaxSessionIdLength ||
+      !reader.ReadStringPiece16(&cipher_suites) || cipher_suites.empty() ||
+      cipher_suites.length() % 2 != 0 ||
+      !reader.ReadStringPiece8(&compression_methods) ||
+      compression_methods.empty()) {
+    return Error("Malformed ClientHello");
+  }
+  if (!ParseExtensions(&reader)) {
+    return Result::kError;
+  }
+  return Result::kParsed;
+}
+
+TlsClientHelloParser::Result TlsClientHelloParser::Error(
+    absl::string_view error_details) {
+  error_details_ = error_details;
+  return Result::kError;
+}
+
+bool TlsClientHelloParser::ParseExtensions(QuicDataReader* reader) {
+  absl::string_view extensions;
+  if (!reader->ReadStringPiece16(&extensions) || !reader->IsDoneReading()) {
+    Error("Malformed ClientHello extensions");
+    return false;
+  }
+  bool seen_server_name = false;
+  bool seen_alpn = false;
+  bool seen_key_share = false;
+  bool seen_transport_parameters = false;
+  QuicDataReader extensions_reader(extensions);
+  while (!extensions_reader.IsDoneReading()) {
+    uint16_t type;
+    absl::string_view extension;
+    if (!extensions_reader.ReadUInt16(&type) ||
+        !extensions_reader.ReadStringPiece16(&extension)) {
+      Error("Malformed extension");
+      return false;
+    }
+    if (resumption_attempted_) {
+      // RFC 8446 section 4.2.11.
+      Error("pre_shared_key is not the last extension");
+      return false;
+    }
+    bool duplicate = false;
+    switch (type) {
+      case kServerNameExtension:
+        duplicate = seen_server_name;
+        seen_server_name = true;
+        if (!duplicate && !ParseServerName(extension)) {
+          return false;
+        }
+        break;
+      case kAlpnExtension:
+        duplicate = seen_alpn;
+        seen_alpn = true;
+        if (!duplicate && !ParseAlpn(extension)) {
+          return false;
+        }
+        break;
+      case kKeyShareExtension:
+        duplicate = seen_key_share;
+        seen_key_share = true;
+        if (!duplicate && !ParseKeyShare(extension)) {
+          return false;
+        }
+        break;
+      case kPreSharedKeyExtension:
+        resumption_attempted_ = true;
+        break;
+      case kEarlyDataExtension:
+        duplicate = early_data_attempted_;
+        early_data_attempted_ = true;
+        break;
+      case kQuicTransportParametersExtension:
+      case kLegacyQuicTransportParametersExtension:
+        // A client sends one of the two codepoints, depending on the version.
+        duplicate = seen_transport_parameters;
+        seen_transport_parameters = true;
+        transport_parameters_ = extension;
+        break;
+      default:
+        break;
+    }
+    if (duplicate) {
+      Error("Duplicate extension");
+      return false;
+    }
+  }
+  return true;
+}
+
+bool TlsClientHelloParser::ParseServerName(absl::string_view extension) {
+  // Like BoringSSL, only accept a list with a single host name.
+  QuicDataReader reader(extension);
+  absl::string_view server_name_list;
+  uint8_t name_type;
+  if (!reader.ReadStringPiece16(&server_name_list) ||
+      !reader.IsDoneReading()) {
+    Error("Malformed server_name extension");
+    return false;
+  }
+  QuicDataReader list_reader(server_name_list);
+  if (!list_reader.ReadUInt8(&name_type) || name_type != kHostNameType ||
+      !list_reader.ReadStringPiece16(&server_name_) || server_name_.empty() ||
+      !list_reader.IsDoneReading() ||
+      server_name_.find('\0') != absl::string_view::npos) {
+    server_name_ = absl::string_view();
+    Error("Malformed server_name extension");
+    return false;
+  }
+  return true;
+}
+
+bool TlsClientHelloParser::ParseAlpn(absl::string_view extension) {
+  QuicDataReader reader(extension);
+  absl::string_view protocol_name_list;
+  if (!reader.ReadStringPiece16(&protocol_name_list) ||
+      !reader.IsDoneReading() || protocol_name_list.empty()) {
+    Error("Malformed ALPN extension");
+    return false;
+  }
+  QuicDataReader list_reader(protocol_name_list);
+  while (!list_reader.IsDoneReading()) {
+    absl::string_view alpn;
+    if (!list_reader.ReadStringPiece8(&alpn) || alpn.empty()) {
+      Error("Malformed ALPN extension");
+      return false;
+    }
+    alpns_.push_back(alpn);
+  }
+  return true;
+}
+
+bool TlsClientHelloParser::ParseKeyShare(absl::string_view extension) {
+  QuicDataReader reader(extension);
+  absl::string_view client_shares;
+  if (!reader.ReadStringPiece16(&client_shares) || !reader.IsDoneReading()) {
+    Error("Malformed key_share extension");
+    return false;
+  }
+  QuicDataReader shares_reader(client_shares);
+  while (!shares_reader.IsDoneReading()) {
+    uint16_t group;
+    absl::string_view key_exchange;
+    if (!shares_reader.ReadUInt16(&group) ||
+        !shares_reader.ReadStringPiece16(&key_exchange) ||
+        key_exchange.empty()) {
+      Error("Malformed key_share extension");
+      return false;
+    }
+    key_share_groups_.push_back(group);
+  }
+  return true;
+}
+
+}  // namespace quic
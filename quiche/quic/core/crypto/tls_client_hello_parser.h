@@ -0,0 +1,86 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_TLS_CLIENT_HELLO_PARSER_H_
+#define QUICHE_QUIC_CORE_CRYPTO_TLS_CLIENT_HELLO_PARSER_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/container/inlined_vector.h"
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/quic_data_reader.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// TlsClientHelloParser extracts the fields of a TLS 1.3 ClientHello which are
+// needed to route or filter a connection (SNI, ALPN, key share groups,
+// resumption and early data attempts, and the QUIC transport parameters
+// extension) from the contents of the Initial crypto stream, without creating
+// an SSL object. It checks the framing of the message and of the extensions it
+// extracts, but it does not validate the ClientHello the way a TLS stack does;
+// the handshake itself is still done by BoringSSL once a session is created.
+//
+// Parse() does not copy or allocate in the common case: the extracted strings
+// point into the parsed buffer, which must outlive their use.
+class QUIC_EXPORT_PRIVATE TlsClientHelloParser {
+ public:
+  enum class Result : uint8_t {
+    // |data| is a prefix of a ClientHello; more crypto stream data is needed.
+    kIncomplete,
+    kParsed,
+    kError,
+  };
+
+  // Returns the total length of the handshake message starting at |data|,
+  // including its four byte header, or 0 if |data| is too short to tell.
+  static size_t MessageLength(absl::string_view data);
+
+  // Parses the ClientHello at the start of |data|, which is the Initial crypto
+  // stream starting from offset 0. Any bytes following the ClientHello are
+  // ignored. Resets the results of previous calls.
+  Result Parse(absl::string_view data);
+
+  // Accessors for the results of a successful Parse().
+  absl::string_view server_name() const { return server_name_; }
+  const absl::InlinedVector<absl::string_view, 4>& alpns() const {
+    return alpns_;
+  }
+  const absl::InlinedVector<uint16_t, 4>& key_share_groups() const {
+    return key_share_groups_;
+  }
+  // Whether the 'pre_shared_key' extension, i.e. a session ticket, is present.
+  bool resumption_attempted() const { return resumption_attempted_; }
+  // Whether the 'early_data' extension is present.
+  bool early_data_attempted() const { return early_data_attempted_; }
+  // Body of the 'quic_transport_parameters' extension, using either the RFC
+  // 9001 or the legacy codepoint. Empty if the extension is absent.
+  absl::string_view transport_parameters() const {
+    return transport_parameters_;
+  }
+
+  // Describes why the last call to Parse() returned kError.
+  absl::string_view error_details() const { return error_details_; }
+
+ private:
+  Result Error(absl::string_view error_details);
+  bool ParseExtensions(QuicDataReader* reader);
+  bool ParseServerName(absl::string_view extension);
+  bool ParseAlpn(absl::string_view extension);
+  bool ParseKeyShare(absl::string_view extension);
+
+  absl::string_view server_name_;
+  absl::InlinedVector<absl::string_view, 4> alpns_;
+  absl::InlinedVector<uint16_t, 4> key_share_groups_;
+  bool resumption_attempted_ = false;
+  bool early_data_attempted_ = false;
+  absl::string_view transport_parameters_;
+  // Always points to a string literal.
+  absl::string_view error_details_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_TLS_CLIENT_HELLO_PARSER_H_
@@ -0,0 +1,158 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/tls_client_hello_parser.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+using Result = TlsClientHelloParser::Result;
+using testing::ElementsAre;
+
+std::string Uint16(uint16_t value) {
+  return std::string({static_cast<char>(value >> 8), static_cast<char>(value)});
+}
+
+std::string LengthPrefixed8(absl::string_view data) {
+  return absl::StrCat(std::string(1, static_cast<char>(data.length())), data);
+}
+
+std::string LengthPrefixed16(absl::string_view data) {
+  return absl::StrCat(Uint16(data.length()), data);
+}
+
+std::string Extension(uint16_t type, absl::string_view body) {
+  return absl::StrCat(Uint16(type), LengthPrefixed16(body));
+}
+
+std::string ServerNameExtension(absl::string_view host_name) {
+  return Extension(0, LengthPrefixed16(absl::StrCat(
+                          std::string(1, '\0'), LengthPrefixed16(host_name))));
+}
+
+std::string AlpnExtension(const std::vector<std::string>& alpns) {
+  std::string list;
+  for (const std::string& alpn : alpns) {
+    absl::StrAppend(&list, LengthPrefixed8(alpn));
+  }
+  return Extension(16, LengthPrefixed16(list));
+}
+
+std::string KeyShareExtension(const std::vector<uint16_t>& groups) {
+  std::string shares;
+  for (uint16_t group : groups) {
+    absl::StrAppend(&shares, Uint16(group),
+                    LengthPrefixed16(std::string(32, 'k')));
+  }
+  return Extension(51, LengthPrefixed16(shares));
+}
+
+// Wraps |extensions| in a ClientHello handshake message.
+std::string ClientHello(absl::string_view extensions) {
+  const std::string body = absl::StrCat(
+      Uint16(0x0303), std::string(32, 'r'), LengthPrefixed8(""),
+      LengthPrefixed16(Uint16(0x1301)), LengthPrefixed8(std::string(1, '\0')),
+      LengthPrefixed16(extensions));
+  return absl::StrCat(std::string(1, '\x01'), std::string(1, '\0'),
+                      Uint16(body.length()), body);
+}
+
+class TlsClientHelloParserTest : public QuicTest {
+ protected:
+  TlsClientHelloParser parser_;
+};
+
+TEST_F(TlsClientHelloParserTest, ParseAllFields) {
+  const std::string chlo = ClientHello(absl::StrCat(
+      ServerNameExtension("www.example.org"), AlpnExtension({"h3", "hq"}),
+      KeyShareExtension({0x001d, 0x0017}), Extension(0x39, "params"),
+      Extension(42, ""), Extension(41, "psk")));
+  ASSERT_EQ(Result::kParsed, parser_.Parse(chlo));
+  EXPECT_EQ("www.example.org", parser_.server_name());
+  EXPECT_THAT(parser_.alpns(), ElementsAre("h3", "hq"));
+  EXPECT_THAT(parser_.key_share_groups(), ElementsAre(0x001d, 0x0017));
+  EXPECT_EQ("params", parser_.transport_parameters());
+  EXPECT_TRUE(parser_.early_data_attempted());
+  EXPECT_TRUE(parser_.resumption_attempted());
+  EXPECT_EQ(chlo.length(), TlsClientHelloParser::MessageLength(chlo));
+}
+
+TEST_F(TlsClientHelloParserTest, NoExtensions) {
+  ASSERT_EQ(Result::kParsed, parser_.Parse(ClientHello("")));
+  EXPECT_TRUE(parser_.server_name().empty());
+  EXPECT_TRUE(parser_.alpns().empty());
+  EXPECT_TRUE(parser_.key_share_groups().empty());
+  EXPECT_TRUE(parser_.transport_parameters().empty());
+  EXPECT_FALSE(parser_.early_data_attempted());
+  EXPECT_FALSE(parser_.resumption_attempted());
+}
+
+TEST_F(TlsClientHelloParserTest, LegacyTransportParameters) {
+  ASSERT_EQ(Result::kParsed,
+            parser_.Parse(ClientHello(Extension(0xffa5, "legacy"))));
+  EXPECT_EQ("legacy", parser_.transport_parameters());
+}
+
+TEST_F(TlsClientHelloParserTest, Incomplete) {
+  const std::string chlo = ClientHello(absl::StrCat(
+      ServerNameExtension("www.example.org"), AlpnExtension({"h3"})));
+  for (size_t length = 0; length < chlo.length(); ++length) {
+    EXPECT_EQ(Result::kIncomplete, parser_.Parse(chlo.substr(0, length)))
+        << length;
+  }
+  // Data following the ClientHello is ignored.
+  ASSERT_EQ(Result::kParsed, parser_.Parse(absl::StrCat(chlo, "trailing")));
+  EXPECT_EQ("www.example.org", parser_.server_name());
+}
+
+TEST_F(TlsClientHelloParserTest, ResetsBetweenCalls) {
+  ASSERT_EQ(Result::kParsed, parser_.Parse(ClientHello(absl::StrCat(
+                                 ServerNameExtension("www.example.org"),
+                                 AlpnExtension({"h3"})))));
+  ASSERT_EQ(Result::kParsed, parser_.Parse(ClientHello("")));
+  EXPECT_TRUE(parser_.server_name().empty());
+  EXPECT_TRUE(parser_.alpns().empty());
+}
+
+TEST_F(TlsClientHelloParserTest, NotClientHello) {
+  std::string chlo = ClientHello("");
+  chlo[0] = 2;
+  EXPECT_EQ(Result::kError, parser_.Parse(chlo));
+  EXPECT_EQ(Result::kError, parser_.Parse(chlo.substr(0, 1)));
+}
+
+TEST_F(TlsClientHelloParserTest, MalformedExtensions) {
+  const std::string bad_extensions[] = {
+      // Truncated extension.
+      absl::StrCat(Uint16(0), Uint16(10), "short"),
+      // Duplicate extensions.
+      absl::StrCat(AlpnExtension({"h3"}), AlpnExtension({"h3"})),
+      absl::StrCat(Extension(0x39, ""), Extension(0xffa5, "")),
+      // pre_shared_key must be last.
+      absl::StrCat(Extension(41, "psk"), Extension(42, "")),
+      // Empty ALPN list and empty protocol name.
+      Extension(16, LengthPrefixed16("")),
+      AlpnExtension({""}),
+      // Empty host name, and a host name containing NUL.
+      ServerNameExtension(""),
+      ServerNameExtension(std::string("a\0b", 3)),
+      // Empty key exchange.
+      Extension(51, LengthPrefixed16(absl::StrCat(Uint16(0x001d), Uint16(0)))),
+  };
+  for (const std::string& extensions : bad_extensions) {
+    EXPECT_EQ(Result::kError, parser_.Parse(ClientHello(extensions)));
+    EXPECT_FALSE(parser_.error_details().empty());
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
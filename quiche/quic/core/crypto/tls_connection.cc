@@ -6,7 +6,10 @@
 
 #include "absl/strings/string_view.h"
 #include "openssl/ssl.h"
+#include "quiche/quic/core/crypto/tls_cert_compression.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
+#include "quiche/quic/platform/api/quic_flag_utils.h"
+#include "quiche/quic/platform/api/quic_flags.h"
 
 namespace quic {
 
@@ -132,6 +135,12 @@ bssl::UniquePtr<SSL_CTX> TlsConnection::CreateSslCtx() {
   SSL_CTX_set_min_proto_version(ssl_ctx.get(), TLS1_3_VERSION);
   SSL_CTX_set_max_proto_version(ssl_ctx.get(), TLS1_3_VERSION);
   SSL_CTX_set_quic_method(ssl_ctx.get(), &kSslQuicMethod);
+  if (GetQuicReloadableFlag(quic_tls_compress_certificates)) {
+    QUIC_RELOADABLE_FLAG_COUNT(quic_tls_compress_certificates);
+    SSL_CTX_add_cert_compression_alg(
+        ssl_ctx.get(), kTlsCertCompressionAlgorithmZlib,
+        CompressCertificateCallback, DecompressCertificateCallback);
+  }
   return ssl_ctx;
 }
 
@@ -203,4 +212,39 @@ int TlsConnection::SendAlertCallback(SSL* ssl,
   return 1;
 }
 
+// static
+int TlsConnection::CompressCertificateCallback(SSL* ssl, CBB* out,
+                                               const uint8_t* in,
+                                               size_t in_len) {
+  std::string compressed;
+  if (!ConnectionFromSsl(ssl)->delegate_->CompressCertificate(
+          absl::string_view(reinterpret_cast<const char*>(in), in_len),
+          &compressed)) {
+    return 0;
+  }
+  return CBB_add_bytes(out, reinterpret_cast<const uint8_t*>(compressed.data()),
+                       compressed.size());
+}
+
+// static
+int TlsConnection::DecompressCertificateCallback(SSL* /*ssl*/,
+                                                 CRYPTO_BUFFER** out,
+                                                 size_t uncompressed_len,
+                                                 const uint8_t* in,
+                                                 size_t in_len) {
+  // BoringSSL has already rejected |uncompressed_len| values above its
+  // certificate size limit.
+  uint8_t* data;
+  bssl::UniquePtr<CRYPTO_BUFFER> buffer(
+      CRYPTO_BUFFER_alloc(&data, uncompressed_len));
+  if (buffer == nullptr ||
+      !TlsDecompressCertificate(
+          absl::string_view(reinterpret_cast<const char*>(in), in_len),
+          absl::MakeSpan(data, uncompressed_len))) {
+    return 0;
+  }
+  *out = buffer.release();
+  return 1;
+}
+
 }  // namespace quic
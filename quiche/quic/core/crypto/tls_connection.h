@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_CRYPTO_TLS_CONNECTION_H_
 #define QUICHE_QUIC_CORE_CRYPTO_TLS_CONNECTION_H_
 
+#include <string>
 #include <vector>
 
 #include "absl/strings/string_view.h"
@@ -79,6 +80,12 @@ class QUIC_EXPORT_PRIVATE TlsConnection {
     // See |SSL_CTX_set_info_callback| for the meaning of |type| and |value|.
     virtual void InfoCallback(int type, int value) = 0;
 
+    // Compresses the Certificate message |certificate_message| this endpoint
+    // is about to send, see RFC 8879. Returns false on failure, in which case
+    // the message is sent uncompressed.
+    virtual bool CompressCertificate(absl::string_view certificate_message,
+                                     std::string* compressed) = 0;
+
     friend class TlsConnection;
   };
 
@@ -143,6 +150,15 @@ class QUIC_EXPORT_PRIVATE TlsConnection {
   static int SendAlertCallback(SSL* ssl, enum ssl_encryption_level_t level,
                                uint8_t desc);
 
+  // Registered as the compression and decompression functions of the zlib
+  // certificate compression algorithm. Compression is delegated to
+  // Delegate::CompressCertificate.
+  static int CompressCertificateCallback(SSL* ssl, CBB* out,
+                                         const uint8_t* in, size_t in_len);
+  static int DecompressCertificateCallback(SSL* ssl, CRYPTO_BUFFER** out,
+                                           size_t uncompressed_len,
+                                           const uint8_t* in, size_t in_len);
+
   Delegate* delegate_;
   bssl::UniquePtr<SSL> ssl_;
   QuicSSLConfig ssl_config_;
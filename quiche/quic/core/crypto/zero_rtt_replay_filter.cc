@@ -0,0 +1,92 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/zero_rtt_replay_filter.h"
+
+#include "absl/numeric/int128.h"
+#include "quiche/quic/core/quic_utils.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Number of bits set in a word for each ClientHello. Each takes 6 bits of the
+// hash.
+constexpr int kNumBitsPerClientHello = 8;
+
+}  // namespace
+
+// static
+size_t ZeroRttReplayFilter::MemorySize(size_t num_words) {
+  return sizeof(Header) + 2 * num_words * sizeof(uint64_t);
+}
+
+ZeroRttReplayFilter::ZeroRttReplayFilter(void* memory, size_t num_words,
+                                         QuicTime::Delta window)
+    : header_(static_cast<Header*>(memory)),
+      words_(reinterpret_cast<std::atomic<uint64_t>*>(header_ + 1)),
+      num_words_(num_words),
+      window_(window) {
+  QUICHE_DCHECK_EQ(0u, reinterpret_cast<uintptr_t>(memory) % sizeof(uint64_t));
+  QUICHE_DCHECK_LT(0u, num_words_);
+}
+
+bool ZeroRttReplayFilter::CheckAndInsert(absl::string_view client_hello_id,
+                                         QuicWallTime now) {
+  MaybeRotate(now);
+
+  const absl::uint128 hash = QuicUtils::FNV1a_128_Hash(client_hello_id);
+  const size_t index = absl::Uint128Low64(hash) % num_words_;
+  uint64_t bits = absl::Uint128High64(hash);
+  uint64_t mask = 0;
+  for (int i = 0; i < kNumBitsPerClientHello; ++i) {
+    mask |= uint64_t{1} << (bits & 63);
+    bits >>= 6;
+  }
+
+  const uint64_t generation =
+      header_->generation.load(std::memory_order_acquire);
+  const uint64_t previous =
+      GenerationWords(generation + 1)[index].load(std::memory_order_relaxed);
+  if ((previous & mask) == mask) {
+    return false;
+  }
+  const uint64_t current = GenerationWords(generation)[index].fetch_or(
+      mask, std::memory_order_relaxed);
+  return (current & mask) != mask;
+}
+
+void ZeroRttReplayFilter::MaybeRotate(QuicWallTime now) {
+  const uint64_t now_us = now.ToUNIXMicroseconds();
+  uint64_t start = header_->generation_start.load(std::memory_order_acquire);
+  if (start == 0) {
+    // First use of the memory region; whichever filter wins starts the first
+    // generation.
+    header_->generation_start.compare_exchange_strong(start, now_us);
+    return;
+  }
+  if (now_us < start ||
+      now_us - start < static_cast<uint64_t>(window_.ToMicroseconds())) {
+    return;
+  }
+  if (!header_->generation_start.compare_exchange_strong(start, now_us)) {
+    // Another filter is rotating.
+    return;
+  }
+
+  // The previous generation becomes the next current one. Clear it before
+  // publishing the new generation, so that no ClientHello is recorded into a
+  // word about to be cleared.
+  const uint64_t generation =
+      header_->generation.load(std::memory_order_relaxed);
+  std::atomic<uint64_t>* words = GenerationWords(generation + 1);
+  for (size_t i = 0; i < num_words_; ++i) {
+    words[i].store(0, std::memory_order_relaxed);
+  }
+  header_->generation.store(generation + 1, std::memory_order_release);
+  QUIC_DVLOG(1) << "Started 0-RTT replay filter generation " << generation + 1;
+}
+
+}  // namespace quic
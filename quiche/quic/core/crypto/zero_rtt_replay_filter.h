@@ -0,0 +1,82 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_CRYPTO_ZERO_RTT_REPLAY_FILTER_H_
+#define QUICHE_QUIC_CORE_CRYPTO_ZERO_RTT_REPLAY_FILTER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// ZeroRttReplayFilter remembers the ClientHellos which offered early data, so
+// that a server can reject the early data of a replayed ClientHello (RFC 8446
+// section 8.2). It is a blocked Bloom filter with two generations which take
+// turns: a ClientHello is remembered for at least |window| and at most twice
+// that. A false positive only makes the server reject early data which was not
+// replayed, and the client then resends it in 1-RTT.
+//
+// All state lives in a memory region provided by the caller, which may be
+// shared between processes, e.g. a memory mapped file. Any number of threads
+// and processes may use filters over the same region concurrently; checking
+// and recording a ClientHello is a single atomic operation, so concurrent
+// copies of one ClientHello are never all accepted.
+class QUIC_EXPORT_PRIVATE ZeroRttReplayFilter {
+ public:
+  static_assert(std::atomic<uint64_t>::is_always_lock_free,
+                "ZeroRttReplayFilter needs lock free atomics to be shared "
+                "between processes");
+
+  // Returns the size of the memory region of a filter with |num_words| 64-bit
+  // words per generation. Each word holds about one ClientHello with a low
+  // false positive rate, so |num_words| should be at least the number of
+  // ClientHellos offering early data expected within |window|.
+  static size_t MemorySize(size_t num_words);
+
+  // |memory| must be 8-byte aligned, MemorySize(|num_words|) bytes long and
+  // zero-filled before its first use by any filter, and it must outlive the
+  // filter. All filters sharing |memory| must use the same |num_words| and
+  // |window|.
+  ZeroRttReplayFilter(void* memory, size_t num_words, QuicTime::Delta window);
+  ZeroRttReplayFilter(const ZeroRttReplayFilter&) = delete;
+  ZeroRttReplayFilter& operator=(const ZeroRttReplayFilter&) = delete;
+
+  // Records |client_hello_id|, a value which identifies the early data of a
+  // ClientHello such as its session ticket, and returns true if it was not
+  // recorded before.
+  // Returns false if it may have been recorded before, in which case the
+  // early data of the ClientHello should be rejected.
+  bool CheckAndInsert(absl::string_view client_hello_id, QuicWallTime now);
+
+ private:
+  struct Header {
+    // Start of the current generation, in UNIX microseconds. Zero until the
+    // first use.
+    std::atomic<uint64_t> generation_start;
+    // Incremented whenever a generation starts; its parity selects the words
+    // of the current generation.
+    std::atomic<uint64_t> generation;
+  };
+
+  // Starts a new generation if the current one is older than |window_|.
+  void MaybeRotate(QuicWallTime now);
+
+  std::atomic<uint64_t>* GenerationWords(uint64_t generation) const {
+    return words_ + (generation % 2) * num_words_;
+  }
+
+  Header* const header_;
+  std::atomic<uint64_t>* const words_;
+  const size_t num_words_;
+  const QuicTime::Delta window_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_CRYPTO_ZERO_RTT_REPLAY_FILTER_H_
@@ -0,0 +1,88 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/crypto/zero_rtt_replay_filter.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr size_t kNumWords = 1024;
+constexpr QuicTime::Delta kWindow = QuicTime::Delta::FromSeconds(10);
+
+class ZeroRttReplayFilterTest : public QuicTest {
+ public:
+  ZeroRttReplayFilterTest()
+      : memory_(ZeroRttReplayFilter::MemorySize(kNumWords) / sizeof(uint64_t)),
+        filter_(memory_.data(), kNumWords, kWindow),
+        now_(QuicWallTime::FromUNIXSeconds(1000000)) {}
+
+ protected:
+  std::vector<uint64_t> memory_;
+  ZeroRttReplayFilter filter_;
+  QuicWallTime now_;
+};
+
+TEST_F(ZeroRttReplayFilterTest, RejectsReplay) {
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 1", now_));
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 2", now_));
+  EXPECT_FALSE(filter_.CheckAndInsert("client hello 1", now_));
+  EXPECT_FALSE(filter_.CheckAndInsert("client hello 2", now_));
+}
+
+TEST_F(ZeroRttReplayFilterTest, RemembersForAtLeastWindow) {
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 1", now_));
+  // Still rejected after the first rotation, when the ClientHello moves to
+  // the previous generation.
+  now_ = now_.Add(kWindow);
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 2", now_));
+  EXPECT_FALSE(filter_.CheckAndInsert("client hello 1", now_));
+
+  // Forgotten after the second rotation, but "client hello 2" is still
+  // remembered.
+  now_ = now_.Add(kWindow);
+  EXPECT_FALSE(filter_.CheckAndInsert("client hello 2", now_));
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 1", now_));
+}
+
+TEST_F(ZeroRttReplayFilterTest, SharedMemory) {
+  // A second filter over the same memory, as in another process, sees the
+  // ClientHellos recorded by the first.
+  ZeroRttReplayFilter other_filter(memory_.data(), kNumWords, kWindow);
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 1", now_));
+  EXPECT_FALSE(other_filter.CheckAndInsert("client hello 1", now_));
+  EXPECT_TRUE(other_filter.CheckAndInsert("client hello 2", now_));
+  EXPECT_FALSE(filter_.CheckAndInsert("client hello 2", now_));
+
+  // Rotations by either filter are seen by both.
+  now_ = now_.Add(kWindow);
+  EXPECT_TRUE(other_filter.CheckAndInsert("client hello 3", now_));
+  now_ = now_.Add(kWindow);
+  EXPECT_TRUE(filter_.CheckAndInsert("client hello 1", now_));
+  EXPECT_FALSE(other_filter.CheckAndInsert("client hello 3", now_));
+}
+
+TEST_F(ZeroRttReplayFilterTest, LowFalsePositiveRate) {
+  int false_positives = 0;
+  for (size_t i = 0; i < kNumWords; ++i) {
+    if (!filter_.CheckAndInsert(absl::StrCat("client hello ", i), now_)) {
+      ++false_positives;
+    }
+  }
+  EXPECT_LT(false_positives, 10);
+  for (size_t i = 0; i < kNumWords; ++i) {
+    EXPECT_FALSE(
+        filter_.CheckAndInsert(absl::StrCat("client hello ", i), now_));
+  }
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
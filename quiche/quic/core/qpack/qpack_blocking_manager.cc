@@ -4,12 +4,21 @@
 
 #include "quiche/quic/core/qpack/qpack_blocking_manager.h"
 
+#include <algorithm>
 #include <limits>
 #include <utility>
 
 namespace quic {
 
-QpackBlockingManager::QpackBlockingManager() : known_received_count_(0) {}
+QpackBlockingManager::IndexSet::IndexSet(
+    std::initializer_list<uint64_t> indices) {
+  for (const uint64_t index : indices) {
+    insert(index);
+  }
+}
+
+QpackBlockingManager::QpackBlockingManager()
+    : header_block_counts_base_(0), known_received_count_(0) {}
 
 bool QpackBlockingManager::OnHeaderAcknowledgement(QuicStreamId stream_id) {
   auto it = header_blocks_.find(stream_id);
@@ -29,7 +38,7 @@ bool QpackBlockingManager::OnHeaderAcknowledgement(QuicStreamId stream_id) {
 
   DecreaseReferenceCounts(indices);
 
-  it->second.pop_front();
+  it->second.erase(it->second.begin());
   if (it->second.empty()) {
     header_blocks_.erase(it);
   }
@@ -119,39 +128,79 @@ bool QpackBlockingManager::blocking_allowed_on_stream(
   return true;
 }
 
-uint64_t QpackBlockingManager::smallest_blocking_index() const {
-  return entry_reference_counts_.empty()
-             ? std::numeric_limits<uint64_t>::max()
-             : entry_reference_counts_.begin()->first;
-}
-
 // static
 uint64_t QpackBlockingManager::RequiredInsertCount(const IndexSet& indices) {
-  return *indices.rbegin() + 1;
+  return indices.largest_index() + 1;
+}
+
+uint64_t QpackBlockingManager::smallest_blocking_index() const {
+  uint64_t smallest_index = header_block_counts_.empty()
+                                ? std::numeric_limits<uint64_t>::max()
+                                : header_block_counts_base_;
+  if (!distant_header_block_counts_.empty()) {
+    smallest_index =
+        std::min(smallest_index, distant_header_block_counts_.begin()->first);
+  }
+  return smallest_index;
 }
 
 void QpackBlockingManager::IncreaseReferenceCounts(const IndexSet& indices) {
-  for (const uint64_t index : indices) {
-    auto it = entry_reference_counts_.lower_bound(index);
-    if (it != entry_reference_counts_.end() && it->first == index) {
-      ++it->second;
-    } else {
-      entry_reference_counts_.insert(it, {index, 1});
+  const uint64_t index = indices.smallest_index();
+  if (header_block_counts_.empty()) {
+    header_block_counts_base_ = index;
+    header_block_counts_.push_back(1);
+    return;
+  }
+
+  // A header block may refer to an entry older than any currently blocking
+  // one, if that entry has not been evicted yet.  Extending the deque costs
+  // one element per index, so references too far from the indices it covers
+  // are counted in a map instead.
+  if (index < header_block_counts_base_) {
+    if (header_block_counts_base_ - index >
+        kMaxHeaderBlockCountsSize - header_block_counts_.size()) {
+      ++distant_header_block_counts_[index];
+      return;
+    }
+    while (index < header_block_counts_base_) {
+      header_block_counts_.push_front(0);
+      --header_block_counts_base_;
     }
   }
+  const uint64_t offset = index - header_block_counts_base_;
+  if (offset >= kMaxHeaderBlockCountsSize) {
+    ++distant_header_block_counts_[index];
+    return;
+  }
+  if (offset >= header_block_counts_.size()) {
+    header_block_counts_.resize(offset + 1, 0);
+  }
+  ++header_block_counts_[offset];
 }
 
 void QpackBlockingManager::DecreaseReferenceCounts(const IndexSet& indices) {
-  for (const uint64_t index : indices) {
-    auto it = entry_reference_counts_.find(index);
-    QUICHE_DCHECK(it != entry_reference_counts_.end());
+  const uint64_t index = indices.smallest_index();
+  auto it = distant_header_block_counts_.find(index);
+  if (it != distant_header_block_counts_.end()) {
     QUICHE_DCHECK_NE(0u, it->second);
-
-    if (it->second == 1) {
-      entry_reference_counts_.erase(it);
-    } else {
-      --it->second;
+    if (--it->second == 0) {
+      distant_header_block_counts_.erase(it);
     }
+    return;
+  }
+
+  QUICHE_DCHECK_LE(header_block_counts_base_, index);
+  QUICHE_DCHECK_LT(index - header_block_counts_base_,
+                   header_block_counts_.size());
+
+  uint64_t& count = header_block_counts_[index - header_block_counts_base_];
+  QUICHE_DCHECK_NE(0u, count);
+  --count;
+
+  // Restore the invariant that the first element is not zero.
+  while (!header_block_counts_.empty() && header_block_counts_.front() == 0) {
+    header_block_counts_.pop_front();
+    ++header_block_counts_base_;
   }
 }
 
@@ -5,13 +5,17 @@
 #ifndef QUICHE_QUIC_CORE_QPACK_QPACK_BLOCKING_MANAGER_H_
 #define QUICHE_QUIC_CORE_QPACK_QPACK_BLOCKING_MANAGER_H_
 
+#include <algorithm>
 #include <cstdint>
+#include <initializer_list>
+#include <limits>
 #include <map>
-#include <set>
 
 #include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/common/quiche_circular_deque.h"
 
 namespace quic {
 
@@ -26,7 +30,32 @@ class QpackBlockingManagerPeer;
 // https://quicwg.org/base-drafts/draft-ietf-quic-qpack.html#blocked-insertion
 class QUIC_EXPORT_PRIVATE QpackBlockingManager {
  public:
-  using IndexSet = std::multiset<uint64_t>;
+  // The dynamic table references of a single header block.  Only the smallest
+  // and the largest referenced index matter: the former determines which
+  // entries must not be evicted, the latter the Required Insert Count.  Entries
+  // in between are protected from eviction by the smallest one, since entries
+  // are evicted in order.  Therefore this is constant size, and recording a
+  // reference is O(1).
+  class QUIC_EXPORT_PRIVATE IndexSet {
+   public:
+    IndexSet() = default;
+    IndexSet(std::initializer_list<uint64_t> indices);
+
+    void insert(uint64_t index) {
+      smallest_index_ = std::min(smallest_index_, index);
+      largest_index_ = std::max(largest_index_, index);
+    }
+
+    bool empty() const { return smallest_index_ > largest_index_; }
+
+    // Must not be called if empty.
+    uint64_t smallest_index() const { return smallest_index_; }
+    uint64_t largest_index() const { return largest_index_; }
+
+   private:
+    uint64_t smallest_index_ = std::numeric_limits<uint64_t>::max();
+    uint64_t largest_index_ = 0;
+  };
 
   QpackBlockingManager();
 
@@ -74,21 +103,37 @@ class QUIC_EXPORT_PRIVATE QpackBlockingManager {
   // A stream typically has only one header block, except for the rare cases of
   // 1xx responses, trailers, or push promises.  Even if there are multiple
   // header blocks sent on a single stream, they might not be blocked at the
-  // same time.  Use std::list instead of quiche::QuicheCircularDeque because it
-  // has lower memory footprint when holding few elements.
-  using HeaderBlocksForStream = std::list<IndexSet>;
+  // same time.  Store one header block inline, so that the common case does
+  // not allocate.
+  using HeaderBlocksForStream = absl::InlinedVector<IndexSet, 1>;
   using HeaderBlocks = absl::flat_hash_map<QuicStreamId, HeaderBlocksForStream>;
 
-  // Increase or decrease the reference count for each index in |indices|.
+  // Maximum number of elements of |header_block_counts_|, which bounds both
+  // its memory and the cost of extending it towards an older index.
+  static constexpr uint64_t kMaxHeaderBlockCountsSize = 1024;
+
+  // Increase or decrease the number of header blocks whose smallest
+  // referenced index is that of |indices|.
   void IncreaseReferenceCounts(const IndexSet& indices);
   void DecreaseReferenceCounts(const IndexSet& indices);
 
-  // Multiset of indices in each header block for each stream.
+  // Indices in each header block for each stream.
   // Must not contain a stream id with an empty queue.
   HeaderBlocks header_blocks_;
 
-  // Number of references in |header_blocks_| for each entry index.
-  std::map<uint64_t, uint64_t> entry_reference_counts_;
+  // Number of header blocks in |header_blocks_| whose smallest referenced
+  // index is |header_block_counts_base_ + i|, at position i.  The first
+  // element is never zero, so that |header_block_counts_base_| is the smallest
+  // blocking index of the deque whenever it is not empty.  Entries are
+  // usually referenced close to the end of the dynamic table, so the deque
+  // stays short; it never exceeds kMaxHeaderBlockCountsSize elements.
+  quiche::QuicheCircularDeque<uint64_t> header_block_counts_;
+  uint64_t header_block_counts_base_;
+  // Number of header blocks for smallest referenced indices which were too far
+  // from |header_block_counts_base_| to be counted in |header_block_counts_|
+  // when the header block was sent.  Never contains a zero count.  Counts for
+  // the same index are interchangeable, so an index may be counted in both.
+  std::map<uint64_t, uint64_t> distant_header_block_counts_;
 
   uint64_t known_received_count_;
 };
@@ -29,6 +29,10 @@ class QpackBlockingManagerPeer {
 
     return false;
   }
+
+  static size_t header_block_counts_size(const QpackBlockingManager* manager) {
+    return manager->header_block_counts_.size();
+  }
 };
 
 namespace {
@@ -171,6 +175,70 @@ TEST_F(QpackBlockingManagerTest, SmallestBlockingIndex) {
             manager_.smallest_blocking_index());
 }
 
+TEST_F(QpackBlockingManagerTest, SmallestBlockingIndexOutOfOrder) {
+  manager_.OnHeaderBlockSent(0, {5, 7});
+  EXPECT_EQ(5u, manager_.smallest_blocking_index());
+
+  // Header blocks may refer to entries older than any blocking one.
+  manager_.OnHeaderBlockSent(1, {2, 8});
+  EXPECT_EQ(2u, manager_.smallest_blocking_index());
+
+  manager_.OnHeaderBlockSent(2, {9});
+  manager_.OnHeaderBlockSent(3, {2});
+  EXPECT_EQ(2u, manager_.smallest_blocking_index());
+
+  EXPECT_TRUE(manager_.OnHeaderAcknowledgement(1));
+  EXPECT_EQ(2u, manager_.smallest_blocking_index());
+
+  manager_.OnStreamCancellation(3);
+  EXPECT_EQ(5u, manager_.smallest_blocking_index());
+
+  EXPECT_TRUE(manager_.OnHeaderAcknowledgement(0));
+  EXPECT_EQ(9u, manager_.smallest_blocking_index());
+  EXPECT_EQ(9u, manager_.known_received_count());
+
+  EXPECT_TRUE(manager_.OnHeaderAcknowledgement(2));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+            manager_.smallest_blocking_index());
+
+  // Bookkeeping starts over at any index once there are no blocking entries.
+  manager_.OnHeaderBlockSent(0, {1});
+  EXPECT_EQ(1u, manager_.smallest_blocking_index());
+}
+
+TEST_F(QpackBlockingManagerTest, SmallestBlockingIndexFarApart) {
+  manager_.OnHeaderBlockSent(0, {1000000});
+  EXPECT_EQ(1000000u, manager_.smallest_blocking_index());
+
+  // References far from each other do not grow the bookkeeping with the
+  // distance between them, in either direction.
+  manager_.OnHeaderBlockSent(1, {0, 1000001});
+  EXPECT_EQ(0u, manager_.smallest_blocking_index());
+  manager_.OnHeaderBlockSent(2, {2000000});
+  manager_.OnHeaderBlockSent(3, {1000002});
+  EXPECT_EQ(0u, manager_.smallest_blocking_index());
+  EXPECT_EQ(3u, QpackBlockingManagerPeer::header_block_counts_size(&manager_));
+
+  EXPECT_TRUE(manager_.OnHeaderAcknowledgement(1));
+  EXPECT_EQ(1000000u, manager_.smallest_blocking_index());
+
+  EXPECT_TRUE(manager_.OnHeaderAcknowledgement(0));
+  EXPECT_EQ(1000002u, manager_.smallest_blocking_index());
+
+  manager_.OnStreamCancellation(3);
+  EXPECT_EQ(2000000u, manager_.smallest_blocking_index());
+
+  // A reference close to a distant one is counted along with it.
+  manager_.OnHeaderBlockSent(4, {2000000});
+  manager_.OnStreamCancellation(2);
+  EXPECT_EQ(2000000u, manager_.smallest_blocking_index());
+
+  EXPECT_TRUE(manager_.OnHeaderAcknowledgement(4));
+  EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
+            manager_.smallest_blocking_index());
+  EXPECT_EQ(0u, QpackBlockingManagerPeer::header_block_counts_size(&manager_));
+}
+
 TEST_F(QpackBlockingManagerTest, HeaderAcknowledgementsOnSingleStream) {
   EXPECT_EQ(0u, manager_.known_received_count());
   EXPECT_EQ(std::numeric_limits<uint64_t>::max(),
@@ -163,8 +163,10 @@ void QpackDecoder::OnErrorDetected(QuicErrorCode error_code,
 std::unique_ptr<QpackProgressiveDecoder> QpackDecoder::CreateProgressiveDecoder(
     QuicStreamId stream_id,
     QpackProgressiveDecoder::HeadersHandlerInterface* handler) {
-  return std::make_unique<QpackProgressiveDecoder>(stream_id, this, this,
-                                                   &header_table_, handler);
+  auto decoder = std::make_unique<QpackProgressiveDecoder>(
+      stream_id, this, this, &header_table_, handler);
+  decoder->set_huffman_literal_cache(huffman_literal_cache_);
+  return decoder;
 }
 
 }  // namespace quic
@@ -97,6 +97,15 @@ class QUIC_EXPORT_PRIVATE QpackDecoder
     decoder_stream_sender_.set_qpack_stream_sender_delegate(delegate);
   }
 
+  // Enables caching of decoded Huffman encoded literals, received both on the
+  // encoder stream and in header blocks, in |cache|.  |cache| may be shared
+  // with other decoders, including HPACK decoders, and must outlive this object
+  // and any QpackProgressiveDecoder it creates.
+  void set_huffman_literal_cache(http2::HpackHuffmanLiteralCache* cache) {
+    huffman_literal_cache_ = cache;
+    encoder_stream_receiver_.set_huffman_literal_cache(cache);
+  }
+
   QpackStreamReceiver* encoder_stream_receiver() {
     return &encoder_stream_receiver_;
   }
@@ -113,6 +122,7 @@ class QUIC_EXPORT_PRIVATE QpackDecoder
   QpackDecoderHeaderTable header_table_;
   std::set<QuicStreamId> blocked_streams_;
   const uint64_t maximum_blocked_streams_;
+  http2::HpackHuffmanLiteralCache* huffman_literal_cache_ = nullptr;
 
   // Known Received Count is the number of insertions the encoder has received
   // acknowledgement for (through Header Acknowledgement and Insert Count
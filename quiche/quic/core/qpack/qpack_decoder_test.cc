@@ -90,6 +90,10 @@ class QpackDecoderTest : public QuicTestWithParam<FragmentMode> {
     // it can handle callbacks later in case of blocked decoding.
   }
 
+  void SetHuffmanLiteralCache(http2::HpackHuffmanLiteralCache* cache) {
+    qpack_decoder_.set_huffman_literal_cache(cache);
+  }
+
   // Decode an entire header block.
   void DecodeHeaderBlock(absl::string_view data) {
     StartDecoding();
@@ -247,6 +251,25 @@ TEST_P(QpackDecoderTest, HuffmanSimple) {
       absl::HexStringToBytes("00002f0125a849e95ba97d7f8925a849e95bb8e8b4bf"));
 }
 
+TEST_P(QpackDecoderTest, HuffmanLiteralCache) {
+  http2::HpackHuffmanLiteralCache cache;
+  SetHuffmanLiteralCache(&cache);
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_CALL(handler_,
+                OnHeaderDecoded(Eq("custom-key"), Eq("custom-value")));
+    EXPECT_CALL(handler_, OnDecodingCompleted());
+
+    DecodeHeaderBlock(
+        absl::HexStringToBytes("00002f0125a849e95ba97d7f8925a849e95bb8e8b4bf"));
+  }
+
+  std::string decoded;
+  EXPECT_TRUE(
+      cache.Lookup(absl::HexStringToBytes("25a849e95bb8e8b4bf"), &decoded));
+  EXPECT_EQ("custom-value", decoded);
+}
+
 TEST_P(QpackDecoderTest, AlternatingHuffmanNonHuffman) {
   EXPECT_CALL(handler_, OnHeaderDecoded(Eq("custom-key"), Eq("custom-value")))
       .Times(4);
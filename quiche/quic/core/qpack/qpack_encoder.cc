@@ -17,24 +17,12 @@
 
 namespace quic {
 
-namespace {
-
-// Fraction to calculate draining index.  The oldest |kDrainingFraction| entries
-// will not be referenced in header blocks.  A new entry (duplicate or literal
-// with name reference) will be added to the dynamic table instead.  This allows
-// the number of references to the draining entry to go to zero faster, so that
-// it can be evicted.  See
-// https://quicwg.org/base-drafts/draft-ietf-quic-qpack.html#avoiding-blocked-insertions.
-// TODO(bnc): Fine tune.
-const float kDrainingFraction = 0.25;
-
-}  // anonymous namespace
-
 QpackEncoder::QpackEncoder(
     DecoderStreamErrorDelegate* decoder_stream_error_delegate)
     : decoder_stream_error_delegate_(decoder_stream_error_delegate),
       decoder_stream_receiver_(this),
       maximum_blocked_streams_(0),
+      clock_(nullptr),
       header_list_count_(0) {
   QUICHE_DCHECK(decoder_stream_error_delegate_);
 }
@@ -93,13 +81,18 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
   const uint64_t known_received_count =
       blocking_manager_.known_received_count();
   // Only entries with index greater than or equal to |draining_index| are
-  // allowed to be referenced.
+  // allowed to be referenced.  The oldest entries will not be referenced in
+  // header blocks.  A new entry (duplicate or literal with name reference)
+  // will be added to the dynamic table instead.  This allows the number of
+  // references to the draining entry to go to zero faster, so that it can be
+  // evicted.  See
+  // https://quicwg.org/base-drafts/draft-ietf-quic-qpack.html#avoiding-blocked-insertions.
   const uint64_t draining_index =
-      header_table_.draining_index(kDrainingFraction);
+      header_table_.draining_index(strategy_.options().draining_fraction);
   // Blocking references are allowed if the number of blocked streams is less
   // than the limit.
   const bool blocking_allowed = blocking_manager_.blocking_allowed_on_stream(
-      stream_id, maximum_blocked_streams_);
+      stream_id, strategy_.BlockedStreamBudget(maximum_blocked_streams_));
 
   // Track events for histograms.
   bool dynamic_table_insertion_blocked = false;
@@ -109,6 +102,8 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
     // These strings are owned by |header_list|.
     absl::string_view name = header.first;
     absl::string_view value = header.second;
+    stats_.uncompressed_bytes += name.size() + value.size();
+    const uint32_t occurrences = strategy_.OnHeaderField(name, value);
 
     bool is_static;
     uint64_t index;
@@ -139,9 +134,12 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
             break;
           }
         } else {
-          // Entry is draining, needs to be duplicated.
+          // Entry is draining, needs to be duplicated.  Cold entries are
+          // left to be evicted.
           if (!blocking_allowed) {
             blocked_stream_limit_exhausted = true;
+          } else if (!strategy_.ShouldDuplicate(occurrences)) {
+            // Encode entry as string literals.
           } else if (QpackEntry::Size(name, value) >
                      header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                          std::min(smallest_blocking_index, index))) {
@@ -153,6 +151,8 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
                   QpackAbsoluteIndexToEncoderStreamRelativeIndex(
                       index, header_table_.inserted_entry_count()));
               uint64_t new_index = header_table_.InsertEntry(name, value);
+              ++stats_.num_insertions;
+              ++stats_.num_duplications;
               representations.push_back(EncodeIndexedHeaderField(
                   is_static, new_index, referred_indices));
               smallest_blocking_index =
@@ -176,6 +176,8 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
       case QpackEncoderHeaderTable::MatchType::kName:
         if (is_static) {
           if (blocking_allowed &&
+              strategy_.ShouldInsert(name, value, occurrences,
+                                     header_table_.dynamic_table_capacity()) &&
               QpackEntry::Size(name, value) <=
                   header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                       smallest_blocking_index)) {
@@ -184,6 +186,7 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
               encoder_stream_sender_.SendInsertWithNameReference(is_static,
                                                                  index, value);
               uint64_t new_index = header_table_.InsertEntry(name, value);
+              ++stats_.num_insertions;
               representations.push_back(EncodeIndexedHeaderField(
                   /* is_static = */ false, new_index, referred_indices));
               smallest_blocking_index =
@@ -202,6 +205,10 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
 
         if (!blocking_allowed) {
           blocked_stream_limit_exhausted = true;
+        } else if (!strategy_.ShouldInsert(
+                       name, value, occurrences,
+                       header_table_.dynamic_table_capacity())) {
+          // Refer to entry name with literal value, if allowed.
         } else if (QpackEntry::Size(name, value) >
                    header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                        std::min(smallest_blocking_index, index))) {
@@ -215,6 +222,7 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
                     index, header_table_.inserted_entry_count()),
                 value);
             uint64_t new_index = header_table_.InsertEntry(name, value);
+            ++stats_.num_insertions;
             representations.push_back(EncodeIndexedHeaderField(
                 is_static, new_index, referred_indices));
             smallest_blocking_index = std::min(smallest_blocking_index, index);
@@ -248,6 +256,10 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
         // If allowed, insert entry and refer to it.
         if (!blocking_allowed) {
           blocked_stream_limit_exhausted = true;
+        } else if (!strategy_.ShouldInsert(
+                       name, value, occurrences,
+                       header_table_.dynamic_table_capacity())) {
+          // Encode entry as string literals.
         } else if (QpackEntry::Size(name, value) >
                    header_table_.MaxInsertSizeWithoutEvictingGivenEntry(
                        smallest_blocking_index)) {
@@ -256,6 +268,7 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
           if (can_write_to_encoder_stream) {
             encoder_stream_sender_.SendInsertWithoutNameReference(name, value);
             uint64_t new_index = header_table_.InsertEntry(name, value);
+            ++stats_.num_insertions;
             representations.push_back(EncodeIndexedHeaderField(
                 /* is_static = */ false, new_index, referred_indices));
             smallest_blocking_index =
@@ -280,6 +293,8 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
   QUICHE_DCHECK_GE(encoder_stream_buffered_byte_count,
                    initial_encoder_stream_buffered_byte_count);
 
+  stats_.encoder_stream_bytes += encoder_stream_buffered_byte_count -
+                                 initial_encoder_stream_buffered_byte_count;
   if (encoder_stream_sent_byte_count) {
     *encoder_stream_sent_byte_count =
         encoder_stream_buffered_byte_count -
@@ -335,7 +350,7 @@ QpackEncoder::Representations QpackEncoder::FirstPassEncode(
 
 std::string QpackEncoder::SecondPassEncode(
     QpackEncoder::Representations representations,
-    uint64_t required_insert_count) const {
+    uint64_t required_insert_count) {
   QpackInstructionEncoder instruction_encoder;
   std::string encoded_headers;
 
@@ -348,6 +363,14 @@ std::string QpackEncoder::SecondPassEncode(
   const uint64_t base = required_insert_count;
 
   for (auto& representation : representations) {
+    if (representation.instruction() == QpackIndexedHeaderFieldInstruction()) {
+      ++stats_.num_indexed;
+    } else if (representation.instruction() ==
+               QpackLiteralHeaderFieldNameReferenceInstruction()) {
+      ++stats_.num_literal_with_name_reference;
+    } else {
+      ++stats_.num_literal;
+    }
     // Dynamic table references must be transformed from absolute to relative
     // indices.
     if ((representation.instruction() == QpackIndexedHeaderFieldInstruction() ||
@@ -360,12 +383,17 @@ std::string QpackEncoder::SecondPassEncode(
     instruction_encoder.Encode(representation, &encoded_headers);
   }
 
+  stats_.num_header_fields += representations.size();
+  stats_.header_block_bytes += encoded_headers.size();
   return encoded_headers;
 }
 
 std::string QpackEncoder::EncodeHeaderList(
     QuicStreamId stream_id, const spdy::Http2HeaderBlock& header_list,
     QuicByteCount* encoder_stream_sent_byte_count) {
+  const QuicTime start = clock_ ? clock_->Now() : QuicTime::Zero();
+  ++stats_.num_header_lists;
+
   // Keep track of all dynamic table indices that this header block refers to so
   // that it can be passed to QpackBlockingManager.
   QpackBlockingManager::IndexSet referred_indices;
@@ -384,7 +412,13 @@ std::string QpackEncoder::EncodeHeaderList(
   }
 
   // Second pass.
-  return SecondPassEncode(std::move(representations), required_insert_count);
+  std::string encoded_headers =
+      SecondPassEncode(std::move(representations), required_insert_count);
+
+  if (clock_) {
+    stats_.encoding_time = stats_.encoding_time + (clock_->Now() - start);
+  }
+  return encoded_headers;
 }
 
 bool QpackEncoder::SetMaximumDynamicTableCapacity(
@@ -13,10 +13,13 @@
 #include "absl/strings/string_view.h"
 #include "quiche/quic/core/qpack/qpack_blocking_manager.h"
 #include "quiche/quic/core/qpack/qpack_decoder_stream_receiver.h"
+#include "quiche/quic/core/qpack/qpack_encoder_strategy.h"
 #include "quiche/quic/core/qpack/qpack_encoder_stream_sender.h"
 #include "quiche/quic/core/qpack/qpack_header_table.h"
 #include "quiche/quic/core/qpack/qpack_instructions.h"
+#include "quiche/quic/core/quic_clock.h"
 #include "quiche/quic/core/quic_error_codes.h"
+#include "quiche/quic/core/quic_time.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/platform/api/quic_export.h"
 #include "quiche/quic/platform/api/quic_exported_stats.h"
@@ -45,6 +48,41 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
                                       absl::string_view error_message) = 0;
   };
 
+  // Counters describing how well this encoder has compressed the header lists
+  // it has encoded so far.
+  struct QUIC_EXPORT_PRIVATE Stats {
+    uint64_t num_header_lists = 0;
+    // Number of header field representations emitted, after value splitting.
+    uint64_t num_header_fields = 0;
+    // Of those, fields encoded as a reference to a static or dynamic table
+    // entry, as a literal value with a name reference, and as a literal name
+    // and value.
+    uint64_t num_indexed = 0;
+    uint64_t num_literal_with_name_reference = 0;
+    uint64_t num_literal = 0;
+    // Number of entries inserted into the dynamic table, including
+    // duplicates, and the number of duplicates among them.
+    uint64_t num_insertions = 0;
+    uint64_t num_duplications = 0;
+    // Sum of the lengths of names and values, before encoding.
+    uint64_t uncompressed_bytes = 0;
+    // Bytes emitted in header blocks, and on the encoder stream.
+    uint64_t header_block_bytes = 0;
+    uint64_t encoder_stream_bytes = 0;
+    // Time spent in EncodeHeaderList().  Only measured if a clock is set.
+    QuicTime::Delta encoding_time = QuicTime::Delta::Zero();
+
+    // Returns the ratio of all bytes emitted to uncompressed bytes, or 1 if
+    // nothing has been encoded yet.
+    double CompressionRatio() const {
+      return uncompressed_bytes == 0
+                 ? 1.0
+                 : static_cast<double>(header_block_bytes +
+                                       encoder_stream_bytes) /
+                       uncompressed_bytes;
+    }
+  };
+
   QpackEncoder(DecoderStreamErrorDelegate* decoder_stream_error_delegate);
   ~QpackEncoder() override;
 
@@ -102,6 +140,20 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
     return header_table_.maximum_dynamic_table_capacity();
   }
 
+  // Replaces the heuristics deciding how the dynamic table is used.  Should be
+  // called before any header list is encoded.
+  void SetStrategyOptions(const QpackEncoderStrategy::Options& options) {
+    strategy_ = QpackEncoderStrategy(options);
+  }
+
+  const QpackEncoderStrategy& strategy() const { return strategy_; }
+
+  // If |clock| is not null, the time spent encoding is measured and reported
+  // in stats().  |clock| must outlive this object.
+  void set_clock(const QuicClock* clock) { clock_ = clock; }
+
+  const Stats& stats() const { return stats_; }
+
  private:
   friend class test::QpackEncoderPeer;
 
@@ -142,9 +194,9 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
 
   // Performs second pass of two-pass encoding: serializes representations
   // generated in first pass, transforming absolute indices of dynamic table
-  // entries to relative indices.
+  // entries to relative indices.  Updates |stats_|.
   std::string SecondPassEncode(Representations representations,
-                               uint64_t required_insert_count) const;
+                               uint64_t required_insert_count);
 
   DecoderStreamErrorDelegate* const decoder_stream_error_delegate_;
   QpackDecoderStreamReceiver decoder_stream_receiver_;
@@ -152,6 +204,9 @@ class QUIC_EXPORT_PRIVATE QpackEncoder
   QpackEncoderHeaderTable header_table_;
   uint64_t maximum_blocked_streams_;
   QpackBlockingManager blocking_manager_;
+  QpackEncoderStrategy strategy_;
+  const QuicClock* clock_;
+  Stats stats_;
   int header_list_count_;
 };
 
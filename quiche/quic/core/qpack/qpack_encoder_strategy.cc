@@ -0,0 +1,76 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/qpack/qpack_encoder_strategy.h"
+
+#include <limits>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "quiche/quic/core/qpack/qpack_header_table.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+QpackEncoderStrategy::QpackEncoderStrategy(const Options& options)
+    : options_(options),
+      tracks_occurrences_(options.min_occurrences_for_insertion > 1 ||
+                          options.min_occurrences_for_unlikely_reuse > 1 ||
+                          options.min_occurrences_for_duplication > 1) {
+  QUICHE_DCHECK_LE(0.0f, options_.draining_fraction);
+  QUICHE_DCHECK_LE(options_.draining_fraction, 1.0f);
+  QUICHE_DCHECK_LE(0.0, options_.blocked_stream_budget);
+  QUICHE_DCHECK_LE(options_.blocked_stream_budget, 1.0);
+}
+
+uint32_t QpackEncoderStrategy::OnHeaderField(absl::string_view name,
+                                             absl::string_view value) {
+  if (!tracks_occurrences_) {
+    return std::numeric_limits<uint32_t>::max();
+  }
+  if (++observations_since_decay_ >= options_.decay_interval) {
+    sketch_.Decay();
+    observations_since_decay_ = 0;
+  }
+  return sketch_.Increment(
+      absl::Hash<std::pair<absl::string_view, absl::string_view>>()(
+          std::make_pair(name, value)));
+}
+
+bool QpackEncoderStrategy::ShouldInsert(absl::string_view name,
+                                        absl::string_view value,
+                                        uint32_t occurrences,
+                                        uint64_t dynamic_table_capacity) const {
+  if (QpackEntry::Size(name, value) >
+      options_.max_entry_fraction_of_table * dynamic_table_capacity) {
+    return false;
+  }
+  if (occurrences < options_.min_occurrences_for_insertion) {
+    return false;
+  }
+  if (options_.min_occurrences_for_unlikely_reuse >
+          options_.min_occurrences_for_insertion &&
+      IsUnlikelyToBeReused(name, value)) {
+    return occurrences >= options_.min_occurrences_for_unlikely_reuse;
+  }
+  return true;
+}
+
+uint64_t QpackEncoderStrategy::BlockedStreamBudget(
+    uint64_t maximum_blocked_streams) const {
+  if (options_.blocked_stream_budget >= 1.0) {
+    return maximum_blocked_streams;
+  }
+  return static_cast<uint64_t>(maximum_blocked_streams *
+                               options_.blocked_stream_budget);
+}
+
+bool QpackEncoderStrategy::IsUnlikelyToBeReused(absl::string_view name,
+                                                absl::string_view value) const {
+  return value.size() >= options_.large_value_size ||
+         spdy::HpackAdaptiveIndexingPolicy::IsUniquePerMessageHeader(name) ||
+         spdy::HpackAdaptiveIndexingPolicy::LooksHighEntropy(value);
+}
+
+}  // namespace quic
@@ -0,0 +1,104 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_STRATEGY_H_
+#define QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_STRATEGY_H_
+
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/spdy/core/hpack/hpack_indexing_policy.h"
+
+namespace quic {
+
+// Heuristics deciding how QpackEncoder uses the dynamic table.  An instance
+// belongs to a single encoder, and thus to a single connection.
+//
+// The default options reproduce the behavior of an encoder without a strategy:
+// every field is inserted if the dynamic table and the blocked stream limit
+// allow, and every draining entry that is referenced is duplicated.  Other
+// options make the encoder more selective:
+//
+// - Fields are inserted only once they have been seen a number of times on the
+//   connection, as estimated by a frequency sketch.  Fields unlikely to be
+//   reused, such as large values, random tokens, or headers unique to every
+//   message, may be held to a higher threshold.
+// - Fields large relative to the dynamic table are not inserted, since they
+//   would evict many smaller entries.
+// - Draining entries, which are about to be evicted, are duplicated only if
+//   they are hot.  Cold ones are sent as literals and left to be evicted.
+// - Only a fraction of the peer's blocked stream limit is used, trading
+//   compression for less head-of-line blocking when encoder stream data is
+//   lost.
+class QUIC_EXPORT_PRIVATE QpackEncoderStrategy {
+ public:
+  struct QUIC_EXPORT_PRIVATE Options {
+    // A field not in the dynamic table is inserted once it has been seen this
+    // many times on the connection, including the current occurrence.
+    uint32_t min_occurrences_for_insertion = 1;
+    // Same, for large values, values that look like random tokens, and
+    // headers whose value changes with every message.
+    uint32_t min_occurrences_for_unlikely_reuse = 1;
+    // Values at least this long are considered large.
+    size_t large_value_size = 64;
+    // Fields whose entry size exceeds this fraction of the dynamic table
+    // capacity are never inserted.
+    double max_entry_fraction_of_table = 1.0;
+    // A referenced draining entry is duplicated if its field has been seen
+    // this many times, including the current occurrence.
+    uint32_t min_occurrences_for_duplication = 1;
+    // Fraction of the dynamic table capacity, starting from the oldest entry,
+    // that is considered draining.  Draining entries are not referenced, so
+    // that they can be evicted.
+    float draining_fraction = 0.25;
+    // Fraction of SETTINGS_QPACK_BLOCKED_STREAMS that may be blocked.
+    double blocked_stream_budget = 1.0;
+    // The frequency sketch is decayed after this many observations.
+    size_t decay_interval = 4096;
+  };
+
+  QpackEncoderStrategy() : QpackEncoderStrategy(Options()) {}
+  explicit QpackEncoderStrategy(const Options& options);
+
+  // Records an occurrence of a header field, and returns the estimated number
+  // of occurrences so far, including this one.  Returns a large number if the
+  // options do not depend on occurrence counts.
+  uint32_t OnHeaderField(absl::string_view name, absl::string_view value);
+
+  // Returns true if a field seen |occurrences| times should be inserted into a
+  // dynamic table of |dynamic_table_capacity| bytes.
+  bool ShouldInsert(absl::string_view name, absl::string_view value,
+                    uint32_t occurrences,
+                    uint64_t dynamic_table_capacity) const;
+
+  // Returns true if a draining entry for a field seen |occurrences| times
+  // should be duplicated.
+  bool ShouldDuplicate(uint32_t occurrences) const {
+    return occurrences >= options_.min_occurrences_for_duplication;
+  }
+
+  // Returns the number of streams that may be blocked, given the limit
+  // |maximum_blocked_streams| advertised by the peer.
+  uint64_t BlockedStreamBudget(uint64_t maximum_blocked_streams) const;
+
+  const Options& options() const { return options_; }
+
+ private:
+  // Returns true if the field is unlikely to be seen again with the same
+  // value.
+  bool IsUnlikelyToBeReused(absl::string_view name,
+                            absl::string_view value) const;
+
+  Options options_;
+  // True if any option depends on occurrence counts.
+  bool tracks_occurrences_;
+  spdy::HpackFrequencySketch sketch_;
+  size_t observations_since_decay_ = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QPACK_QPACK_ENCODER_STRATEGY_H_
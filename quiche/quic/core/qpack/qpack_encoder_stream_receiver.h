@@ -55,6 +55,12 @@ class QUIC_EXPORT_PRIVATE QpackEncoderStreamReceiver
   // and all further data is ignored.
   void Decode(absl::string_view data) override;
 
+  // Enables caching of decoded Huffman encoded literals in |cache|, which must
+  // outlive this object.
+  void set_huffman_literal_cache(http2::HpackHuffmanLiteralCache* cache) {
+    instruction_decoder_.set_huffman_literal_cache(cache);
+  }
+
   // QpackInstructionDecoder::Delegate implementation.
   bool OnInstructionDecoded(const QpackInstruction* instruction) override;
   void OnInstructionDecodingError(QpackInstructionDecoder::ErrorCode error_code,
@@ -30,6 +30,23 @@ namespace {
 // stream.
 constexpr uint64_t kTooManyBytesBuffered = 1024 * 1024;
 
+// A clock that advances by one microsecond every time it is read.
+class AdvancingClock : public QuicClock {
+ public:
+  QuicTime ApproximateNow() const override { return now_; }
+  QuicTime Now() const override {
+    now_ = now_ + QuicTime::Delta::FromMicroseconds(1);
+    return now_;
+  }
+  QuicWallTime WallNow() const override {
+    return QuicWallTime::FromUNIXMicroseconds(
+        (now_ - QuicTime::Zero()).ToMicroseconds());
+  }
+
+ private:
+  mutable QuicTime now_ = QuicTime::Zero();
+};
+
 class QpackEncoderTest : public QuicTest {
  protected:
   QpackEncoderTest()
@@ -486,6 +503,163 @@ TEST_F(QpackEncoderTest, Draining) {
             Encode(header_list3));
 }
 
+TEST_F(QpackEncoderTest, ColdDrainingEntryIsNotDuplicated) {
+  EXPECT_CALL(encoder_stream_sender_delegate_, NumBytesBuffered())
+      .WillRepeatedly(Return(0));
+  QpackEncoderStrategy::Options options;
+  options.min_occurrences_for_duplication = 3;
+  encoder_.SetStrategyOptions(options);
+
+  spdy::Http2HeaderBlock header_list1;
+  header_list1["one"] = "foo";
+  header_list1["two"] = "foo";
+  header_list1["three"] = "foo";
+  header_list1["four"] = "foo";
+
+  // Make just enough room in the dynamic table for the header list plus the
+  // first entry duplicated, so that the oldest entry is draining.
+  uint64_t maximum_dynamic_table_capacity = 0;
+  for (const auto& header_field : header_list1) {
+    maximum_dynamic_table_capacity +=
+        QpackEntry::Size(header_field.first, header_field.second);
+  }
+  maximum_dynamic_table_capacity += QpackEntry::Size("one", "foo");
+  encoder_.SetMaximumDynamicTableCapacity(maximum_dynamic_table_capacity);
+  encoder_.SetDynamicTableCapacity(maximum_dynamic_table_capacity);
+
+  // Set Dynamic Table Capacity instruction and insert four entries into the
+  // dynamic table.
+  EXPECT_CALL(encoder_stream_sender_delegate_, WriteStreamData(_));
+  EXPECT_EQ(absl::HexStringToBytes("0500"        // prefix
+                                   "83828180"),  // dynamic entries
+            Encode(header_list1));
+  EXPECT_EQ(4u, encoder_.stats().num_insertions);
+
+  // The oldest entry is draining, and has been seen only twice.  It is not
+  // duplicated, and no instructions are sent on the encoder stream.
+  spdy::Http2HeaderBlock header_list2;
+  header_list2["one"] = "foo";
+  std::string output = Encode(header_list2);
+  EXPECT_EQ(absl::HexStringToBytes("0000"), output.substr(0, 2));
+  EXPECT_EQ(0u, encoder_.stats().num_duplications);
+  EXPECT_EQ(1u, encoder_.stats().num_literal);
+
+  // Seen a third time, the entry is hot enough to be duplicated.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::HexStringToBytes("03"))));
+  EXPECT_EQ(absl::HexStringToBytes("0600"  // prefix
+                                   "80"),  // most recent dynamic table entry
+            Encode(header_list2));
+  EXPECT_EQ(1u, encoder_.stats().num_duplications);
+}
+
+TEST_F(QpackEncoderTest, InsertionDeferredUntilFieldIsRepeated) {
+  EXPECT_CALL(encoder_stream_sender_delegate_, NumBytesBuffered())
+      .WillRepeatedly(Return(0));
+  QpackEncoderStrategy::Options options;
+  options.min_occurrences_for_insertion = 2;
+  encoder_.SetStrategyOptions(options);
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+
+  // The first occurrence is encoded as string literals.  Only the Set Dynamic
+  // Table Capacity instruction is sent.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::HexStringToBytes("3fe11f"))));
+  EXPECT_EQ(absl::HexStringToBytes("00002a94e703626172"), Encode(header_list));
+  EXPECT_EQ(0u, encoder_stream_sent_byte_count_);
+
+  // The second occurrence is inserted and referenced.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::HexStringToBytes("6294e703626172"))));
+  EXPECT_EQ(absl::HexStringToBytes("020080"), Encode(header_list));
+}
+
+TEST_F(QpackEncoderTest, BlockedStreamBudget) {
+  EXPECT_CALL(encoder_stream_sender_delegate_, NumBytesBuffered())
+      .WillRepeatedly(Return(0));
+  QpackEncoderStrategy::Options options;
+  options.blocked_stream_budget = 0.5;
+  encoder_.SetStrategyOptions(options);
+  encoder_.SetMaximumBlockedStreams(1);
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+
+  // Half of the one blocked stream allowed by the peer rounds down to none,
+  // so no entry is inserted.
+  EXPECT_CALL(encoder_stream_sender_delegate_,
+              WriteStreamData(Eq(absl::HexStringToBytes("3fe11f"))));
+  EXPECT_EQ(absl::HexStringToBytes("00002a94e703626172"), Encode(header_list));
+}
+
+TEST_F(QpackEncoderTest, Stats) {
+  EXPECT_CALL(encoder_stream_sender_delegate_, NumBytesBuffered())
+      .WillRepeatedly(Return(0));
+  encoder_.SetMaximumBlockedStreams(1);
+  encoder_.SetMaximumDynamicTableCapacity(4096);
+  encoder_.SetDynamicTableCapacity(4096);
+
+  EXPECT_EQ(1.0, encoder_.stats().CompressionRatio());
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+  header_list.AppendValueOrAddHeader("foo",
+                                     "baz");  // name matches dynamic entry
+  header_list[":method"] = "GET";             // matches static entry
+
+  EXPECT_CALL(encoder_stream_sender_delegate_, WriteStreamData(_));
+  std::string output = Encode(header_list);
+
+  const QpackEncoder::Stats& stats = encoder_.stats();
+  EXPECT_EQ(1u, stats.num_header_lists);
+  EXPECT_EQ(3u, stats.num_header_fields);
+  EXPECT_EQ(3u, stats.num_indexed);
+  EXPECT_EQ(0u, stats.num_literal_with_name_reference);
+  EXPECT_EQ(0u, stats.num_literal);
+  EXPECT_EQ(2u, stats.num_insertions);
+  EXPECT_EQ(0u, stats.num_duplications);
+  EXPECT_EQ(22u, stats.uncompressed_bytes);
+  EXPECT_EQ(output.size(), stats.header_block_bytes);
+  EXPECT_EQ(encoder_stream_sent_byte_count_, stats.encoder_stream_bytes);
+  EXPECT_EQ(static_cast<double>(output.size() +
+                                encoder_stream_sent_byte_count_) /
+                22,
+            stats.CompressionRatio());
+  EXPECT_EQ(QuicTime::Delta::Zero(), stats.encoding_time);
+
+  // The same header list compresses better once entries are in the table.
+  // No instructions are sent on the encoder stream.
+  output = Encode(header_list);
+  EXPECT_EQ(2u, stats.num_header_lists);
+  EXPECT_EQ(6u, stats.num_indexed);
+  EXPECT_EQ(2u, stats.num_insertions);
+  EXPECT_EQ(44u, stats.uncompressed_bytes);
+  EXPECT_LT(stats.CompressionRatio(), 1.0);
+}
+
+TEST_F(QpackEncoderTest, EncodingTime) {
+  EXPECT_CALL(encoder_stream_sender_delegate_, NumBytesBuffered())
+      .WillRepeatedly(Return(0));
+  AdvancingClock clock;
+  encoder_.set_clock(&clock);
+
+  spdy::Http2HeaderBlock header_list;
+  header_list["foo"] = "bar";
+  Encode(header_list);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(1),
+            encoder_.stats().encoding_time);
+
+  Encode(header_list);
+  EXPECT_EQ(QuicTime::Delta::FromMicroseconds(2),
+            encoder_.stats().encoding_time);
+}
+
 TEST_F(QpackEncoderTest, DynamicTableCapacityLessThanMaximum) {
   encoder_.SetMaximumDynamicTableCapacity(1024);
   encoder_.SetDynamicTableCapacity(30);
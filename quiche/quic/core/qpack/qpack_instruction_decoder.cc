@@ -30,6 +30,7 @@ QpackInstructionDecoder::QpackInstructionDecoder(const QpackLanguage* language,
       varint2_(0),
       is_huffman_encoded_(false),
       string_length_(0),
+      huffman_literal_cache_(nullptr),
       error_detected_(false),
       state_(State::kStartInstruction) {}
 
@@ -291,11 +292,18 @@ bool QpackInstructionDecoder::DoReadStringDone() {
   QUICHE_DCHECK_EQ(string->size(), string_length_);
 
   if (is_huffman_encoded_) {
-    huffman_decoder_.Reset();
     // HpackHuffmanDecoder::Decode() cannot perform in-place decoding.
     std::string decoded_value;
-    huffman_decoder_.Decode(*string, &decoded_value);
-    if (!huffman_decoder_.InputProperlyTerminated()) {
+    bool success;
+    if (huffman_literal_cache_ != nullptr) {
+      success = huffman_literal_cache_->Decode(*string, &huffman_decoder_,
+                                               &decoded_value);
+    } else {
+      huffman_decoder_.Reset();
+      huffman_decoder_.Decode(*string, &decoded_value);
+      success = huffman_decoder_.InputProperlyTerminated();
+    }
+    if (!success) {
       OnError(ErrorCode::HUFFMAN_ENCODING_ERROR,
               "Error in Huffman-encoded string.");
       return false;
@@ -11,6 +11,7 @@
 
 #include "absl/strings/string_view.h"
 #include "quiche/http2/hpack/huffman/hpack_huffman_decoder.h"
+#include "quiche/http2/hpack/huffman/hpack_huffman_literal_cache.h"
 #include "quiche/http2/hpack/varint/hpack_varint_decoder.h"
 #include "quiche/quic/core/qpack/qpack_instructions.h"
 #include "quiche/quic/platform/api/quic_export.h"
@@ -68,6 +69,13 @@ class QUIC_EXPORT_PRIVATE QpackInstructionDecoder {
   // has been entirely parsed.
   bool AtInstructionBoundary() const;
 
+  // Huffman encoded names and values are looked up in and added to |cache|,
+  // which must outlive this object.  Disabled if |cache| is nullptr, which is
+  // the default.
+  void set_huffman_literal_cache(http2::HpackHuffmanLiteralCache* cache) {
+    huffman_literal_cache_ = cache;
+  }
+
   // Accessors for decoded values.  Should only be called for fields that are
   // part of the most recently decoded instruction, and only after |this| calls
   // Delegate::OnInstructionDecoded() but before Decode() is called again.
@@ -141,6 +149,9 @@ class QUIC_EXPORT_PRIVATE QpackInstructionDecoder {
   // Decoder instance for decoding Huffman encoded strings.
   http2::HpackHuffmanDecoder huffman_decoder_;
 
+  // Cache of decoded Huffman encoded strings, or nullptr.
+  http2::HpackHuffmanLiteralCache* huffman_literal_cache_;
+
   // True if a decoding error has been detected by QpackInstructionDecoder.
   // Only used in QUICHE_DCHECKs.
   bool error_detected_;
@@ -160,6 +160,29 @@ TEST_P(QpackInstructionDecoderTest, NameAndValue) {
   EXPECT_EQ("bar", decoder_->value());
 }
 
+TEST_P(QpackInstructionDecoderTest, HuffmanLiteralCache) {
+  http2::HpackHuffmanLiteralCache cache;
+  decoder_->set_huffman_literal_cache(&cache);
+
+  for (int i = 0; i < 2; ++i) {
+    EXPECT_CALL(delegate_, OnInstructionDecoded(TestInstruction2()));
+    DecodeInstruction(absl::HexStringToBytes("c294e7838c767f"));
+
+    EXPECT_EQ("foo", decoder_->name());
+    EXPECT_EQ("bar", decoder_->value());
+  }
+
+  std::string decoded;
+  EXPECT_TRUE(cache.Lookup(absl::HexStringToBytes("94e7"), &decoded));
+  EXPECT_EQ("foo", decoded);
+
+  EXPECT_CALL(delegate_,
+              OnInstructionDecodingError(
+                  QpackInstructionDecoder::ErrorCode::HUFFMAN_ENCODING_ERROR,
+                  Eq("Error in Huffman-encoded string.")));
+  DecodeInstruction(absl::HexStringToBytes("c1ff"));
+}
+
 TEST_P(QpackInstructionDecoderTest, InvalidHuffmanEncoding) {
   EXPECT_CALL(delegate_,
               OnInstructionDecodingError(
@@ -97,6 +97,12 @@ class QUIC_EXPORT_PRIVATE QpackProgressiveDecoder
   // through Decode().  No methods must be called afterwards.
   void EndHeaderBlock();
 
+  // Enables caching of decoded Huffman encoded literals in |cache|, which must
+  // outlive this object.
+  void set_huffman_literal_cache(http2::HpackHuffmanLiteralCache* cache) {
+    instruction_decoder_.set_huffman_literal_cache(cache);
+  }
+
   // QpackInstructionDecoder::Delegate implementation.
   bool OnInstructionDecoded(const QpackInstruction* instruction) override;
   void OnInstructionDecodingError(QpackInstructionDecoder::ErrorCode error_code,
@@ -0,0 +1,387 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_binary_trace_visitor.h"
+
+#include <algorithm>
+#include <limits>
+#include <string>
+
+#include "absl/strings/escaping.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_format.h"
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/congestion_control/rtt_stats.h"
+#include "quiche/quic/core/quic_sent_packet_manager.h"
+#include "quiche/quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+
+namespace {
+
+uint32_t CapToUint32(uint64_t value) {
+  return static_cast<uint32_t>(
+      std::min<uint64_t>(value, std::numeric_limits<uint32_t>::max()));
+}
+
+size_t RoundUpToPowerOf2(size_t value) {
+  size_t result = 1;
+  while (result < value) {
+    result <<= 1;
+  }
+  return result;
+}
+
+// Returns the qlog packet type of packets sent at |level|.
+absl::string_view QlogPacketType(uint8_t level) {
+  switch (static_cast<EncryptionLevel>(level)) {
+    case ENCRYPTION_INITIAL:
+      return "initial";
+    case ENCRYPTION_HANDSHAKE:
+      return "handshake";
+    case ENCRYPTION_ZERO_RTT:
+      return "0RTT";
+    case ENCRYPTION_FORWARD_SECURE:
+      return "1RTT";
+    case NUM_ENCRYPTION_LEVELS:
+      break;
+  }
+  return "unknown";
+}
+
+quic_trace::EncryptionLevel QuicTraceEncryptionLevel(uint8_t level) {
+  switch (static_cast<EncryptionLevel>(level)) {
+    case ENCRYPTION_INITIAL:
+      return quic_trace::ENCRYPTION_INITIAL;
+    case ENCRYPTION_HANDSHAKE:
+      return quic_trace::ENCRYPTION_HANDSHAKE;
+    case ENCRYPTION_ZERO_RTT:
+      return quic_trace::ENCRYPTION_0RTT;
+    case ENCRYPTION_FORWARD_SECURE:
+      return quic_trace::ENCRYPTION_1RTT;
+    case NUM_ENCRYPTION_LEVELS:
+      break;
+  }
+  return quic_trace::ENCRYPTION_UNKNOWN;
+}
+
+std::string QlogMilliseconds(uint64_t microseconds) {
+  return absl::StrFormat("%.3f", microseconds / 1000.0);
+}
+
+std::string QlogStreamFrame(const QuicBinaryTraceVisitor::Record& record) {
+  return absl::StrCat(
+      "{\"frame_type\":\"stream\",\"stream_id\":", record.number,
+      ",\"offset\":", record.value1, ",\"length\":", record.value2,
+      ",\"fin\":", record.flag ? "true" : "false", "}");
+}
+
+}  // namespace
+
+QuicBinaryTraceVisitor::QuicBinaryTraceVisitor(
+    const QuicConnection* connection, size_t capacity, Delegate* delegate)
+    : connection_(connection),
+      delegate_(delegate),
+      start_time_(connection_->clock()->ApproximateNow()),
+      records_(RoundUpToPowerOf2(capacity)),
+      num_records_(0) {}
+
+QuicBinaryTraceVisitor::Record& QuicBinaryTraceVisitor::AddRecord(
+    EventType type, QuicTime time) {
+  Record& record = records_[num_records_ & (records_.size() - 1)];
+  ++num_records_;
+  record = Record();
+  record.time_us =
+      time > start_time_ ? (time - start_time_).ToMicroseconds() : 0;
+  record.type = type;
+  return record;
+}
+
+void QuicBinaryTraceVisitor::OnPacketSent(
+    QuicPacketNumber packet_number, QuicPacketLength packet_length,
+    bool has_crypto_handshake, TransmissionType transmission_type,
+    EncryptionLevel encryption_level, const QuicFrames& retransmittable_frames,
+    const QuicFrames& nonretransmittable_frames, QuicTime sent_time) {
+  Record& record = AddRecord(EventType::kPacketSent, sent_time);
+  record.number = packet_number.ToUint64();
+  record.value1 = packet_length;
+  record.value2 = CapToUint32(retransmittable_frames.size() +
+                              nonretransmittable_frames.size());
+  record.level = encryption_level;
+  record.subtype = transmission_type;
+  record.flag = has_crypto_handshake;
+
+  for (const QuicFrame& frame : retransmittable_frames) {
+    if (frame.type != STREAM_FRAME) {
+      continue;
+    }
+    Record& stream_record = AddRecord(EventType::kStreamFrameSent, sent_time);
+    stream_record.number = frame.stream_frame.stream_id;
+    stream_record.value1 = CapToUint32(frame.stream_frame.offset);
+    stream_record.value2 = frame.stream_frame.data_length;
+    stream_record.flag = frame.stream_frame.fin;
+  }
+}
+
+void QuicBinaryTraceVisitor::OnIncomingAck(
+    QuicPacketNumber /*ack_packet_number*/, EncryptionLevel ack_decrypted_level,
+    const QuicAckFrame& ack_frame, QuicTime ack_receive_time,
+    QuicPacketNumber /*largest_observed*/, bool rtt_updated,
+    QuicPacketNumber /*least_unacked_sent_packet*/) {
+  Record& record = AddRecord(EventType::kAckReceived, ack_receive_time);
+  if (ack_frame.largest_acked.IsInitialized()) {
+    record.number = ack_frame.largest_acked.ToUint64();
+  }
+  record.value1 = CapToUint32(ack_frame.ack_delay_time.ToMicroseconds());
+  record.value2 = CapToUint32(ack_frame.packets.NumIntervals());
+  record.level = ack_decrypted_level;
+  record.flag = rtt_updated;
+  RecordCongestionState(ack_receive_time);
+}
+
+void QuicBinaryTraceVisitor::RecordCongestionState(QuicTime time) {
+  const QuicSentPacketManager& manager = connection_->sent_packet_manager();
+  Record& record = AddRecord(EventType::kCongestionState, time);
+  record.value1 = CapToUint32(manager.GetCongestionWindowInBytes());
+  record.value2 = CapToUint32(manager.GetBytesInFlight());
+  record.value3 =
+      CapToUint32(manager.GetRttStats()->smoothed_rtt().ToMicroseconds());
+}
+
+void QuicBinaryTraceVisitor::OnPacketLoss(QuicPacketNumber lost_packet_number,
+                                          EncryptionLevel encryption_level,
+                                          TransmissionType transmission_type,
+                                          QuicTime detection_time) {
+  Record& record = AddRecord(EventType::kPacketLost, detection_time);
+  record.number = lost_packet_number.ToUint64();
+  record.level = encryption_level;
+  record.subtype = transmission_type;
+}
+
+void QuicBinaryTraceVisitor::OnApplicationLimited() {
+  AddRecord(EventType::kApplicationLimited,
+            connection_->clock()->ApproximateNow());
+}
+
+void QuicBinaryTraceVisitor::OnStreamFrame(const QuicStreamFrame& frame) {
+  Record& record = AddRecord(EventType::kStreamFrameReceived,
+                             connection_->clock()->ApproximateNow());
+  record.number = frame.stream_id;
+  record.value1 = CapToUint32(frame.offset);
+  record.value2 = frame.data_length;
+  record.flag = frame.fin;
+}
+
+void QuicBinaryTraceVisitor::OnRstStreamFrame(const QuicRstStreamFrame& frame) {
+  Record& record = AddRecord(EventType::kRstStreamReceived,
+                             connection_->clock()->ApproximateNow());
+  record.number = frame.stream_id;
+  record.value1 = CapToUint32(frame.byte_offset);
+  record.value2 = CapToUint32(frame.ietf_error_code);
+}
+
+void QuicBinaryTraceVisitor::OnConnectionClosed(
+    const QuicConnectionCloseFrame& frame, ConnectionCloseSource source) {
+  Record& record = AddRecord(EventType::kConnectionClosed,
+                             connection_->clock()->ApproximateNow());
+  record.number = frame.quic_error_code;
+  record.subtype = static_cast<uint8_t>(source);
+  if (delegate_ != nullptr && frame.quic_error_code != QUIC_NO_ERROR) {
+    delegate_->OnConnectionClosedWithError(*this, frame.quic_error_code);
+  }
+}
+
+std::vector<QuicBinaryTraceVisitor::Record> QuicBinaryTraceVisitor::GetRecords()
+    const {
+  std::vector<Record> records;
+  records.reserve(std::min<uint64_t>(num_records_, records_.size()));
+  for (uint64_t i = num_dropped_records(); i < num_records_; ++i) {
+    records.push_back(records_[i & (records_.size() - 1)]);
+  }
+  return records;
+}
+
+std::string QuicBinaryTraceVisitor::ToQlogJson() const {
+  const std::string odcid =
+      absl::BytesToHexString(absl::string_view(
+          connection_->connection_id().data(),
+          connection_->connection_id().length()));
+  std::string json = absl::StrCat(
+      "{\"qlog_version\":\"0.3\",\"qlog_format\":\"JSON\",\"traces\":[{",
+      "\"vantage_point\":{\"type\":\"",
+      connection_->perspective() == Perspective::IS_SERVER ? "server"
+                                                           : "client",
+      "\"},\"common_fields\":{\"ODCID\":\"", odcid,
+      "\",\"time_format\":\"relative\",\"reference_time\":0},",
+      "\"dropped_events\":", num_dropped_records(), ",\"events\":[");
+
+  const std::vector<Record> records = GetRecords();
+  bool first_event = true;
+  for (size_t i = 0; i < records.size(); ++i) {
+    const Record& record = records[i];
+    std::string name;
+    std::string data;
+    switch (record.type) {
+      case EventType::kPacketSent: {
+        name = "transport:packet_sent";
+        std::string frames;
+        // Stream frames are recorded right after their packet.
+        while (i + 1 < records.size() &&
+               records[i + 1].type == EventType::kStreamFrameSent) {
+          absl::StrAppend(&frames, frames.empty() ? "" : ",",
+                          QlogStreamFrame(records[++i]));
+        }
+        data = absl::StrCat(
+            "{\"header\":{\"packet_type\":\"", QlogPacketType(record.level),
+            "\",\"packet_number\":", record.number,
+            "},\"raw\":{\"length\":", record.value1, "},\"transmission\":\"",
+            TransmissionTypeToString(
+                static_cast<TransmissionType>(record.subtype)),
+            "\",\"frames\":[", frames, "]}");
+        break;
+      }
+      case EventType::kAckReceived:
+        name = "transport:packet_received";
+        data = absl::StrCat(
+            "{\"header\":{\"packet_type\":\"", QlogPacketType(record.level),
+            "\"},\"frames\":[{\"frame_type\":\"ack\",\"ack_delay\":",
+            QlogMilliseconds(record.value1),
+            ",\"largest_acknowledged\":", record.number,
+            ",\"num_ranges\":", record.value2, "}]}");
+        break;
+      case EventType::kPacketLost:
+        name = "recovery:packet_lost";
+        data = absl::StrCat("{\"header\":{\"packet_type\":\"",
+                            QlogPacketType(record.level),
+                            "\",\"packet_number\":", record.number, "}}");
+        break;
+      case EventType::kCongestionState:
+        name = "recovery:metrics_updated";
+        data = absl::StrCat("{\"congestion_window\":", record.value1,
+                            ",\"bytes_in_flight\":", record.value2,
+                            ",\"smoothed_rtt\":",
+                            QlogMilliseconds(record.value3), "}");
+        break;
+      case EventType::kApplicationLimited:
+        name = "recovery:congestion_state_updated";
+        data = "{\"new\":\"application_limited\"}";
+        break;
+      case EventType::kStreamFrameSent:
+        // Only dropped records can separate a stream frame from its packet.
+        continue;
+      case EventType::kStreamFrameReceived:
+        name = "transport:packet_received";
+        data = absl::StrCat("{\"frames\":[", QlogStreamFrame(record), "]}");
+        break;
+      case EventType::kRstStreamReceived:
+        name = "transport:packet_received";
+        data = absl::StrCat(
+            "{\"frames\":[{\"frame_type\":\"reset_stream\",\"stream_id\":",
+            record.number, ",\"final_size\":", record.value1,
+            ",\"error_code\":", record.value2, "}]}");
+        break;
+      case EventType::kConnectionClosed:
+        name = "transport:connection_closed";
+        data = absl::StrCat(
+            "{\"owner\":\"",
+            static_cast<ConnectionCloseSource>(record.subtype) ==
+                    ConnectionCloseSource::FROM_SELF
+                ? "local"
+                : "remote",
+            "\",\"connection_code\":", record.number, ",\"reason\":\"",
+            QuicErrorCodeToString(static_cast<QuicErrorCode>(record.number)),
+            "\"}");
+        break;
+    }
+    absl::StrAppend(&json, first_event ? "" : ",", "{\"time\":",
+                    QlogMilliseconds(record.time_us), ",\"name\":\"", name,
+                    "\",\"data\":", data, "}");
+    first_event = false;
+  }
+  absl::StrAppend(&json, "]}]}");
+  return json;
+}
+
+void QuicBinaryTraceVisitor::ToQuicTrace(quic_trace::Trace* trace) const {
+  quic_trace::Event* last_ack_event = nullptr;
+  quic_trace::Event* last_sent_event = nullptr;
+  for (const Record& record : GetRecords()) {
+    switch (record.type) {
+      case EventType::kPacketSent: {
+        quic_trace::Event* event = trace->add_events();
+        event->set_event_type(quic_trace::PACKET_SENT);
+        event->set_time_us(record.time_us);
+        event->set_packet_number(record.number);
+        event->set_packet_size(record.value1);
+        event->set_encryption_level(QuicTraceEncryptionLevel(record.level));
+        last_sent_event = event;
+        break;
+      }
+      case EventType::kStreamFrameSent:
+      case EventType::kStreamFrameReceived: {
+        quic_trace::Event* event;
+        if (record.type == EventType::kStreamFrameSent) {
+          if (last_sent_event == nullptr) {
+            continue;
+          }
+          event = last_sent_event;
+        } else {
+          event = trace->add_events();
+          event->set_event_type(quic_trace::PACKET_RECEIVED);
+          event->set_time_us(record.time_us);
+        }
+        quic_trace::Frame* frame = event->add_frames();
+        frame->set_frame_type(quic_trace::STREAM);
+        quic_trace::StreamFrameInfo* info = frame->mutable_stream_frame_info();
+        info->set_stream_id(record.number);
+        info->set_fin(record.flag);
+        info->set_offset(record.value1);
+        info->set_length(record.value2);
+        break;
+      }
+      case EventType::kAckReceived: {
+        quic_trace::Event* event = trace->add_events();
+        event->set_event_type(quic_trace::PACKET_RECEIVED);
+        event->set_time_us(record.time_us);
+        event->set_encryption_level(QuicTraceEncryptionLevel(record.level));
+        quic_trace::Frame* frame = event->add_frames();
+        frame->set_frame_type(quic_trace::ACK);
+        frame->mutable_ack_info()->set_ack_delay_us(record.value1);
+        last_ack_event = event;
+        break;
+      }
+      case EventType::kCongestionState: {
+        if (last_ack_event == nullptr) {
+          continue;
+        }
+        quic_trace::TransportState* state =
+            last_ack_event->mutable_transport_state();
+        state->set_cwnd_bytes(record.value1);
+        state->set_in_flight_bytes(record.value2);
+        state->set_smoothed_rtt_us(record.value3);
+        break;
+      }
+      case EventType::kPacketLost: {
+        quic_trace::Event* event = trace->add_events();
+        event->set_event_type(quic_trace::PACKET_LOST);
+        event->set_time_us(record.time_us);
+        event->set_packet_number(record.number);
+        event->set_encryption_level(QuicTraceEncryptionLevel(record.level));
+        break;
+      }
+      case EventType::kApplicationLimited: {
+        quic_trace::Event* event = trace->add_events();
+        event->set_event_type(quic_trace::APPLICATION_LIMITED);
+        event->set_time_us(record.time_us);
+        break;
+      }
+      case EventType::kRstStreamReceived:
+      case EventType::kConnectionClosed:
+        // Not represented in quic_trace events.
+        break;
+    }
+  }
+}
+
+}  // namespace quic
@@ -0,0 +1,143 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_BINARY_TRACE_VISITOR_H_
+#define QUICHE_QUIC_CORE_QUIC_BINARY_TRACE_VISITOR_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "quiche/quic/core/quic_connection.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/core/quic_types.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quic_trace/quic_trace.pb.h"
+
+namespace quic {
+
+// Records the recent events of a QuicConnection into a fixed-size ring buffer
+// of 32-byte binary records, overwriting the oldest ones.  Recording an event
+// copies a few integers and never allocates, so unlike QuicTraceVisitor this
+// visitor can be left enabled on a sample of production connections.  The
+// records are only converted to qlog JSON or to a quic_trace::Trace when
+// asked to, e.g. when the connection is closed with an error.
+class QUIC_NO_EXPORT QuicBinaryTraceVisitor
+    : public QuicConnectionDebugVisitor {
+ public:
+  enum class EventType : uint8_t {
+    kPacketSent,
+    // An ACK frame was received.
+    kAckReceived,
+    kPacketLost,
+    // The congestion controller state after processing an ACK frame.
+    kCongestionState,
+    kApplicationLimited,
+    kStreamFrameSent,
+    kStreamFrameReceived,
+    kRstStreamReceived,
+    kConnectionClosed,
+  };
+
+  // A recorded event.  The meaning of the fields depends on |type|:
+  //                    |number|        |value1|     |value2|     |value3|
+  // kPacketSent        packet number   length       frames       -
+  // kAckReceived       largest acked   ack delay us ranges       -
+  // kPacketLost        packet number   -            -            -
+  // kCongestionState   -               cwnd         bytes in     smoothed
+  //                                                 flight       RTT us
+  // kStreamFrame*      stream ID       offset       length       -
+  // kRstStreamReceived stream ID       final offset error code   -
+  // kConnectionClosed  error code      -            -            -
+  // |level| is the encryption level and |subtype| the transmission type of
+  // packets, or the close source for kConnectionClosed.  |flag| is whether the
+  // packet has crypto handshake data, whether the ACK updated the RTT, or
+  // whether the stream frame has a FIN.  Values above 2^32 - 1 are capped.
+  struct QUIC_NO_EXPORT Record {
+    // Time since the visitor was created, in microseconds.
+    uint64_t time_us;
+    uint64_t number;
+    uint32_t value1;
+    uint32_t value2;
+    uint32_t value3;
+    EventType type;
+    uint8_t level;
+    uint8_t subtype;
+    bool flag;
+  };
+  static_assert(sizeof(Record) == 32, "Record must stay compact");
+
+  class QUIC_NO_EXPORT Delegate {
+   public:
+    virtual ~Delegate() {}
+
+    // Called when the connection is closed with an error, while the records
+    // are still available.
+    virtual void OnConnectionClosedWithError(
+        const QuicBinaryTraceVisitor& visitor, QuicErrorCode error) = 0;
+  };
+
+  // Keeps the last |capacity| events, which is rounded up to a power of 2.
+  // |delegate| may be nullptr.
+  QuicBinaryTraceVisitor(const QuicConnection* connection, size_t capacity,
+                         Delegate* delegate);
+  QuicBinaryTraceVisitor(const QuicBinaryTraceVisitor&) = delete;
+  QuicBinaryTraceVisitor& operator=(const QuicBinaryTraceVisitor&) = delete;
+
+  // From QuicConnectionDebugVisitor.
+  void OnPacketSent(QuicPacketNumber packet_number,
+                    QuicPacketLength packet_length, bool has_crypto_handshake,
+                    TransmissionType transmission_type,
+                    EncryptionLevel encryption_level,
+                    const QuicFrames& retransmittable_frames,
+                    const QuicFrames& nonretransmittable_frames,
+                    QuicTime sent_time) override;
+  void OnIncomingAck(QuicPacketNumber ack_packet_number,
+                     EncryptionLevel ack_decrypted_level,
+                     const QuicAckFrame& ack_frame, QuicTime ack_receive_time,
+                     QuicPacketNumber largest_observed, bool rtt_updated,
+                     QuicPacketNumber least_unacked_sent_packet) override;
+  void OnPacketLoss(QuicPacketNumber lost_packet_number,
+                    EncryptionLevel encryption_level,
+                    TransmissionType transmission_type,
+                    QuicTime detection_time) override;
+  void OnApplicationLimited() override;
+  void OnStreamFrame(const QuicStreamFrame& frame) override;
+  void OnRstStreamFrame(const QuicRstStreamFrame& frame) override;
+  void OnConnectionClosed(const QuicConnectionCloseFrame& frame,
+                          ConnectionCloseSource source) override;
+
+  // Returns the recorded events, oldest first.
+  std::vector<Record> GetRecords() const;
+
+  // Number of events overwritten because the buffer was full.
+  uint64_t num_dropped_records() const {
+    return num_records_ > records_.size() ? num_records_ - records_.size() : 0;
+  }
+
+  // Returns the recorded events as a qlog (draft-ietf-quic-qlog-main-schema)
+  // JSON file.
+  std::string ToQlogJson() const;
+
+  // Appends the recorded events to |trace|.
+  void ToQuicTrace(quic_trace::Trace* trace) const;
+
+ private:
+  // Returns the record to fill for an event that happened at |time|.
+  Record& AddRecord(EventType type, QuicTime time);
+  void RecordCongestionState(QuicTime time);
+
+  const QuicConnection* connection_;
+  Delegate* delegate_;
+  const QuicTime start_time_;
+  // Size is a power of 2.
+  std::vector<Record> records_;
+  // Total number of events recorded, including the overwritten ones.
+  uint64_t num_records_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_BINARY_TRACE_VISITOR_H_
@@ -0,0 +1,200 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_binary_trace_visitor.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/match.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_interval_set.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+#include "quiche/quic/test_tools/simulator/quic_endpoint.h"
+#include "quiche/quic/test_tools/simulator/simulator.h"
+#include "quiche/quic/test_tools/simulator/switch.h"
+
+namespace quic::test {
+namespace {
+
+using EventType = QuicBinaryTraceVisitor::EventType;
+using Record = QuicBinaryTraceVisitor::Record;
+
+const QuicByteCount kTransferSize = 1000 * kMaxOutgoingPacketSize;
+const QuicStreamId kTestStreamNumber = 3;
+const QuicTime::Delta kDelay = QuicTime::Delta::FromMilliseconds(20);
+const QuicBandwidth kBandwidth = QuicBandwidth::FromKBitsPerSecond(1000);
+
+class MockDelegate : public QuicBinaryTraceVisitor::Delegate {
+ public:
+  MOCK_METHOD(void, OnConnectionClosedWithError,
+              (const QuicBinaryTraceVisitor&, QuicErrorCode), (override));
+};
+
+// Records the client side of a simulated transfer with some loss.
+class QuicBinaryTraceVisitorTest : public QuicTest {
+ protected:
+  QuicBinaryTraceVisitorTest()
+      : client_(&simulator_, "Client", "Server", Perspective::IS_CLIENT,
+                TestConnectionId()),
+        server_(&simulator_, "Server", "Client", Perspective::IS_SERVER,
+                TestConnectionId()),
+        network_switch_(&simulator_, "Switch", 8,
+                        0.5 * (kBandwidth * (2 * kDelay))),
+        client_link_(&client_, network_switch_.port(1), 2 * kBandwidth,
+                     kDelay),
+        server_link_(&server_, network_switch_.port(2), kBandwidth, kDelay) {}
+
+  // Transfers about a megabyte from client to server.
+  void Transfer(QuicBinaryTraceVisitor* visitor) {
+    client_.connection()->set_debug_visitor(visitor);
+    client_.AddBytesToTransfer(kTransferSize);
+    ASSERT_TRUE(simulator_.RunUntilOrTimeout(
+        [this]() { return server_.bytes_received() >= kTransferSize; },
+        3 * kBandwidth.TransferTime(kTransferSize)));
+    ASSERT_NE(0u, client_.connection()->GetStats().packets_retransmitted);
+  }
+
+  simulator::Simulator simulator_;
+  simulator::QuicEndpoint client_;
+  simulator::QuicEndpoint server_;
+  simulator::Switch network_switch_;
+  simulator::SymmetricLink client_link_;
+  simulator::SymmetricLink server_link_;
+};
+
+TEST_F(QuicBinaryTraceVisitorTest, RecordsAllEvents) {
+  QuicBinaryTraceVisitor visitor(client_.connection(), 1 << 20, nullptr);
+  Transfer(&visitor);
+  EXPECT_EQ(0u, visitor.num_dropped_records());
+
+  QuicPacketCount packets_sent = 0;
+  QuicPacketCount packets_lost = 0;
+  size_t acks = 0;
+  size_t congestion_states = 0;
+  QuicIntervalSet<QuicStreamOffset> offsets;
+  for (const Record& record : visitor.GetRecords()) {
+    switch (record.type) {
+      case EventType::kPacketSent:
+        ++packets_sent;
+        break;
+      case EventType::kPacketLost:
+        ++packets_lost;
+        break;
+      case EventType::kAckReceived:
+        ++acks;
+        break;
+      case EventType::kCongestionState:
+        ++congestion_states;
+        EXPECT_LT(0u, record.value1);
+        break;
+      case EventType::kStreamFrameSent:
+        if (record.number == kTestStreamNumber) {
+          offsets.Add(record.value1, record.value1 + record.value2);
+        }
+        break;
+      default:
+        break;
+    }
+  }
+  const QuicConnectionStats& stats = client_.connection()->GetStats();
+  EXPECT_EQ(stats.packets_sent, packets_sent);
+  EXPECT_EQ(stats.packets_lost, packets_lost);
+  EXPECT_LT(0u, acks);
+  EXPECT_EQ(acks, congestion_states);
+  ASSERT_EQ(1u, offsets.Size());
+  EXPECT_EQ(0u, offsets.begin()->min());
+  EXPECT_EQ(kTransferSize, offsets.rbegin()->max());
+}
+
+TEST_F(QuicBinaryTraceVisitorTest, KeepsLatestEvents) {
+  // Rounded up to 128.
+  QuicBinaryTraceVisitor visitor(client_.connection(), 100, nullptr);
+  Transfer(&visitor);
+  const std::vector<Record> records = visitor.GetRecords();
+  ASSERT_EQ(128u, records.size());
+  EXPECT_LT(0u, visitor.num_dropped_records());
+
+  QuicPacketNumber last_sent_packet;
+  for (const Record& record : records) {
+    if (record.type != EventType::kPacketSent) {
+      continue;
+    }
+    if (last_sent_packet.IsInitialized()) {
+      EXPECT_LT(last_sent_packet.ToUint64(), record.number);
+    }
+    last_sent_packet = QuicPacketNumber(record.number);
+  }
+  EXPECT_EQ(
+      client_.connection()->sent_packet_manager().GetLargestSentPacket(),
+      last_sent_packet);
+}
+
+TEST_F(QuicBinaryTraceVisitorTest, ToQuicTrace) {
+  QuicBinaryTraceVisitor visitor(client_.connection(), 1 << 20, nullptr);
+  Transfer(&visitor);
+  quic_trace::Trace trace;
+  visitor.ToQuicTrace(&trace);
+
+  QuicPacketCount packets_sent = 0;
+  QuicIntervalSet<QuicStreamOffset> offsets;
+  for (const quic_trace::Event& event : trace.events()) {
+    if (event.event_type() == quic_trace::PACKET_RECEIVED) {
+      EXPECT_TRUE(event.has_transport_state() ||
+                  event.frames(0).frame_type() == quic_trace::STREAM);
+    }
+    if (event.event_type() != quic_trace::PACKET_SENT) {
+      continue;
+    }
+    ++packets_sent;
+    for (const quic_trace::Frame& frame : event.frames()) {
+      const quic_trace::StreamFrameInfo& info = frame.stream_frame_info();
+      if (info.stream_id() == kTestStreamNumber) {
+        offsets.Add(info.offset(), info.offset() + info.length());
+      }
+    }
+  }
+  EXPECT_EQ(client_.connection()->GetStats().packets_sent, packets_sent);
+  ASSERT_EQ(1u, offsets.Size());
+  EXPECT_EQ(kTransferSize, offsets.rbegin()->max());
+}
+
+TEST_F(QuicBinaryTraceVisitorTest, ToQlogJson) {
+  QuicBinaryTraceVisitor visitor(client_.connection(), 256, nullptr);
+  Transfer(&visitor);
+  const std::string qlog = visitor.ToQlogJson();
+  EXPECT_TRUE(absl::StartsWith(
+      qlog,
+      "{\"qlog_version\":\"0.3\",\"qlog_format\":\"JSON\",\"traces\":[{"
+      "\"vantage_point\":{\"type\":\"client\"},\"common_fields\":{\"ODCID\":"
+      "\"000000000000002a\""));
+  EXPECT_TRUE(absl::StrContains(qlog, "\"name\":\"transport:packet_sent\""));
+  EXPECT_TRUE(absl::StrContains(qlog, "\"frame_type\":\"stream\""));
+  EXPECT_TRUE(
+      absl::StrContains(qlog, "\"name\":\"recovery:metrics_updated\""));
+  EXPECT_TRUE(absl::EndsWith(qlog, "}]}]}"));
+}
+
+TEST_F(QuicBinaryTraceVisitorTest, DumpOnErrorClose) {
+  MockDelegate delegate;
+  QuicBinaryTraceVisitor visitor(client_.connection(), 256, &delegate);
+  Transfer(&visitor);
+
+  EXPECT_CALL(delegate,
+              OnConnectionClosedWithError(testing::Ref(visitor),
+                                          QUIC_INTERNAL_ERROR))
+      .WillOnce([](const QuicBinaryTraceVisitor& visitor, QuicErrorCode) {
+        const std::vector<Record> records = visitor.GetRecords();
+        ASSERT_FALSE(records.empty());
+        EXPECT_EQ(EventType::kConnectionClosed, records.back().type);
+        EXPECT_EQ(static_cast<uint64_t>(QUIC_INTERNAL_ERROR),
+                  records.back().number);
+      });
+  client_.connection()->CloseConnection(
+      QUIC_INTERNAL_ERROR, "test", ConnectionCloseBehavior::SILENT_CLOSE);
+}
+
+}  // namespace
+}  // namespace quic::test
@@ -159,6 +159,9 @@ class QUIC_NO_EXPORT QuicBufferedPacketStore {
   // Is there any CHLO buffered in the store?
   bool HasChlosBuffered() const;
 
+  // Returns the number of connections with a CHLO buffered in the store.
+  size_t NumChlosBuffered() const { return connections_with_chlo_.size(); }
+
  private:
   friend class test::QuicBufferedPacketStorePeer;
 
@@ -266,6 +266,9 @@ TEST_F(QuicBufferedPacketStoreTest, EnqueueChloOnTooManyDifferentConnections) {
   EXPECT_TRUE(store_.HasChloForConnection(
       /*connection_id=*/TestConnectionId(1)));
 
+  EXPECT_EQ(kDefaultMaxConnectionsInStore - kMaxConnectionsWithoutCHLO + 1,
+            store_.NumChlosBuffered());
+
   QuicConnectionId delivered_conn_id;
   for (size_t i = 0;
        i < kDefaultMaxConnectionsInStore - kMaxConnectionsWithoutCHLO + 1;
@@ -283,6 +286,7 @@ TEST_F(QuicBufferedPacketStoreTest, EnqueueChloOnTooManyDifferentConnections) {
     }
   }
   EXPECT_FALSE(store_.HasChlosBuffered());
+  EXPECT_EQ(0u, store_.NumChlosBuffered());
 }
 
 // Tests that store expires long-staying connections appropriately for
@@ -372,6 +372,11 @@ QuicConnection::QuicConnection(
     }
   }
   packet_creator_.SetDefaultPeerAddress(initial_peer_address);
+  const int64_t cpu_profile_sample_interval =
+      GetQuicFlag(FLAGS_quic_cpu_profile_sample_interval);
+  if (cpu_profile_sample_interval > 0) {
+    EnableCpuProfiling(cpu_profile_sample_interval);
+  }
 }
 
 void QuicConnection::InstallInitialCrypters(QuicConnectionId connection_id) {
@@ -967,6 +972,37 @@ void QuicConnection::SetOriginalDestinationConnectionId(
       default_path_.server_connection_id;
 }
 
+void QuicConnection::OnRetryTokenValidated(
+    const QuicConnectionId& original_destination_connection_id) {
+  QUICHE_DCHECK_EQ(Perspective::IS_SERVER, perspective_);
+  QUIC_DLOG(INFO) << ENDPOINT << "Address validated via retry token, "
+                  << "original_destination_connection_id "
+                  << original_destination_connection_id;
+  QUICHE_DCHECK_NE(original_destination_connection_id,
+                   default_path_.server_connection_id);
+  QUICHE_DCHECK(!original_destination_connection_id_.has_value())
+      << original_destination_connection_id_.value();
+  QUICHE_DCHECK(!retry_source_connection_id_.has_value())
+      << retry_source_connection_id_.value();
+  // Unlike SetOriginalDestinationConnectionId(), the Initial keys do not
+  // change: the client derives them from the retry source connection ID.
+  original_destination_connection_id_ = original_destination_connection_id;
+  original_destination_connection_id_replacement_ =
+      default_path_.server_connection_id;
+  retry_source_connection_id_ = default_path_.server_connection_id;
+  default_path_.validated = true;
+  stats_.address_validated_via_token = true;
+}
+
+void QuicConnection::SetConnectionIdGenerator(
+    ConnectionIdGeneratorInterface* generator) {
+  QUICHE_DCHECK_EQ(Perspective::IS_SERVER, perspective_);
+  connection_id_generator_ = generator;
+  if (self_issued_cid_manager_ != nullptr) {
+    self_issued_cid_manager_->set_connection_id_generator(generator);
+  }
+}
+
 QuicConnectionId QuicConnection::GetOriginalDestinationConnectionId() {
   if (original_destination_connection_id_.has_value()) {
     return original_destination_connection_id_.value();
@@ -1214,6 +1250,7 @@ bool QuicConnection::OnPacketHeader(const QuicPacketHeader& header) {
   is_current_packet_connectivity_probing_ = false;
   has_path_challenge_in_current_packet_ = false;
   current_effective_peer_migration_type_ = NO_CHANGE;
+  current_packet_on_multipath_path_ = false;
 
   if (perspective_ == Perspective::IS_CLIENT) {
     if (!GetLargestReceivedPacket().IsInitialized() ||
@@ -1241,6 +1278,29 @@ bool QuicConnection::OnPacketHeader(const QuicPacketHeader& header) {
         QuicUtils::DetermineAddressChangeType(
             default_path_.peer_address,
             GetEffectivePeerAddressFromCurrentPacket());
+    const bool is_largest_received_packet =
+        !GetLargestReceivedPacket().IsInitialized() ||
+        header.packet_number > GetLargestReceivedPacket();
+    if (current_effective_peer_migration_type_ != NO_CHANGE) {
+      const QuicPathId path_id =
+          FindMultipathPath(last_received_packet_info_.destination_address,
+                            GetEffectivePeerAddressFromCurrentPacket());
+      if (path_id != kInvalidPathId) {
+        // Packets received on additional paths do not migrate the connection.
+        current_packet_on_multipath_path_ = true;
+        current_effective_peer_migration_type_ = NO_CHANGE;
+        MultipathPath* path = multipath_paths_[path_id].get();
+        if (!path->validated) {
+          path->bytes_received_before_address_validation +=
+              last_received_packet_info_.length;
+        }
+        if (is_largest_received_packet) {
+          ack_path_id_ = path_id;
+        }
+      }
+    } else if (is_largest_received_packet) {
+      ack_path_id_ = kDefaultPathId;
+    }
 
     if (connection_migration_use_new_cid_) {
       auto effective_peer_address = GetEffectivePeerAddressFromCurrentPacket();
@@ -1355,7 +1415,11 @@ bool QuicConnection::OnStreamFrame(const QuicStreamFrame& frame) {
   // MaybeUpdateAckTimeout to a stand-alone function instead of calling them for
   // all frames.
   MaybeUpdateAckTimeout();
-  visitor_->OnStreamFrame(frame);
+  {
+    QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                       QuicCpuProfileCategory::kStreamDelivery);
+    visitor_->OnStreamFrame(frame);
+  }
   stats_.stream_bytes_received += frame.data_length;
   if (use_ping_manager_) {
     ping_manager_.reset_consecutive_retransmittable_on_wire_count();
@@ -1491,10 +1555,15 @@ bool QuicConnection::OnAckFrameEnd(QuicPacketNumber start) {
       sent_packet_manager_.one_rtt_packet_acked();
   const bool zero_rtt_packet_was_acked =
       sent_packet_manager_.zero_rtt_packet_acked();
-  const AckResult ack_result = sent_packet_manager_.OnAckFrameEnd(
-      idle_network_detector_.time_of_last_received_packet(),
-      last_received_packet_info_.header.packet_number,
-      last_received_packet_info_.decrypted_level);
+  AckResult ack_result;
+  {
+    QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                       QuicCpuProfileCategory::kAckProcessing);
+    ack_result = sent_packet_manager_.OnAckFrameEnd(
+        idle_network_detector_.time_of_last_received_packet(),
+        last_received_packet_info_.header.packet_number,
+        last_received_packet_info_.decrypted_level);
+  }
   if (ack_result != PACKETS_NEWLY_ACKED &&
       ack_result != NO_PACKETS_NEWLY_ACKED) {
     // Error occurred (e.g., this ACK tries to ack packets in wrong packet
@@ -2321,6 +2390,9 @@ void QuicConnection::OnKeyUpdate(KeyUpdateReason reason) {
 
   lowest_packet_sent_in_current_key_phase_.Clear();
   stats_.key_update_count++;
+  if (reason != KeyUpdateReason::kRemote) {
+    stats_.local_key_update_count++;
+  }
 
   // If another key update triggers while the previous
   // discard_previous_one_rtt_keys_alarm_ hasn't fired yet, cancel it since the
@@ -2584,6 +2656,11 @@ const QuicConnectionStats& QuicConnection::GetStats() {
   sent_packet_manager_.GetSendAlgorithm()->PopulateConnectionStats(&stats_);
   stats_.egress_mtu = long_term_mtu_;
   stats_.ingress_mtu = largest_received_packet_size_;
+  stats_.pre_derived_key_update_count = framer_.pre_derived_key_update_count();
+  stats_.num_key_update_trial_decryptions =
+      framer_.key_update_trial_decryption_count();
+  stats_.num_failed_key_update_trial_decryptions =
+      framer_.failed_key_update_trial_decryption_count();
   return stats_;
 }
 
@@ -2722,6 +2799,8 @@ void QuicConnection::ProcessUdpPacket(const QuicSocketAddress& self_address,
   if (!connected_) {
     return;
   }
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                     QuicCpuProfileCategory::kReceive);
   QUIC_DVLOG(2) << ENDPOINT << "Received encrypted " << packet.length()
                 << " bytes:" << std::endl
                 << quiche::QuicheTextUtils::HexDump(
@@ -3108,9 +3187,14 @@ void QuicConnection::WriteQueuedPackets() {
       break;
     }
     const BufferedPacket& packet = buffered_packets_.front();
-    WriteResult result = writer_->WritePacket(
-        packet.data.get(), packet.length, packet.self_address.host(),
-        packet.peer_address, per_packet_options_);
+    WriteResult result;
+    {
+      QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                         QuicCpuProfileCategory::kWrite);
+      result = writer_->WritePacket(
+          packet.data.get(), packet.length, packet.self_address.host(),
+          packet.peer_address, per_packet_options_);
+    }
     QUIC_DVLOG(1) << ENDPOINT << "Sending buffered packet, result: " << result;
     if (IsMsgTooBig(writer_, result) && packet.length > long_term_mtu_) {
       // When MSG_TOO_BIG is returned, the system typically knows what the
@@ -3210,6 +3294,13 @@ const QuicFrames QuicConnection::MaybeBundleAckOpportunistically() {
       auto frame = sent_packet_manager_.GetUpdatedAckFrequencyFrame();
       visitor_->SendAckFrequency(frame);
     }
+  } else if (ack_frequency_sent_) {
+    absl::optional<QuicAckFrequencyFrame> frame =
+        sent_packet_manager_.MaybeGetUpdatedAckFrequencyFrame(
+            clock_->ApproximateNow());
+    if (frame.has_value()) {
+      visitor_->SendAckFrequency(*frame);
+    }
   }
 
   QuicFrames frames;
@@ -3473,18 +3564,45 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
       //
       // writer_->WritePacket transfers buffer ownership back to the writer.
       packet->release_encrypted_buffer = nullptr;
-      result = writer_->WritePacket(packet->encrypted_buffer, encrypted_length,
-                                    self_address().host(), send_to_address,
-                                    per_packet_options_);
-      // This is a work around for an issue with linux UDP GSO batch writers.
-      // When sending a GSO packet with 2 segments, if the first segment is
-      // larger than the path MTU, instead of EMSGSIZE, the linux kernel returns
-      // EINVAL, which translates to WRITE_STATUS_ERROR and causes conneciton to
-      // be closed. By manually flush the writer here, the MTU probe is sent in
-      // a normal(non-GSO) packet, so the kernel can return EMSGSIZE and we will
-      // not close the connection.
-      if (is_mtu_discovery && writer_->IsBatchMode()) {
-        result = writer_->Flush();
+      {
+        QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                           QuicCpuProfileCategory::kWrite);
+        QuicPacketWriter* writer = writer_;
+        QuicIpAddress self_host = self_address().host();
+        const bool send_on_multipath = ShouldSendOnMultipath(
+            *packet, send_on_current_path, is_mtu_discovery);
+        QuicPathId path_id = kDefaultPathId;
+        if (send_on_multipath) {
+          path_id = sent_packet_manager_.SelectPathForNextPacket(
+              clock_->ApproximateNow());
+        } else if (ShouldSendAckOnMultipath(*packet, send_on_current_path,
+                                            is_mtu_discovery)) {
+          path_id = ack_path_id_;
+        }
+        if (path_id != kDefaultPathId && CanWriteOnMultipathPath(path_id)) {
+          const MultipathPath& path = *multipath_paths_[path_id];
+          packet->path_id = path_id;
+          writer = path.writer != nullptr ? path.writer : writer_;
+          self_host = path.self_address.host();
+          send_to_address = path.peer_address;
+        }
+        if (send_on_multipath &&
+            sent_packet_manager_.DuplicatesPacketsOnAllPaths()) {
+          WriteMultipathDuplicates(*packet, packet->path_id);
+        }
+        result = writer->WritePacket(packet->encrypted_buffer, encrypted_length,
+                                     self_host, send_to_address,
+                                     per_packet_options_);
+        // This is a work around for an issue with linux UDP GSO batch
+        // writers. When sending a GSO packet with 2 segments, if the first
+        // segment is larger than the path MTU, instead of EMSGSIZE, the linux
+        // kernel returns EINVAL, which translates to WRITE_STATUS_ERROR and
+        // causes conneciton to be closed. By manually flush the writer here,
+        // the MTU probe is sent in a normal(non-GSO) packet, so the kernel can
+        // return EMSGSIZE and we will not close the connection.
+        if (is_mtu_discovery && writer_->IsBatchMode()) {
+          result = writer_->Flush();
+        }
       }
       break;
     case LEGACY_VERSION_ENCAPSULATE: {
@@ -3540,6 +3658,19 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
       WRITE_STATUS_NUM_VALUES,
       "Status code returned by writer_->WritePacket() in QuicConnection.");
 
+  bool remove_multipath_path = false;
+  if (packet->path_id != kDefaultPathId &&
+      (IsWriteBlockedStatus(result.status) || IsWriteError(result.status))) {
+    // Neither buffer the packet nor close the connection because of an
+    // additional path. The packet is recorded as sent, and its data gets
+    // retransmitted once it is detected lost or the failed path is removed.
+    QUIC_DLOG(INFO) << ENDPOINT << "Failed writing packet " << packet_number
+                    << " on path " << static_cast<int>(packet->path_id)
+                    << ", status: " << result.status;
+    remove_multipath_path = IsWriteError(result.status);
+    result = WriteResult(WRITE_STATUS_OK, 0);
+  }
+
   if (IsWriteBlockedStatus(result.status)) {
     // Ensure the writer is still write blocked, otherwise QUIC may continue
     // trying to write when it will not be able to.
@@ -3623,7 +3754,13 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
   QUIC_DVLOG(1) << ENDPOINT << "time we began writing last sent packet: "
                 << packet_send_time.ToDebuggingValue();
 
-  if (IsDefaultPath(default_path_.self_address, send_to_address)) {
+  if (packet->path_id != kDefaultPathId) {
+    ++stats_.num_packets_sent_on_additional_paths;
+    MultipathPath* path = multipath_paths_[packet->path_id].get();
+    if (!path->validated) {
+      path->bytes_sent_before_address_validation += encrypted_length;
+    }
+  } else if (IsDefaultPath(default_path_.self_address, send_to_address)) {
     if (EnforceAntiAmplificationLimit()) {
       // Include bytes sent even if they are not in flight.
       default_path_.bytes_sent_before_address_validation += encrypted_length;
@@ -3647,6 +3784,9 @@ bool QuicConnection::WritePacket(SerializedPacket* packet) {
                   !sent_packet_manager_.HasInFlightPackets())
       << ENDPOINT
       << "Trying to start blackhole detection without no bytes in flight";
+  if (remove_multipath_path) {
+    RemoveMultipathPath(packet->path_id);
+  }
 
   if (debug_visitor_ != nullptr) {
     if (sent_packet_manager_.unacked_packets().empty()) {
@@ -3784,6 +3924,12 @@ bool QuicConnection::MaybeHandleAeadConfidentialityLimits(
     return true;
   }
 
+  if (num_packets_encrypted_in_current_key_phase >= key_update_limit / 2) {
+    // In case the previous keys have not been discarded yet, make sure the
+    // keys of the key update below are ready well before it.
+    MaybeDeriveNextOneRttKeys();
+  }
+
   if (IsKeyUpdateAllowed() &&
       num_packets_encrypted_in_current_key_phase >= key_update_limit) {
     // Approaching the confidentiality limit, initiate key update so that
@@ -3828,7 +3974,12 @@ void QuicConnection::FlushPackets() {
     return;
   }
 
-  WriteResult result = writer_->Flush();
+  WriteResult result;
+  {
+    QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                       QuicCpuProfileCategory::kWrite);
+    result = writer_->Flush();
+  }
 
   QUIC_HISTOGRAM_ENUM("QuicConnection.FlushPacketStatus", result.status,
                       WRITE_STATUS_NUM_VALUES,
@@ -4013,12 +4164,14 @@ QuicConnection::MakeSelfIssuedConnectionIdManager() {
                  !default_path_.client_connection_id.IsEmpty()) ||
                 (perspective_ == Perspective::IS_SERVER &&
                  !default_path_.server_connection_id.IsEmpty()));
-  return std::make_unique<QuicSelfIssuedConnectionIdManager>(
+  auto manager = std::make_unique<QuicSelfIssuedConnectionIdManager>(
       kMinNumOfActiveConnectionIds,
       perspective_ == Perspective::IS_CLIENT
           ? default_path_.client_connection_id
           : default_path_.server_connection_id,
       clock_, alarm_factory_, this, context());
+  manager->set_connection_id_generator(connection_id_generator_);
+  return manager;
 }
 
 void QuicConnection::MaybeSendConnectionIdToClient() {
@@ -4313,6 +4466,20 @@ void QuicConnection::RemoveDecrypter(EncryptionLevel level) {
 
 void QuicConnection::DiscardPreviousOneRttKeys() {
   framer_.DiscardPreviousOneRttKeys();
+  // Without the previous keys, packets with the other key phase can only
+  // initiate a key update. Derive its keys now rather than when such a packet
+  // arrives, which also avoids a timing side channel on key updates.
+  MaybeDeriveNextOneRttKeys();
+}
+
+void QuicConnection::MaybeDeriveNextOneRttKeys() {
+  if (!GetQuicReloadableFlag(quic_pre_derive_next_one_rtt_keys) ||
+      !support_key_update_for_connection_ || !IsHandshakeConfirmed()) {
+    return;
+  }
+  if (!framer_.DeriveNextOneRttKeys()) {
+    QUIC_DLOG(INFO) << ENDPOINT << "Failed to derive next 1-RTT keys";
+  }
 }
 
 bool QuicConnection::IsKeyUpdateAllowed() const {
@@ -5678,6 +5845,9 @@ bool QuicConnection::UpdatePacketContent(QuicFrameType type) {
 
 void QuicConnection::MaybeStartIetfPeerMigration() {
   QUICHE_DCHECK(version().HasIetfQuicFrames());
+  if (current_packet_on_multipath_path_) {
+    return;
+  }
   if (current_effective_peer_migration_type_ != NO_CHANGE &&
       !IsHandshakeConfirmed()) {
     QUIC_LOG_EVERY_N_SEC(INFO, 60)
@@ -5699,7 +5869,10 @@ void QuicConnection::MaybeStartIetfPeerMigration() {
   if (GetLargestReceivedPacket().IsInitialized() &&
       last_received_packet_info_.header.packet_number ==
           GetLargestReceivedPacket()) {
-    if (current_effective_peer_migration_type_ != NO_CHANGE) {
+    if (current_effective_peer_migration_type_ != NO_CHANGE &&
+        MaybeAddMultipathPathFromPeer()) {
+      current_packet_on_multipath_path_ = true;
+    } else if (current_effective_peer_migration_type_ != NO_CHANGE) {
       // Start effective peer migration when the current packet contains a
       // non-probing frame.
       // TODO(fayang): When multiple packet number spaces is supported, only
@@ -5708,6 +5881,7 @@ void QuicConnection::MaybeStartIetfPeerMigration() {
         UpdatePeerAddress(last_received_packet_info_.source_address);
       }
       StartEffectivePeerMigration(current_effective_peer_migration_type_);
+      ack_path_id_ = kDefaultPathId;
     } else {
       UpdatePeerAddress(last_received_packet_info_.source_address);
     }
@@ -5756,6 +5930,14 @@ void QuicConnection::SetDataProducer(
   framer_.set_data_producer(data_producer);
 }
 
+void QuicConnection::EnableCpuProfiling(uint64_t sample_interval) {
+  QUICHE_DCHECK_LT(0u, sample_interval);
+  cpu_profiler_ =
+      std::make_unique<QuicCpuProfiler>(&stats_.cpu_profile, sample_interval);
+  framer_.set_cpu_profiler(cpu_profiler_.get());
+  packet_creator_.set_cpu_profiler(cpu_profiler_.get());
+}
+
 void QuicConnection::SetTransmissionType(TransmissionType type) {
   packet_creator_.SetTransmissionType(type);
 }
@@ -6046,9 +6228,14 @@ bool QuicConnection::FlushCoalescedPacket() {
     return true;
   }
 
-  WriteResult result = writer_->WritePacket(
-      buffer, length, coalesced_packet_.self_address().host(),
-      coalesced_packet_.peer_address(), per_packet_options_);
+  WriteResult result;
+  {
+    QuicCpuProfiler::ScopedTimer timer(cpu_profiler_.get(),
+                                       QuicCpuProfileCategory::kWrite);
+    result = writer_->WritePacket(
+        buffer, length, coalesced_packet_.self_address().host(),
+        coalesced_packet_.peer_address(), per_packet_options_);
+  }
   if (IsWriteError(result.status)) {
     OnWriteError(result.error_code);
     return false;
@@ -6894,6 +7081,213 @@ bool QuicConnection::MigratePath(const QuicSocketAddress& self_address,
   return true;
 }
 
+QuicConnection::MultipathPath::MultipathPath(
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address, QuicPacketWriter* writer,
+    bool owns_writer)
+    : self_address(self_address),
+      peer_address(peer_address),
+      writer(writer),
+      owns_writer(owns_writer) {}
+
+QuicConnection::MultipathPath::~MultipathPath() {
+  if (owns_writer) {
+    delete writer;
+  }
+}
+
+QuicPathId QuicConnection::AddMultipathPath(
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address, QuicPacketWriter* writer,
+    bool owns_writer) {
+  if (!connected_ || !sent_packet_manager_.multipath_enabled() ||
+      !version().HasIetfQuicFrames() || !IsHandshakeConfirmed()) {
+    QUIC_DLOG(INFO) << ENDPOINT << "Not adding multipath path from "
+                    << self_address << " to " << peer_address;
+    return kInvalidPathId;
+  }
+  if (IsDefaultPath(self_address, peer_address) ||
+      FindMultipathPath(self_address, peer_address) != kInvalidPathId) {
+    QUIC_BUG(quic_bug_10511_47)
+        << ENDPOINT << "Path from " << self_address << " to " << peer_address
+        << " is already in use";
+    return kInvalidPathId;
+  }
+  for (QuicPathId path_id = kDefaultPathId + 1;
+       path_id < kMaxNumMultipathPaths; ++path_id) {
+    if (multipath_paths_[path_id] != nullptr) {
+      continue;
+    }
+    if (!sent_packet_manager_.AddPath(path_id)) {
+      return kInvalidPathId;
+    }
+    QUIC_DLOG(INFO) << ENDPOINT << "Adding multipath path "
+                    << static_cast<int>(path_id) << " from " << self_address
+                    << " to " << peer_address;
+    auto path = std::make_unique<MultipathPath>(self_address, peer_address,
+                                                writer, owns_writer);
+    // Paths added by the client have been validated by the client beforehand.
+    path->validated = perspective_ == Perspective::IS_CLIENT;
+    multipath_paths_[path_id] = std::move(path);
+    return path_id;
+  }
+  QUIC_DLOG(INFO) << ENDPOINT << "Too many multipath paths";
+  return kInvalidPathId;
+}
+
+void QuicConnection::RemoveMultipathPath(QuicPathId path_id) {
+  if (path_id == kDefaultPathId || path_id >= kMaxNumMultipathPaths ||
+      multipath_paths_[path_id] == nullptr) {
+    QUIC_BUG(quic_bug_10511_48)
+        << ENDPOINT << "Removing unknown multipath path "
+        << static_cast<int>(path_id);
+    return;
+  }
+  QUIC_DLOG(INFO) << ENDPOINT << "Removing multipath path "
+                  << static_cast<int>(path_id);
+  sent_packet_manager_.RemovePath(path_id);
+  multipath_paths_[path_id].reset();
+  if (ack_path_id_ == path_id) {
+    ack_path_id_ = kDefaultPathId;
+  }
+}
+
+size_t QuicConnection::GetNumAdditionalMultipathPaths() const {
+  size_t num_paths = 0;
+  for (const std::unique_ptr<MultipathPath>& path : multipath_paths_) {
+    if (path != nullptr) {
+      ++num_paths;
+    }
+  }
+  return num_paths;
+}
+
+QuicPathId QuicConnection::FindMultipathPath(
+    const QuicSocketAddress& self_address,
+    const QuicSocketAddress& peer_address) const {
+  for (QuicPathId path_id = kDefaultPathId + 1;
+       path_id < kMaxNumMultipathPaths; ++path_id) {
+    const MultipathPath* path = multipath_paths_[path_id].get();
+    if (path != nullptr && path->self_address == self_address &&
+        path->peer_address == peer_address) {
+      return path_id;
+    }
+  }
+  return kInvalidPathId;
+}
+
+bool QuicConnection::MaybeAddMultipathPathFromPeer() {
+  if (perspective_ != Perspective::IS_SERVER ||
+      !sent_packet_manager_.multipath_enabled()) {
+    return false;
+  }
+  // Like QuicUtils::DetermineAddressChangeType(), consider a port or subnet
+  // change to be caused by a NAT rather than by the peer adding a path. The
+  // peer no longer receives on the previous address, so the default path has
+  // to follow it.
+  if (last_received_packet_info_.destination_address ==
+          default_path_.self_address &&
+      (current_effective_peer_migration_type_ == PORT_CHANGE ||
+       current_effective_peer_migration_type_ == IPV4_SUBNET_CHANGE)) {
+    QUIC_DLOG(INFO) << ENDPOINT << "Migrating the default path upon NAT "
+                    << "rebinding to "
+                    << GetEffectivePeerAddressFromCurrentPacket();
+    return false;
+  }
+  const QuicPathId path_id = AddMultipathPath(
+      last_received_packet_info_.destination_address,
+      GetEffectivePeerAddressFromCurrentPacket(), /*writer=*/nullptr,
+      /*owns_writer=*/false);
+  if (path_id == kInvalidPathId) {
+    return false;
+  }
+  multipath_paths_[path_id]->bytes_received_before_address_validation +=
+      last_received_packet_info_.length;
+  ack_path_id_ = path_id;
+  return true;
+}
+
+bool QuicConnection::ShouldSendOnMultipath(const SerializedPacket& packet,
+                                           bool send_on_current_path,
+                                           bool is_mtu_discovery) {
+  // The MTU is only discovered on the default path, and packets intended for
+  // alternative paths, e.g., during migration, stay on them.
+  return sent_packet_manager_.multipath_enabled() && send_on_current_path &&
+         !is_mtu_discovery &&
+         packet.encryption_level == ENCRYPTION_FORWARD_SECURE &&
+         IsRetransmittable(packet) == HAS_RETRANSMITTABLE_DATA &&
+         GetNumAdditionalMultipathPaths() > 0;
+}
+
+bool QuicConnection::ShouldSendAckOnMultipath(const SerializedPacket& packet,
+                                              bool send_on_current_path,
+                                              bool is_mtu_discovery) const {
+  return ack_path_id_ != kDefaultPathId && send_on_current_path &&
+         !is_mtu_discovery &&
+         packet.encryption_level == ENCRYPTION_FORWARD_SECURE &&
+         IsRetransmittable(packet) == NO_RETRANSMITTABLE_DATA;
+}
+
+bool QuicConnection::CanWriteOnMultipathPath(QuicPathId path_id) {
+  MultipathPath* path = multipath_paths_[path_id].get();
+  if (path == nullptr) {
+    return false;
+  }
+  QuicPacketWriter* writer = path->writer != nullptr ? path->writer : writer_;
+  if (writer->IsWriteBlocked()) {
+    return false;
+  }
+  if (!path->validated && sent_packet_manager_.HasAckedPacketOnPath(path_id)) {
+    path->validated = true;
+  }
+  return path->validated ||
+         path->bytes_sent_before_address_validation <
+             anti_amplification_factor_ *
+                 path->bytes_received_before_address_validation;
+}
+
+void QuicConnection::WriteMultipathDuplicates(const SerializedPacket& packet,
+                                              QuicPathId path_id) {
+  const QuicTime now = clock_->ApproximateNow();
+  for (QuicPathId other = kDefaultPathId; other < kMaxNumMultipathPaths;
+       ++other) {
+    // Copies only use the capacity the path's own packets leave unused. They
+    // share the packet number of |packet|, so they are not tracked as sent on
+    // |other|.
+    if (other == path_id || !sent_packet_manager_.CanSendOnPath(other, now)) {
+      continue;
+    }
+    QuicPacketWriter* writer = writer_;
+    QuicIpAddress self_host = self_address().host();
+    QuicSocketAddress peer = peer_address();
+    MultipathPath* path = multipath_paths_[other].get();
+    if (other != kDefaultPathId) {
+      if (!CanWriteOnMultipathPath(other)) {
+        continue;
+      }
+      if (path->writer != nullptr) {
+        writer = path->writer;
+      }
+      self_host = path->self_address.host();
+      peer = path->peer_address;
+    } else if (writer_->IsWriteBlocked()) {
+      continue;
+    }
+    // Copies are best effort, so failures are ignored.
+    const WriteResult result =
+        writer->WritePacket(packet.encrypted_buffer, packet.encrypted_length,
+                            self_host, peer, per_packet_options_);
+    if (result.status != WRITE_STATUS_OK) {
+      continue;
+    }
+    ++stats_.num_duplicate_packets_sent_on_multipath;
+    stats_.bytes_sent_in_multipath_duplicates += packet.encrypted_length;
+    if (path != nullptr && !path->validated) {
+      path->bytes_sent_before_address_validation += packet.encrypted_length;
+    }
+  }
+}
+
 void QuicConnection::OnPathValidationFailureAtClient() {
   if (connection_migration_use_new_cid_) {
     QUICHE_DCHECK(perspective_ == Perspective::IS_CLIENT);
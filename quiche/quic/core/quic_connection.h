@@ -26,8 +26,10 @@
 
 #include "absl/strings/string_view.h"
 #include "absl/types/optional.h"
+#include "absl/types/span.h"
 #include "quiche/quic/core/crypto/quic_decrypter.h"
 #include "quiche/quic/core/crypto/quic_encrypter.h"
+#include "quiche/quic/core/connection_id_generator.h"
 #include "quiche/quic/core/crypto/transport_parameters.h"
 #include "quiche/quic/core/frames/quic_ack_frequency_frame.h"
 #include "quiche/quic/core/frames/quic_max_streams_frame.h"
@@ -41,6 +43,7 @@
 #include "quiche/quic/core/quic_connection_id_manager.h"
 #include "quiche/quic/core/quic_connection_stats.h"
 #include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_cpu_profiler.h"
 #include "quiche/quic/core/quic_framer.h"
 #include "quiche/quic/core/quic_idle_network_detector.h"
 #include "quiche/quic/core/quic_mtu_discovery.h"
@@ -572,6 +575,14 @@ class QUIC_EXPORT_PRIVATE QuicConnection
                                 const QuicSocketAddress& peer_address,
                                 const QuicReceivedPacket& packet);
 
+  // Called with a burst of packets about to be passed to ProcessUdpPacket(),
+  // in the same order, so that their header protection masks are computed at
+  // once.
+  void PrecomputeHeaderProtectionMasks(
+      absl::Span<const absl::string_view> packets) {
+    framer_.PrecomputeHeaderProtectionMasks(packets);
+  }
+
   // QuicBlockedWriterInterface
   // Called when the underlying connection becomes writable to allow queued
   // writes to happen.
@@ -748,6 +759,10 @@ class QUIC_EXPORT_PRIVATE QuicConnection
     debug_visitor_ = debug_visitor;
     sent_packet_manager_.SetDebugDelegate(debug_visitor);
   }
+  // Starts attributing the CPU time of the hot path to the categories of
+  // |stats_.cpu_profile|, timing one in |sample_interval| operations.  Also
+  // enabled for all connections by --quic_cpu_profile_sample_interval.
+  void EnableCpuProfiling(uint64_t sample_interval);
   // Used in Chromium, but not internally.
   // Must only be called before ping_alarm_ is set.
   void set_keep_alive_ping_timeout(QuicTime::Delta keep_alive_ping_timeout);
@@ -1093,6 +1108,25 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Returns the original destination connection ID used for this connection.
   QuicConnectionId GetOriginalDestinationConnectionId();
 
+  // Called by QuicDispatcher on the server when the Initial which created this
+  // connection carries a valid retry token. The client sent its first Initial
+  // to |original_destination_connection_id| and retried to the server
+  // connection ID, which was the source connection ID of the RETRY packet.
+  // This validates the client address.
+  void OnRetryTokenValidated(
+      const QuicConnectionId& original_destination_connection_id);
+
+  // Called by QuicDispatcher on the server to have |generator| generate the
+  // connection IDs this connection issues. |generator| must outlive this
+  // connection.
+  void SetConnectionIdGenerator(ConnectionIdGeneratorInterface* generator);
+
+  // Source connection ID of the RETRY packet received by the client, or, on
+  // the server, sent in response to the client's first Initial.
+  const absl::optional<QuicConnectionId>& retry_source_connection_id() const {
+    return retry_source_connection_id_;
+  }
+
   // Called when ACK alarm goes off. Sends ACKs of those packet number spaces
   // which have expired ACK timeout. Only used when this connection supports
   // multiple packet number spaces.
@@ -1196,6 +1230,24 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // client side.
   void OnPathValidationFailureAtClient();
 
+  // Once multipath is enabled and the handshake is confirmed, adds the path
+  // defined by |self_address| and |peer_address| such that 1-RTT data packets
+  // are spread across it and the default path. The caller should have
+  // validated the path, e.g., with ValidatePath(). |writer| is owned by the
+  // connection if |owns_writer| is true and the path is added. Returns the ID
+  // of the new path, or kInvalidPathId on failure, in which case the caller
+  // keeps |writer|.
+  QuicPathId AddMultipathPath(const QuicSocketAddress& self_address,
+                              const QuicSocketAddress& peer_address,
+                              QuicPacketWriter* writer, bool owns_writer);
+
+  // Stops sending on |path_id|. Data in flight on it is retransmitted on the
+  // remaining paths.
+  void RemoveMultipathPath(QuicPathId path_id);
+
+  // Returns the number of paths in use besides the default path.
+  size_t GetNumAdditionalMultipathPaths() const;
+
   void SetSourceAddressTokenToSend(absl::string_view token);
 
   void SendPing() {
@@ -1393,6 +1445,29 @@ class QUIC_EXPORT_PRIVATE QuicConnection
     absl::optional<RttStats> rtt_stats;
   };
 
+  // A path of a multipath connection other than the default path.
+  struct QUIC_EXPORT_PRIVATE MultipathPath {
+    MultipathPath(const QuicSocketAddress& self_address,
+                  const QuicSocketAddress& peer_address,
+                  QuicPacketWriter* writer, bool owns_writer);
+    MultipathPath(const MultipathPath& other) = delete;
+    MultipathPath& operator=(const MultipathPath& other) = delete;
+    ~MultipathPath();
+
+    QuicSocketAddress self_address;
+    QuicSocketAddress peer_address;
+    // Owned or not depending on |owns_writer|. Null if the path shares the
+    // connection's writer.
+    QuicPacketWriter* writer;
+    bool owns_writer;
+    // Paths added by the server upon receiving packets from a new peer address
+    // are not validated until a packet sent on them gets acknowledged. Until
+    // then, the anti-amplification limit applies.
+    bool validated = false;
+    QuicByteCount bytes_received_before_address_validation = 0;
+    QuicByteCount bytes_sent_before_address_validation = 0;
+  };
+
   using QueuedPacketList = std::list<SerializedPacket>;
 
   // BufferedPacket stores necessary information (encrypted buffer and self/peer
@@ -1579,6 +1654,10 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // termination packets.
   bool MaybeHandleAeadConfidentialityLimits(const SerializedPacket& packet);
 
+  // Derives the 1-RTT keys of the next key phase ahead of the next key update,
+  // if enabled and not done yet.
+  void MaybeDeriveNextOneRttKeys();
+
   // Flush packets buffered in the writer, if any.
   void FlushPackets();
 
@@ -1827,6 +1906,37 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   bool IsAlternativePath(const QuicSocketAddress& self_address,
                          const QuicSocketAddress& peer_address) const;
 
+  // Returns the ID of the additional multipath path with the given addresses,
+  // or kInvalidPathId if there is none.
+  QuicPathId FindMultipathPath(const QuicSocketAddress& self_address,
+                               const QuicSocketAddress& peer_address) const;
+
+  // Called by the server on receiving a non-probing packet from a new peer
+  // address. Keeps the default path and starts sending on the new address as
+  // an additional path if multipath is enabled, unless the new address is a
+  // NAT rebinding of the default path, which then migrates as usual. Returns
+  // true if the path was added.
+  bool MaybeAddMultipathPathFromPeer();
+
+  // Returns true if |packet| may be written to an additional multipath path.
+  bool ShouldSendOnMultipath(const SerializedPacket& packet,
+                             bool send_on_current_path,
+                             bool is_mtu_discovery);
+
+  // Returns true if |packet|, which carries no retransmittable data, is sent
+  // on |ack_path_id_| rather than on the default path.
+  bool ShouldSendAckOnMultipath(const SerializedPacket& packet,
+                                bool send_on_current_path,
+                                bool is_mtu_discovery) const;
+
+  // Returns true if additional path |path_id| is neither write blocked nor
+  // limited by the anti-amplification limit.
+  bool CanWriteOnMultipathPath(QuicPathId path_id);
+
+  // Writes best-effort copies of |packet| on the paths other than |path_id|.
+  void WriteMultipathDuplicates(const SerializedPacket& packet,
+                                QuicPathId path_id);
+
   // Restore connection default path and congestion control state to the last
   // validated path and its state. Called after fail to validate peer address
   // upon detecting a peer migration.
@@ -1980,6 +2090,9 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // Statistics for this session.
   QuicConnectionStats stats_;
 
+  // Not null if CPU profiling is enabled.
+  std::unique_ptr<QuicCpuProfiler> cpu_profiler_;
+
   UberReceivedPacketManager uber_received_packet_manager_;
 
   // Indicates how many consecutive times an ack has arrived which indicates
@@ -2137,6 +2250,8 @@ class QUIC_EXPORT_PRIVATE QuicConnection
 
   std::unique_ptr<QuicPeerIssuedConnectionIdManager> peer_issued_cid_manager_;
   std::unique_ptr<QuicSelfIssuedConnectionIdManager> self_issued_cid_manager_;
+  // Set by SetConnectionIdGenerator().
+  ConnectionIdGeneratorInterface* connection_id_generator_ = nullptr;
 
   // Time this connection can release packets into the future.
   QuicTime::Delta release_time_into_future_;
@@ -2160,7 +2275,8 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   QuicConnectionId original_destination_connection_id_replacement_;
 
   // After we receive a RETRY packet, |retry_source_connection_id_| contains
-  // the source connection ID from that packet.
+  // the source connection ID from that packet. On the server, it is set by
+  // OnRetryTokenValidated().
   absl::optional<QuicConnectionId> retry_source_connection_id_;
 
   // Used to store content of packets which cannot be sent because of write
@@ -2240,6 +2356,19 @@ class QUIC_EXPORT_PRIVATE QuicConnection
   // 2), do not override it on receiving PATH_CHALLENGE (case 1).
   PathState alternative_path_;
 
+  // The paths of a multipath connection besides the default path, indexed by
+  // path ID. The entry of kDefaultPathId is always null.
+  std::unique_ptr<MultipathPath> multipath_paths_[kMaxNumMultipathPaths];
+
+  // True if the packet currently being processed was received on one of
+  // |multipath_paths_|.
+  bool current_packet_on_multipath_path_ = false;
+
+  // The path on which the server received the largest packet number, and on
+  // which it sends packets without retransmittable data, such as ACKs, so that
+  // they reach the peer even if it stopped using the default path.
+  QuicPathId ack_path_id_ = kDefaultPathId;
+
   // If true, upon seeing a new client address, validate the client address.
   bool validate_client_addresses_ = false;
 
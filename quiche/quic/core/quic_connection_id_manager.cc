@@ -10,6 +10,7 @@
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_error_codes.h"
 #include "quiche/quic/core/quic_utils.h"
+#include "quiche/quic/platform/api/quic_flag_utils.h"
 #include "quiche/common/platform/api/quiche_logging.h"
 
 namespace quic {
@@ -284,6 +285,7 @@ QuicSelfIssuedConnectionIdManager::QuicSelfIssuedConnectionIdManager(
       retire_connection_id_alarm_(alarm_factory->CreateAlarm(
           new RetireSelfIssuedConnectionIdAlarmDelegate(this, context))),
       last_connection_id_(initial_connection_id),
+      connection_id_length_(initial_connection_id.length()),
       next_connection_id_sequence_number_(1u),
       last_connection_id_consumed_by_self_sequence_number_(0u) {
   active_connection_ids_.emplace_back(initial_connection_id, 0u);
@@ -295,6 +297,18 @@ QuicSelfIssuedConnectionIdManager::~QuicSelfIssuedConnectionIdManager() {
 
 QuicConnectionId QuicSelfIssuedConnectionIdManager::GenerateNewConnectionId(
     const QuicConnectionId& old_connection_id) const {
+  if (connection_id_generator_ != nullptr) {
+    absl::optional<QuicConnectionId> new_connection_id =
+        connection_id_generator_->GenerateNextConnectionId(old_connection_id);
+    if (new_connection_id.has_value()) {
+      // The dispatcher could not parse packets sent to a connection ID of
+      // another length, e.g. one generated after a QUIC-LB config change.
+      if (new_connection_id->length() == connection_id_length_) {
+        return *new_connection_id;
+      }
+      QUIC_CODE_COUNT(quic_generated_connection_id_length_mismatch);
+    }
+  }
   return QuicUtils::CreateReplacementConnectionId(old_connection_id);
 }
 
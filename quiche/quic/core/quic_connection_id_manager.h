@@ -14,6 +14,7 @@
 #include <memory>
 
 #include "absl/types/optional.h"
+#include "quiche/quic/core/connection_id_generator.h"
 #include "quiche/quic/core/frames/quic_new_connection_id_frame.h"
 #include "quiche/quic/core/frames/quic_retire_connection_id_frame.h"
 #include "quiche/quic/core/quic_alarm.h"
@@ -161,6 +162,14 @@ class QUIC_EXPORT_PRIVATE QuicSelfIssuedConnectionIdManager {
   virtual QuicConnectionId GenerateNewConnectionId(
       const QuicConnectionId& old_connection_id) const;
 
+  // If set, new connection IDs are generated by |generator| rather than
+  // derived from the previous one, unless |generator| fails or returns a
+  // connection ID whose length differs from that of the initial one.
+  // |generator| must outlive this object.
+  void set_connection_id_generator(ConnectionIdGeneratorInterface* generator) {
+    connection_id_generator_ = generator;
+  }
+
  private:
   friend class test::QuicConnectionIdManagerPeer;
 
@@ -184,9 +193,13 @@ class QUIC_EXPORT_PRIVATE QuicSelfIssuedConnectionIdManager {
   std::unique_ptr<QuicAlarm> retire_connection_id_alarm_;
   // State of the last issued connection Id.
   QuicConnectionId last_connection_id_;
+  // Length of the initial connection ID, which the peer's packets are parsed
+  // with.
+  const uint8_t connection_id_length_;
   uint64_t next_connection_id_sequence_number_;
   // The sequence number of last connection ID consumed.
   uint64_t last_connection_id_consumed_by_self_sequence_number_;
+  ConnectionIdGeneratorInterface* connection_id_generator_ = nullptr;
 };
 
 }  // namespace quic
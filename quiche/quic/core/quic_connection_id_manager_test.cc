@@ -8,8 +8,10 @@
 
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_error_codes.h"
+#include "quiche/quic/core/quic_utils.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/mock_clock.h"
+#include "quiche/quic/test_tools/mock_connection_id_generator.h"
 #include "quiche/quic/test_tools/quic_connection_id_manager_peer.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
 
@@ -18,6 +20,7 @@ namespace {
 
 using ::quic::test::IsError;
 using ::quic::test::IsQuicNoError;
+using ::quic::test::MockConnectionIdGenerator;
 using ::quic::test::QuicConnectionIdManagerPeer;
 using ::quic::test::TestConnectionId;
 using ::testing::_;
@@ -952,5 +955,41 @@ TEST_F(QuicSelfIssuedConnectionIdManagerTest,
   cid_manager_.MaybeSendNewConnectionIds();
 }
 
+TEST_F(QuicSelfIssuedConnectionIdManagerTest, ConnectionIdGenerator) {
+  MockConnectionIdGenerator generator;
+  cid_manager_.set_connection_id_generator(&generator);
+  const QuicConnectionId cid1 = TestConnectionId(0x1234);
+  EXPECT_CALL(generator, GenerateNextConnectionId(initial_connection_id_))
+      .WillOnce(Return(cid1));
+  EXPECT_CALL(cid_manager_visitor_, OnNewConnectionIdIssued(cid1));
+  EXPECT_CALL(cid_manager_visitor_,
+              SendNewConnectionId(ExpectedNewConnectionIdFrame(cid1, 1u, 0u)))
+      .WillOnce(Return(true));
+  cid_manager_.MaybeSendNewConnectionIds();
+
+  // Falls back to deriving the connection ID from the previous one.
+  EXPECT_CALL(generator, GenerateNextConnectionId(cid1))
+      .WillOnce(Return(absl::nullopt));
+  EXPECT_EQ(cid_manager_.GenerateNewConnectionId(cid1),
+            QuicUtils::CreateReplacementConnectionId(cid1));
+}
+
+TEST_F(QuicSelfIssuedConnectionIdManagerTest,
+       ConnectionIdGeneratorWrongLength) {
+  MockConnectionIdGenerator generator;
+  cid_manager_.set_connection_id_generator(&generator);
+  ASSERT_EQ(initial_connection_id_.length(), kQuicDefaultConnectionIdLength);
+  const QuicConnectionId long_cid({1, 2, 3, 4, 5, 6, 7, 8, 9});
+  EXPECT_CALL(generator, GenerateNextConnectionId(initial_connection_id_))
+      .WillOnce(Return(long_cid));
+  const QuicConnectionId cid1 =
+      QuicUtils::CreateReplacementConnectionId(initial_connection_id_);
+  EXPECT_CALL(cid_manager_visitor_, OnNewConnectionIdIssued(cid1));
+  EXPECT_CALL(cid_manager_visitor_,
+              SendNewConnectionId(ExpectedNewConnectionIdFrame(cid1, 1u, 0u)))
+      .WillOnce(Return(true));
+  cid_manager_.MaybeSendNewConnectionIds();
+}
+
 }  // namespace
 }  // namespace quic::test
@@ -54,9 +54,16 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " num_coalesced_packets_processed: "
      << s.num_coalesced_packets_processed;
   os << " num_ack_aggregation_epochs: " << s.num_ack_aggregation_epochs;
+  os << " num_ack_frequency_frames_sent: " << s.num_ack_frequency_frames_sent;
   os << " sent_legacy_version_encapsulated_packets: "
      << s.sent_legacy_version_encapsulated_packets;
   os << " key_update_count: " << s.key_update_count;
+  os << " local_key_update_count: " << s.local_key_update_count;
+  os << " pre_derived_key_update_count: " << s.pre_derived_key_update_count;
+  os << " num_key_update_trial_decryptions: "
+     << s.num_key_update_trial_decryptions;
+  os << " num_failed_key_update_trial_decryptions: "
+     << s.num_failed_key_update_trial_decryptions;
   os << " num_failed_authentication_packets_received: "
      << s.num_failed_authentication_packets_received;
   os << " num_tls_server_zero_rtt_packets_received_after_discarding_decrypter: "
@@ -64,6 +71,17 @@ std::ostream& operator<<(std::ostream& os, const QuicConnectionStats& s) {
   os << " address_validated_via_decrypting_packet: "
      << s.address_validated_via_decrypting_packet;
   os << " address_validated_via_token: " << s.address_validated_via_token;
+  if (s.num_packets_sent_on_additional_paths > 0) {
+    os << " num_packets_sent_on_additional_paths: "
+       << s.num_packets_sent_on_additional_paths;
+    os << " num_duplicate_packets_sent_on_multipath: "
+       << s.num_duplicate_packets_sent_on_multipath;
+    os << " bytes_sent_in_multipath_duplicates: "
+       << s.bytes_sent_in_multipath_duplicates;
+  }
+  if (s.cpu_profile.sampled_operations > 0) {
+    os << " cpu_profile: " << s.cpu_profile;
+  }
   os << " }";
 
   return os;
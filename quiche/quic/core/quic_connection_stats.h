@@ -9,6 +9,7 @@
 #include <ostream>
 
 #include "quiche/quic/core/quic_bandwidth.h"
+#include "quiche/quic/core/quic_cpu_profiler.h"
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/core/quic_time.h"
 #include "quiche/quic/core/quic_time_accumulator.h"
@@ -153,6 +154,8 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   // Number of ack aggregation epochs. For the same number of bytes acked, the
   // smaller this value, the more ack aggregation is going on.
   uint64_t num_ack_aggregation_epochs = 0;
+  // Number of distinct ACK_FREQUENCY frames sent, excluding retransmissions.
+  uint64_t num_ack_frequency_frames_sent = 0;
 
   // Whether overshooting is detected (and pacing rate decreases) during start
   // up with network parameters adjusted.
@@ -180,6 +183,20 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   // the peer has acknowledged the key update.
   uint32_t key_update_count = 0;
 
+  // Number of key phase updates initiated by this endpoint, included in
+  // key_update_count.
+  uint32_t local_key_update_count = 0;
+
+  // Number of key phase updates which switched to keys derived ahead of time,
+  // rather than when the update happened.
+  uint32_t pre_derived_key_update_count = 0;
+
+  // Number of 1-RTT packets received with the next key phase which were
+  // decrypted with the keys of the next key phase, i.e. which might have
+  // initiated a key update, and how many of them failed to decrypt.
+  QuicPacketCount num_key_update_trial_decryptions = 0;
+  QuicPacketCount num_failed_key_update_trial_decryptions = 0;
+
   // Counts the number of undecryptable packets received across all keys. Does
   // not include packets where a decryption key for that level was absent.
   QuicPacketCount num_failed_authentication_packets_received = 0;
@@ -218,6 +235,12 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   size_t num_new_connection_id_sent = 0;
   // Number of RETIRE_CONNECTION_ID frames sent.
   size_t num_retire_connection_id_sent = 0;
+  // Number of packets sent on multipath paths other than the default path.
+  QuicPacketCount num_packets_sent_on_additional_paths = 0;
+  // Number of copies of packets sent by the redundant multipath scheduler,
+  // and their bytes, which are not included in |bytes_sent|.
+  QuicPacketCount num_duplicate_packets_sent_on_multipath = 0;
+  QuicByteCount bytes_sent_in_multipath_duplicates = 0;
 
   struct QUIC_NO_EXPORT TlsServerOperationStats {
     bool success = false;
@@ -233,6 +256,10 @@ struct QUIC_EXPORT_PRIVATE QuicConnectionStats {
   absl::optional<TlsServerOperationStats> tls_server_select_cert_stats;
   absl::optional<TlsServerOperationStats> tls_server_compute_signature_stats;
   absl::optional<TlsServerOperationStats> tls_server_decrypt_ticket_stats;
+
+  // CPU time spent on the hot path, only collected if CPU profiling is enabled
+  // on the connection.
+  QuicCpuProfile cpu_profile;
 };
 
 }  // namespace quic
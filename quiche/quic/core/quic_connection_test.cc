@@ -3417,6 +3417,45 @@ TEST_P(QuicConnectionTest, AckUnsentData) {
   TestConnectionCloseQuicErrorCode(QUIC_INVALID_ACK_DATA);
 }
 
+TEST_P(QuicConnectionTest, CpuProfiling) {
+  connection_.EnableCpuProfiling(1);
+  const QuicCpuProfile& profile = connection_.GetStats().cpu_profile;
+  auto sampled_calls = [&profile](QuicCpuProfileCategory category) {
+    return profile.sampled_calls[static_cast<size_t>(category)];
+  };
+
+  EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
+  EXPECT_CALL(visitor_, OnStreamFrame(_));
+  peer_framer_.SetEncrypter(ENCRYPTION_FORWARD_SECURE,
+                            std::make_unique<TaggingEncrypter>(0x01));
+  SetDecrypter(ENCRYPTION_FORWARD_SECURE,
+               std::make_unique<StrictTaggingDecrypter>(0x01));
+  ProcessDataPacket(1);
+  EXPECT_EQ(1u, sampled_calls(QuicCpuProfileCategory::kReceive));
+  EXPECT_EQ(1u, sampled_calls(QuicCpuProfileCategory::kFrameParse));
+  EXPECT_LE(1u, sampled_calls(QuicCpuProfileCategory::kDecrypt));
+  EXPECT_EQ(1u, sampled_calls(QuicCpuProfileCategory::kStreamDelivery));
+  EXPECT_EQ(0u, sampled_calls(QuicCpuProfileCategory::kAckProcessing));
+
+  const uint64_t packets_created =
+      sampled_calls(QuicCpuProfileCategory::kPacketCreation);
+  QuicPacketNumber last_packet;
+  SendStreamDataToPeer(1, "foo", 0, NO_FIN, &last_packet);
+  EXPECT_LT(packets_created,
+            sampled_calls(QuicCpuProfileCategory::kPacketCreation));
+  EXPECT_LE(1u, sampled_calls(QuicCpuProfileCategory::kEncrypt));
+  EXPECT_LE(1u, sampled_calls(QuicCpuProfileCategory::kWrite));
+
+  EXPECT_CALL(*send_algorithm_, OnCongestionEvent(true, _, _, _, _));
+  if (connection_.SupportsMultiplePacketNumberSpaces()) {
+    EXPECT_CALL(visitor_, OnOneRttPacketAcknowledged());
+  }
+  QuicAckFrame frame = InitAckFrame(last_packet);
+  ProcessAckPacket(2, &frame);
+  EXPECT_EQ(1u, sampled_calls(QuicCpuProfileCategory::kAckProcessing));
+  EXPECT_EQ(profile.operations, profile.sampled_operations);
+}
+
 TEST_P(QuicConnectionTest, BasicSending) {
   if (connection_.SupportsMultiplePacketNumberSpaces()) {
     return;
@@ -12472,6 +12511,64 @@ TEST_P(QuicConnectionTest, InitiateKeyUpdate) {
   EXPECT_FALSE(connection_.HaveSentPacketsInCurrentKeyPhaseButNoneAcked());
 }
 
+TEST_P(QuicConnectionTest, InitiateKeyUpdateWithPreDerivedKeys) {
+  if (!connection_.version().UsesTls()) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_pre_derive_next_one_rtt_keys, true);
+
+  TransportParameters params;
+  QuicConfig config;
+  std::string error_details;
+  EXPECT_THAT(config.ProcessTransportParameters(
+                  params, /* is_resumption = */ false, &error_details),
+              IsQuicNoError());
+  QuicConfigPeer::SetNegotiated(&config, true);
+  QuicConfigPeer::SetReceivedOriginalConnectionId(&config,
+                                                  connection_.connection_id());
+  QuicConfigPeer::SetReceivedInitialSourceConnectionId(
+      &config, connection_.connection_id());
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  connection_.SetFromConfig(config);
+
+  use_tagging_decrypter();
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+  connection_.SetEncrypter(ENCRYPTION_FORWARD_SECURE,
+                           std::make_unique<TaggingEncrypter>(0x01));
+  SetDecrypter(ENCRYPTION_FORWARD_SECURE,
+               std::make_unique<StrictTaggingDecrypter>(0x01));
+  EXPECT_CALL(visitor_, GetHandshakeState())
+      .WillRepeatedly(Return(HANDSHAKE_CONFIRMED));
+  connection_.OnHandshakeComplete();
+  peer_framer_.SetEncrypter(ENCRYPTION_FORWARD_SECURE,
+                            std::make_unique<TaggingEncrypter>(0x01));
+
+  QuicPacketNumber last_packet;
+  SendStreamDataToPeer(1, "foo", 0, NO_FIN, &last_packet);
+  EXPECT_CALL(*send_algorithm_, OnCongestionEvent(true, _, _, _, _));
+  QuicAckFrame frame1 = InitAckFrame(1);
+  ProcessAckPacket(&frame1);
+  EXPECT_TRUE(connection_.IsKeyUpdateAllowed());
+
+  // The next keys are derived once the previous ones are discarded.
+  ASSERT_TRUE(connection_.GetDiscardPreviousOneRttKeysAlarm()->IsSet());
+  EXPECT_CALL(visitor_, AdvanceKeysAndCreateCurrentOneRttDecrypter())
+      .WillOnce(
+          []() { return std::make_unique<StrictTaggingDecrypter>(0x02); });
+  EXPECT_CALL(visitor_, CreateCurrentOneRttEncrypter()).WillOnce([]() {
+    return std::make_unique<TaggingEncrypter>(0x02);
+  });
+  connection_.GetDiscardPreviousOneRttKeysAlarm()->Fire();
+
+  // The key update switches to them without deriving any key.
+  EXPECT_CALL(visitor_, OnKeyUpdate(KeyUpdateReason::kLocalForTests));
+  EXPECT_TRUE(connection_.InitiateKeyUpdate(KeyUpdateReason::kLocalForTests));
+  const QuicConnectionStats& stats = connection_.GetStats();
+  EXPECT_EQ(1u, stats.key_update_count);
+  EXPECT_EQ(1u, stats.local_key_update_count);
+  EXPECT_EQ(1u, stats.pre_derived_key_update_count);
+}
+
 TEST_P(QuicConnectionTest, InitiateKeyUpdateApproachingConfidentialityLimit) {
   if (!connection_.version().UsesTls()) {
     return;
@@ -13064,6 +13161,168 @@ TEST_P(QuicConnectionTest, MigrateToNewPathDuringProbing) {
       &connection_, kNewSelfAddress, connection_.peer_address()));
 }
 
+TEST_P(QuicConnectionTest, SendOnMultipathPath) {
+  if (!VersionHasIetfQuicFrames(connection_.version().transport_version)) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_enable_multipath_experiment, true);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  QuicConfig config;
+  config.SetClientConnectionOptions(QuicTagVector{kMPRR});
+  connection_.SetFromConfig(config);
+  EXPECT_CALL(visitor_, GetHandshakeState())
+      .WillRepeatedly(Return(HANDSHAKE_CONFIRMED));
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+
+  const QuicSocketAddress kNewSelfAddress(QuicIpAddress::Any4(), 12345);
+  TestPacketWriter new_writer(version(), &clock_, Perspective::IS_CLIENT);
+  const QuicPathId path_id =
+      connection_.AddMultipathPath(kNewSelfAddress, connection_.peer_address(),
+                                   &new_writer, /*owns_writer=*/false);
+  ASSERT_NE(kInvalidPathId, path_id);
+  EXPECT_EQ(1u, connection_.GetNumAdditionalMultipathPaths());
+  // The same path cannot be added twice. The rejected call does not take
+  // ownership of the writer, which would delete |new_writer| here.
+  EXPECT_QUIC_BUG(
+      EXPECT_EQ(kInvalidPathId, connection_.AddMultipathPath(
+                                    kNewSelfAddress, connection_.peer_address(),
+                                    &new_writer, /*owns_writer=*/true)),
+      "is already in use");
+
+  // The round robin scheduler alternates between the two paths.
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _))
+      .Times(AnyNumber());
+  connection_.SendStreamDataWithString(3, "foo", 0, NO_FIN);
+  connection_.SendStreamDataWithString(3, "bar", 3, NO_FIN);
+  EXPECT_EQ(1u, writer_->packets_write_attempts());
+  EXPECT_EQ(1u, new_writer.packets_write_attempts());
+  EXPECT_EQ(kNewSelfAddress.host(), new_writer.last_write_source_address());
+  EXPECT_EQ(1u, connection_.GetStats().num_packets_sent_on_additional_paths);
+
+  // A write error on the additional path removes it instead of closing the
+  // connection.
+  new_writer.SetShouldWriteFail();
+  connection_.SendStreamDataWithString(3, "baz", 6, NO_FIN);
+  connection_.SendStreamDataWithString(3, "qux", 9, NO_FIN);
+  EXPECT_EQ(2u, writer_->packets_write_attempts());
+  EXPECT_EQ(2u, new_writer.packets_write_attempts());
+  EXPECT_TRUE(connection_.connected());
+  EXPECT_EQ(0u, connection_.GetNumAdditionalMultipathPaths());
+  EXPECT_FALSE(connection_.sent_packet_manager().IsPathActive(path_id));
+
+  connection_.SendStreamDataWithString(3, "quux", 12, NO_FIN);
+  EXPECT_EQ(3u, writer_->packets_write_attempts());
+  EXPECT_EQ(2u, new_writer.packets_write_attempts());
+}
+
+TEST_P(QuicConnectionTest, RedundantMultipathCopies) {
+  if (!VersionHasIetfQuicFrames(connection_.version().transport_version)) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_enable_multipath_experiment, true);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  QuicConfig config;
+  config.SetClientConnectionOptions(QuicTagVector{kMPRD});
+  connection_.SetFromConfig(config);
+  EXPECT_CALL(visitor_, GetHandshakeState())
+      .WillRepeatedly(Return(HANDSHAKE_CONFIRMED));
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+  const QuicSocketAddress kNewSelfAddress(QuicIpAddress::Any4(), 12345);
+  TestPacketWriter new_writer(version(), &clock_, Perspective::IS_CLIENT);
+  ASSERT_NE(kInvalidPathId,
+            connection_.AddMultipathPath(kNewSelfAddress,
+                                         connection_.peer_address(),
+                                         &new_writer, /*owns_writer=*/false));
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _))
+      .Times(AnyNumber());
+
+  // Each packet is copied on the other path, which is not counted in the bytes
+  // sent.
+  const QuicByteCount bytes_sent = connection_.GetStats().bytes_sent;
+  connection_.SendStreamDataWithString(3, "foo", 0, NO_FIN);
+  EXPECT_EQ(2u, writer_->packets_write_attempts() +
+                    new_writer.packets_write_attempts());
+  EXPECT_EQ(1u, connection_.GetStats().num_duplicate_packets_sent_on_multipath);
+  EXPECT_EQ(connection_.GetStats().bytes_sent - bytes_sent,
+            connection_.GetStats().bytes_sent_in_multipath_duplicates);
+
+  // Copies are not sent on a path whose congestion window is full.
+  EXPECT_CALL(*send_algorithm_, CanSend(_)).WillRepeatedly(Return(false));
+  const size_t packets_written = writer_->packets_write_attempts();
+  const size_t new_path_packets_written = new_writer.packets_write_attempts();
+  connection_.SendStreamDataWithString(3, "bar", 3, NO_FIN);
+  EXPECT_EQ(packets_written, writer_->packets_write_attempts());
+  EXPECT_EQ(new_path_packets_written + 1,
+            new_writer.packets_write_attempts());
+  EXPECT_EQ(1u, connection_.GetStats().num_duplicate_packets_sent_on_multipath);
+}
+
+// Makes sure a server with multipath enabled acknowledges packets on the path
+// they arrive on, and migrates its default path upon a NAT rebinding rather
+// than adding another path.
+TEST_P(QuicConnectionTest, MultipathServerNatRebinding) {
+  if (!VersionHasIetfQuicFrames(connection_.version().transport_version)) {
+    return;
+  }
+  SetQuicReloadableFlag(quic_enable_multipath_experiment, true);
+  set_perspective(Perspective::IS_SERVER);
+  QuicPacketCreatorPeer::SetSendVersionInPacket(creator_, false);
+  connection_.SetDefaultEncryptionLevel(ENCRYPTION_FORWARD_SECURE);
+  EXPECT_CALL(visitor_, GetHandshakeState())
+      .WillRepeatedly(Return(HANDSHAKE_CONFIRMED));
+  QuicConnectionPeer::SetAddressValidated(&connection_);
+  QuicConfig config;
+  config.SetInitialReceivedConnectionOptions(QuicTagVector{kMPRR});
+  QuicConfigPeer::SetNegotiated(&config, true);
+  QuicConfigPeer::SetReceivedOriginalConnectionId(&config,
+                                                  connection_.connection_id());
+  QuicConfigPeer::SetReceivedInitialSourceConnectionId(&config,
+                                                       QuicConnectionId());
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  connection_.SetFromConfig(config);
+  ASSERT_TRUE(connection_.sent_packet_manager().multipath_enabled());
+  EXPECT_CALL(visitor_, OnStreamFrame(_)).Times(AnyNumber());
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _))
+      .Times(AnyNumber());
+  auto send_ack = [this]() {
+    QuicConnection::ScopedPacketFlusher flusher(&connection_);
+    connection_.SendAck();
+  };
+
+  QuicFrames frames;
+  frames.push_back(QuicFrame(frame1_));
+  ProcessFramesPacketWithAddresses(frames, kSelfAddress, kPeerAddress,
+                                   ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(kPeerAddress, connection_.peer_address());
+
+  // A packet from another network of the client adds a path, on which the
+  // server acknowledges it.
+  const QuicSocketAddress kCellularPeerAddress(QuicIpAddress::Loopback4(),
+                                               /*port=*/23456);
+  EXPECT_CALL(visitor_, OnConnectionMigration(_)).Times(0);
+  ProcessFramesPacketWithAddresses(frames, kSelfAddress, kCellularPeerAddress,
+                                   ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(kPeerAddress, connection_.peer_address());
+  EXPECT_EQ(1u, connection_.GetNumAdditionalMultipathPaths());
+  send_ack();
+  EXPECT_EQ(kCellularPeerAddress, writer_->last_write_peer_address());
+  ProcessFramesPacketWithAddresses(frames, kSelfAddress, kPeerAddress,
+                                   ENCRYPTION_FORWARD_SECURE);
+  send_ack();
+  EXPECT_EQ(kPeerAddress, writer_->last_write_peer_address());
+
+  // A NAT rebinding migrates the default path, which keeps being acknowledged.
+  const QuicSocketAddress kRebindingPeerAddress(kPeerAddress.host(),
+                                                /*port=*/34567);
+  EXPECT_CALL(visitor_, OnConnectionMigration(PORT_CHANGE));
+  ProcessFramesPacketWithAddresses(frames, kSelfAddress, kRebindingPeerAddress,
+                                   ENCRYPTION_FORWARD_SECURE);
+  EXPECT_EQ(kRebindingPeerAddress, connection_.peer_address());
+  EXPECT_EQ(1u, connection_.GetNumAdditionalMultipathPaths());
+  send_ack();
+  EXPECT_EQ(kRebindingPeerAddress, writer_->last_write_peer_address());
+}
+
 TEST_P(QuicConnectionTest, SingleAckInPacket) {
   EXPECT_CALL(visitor_, OnSuccessfulVersionNegotiation(_));
   EXPECT_CALL(visitor_, OnConnectionClosed(_, _));
@@ -218,6 +218,10 @@ const uint64_t kUFloat16MaxValue =  // 0x3FFC0000000
 // duplicated.
 const size_t kDiversificationNonceSize = 32;
 
+// Length, in bytes, of the ciphertext sample from which the header protection
+// mask of an IETF QUIC packet is computed.
+const size_t kHeaderProtectionSampleLength = 16;
+
 // The largest gap in packets we'll accept without closing the connection.
 // This will likely have to be tuned.
 const QuicPacketCount kMaxPacketGap = 5000;
@@ -268,6 +272,9 @@ const size_t kMaxNewTokenTokenLength = 0xffff;
 // The prefix used by a source address token in a NEW_TOKEN frame.
 const uint8_t kAddressTokenPrefix = 0;
 
+// The prefix used by a token in a RETRY packet.
+const uint8_t kRetryTokenPrefix = 1;
+
 // Default initial rtt used before any samples are received.
 const int kInitialRttMs = 100;
 
@@ -291,6 +298,12 @@ const QuicPacketCount kMaxRetransmittablePacketsBeforeAck = 10;
 const QuicPacketCount kMinReceivedBeforeAckDecimation = 100;
 // One quarter RTT delay when doing ack decimation.
 const float kAckDecimationDelay = 0.25;
+// Number of ACKs per bandwidth-delay product requested when the ACK frequency
+// is adapted to the bandwidth-delay product.
+const QuicPacketCount kAdaptiveAckFrequencyAcksPerBdp = 4;
+// Maximum packet tolerance requested when the ACK frequency is adapted to the
+// bandwidth-delay product.
+const QuicPacketCount kMaxAdaptiveAckFrequencyPacketTolerance = 64;
 
 // The default alarm granularity assumed by QUIC code.
 const QuicTime::Delta kAlarmGranularity = QuicTime::Delta::FromMilliseconds(1);
@@ -298,6 +311,12 @@ const QuicTime::Delta kAlarmGranularity = QuicTime::Delta::FromMilliseconds(1);
 // Maximum number of unretired connection IDs a connection can have.
 const size_t kMaxNumConnectonIdsInUse = 10u;
 
+// The path a connection sends on when multipath is not in use.
+const QuicPathId kDefaultPathId = 0;
+const QuicPathId kInvalidPathId = 0xff;
+// Maximum number of paths a multipath connection sends on concurrently.
+const size_t kMaxNumMultipathPaths = 4u;
+
 // Packet number of first sending packet of a connection. Please note, this
 // cannot be used as first received packet because peer can choose its starting
 // packet number.
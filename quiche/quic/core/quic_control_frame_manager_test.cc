@@ -236,6 +236,26 @@ TEST_F(QuicControlFrameManagerTest, SendAndAckAckFrequencyFrame) {
       manager_->OnControlFrameAcked(QuicFrame(&expected_ack_frequency)));
 }
 
+TEST_F(QuicControlFrameManagerTest, AckFrequencyFrameKeepsIgnoreOrder) {
+  Initialize();
+  EXPECT_CALL(*session_, WriteControlFrame(_, _))
+      .Times(5)
+      .WillRepeatedly(Invoke(&ClearControlFrameWithTransmissionType));
+  manager_->OnCanWrite();
+
+  QuicAckFrequencyFrame frame_to_send;
+  frame_to_send.packet_tolerance = 10;
+  frame_to_send.max_ack_delay = QuicTime::Delta::FromMilliseconds(24);
+  frame_to_send.ignore_order = true;
+  EXPECT_CALL(*session_, WriteControlFrame(_, _))
+      .WillOnce([](const QuicFrame& frame, TransmissionType type) {
+        EXPECT_EQ(ACK_FREQUENCY_FRAME, frame.type);
+        EXPECT_TRUE(frame.ack_frequency_frame->ignore_order);
+        return ClearControlFrameWithTransmissionType(frame, type);
+      });
+  manager_->WriteOrBufferAckFrequency(frame_to_send);
+}
+
 TEST_F(QuicControlFrameManagerTest, NewAndRetireConnectionIdFrames) {
   Initialize();
   InSequence s;
@@ -0,0 +1,151 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_cpu_profiler.h"
+
+#include <chrono>
+
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+int64_t SteadyClockNowNanos() {
+  return std::chrono::duration_cast<std::chrono::nanoseconds>(
+             std::chrono::steady_clock::now().time_since_epoch())
+      .count();
+}
+
+size_t CategoryIndex(QuicCpuProfileCategory category) {
+  return static_cast<size_t>(category);
+}
+
+}  // namespace
+
+const char* QuicCpuProfileCategoryToString(QuicCpuProfileCategory category) {
+  switch (category) {
+    case QuicCpuProfileCategory::kReceive:
+      return "receive";
+    case QuicCpuProfileCategory::kDecrypt:
+      return "decrypt";
+    case QuicCpuProfileCategory::kFrameParse:
+      return "frame_parse";
+    case QuicCpuProfileCategory::kAckProcessing:
+      return "ack_processing";
+    case QuicCpuProfileCategory::kStreamDelivery:
+      return "stream_delivery";
+    case QuicCpuProfileCategory::kPacketCreation:
+      return "packet_creation";
+    case QuicCpuProfileCategory::kEncrypt:
+      return "encrypt";
+    case QuicCpuProfileCategory::kWrite:
+      return "write";
+    case QuicCpuProfileCategory::kNumCategories:
+      break;
+  }
+  return "INVALID_CATEGORY";
+}
+
+int64_t QuicCpuProfile::EstimatedNanos(QuicCpuProfileCategory category) const {
+  if (sampled_operations == 0) {
+    return 0;
+  }
+  return static_cast<int64_t>(
+      static_cast<double>(sampled_nanos[CategoryIndex(category)]) *
+      operations / sampled_operations);
+}
+
+QuicCpuProfile& QuicCpuProfile::operator+=(const QuicCpuProfile& other) {
+  operations += other.operations;
+  sampled_operations += other.sampled_operations;
+  for (size_t i = 0; i < kNumCategories; ++i) {
+    sampled_nanos[i] += other.sampled_nanos[i];
+    sampled_calls[i] += other.sampled_calls[i];
+  }
+  return *this;
+}
+
+std::ostream& operator<<(std::ostream& os, const QuicCpuProfile& profile) {
+  os << "{ operations: " << profile.operations
+     << " sampled_operations: " << profile.sampled_operations;
+  for (size_t i = 0; i < QuicCpuProfile::kNumCategories; ++i) {
+    const auto category = static_cast<QuicCpuProfileCategory>(i);
+    os << " " << QuicCpuProfileCategoryToString(category)
+       << "_ns: " << profile.EstimatedNanos(category);
+  }
+  os << " }";
+  return os;
+}
+
+QuicCpuProfiler::ScopedTimer::ScopedTimer(QuicCpuProfiler* profiler,
+                                          QuicCpuProfileCategory category)
+    : profiler_(profiler),
+      parent_category_(profiler == nullptr ? category
+                                           : profiler->Enter(category)) {}
+
+QuicCpuProfiler::ScopedTimer::~ScopedTimer() {
+  if (profiler_ != nullptr) {
+    profiler_->Exit(parent_category_);
+  }
+}
+
+QuicCpuProfiler::QuicCpuProfiler(QuicCpuProfile* profile,
+                                 uint64_t sample_interval)
+    : profile_(profile),
+      sample_interval_(sample_interval),
+      operations_until_sample_(sample_interval - 1),
+      depth_(0),
+      sampling_(false),
+      current_category_(QuicCpuProfileCategory::kNumCategories),
+      last_nanos_(0),
+      now_nanos_(&SteadyClockNowNanos) {
+  QUICHE_DCHECK_LT(0u, sample_interval_);
+}
+
+QuicCpuProfileCategory QuicCpuProfiler::Enter(
+    QuicCpuProfileCategory category) {
+  if (depth_ == 0) {
+    ++profile_->operations;
+    if (operations_until_sample_ == 0) {
+      sampling_ = true;
+      ++profile_->sampled_operations;
+      operations_until_sample_ = sample_interval_ - 1;
+    } else {
+      --operations_until_sample_;
+    }
+  }
+  if (sampling_) {
+    if (depth_ > 0) {
+      ChargeCurrentCategory();
+    } else {
+      last_nanos_ = now_nanos_();
+    }
+    ++profile_->sampled_calls[CategoryIndex(category)];
+  }
+  const QuicCpuProfileCategory parent_category = current_category_;
+  current_category_ = category;
+  ++depth_;
+  return parent_category;
+}
+
+void QuicCpuProfiler::Exit(QuicCpuProfileCategory parent_category) {
+  QUICHE_DCHECK_LT(0, depth_);
+  if (sampling_) {
+    ChargeCurrentCategory();
+  }
+  current_category_ = parent_category;
+  if (--depth_ == 0) {
+    sampling_ = false;
+  }
+}
+
+void QuicCpuProfiler::ChargeCurrentCategory() {
+  const int64_t now = now_nanos_();
+  profile_->sampled_nanos[CategoryIndex(current_category_)] +=
+      now - last_nanos_;
+  last_nanos_ = now;
+}
+
+}  // namespace quic
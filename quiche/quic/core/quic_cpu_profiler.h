@@ -0,0 +1,129 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_CPU_PROFILER_H_
+#define QUICHE_QUIC_CORE_QUIC_CPU_PROFILER_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <ostream>
+
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Hot-path operations of a QuicConnection whose CPU time can be profiled.
+enum class QuicCpuProfileCategory : uint8_t {
+  // Connection-level handling of a received UDP packet that is not part of
+  // another category, e.g. address and path bookkeeping.
+  kReceive,
+  // Header protection removal and payload decryption.
+  kDecrypt,
+  // Parsing of packet headers and frames.
+  kFrameParse,
+  // Processing of ACK frames by the sent packet manager, including
+  // congestion control.
+  kAckProcessing,
+  // Delivery of STREAM frames to the session and streams.
+  kStreamDelivery,
+  // Serialization of frames into packets.
+  kPacketCreation,
+  // Payload encryption and header protection.
+  kEncrypt,
+  // Calls into the QuicPacketWriter.
+  kWrite,
+  kNumCategories,
+};
+
+QUIC_EXPORT_PRIVATE const char* QuicCpuProfileCategoryToString(
+    QuicCpuProfileCategory category);
+
+// CPU time spent by a connection, or by the connections of a dispatcher, in
+// each QuicCpuProfileCategory.  Only one in every N top-level operations is
+// timed, see QuicCpuProfiler.
+struct QUIC_EXPORT_PRIVATE QuicCpuProfile {
+  static constexpr size_t kNumCategories =
+      static_cast<size_t>(QuicCpuProfileCategory::kNumCategories);
+
+  // Estimated total time spent in |category|, extrapolated from the timed
+  // operations.
+  int64_t EstimatedNanos(QuicCpuProfileCategory category) const;
+
+  QuicCpuProfile& operator+=(const QuicCpuProfile& other);
+
+  QUIC_EXPORT_PRIVATE friend std::ostream& operator<<(
+      std::ostream& os, const QuicCpuProfile& profile);
+
+  // Number of top-level operations, e.g. received packets or flushes, and how
+  // many of them were timed.
+  uint64_t operations = 0;
+  uint64_t sampled_operations = 0;
+  // Time spent in each category during the timed operations, in nanoseconds.
+  // Time spent in nested categories is excluded, e.g. the decryption of a
+  // packet is not counted as frame parsing.
+  std::array<int64_t, kNumCategories> sampled_nanos{};
+  // Number of times each category was entered during the timed operations.
+  std::array<uint64_t, kNumCategories> sampled_calls{};
+};
+
+// QuicCpuProfiler attributes the CPU time of a connection's hot path to
+// QuicCpuProfileCategory's.  Code is instrumented with ScopedTimer's, which
+// may nest; the outermost one is a top-level operation.  Reading the clock
+// twice per ScopedTimer costs about as much as decrypting a small packet, so
+// only one in every |sample_interval| top-level operations is timed, and the
+// ScopedTimer's of the others only count calls.
+class QUIC_EXPORT_PRIVATE QuicCpuProfiler {
+ public:
+  // Returns a monotonic time in nanoseconds.
+  using NowNanosFunction = int64_t (*)();
+
+  class QUIC_EXPORT_PRIVATE ScopedTimer {
+   public:
+    // Does nothing if |profiler| is nullptr.
+    ScopedTimer(QuicCpuProfiler* profiler, QuicCpuProfileCategory category);
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+    ~ScopedTimer();
+
+   private:
+    QuicCpuProfiler* profiler_;
+    QuicCpuProfileCategory parent_category_;
+  };
+
+  // |profile| must outlive this profiler.  A |sample_interval| of 1 times
+  // every operation.
+  QuicCpuProfiler(QuicCpuProfile* profile, uint64_t sample_interval);
+  QuicCpuProfiler(const QuicCpuProfiler&) = delete;
+  QuicCpuProfiler& operator=(const QuicCpuProfiler&) = delete;
+
+  uint64_t sample_interval() const { return sample_interval_; }
+
+  void set_now_nanos_function_for_testing(NowNanosFunction now_nanos) {
+    now_nanos_ = now_nanos;
+  }
+
+ private:
+  // Returns the category of the innermost running ScopedTimer.
+  QuicCpuProfileCategory Enter(QuicCpuProfileCategory category);
+  void Exit(QuicCpuProfileCategory parent_category);
+  // Charges the time since the last clock reading to |current_category_|.
+  void ChargeCurrentCategory();
+
+  QuicCpuProfile* profile_;
+  const uint64_t sample_interval_;
+  // Number of top-level operations to skip before timing one.
+  uint64_t operations_until_sample_;
+  // Number of running ScopedTimer's.
+  int depth_;
+  // Whether the current top-level operation is timed.
+  bool sampling_;
+  QuicCpuProfileCategory current_category_;
+  int64_t last_nanos_;
+  NowNanosFunction now_nanos_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_CPU_PROFILER_H_
@@ -0,0 +1,141 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_cpu_profiler.h"
+
+#include <cstdint>
+#include <memory>
+#include <sstream>
+
+#include "quiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+int64_t fake_now_nanos = 0;
+
+int64_t FakeNowNanos() { return fake_now_nanos; }
+
+int64_t SampledNanos(const QuicCpuProfile& profile,
+                     QuicCpuProfileCategory category) {
+  return profile.sampled_nanos[static_cast<size_t>(category)];
+}
+
+uint64_t SampledCalls(const QuicCpuProfile& profile,
+                      QuicCpuProfileCategory category) {
+  return profile.sampled_calls[static_cast<size_t>(category)];
+}
+
+class QuicCpuProfilerTest : public QuicTest {
+ protected:
+  QuicCpuProfilerTest() { fake_now_nanos = 1000; }
+
+  void CreateProfiler(uint64_t sample_interval) {
+    profiler_ = std::make_unique<QuicCpuProfiler>(&profile_, sample_interval);
+    profiler_->set_now_nanos_function_for_testing(&FakeNowNanos);
+  }
+
+  // Runs one top-level kReceive operation taking 100ns, 30ns of which are
+  // spent in kDecrypt and 20ns in kStreamDelivery nested in kFrameParse.
+  void ReceivePacket() {
+    QuicCpuProfiler::ScopedTimer receive(profiler_.get(),
+                                         QuicCpuProfileCategory::kReceive);
+    fake_now_nanos += 10;
+    {
+      QuicCpuProfiler::ScopedTimer parse(profiler_.get(),
+                                         QuicCpuProfileCategory::kFrameParse);
+      fake_now_nanos += 5;
+      {
+        QuicCpuProfiler::ScopedTimer decrypt(profiler_.get(),
+                                             QuicCpuProfileCategory::kDecrypt);
+        fake_now_nanos += 30;
+      }
+      fake_now_nanos += 15;
+      {
+        QuicCpuProfiler::ScopedTimer deliver(
+            profiler_.get(), QuicCpuProfileCategory::kStreamDelivery);
+        fake_now_nanos += 20;
+      }
+    }
+    fake_now_nanos += 20;
+  }
+
+  QuicCpuProfile profile_;
+  std::unique_ptr<QuicCpuProfiler> profiler_;
+};
+
+TEST_F(QuicCpuProfilerTest, NullProfiler) {
+  ReceivePacket();
+  EXPECT_EQ(0u, profile_.operations);
+}
+
+TEST_F(QuicCpuProfilerTest, NestedTimersChargeExclusiveTime) {
+  CreateProfiler(1);
+  ReceivePacket();
+
+  EXPECT_EQ(1u, profile_.operations);
+  EXPECT_EQ(1u, profile_.sampled_operations);
+  EXPECT_EQ(30, SampledNanos(profile_, QuicCpuProfileCategory::kReceive));
+  EXPECT_EQ(20, SampledNanos(profile_, QuicCpuProfileCategory::kFrameParse));
+  EXPECT_EQ(30, SampledNanos(profile_, QuicCpuProfileCategory::kDecrypt));
+  EXPECT_EQ(20,
+            SampledNanos(profile_, QuicCpuProfileCategory::kStreamDelivery));
+  EXPECT_EQ(0, SampledNanos(profile_, QuicCpuProfileCategory::kWrite));
+  EXPECT_EQ(1u, SampledCalls(profile_, QuicCpuProfileCategory::kDecrypt));
+  EXPECT_EQ(0u, SampledCalls(profile_, QuicCpuProfileCategory::kWrite));
+}
+
+TEST_F(QuicCpuProfilerTest, SamplesOneInIntervalOperations) {
+  CreateProfiler(4);
+  for (int i = 0; i < 10; ++i) {
+    ReceivePacket();
+  }
+  {
+    // A top-level operation of another category.
+    QuicCpuProfiler::ScopedTimer write(profiler_.get(),
+                                       QuicCpuProfileCategory::kWrite);
+    fake_now_nanos += 50;
+  }
+
+  EXPECT_EQ(11u, profile_.operations);
+  EXPECT_EQ(2u, profile_.sampled_operations);
+  EXPECT_EQ(60, SampledNanos(profile_, QuicCpuProfileCategory::kDecrypt));
+  EXPECT_EQ(2u, SampledCalls(profile_, QuicCpuProfileCategory::kDecrypt));
+  EXPECT_EQ(0, SampledNanos(profile_, QuicCpuProfileCategory::kWrite));
+  EXPECT_EQ(330, profile_.EstimatedNanos(QuicCpuProfileCategory::kDecrypt));
+
+  // The 12th operation is timed.
+  {
+    QuicCpuProfiler::ScopedTimer write(profiler_.get(),
+                                       QuicCpuProfileCategory::kWrite);
+    fake_now_nanos += 50;
+  }
+  EXPECT_EQ(3u, profile_.sampled_operations);
+  EXPECT_EQ(50, SampledNanos(profile_, QuicCpuProfileCategory::kWrite));
+}
+
+TEST_F(QuicCpuProfilerTest, Aggregate) {
+  CreateProfiler(1);
+  ReceivePacket();
+  QuicCpuProfile total;
+  total += profile_;
+  total += profile_;
+  EXPECT_EQ(2u, total.operations);
+  EXPECT_EQ(2u, total.sampled_operations);
+  EXPECT_EQ(60, SampledNanos(total, QuicCpuProfileCategory::kDecrypt));
+  EXPECT_EQ(60, total.EstimatedNanos(QuicCpuProfileCategory::kDecrypt));
+
+  std::ostringstream os;
+  os << total;
+  EXPECT_EQ(
+      "{ operations: 2 sampled_operations: 2 receive_ns: 60 decrypt_ns: 60 "
+      "frame_parse_ns: 40 ack_processing_ns: 0 stream_delivery_ns: 40 "
+      "packet_creation_ns: 0 encrypt_ns: 0 write_ns: 0 }",
+      os.str());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
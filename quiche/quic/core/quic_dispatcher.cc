@@ -10,12 +10,14 @@
 
 #include "absl/base/optimization.h"
 #include "absl/container/flat_hash_set.h"
+#include "absl/container/inlined_vector.h"
 #include "absl/strings/string_view.h"
 #include "quiche/quic/core/chlo_extractor.h"
 #include "quiche/quic/core/crypto/crypto_protocol.h"
 #include "quiche/quic/core/crypto/quic_random.h"
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_error_codes.h"
+#include "quiche/quic/core/quic_framer.h"
 #include "quiche/quic/core/quic_session.h"
 #include "quiche/quic/core/quic_time_wait_list_manager.h"
 #include "quiche/quic/core/quic_types.h"
@@ -355,6 +357,8 @@ QuicDispatcher::QuicDispatcher(
       should_update_expected_server_connection_id_length_(false) {
   QUIC_BUG_IF(quic_bug_12724_1, GetSupportedVersions().empty())
       << "Trying to create dispatcher without any supported versions";
+  helper_->GetRandomGenerator()->RandBytes(generator_fallback_key_,
+                                           sizeof(generator_fallback_key_));
   QUIC_DLOG(INFO) << "Created QuicDispatcher with versions: "
                   << ParsedQuicVersionVectorToString(GetSupportedVersions());
 }
@@ -440,9 +444,84 @@ void QuicDispatcher::ProcessPacket(const QuicSocketAddress& self_address,
   ProcessHeader(&packet_info);
 }
 
+void QuicDispatcher::OnPacketsRead(
+    absl::Span<const absl::string_view> packets) {
+  if (!GetQuicReloadableFlag(quic_batch_header_protection_masks)) {
+    return;
+  }
+  // Look up the session of each short header packet. Packets with long headers
+  // or of unknown connections are left to ProcessPacket().
+  absl::InlinedVector<QuicSession*, 16> sessions(packets.size(), nullptr);
+  bool has_session = false;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    absl::string_view packet = packets[i];
+    if (packet.size() <= 1u + expected_server_connection_id_length_ ||
+        (static_cast<uint8_t>(packet[0]) & FLAGS_LONG_HEADER) != 0) {
+      continue;
+    }
+    auto it = reference_counted_session_map_.find(QuicConnectionId(
+        packet.data() + 1, expected_server_connection_id_length_));
+    if (it != reference_counted_session_map_.end()) {
+      sessions[i] = it->second.get();
+      has_session = true;
+    }
+  }
+  if (!has_session) {
+    return;
+  }
+  QUIC_RELOADABLE_FLAG_COUNT(quic_batch_header_protection_masks);
+  // Hand each session its packets, in the order they are going to be
+  // processed in.
+  absl::InlinedVector<absl::string_view, 16> session_packets;
+  for (size_t i = 0; i < packets.size(); ++i) {
+    QuicSession* session = sessions[i];
+    if (session == nullptr) {
+      continue;
+    }
+    session_packets.clear();
+    for (size_t j = i; j < packets.size(); ++j) {
+      if (sessions[j] == session) {
+        session_packets.push_back(packets[j]);
+        sessions[j] = nullptr;
+      }
+    }
+    if (session_packets.size() > 1) {
+      session->connection()->PrecomputeHeaderProtectionMasks(session_packets);
+    }
+  }
+}
+
 QuicConnectionId QuicDispatcher::MaybeReplaceServerConnectionId(
     const QuicConnectionId& server_connection_id,
     const ParsedQuicVersion& version) const {
+  if (connection_id_generator_ != nullptr) {
+    absl::optional<QuicConnectionId> new_connection_id =
+        connection_id_generator_->MaybeReplaceConnectionId(server_connection_id,
+                                                           version);
+    // Verify that MaybeReplaceConnectionId is deterministic.
+    QUICHE_DCHECK(new_connection_id ==
+                  connection_id_generator_->MaybeReplaceConnectionId(
+                      server_connection_id, version));
+    if (new_connection_id.has_value()) {
+      if (new_connection_id->length() ==
+          expected_server_connection_id_length_) {
+        QUIC_DLOG(INFO) << "Replacing incoming connection ID "
+                        << server_connection_id << " with generated "
+                        << *new_connection_id;
+        return *new_connection_id;
+      }
+      QUIC_BUG(quic_dispatcher_generated_connection_id_length)
+          << "Connection ID generator returned " << *new_connection_id
+          << " of length " << static_cast<int>(new_connection_id->length())
+          << ", expected "
+          << static_cast<int>(expected_server_connection_id_length_);
+      // Like the generator's, the replacement must not be predictable from
+      // the connection ID the client chose.
+      return QuicUtils::CreateKeyedReplacementConnectionId(
+          server_connection_id, generator_fallback_key_,
+          expected_server_connection_id_length_);
+    }
+  }
   const uint8_t server_connection_id_length = server_connection_id.length();
   if (server_connection_id_length == expected_server_connection_id_length_) {
     return server_connection_id;
@@ -613,18 +692,29 @@ bool QuicDispatcher::MaybeDispatchPacket(
     // and that only happens for known verions.
     QuicConnectionId replaced_connection_id = MaybeReplaceServerConnectionId(
         server_connection_id, packet_info.version);
+    auto it2 = reference_counted_session_map_.end();
     if (replaced_connection_id != server_connection_id) {
       // Search for the replacement.
-      auto it2 = reference_counted_session_map_.find(replaced_connection_id);
-      if (it2 != reference_counted_session_map_.end()) {
-        QUICHE_DCHECK(
-            !buffered_packets_.HasBufferedPackets(replaced_connection_id));
-        it2->second->ProcessUdpPacket(packet_info.self_address,
-                                      packet_info.peer_address,
-                                      packet_info.packet);
-        return true;
+      it2 = reference_counted_session_map_.find(replaced_connection_id);
+    }
+    if (it2 == reference_counted_session_map_.end() &&
+        connection_id_generator_ != nullptr) {
+      // The generator may have changed its replacement since the connection
+      // was created.
+      absl::optional<QuicConnectionId> previous_connection_id =
+          connection_id_generator_->GetPreviousReplacementConnectionId(
+              server_connection_id, packet_info.version);
+      if (previous_connection_id.has_value()) {
+        it2 = reference_counted_session_map_.find(*previous_connection_id);
       }
     }
+    if (it2 != reference_counted_session_map_.end()) {
+      QUICHE_DCHECK(!buffered_packets_.HasBufferedPackets(it2->first));
+      it2->second->ProcessUdpPacket(packet_info.self_address,
+                                    packet_info.peer_address,
+                                    packet_info.packet);
+      return true;
+    }
   }
 
   if (buffered_packets_.HasChloForConnection(server_connection_id)) {
@@ -720,6 +810,10 @@ void QuicDispatcher::ProcessHeader(ReceivedPacketInfo* packet_info) {
 
     // Client Hello fully received.
     fate = ValidityChecksOnFullChlo(*packet_info, *parsed_chlo);
+    if (fate == kFateProcess && retry_policy_ != nullptr &&
+        packet_info->version.UsesTls()) {
+      fate = ValidateAddressOrRetry(*packet_info, &*parsed_chlo);
+    }
 
     if (fate == kFateProcess) {
       QUICHE_DCHECK(
@@ -767,6 +861,78 @@ void QuicDispatcher::ProcessHeader(ReceivedPacketInfo* packet_info) {
   }
 }
 
+QuicDispatcher::QuicPacketFate QuicDispatcher::ValidateAddressOrRetry(
+    const ReceivedPacketInfo& packet_info, ParsedClientHello* parsed_chlo) {
+  const QuicIpAddress client_address = packet_info.peer_address.host();
+  const QuicWallTime now = helper()->GetClock()->WallNow();
+  if (AddressTokenCrypter::IsRetryToken(parsed_chlo->retry_token)) {
+    absl::optional<AddressTokenCrypter::RetryToken> retry_token =
+        address_token_crypter_->ValidateRetryToken(parsed_chlo->retry_token,
+                                                   client_address, now);
+    // The client must retry to the connection ID chosen in the RETRY, which
+    // has the expected length, so that it is not replaced.
+    if (!retry_token.has_value() ||
+        retry_token->retry_source_connection_id !=
+            packet_info.destination_connection_id ||
+        packet_info.destination_connection_id.length() !=
+            expected_server_connection_id_length_) {
+      QUIC_DVLOG(1) << "Dropping CHLO with invalid retry token for "
+                    << packet_info.destination_connection_id;
+      QUIC_CODE_COUNT(quic_dispatcher_invalid_retry_token);
+      buffered_packets_.DiscardPackets(packet_info.destination_connection_id);
+      return kFateDrop;
+    }
+    parsed_chlo->retry_original_destination_connection_id =
+        retry_token->original_destination_connection_id;
+    return kFateProcess;
+  }
+  if (!parsed_chlo->retry_token.empty() &&
+      address_token_crypter_->ValidateNewToken(parsed_chlo->retry_token,
+                                               client_address, now)) {
+    return kFateProcess;
+  }
+  if (!retry_policy_->ShouldRetry(client_address,
+                                  buffered_packets_.NumChlosBuffered(),
+                                  helper()->GetClock()->ApproximateNow())) {
+    return kFateProcess;
+  }
+
+  // The connection keeps the connection ID the client retries to, so it is
+  // chosen by the generator, if any, like the replacements of the others.
+  absl::optional<QuicConnectionId> generated_connection_id;
+  if (connection_id_generator_ != nullptr) {
+    generated_connection_id =
+        connection_id_generator_->GenerateNextConnectionId(
+            packet_info.destination_connection_id);
+  }
+  const QuicConnectionId retry_source_connection_id =
+      generated_connection_id.has_value() &&
+              generated_connection_id->length() ==
+                  expected_server_connection_id_length_
+          ? *generated_connection_id
+          : QuicUtils::CreateRandomConnectionId(
+                expected_server_connection_id_length_,
+                helper()->GetRandomGenerator());
+  std::unique_ptr<QuicEncryptedPacket> retry_packet =
+      QuicFramer::BuildIetfRetryPacket(
+          packet_info.version, packet_info.source_connection_id,
+          retry_source_connection_id, packet_info.destination_connection_id,
+          address_token_crypter_->MintRetryToken(
+              client_address, packet_info.destination_connection_id,
+              retry_source_connection_id, now,
+              helper()->GetRandomGenerator()));
+  if (retry_packet == nullptr) {
+    return kFateProcess;
+  }
+  QUIC_DVLOG(1) << "Sending RETRY for " << packet_info.destination_connection_id
+                << " to " << packet_info.peer_address;
+  QUIC_CODE_COUNT(quic_dispatcher_sent_retry);
+  time_wait_list_manager_->SendPacket(packet_info.self_address,
+                                      packet_info.peer_address, *retry_packet);
+  buffered_packets_.DiscardPackets(packet_info.destination_connection_id);
+  return kFateDrop;
+}
+
 absl::optional<ParsedClientHello>
 QuicDispatcher::TryExtractChloOrBufferEarlyPacket(
     const ReceivedPacketInfo& packet_info) {
@@ -929,6 +1095,15 @@ void QuicDispatcher::StartAcceptingNewConnections() {
   accept_new_connections_ = true;
 }
 
+void QuicDispatcher::SetRetryPolicy(
+    std::unique_ptr<QuicRetryPolicy> retry_policy) {
+  retry_policy_ = std::move(retry_policy);
+  if (retry_policy_ != nullptr && address_token_crypter_ == nullptr) {
+    address_token_crypter_ =
+        std::make_unique<AddressTokenCrypter>(crypto_config_);
+  }
+}
+
 void QuicDispatcher::StopAcceptingNewConnections() {
   accept_new_connections_ = false;
   // No more CHLO will arrive and buffered CHLOs shouldn't be able to create
@@ -1051,6 +1226,7 @@ void QuicDispatcher::OnConnectionClosed(QuicConnectionId server_connection_id,
       << ", with details: " << error_details;
 
   QuicConnection* connection = it->second->connection();
+  closed_connections_cpu_profile_ += connection->GetStats().cpu_profile;
   if (ShouldDestroySessionAsynchronously()) {
     // Set up alarm to fire immediately to bring destruction of this session
     // out of current call stack.
@@ -1213,16 +1389,27 @@ void QuicDispatcher::ProcessBufferedChlos(size_t max_connections_to_create) {
     }
     const ParsedClientHello& parsed_chlo = *packet_list.parsed_chlo;
     QuicConnectionId original_connection_id = server_connection_id;
-    server_connection_id = MaybeReplaceServerConnectionId(server_connection_id,
-                                                          packet_list.version);
+    // A validated retry token means the connection ID was chosen by the RETRY.
+    if (!parsed_chlo.retry_original_destination_connection_id.has_value()) {
+      server_connection_id = MaybeReplaceServerConnectionId(
+          server_connection_id, packet_list.version);
+    }
     std::string alpn = SelectAlpn(parsed_chlo.alpns);
     std::unique_ptr<QuicSession> session = CreateQuicSession(
         server_connection_id, packets.front().self_address,
         packets.front().peer_address, alpn, packet_list.version, parsed_chlo);
+    if (connection_id_generator_ != nullptr) {
+      session->connection()->SetConnectionIdGenerator(
+          connection_id_generator_);
+    }
     if (original_connection_id != server_connection_id) {
       session->connection()->SetOriginalDestinationConnectionId(
           original_connection_id);
     }
+    if (parsed_chlo.retry_original_destination_connection_id.has_value()) {
+      session->connection()->OnRetryTokenValidated(
+          *parsed_chlo.retry_original_destination_connection_id);
+    }
     QUIC_DLOG(INFO) << "Created new session for " << server_connection_id;
 
     auto insertion_result = reference_counted_session_map_.insert(
@@ -1310,8 +1497,11 @@ void QuicDispatcher::ProcessChlo(ParsedClientHello parsed_chlo,
 
   QuicConnectionId original_connection_id =
       packet_info->destination_connection_id;
-  packet_info->destination_connection_id = MaybeReplaceServerConnectionId(
-      original_connection_id, packet_info->version);
+  // A validated retry token means the connection ID was chosen by the RETRY.
+  if (!parsed_chlo.retry_original_destination_connection_id.has_value()) {
+    packet_info->destination_connection_id = MaybeReplaceServerConnectionId(
+        original_connection_id, packet_info->version);
+  }
   // Creates a new session and process all buffered packets for this connection.
   std::string alpn = SelectAlpn(parsed_chlo.alpns);
   std::unique_ptr<QuicSession> session = CreateQuicSession(
@@ -1325,12 +1515,19 @@ void QuicDispatcher::ProcessChlo(ParsedClientHello parsed_chlo,
         << " ALPN \"" << alpn << "\" version " << packet_info->version;
     return;
   }
+  if (connection_id_generator_ != nullptr) {
+    session->connection()->SetConnectionIdGenerator(connection_id_generator_);
+  }
   const bool replaced_connection_id =
       original_connection_id != packet_info->destination_connection_id;
   if (replaced_connection_id) {
     session->connection()->SetOriginalDestinationConnectionId(
         original_connection_id);
   }
+  if (parsed_chlo.retry_original_destination_connection_id.has_value()) {
+    session->connection()->OnRetryTokenValidated(
+        *parsed_chlo.retry_original_destination_connection_id);
+  }
   QUIC_DLOG(INFO) << "Created new session for "
                   << packet_info->destination_connection_id;
 
@@ -1447,4 +1644,16 @@ size_t QuicDispatcher::NumSessions() const {
   return num_sessions_in_session_map_;
 }
 
+QuicCpuProfile QuicDispatcher::GetCpuProfile() const {
+  QuicCpuProfile profile = closed_connections_cpu_profile_;
+  // A session is in the map once per server connection ID.
+  absl::flat_hash_set<const QuicSession*> sessions;
+  for (const auto& it : reference_counted_session_map_) {
+    if (sessions.insert(it.second.get()).second) {
+      profile += it.second->connection()->GetStats().cpu_profile;
+    }
+  }
+  return profile;
+}
+
 }  // namespace quic
@@ -15,15 +15,20 @@
 
 #include "absl/container/flat_hash_map.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "quiche/quic/core/connection_id_generator.h"
+#include "quiche/quic/core/crypto/address_token_crypter.h"
 #include "quiche/quic/core/crypto/quic_compressed_certs_cache.h"
 #include "quiche/quic/core/crypto/quic_random.h"
 #include "quiche/quic/core/quic_blocked_writer_interface.h"
 #include "quiche/quic/core/quic_buffered_packet_store.h"
 #include "quiche/quic/core/quic_connection.h"
 #include "quiche/quic/core/quic_connection_id.h"
+#include "quiche/quic/core/quic_cpu_profiler.h"
 #include "quiche/quic/core/quic_crypto_server_stream_base.h"
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/core/quic_process_packet_interface.h"
+#include "quiche/quic/core/quic_retry_policy.h"
 #include "quiche/quic/core/quic_session.h"
 #include "quiche/quic/core/quic_time_wait_list_manager.h"
 #include "quiche/quic/core/quic_version_manager.h"
@@ -69,6 +74,10 @@ class QUIC_NO_EXPORT QuicDispatcher
                      const QuicSocketAddress& peer_address,
                      const QuicReceivedPacket& packet) override;
 
+  // Computes the header protection masks of the 1-RTT packets of each existing
+  // session among |packets| at once, before they are processed one by one.
+  void OnPacketsRead(absl::Span<const absl::string_view> packets) override;
+
   // Called when the socket becomes writable to allow queued writes to happen.
   virtual void OnCanWrite();
 
@@ -125,6 +134,10 @@ class QUIC_NO_EXPORT QuicDispatcher
 
   size_t NumSessions() const;
 
+  // Returns the CPU time spent by the connections of this dispatcher, open or
+  // closed, on which CPU profiling is enabled.
+  QuicCpuProfile GetCpuProfile() const;
+
   // Deletes all sessions on the closed session list and clears the list.
   virtual void DeleteSessions();
 
@@ -162,6 +175,21 @@ class QUIC_NO_EXPORT QuicDispatcher
 
   bool accept_new_connections() const { return accept_new_connections_; }
 
+  // Enables stateless retries of new TLS connections whose CHLO does not carry
+  // a valid address validation token, when |retry_policy| says so. Retry
+  // tokens are protected with the source address token keys of
+  // crypto_config(). Disabled by default.
+  void SetRetryPolicy(std::unique_ptr<QuicRetryPolicy> retry_policy);
+
+  // Has |generator| choose the connection IDs of new connections in place of
+  // the ones chosen by clients, and of the connection IDs their connections
+  // issue, e.g. to make them routable by a QUIC-LB load balancer. The
+  // generated connection IDs must have the length this dispatcher expects.
+  // |generator| must outlive this dispatcher and its sessions.
+  void SetConnectionIdGenerator(ConnectionIdGeneratorInterface* generator) {
+    connection_id_generator_ = generator;
+  }
+
  protected:
   // Creates a QUIC session based on the given information.
   // |alpn| is the selected ALPN from |parsed_chlo.alpns|.
@@ -350,8 +378,10 @@ class QUIC_NO_EXPORT QuicDispatcher
   // element of the vector is returned.
   std::string SelectAlpn(const std::vector<std::string>& alpns);
 
-  // If the connection ID length is different from what the dispatcher expects,
-  // replace the connection ID with one of the right length.
+  // If a connection ID generator is set, replaces the connection ID with the
+  // one it generates. Otherwise, if the connection ID length is different from
+  // what the dispatcher expects, replace the connection ID with one of the
+  // right length.
   // Note that this MUST produce a deterministic result (calling this method
   // with two connection IDs that are equal must produce the same result).
   QuicConnectionId MaybeReplaceServerConnectionId(
@@ -381,6 +411,14 @@ class QUIC_NO_EXPORT QuicDispatcher
   absl::optional<ParsedClientHello> TryExtractChloOrBufferEarlyPacket(
       const ReceivedPacketInfo& packet_info);
 
+  // Called with the full CHLO of a new TLS connection when a retry policy is
+  // set. Records the original destination connection ID in |parsed_chlo| if
+  // the CHLO carries a valid retry token. Otherwise, sends a RETRY and returns
+  // kFateDrop if the retry policy asks for it, and also drops the packet if it
+  // carries an invalid retry token.
+  QuicPacketFate ValidateAddressOrRetry(const ReceivedPacketInfo& packet_info,
+                                        ParsedClientHello* parsed_chlo);
+
   // Deliver |packets| to |session| for further processing.
   void DeliverPacketsToSession(
       const std::list<QuicBufferedPacketStore::BufferedPacket>& packets,
@@ -436,6 +474,9 @@ class QUIC_NO_EXPORT QuicDispatcher
   // Number of unique session in session map.
   size_t num_sessions_in_session_map_ = 0;
 
+  // Sum of the CPU profiles of the closed connections.
+  QuicCpuProfile closed_connections_cpu_profile_;
+
   // A backward counter of how many new sessions can be create within current
   // event loop. When reaches 0, it means can't create sessions for now.
   int16_t new_sessions_allowed_per_event_loop_;
@@ -467,6 +508,16 @@ class QUIC_NO_EXPORT QuicDispatcher
   // If true, change expected_server_connection_id_length_ to be the received
   // destination connection ID length of all IETF long headers.
   bool should_update_expected_server_connection_id_length_;
+
+  // Set by SetRetryPolicy().
+  std::unique_ptr<QuicRetryPolicy> retry_policy_;
+  std::unique_ptr<AddressTokenCrypter> address_token_crypter_;
+
+  // Set by SetConnectionIdGenerator().
+  ConnectionIdGeneratorInterface* connection_id_generator_ = nullptr;
+  // SipHash key of the replacements of the connection IDs which
+  // |connection_id_generator_| fails to replace with one of the right length.
+  uint64_t generator_fallback_key_[2];
 };
 
 }  // namespace quic
@@ -12,6 +12,7 @@
 #include "absl/base/macros.h"
 #include "absl/strings/str_cat.h"
 #include "quiche/quic/core/chlo_extractor.h"
+#include "quiche/quic/core/crypto/address_token_crypter.h"
 #include "quiche/quic/core/crypto/crypto_handshake.h"
 #include "quiche/quic/core/crypto/crypto_protocol.h"
 #include "quiche/quic/core/crypto/quic_crypto_server_config.h"
@@ -22,6 +23,7 @@
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_crypto_stream.h"
 #include "quiche/quic/core/quic_packet_writer_wrapper.h"
+#include "quiche/quic/core/quic_retry_policy.h"
 #include "quiche/quic/core/quic_time_wait_list_manager.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/core/quic_utils.h"
@@ -33,6 +35,7 @@
 #include "quiche/quic/test_tools/crypto_test_utils.h"
 #include "quiche/quic/test_tools/fake_proof_source.h"
 #include "quiche/quic/test_tools/first_flight.h"
+#include "quiche/quic/test_tools/mock_connection_id_generator.h"
 #include "quiche/quic/test_tools/mock_quic_time_wait_list_manager.h"
 #include "quiche/quic/test_tools/quic_buffered_packet_store_peer.h"
 #include "quiche/quic/test_tools/quic_connection_peer.h"
@@ -560,6 +563,209 @@ TEST_P(QuicDispatcherTestAllVersions, TlsClientHelloCreatesSession) {
   ProcessFirstFlight(client_address, TestConnectionId(1));
 }
 
+TEST_P(QuicDispatcherTestOneVersion, RetryWhenOverNewConnectionRate) {
+  if (!version_.UsesTls()) {
+    return;
+  }
+  CreateTimeWaitListManager();
+  QuicRetryPolicy::Config retry_config;
+  retry_config.max_new_connections_per_second = 1;
+  dispatcher_->SetRetryPolicy(std::make_unique<QuicRetryPolicy>(retry_config));
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+
+  // The first connection is within the rate and creates a session.
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(TestConnectionId(1), _, client_address, _, _,
+                                Eq(ParsedClientHelloForTest())))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(1), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _));
+  EXPECT_CALL(*time_wait_list_manager_, SendPacket(_, _, _)).Times(0);
+  ProcessFirstFlight(client_address, TestConnectionId(1));
+  EXPECT_FALSE(
+      session1_->connection()->retry_source_connection_id().has_value());
+
+  // The second one is retried.
+  testing::Mock::VerifyAndClearExpectations(time_wait_list_manager_);
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(TestConnectionId(2), _, _, _, _,
+                                              _))
+      .Times(0);
+  std::string retry_packet;
+  EXPECT_CALL(*time_wait_list_manager_, SendPacket(_, client_address, _))
+      .WillOnce(WithArg<2>(Invoke([&](const QuicEncryptedPacket& packet) {
+        retry_packet = std::string(packet.AsStringPiece());
+      })));
+  ProcessFirstFlight(client_address, TestConnectionId(2));
+
+  PacketHeaderFormat format;
+  QuicLongHeaderType long_packet_type;
+  bool version_present, has_length_prefix;
+  QuicVersionLabel version_label;
+  ParsedQuicVersion parsed_version = UnsupportedQuicVersion();
+  QuicConnectionId destination_connection_id, source_connection_id;
+  absl::optional<absl::string_view> retry_token;
+  std::string detailed_error;
+  ASSERT_THAT(QuicFramer::ParsePublicHeaderDispatcher(
+                  QuicEncryptedPacket(retry_packet.data(),
+                                      retry_packet.length()),
+                  kQuicDefaultConnectionIdLength, &format, &long_packet_type,
+                  &version_present, &has_length_prefix, &version_label,
+                  &parsed_version, &destination_connection_id,
+                  &source_connection_id, &retry_token, &detailed_error),
+              IsQuicNoError());
+  EXPECT_EQ(IETF_QUIC_LONG_HEADER_PACKET, format);
+  EXPECT_EQ(RETRY, long_packet_type);
+  EXPECT_EQ(version_, parsed_version);
+  EXPECT_EQ(kQuicDefaultConnectionIdLength, source_connection_id.length());
+  EXPECT_NE(TestConnectionId(2), source_connection_id);
+  EXPECT_FALSE(dispatcher_->HasChlosBuffered());
+}
+
+TEST_P(QuicDispatcherTestOneVersion, ValidRetryTokenCreatesSession) {
+  if (!version_.UsesTls()) {
+    return;
+  }
+  CreateTimeWaitListManager();
+  QuicRetryPolicy::Config retry_config;
+  retry_config.max_new_connections_per_second = 1;
+  dispatcher_->SetRetryPolicy(std::make_unique<QuicRetryPolicy>(retry_config));
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  // Retries of this client are sent to TestConnectionId(2).
+  AddressTokenCrypter crypter(&crypto_config_);
+  const std::string token = crypter.MintRetryToken(
+      client_address.host(), TestConnectionId(1), TestConnectionId(2),
+      mock_helper_.GetClock()->WallNow(), QuicRandom::GetInstance());
+
+  auto process_first_flight_with_token =
+      [&](const QuicSocketAddress& peer_address,
+          const QuicConnectionId& server_connection_id) {
+        for (auto& packet : GetFirstFlightOfPacketsWithToken(
+                 version_, server_connection_id, token)) {
+          ProcessReceivedPacket(std::move(packet), peer_address, version_,
+                                server_connection_id);
+        }
+      };
+  ParsedClientHello parsed_chlo = ParsedClientHelloForTest();
+  parsed_chlo.retry_token = token;
+  parsed_chlo.retry_original_destination_connection_id = TestConnectionId(1);
+  EXPECT_CALL(*time_wait_list_manager_, SendPacket(_, _, _)).Times(0);
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(TestConnectionId(2), _, client_address, _, _,
+                                Eq(parsed_chlo)))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(2), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _));
+  process_first_flight_with_token(client_address, TestConnectionId(2));
+  EXPECT_EQ(TestConnectionId(2),
+            session1_->connection()->retry_source_connection_id());
+  EXPECT_EQ(TestConnectionId(1),
+            session1_->connection()->GetOriginalDestinationConnectionId());
+
+  // The token is only valid for the connection ID it was minted for, and for
+  // the client address. Invalid retry tokens are dropped rather than retried.
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+  process_first_flight_with_token(client_address, TestConnectionId(3));
+  process_first_flight_with_token(
+      QuicSocketAddress(QuicIpAddress::Loopback6(), 1), TestConnectionId(4));
+}
+
+// Makes sure the connection ID the client retries to is generated, and kept
+// by the connection rather than replaced again.
+TEST_P(QuicDispatcherTestOneVersion, RetryWithConnectionIdGenerator) {
+  if (!version_.UsesTls()) {
+    return;
+  }
+  CreateTimeWaitListManager();
+  QuicRetryPolicy::Config retry_config;
+  retry_config.max_new_connections_per_second = 1;
+  dispatcher_->SetRetryPolicy(std::make_unique<QuicRetryPolicy>(retry_config));
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicConnectionId retry_source_connection_id = TestConnectionId(0x1234);
+  MockConnectionIdGenerator generator;
+  dispatcher_->SetConnectionIdGenerator(&generator);
+  EXPECT_CALL(generator, MaybeReplaceConnectionId(_, version_))
+      .WillRepeatedly(Return(absl::nullopt));
+  EXPECT_CALL(generator,
+              MaybeReplaceConnectionId(retry_source_connection_id, version_))
+      .WillRepeatedly(Return(TestConnectionId(0x5678)));
+  EXPECT_CALL(generator, GetPreviousReplacementConnectionId(_, _))
+      .WillRepeatedly(Return(absl::nullopt));
+  EXPECT_CALL(generator, GenerateNextConnectionId(_))
+      .WillRepeatedly(Return(absl::nullopt));
+  EXPECT_CALL(generator, GenerateNextConnectionId(TestConnectionId(2)))
+      .WillOnce(Return(retry_source_connection_id));
+
+  // The first connection is within the rate and creates a session.
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(TestConnectionId(1), _, client_address, _, _,
+                                Eq(ParsedClientHelloForTest())))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, TestConnectionId(1), client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _));
+  ProcessFirstFlight(client_address, TestConnectionId(1));
+
+  // The second one is retried to the generated connection ID.
+  std::string retry_packet;
+  EXPECT_CALL(*time_wait_list_manager_, SendPacket(_, client_address, _))
+      .WillOnce(WithArg<2>(Invoke([&](const QuicEncryptedPacket& packet) {
+        retry_packet = std::string(packet.AsStringPiece());
+      })));
+  ProcessFirstFlight(client_address, TestConnectionId(2));
+  PacketHeaderFormat format;
+  QuicLongHeaderType long_packet_type;
+  bool version_present, has_length_prefix;
+  QuicVersionLabel version_label;
+  ParsedQuicVersion parsed_version = UnsupportedQuicVersion();
+  QuicConnectionId destination_connection_id, source_connection_id;
+  absl::optional<absl::string_view> retry_token;
+  std::string detailed_error;
+  ASSERT_THAT(QuicFramer::ParsePublicHeaderDispatcher(
+                  QuicEncryptedPacket(retry_packet.data(),
+                                      retry_packet.length()),
+                  kQuicDefaultConnectionIdLength, &format, &long_packet_type,
+                  &version_present, &has_length_prefix, &version_label,
+                  &parsed_version, &destination_connection_id,
+                  &source_connection_id, &retry_token, &detailed_error),
+              IsQuicNoError());
+  EXPECT_EQ(RETRY, long_packet_type);
+  EXPECT_EQ(retry_source_connection_id, source_connection_id);
+
+  // The retried connection keeps that connection ID.
+  testing::Mock::VerifyAndClearExpectations(time_wait_list_manager_);
+  AddressTokenCrypter crypter(&crypto_config_);
+  const std::string token = crypter.MintRetryToken(
+      client_address.host(), TestConnectionId(2), retry_source_connection_id,
+      mock_helper_.GetClock()->WallNow(), QuicRandom::GetInstance());
+  EXPECT_CALL(*time_wait_list_manager_, SendPacket(_, _, _)).Times(0);
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(retry_source_connection_id, _,
+                                              client_address, _, _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, retry_source_connection_id,
+          client_address, &mock_helper_, &mock_alarm_factory_,
+          &crypto_config_, QuicDispatcherPeer::GetCache(dispatcher_.get()),
+          &session2_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session2_->connection()),
+              ProcessUdpPacket(_, _, _));
+  for (auto& packet : GetFirstFlightOfPacketsWithToken(
+           version_, retry_source_connection_id, token)) {
+    ProcessReceivedPacket(std::move(packet), client_address, version_,
+                          retry_source_connection_id);
+  }
+  EXPECT_EQ(retry_source_connection_id,
+            session2_->connection()->retry_source_connection_id());
+  EXPECT_EQ(TestConnectionId(2),
+            session2_->connection()->GetOriginalDestinationConnectionId());
+}
+
 void QuicDispatcherTestBase::TestTlsMultiPacketClientHello(
     bool add_reordering, bool long_connection_id) {
   if (!version_.UsesTls()) {
@@ -1139,6 +1345,127 @@ TEST_P(QuicDispatcherTestAllVersions, InvalidShortConnectionIdLengthReplaced) {
   ProcessFirstFlight(client_address, bad_connection_id);
 }
 
+// Makes sure the connection ID generator replaces connection IDs of the
+// expected length too.
+TEST_P(QuicDispatcherTestAllVersions, ConnectionIdGeneratorReplacesId) {
+  if (!version_.HasIetfQuicFrames()) {
+    return;
+  }
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicConnectionId original_connection_id = TestConnectionId(1);
+  QuicConnectionId generated_connection_id = TestConnectionId(0x1234);
+  MockConnectionIdGenerator generator;
+  dispatcher_->SetConnectionIdGenerator(&generator);
+  EXPECT_CALL(generator, MaybeReplaceConnectionId(original_connection_id,
+                                                  version_))
+      .WillRepeatedly(Return(generated_connection_id));
+  EXPECT_CALL(generator, GetPreviousReplacementConnectionId(_, _))
+      .WillRepeatedly(Return(absl::nullopt));
+
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(generated_connection_id, _, client_address,
+                                Eq(ExpectedAlpn()), _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, generated_connection_id, client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .WillOnce(WithArg<2>(Invoke(
+          [this, original_connection_id](const QuicEncryptedPacket& packet) {
+            ValidatePacket(original_connection_id, packet);
+          })));
+  EXPECT_CALL(*dispatcher_,
+              ShouldCreateOrBufferPacketForConnection(
+                  ReceivedPacketInfoConnectionIdEquals(
+                      original_connection_id)));
+  ProcessFirstFlight(client_address, original_connection_id);
+}
+
+// Makes sure packets sent to the original connection ID keep reaching the
+// connection after the generator changes its replacement, e.g. when a QUIC-LB
+// config is rotated during the handshake.
+TEST_P(QuicDispatcherTestAllVersions,
+       ConnectionIdGeneratorChangesReplacementDuringHandshake) {
+  if (!version_.HasIetfQuicFrames()) {
+    return;
+  }
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicConnectionId original_connection_id = TestConnectionId(1);
+  QuicConnectionId generated_connection_id = TestConnectionId(0x1234);
+  QuicConnectionId new_generated_connection_id = TestConnectionId(0x5678);
+  MockConnectionIdGenerator generator;
+  dispatcher_->SetConnectionIdGenerator(&generator);
+  EXPECT_CALL(generator, MaybeReplaceConnectionId(original_connection_id,
+                                                  version_))
+      .WillRepeatedly(Return(generated_connection_id));
+  EXPECT_CALL(generator, GetPreviousReplacementConnectionId(_, _))
+      .WillRepeatedly(Return(absl::nullopt));
+  EXPECT_CALL(*dispatcher_,
+              CreateQuicSession(generated_connection_id, _, client_address,
+                                Eq(ExpectedAlpn()), _, _))
+      .WillOnce(Return(ByMove(CreateSession(
+          dispatcher_.get(), config_, generated_connection_id, client_address,
+          &mock_helper_, &mock_alarm_factory_, &crypto_config_,
+          QuicDispatcherPeer::GetCache(dispatcher_.get()), &session1_))));
+  EXPECT_CALL(*reinterpret_cast<MockQuicConnection*>(session1_->connection()),
+              ProcessUdpPacket(_, _, _))
+      .Times(2)
+      .WillRepeatedly(WithArg<2>(Invoke(
+          [this, original_connection_id](const QuicEncryptedPacket& packet) {
+            ValidatePacket(original_connection_id, packet);
+          })));
+  EXPECT_CALL(*dispatcher_,
+              ShouldCreateOrBufferPacketForConnection(
+                  ReceivedPacketInfoConnectionIdEquals(
+                      original_connection_id)));
+  ProcessFirstFlight(client_address, original_connection_id);
+
+  EXPECT_CALL(generator, MaybeReplaceConnectionId(original_connection_id,
+                                                  version_))
+      .WillRepeatedly(Return(new_generated_connection_id));
+  EXPECT_CALL(generator, GetPreviousReplacementConnectionId(
+                             original_connection_id, version_))
+      .WillRepeatedly(Return(generated_connection_id));
+  EXPECT_CALL(*dispatcher_, CreateQuicSession(_, _, _, _, _, _)).Times(0);
+  ProcessPacket(client_address, original_connection_id, true, "data");
+}
+
+// Makes sure a generated connection ID of the wrong length is not used.
+TEST_P(QuicDispatcherTestAllVersions, ConnectionIdGeneratorWrongLength) {
+  if (!version_.HasIetfQuicFrames()) {
+    return;
+  }
+  QuicSocketAddress client_address(QuicIpAddress::Loopback4(), 1);
+  QuicConnectionId original_connection_id = TestConnectionId(1);
+  MockConnectionIdGenerator generator;
+  dispatcher_->SetConnectionIdGenerator(&generator);
+  EXPECT_CALL(generator, MaybeReplaceConnectionId(original_connection_id,
+                                                  version_))
+      .WillRepeatedly(Return(TestConnectionIdNineBytesLong(2)));
+  EXPECT_CALL(generator, GetPreviousReplacementConnectionId(_, _))
+      .WillRepeatedly(Return(absl::nullopt));
+  QuicConnectionId replacement;
+  EXPECT_QUIC_BUG(
+      {
+        replacement = QuicDispatcherPeer::MaybeReplaceServerConnectionId(
+            dispatcher_.get(), original_connection_id, version_);
+      },
+      "Connection ID generator returned");
+  // Falls back to a keyed replacement of the expected length.
+  EXPECT_EQ(kQuicDefaultConnectionIdLength, replacement.length());
+  EXPECT_NE(original_connection_id, replacement);
+  EXPECT_NE(QuicUtils::CreateReplacementConnectionId(original_connection_id),
+            replacement);
+  EXPECT_QUIC_BUG(
+      {
+        EXPECT_EQ(replacement,
+                  QuicDispatcherPeer::MaybeReplaceServerConnectionId(
+                      dispatcher_.get(), original_connection_id, version_));
+      },
+      "Connection ID generator returned");
+}
+
 // Makes sure TestConnectionId(1) creates a new connection and
 // TestConnectionIdNineBytesLong(2) gets replaced.
 TEST_P(QuicDispatcherTestAllVersions, MixGoodAndBadConnectionIdLengthPackets) {
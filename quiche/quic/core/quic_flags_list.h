@@ -21,6 +21,8 @@ QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_no_probe_up_exit_if_no_queue, tru
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_use_lower_min_for_trusted_irtt, true)
 // If true, QUIC will default enable MTU discovery at server, with a target of 1450 bytes.
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_enable_mtu_discovery_at_server, false)
+// If true, QUIC TLS handshakes offer and accept zlib certificate compression (RFC 8879).
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_tls_compress_certificates, false)
 // If true, QuicGsoBatchWriter will support release time if it is available and the process has the permission to do so.
 QUIC_FLAG(FLAGS_quic_restart_flag_quic_support_release_time_for_gso, false)
 // If true, abort async QPACK header decompression in QuicSpdyStream::Reset() and in QuicSpdyStream::OnStreamReset().
@@ -29,6 +31,10 @@ QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_abort_qpack_on_stream_reset, true)
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_can_send_ack_frequency, true)
 // If true, allow client to enable BBRv2 on server via connection option \'B2ON\'.
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_allow_client_enabled_bbr_v2, true)
+// If true, allow client to enable PCC on server via connection option \'TPCC\'.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_allow_client_enabled_pcc, false)
+// If true, allow client to enable experimental multipath via connection options \'MPTH\', \'MPRR\' or \'MPRD\'.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_enable_multipath_experiment, false)
 // If true, close read side but not write side in QuicSpdyStream::OnStreamReset().
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_fix_on_stream_reset, true)
 // If true, close the connection if a crypto send buffer exceeds its size limit.
@@ -111,6 +117,14 @@ QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_exit_startup_on_persistent_queue2
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_add_bytes_acked_after_inflight_hi_limited, true)
 // When true, the BBR4 copt sets the extra_acked window to 20 RTTs and BBR5 sets it to 40 RTTs.
 QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_bbr2_extra_acked_window, true)
+// If true, QuicPacketCreator encrypts the stream data of packets consisting of a single STREAM frame straight from the stream send buffer into the packet, instead of first copying it into the packet as plaintext.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_encrypt_stream_data_from_send_buffer, false)
+// If true, TlsChloExtractor parses the CHLO with TlsClientHelloParser instead of a BoringSSL SSL object.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_parse_chlo_without_ssl, false)
+// If true, QuicDispatcher computes the header protection masks of the 1-RTT packets of a session read in the same burst at once.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_batch_header_protection_masks, false)
+// If true, QuicConnection derives the 1-RTT keys of the next key phase ahead of the next key update, once the previous keys are discarded or the AEAD confidentiality limit is approached.
+QUIC_FLAG(FLAGS_quic_reloadable_flag_quic_pre_derive_next_one_rtt_keys, false)
 
 #endif
 
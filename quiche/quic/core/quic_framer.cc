@@ -32,6 +32,7 @@
 #include "quiche/quic/core/frames/quic_ack_frequency_frame.h"
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_cpu_profiler.h"
 #include "quiche/quic/core/quic_data_reader.h"
 #include "quiche/quic/core/quic_data_writer.h"
 #include "quiche/quic/core/quic_error_codes.h"
@@ -1457,8 +1458,55 @@ QuicFramer::BuildIetfVersionNegotiationPacket(
   return std::make_unique<QuicEncryptedPacket>(buffer.release(), len, true);
 }
 
+// static
+std::unique_ptr<QuicEncryptedPacket> QuicFramer::BuildIetfRetryPacket(
+    const ParsedQuicVersion& version, QuicConnectionId client_connection_id,
+    QuicConnectionId server_connection_id,
+    QuicConnectionId original_connection_id, absl::string_view retry_token) {
+  QUIC_DVLOG(1) << "Building IETF retry packet for " << version
+                << ", server_connection_id " << server_connection_id
+                << " client_connection_id " << client_connection_id
+                << " original_connection_id " << original_connection_id;
+  if (!version.UsesTls() || retry_token.empty()) {
+    QUIC_BUG(quic_bug_10850_103)
+        << "Cannot build retry packet for " << version << " with "
+        << retry_token.length() << " byte token";
+    return nullptr;
+  }
+  QUICHE_DCHECK(version.HasLengthPrefixedConnectionIds()) << version;
+  const size_t len = kPacketHeaderTypeSize + kQuicVersionSize +
+                     2 * kConnectionIdLengthSize +
+                     client_connection_id.length() +
+                     server_connection_id.length() + retry_token.length() +
+                     kRetryIntegrityTagLength;
+  std::unique_ptr<char[]> buffer(new char[len]);
+  QuicDataWriter writer(len, buffer.get());
+
+  const uint8_t type = static_cast<uint8_t>(
+      FLAGS_LONG_HEADER | FLAGS_FIXED_BIT |
+      LongHeaderTypeToOnWireValue(RETRY, version));
+  if (!writer.WriteUInt8(type) ||
+      !writer.WriteUInt32(CreateQuicVersionLabel(version)) ||
+      !AppendIetfConnectionIds(/*version_flag=*/true,
+                               /*use_length_prefix=*/true,
+                               client_connection_id, server_connection_id,
+                               &writer) ||
+      !writer.WriteStringPiece(retry_token)) {
+    return nullptr;
+  }
+  if (!CryptoUtils::ComputeRetryIntegrityTag(
+          version, original_connection_id,
+          absl::string_view(writer.data(), writer.length()),
+          writer.data() + writer.length())) {
+    return nullptr;
+  }
+  return std::make_unique<QuicEncryptedPacket>(buffer.release(), len, true);
+}
+
 bool QuicFramer::ProcessPacket(const QuicEncryptedPacket& packet) {
   QUICHE_DCHECK(!is_processing_packet_) << ENDPOINT << "Nested ProcessPacket";
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kFrameParse);
   is_processing_packet_ = true;
   bool result = ProcessPacketInternal(packet);
   is_processing_packet_ = false;
@@ -4381,6 +4429,7 @@ void QuicFramer::SetDecrypter(EncryptionLevel level,
   decrypter_[decrypter_level_] = nullptr;
   decrypter_[level] = std::move(decrypter);
   decrypter_level_ = level;
+  ClearPrecomputedHeaderProtectionMasks();
 }
 
 void QuicFramer::SetAlternativeDecrypter(
@@ -4396,6 +4445,7 @@ void QuicFramer::SetAlternativeDecrypter(
   decrypter_[level] = std::move(decrypter);
   alternative_decrypter_level_ = level;
   alternative_decrypter_latch_ = latch_once_used;
+  ClearPrecomputedHeaderProtectionMasks();
 }
 
 void QuicFramer::InstallDecrypter(EncryptionLevel level,
@@ -4403,12 +4453,14 @@ void QuicFramer::InstallDecrypter(EncryptionLevel level,
   QUICHE_DCHECK(version_.KnowsWhichDecrypterToUse());
   QUIC_DVLOG(1) << ENDPOINT << "Installing decrypter at level " << level;
   decrypter_[level] = std::move(decrypter);
+  ClearPrecomputedHeaderProtectionMasks();
 }
 
 void QuicFramer::RemoveDecrypter(EncryptionLevel level) {
   QUICHE_DCHECK(version_.KnowsWhichDecrypterToUse());
   QUIC_DVLOG(1) << ENDPOINT << "Removing decrypter at level " << level;
   decrypter_[level] = nullptr;
+  ClearPrecomputedHeaderProtectionMasks();
 }
 
 void QuicFramer::SetKeyUpdateSupportForConnection(bool enabled) {
@@ -4422,6 +4474,29 @@ void QuicFramer::DiscardPreviousOneRttKeys() {
   previous_decrypter_ = nullptr;
 }
 
+bool QuicFramer::DeriveNextOneRttKeys() {
+  QUICHE_DCHECK(support_key_update_for_connection_);
+  if (next_decrypter_ && next_encrypter_) {
+    return true;
+  }
+  QUIC_RELOADABLE_FLAG_COUNT(quic_pre_derive_next_one_rtt_keys);
+  if (!next_decrypter_) {
+    next_decrypter_ = visitor_->AdvanceKeysAndCreateCurrentOneRttDecrypter();
+    if (!next_decrypter_) {
+      return false;
+    }
+  }
+  if (!next_encrypter_) {
+    // The secrets have been advanced along with the creation of
+    // |next_decrypter_|.
+    next_encrypter_ = visitor_->CreateCurrentOneRttEncrypter();
+    if (!next_encrypter_) {
+      return false;
+    }
+  }
+  return true;
+}
+
 bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
   QUICHE_DCHECK(support_key_update_for_connection_);
   if (!next_decrypter_) {
@@ -4429,8 +4504,12 @@ bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
     // yet.
     next_decrypter_ = visitor_->AdvanceKeysAndCreateCurrentOneRttDecrypter();
   }
-  std::unique_ptr<QuicEncrypter> next_encrypter =
-      visitor_->CreateCurrentOneRttEncrypter();
+  std::unique_ptr<QuicEncrypter> next_encrypter = std::move(next_encrypter_);
+  if (next_encrypter) {
+    ++pre_derived_key_update_count_;
+  } else {
+    next_encrypter = visitor_->CreateCurrentOneRttEncrypter();
+  }
   if (!next_decrypter_ || !next_encrypter) {
     QUIC_BUG(quic_bug_10850_58) << "Failed to create next crypters";
     return false;
@@ -4443,6 +4522,7 @@ bool QuicFramer::DoKeyUpdate(KeyUpdateReason reason) {
   previous_decrypter_ = std::move(decrypter_[ENCRYPTION_FORWARD_SECURE]);
   decrypter_[ENCRYPTION_FORWARD_SECURE] = std::move(next_decrypter_);
   encrypter_[ENCRYPTION_FORWARD_SECURE] = std::move(next_encrypter);
+  ClearPrecomputedHeaderProtectionMasks();
   switch (reason) {
     case KeyUpdateReason::kInvalid:
       QUIC_CODE_COUNT(quic_key_update_invalid);
@@ -4513,6 +4593,8 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
                                   size_t total_len, size_t buffer_len,
                                   char* buffer) {
   QUICHE_DCHECK(packet_number.IsInitialized());
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kEncrypt);
   if (encrypter_[level] == nullptr) {
     QUIC_BUG(quic_bug_10850_59)
         << ENDPOINT
@@ -4542,9 +4624,48 @@ size_t QuicFramer::EncryptInPlace(EncryptionLevel level,
   return ad_len + output_length;
 }
 
+size_t QuicFramer::EncryptInPlaceWithExtraPlaintext(
+    EncryptionLevel level, QuicPacketNumber packet_number, size_t ad_len,
+    size_t total_len, size_t buffer_len, char* buffer,
+    absl::string_view extra_plaintext) {
+  QUICHE_DCHECK(packet_number.IsInitialized());
+  QUICHE_DCHECK_LE(ad_len + extra_plaintext.length(), total_len);
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kEncrypt);
+  if (encrypter_[level] == nullptr) {
+    QUIC_BUG(quic_bug_10850_102)
+        << ENDPOINT
+        << "Attempted to encrypt in place without encrypter at level " << level;
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+
+  size_t output_length = 0;
+  if (!encrypter_[level]->EncryptPacketWithExtraPlaintext(
+          packet_number.ToUint64(),
+          absl::string_view(buffer, ad_len),  // Associated data
+          absl::string_view(buffer + ad_len,
+                            total_len - ad_len -
+                                extra_plaintext.length()),  // Plaintext
+          extra_plaintext,
+          buffer + ad_len,  // Destination buffer
+          &output_length, buffer_len - ad_len)) {
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+  if (version_.HasHeaderProtection() &&
+      !ApplyHeaderProtection(level, buffer, ad_len + output_length, ad_len)) {
+    QUIC_DLOG(ERROR) << "Applying header protection failed.";
+    RaiseError(QUIC_ENCRYPTION_FAILURE);
+    return 0;
+  }
+
+  return ad_len + output_length;
+}
+
 namespace {
 
-const size_t kHPSampleLen = 16;
+const size_t kHPSampleLen = kHeaderProtectionSampleLength;
 
 constexpr bool IsLongHeader(uint8_t type_byte) {
   return (type_byte & FLAGS_LONG_HEADER) != 0;
@@ -4643,6 +4764,8 @@ bool QuicFramer::RemoveHeaderProtection(QuicDataReader* reader,
                                         QuicPacketHeader* header,
                                         uint64_t* full_packet_number,
                                         std::vector<char>* associated_data) {
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kDecrypt);
   EncryptionLevel expected_decryption_level = GetEncryptionLevel(*header);
   QuicDecrypter* decrypter = decrypter_[expected_decryption_level].get();
   if (decrypter == nullptr) {
@@ -4678,7 +4801,18 @@ bool QuicFramer::RemoveHeaderProtection(QuicDataReader* reader,
       return false;
     }
   }
-  std::string mask = decrypter->GenerateHeaderProtectionMask(&sample_reader);
+  absl::string_view mask;
+  std::string mask_storage;
+  if (expected_decryption_level == ENCRYPTION_FORWARD_SECURE &&
+      header->form == IETF_QUIC_SHORT_HEADER_PACKET &&
+      !precomputed_header_protection_samples_.empty()) {
+    mask = PrecomputedHeaderProtectionMask(
+        sample_reader.PeekRemainingPayload().substr(0, kHPSampleLen));
+  }
+  if (mask.empty()) {
+    mask_storage = decrypter->GenerateHeaderProtectionMask(&sample_reader);
+    mask = mask_storage;
+  }
   QuicDataReader mask_reader(mask.data(), mask.size());
   if (mask.empty()) {
     QUIC_DVLOG(1) << "Failed to compute mask";
@@ -4762,11 +4896,76 @@ bool QuicFramer::RemoveHeaderProtection(QuicDataReader* reader,
   return true;
 }
 
+void QuicFramer::PrecomputeHeaderProtectionMasks(
+    absl::Span<const absl::string_view> packets) {
+  ClearPrecomputedHeaderProtectionMasks();
+  QuicDecrypter* decrypter = decrypter_[ENCRYPTION_FORWARD_SECURE].get();
+  if (!version_.HasHeaderProtection() || decrypter == nullptr ||
+      packets.size() < 2) {
+    return;
+  }
+  // The sample of a short header packet starts 4 bytes after the packet
+  // number, which follows the type byte and the destination connection ID.
+  const size_t sample_offset =
+      1 +
+      (perspective_ == Perspective::IS_SERVER
+           ? expected_server_connection_id_length_
+           : expected_client_connection_id_length_) +
+      IETF_MAX_PACKET_NUMBER_LENGTH;
+  for (absl::string_view packet : packets) {
+    if (packet.size() < sample_offset + kHPSampleLen ||
+        IsLongHeader(static_cast<uint8_t>(packet[0]))) {
+      continue;
+    }
+    precomputed_header_protection_samples_.append(
+        packet.data() + sample_offset, kHPSampleLen);
+  }
+  if (precomputed_header_protection_samples_.size() < 2 * kHPSampleLen) {
+    ClearPrecomputedHeaderProtectionMasks();
+    return;
+  }
+  precomputed_header_protection_masks_.resize(
+      precomputed_header_protection_samples_.size());
+  if (!decrypter->GenerateHeaderProtectionMasks(
+          precomputed_header_protection_samples_,
+          &precomputed_header_protection_masks_[0])) {
+    QUIC_DVLOG(1) << ENDPOINT << "Failed to precompute header protection masks";
+    ClearPrecomputedHeaderProtectionMasks();
+  }
+}
+
+absl::string_view QuicFramer::PrecomputedHeaderProtectionMask(
+    absl::string_view sample) {
+  if (sample.size() != kHPSampleLen) {
+    return absl::string_view();
+  }
+  // Packets are usually processed in the order their masks were computed in,
+  // so start looking at the sample of the next one.
+  absl::string_view samples(precomputed_header_protection_samples_);
+  for (size_t offset = next_precomputed_header_protection_sample_;
+       offset < samples.size(); offset += kHPSampleLen) {
+    if (samples.substr(offset, kHPSampleLen) == sample) {
+      next_precomputed_header_protection_sample_ = offset + kHPSampleLen;
+      return absl::string_view(precomputed_header_protection_masks_)
+          .substr(offset, kHPSampleLen);
+    }
+  }
+  return absl::string_view();
+}
+
+void QuicFramer::ClearPrecomputedHeaderProtectionMasks() {
+  precomputed_header_protection_samples_.clear();
+  precomputed_header_protection_masks_.clear();
+  next_precomputed_header_protection_sample_ = 0;
+}
+
 size_t QuicFramer::EncryptPayload(EncryptionLevel level,
                                   QuicPacketNumber packet_number,
                                   const QuicPacket& packet, char* buffer,
                                   size_t buffer_len) {
   QUICHE_DCHECK(packet_number.IsInitialized());
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kEncrypt);
   if (encrypter_[level] == nullptr) {
     QUIC_BUG(quic_bug_10850_63)
         << ENDPOINT << "Attempted to encrypt without encrypter at level "
@@ -4852,6 +5051,8 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
                                 char* decrypted_buffer, size_t buffer_length,
                                 size_t* decrypted_length,
                                 EncryptionLevel* decrypted_level) {
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kDecrypt);
   if (!EncryptionLevelIsValid(decrypter_level_)) {
     QUIC_BUG(quic_bug_10850_67)
         << "Attempted to decrypt with bad decrypter_level_";
@@ -4910,6 +5111,7 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
                         << " attempt_key_update=true";
           attempt_key_update = true;
           potential_peer_key_update_attempt_count_++;
+          key_update_trial_decryption_count_++;
           decrypter = next_decrypter_.get();
         } else {
           if (previous_decrypter_) {
@@ -4944,6 +5146,9 @@ bool QuicFramer::DecryptPayload(size_t udp_packet_length,
   bool success = decrypter->DecryptPacket(
       header.packet_number.ToUint64(), associated_data, encrypted,
       decrypted_buffer, decrypted_length, buffer_length);
+  if (!success && attempt_key_update) {
+    failed_key_update_trial_decryption_count_++;
+  }
   if (success) {
     visitor_->OnDecryptedPacket(udp_packet_length, level);
     if (level == ENCRYPTION_ZERO_RTT &&
@@ -5412,27 +5617,9 @@ bool QuicFramer::AppendStreamFrame(const QuicStreamFrame& frame,
   if (VersionHasIetfQuicFrames(version_.transport_version)) {
     return AppendIetfStreamFrame(frame, no_stream_frame_length, writer);
   }
-  if (!AppendStreamId(GetStreamIdSize(frame.stream_id), frame.stream_id,
-                      writer)) {
-    QUIC_BUG(quic_bug_10850_80) << "Writing stream id size failed.";
-    return false;
-  }
-  if (!AppendStreamOffset(GetStreamOffsetSize(frame.offset), frame.offset,
-                          writer)) {
-    QUIC_BUG(quic_bug_10850_81) << "Writing offset size failed.";
+  if (!AppendStreamFrameHeader(frame, no_stream_frame_length, writer)) {
     return false;
   }
-  if (!no_stream_frame_length) {
-    static_assert(
-        std::numeric_limits<decltype(frame.data_length)>::max() <=
-            std::numeric_limits<uint16_t>::max(),
-        "If frame.data_length can hold more than a uint16_t than we need to "
-        "check that frame.data_length <= std::numeric_limits<uint16_t>::max()");
-    if (!writer->WriteUInt16(static_cast<uint16_t>(frame.data_length))) {
-      QUIC_BUG(quic_bug_10850_82) << "Writing stream frame length failed";
-      return false;
-    }
-  }
 
   if (data_producer_ != nullptr) {
     QUICHE_DCHECK_EQ(nullptr, frame.data_buffer);
@@ -5455,6 +5642,36 @@ bool QuicFramer::AppendStreamFrame(const QuicStreamFrame& frame,
   return true;
 }
 
+bool QuicFramer::AppendStreamFrameHeader(const QuicStreamFrame& frame,
+                                         bool no_stream_frame_length,
+                                         QuicDataWriter* writer) {
+  if (VersionHasIetfQuicFrames(version_.transport_version)) {
+    return AppendIetfStreamFrameHeader(frame, no_stream_frame_length, writer);
+  }
+  if (!AppendStreamId(GetStreamIdSize(frame.stream_id), frame.stream_id,
+                      writer)) {
+    QUIC_BUG(quic_bug_10850_80) << "Writing stream id size failed.";
+    return false;
+  }
+  if (!AppendStreamOffset(GetStreamOffsetSize(frame.offset), frame.offset,
+                          writer)) {
+    QUIC_BUG(quic_bug_10850_81) << "Writing offset size failed.";
+    return false;
+  }
+  if (!no_stream_frame_length) {
+    static_assert(
+        std::numeric_limits<decltype(frame.data_length)>::max() <=
+            std::numeric_limits<uint16_t>::max(),
+        "If frame.data_length can hold more than a uint16_t than we need to "
+        "check that frame.data_length <= std::numeric_limits<uint16_t>::max()");
+    if (!writer->WriteUInt16(static_cast<uint16_t>(frame.data_length))) {
+      QUIC_BUG(quic_bug_10850_82) << "Writing stream frame length failed";
+      return false;
+    }
+  }
+  return true;
+}
+
 bool QuicFramer::AppendNewTokenFrame(const QuicNewTokenFrame& frame,
                                      QuicDataWriter* writer) {
   if (!writer->WriteVarInt62(static_cast<uint64_t>(frame.token.length()))) {
@@ -5496,25 +5713,10 @@ bool QuicFramer::ProcessNewTokenFrame(QuicDataReader* reader,
 bool QuicFramer::AppendIetfStreamFrame(const QuicStreamFrame& frame,
                                        bool last_frame_in_packet,
                                        QuicDataWriter* writer) {
-  if (!writer->WriteVarInt62(static_cast<uint64_t>(frame.stream_id))) {
-    set_detailed_error("Writing stream id failed.");
+  if (!AppendIetfStreamFrameHeader(frame, last_frame_in_packet, writer)) {
     return false;
   }
 
-  if (frame.offset != 0) {
-    if (!writer->WriteVarInt62(static_cast<uint64_t>(frame.offset))) {
-      set_detailed_error("Writing data offset failed.");
-      return false;
-    }
-  }
-
-  if (!last_frame_in_packet) {
-    if (!writer->WriteVarInt62(frame.data_length)) {
-      set_detailed_error("Writing data length failed.");
-      return false;
-    }
-  }
-
   if (frame.data_length == 0) {
     return true;
   }
@@ -5536,6 +5738,30 @@ bool QuicFramer::AppendIetfStreamFrame(const QuicStreamFrame& frame,
   return true;
 }
 
+bool QuicFramer::AppendIetfStreamFrameHeader(const QuicStreamFrame& frame,
+                                             bool last_frame_in_packet,
+                                             QuicDataWriter* writer) {
+  if (!writer->WriteVarInt62(static_cast<uint64_t>(frame.stream_id))) {
+    set_detailed_error("Writing stream id failed.");
+    return false;
+  }
+
+  if (frame.offset != 0) {
+    if (!writer->WriteVarInt62(static_cast<uint64_t>(frame.offset))) {
+      set_detailed_error("Writing data offset failed.");
+      return false;
+    }
+  }
+
+  if (!last_frame_in_packet) {
+    if (!writer->WriteVarInt62(frame.data_length)) {
+      set_detailed_error("Writing data length failed.");
+      return false;
+    }
+  }
+  return true;
+}
+
 bool QuicFramer::AppendCryptoFrame(const QuicCryptoFrame& frame,
                                    QuicDataWriter* writer) {
   if (!writer->WriteVarInt62(static_cast<uint64_t>(frame.offset))) {
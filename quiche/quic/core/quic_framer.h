@@ -11,6 +11,7 @@
 #include <string>
 
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "quiche/quic/core/crypto/quic_decrypter.h"
 #include "quiche/quic/core/crypto/quic_encrypter.h"
 #include "quiche/quic/core/crypto/quic_random.h"
@@ -25,6 +26,7 @@ namespace test {
 class QuicFramerPeer;
 }  // namespace test
 
+class QuicCpuProfiler;
 class QuicDataReader;
 class QuicDataWriter;
 class QuicFramer;
@@ -488,6 +490,16 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
       QuicConnectionId client_connection_id,
       const ParsedQuicVersionVector& versions);
 
+  // Returns a new RETRY packet, sent by a server in response to a client
+  // Initial with destination connection ID |original_connection_id| and
+  // source connection ID |client_connection_id|. The client is asked to retry
+  // with |server_connection_id| and |retry_token|. |version| must use TLS.
+  // Returns nullptr on failure.
+  static std::unique_ptr<QuicEncryptedPacket> BuildIetfRetryPacket(
+      const ParsedQuicVersion& version, QuicConnectionId client_connection_id,
+      QuicConnectionId server_connection_id,
+      QuicConnectionId original_connection_id, absl::string_view retry_token);
+
   // If header.version_flag is set, the version in the
   // packet will be set -- but it will be set from version_ not
   // header.versions.
@@ -509,6 +521,10 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   size_t AppendIetfFrames(const QuicFrames& frames, QuicDataWriter* writer);
   bool AppendStreamFrame(const QuicStreamFrame& frame,
                          bool no_stream_frame_length, QuicDataWriter* writer);
+  // Appends everything in |frame| but the type byte and the stream data.
+  bool AppendStreamFrameHeader(const QuicStreamFrame& frame,
+                               bool no_stream_frame_length,
+                               QuicDataWriter* writer);
   bool AppendCryptoFrame(const QuicCryptoFrame& frame, QuicDataWriter* writer);
   bool AppendAckFrequencyFrame(const QuicAckFrequencyFrame& frame,
                                QuicDataWriter* writer);
@@ -539,13 +555,45 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   void SetKeyUpdateSupportForConnection(bool enabled);
   // Discard the decrypter for the previous key phase.
   void DiscardPreviousOneRttKeys();
+  // Derives the 1-RTT keys of the next key phase ahead of time, if not done
+  // yet, so that the next key update, whether initiated locally or by the
+  // peer, switches to them without deriving keys on the packet path.
+  // Returns false on failure.
+  bool DeriveNextOneRttKeys();
   // Update the key phase.
   bool DoKeyUpdate(KeyUpdateReason reason);
+
+  // Computes the header protection masks of the 1-RTT short header packets
+  // among |packets| in one call to the decrypter, which is cheaper than one
+  // call per packet for some ciphers. The masks are used by the following calls
+  // to ProcessPacket() for the same packets, in the same order. Does nothing
+  // for fewer than two such packets. Packets of other connections or with
+  // unexpected connection IDs merely waste their mask.
+  void PrecomputeHeaderProtectionMasks(
+      absl::Span<const absl::string_view> packets);
   // Returns the count of packets received that appeared to attempt a key
   // update but failed decryption which have been received since the last
   // successfully decrypted packet.
   QuicPacketCount PotentialPeerKeyUpdateAttemptCount() const;
 
+  // Number of 1-RTT packets received with the next key phase which were
+  // decrypted with the keys of the next key phase, and how many of them failed
+  // to decrypt, over the lifetime of the connection. Unlike
+  // PotentialPeerKeyUpdateAttemptCount(), which only counts the failures since
+  // the last successfully decrypted packet to enforce the integrity limit,
+  // these are never reset and are reported in QuicConnectionStats.
+  QuicPacketCount key_update_trial_decryption_count() const {
+    return key_update_trial_decryption_count_;
+  }
+  QuicPacketCount failed_key_update_trial_decryption_count() const {
+    return failed_key_update_trial_decryption_count_;
+  }
+  // Number of key updates which switched to keys derived ahead of time by
+  // DeriveNextOneRttKeys().
+  uint32_t pre_derived_key_update_count() const {
+    return pre_derived_key_update_count_;
+  }
+
   const QuicDecrypter* GetDecrypter(EncryptionLevel level) const;
   const QuicDecrypter* decrypter() const;
   const QuicDecrypter* alternative_decrypter() const;
@@ -567,6 +615,15 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                         size_t ad_len, size_t total_len, size_t buffer_len,
                         char* buffer);
 
+  // Like EncryptInPlace, but the last |extra_plaintext| length bytes of the
+  // plaintext are read from |extra_plaintext| rather than from |buffer|, in
+  // which they are only written encrypted.
+  size_t EncryptInPlaceWithExtraPlaintext(EncryptionLevel level,
+                                          QuicPacketNumber packet_number,
+                                          size_t ad_len, size_t total_len,
+                                          size_t buffer_len, char* buffer,
+                                          absl::string_view extra_plaintext);
+
   // Returns the length of the data encrypted into |buffer| if |buffer_len| is
   // long enough, and otherwise 0.
   size_t EncryptPayload(EncryptionLevel level, QuicPacketNumber packet_number,
@@ -624,6 +681,10 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
     data_producer_ = data_producer;
   }
 
+  void set_cpu_profiler(QuicCpuProfiler* cpu_profiler) {
+    cpu_profiler_ = cpu_profiler;
+  }
+
   QuicTime creation_time() const { return creation_time_; }
 
   QuicPacketNumber first_sending_packet_number() const {
@@ -762,6 +823,11 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
                               uint64_t* full_packet_number,
                               std::vector<char>* associated_data);
 
+  // Returns the mask precomputed by PrecomputeHeaderProtectionMasks() for
+  // |sample|, or an empty string_view if there is none.
+  absl::string_view PrecomputedHeaderProtectionMask(absl::string_view sample);
+  void ClearPrecomputedHeaderProtectionMasks();
+
   bool ProcessDataPacket(QuicDataReader* reader, QuicPacketHeader* header,
                          const QuicEncryptedPacket& packet,
                          char* decrypted_buffer, size_t buffer_length);
@@ -973,6 +1039,9 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // IETF frame appending methods.  All methods append the type byte as well.
   bool AppendIetfStreamFrame(const QuicStreamFrame& frame,
                              bool last_frame_in_packet, QuicDataWriter* writer);
+  bool AppendIetfStreamFrameHeader(const QuicStreamFrame& frame,
+                                   bool last_frame_in_packet,
+                                   QuicDataWriter* writer);
   bool AppendIetfConnectionCloseFrame(const QuicConnectionCloseFrame& frame,
                                       QuicDataWriter* writer);
   bool AppendPathChallengeFrame(const QuicPathChallengeFrame& frame,
@@ -1134,6 +1203,21 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // Decrypter for the next key phase. May be null if next keys haven't been
   // generated yet.
   std::unique_ptr<QuicDecrypter> next_decrypter_;
+  // Encrypter for the next key phase. Only set by DeriveNextOneRttKeys().
+  std::unique_ptr<QuicEncrypter> next_encrypter_;
+  // Cumulative counterparts of potential_peer_key_update_attempt_count_, for
+  // stats only.
+  QuicPacketCount key_update_trial_decryption_count_ = 0;
+  QuicPacketCount failed_key_update_trial_decryption_count_ = 0;
+  uint32_t pre_derived_key_update_count_ = 0;
+
+  // Header protection samples of 1-RTT packets and their masks, computed by
+  // PrecomputeHeaderProtectionMasks() with the current 1-RTT decrypter, one
+  // per kHeaderProtectionSampleLength bytes.
+  std::string precomputed_header_protection_samples_;
+  std::string precomputed_header_protection_masks_;
+  // Offset of the sample of the next packet expected to be processed.
+  size_t next_precomputed_header_protection_sample_ = 0;
 
   // If this is a framer of a connection, this is the packet number of first
   // sending packet. If this is a framer of a framer of dispatcher, this is the
@@ -1144,6 +1228,9 @@ class QUIC_EXPORT_PRIVATE QuicFramer {
   // owned. TODO(fayang): Consider add data producer to framer's constructor.
   QuicStreamFrameDataProducer* data_producer_;
 
+  // If not null, times packet parsing, decryption and encryption. Not owned.
+  QuicCpuProfiler* cpu_profiler_ = nullptr;
+
   // Whether we are in the middle of a call to this->ProcessPacket.
   bool is_processing_packet_ = false;
 
@@ -17,6 +17,8 @@
 #include "absl/strings/escaping.h"
 #include "absl/strings/match.h"
 #include "absl/strings/string_view.h"
+#include "absl/types/span.h"
+#include "quiche/quic/core/crypto/crypto_utils.h"
 #include "quiche/quic/core/crypto/null_decrypter.h"
 #include "quiche/quic/core/crypto/null_encrypter.h"
 #include "quiche/quic/core/crypto/quic_decrypter.h"
@@ -7395,6 +7397,31 @@ TEST_P(QuicFramerTest, BuildVersionNegotiationPacketWithClientConnectionId) {
       ABSL_ARRAYSIZE(packet));
 }
 
+TEST_P(QuicFramerTest, BuildIetfRetryPacket) {
+  if (!framer_.version().UsesTls()) {
+    return;
+  }
+  const QuicConnectionId original_connection_id = FramerTestConnectionId();
+  const QuicConnectionId server_connection_id = FramerTestConnectionIdPlusOne();
+  std::unique_ptr<QuicEncryptedPacket> data(QuicFramer::BuildIetfRetryPacket(
+      framer_.version(), EmptyQuicConnectionId(), server_connection_id,
+      original_connection_id, "Hello this is RETRY!"));
+  ASSERT_TRUE(data != nullptr);
+
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  EXPECT_TRUE(framer_.ProcessPacket(*data));
+  EXPECT_THAT(framer_.error(), IsQuicNoError());
+  ASSERT_TRUE(visitor_.on_retry_packet_called_);
+  EXPECT_EQ(server_connection_id, *visitor_.retry_new_connection_id_);
+  EXPECT_EQ("Hello this is RETRY!", *visitor_.retry_token_);
+  EXPECT_TRUE(CryptoUtils::ValidateRetryIntegrityTag(
+      framer_.version(), original_connection_id, *visitor_.retry_without_tag_,
+      *visitor_.retry_token_integrity_tag_));
+  EXPECT_FALSE(CryptoUtils::ValidateRetryIntegrityTag(
+      framer_.version(), server_connection_id, *visitor_.retry_without_tag_,
+      *visitor_.retry_token_integrity_tag_));
+}
+
 TEST_P(QuicFramerTest, BuildAckFramePacketOneAckBlock) {
   QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
   QuicPacketHeader header;
@@ -16213,6 +16240,76 @@ TEST_P(QuicFramerTest, KeyUpdateLocallyInitiated) {
   EXPECT_EQ(1, visitor_.decrypted_first_packet_in_key_phase_count_);
 }
 
+TEST_P(QuicFramerTest, KeyUpdateWithPreDerivedKeys) {
+  if (!framer_.version().UsesTls()) {
+    // Key update is only used in QUIC+TLS.
+    return;
+  }
+  ASSERT_TRUE(framer_.version().KnowsWhichDecrypterToUse());
+  framer_.InstallDecrypter(ENCRYPTION_FORWARD_SECURE,
+                           std::make_unique<StrictTaggingDecrypter>(/*key=*/0));
+  framer_.SetKeyUpdateSupportForConnection(true);
+
+  EXPECT_TRUE(framer_.DeriveNextOneRttKeys());
+  EXPECT_EQ(1, visitor_.derive_next_key_count_);
+  // The keys are only derived once.
+  EXPECT_TRUE(framer_.DeriveNextOneRttKeys());
+  EXPECT_EQ(1, visitor_.derive_next_key_count_);
+
+  QuicPacketHeader header;
+  header.destination_connection_id = FramerTestConnectionId();
+  header.reset_flag = false;
+  header.version_flag = false;
+  header.packet_number = kPacketNumber;
+
+  QuicFrames frames = {QuicFrame(QuicPaddingFrame())};
+
+  // The peer initiates a key update, which uses the derived keys.
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  std::unique_ptr<QuicPacket> data(BuildDataPacket(header, frames));
+  ASSERT_TRUE(data != nullptr);
+  std::unique_ptr<QuicEncryptedPacket> encrypted(
+      EncryptPacketWithTagAndPhase(*data, 1, true));
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  ASSERT_EQ(1u, visitor_.key_update_count());
+  EXPECT_EQ(KeyUpdateReason::kRemote, visitor_.key_update_reasons_[0]);
+  EXPECT_EQ(1, visitor_.derive_next_key_count_);
+  EXPECT_EQ(1u, framer_.pre_derived_key_update_count());
+  EXPECT_EQ(1u, framer_.key_update_trial_decryption_count());
+  EXPECT_EQ(0u, framer_.failed_key_update_trial_decryption_count());
+
+  // A packet with the next key phase which does not decrypt with the next keys
+  // is a failed trial decryption. The next keys are derived on demand.
+  header.packet_number += 1;
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  data = BuildDataPacket(header, frames);
+  ASSERT_TRUE(data != nullptr);
+  encrypted = EncryptPacketWithTagAndPhase(*data, 1, false);
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_FALSE(framer_.ProcessPacket(*encrypted));
+  EXPECT_EQ(1u, visitor_.key_update_count());
+  EXPECT_EQ(2, visitor_.derive_next_key_count_);
+  EXPECT_EQ(2u, framer_.key_update_trial_decryption_count());
+  EXPECT_EQ(1u, framer_.failed_key_update_trial_decryption_count());
+
+  // Deriving the rest of the next keys does not advance the secrets again.
+  EXPECT_TRUE(framer_.DeriveNextOneRttKeys());
+  EXPECT_EQ(2, visitor_.derive_next_key_count_);
+  EXPECT_TRUE(framer_.DoKeyUpdate(KeyUpdateReason::kLocalForTests));
+  EXPECT_EQ(2u, visitor_.key_update_count());
+  EXPECT_EQ(2, visitor_.derive_next_key_count_);
+  EXPECT_EQ(2u, framer_.pre_derived_key_update_count());
+
+  // A locally initiated key update without derived keys derives them.
+  EXPECT_TRUE(framer_.DoKeyUpdate(KeyUpdateReason::kLocalForTests));
+  EXPECT_EQ(3u, visitor_.key_update_count());
+  EXPECT_EQ(3, visitor_.derive_next_key_count_);
+  EXPECT_EQ(2u, framer_.pre_derived_key_update_count());
+}
+
 TEST_P(QuicFramerTest, KeyUpdateLocallyInitiatedReceivedOldPacket) {
   if (!framer_.version().UsesTls()) {
     // Key update is only used in QUIC+TLS.
@@ -16368,6 +16465,82 @@ TEST_P(QuicFramerTest, ErrorWhenUnexpectedFrameTypeEncountered) {
       framer_.detailed_error());
 }
 
+// Counts the header protection masks computed one at a time.
+class MaskCountingDecrypter : public StrictTaggingDecrypter {
+ public:
+  using StrictTaggingDecrypter::StrictTaggingDecrypter;
+
+  std::string GenerateHeaderProtectionMask(
+      QuicDataReader* sample_reader) override {
+    ++num_masks_;
+    return StrictTaggingDecrypter::GenerateHeaderProtectionMask(sample_reader);
+  }
+
+  int num_masks_ = 0;
+};
+
+TEST_P(QuicFramerTest, PrecomputedHeaderProtectionMasks) {
+  if (!framer_.version().UsesTls()) {
+    return;
+  }
+  auto decrypter = std::make_unique<MaskCountingDecrypter>(/*key=*/0);
+  MaskCountingDecrypter* decrypter_ptr = decrypter.get();
+  framer_.InstallDecrypter(ENCRYPTION_FORWARD_SECURE, std::move(decrypter));
+
+  QuicPacketHeader header;
+  header.destination_connection_id = FramerTestConnectionId();
+  header.reset_flag = false;
+  header.version_flag = false;
+  header.packet_number = kPacketNumber;
+  QuicFrames frames = {QuicFrame(QuicPaddingFrame())};
+
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  std::vector<std::unique_ptr<QuicEncryptedPacket>> packets;
+  std::vector<absl::string_view> contents;
+  for (int i = 0; i < 4; ++i) {
+    std::unique_ptr<QuicPacket> data(BuildDataPacket(header, frames));
+    ASSERT_TRUE(data != nullptr);
+    packets.push_back(EncryptPacketWithTagAndPhase(*data, 0, false));
+    ASSERT_TRUE(packets.back());
+    contents.push_back(packets.back()->AsStringPiece());
+    header.packet_number += 1;
+  }
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+
+  // The masks of the first three packets are computed at once.
+  framer_.PrecomputeHeaderProtectionMasks(
+      absl::MakeConstSpan(contents.data(), 3));
+  EXPECT_EQ(3, decrypter_ptr->num_masks_);
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_TRUE(framer_.ProcessPacket(*packets[i]));
+  }
+  EXPECT_EQ(3, decrypter_ptr->num_masks_);
+  EXPECT_TRUE(framer_.ProcessPacket(*packets[3]));
+  EXPECT_EQ(4, decrypter_ptr->num_masks_);
+
+  // A single packet is not worth batching.
+  framer_.PrecomputeHeaderProtectionMasks(
+      absl::MakeConstSpan(contents.data(), 1));
+  EXPECT_EQ(4, decrypter_ptr->num_masks_);
+
+  // Masks computed with a decrypter which has since been replaced are dropped.
+  framer_.PrecomputeHeaderProtectionMasks(contents);
+  EXPECT_EQ(8, decrypter_ptr->num_masks_);
+  decrypter = std::make_unique<MaskCountingDecrypter>(/*key=*/0);
+  decrypter_ptr = decrypter.get();
+  framer_.InstallDecrypter(ENCRYPTION_FORWARD_SECURE, std::move(decrypter));
+  header.packet_number += 1;
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_CLIENT);
+  std::unique_ptr<QuicPacket> data(BuildDataPacket(header, frames));
+  ASSERT_TRUE(data != nullptr);
+  std::unique_ptr<QuicEncryptedPacket> encrypted =
+      EncryptPacketWithTagAndPhase(*data, 0, false);
+  ASSERT_TRUE(encrypted);
+  QuicFramerPeer::SetPerspective(&framer_, Perspective::IS_SERVER);
+  EXPECT_TRUE(framer_.ProcessPacket(*encrypted));
+  EXPECT_EQ(1, decrypter_ptr->num_masks_);
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
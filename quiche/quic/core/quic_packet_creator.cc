@@ -24,6 +24,7 @@
 #include "quiche/quic/core/quic_chaos_protector.h"
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_cpu_profiler.h"
 #include "quiche/quic/core/quic_data_writer.h"
 #include "quiche/quic/core/quic_error_codes.h"
 #include "quiche/quic/core/quic_types.h"
@@ -631,11 +632,30 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
   // TODO(ianswett): AppendTypeByte and AppendStreamFrame could be optimized
   // into one method that takes a QuicStreamFrame, if warranted.
   bool omit_frame_length = !needs_padding;
+  // If the stream data ends the packet and is contiguous in the send buffer,
+  // it is encrypted straight from there into |encrypted_buffer| rather than
+  // copied into it as plaintext first.
+  absl::string_view stream_data;
+  if (omit_frame_length && bytes_consumed > 0 &&
+      framer_->data_producer() != nullptr &&
+      GetQuicReloadableFlag(quic_encrypt_stream_data_from_send_buffer)) {
+    stream_data = framer_->data_producer()->GetContiguousStreamData(
+        id, stream_offset, bytes_consumed);
+  }
   if (!framer_->AppendTypeByte(QuicFrame(frame), omit_frame_length, &writer)) {
     QUIC_BUG(quic_bug_10752_10) << ENDPOINT << "AppendTypeByte failed";
     return;
   }
-  if (!framer_->AppendStreamFrame(frame, omit_frame_length, &writer)) {
+  if (!stream_data.empty()) {
+    QUIC_RELOADABLE_FLAG_COUNT(quic_encrypt_stream_data_from_send_buffer);
+    // Leave room for the stream data, so that the long header length is right.
+    if (!framer_->AppendStreamFrameHeader(frame, omit_frame_length, &writer) ||
+        !writer.Seek(stream_data.length())) {
+      QUIC_BUG(quic_bug_10752_40)
+          << ENDPOINT << "AppendStreamFrameHeader failed";
+      return;
+    }
+  } else if (!framer_->AppendStreamFrame(frame, omit_frame_length, &writer)) {
     QUIC_BUG(quic_bug_10752_11) << ENDPOINT << "AppendStreamFrame failed";
     return;
   }
@@ -657,10 +677,18 @@ void QuicPacketCreator::CreateAndSerializeStreamFrame(
   QUICHE_DCHECK(packet_.encryption_level == ENCRYPTION_FORWARD_SECURE ||
                 packet_.encryption_level == ENCRYPTION_ZERO_RTT)
       << ENDPOINT << packet_.encryption_level;
-  size_t encrypted_length = framer_->EncryptInPlace(
-      packet_.encryption_level, packet_.packet_number,
-      GetStartOfEncryptedData(framer_->transport_version(), header),
-      writer.length(), kMaxOutgoingPacketSize, encrypted_buffer);
+  const size_t ad_length =
+      GetStartOfEncryptedData(framer_->transport_version(), header);
+  size_t encrypted_length =
+      stream_data.empty()
+          ? framer_->EncryptInPlace(packet_.encryption_level,
+                                    packet_.packet_number, ad_length,
+                                    writer.length(), kMaxOutgoingPacketSize,
+                                    encrypted_buffer)
+          : framer_->EncryptInPlaceWithExtraPlaintext(
+                packet_.encryption_level, packet_.packet_number, ad_length,
+                writer.length(), kMaxOutgoingPacketSize, encrypted_buffer,
+                stream_data);
   if (encrypted_length == 0) {
     QUIC_BUG(quic_bug_10752_13)
         << ENDPOINT << "Failed to encrypt packet number "
@@ -777,6 +805,8 @@ QuicPacketCreator::MaybeBuildDataPacketWithChaosProtection(
 bool QuicPacketCreator::SerializePacket(QuicOwnedPacketBuffer encrypted_buffer,
                                         size_t encrypted_buffer_len,
                                         bool allow_padding) {
+  QuicCpuProfiler::ScopedTimer timer(cpu_profiler_,
+                                     QuicCpuProfileCategory::kPacketCreation);
   if (packet_.encrypted_buffer != nullptr) {
     const std::string error_details =
         "Packet's encrypted buffer is not empty before serialization";
@@ -424,6 +424,10 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
     debug_delegate_ = debug_delegate;
   }
 
+  void set_cpu_profiler(QuicCpuProfiler* cpu_profiler) {
+    cpu_profiler_ = cpu_profiler;
+  }
+
   QuicByteCount pending_padding_bytes() const { return pending_padding_bytes_; }
 
   ParsedQuicVersion version() const { return framer_->version(); }
@@ -620,6 +624,8 @@ class QUIC_EXPORT_PRIVATE QuicPacketCreator {
   DebugDelegate* debug_delegate_;
   QuicFramer* framer_;
   QuicRandom* random_;
+  // If not null, times packet serialization.
+  QuicCpuProfiler* cpu_profiler_ = nullptr;
 
   // Controls whether version should be included while serializing the packet.
   // send_version_in_packet_ should never be read directly, use
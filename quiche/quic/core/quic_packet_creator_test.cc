@@ -2949,6 +2949,38 @@ TEST_F(QuicPacketCreatorMultiplePacketsTest, ConsumeDataFastPath) {
   EXPECT_EQ(10000u, stream_frame.data_length + stream_frame.offset);
 }
 
+TEST_F(QuicPacketCreatorMultiplePacketsTest,
+       ConsumeDataFastPathEncryptsFromSendBuffer) {
+  SetQuicReloadableFlag(quic_encrypt_stream_data_from_send_buffer, true);
+  delegate_.SetCanWriteAnything();
+
+  // Some of the stream frames span send buffer slices and are copied.
+  std::string data(10000, '?');
+  for (size_t i = 0; i < data.size(); ++i) {
+    data[i] = 'a' + i % 26;
+  }
+  EXPECT_CALL(delegate_, OnSerializedPacket(_))
+      .WillRepeatedly(
+          Invoke(this, &QuicPacketCreatorMultiplePacketsTest::SavePacket));
+  QuicConsumedData consumed = creator_.ConsumeDataFastPath(
+      QuicUtils::GetFirstBidirectionalStreamId(framer_.transport_version(),
+                                               Perspective::IS_CLIENT),
+      data);
+  EXPECT_EQ(10000u, consumed.bytes_consumed);
+  EXPECT_TRUE(consumed.fin_consumed);
+
+  std::string received;
+  for (const SerializedPacket& packet : packets_) {
+    ASSERT_TRUE(simple_framer_.ProcessPacket(
+        QuicEncryptedPacket(packet.encrypted_buffer, packet.encrypted_length)));
+    ASSERT_EQ(1u, simple_framer_.stream_frames().size());
+    const QuicStreamFrame& frame = *simple_framer_.stream_frames()[0];
+    EXPECT_EQ(received.size(), frame.offset);
+    received.append(frame.data_buffer, frame.data_length);
+  }
+  EXPECT_EQ(data, received);
+}
+
 TEST_F(QuicPacketCreatorMultiplePacketsTest, ConsumeDataLarge) {
   delegate_.SetCanWriteAnything();
 
@@ -5,6 +5,8 @@
 #include "quiche/quic/core/quic_packet_reader.h"
 
 #include "absl/base/macros.h"
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/core/quic_process_packet_interface.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
@@ -56,6 +58,22 @@ bool QuicPacketReader::ReadAndDispatchPackets(
                 QuicUdpPacketInfoBit::RECV_TIMESTAMP, QuicUdpPacketInfoBit::TTL,
                 QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER),
       &read_results_);
+
+  // Let |processor| batch work across the packets, e.g. per connection.
+  absl::string_view packet_contents[kNumPacketsPerReadMmsgCall];
+  size_t num_packets = 0;
+  for (size_t i = 0;
+       i < packets_read && num_packets < kNumPacketsPerReadMmsgCall; ++i) {
+    if (read_results_[i].ok) {
+      packet_contents[num_packets++] =
+          absl::string_view(read_results_[i].packet_buffer.buffer,
+                            read_results_[i].packet_buffer.buffer_len);
+    }
+  }
+  if (num_packets > 1) {
+    processor->OnPacketsRead(absl::MakeConstSpan(packet_contents, num_packets));
+  }
+
   for (size_t i = 0; i < packets_read; ++i) {
     auto& result = read_results_[i];
     if (!result.ok) {
@@ -424,7 +424,8 @@ SerializedPacket::SerializedPacket(QuicPacketNumber packet_number,
       has_ack_frame_copy(false),
       has_ack_frequency(false),
       has_message(false),
-      fate(SEND_TO_WRITER) {}
+      fate(SEND_TO_WRITER),
+      path_id(kDefaultPathId) {}
 
 SerializedPacket::SerializedPacket(SerializedPacket&& other)
     : has_crypto_handshake(other.has_crypto_handshake),
@@ -439,7 +440,8 @@ SerializedPacket::SerializedPacket(SerializedPacket&& other)
       has_ack_frequency(other.has_ack_frequency),
       has_message(other.has_message),
       fate(other.fate),
-      peer_address(other.peer_address) {
+      peer_address(other.peer_address),
+      path_id(other.path_id) {
   if (this != &other) {
     if (release_encrypted_buffer && encrypted_buffer != nullptr) {
       release_encrypted_buffer(encrypted_buffer);
@@ -486,6 +488,7 @@ SerializedPacket* CopySerializedPacket(const SerializedPacket& serialized,
   copy->has_message = serialized.has_message;
   copy->fate = serialized.fate;
   copy->peer_address = serialized.peer_address;
+  copy->path_id = serialized.path_id;
 
   if (copy_buffer) {
     copy->encrypted_buffer = CopyBuffer(serialized);
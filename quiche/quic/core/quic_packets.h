@@ -376,6 +376,8 @@ struct QUIC_EXPORT_PRIVATE SerializedPacket {
   bool has_message;
   SerializedPacketFate fate;
   QuicSocketAddress peer_address;
+  // The path this packet is sent on when multipath is in use.
+  QuicPathId path_id;
 };
 
 // Make a copy of |serialized| (including the underlying frames). |copy_buffer|
@@ -0,0 +1,118 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_path_scheduler.h"
+
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+
+namespace {
+
+QuicPathId SelectMinRttPath(
+    absl::Span<const QuicPathScheduler::PathInfo> paths) {
+  const QuicPathScheduler::PathInfo* best = nullptr;
+  for (const QuicPathScheduler::PathInfo& path : paths) {
+    if (path.can_send &&
+        (best == nullptr || path.smoothed_rtt < best->smoothed_rtt)) {
+      best = &path;
+    }
+  }
+  return best == nullptr ? kInvalidPathId : best->path_id;
+}
+
+class MinRttPathScheduler : public QuicPathScheduler {
+ public:
+  QuicPathId SelectPath(absl::Span<const PathInfo> paths) override {
+    return SelectMinRttPath(paths);
+  }
+  bool DuplicatesPackets() const override { return false; }
+  QuicPathSchedulerType GetType() const override {
+    return QuicPathSchedulerType::kMinRtt;
+  }
+};
+
+class RoundRobinPathScheduler : public QuicPathScheduler {
+ public:
+  QuicPathId SelectPath(absl::Span<const PathInfo> paths) override {
+    // Pick the first path which can send after the previously selected one,
+    // wrapping around.
+    const PathInfo* first = nullptr;
+    const PathInfo* next = nullptr;
+    for (const PathInfo& path : paths) {
+      if (!path.can_send) {
+        continue;
+      }
+      if (first == nullptr || path.path_id < first->path_id) {
+        first = &path;
+      }
+      if (path.path_id > last_path_id_ &&
+          (next == nullptr || path.path_id < next->path_id)) {
+        next = &path;
+      }
+    }
+    const PathInfo* selected = next != nullptr ? next : first;
+    if (selected == nullptr) {
+      return kInvalidPathId;
+    }
+    last_path_id_ = selected->path_id;
+    return last_path_id_;
+  }
+  bool DuplicatesPackets() const override { return false; }
+  QuicPathSchedulerType GetType() const override {
+    return QuicPathSchedulerType::kRoundRobin;
+  }
+
+ private:
+  QuicPathId last_path_id_ = kInvalidPathId;
+};
+
+class RedundantPathScheduler : public QuicPathScheduler {
+ public:
+  QuicPathId SelectPath(absl::Span<const PathInfo> paths) override {
+    return SelectMinRttPath(paths);
+  }
+  bool DuplicatesPackets() const override { return true; }
+  QuicPathSchedulerType GetType() const override {
+    return QuicPathSchedulerType::kRedundant;
+  }
+};
+
+}  // namespace
+
+std::string QuicPathSchedulerTypeToString(QuicPathSchedulerType type) {
+  switch (type) {
+    case QuicPathSchedulerType::kMinRtt:
+      return "MIN_RTT";
+    case QuicPathSchedulerType::kRoundRobin:
+      return "ROUND_ROBIN";
+    case QuicPathSchedulerType::kRedundant:
+      return "REDUNDANT";
+  }
+  return "INVALID_PATH_SCHEDULER_TYPE";
+}
+
+std::ostream& operator<<(std::ostream& os, QuicPathSchedulerType type) {
+  os << QuicPathSchedulerTypeToString(type);
+  return os;
+}
+
+// static
+std::unique_ptr<QuicPathScheduler> QuicPathScheduler::Create(
+    QuicPathSchedulerType type) {
+  switch (type) {
+    case QuicPathSchedulerType::kMinRtt:
+      return std::make_unique<MinRttPathScheduler>();
+    case QuicPathSchedulerType::kRoundRobin:
+      return std::make_unique<RoundRobinPathScheduler>();
+    case QuicPathSchedulerType::kRedundant:
+      return std::make_unique<RedundantPathScheduler>();
+  }
+  QUIC_BUG(quic_bug_10433_1) << "Unknown path scheduler type "
+                             << static_cast<int>(type);
+  return std::make_unique<MinRttPathScheduler>();
+}
+
+}  // namespace quic
@@ -0,0 +1,63 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_PATH_SCHEDULER_H_
+#define QUICHE_QUIC_CORE_QUIC_PATH_SCHEDULER_H_
+
+#include <cstdint>
+#include <memory>
+#include <ostream>
+#include <string>
+
+#include "absl/types/span.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/core/quic_types.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+enum class QuicPathSchedulerType : uint8_t {
+  // Sends each packet on the path with the lowest smoothed RTT among the paths
+  // whose congestion controller allows sending.
+  kMinRtt,
+  // Takes turns among the paths whose congestion controller allows sending.
+  kRoundRobin,
+  // Like kMinRtt, and also sends a copy of each packet on the other paths.
+  kRedundant,
+};
+
+QUIC_EXPORT_PRIVATE std::string QuicPathSchedulerTypeToString(
+    QuicPathSchedulerType type);
+
+QUIC_EXPORT_PRIVATE std::ostream& operator<<(std::ostream& os,
+                                             QuicPathSchedulerType type);
+
+// Decides which path each packet of a multipath connection is sent on.
+class QUIC_EXPORT_PRIVATE QuicPathScheduler {
+ public:
+  struct QUIC_EXPORT_PRIVATE PathInfo {
+    QuicPathId path_id = kInvalidPathId;
+    QuicTime::Delta smoothed_rtt = QuicTime::Delta::Zero();
+    // Whether the path's congestion controller and pacer allow sending now.
+    bool can_send = false;
+  };
+
+  static std::unique_ptr<QuicPathScheduler> Create(QuicPathSchedulerType type);
+
+  virtual ~QuicPathScheduler() {}
+
+  // Returns the path to send the next packet on, or kInvalidPathId if none of
+  // |paths| can send.
+  virtual QuicPathId SelectPath(absl::Span<const PathInfo> paths) = 0;
+
+  // Returns true if a copy of each packet is also sent on the other paths.
+  virtual bool DuplicatesPackets() const = 0;
+
+  virtual QuicPathSchedulerType GetType() const = 0;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_PATH_SCHEDULER_H_
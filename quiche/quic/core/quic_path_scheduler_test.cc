@@ -0,0 +1,84 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_path_scheduler.h"
+
+#include <memory>
+#include <vector>
+
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+using PathInfo = QuicPathScheduler::PathInfo;
+
+PathInfo Path(QuicPathId path_id, int64_t smoothed_rtt_ms, bool can_send) {
+  return {path_id, QuicTime::Delta::FromMilliseconds(smoothed_rtt_ms),
+          can_send};
+}
+
+class QuicPathSchedulerTest : public QuicTest {};
+
+TEST_F(QuicPathSchedulerTest, MinRtt) {
+  std::unique_ptr<QuicPathScheduler> scheduler =
+      QuicPathScheduler::Create(QuicPathSchedulerType::kMinRtt);
+  EXPECT_EQ(QuicPathSchedulerType::kMinRtt, scheduler->GetType());
+  EXPECT_FALSE(scheduler->DuplicatesPackets());
+
+  std::vector<PathInfo> paths = {Path(0, 50, true), Path(1, 20, true),
+                                 Path(2, 30, true)};
+  EXPECT_EQ(1u, scheduler->SelectPath(paths));
+  EXPECT_EQ(1u, scheduler->SelectPath(paths));
+
+  // Falls back to the next fastest path when the fastest is cwnd limited.
+  paths[1].can_send = false;
+  EXPECT_EQ(2u, scheduler->SelectPath(paths));
+
+  paths[0].can_send = false;
+  paths[2].can_send = false;
+  EXPECT_EQ(kInvalidPathId, scheduler->SelectPath(paths));
+}
+
+TEST_F(QuicPathSchedulerTest, RoundRobin) {
+  std::unique_ptr<QuicPathScheduler> scheduler =
+      QuicPathScheduler::Create(QuicPathSchedulerType::kRoundRobin);
+  EXPECT_EQ(QuicPathSchedulerType::kRoundRobin, scheduler->GetType());
+  EXPECT_FALSE(scheduler->DuplicatesPackets());
+
+  std::vector<PathInfo> paths = {Path(0, 50, true), Path(1, 20, true),
+                                 Path(3, 30, true)};
+  EXPECT_EQ(0u, scheduler->SelectPath(paths));
+  EXPECT_EQ(1u, scheduler->SelectPath(paths));
+  EXPECT_EQ(3u, scheduler->SelectPath(paths));
+  EXPECT_EQ(0u, scheduler->SelectPath(paths));
+
+  // Skips the paths which cannot send.
+  paths[1].can_send = false;
+  EXPECT_EQ(3u, scheduler->SelectPath(paths));
+  EXPECT_EQ(0u, scheduler->SelectPath(paths));
+  EXPECT_EQ(3u, scheduler->SelectPath(paths));
+
+  paths[0].can_send = false;
+  paths[2].can_send = false;
+  EXPECT_EQ(kInvalidPathId, scheduler->SelectPath(paths));
+}
+
+TEST_F(QuicPathSchedulerTest, Redundant) {
+  std::unique_ptr<QuicPathScheduler> scheduler =
+      QuicPathScheduler::Create(QuicPathSchedulerType::kRedundant);
+  EXPECT_EQ(QuicPathSchedulerType::kRedundant, scheduler->GetType());
+  EXPECT_TRUE(scheduler->DuplicatesPackets());
+
+  std::vector<PathInfo> paths = {Path(0, 50, true), Path(1, 20, false)};
+  EXPECT_EQ(0u, scheduler->SelectPath(paths));
+  paths[1].can_send = true;
+  EXPECT_EQ(1u, scheduler->SelectPath(paths));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -5,6 +5,8 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_PROCESS_PACKET_INTERFACE_H_
 #define QUICHE_QUIC_CORE_QUIC_PROCESS_PACKET_INTERFACE_H_
 
+#include "absl/strings/string_view.h"
+#include "absl/types/span.h"
 #include "quiche/quic/core/quic_packets.h"
 #include "quiche/quic/platform/api/quic_socket_address.h"
 
@@ -17,6 +19,11 @@ class QUIC_NO_EXPORT ProcessPacketInterface {
   virtual void ProcessPacket(const QuicSocketAddress& self_address,
                              const QuicSocketAddress& peer_address,
                              const QuicReceivedPacket& packet) = 0;
+
+  // Called with the contents of a burst of packets read at once, before
+  // ProcessPacket() is called for each of them, so that work common to several
+  // packets can be batched.
+  virtual void OnPacketsRead(absl::Span<const absl::string_view> /*packets*/) {}
 };
 
 }  // namespace quic
@@ -215,4 +215,9 @@ QUIC_PROTOCOL_FLAG(
 
 QUIC_PROTOCOL_FLAG(bool, quic_use_lower_server_response_mtu_for_test, false,
                    "If true, cap server response packet size at 1250.")
+
+QUIC_PROTOCOL_FLAG(
+    int64_t, quic_cpu_profile_sample_interval, 0,
+    "If positive, QUIC connections time one in this many hot-path operations "
+    "and report the CPU time per category in QuicConnectionStats.")
 #endif
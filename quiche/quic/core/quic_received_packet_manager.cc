@@ -331,7 +331,8 @@ void QuicReceivedPacketManager::OnAckFrequencyFrame(
   }
   last_ack_frequency_frame_sequence_number_ = new_sequence_number;
   ack_frequency_ = frame.packet_tolerance;
-  local_max_ack_delay_ = frame.max_ack_delay;
+  // Avoid arming the ACK alarm more often than its granularity allows.
+  local_max_ack_delay_ = std::max(frame.max_ack_delay, kAlarmGranularity);
   ignore_order_ = frame.ignore_order;
 }
 
@@ -539,6 +539,19 @@ TEST_F(QuicReceivedPacketManagerTest,
   }
 }
 
+TEST_F(QuicReceivedPacketManagerTest,
+       AckFrequencyFrameMaxAckDelayIsAtLeastAlarmGranularity) {
+  QuicAckFrequencyFrame frame;
+  frame.sequence_number = 1;
+  frame.max_ack_delay = QuicTime::Delta::FromMicroseconds(100);
+  frame.packet_tolerance = 10;
+  received_manager_.OnAckFrequencyFrame(frame);
+
+  RecordPacketReceipt(1, clock_.ApproximateNow());
+  MaybeUpdateAckTimeout(kInstigateAck, 1);
+  CheckAckTimeout(clock_.ApproximateNow() + kAlarmGranularity);
+}
+
 TEST_F(QuicReceivedPacketManagerTest,
        DisableOutOfOrderAckByIgnoreOrderFromAckFrequencyFrame) {
   EXPECT_FALSE(HasPendingAck());
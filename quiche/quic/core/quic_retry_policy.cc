@@ -0,0 +1,94 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_retry_policy.h"
+
+#include <algorithm>
+#include <memory>
+
+namespace quic {
+
+namespace {
+
+const QuicTime::Delta kRateWindow = QuicTime::Delta::FromSeconds(1);
+
+}  // namespace
+
+QuicRetryPolicy::QuicRetryPolicy(const Config& config)
+    : config_(config),
+      new_connections_per_prefix_(
+          std::max<size_t>(1, config.max_tracked_prefixes)) {}
+
+bool QuicRetryPolicy::ShouldRetry(const QuicIpAddress& client_address,
+                                  size_t num_buffered_chlos, QuicTime now) {
+  // Account for the connection globally and per prefix even if another
+  // threshold is already exceeded, so that the rates stay accurate.
+  bool should_retry = config_.max_buffered_chlos > 0 &&
+                      num_buffered_chlos >= config_.max_buffered_chlos;
+
+  const uint64_t rate = new_connections_.CountEvent(now);
+  if (config_.max_new_connections_per_second > 0 &&
+      rate > config_.max_new_connections_per_second) {
+    should_retry = true;
+  }
+
+  if (config_.max_new_connections_per_prefix_per_second > 0) {
+    const std::string prefix = PrefixOf(client_address);
+    auto it = new_connections_per_prefix_.Lookup(prefix);
+    if (it == new_connections_per_prefix_.end()) {
+      new_connections_per_prefix_.Insert(prefix,
+                                         std::make_unique<RateCounter>());
+      it = new_connections_per_prefix_.Lookup(prefix);
+    }
+    if (it->second->CountEvent(now) >
+        config_.max_new_connections_per_prefix_per_second) {
+      should_retry = true;
+    }
+  }
+  return should_retry;
+}
+
+std::string QuicRetryPolicy::PrefixOf(const QuicIpAddress& address) const {
+  const QuicIpAddress normalized = address.Normalized();
+  std::string prefix = normalized.ToPackedString();
+  const size_t prefix_length = normalized.IsIPv4()
+                                   ? config_.ipv4_prefix_length
+                                   : config_.ipv6_prefix_length;
+  for (size_t i = 0; i < prefix.length(); ++i) {
+    if (prefix_length >= 8 * (i + 1)) {
+      continue;
+    }
+    if (prefix_length <= 8 * i) {
+      prefix[i] = 0;
+    } else {
+      prefix[i] &= static_cast<char>(0xff << (8 * (i + 1) - prefix_length));
+    }
+  }
+  return prefix;
+}
+
+uint64_t QuicRetryPolicy::RateCounter::CountEvent(QuicTime now) {
+  if (now - window_start_ >= kRateWindow + kRateWindow) {
+    // Both windows are stale.
+    window_start_ = now;
+    previous_window_count_ = 0;
+    current_window_count_ = 0;
+  } else if (now - window_start_ >= kRateWindow) {
+    window_start_ = window_start_ + kRateWindow;
+    previous_window_count_ = current_window_count_;
+    current_window_count_ = 0;
+  }
+  ++current_window_count_;
+
+  // Weigh the previous window by the fraction of it which is less than a
+  // second before |now|.
+  const QuicTime::Delta elapsed = now - window_start_;
+  const uint64_t previous_window_weight_us =
+      (kRateWindow - elapsed).ToMicroseconds();
+  return current_window_count_ +
+         previous_window_count_ * previous_window_weight_us /
+             kRateWindow.ToMicroseconds();
+}
+
+}  // namespace quic
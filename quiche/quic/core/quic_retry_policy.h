@@ -0,0 +1,80 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_CORE_QUIC_RETRY_POLICY_H_
+#define QUICHE_QUIC_CORE_QUIC_RETRY_POLICY_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+#include "quiche/quic/core/quic_lru_cache.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/quic/platform/api/quic_ip_address.h"
+
+namespace quic {
+
+// QuicRetryPolicy decides whether QuicDispatcher answers a client Initial
+// which does not carry a valid address validation token with a RETRY, instead
+// of starting a handshake. It only does so under load: when the rate of such
+// Initials, from all clients or from one address prefix, or the number of
+// CHLOs waiting for a session exceeds its thresholds. Clients therefore only
+// pay for the extra round trip while the server needs to protect its
+// handshake CPU, e.g. from a flood of Initials with spoofed source addresses.
+class QUIC_EXPORT_PRIVATE QuicRetryPolicy {
+ public:
+  struct QUIC_EXPORT_PRIVATE Config {
+    // Initials without a valid token are retried while any of the following
+    // is exceeded. Zero disables the corresponding check.
+    uint32_t max_new_connections_per_second = 0;
+    uint32_t max_new_connections_per_prefix_per_second = 0;
+    size_t max_buffered_chlos = 0;
+    // New connections are accounted per address prefix of these lengths.
+    uint8_t ipv4_prefix_length = 24;
+    uint8_t ipv6_prefix_length = 48;
+    // Maximum number of prefixes accounted at once; the least recently seen
+    // prefix is forgotten first.
+    size_t max_tracked_prefixes = 4096;
+  };
+
+  explicit QuicRetryPolicy(const Config& config);
+  QuicRetryPolicy(const QuicRetryPolicy&) = delete;
+  QuicRetryPolicy& operator=(const QuicRetryPolicy&) = delete;
+
+  // Called for each Initial of a new connection from |client_address| which
+  // does not carry a valid token, when |num_buffered_chlos| CHLOs are waiting
+  // for a session. Accounts for the connection attempt and returns whether it
+  // should be retried.
+  bool ShouldRetry(const QuicIpAddress& client_address,
+                   size_t num_buffered_chlos, QuicTime now);
+
+  const Config& config() const { return config_; }
+
+ private:
+  // Estimates the number of events in the last second from the counts of the
+  // current and the previous one second window.
+  class QUIC_EXPORT_PRIVATE RateCounter {
+   public:
+    // Counts one event at |now| and returns the estimated number of events in
+    // the second up to |now|, including this one.
+    uint64_t CountEvent(QuicTime now);
+
+   private:
+    QuicTime window_start_ = QuicTime::Zero();
+    uint64_t current_window_count_ = 0;
+    uint64_t previous_window_count_ = 0;
+  };
+
+  // Returns the prefix of |address| which new connections are accounted by.
+  std::string PrefixOf(const QuicIpAddress& address) const;
+
+  const Config config_;
+  RateCounter new_connections_;
+  QuicLRUCache<std::string, RateCounter> new_connections_per_prefix_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_CORE_QUIC_RETRY_POLICY_H_
@@ -0,0 +1,122 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/core/quic_retry_policy.h"
+
+#include <string>
+
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+QuicIpAddress Address(const std::string& address) {
+  QuicIpAddress ip;
+  EXPECT_TRUE(ip.FromString(address));
+  return ip;
+}
+
+class QuicRetryPolicyTest : public QuicTest {
+ protected:
+  QuicRetryPolicyTest() {
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(10));
+  }
+
+  // Returns how many of |count| connection attempts from |address|, spread
+  // evenly over one second, are retried.
+  int CountRetries(QuicRetryPolicy* policy, const std::string& address,
+                   int count, size_t num_buffered_chlos = 0) {
+    int num_retries = 0;
+    for (int i = 0; i < count; ++i) {
+      if (policy->ShouldRetry(Address(address), num_buffered_chlos,
+                              clock_.Now())) {
+        ++num_retries;
+      }
+      clock_.AdvanceTime(QuicTime::Delta::FromMicroseconds(1000000 / count));
+    }
+    return num_retries;
+  }
+
+  MockClock clock_;
+  QuicRetryPolicy::Config config_;
+};
+
+TEST_F(QuicRetryPolicyTest, DisabledByDefault) {
+  QuicRetryPolicy policy(config_);
+  EXPECT_EQ(0, CountRetries(&policy, "192.0.2.1", 10000, 1000));
+}
+
+TEST_F(QuicRetryPolicyTest, NewConnectionRate) {
+  config_.max_new_connections_per_second = 100;
+  QuicRetryPolicy policy(config_);
+  EXPECT_EQ(0, CountRetries(&policy, "192.0.2.1", 90));
+  EXPECT_EQ(0, CountRetries(&policy, "192.0.2.1", 90));
+  // Once the rate goes up, most connections are retried.
+  EXPECT_LT(800, CountRetries(&policy, "192.0.2.1", 1000));
+  // Retries stop once the rate goes down again.
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1));
+  EXPECT_EQ(0, CountRetries(&policy, "192.0.2.1", 50));
+}
+
+TEST_F(QuicRetryPolicyTest, NewConnectionRatePerPrefix) {
+  config_.max_new_connections_per_prefix_per_second = 10;
+  QuicRetryPolicy policy(config_);
+  for (int i = 0; i < 10; ++i) {
+    EXPECT_FALSE(
+        policy.ShouldRetry(Address("192.0.2.1"), 0, clock_.Now()));
+  }
+  // Same /24.
+  EXPECT_TRUE(policy.ShouldRetry(Address("192.0.2.200"), 0, clock_.Now()));
+  EXPECT_TRUE(
+      policy.ShouldRetry(Address("::ffff:192.0.2.3"), 0, clock_.Now()));
+  // Other prefixes are not affected.
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.3.1"), 0, clock_.Now()));
+  EXPECT_FALSE(policy.ShouldRetry(Address("2001:db8::1"), 0, clock_.Now()));
+
+  for (int i = 0; i < 9; ++i) {
+    EXPECT_FALSE(policy.ShouldRetry(Address("2001:db8:0:ffff::1"), 0,
+                                    clock_.Now()));
+  }
+  // Same /48.
+  EXPECT_TRUE(policy.ShouldRetry(Address("2001:db8::2"), 0, clock_.Now()));
+  EXPECT_FALSE(policy.ShouldRetry(Address("2001:db9::1"), 0, clock_.Now()));
+
+  clock_.AdvanceTime(QuicTime::Delta::FromSeconds(2));
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.2.1"), 0, clock_.Now()));
+}
+
+TEST_F(QuicRetryPolicyTest, PrefixLength) {
+  config_.max_new_connections_per_prefix_per_second = 1;
+  config_.ipv4_prefix_length = 20;
+  QuicRetryPolicy policy(config_);
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.16.1"), 0, clock_.Now()));
+  EXPECT_TRUE(policy.ShouldRetry(Address("192.0.31.255"), 0, clock_.Now()));
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.32.1"), 0, clock_.Now()));
+}
+
+TEST_F(QuicRetryPolicyTest, MaxTrackedPrefixes) {
+  config_.max_new_connections_per_prefix_per_second = 1;
+  config_.max_tracked_prefixes = 2;
+  QuicRetryPolicy policy(config_);
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.1.1"), 0, clock_.Now()));
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.2.1"), 0, clock_.Now()));
+  EXPECT_TRUE(policy.ShouldRetry(Address("192.0.1.1"), 0, clock_.Now()));
+  // Evicts 192.0.2.0/24, which was seen least recently.
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.3.1"), 0, clock_.Now()));
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.2.1"), 0, clock_.Now()));
+}
+
+TEST_F(QuicRetryPolicyTest, BufferedChlos) {
+  config_.max_buffered_chlos = 10;
+  QuicRetryPolicy policy(config_);
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.2.1"), 9, clock_.Now()));
+  EXPECT_TRUE(policy.ShouldRetry(Address("192.0.2.1"), 10, clock_.Now()));
+  EXPECT_FALSE(policy.ShouldRetry(Address("192.0.2.1"), 0, clock_.Now()));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -8,6 +8,7 @@
 #include <cstddef>
 #include <string>
 
+#include "absl/container/inlined_vector.h"
 #include "quiche/quic/core/congestion_control/general_loss_algorithm.h"
 #include "quiche/quic/core/congestion_control/pacing_sender.h"
 #include "quiche/quic/core/congestion_control/send_algorithm_interface.h"
@@ -127,10 +128,25 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
     if (config.HasClientSentConnectionOption(kAFF1, perspective)) {
       use_smoothed_rtt_in_ack_delay_ = true;
     }
+    if (config.HasClientSentConnectionOption(kAFF3, perspective)) {
+      adapt_ack_frequency_ = true;
+    }
   }
   if (config.HasClientSentConnectionOption(kMAD0, perspective)) {
     ignore_ack_delay_ = true;
   }
+  if (GetQuicReloadableFlag(quic_enable_multipath_experiment)) {
+    if (config.HasClientSentConnectionOption(kMPRD, perspective)) {
+      QUIC_RELOADABLE_FLAG_COUNT_N(quic_enable_multipath_experiment, 1, 3);
+      EnableMultipath(QuicPathSchedulerType::kRedundant);
+    } else if (config.HasClientSentConnectionOption(kMPRR, perspective)) {
+      QUIC_RELOADABLE_FLAG_COUNT_N(quic_enable_multipath_experiment, 2, 3);
+      EnableMultipath(QuicPathSchedulerType::kRoundRobin);
+    } else if (config.HasClientSentConnectionOption(kMPTH, perspective)) {
+      QUIC_RELOADABLE_FLAG_COUNT_N(quic_enable_multipath_experiment, 3, 3);
+      EnableMultipath(QuicPathSchedulerType::kMinRtt);
+    }
+  }
 
   if (config.HasClientRequestedIndependentOption(kPDP1, perspective)) {
     num_ptos_for_path_degrading_ = 1;
@@ -154,6 +170,11 @@ void QuicSentPacketManager::SetFromConfig(const QuicConfig& config) {
     QUIC_RELOADABLE_FLAG_COUNT(quic_allow_client_enabled_bbr_v2);
     SetSendAlgorithm(kBBRv2);
   }
+  if (GetQuicReloadableFlag(quic_allow_client_enabled_pcc) &&
+      config.HasClientRequestedIndependentOption(kTPCC, perspective)) {
+    QUIC_RELOADABLE_FLAG_COUNT(quic_allow_client_enabled_pcc);
+    SetSendAlgorithm(kPCC);
+  }
 
   if (config.HasClientRequestedIndependentOption(kRENO, perspective)) {
     SetSendAlgorithm(kRenoBytes);
@@ -248,6 +269,8 @@ void QuicSentPacketManager::ApplyConnectionOptions(
     cc_type = kBBRv2;
   } else if (ContainsQuicTag(connection_options, kTBBR)) {
     cc_type = kBBR;
+  } else if (ContainsQuicTag(connection_options, kTPCC)) {
+    cc_type = kPCC;
   } else if (ContainsQuicTag(connection_options, kRENO)) {
     cc_type = kRenoBytes;
   } else if (ContainsQuicTag(connection_options, kQBIC)) {
@@ -386,7 +409,9 @@ void QuicSentPacketManager::MaybeInvokeCongestionEvent(
   }
   const bool overshooting_detected =
       stats_->overshooting_detected_with_network_parameters_adjusted;
-  if (using_pacing_) {
+  if (HasAdditionalPaths()) {
+    InvokeMultipathCongestionEvents(event_time);
+  } else if (using_pacing_) {
     pacing_sender_.OnCongestionEvent(rtt_updated, prior_in_flight, event_time,
                                      packets_acked_, packets_lost_);
   } else {
@@ -648,6 +673,51 @@ QuicAckFrequencyFrame QuicSentPacketManager::GetUpdatedAckFrequencyFrame()
   frame.max_ack_delay =
       std::max(frame.max_ack_delay,
                QuicTime::Delta::FromMilliseconds(kDefaultMinAckDelayTimeMs));
+  if (adapt_ack_frequency_) {
+    // Ask for a fixed number of ACKs per bandwidth-delay product, falling back
+    // to the congestion window before there is a bandwidth estimate.
+    QuicByteCount bdp =
+        send_algorithm_->BandwidthEstimate() * rtt_stats_.MinOrInitialRtt();
+    if (bdp == 0) {
+      bdp = GetCongestionWindowInBytes();
+    }
+    frame.packet_tolerance = std::clamp<QuicPacketCount>(
+        bdp / kDefaultTCPMSS / kAdaptiveAckFrequencyAcksPerBdp,
+        kDefaultRetransmittablePacketsBeforeAck,
+        kMaxAdaptiveAckFrequencyPacketTolerance);
+    // Once packets have been reordered, immediate ACKs of out of order packets
+    // are mostly wasted, and losses are detected by the next ACK anyway.
+    frame.ignore_order = stats_->sent_packets_max_sequence_reordering > 0;
+  }
+  return frame;
+}
+
+absl::optional<QuicAckFrequencyFrame>
+QuicSentPacketManager::MaybeGetUpdatedAckFrequencyFrame(QuicTime now) {
+  if (!adapt_ack_frequency_ ||
+      !last_ack_frequency_frame_time_.IsInitialized() ||
+      !CanSendAckFrequency() ||
+      now - last_ack_frequency_frame_time_ <
+          rtt_stats_.SmoothedOrInitialRtt()) {
+    return absl::nullopt;
+  }
+  const QuicAckFrequencyFrame frame = GetUpdatedAckFrequencyFrame();
+  // Ignore changes of up to 25% to avoid sending a frame every round trip.
+  const uint64_t last_tolerance = last_ack_frequency_frame_.packet_tolerance;
+  const bool tolerance_changed =
+      4 * frame.packet_tolerance < 3 * last_tolerance ||
+      4 * frame.packet_tolerance > 5 * last_tolerance;
+  const QuicTime::Delta last_max_ack_delay =
+      last_ack_frequency_frame_.max_ack_delay;
+  const bool max_ack_delay_changed =
+      frame.max_ack_delay < 0.75 * last_max_ack_delay ||
+      frame.max_ack_delay > 1.25 * last_max_ack_delay;
+  if (!tolerance_changed && !max_ack_delay_changed &&
+      frame.ignore_order == last_ack_frequency_frame_.ignore_order) {
+    return absl::nullopt;
+  }
+  last_ack_frequency_frame_ = frame;
+  last_ack_frequency_frame_time_ = now;
   return frame;
 }
 
@@ -672,13 +742,32 @@ bool QuicSentPacketManager::OnPacketSent(
     in_flight = false;
     measure_rtt = false;
   }
-  if (using_pacing_) {
-    pacing_sender_.OnPacketSent(sent_time, unacked_packets_.bytes_in_flight(),
-                                packet_number, packet.encrypted_length,
+  if (!IsPathActive(packet.path_id)) {
+    QUIC_BUG(quic_bug_10750_8)
+        << "Packet " << packet_number << " sent on inactive path "
+        << static_cast<int>(packet.path_id);
+    mutable_packet->path_id = kDefaultPathId;
+  }
+  const QuicPathId path_id = packet.path_id;
+  const QuicByteCount bytes_in_flight = GetBytesInFlightForPath(path_id);
+  if (path_id != kDefaultPathId) {
+    PathState* path = additional_paths_[path_id].get();
+    if (using_pacing_) {
+      path->pacing_sender.OnPacketSent(sent_time, bytes_in_flight,
+                                       packet_number, packet.encrypted_length,
+                                       has_retransmittable_data);
+    } else {
+      path->send_algorithm->OnPacketSent(sent_time, bytes_in_flight,
+                                         packet_number, packet.encrypted_length,
+                                         has_retransmittable_data);
+    }
+  } else if (using_pacing_) {
+    pacing_sender_.OnPacketSent(sent_time, bytes_in_flight, packet_number,
+                                packet.encrypted_length,
                                 has_retransmittable_data);
   } else {
-    send_algorithm_->OnPacketSent(sent_time, unacked_packets_.bytes_in_flight(),
-                                  packet_number, packet.encrypted_length,
+    send_algorithm_->OnPacketSent(sent_time, bytes_in_flight, packet_number,
+                                  packet.encrypted_length,
                                   has_retransmittable_data);
   }
 
@@ -696,7 +785,7 @@ bool QuicSentPacketManager::OnPacketSent(
   if (packet.has_ack_frequency) {
     for (const auto& frame : packet.retransmittable_frames) {
       if (frame.type == ACK_FREQUENCY_FRAME) {
-        OnAckFrequencyFrameSent(*frame.ack_frequency_frame);
+        OnAckFrequencyFrameSent(*frame.ack_frequency_frame, sent_time);
       }
     }
   }
@@ -889,7 +978,7 @@ QuicSentPacketManager::GetRetransmissionMode() const {
       unacked_packets_.HasPendingCryptoPackets()) {
     return HANDSHAKE_MODE;
   }
-  if (loss_algorithm_->GetLossTimeout() != QuicTime::Zero()) {
+  if (GetLossTimeout() != QuicTime::Zero()) {
     return LOSS_MODE;
   }
   return PTO_MODE;
@@ -901,10 +990,14 @@ void QuicSentPacketManager::InvokeLossDetection(QuicTime time) {
                      packets_acked_.back().packet_number);
     largest_newly_acked_ = packets_acked_.back().packet_number;
   }
-  LossDetectionInterface::DetectionStats detection_stats =
-      loss_algorithm_->DetectLosses(unacked_packets_, time, rtt_stats_,
-                                    largest_newly_acked_, packets_acked_,
-                                    &packets_lost_);
+  LossDetectionInterface::DetectionStats detection_stats;
+  if (HasAdditionalPaths()) {
+    DetectMultipathLosses(time);
+  } else {
+    detection_stats = loss_algorithm_->DetectLosses(
+        unacked_packets_, time, rtt_stats_, largest_newly_acked_,
+        packets_acked_, &packets_lost_);
+  }
 
   if (detection_stats.sent_packets_max_sequence_reordering >
       stats_->sent_packets_max_sequence_reordering) {
@@ -960,6 +1053,15 @@ bool QuicSentPacketManager::MaybeUpdateRTT(QuicPacketNumber largest_acked,
   }
 
   QuicTime::Delta send_delta = ack_receive_time - transmission_info.sent_time;
+  const QuicPathId path_id = IsPathActive(transmission_info.path_id)
+                                 ? transmission_info.path_id
+                                 : kDefaultPathId;
+  path_rtt_updated_[path_id] = true;
+  if (path_id != kDefaultPathId) {
+    additional_paths_[path_id]->rtt_stats.UpdateRtt(send_delta, ack_delay_time,
+                                                    ack_receive_time);
+    return true;
+  }
   const bool min_rtt_available = !rtt_stats_.min_rtt().IsZero();
   rtt_stats_.UpdateRtt(send_delta, ack_delay_time, ack_receive_time);
 
@@ -977,12 +1079,39 @@ QuicTime::Delta QuicSentPacketManager::TimeUntilSend(QuicTime now) const {
     return QuicTime::Delta::Zero();
   }
 
+  QuicTime::Delta delay = TimeUntilSendOnPath(kDefaultPathId, now);
+  if (!HasAdditionalPaths()) {
+    return delay;
+  }
+  // Sending is possible as soon as any path can send.
+  for (QuicPathId path_id = kDefaultPathId + 1;
+       path_id < kMaxNumMultipathPaths && !delay.IsZero(); ++path_id) {
+    if (additional_paths_[path_id] != nullptr) {
+      delay = std::min(delay, TimeUntilSendOnPath(path_id, now));
+    }
+  }
+  return delay;
+}
+
+bool QuicSentPacketManager::CanSendOnPath(QuicPathId path_id,
+                                         QuicTime now) const {
+  return IsPathActive(path_id) && TimeUntilSendOnPath(path_id, now).IsZero();
+}
+
+QuicTime::Delta QuicSentPacketManager::TimeUntilSendOnPath(
+    QuicPathId path_id, QuicTime now) const {
+  SendAlgorithmInterface* send_algorithm = send_algorithm_.get();
+  const PacingSender* pacing_sender = &pacing_sender_;
+  if (path_id != kDefaultPathId) {
+    send_algorithm = additional_paths_[path_id]->send_algorithm.get();
+    pacing_sender = &additional_paths_[path_id]->pacing_sender;
+  }
+  const QuicByteCount bytes_in_flight = GetBytesInFlightForPath(path_id);
   if (using_pacing_) {
-    return pacing_sender_.TimeUntilSend(now,
-                                        unacked_packets_.bytes_in_flight());
+    return pacing_sender->TimeUntilSend(now, bytes_in_flight);
   }
 
-  return send_algorithm_->CanSend(unacked_packets_.bytes_in_flight())
+  return send_algorithm->CanSend(bytes_in_flight)
              ? QuicTime::Delta::Zero()
              : QuicTime::Delta::Infinite();
 }
@@ -1010,7 +1139,7 @@ const QuicTime QuicSentPacketManager::GetRetransmissionTime() const {
       return unacked_packets_.GetLastCryptoPacketSentTime() +
              GetCryptoRetransmissionDelay();
     case LOSS_MODE:
-      return loss_algorithm_->GetLossTimeout();
+      return GetLossTimeout();
     case PTO_MODE: {
       if (!supports_multiple_packet_number_spaces()) {
         if (unacked_packets_.HasInFlightPackets() &&
@@ -1106,16 +1235,17 @@ const QuicTime::Delta QuicSentPacketManager::GetCryptoRetransmissionDelay()
 
 const QuicTime::Delta QuicSentPacketManager::GetProbeTimeoutDelay(
     PacketNumberSpace space) const {
-  if (rtt_stats_.smoothed_rtt().IsZero()) {
+  const RttStats& rtt_stats = GetRttStatsForPto();
+  if (rtt_stats.smoothed_rtt().IsZero()) {
     // Respect kMinHandshakeTimeoutMs to avoid a potential amplification attack.
-    QUIC_BUG_IF(quic_bug_12552_6, rtt_stats_.initial_rtt().IsZero());
-    return std::max(kPtoMultiplierWithoutRttSamples * rtt_stats_.initial_rtt(),
+    QUIC_BUG_IF(quic_bug_12552_6, rtt_stats.initial_rtt().IsZero());
+    return std::max(kPtoMultiplierWithoutRttSamples * rtt_stats.initial_rtt(),
                     QuicTime::Delta::FromMilliseconds(kMinHandshakeTimeoutMs)) *
            (1 << consecutive_pto_count_);
   }
   QuicTime::Delta pto_delay =
-      rtt_stats_.smoothed_rtt() +
-      std::max(kPtoRttvarMultiplier * rtt_stats_.mean_deviation(),
+      rtt_stats.smoothed_rtt() +
+      std::max(kPtoRttvarMultiplier * rtt_stats.mean_deviation(),
                kAlarmGranularity) +
       (ShouldAddMaxAckDelay(space) ? peer_max_ack_delay_
                                    : QuicTime::Delta::Zero());
@@ -1208,6 +1338,7 @@ void QuicSentPacketManager::OnAckFrameStart(QuicPacketNumber largest_acked,
       ack_delay_time = QuicTime::Delta::Zero();
     }
   }
+  std::fill(std::begin(path_rtt_updated_), std::end(path_rtt_updated_), false);
   rtt_updated_ =
       MaybeUpdateRTT(largest_acked, ack_delay_time, ack_receive_time);
   last_ack_frame_.ack_delay_time = ack_delay_time;
@@ -1267,6 +1398,10 @@ AckResult QuicSentPacketManager::OnAckFrameEnd(
     QuicTime ack_receive_time, QuicPacketNumber ack_packet_number,
     EncryptionLevel ack_decrypted_level) {
   QuicByteCount prior_bytes_in_flight = unacked_packets_.bytes_in_flight();
+  // Sent time of the largest newly acked packet of each path which may be
+  // used for RTT measurement.
+  absl::InlinedVector<QuicTime, kMaxNumMultipathPaths>
+      largest_newly_acked_sent_time(kMaxNumMultipathPaths, QuicTime::Zero());
   // Reverse packets_acked_ so that it is in ascending order.
   std::reverse(packets_acked_.begin(), packets_acked_.end());
   for (AckedPacket& acked_packet : packets_acked_) {
@@ -1329,10 +1464,31 @@ AckResult QuicSentPacketManager::OnAckFrameEnd(
     }
     unacked_packets_.MaybeUpdateLargestAckedOfPacketNumberSpace(
         packet_number_space, acked_packet.packet_number);
+    largest_acked_on_path_[info->path_id].UpdateMax(
+        acked_packet.packet_number);
+    if (info->state != NOT_CONTRIBUTING_RTT) {
+      largest_newly_acked_sent_time[info->path_id] = info->sent_time;
+    }
     MarkPacketHandled(acked_packet.packet_number, info, ack_receive_time,
                       last_ack_frame_.ack_delay_time,
                       acked_packet.receive_timestamp);
   }
+  if (HasAdditionalPaths()) {
+    // The peer's ack delay only applies to the largest acked packet, so the
+    // samples of the other paths are taken without subtracting it.
+    for (QuicPathId path_id = kDefaultPathId; path_id < kMaxNumMultipathPaths;
+         ++path_id) {
+      if (!IsPathActive(path_id) || path_rtt_updated_[path_id] ||
+          !largest_newly_acked_sent_time[path_id].IsInitialized()) {
+        continue;
+      }
+      GetMutablePathRttStats(path_id)->UpdateRtt(
+          ack_receive_time - largest_newly_acked_sent_time[path_id],
+          QuicTime::Delta::Zero(), ack_receive_time);
+      path_rtt_updated_[path_id] = true;
+      rtt_updated_ = true;
+    }
+  }
   const bool acked_new_packet = !packets_acked_.empty();
   PostProcessNewlyAckedPackets(ack_packet_number, ack_decrypted_level,
                                last_ack_frame_, ack_receive_time, rtt_updated_,
@@ -1350,6 +1506,16 @@ void QuicSentPacketManager::OnApplicationLimited() {
     pacing_sender_.OnApplicationLimited();
   }
   send_algorithm_->OnApplicationLimited(unacked_packets_.bytes_in_flight());
+  for (const std::unique_ptr<PathState>& path : additional_paths_) {
+    if (path == nullptr) {
+      continue;
+    }
+    if (using_pacing_) {
+      path->pacing_sender.OnApplicationLimited();
+    }
+    path->send_algorithm->OnApplicationLimited(
+        unacked_packets_.bytes_in_flight());
+  }
   if (debug_delegate_ != nullptr) {
     debug_delegate_->OnApplicationLimited();
   }
@@ -1464,7 +1630,15 @@ QuicTime::Delta QuicSentPacketManager::GetPtoDelay() const {
 }
 
 void QuicSentPacketManager::OnAckFrequencyFrameSent(
-    const QuicAckFrequencyFrame& ack_frequency_frame) {
+    const QuicAckFrequencyFrame& ack_frequency_frame, QuicTime sent_time) {
+  if (in_use_sent_ack_delays_.empty() ||
+      in_use_sent_ack_delays_.back().second <
+          ack_frequency_frame.sequence_number) {
+    // Not a retransmission.
+    ++stats_->num_ack_frequency_frames_sent;
+    last_ack_frequency_frame_ = ack_frequency_frame;
+    last_ack_frequency_frame_time_ = sent_time;
+  }
   in_use_sent_ack_delays_.emplace_back(ack_frequency_frame.max_ack_delay,
                                        ack_frequency_frame.sequence_number);
   if (ack_frequency_frame.max_ack_delay > peer_max_ack_delay_) {
@@ -1495,5 +1669,248 @@ void QuicSentPacketManager::OnAckFrequencyFrameAcked(
                             ->first;
 }
 
+void QuicSentPacketManager::EnableMultipath(
+    QuicPathSchedulerType scheduler_type) {
+  QUIC_DLOG(INFO) << ENDPOINT << "Enabling multipath with " << scheduler_type
+                  << " scheduler";
+  path_scheduler_ = QuicPathScheduler::Create(scheduler_type);
+}
+
+bool QuicSentPacketManager::AddPath(QuicPathId path_id) {
+  if (!multipath_enabled() || path_id == kDefaultPathId ||
+      path_id >= kMaxNumMultipathPaths ||
+      additional_paths_[path_id] != nullptr) {
+    return false;
+  }
+  auto path = std::make_unique<PathState>();
+  path->rtt_stats.set_initial_rtt(rtt_stats_.initial_rtt());
+  path->send_algorithm.reset(SendAlgorithmInterface::Create(
+      clock_, &path->rtt_stats, &unacked_packets_,
+      send_algorithm_->GetCongestionControlType(), random_, stats_,
+      initial_congestion_window_, nullptr));
+  path->pacing_sender.set_sender(path->send_algorithm.get());
+  additional_paths_[path_id] = std::move(path);
+  ++num_additional_paths_;
+  largest_acked_on_path_[path_id].Clear();
+  path_rtt_updated_[path_id] = false;
+  return true;
+}
+
+void QuicSentPacketManager::RemovePath(QuicPathId path_id) {
+  if (path_id == kDefaultPathId || !IsPathActive(path_id)) {
+    return;
+  }
+  QuicPacketNumber packet_number = unacked_packets_.GetLeastUnacked();
+  for (auto it = unacked_packets_.begin(); it != unacked_packets_.end();
+       ++it, ++packet_number) {
+    if (it->path_id != path_id || !it->in_flight) {
+      continue;
+    }
+    // As in OnConnectionMigration, packets in flight on the removed path do
+    // not contribute to congestion control or RTT.
+    unacked_packets_.RemoveFromInFlight(packet_number);
+    if (unacked_packets_.HasRetransmittableFrames(packet_number)) {
+      MarkForRetransmission(packet_number, PATH_RETRANSMISSION);
+    }
+  }
+  additional_paths_[path_id].reset();
+  --num_additional_paths_;
+  largest_acked_on_path_[path_id].Clear();
+  path_rtt_updated_[path_id] = false;
+  if (!HasAdditionalPaths()) {
+    multipath_loss_timeout_ = QuicTime::Zero();
+  }
+}
+
+bool QuicSentPacketManager::IsPathActive(QuicPathId path_id) const {
+  return path_id == kDefaultPathId || (path_id < kMaxNumMultipathPaths &&
+                                       additional_paths_[path_id] != nullptr);
+}
+
+QuicPathId QuicSentPacketManager::SelectPathForNextPacket(QuicTime now) {
+  if (!HasAdditionalPaths()) {
+    return kDefaultPathId;
+  }
+  QuicPathScheduler::PathInfo paths[kMaxNumMultipathPaths];
+  size_t num_paths = 0;
+  for (QuicPathId path_id = kDefaultPathId; path_id < kMaxNumMultipathPaths;
+       ++path_id) {
+    if (!IsPathActive(path_id)) {
+      continue;
+    }
+    QuicPathScheduler::PathInfo& path = paths[num_paths++];
+    path.path_id = path_id;
+    path.smoothed_rtt = GetPathRttStats(path_id)->SmoothedOrInitialRtt();
+    path.can_send = TimeUntilSendOnPath(path_id, now).IsZero();
+  }
+  const QuicPathId path_id =
+      path_scheduler_->SelectPath(absl::MakeConstSpan(paths, num_paths));
+  return path_id == kInvalidPathId ? kDefaultPathId : path_id;
+}
+
+const RttStats* QuicSentPacketManager::GetPathRttStats(
+    QuicPathId path_id) const {
+  if (path_id == kDefaultPathId) {
+    return &rtt_stats_;
+  }
+  if (!IsPathActive(path_id)) {
+    return nullptr;
+  }
+  return &additional_paths_[path_id]->rtt_stats;
+}
+
+const SendAlgorithmInterface* QuicSentPacketManager::GetPathSendAlgorithm(
+    QuicPathId path_id) const {
+  if (path_id == kDefaultPathId) {
+    return send_algorithm_.get();
+  }
+  if (!IsPathActive(path_id)) {
+    return nullptr;
+  }
+  return additional_paths_[path_id]->send_algorithm.get();
+}
+
+bool QuicSentPacketManager::HasAckedPacketOnPath(QuicPathId path_id) const {
+  return path_id < kMaxNumMultipathPaths &&
+         largest_acked_on_path_[path_id].IsInitialized();
+}
+
+RttStats* QuicSentPacketManager::GetMutablePathRttStats(QuicPathId path_id) {
+  if (path_id == kDefaultPathId || !IsPathActive(path_id)) {
+    return &rtt_stats_;
+  }
+  return &additional_paths_[path_id]->rtt_stats;
+}
+
+QuicByteCount QuicSentPacketManager::GetBytesInFlightForPath(
+    QuicPathId path_id) const {
+  if (!multipath_enabled()) {
+    return unacked_packets_.bytes_in_flight();
+  }
+  return unacked_packets_.GetBytesInFlightOnPath(path_id);
+}
+
+void QuicSentPacketManager::DetectMultipathLosses(QuicTime time) {
+  QUICHE_DCHECK(packets_lost_.empty());
+  multipath_loss_timeout_ = QuicTime::Zero();
+  if (unacked_packets_.empty()) {
+    return;
+  }
+  absl::InlinedVector<QuicTime::Delta, kMaxNumMultipathPaths> loss_delay(
+      kMaxNumMultipathPaths, QuicTime::Delta::Zero());
+  for (QuicPathId path_id = kDefaultPathId; path_id < kMaxNumMultipathPaths;
+       ++path_id) {
+    const RttStats* rtt_stats = GetPathRttStats(path_id);
+    if (rtt_stats == nullptr) {
+      continue;
+    }
+    const QuicTime::Delta max_rtt =
+        std::max(rtt_stats->previous_srtt(), rtt_stats->latest_rtt());
+    loss_delay[path_id] = std::max(
+        kAlarmGranularity, max_rtt + (max_rtt >> kDefaultIetfLossDelayShift));
+  }
+  // Number of packets sent on each path after the one being examined, up to
+  // the largest acked packet of that path.
+  QuicPacketCount num_later_packets[kMaxNumMultipathPaths] = {};
+  QuicPacketNumber packet_number = unacked_packets_.largest_sent_packet();
+  for (auto it = unacked_packets_.rbegin(); it != unacked_packets_.rend();
+       ++it, --packet_number) {
+    const QuicPathId path_id = it->path_id;
+    if (it->state == NEVER_SENT || !IsPathActive(path_id) ||
+        !largest_acked_on_path_[path_id].IsInitialized() ||
+        packet_number > largest_acked_on_path_[path_id]) {
+      continue;
+    }
+    const QuicPacketCount num_later = num_later_packets[path_id]++;
+    if (!it->in_flight) {
+      continue;
+    }
+    if (num_later < kDefaultPacketReorderingThreshold) {
+      const QuicTime when_lost = it->sent_time + loss_delay[path_id];
+      if (time < when_lost) {
+        if (!multipath_loss_timeout_.IsInitialized() ||
+            when_lost < multipath_loss_timeout_) {
+          multipath_loss_timeout_ = when_lost;
+        }
+        continue;
+      }
+    }
+    packets_lost_.push_back(LostPacket(packet_number, it->bytes_sent));
+  }
+  // Keep lost packets in ascending order, as the loss algorithms do.
+  std::reverse(packets_lost_.begin(), packets_lost_.end());
+}
+
+void QuicSentPacketManager::InvokeMultipathCongestionEvents(
+    QuicTime event_time) {
+  for (QuicPathId path_id = kDefaultPathId; path_id < kMaxNumMultipathPaths;
+       ++path_id) {
+    if (!IsPathActive(path_id)) {
+      continue;
+    }
+    AckedPacketVector acked_packets;
+    LostPacketVector lost_packets;
+    // Bytes acked and lost have already been removed from flight.
+    QuicByteCount prior_in_flight =
+        unacked_packets_.GetBytesInFlightOnPath(path_id);
+    for (const AckedPacket& packet : packets_acked_) {
+      if (unacked_packets_.GetTransmissionInfo(packet.packet_number).path_id ==
+          path_id) {
+        prior_in_flight += packet.bytes_acked;
+        acked_packets.push_back(packet);
+      }
+    }
+    for (const LostPacket& packet : packets_lost_) {
+      if (unacked_packets_.GetTransmissionInfo(packet.packet_number).path_id ==
+          path_id) {
+        prior_in_flight += packet.bytes_lost;
+        lost_packets.push_back(packet);
+      }
+    }
+    const bool rtt_updated = path_rtt_updated_[path_id];
+    if (!rtt_updated && acked_packets.empty() && lost_packets.empty()) {
+      continue;
+    }
+    if (path_id == kDefaultPathId) {
+      if (using_pacing_) {
+        pacing_sender_.OnCongestionEvent(rtt_updated, prior_in_flight,
+                                         event_time, acked_packets,
+                                         lost_packets);
+      } else {
+        send_algorithm_->OnCongestionEvent(rtt_updated, prior_in_flight,
+                                           event_time, acked_packets,
+                                           lost_packets);
+      }
+    } else if (using_pacing_) {
+      additional_paths_[path_id]->pacing_sender.OnCongestionEvent(
+          rtt_updated, prior_in_flight, event_time, acked_packets,
+          lost_packets);
+    } else {
+      additional_paths_[path_id]->send_algorithm->OnCongestionEvent(
+          rtt_updated, prior_in_flight, event_time, acked_packets,
+          lost_packets);
+    }
+  }
+  std::fill(std::begin(path_rtt_updated_), std::end(path_rtt_updated_), false);
+}
+
+const RttStats& QuicSentPacketManager::GetRttStatsForPto() const {
+  const RttStats* slowest = &rtt_stats_;
+  for (const std::unique_ptr<PathState>& path : additional_paths_) {
+    if (path != nullptr && path->rtt_stats.SmoothedOrInitialRtt() >
+                               slowest->SmoothedOrInitialRtt()) {
+      slowest = &path->rtt_stats;
+    }
+  }
+  return *slowest;
+}
+
+QuicTime QuicSentPacketManager::GetLossTimeout() const {
+  if (HasAdditionalPaths()) {
+    return multipath_loss_timeout_;
+  }
+  return loss_algorithm_->GetLossTimeout();
+}
+
 #undef ENDPOINT  // undef for jumbo builds
 }  // namespace quic
@@ -14,12 +14,14 @@
 #include <utility>
 #include <vector>
 
+#include "absl/types/optional.h"
 #include "quiche/quic/core/congestion_control/pacing_sender.h"
 #include "quiche/quic/core/congestion_control/rtt_stats.h"
 #include "quiche/quic/core/congestion_control/send_algorithm_interface.h"
 #include "quiche/quic/core/congestion_control/uber_loss_algorithm.h"
 #include "quiche/quic/core/proto/cached_network_parameters_proto.h"
 #include "quiche/quic/core/quic_packets.h"
+#include "quiche/quic/core/quic_path_scheduler.h"
 #include "quiche/quic/core/quic_sustained_bandwidth_recorder.h"
 #include "quiche/quic/core/quic_time.h"
 #include "quiche/quic/core/quic_transmission_info.h"
@@ -205,8 +207,17 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
 
   bool CanSendAckFrequency() const;
 
+  // Returns the ACK frequency to request from the peer.  If the ACK frequency
+  // is adapted, the packet tolerance is a fraction of the bandwidth-delay
+  // product and ignore_order is set once reordering has been observed.
   QuicAckFrequencyFrame GetUpdatedAckFrequencyFrame() const;
 
+  // Returns a new ACK_FREQUENCY frame to send if the ACK frequency is adapted,
+  // one has already been sent, and the requested ACK frequency has changed
+  // significantly since.  Updates are sent at most once per smoothed RTT.
+  absl::optional<QuicAckFrequencyFrame> MaybeGetUpdatedAckFrequencyFrame(
+      QuicTime now);
+
   // Called when the retransmission timer expires and returns the retransmission
   // mode.
   RetransmissionTimeoutMode OnRetransmissionTimeout();
@@ -470,6 +481,53 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
     return simplify_set_retransmission_alarm_;
   }
 
+  // Enables sending on up to kMaxNumMultipathPaths concurrently active paths,
+  // each with its own RTT and congestion control state. kDefaultPathId is
+  // always active and uses the connection's congestion controller, the other
+  // paths are added with AddPath(). |scheduler_type| decides which path each
+  // packet is sent on.
+  void EnableMultipath(QuicPathSchedulerType scheduler_type);
+
+  bool multipath_enabled() const { return path_scheduler_ != nullptr; }
+
+  // Starts tracking RTT and congestion control state of |path_id|, with the
+  // same congestion control algorithm as the default path. Returns false if
+  // multipath is not enabled, or |path_id| is invalid or already active.
+  bool AddPath(QuicPathId path_id);
+
+  // Stops tracking |path_id|. Its packets in flight are retransmitted on the
+  // remaining paths.
+  void RemovePath(QuicPathId path_id);
+
+  bool IsPathActive(QuicPathId path_id) const;
+
+  // Returns the path the next retransmittable packet should be sent on, which
+  // is kDefaultPathId unless there are active paths other than the default.
+  QuicPathId SelectPathForNextPacket(QuicTime now);
+
+  // Returns true if each packet should also be sent on all the other active
+  // paths.
+  bool DuplicatesPacketsOnAllPaths() const {
+    return multipath_enabled() && path_scheduler_->DuplicatesPackets();
+  }
+
+  // Returns the RTT stats of |path_id|, or nullptr if it is not active.
+  const RttStats* GetPathRttStats(QuicPathId path_id) const;
+
+  // Returns the send algorithm of |path_id|, or nullptr if it is not active.
+  const SendAlgorithmInterface* GetPathSendAlgorithm(QuicPathId path_id) const;
+
+  QuicByteCount GetBytesInFlightOnPath(QuicPathId path_id) const {
+    return unacked_packets_.GetBytesInFlightOnPath(path_id);
+  }
+
+  // Returns true if any packet sent on |path_id| has been acknowledged.
+  bool HasAckedPacketOnPath(QuicPathId path_id) const;
+
+  // Returns true if neither the congestion window nor the pacer of active path
+  // |path_id| delays sending at |now|.
+  bool CanSendOnPath(QuicPathId path_id, QuicTime now) const;
+
  private:
   friend class test::QuicConnectionPeer;
   friend class test::QuicSentPacketManagerPeer;
@@ -553,8 +611,44 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   bool PeerCompletedAddressValidation() const;
 
   // Called when an AckFrequencyFrame is sent.
-  void OnAckFrequencyFrameSent(
-      const QuicAckFrequencyFrame& ack_frequency_frame);
+  void OnAckFrequencyFrameSent(const QuicAckFrequencyFrame& ack_frequency_frame,
+                               QuicTime sent_time);
+
+  // RTT and congestion control state of an active path other than
+  // kDefaultPathId.
+  struct QUIC_EXPORT_PRIVATE PathState {
+    RttStats rtt_stats;
+    std::unique_ptr<SendAlgorithmInterface> send_algorithm;
+    PacingSender pacing_sender;
+  };
+
+  bool HasAdditionalPaths() const { return num_additional_paths_ > 0; }
+
+  // Returns the RTT stats of |path_id|, falling back to |rtt_stats_| if it is
+  // not active.
+  RttStats* GetMutablePathRttStats(QuicPathId path_id);
+
+  // Returns the bytes in flight seen by the send algorithm of |path_id|.
+  QuicByteCount GetBytesInFlightForPath(QuicPathId path_id) const;
+
+  QuicTime::Delta TimeUntilSendOnPath(QuicPathId path_id, QuicTime now) const;
+
+  // Loss detection used instead of |loss_algorithm_| while there are active
+  // paths other than the default. Packet and time thresholds are applied per
+  // path, as packets sent on a slower path are naturally acked after later
+  // packets sent on a faster one.
+  void DetectMultipathLosses(QuicTime time);
+
+  // Invokes OnCongestionEvent on the send algorithm of each active path with
+  // the packets acked and lost on that path.
+  void InvokeMultipathCongestionEvents(QuicTime event_time);
+
+  // Returns the RTT stats the PTO is computed from, which are those of the
+  // path with the largest smoothed RTT.
+  const RttStats& GetRttStatsForPto() const;
+
+  // Returns the earliest time at which a packet may be declared lost.
+  QuicTime GetLossTimeout() const;
 
   // Called when an AckFrequencyFrame is acked.
   void OnAckFrequencyFrameAcked(
@@ -632,6 +726,14 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
   // Use smoothed RTT for computing max_ack_delay in AckFrequency frame.
   bool use_smoothed_rtt_in_ack_delay_ = false;
 
+  // Whether to adapt the packet tolerance of AckFrequency frames to the
+  // bandwidth-delay product and keep updating the peer.
+  bool adapt_ack_frequency_ = false;
+
+  // The most recent AckFrequency frame sent or about to be sent, and when.
+  QuicAckFrequencyFrame last_ack_frequency_frame_;
+  QuicTime last_ack_frequency_frame_time_ = QuicTime::Zero();
+
   // The history of outstanding max_ack_delays sent to peer. Outstanding means
   // a max_ack_delay is sent as part of the last acked AckFrequencyFrame or
   // an unacked AckFrequencyFrame after that.
@@ -681,6 +783,18 @@ class QUIC_EXPORT_PRIVATE QuicSentPacketManager {
 
   const bool simplify_set_retransmission_alarm_ =
       GetQuicReloadableFlag(quic_simplify_set_retransmission_alarm);
+
+  // Non-null once multipath is enabled.
+  std::unique_ptr<QuicPathScheduler> path_scheduler_;
+  // Indexed by path ID. The entry of kDefaultPathId is always null.
+  std::unique_ptr<PathState> additional_paths_[kMaxNumMultipathPaths];
+  size_t num_additional_paths_ = 0;
+  // The largest packet sent on each path which has been acked.
+  QuicPacketNumber largest_acked_on_path_[kMaxNumMultipathPaths];
+  // Whether the RTT of each path was updated by the last ACK.
+  bool path_rtt_updated_[kMaxNumMultipathPaths] = {};
+  // Earliest time a packet may be declared lost by DetectMultipathLosses.
+  QuicTime multipath_loss_timeout_ = QuicTime::Zero();
 };
 
 }  // namespace quic
@@ -271,6 +271,16 @@ class QuicSentPacketManagerTest : public QuicTest {
                           HAS_RETRANSMITTABLE_DATA, true);
   }
 
+  // Sends a data packet on an additional path of a multipath connection,
+  // which does not use |send_algorithm_|.
+  void SendDataPacketOnPath(uint64_t packet_number, QuicPathId path_id) {
+    SerializedPacket packet(CreateDataPacket(packet_number));
+    packet.encryption_level = ENCRYPTION_FORWARD_SECURE;
+    packet.path_id = path_id;
+    manager_.OnPacketSent(&packet, clock_.Now(), NOT_RETRANSMISSION,
+                          HAS_RETRANSMITTABLE_DATA, true);
+  }
+
   void SendPingPacket(uint64_t packet_number,
                       EncryptionLevel encryption_level) {
     EXPECT_CALL(*send_algorithm_,
@@ -1221,6 +1231,19 @@ TEST_F(QuicSentPacketManagerTest, NegotiateCongestionControlFromOptions) {
   EXPECT_EQ(kBBR, QuicSentPacketManagerPeer::GetSendAlgorithm(manager_)
                       ->GetCongestionControlType());
 
+  options.clear();
+  options.push_back(kTPCC);
+  QuicConfigPeer::SetReceivedConnectionOptions(&config, options);
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.SetFromConfig(config);
+  if (GetQuicReloadableFlag(quic_allow_client_enabled_pcc)) {
+    EXPECT_EQ(kPCC, QuicSentPacketManagerPeer::GetSendAlgorithm(manager_)
+                        ->GetCongestionControlType());
+  } else {
+    EXPECT_EQ(kBBR, QuicSentPacketManagerPeer::GetSendAlgorithm(manager_)
+                        ->GetCongestionControlType());
+  }
+
   options.clear();
   options.push_back(kBYTE);
   QuicConfigPeer::SetReceivedConnectionOptions(&config, options);
@@ -3052,6 +3075,74 @@ TEST_F(QuicSentPacketManagerTest, BuildAckFrequencyFrame) {
   EXPECT_EQ(frame.packet_tolerance, 10u);
 }
 
+TEST_F(QuicSentPacketManagerTest, AdaptAckFrequencyToBdp) {
+  SetQuicReloadableFlag(quic_can_send_ack_frequency, true);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  EXPECT_CALL(*send_algorithm_, OnPacketSent(_, _, _, _, _)).Times(AnyNumber());
+  QuicConfig config;
+  QuicConfigPeer::SetReceivedMinAckDelayMs(&config, /*min_ack_delay_ms=*/1);
+  QuicConfigPeer::SetReceivedConnectionOptions(&config, {kAFF3});
+  manager_.SetFromConfig(config);
+  manager_.SetHandshakeConfirmed();
+
+  const QuicTime::Delta rtt = QuicTime::Delta::FromMilliseconds(80);
+  auto* rtt_stats = const_cast<RttStats*>(manager_.GetRttStats());
+  rtt_stats->UpdateRtt(rtt, QuicTime::Delta::Zero(), clock_.Now());
+  // A bandwidth-delay product of 100 packets.
+  EXPECT_CALL(*send_algorithm_, BandwidthEstimate())
+      .WillRepeatedly(Return(
+          QuicBandwidth::FromBytesAndTimeDelta(100 * kDefaultTCPMSS, rtt)));
+  QuicAckFrequencyFrame frame = manager_.GetUpdatedAckFrequencyFrame();
+  EXPECT_EQ(25u, frame.packet_tolerance);
+  EXPECT_FALSE(frame.ignore_order);
+
+  // Updates are only sent once a first frame has been sent.
+  EXPECT_FALSE(
+      manager_.MaybeGetUpdatedAckFrequencyFrame(clock_.Now()).has_value());
+  SerializedPacket packet = MakePacketWithAckFrequencyFrame(
+      /*packet_number=*/1, /*ack_frequency_sequence_number=*/1,
+      frame.max_ack_delay);
+  manager_.OnPacketSent(&packet, clock_.Now(), NOT_RETRANSMISSION,
+                        HAS_RETRANSMITTABLE_DATA, /*measure_rtt=*/true);
+  EXPECT_EQ(1u, stats_.num_ack_frequency_frames_sent);
+
+  // The frame sent had a packet tolerance of 2, but no update is sent within
+  // a round trip.
+  clock_.AdvanceTime(rtt * 0.5);
+  EXPECT_FALSE(
+      manager_.MaybeGetUpdatedAckFrequencyFrame(clock_.Now()).has_value());
+  clock_.AdvanceTime(rtt * 0.5);
+  absl::optional<QuicAckFrequencyFrame> update =
+      manager_.MaybeGetUpdatedAckFrequencyFrame(clock_.Now());
+  ASSERT_TRUE(update.has_value());
+  EXPECT_EQ(25u, update->packet_tolerance);
+
+  // Small changes are ignored.
+  EXPECT_CALL(*send_algorithm_, BandwidthEstimate())
+      .WillRepeatedly(Return(
+          QuicBandwidth::FromBytesAndTimeDelta(120 * kDefaultTCPMSS, rtt)));
+  clock_.AdvanceTime(rtt);
+  EXPECT_FALSE(
+      manager_.MaybeGetUpdatedAckFrequencyFrame(clock_.Now()).has_value());
+
+  // The packet tolerance is capped.
+  EXPECT_CALL(*send_algorithm_, BandwidthEstimate())
+      .WillRepeatedly(Return(
+          QuicBandwidth::FromBytesAndTimeDelta(1000 * kDefaultTCPMSS, rtt)));
+  update = manager_.MaybeGetUpdatedAckFrequencyFrame(clock_.Now());
+  ASSERT_TRUE(update.has_value());
+  EXPECT_EQ(kMaxAdaptiveAckFrequencyPacketTolerance, update->packet_tolerance);
+
+  // Reordering makes the peer ignore order.
+  stats_.sent_packets_max_sequence_reordering = 1;
+  clock_.AdvanceTime(rtt);
+  update = manager_.MaybeGetUpdatedAckFrequencyFrame(clock_.Now());
+  ASSERT_TRUE(update.has_value());
+  EXPECT_TRUE(update->ignore_order);
+  EXPECT_EQ(1u, stats_.num_ack_frequency_frames_sent);
+}
+
 TEST_F(QuicSentPacketManagerTest, SmoothedRttIgnoreAckDelay) {
   QuicConfig config;
   QuicTagVector options;
@@ -3246,6 +3337,131 @@ TEST_F(QuicSentPacketManagerTest, GetAvailableCongestionWindow) {
   EXPECT_EQ(0u, manager_.GetAvailableCongestionWindowInBytes());
 }
 
+TEST_F(QuicSentPacketManagerTest, NegotiateMultipath) {
+  SetQuicReloadableFlag(quic_enable_multipath_experiment, true);
+  EXPECT_CALL(*send_algorithm_, SetFromConfig(_, _));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  QuicConfig config;
+  QuicConfigPeer::SetReceivedConnectionOptions(&config, {kMPRR});
+  EXPECT_FALSE(manager_.multipath_enabled());
+  EXPECT_FALSE(manager_.AddPath(1));
+  manager_.SetFromConfig(config);
+  EXPECT_TRUE(manager_.multipath_enabled());
+  EXPECT_FALSE(manager_.DuplicatesPacketsOnAllPaths());
+  EXPECT_TRUE(manager_.AddPath(1));
+}
+
+TEST_F(QuicSentPacketManagerTest, MultipathPerPathRttAndBytesInFlight) {
+  manager_.EnableMultipath(QuicPathSchedulerType::kMinRtt);
+  ASSERT_TRUE(manager_.AddPath(1));
+  EXPECT_FALSE(manager_.AddPath(1));
+  EXPECT_FALSE(manager_.AddPath(kDefaultPathId));
+  EXPECT_FALSE(manager_.AddPath(kMaxNumMultipathPaths));
+  EXPECT_TRUE(manager_.IsPathActive(1));
+  EXPECT_FALSE(manager_.IsPathActive(2));
+  EXPECT_EQ(nullptr, manager_.GetPathRttStats(2));
+
+  SendDataPacket(1, ENCRYPTION_FORWARD_SECURE);
+  SendDataPacketOnPath(2, 1);
+  EXPECT_EQ(2 * kDefaultLength, manager_.GetBytesInFlight());
+  EXPECT_EQ(kDefaultLength, manager_.GetBytesInFlightOnPath(kDefaultPathId));
+  EXPECT_EQ(kDefaultLength, manager_.GetBytesInFlightOnPath(1));
+
+  // Only the congestion controller of path 1 sees the ack of packet 2.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(50));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.OnAckFrameStart(QuicPacketNumber(2), QuicTime::Delta::Zero(),
+                           clock_.Now());
+  manager_.OnAckRange(QuicPacketNumber(2), QuicPacketNumber(3));
+  EXPECT_EQ(PACKETS_NEWLY_ACKED,
+            manager_.OnAckFrameEnd(clock_.Now(), QuicPacketNumber(1),
+                                   ENCRYPTION_FORWARD_SECURE));
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(50),
+            manager_.GetPathRttStats(1)->latest_rtt());
+  EXPECT_TRUE(manager_.GetRttStats()->latest_rtt().IsZero());
+  EXPECT_TRUE(manager_.HasAckedPacketOnPath(1));
+  EXPECT_FALSE(manager_.HasAckedPacketOnPath(kDefaultPathId));
+  EXPECT_EQ(0u, manager_.GetBytesInFlightOnPath(1));
+
+  // The min RTT scheduler prefers path 1, as the default path has no RTT
+  // sample yet.
+  EXPECT_CALL(*send_algorithm_, CanSend(_)).WillRepeatedly(Return(true));
+  EXPECT_EQ(1u, manager_.SelectPathForNextPacket(clock_.Now()));
+
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(50));
+  EXPECT_CALL(*send_algorithm_,
+              OnCongestionEvent(true, kDefaultLength, _,
+                                Pointwise(PacketNumberEq(), {1}), IsEmpty()));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.OnAckFrameStart(QuicPacketNumber(2), QuicTime::Delta::Zero(),
+                           clock_.Now());
+  manager_.OnAckRange(QuicPacketNumber(1), QuicPacketNumber(3));
+  EXPECT_EQ(PACKETS_NEWLY_ACKED,
+            manager_.OnAckFrameEnd(clock_.Now(), QuicPacketNumber(2),
+                                   ENCRYPTION_FORWARD_SECURE));
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(100),
+            manager_.GetRttStats()->latest_rtt());
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(50),
+            manager_.GetPathRttStats(1)->latest_rtt());
+}
+
+TEST_F(QuicSentPacketManagerTest, MultipathLossDetectionIsPerPath) {
+  manager_.EnableMultipath(QuicPathSchedulerType::kMinRtt);
+  ASSERT_TRUE(manager_.AddPath(1));
+  for (uint64_t i = 1; i <= 4; ++i) {
+    SendDataPacketOnPath(i, 1);
+  }
+  for (uint64_t i = 5; i <= 8; ++i) {
+    SendDataPacket(i, ENCRYPTION_FORWARD_SECURE);
+  }
+
+  // Packets 5 to 8 on the faster default path are acked first, which does not
+  // make the packets still in flight on path 1 lost.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(20));
+  uint64_t acked[] = {5, 6, 7, 8};
+  ExpectAcksAndLosses(true, acked, ABSL_ARRAYSIZE(acked), nullptr, 0);
+  manager_.OnAckFrameStart(QuicPacketNumber(8), QuicTime::Delta::Zero(),
+                           clock_.Now());
+  manager_.OnAckRange(QuicPacketNumber(5), QuicPacketNumber(9));
+  EXPECT_EQ(PACKETS_NEWLY_ACKED,
+            manager_.OnAckFrameEnd(clock_.Now(), QuicPacketNumber(1),
+                                   ENCRYPTION_FORWARD_SECURE));
+  EXPECT_EQ(4 * kDefaultLength, manager_.GetBytesInFlightOnPath(1));
+  EXPECT_EQ(0u, stats_.packets_lost);
+
+  // Packets 2 to 4 are acked, and packet 1 is lost by the packet threshold of
+  // path 1.
+  clock_.AdvanceTime(QuicTime::Delta::FromMilliseconds(60));
+  EXPECT_CALL(notifier_, OnFrameLost(_));
+  EXPECT_CALL(*network_change_visitor_, OnCongestionChange());
+  manager_.OnAckFrameStart(QuicPacketNumber(8), QuicTime::Delta::Zero(),
+                           clock_.Now());
+  manager_.OnAckRange(QuicPacketNumber(2), QuicPacketNumber(9));
+  EXPECT_EQ(PACKETS_NEWLY_ACKED,
+            manager_.OnAckFrameEnd(clock_.Now(), QuicPacketNumber(2),
+                                   ENCRYPTION_FORWARD_SECURE));
+  EXPECT_EQ(0u, manager_.GetBytesInFlightOnPath(1));
+  EXPECT_EQ(1u, stats_.packets_lost);
+  EXPECT_EQ(QuicTime::Delta::FromMilliseconds(80),
+            manager_.GetPathRttStats(1)->latest_rtt());
+}
+
+TEST_F(QuicSentPacketManagerTest, RemoveMultipathPath) {
+  manager_.EnableMultipath(QuicPathSchedulerType::kRedundant);
+  EXPECT_TRUE(manager_.DuplicatesPacketsOnAllPaths());
+  ASSERT_TRUE(manager_.AddPath(2));
+  SendDataPacketOnPath(1, 2);
+  EXPECT_EQ(kDefaultLength, manager_.GetBytesInFlightOnPath(2));
+
+  // Packets in flight on the removed path are retransmitted elsewhere.
+  EXPECT_CALL(notifier_, OnFrameLost(_));
+  manager_.RemovePath(2);
+  EXPECT_FALSE(manager_.IsPathActive(2));
+  EXPECT_EQ(0u, manager_.GetBytesInFlightOnPath(2));
+  EXPECT_EQ(0u, manager_.GetBytesInFlight());
+  EXPECT_EQ(kDefaultPathId, manager_.SelectPathForNextPacket(clock_.Now()));
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -1745,6 +1745,10 @@ bool QuicSession::FillTransportParameters(TransportParameters* params) {
       config_.SetOriginalConnectionIdToSend(
           connection_->GetOriginalDestinationConnectionId());
       config_.SetInitialSourceConnectionIdToSend(connection_->connection_id());
+      if (connection_->retry_source_connection_id().has_value()) {
+        config_.SetRetrySourceConnectionIdToSend(
+            *connection_->retry_source_connection_id());
+      }
     } else {
       config_.SetInitialSourceConnectionIdToSend(
           connection_->client_connection_id());
@@ -2357,6 +2361,16 @@ WriteStreamDataResult QuicSession::WriteStreamData(QuicStreamId id,
   return WRITE_FAILED;
 }
 
+absl::string_view QuicSession::GetContiguousStreamData(
+    QuicStreamId id, QuicStreamOffset offset, QuicByteCount data_length) {
+  QuicStream* stream = GetStream(id);
+  if (stream == nullptr) {
+    // Let WriteStreamData report the missing stream.
+    return absl::string_view();
+  }
+  return stream->GetContiguousStreamData(offset, data_length);
+}
+
 bool QuicSession::WriteCryptoData(EncryptionLevel level,
                                   QuicStreamOffset offset,
                                   QuicByteCount data_length,
@@ -180,6 +180,9 @@ class QUIC_EXPORT_PRIVATE QuicSession
                                         QuicStreamOffset offset,
                                         QuicByteCount data_length,
                                         QuicDataWriter* writer) override;
+  absl::string_view GetContiguousStreamData(QuicStreamId id,
+                                            QuicStreamOffset offset,
+                                            QuicByteCount data_length) override;
   bool WriteCryptoData(EncryptionLevel level, QuicStreamOffset offset,
                        QuicByteCount data_length,
                        QuicDataWriter* writer) override;
@@ -1207,6 +1207,12 @@ bool QuicStream::WriteStreamData(QuicStreamOffset offset,
   return send_buffer_.WriteStreamData(offset, data_length, writer);
 }
 
+absl::string_view QuicStream::GetContiguousStreamData(
+    QuicStreamOffset offset, QuicByteCount data_length) {
+  QUICHE_DCHECK_LT(0u, data_length);
+  return send_buffer_.GetContiguousStreamData(offset, data_length);
+}
+
 void QuicStream::WriteBufferedData(EncryptionLevel level) {
   QUICHE_DCHECK(!write_side_closed_ && (HasBufferedData() || fin_buffered_));
 
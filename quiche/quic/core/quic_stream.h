@@ -332,6 +332,11 @@ class QUIC_EXPORT_PRIVATE QuicStream
   bool WriteStreamData(QuicStreamOffset offset, QuicByteCount data_length,
                        QuicDataWriter* writer);
 
+  // Returns |data_length| of data starting at |offset| from send buffer if it
+  // is contiguous, and an empty view otherwise.
+  absl::string_view GetContiguousStreamData(QuicStreamOffset offset,
+                                            QuicByteCount data_length);
+
   // Called when data [offset, offset + data_length) is acked. |fin_acked|
   // indicates whether the fin is acked. Returns true and updates
   // |newly_acked_length| if any new stream data (including fin) gets acked.
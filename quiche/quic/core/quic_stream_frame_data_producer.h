@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_STREAM_FRAME_DATA_PRODUCER_H_
 #define QUICHE_QUIC_CORE_QUIC_STREAM_FRAME_DATA_PRODUCER_H_
 
+#include "absl/strings/string_view.h"
 #include "quiche/quic/core/quic_types.h"
 
 namespace quic {
@@ -25,6 +26,17 @@ class QUIC_EXPORT_PRIVATE QuicStreamFrameDataProducer {
                                                 QuicByteCount data_length,
                                                 QuicDataWriter* writer) = 0;
 
+  // Returns the |data_length| bytes of stream |id| at |offset| if they are
+  // stored contiguously, so that they can be encrypted straight into the
+  // packet without being copied first.  Otherwise returns an empty view, and
+  // WriteStreamData() must be used instead.  The view is only valid until the
+  // stream data is next modified.
+  virtual absl::string_view GetContiguousStreamData(
+      QuicStreamId /*id*/, QuicStreamOffset /*offset*/,
+      QuicByteCount /*data_length*/) {
+    return absl::string_view();
+  }
+
   // Writes the data for a CRYPTO frame to |writer| for a frame at encryption
   // level |level| starting at offset |offset| for |data_length| bytes. Returns
   // whether writing the data was successful.
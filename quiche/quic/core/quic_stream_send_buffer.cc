@@ -145,6 +145,29 @@ bool QuicStreamSendBuffer::WriteStreamData(QuicStreamOffset offset,
   return data_length == 0;
 }
 
+absl::string_view QuicStreamSendBuffer::GetContiguousStreamData(
+    QuicStreamOffset offset, QuicByteCount data_length) {
+  QUIC_BUG_IF(quic_bug_12823_3, current_end_offset_ < offset)
+      << "Tried to write data out of sequence. last_offset_end:"
+      << current_end_offset_ << ", offset:" << offset;
+  auto slice_it = interval_deque_.DataAt(offset);
+  if (data_length == 0 || slice_it == interval_deque_.DataEnd() ||
+      offset < slice_it->offset) {
+    return absl::string_view();
+  }
+  const QuicByteCount slice_offset = offset - slice_it->offset;
+  if (slice_it->slice.length() - slice_offset < data_length) {
+    return absl::string_view();
+  }
+  const absl::string_view data(slice_it->slice.data() + slice_offset,
+                               data_length);
+  const QuicStreamOffset new_end = slice_it->offset + slice_it->slice.length();
+  current_end_offset_ = std::max(current_end_offset_, new_end);
+  // Advances the write index the same way WriteStreamData does.
+  ++slice_it;
+  return data;
+}
+
 bool QuicStreamSendBuffer::OnStreamDataAcked(
     QuicStreamOffset offset, QuicByteCount data_length,
     QuicByteCount* newly_acked_length) {
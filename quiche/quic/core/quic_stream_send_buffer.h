@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_CORE_QUIC_STREAM_SEND_BUFFER_H_
 #define QUICHE_QUIC_CORE_QUIC_STREAM_SEND_BUFFER_H_
 
+#include "absl/strings/string_view.h"
 #include "absl/types/span.h"
 #include "quiche/quic/core/frames/quic_stream_frame.h"
 #include "quiche/quic/core/quic_interval_deque.h"
@@ -84,6 +85,12 @@ class QUIC_EXPORT_PRIVATE QuicStreamSendBuffer {
   bool WriteStreamData(QuicStreamOffset offset, QuicByteCount data_length,
                        QuicDataWriter* writer);
 
+  // Returns the |data_length| bytes of data starting at |offset| if they are
+  // in a single slice, and an empty view otherwise.  Like WriteStreamData,
+  // marks the data as written.
+  absl::string_view GetContiguousStreamData(QuicStreamOffset offset,
+                                            QuicByteCount data_length);
+
   // Called when data [offset, offset + data_length) is acked or removed as
   // stream is canceled. Removes fully acked data slice from send buffer. Set
   // |newly_acked_length|. Returns false if trying to ack unsent data.
@@ -140,6 +140,26 @@ TEST_F(QuicStreamSendBufferTest,
   EXPECT_EQ(3840u, QuicStreamSendBufferPeer::EndOffset(&send_buffer_));
 }
 
+TEST_F(QuicStreamSendBufferTest, GetContiguousStreamData) {
+  EXPECT_EQ(std::string(1024, 'a'),
+            send_buffer_.GetContiguousStreamData(0, 1024));
+  EXPECT_EQ(1, QuicStreamSendBufferPeer::write_index(&send_buffer_));
+  EXPECT_EQ(std::string(512, 'a') + std::string(256, 'b'),
+            send_buffer_.GetContiguousStreamData(1024, 768));
+  EXPECT_EQ(2048u, QuicStreamSendBufferPeer::EndOffset(&send_buffer_));
+
+  // Data across slice boundaries is not contiguous.
+  EXPECT_TRUE(send_buffer_.GetContiguousStreamData(1792, 512).empty());
+  EXPECT_EQ(std::string(256, 'c'),
+            send_buffer_.GetContiguousStreamData(1792, 256));
+  EXPECT_EQ(std::string(1024, 'c'),
+            send_buffer_.GetContiguousStreamData(2048, 1024));
+  EXPECT_TRUE(send_buffer_.GetContiguousStreamData(3072, 1000).empty());
+  EXPECT_EQ(std::string(768, 'd'),
+            send_buffer_.GetContiguousStreamData(3072, 768));
+  EXPECT_EQ(3840u, QuicStreamSendBufferPeer::EndOffset(&send_buffer_));
+}
+
 TEST_F(QuicStreamSendBufferTest, RemoveStreamFrame) {
   WriteAllData();
 
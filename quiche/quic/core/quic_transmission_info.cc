@@ -5,6 +5,7 @@
 #include "quiche/quic/core/quic_transmission_info.h"
 
 #include "absl/strings/str_cat.h"
+#include "quiche/quic/core/quic_constants.h"
 
 namespace quic {
 
@@ -16,7 +17,8 @@ QuicTransmissionInfo::QuicTransmissionInfo()
       in_flight(false),
       state(OUTSTANDING),
       has_crypto_handshake(false),
-      has_ack_frequency(false) {}
+      has_ack_frequency(false),
+      path_id(kDefaultPathId) {}
 
 QuicTransmissionInfo::QuicTransmissionInfo(EncryptionLevel level,
                                            TransmissionType transmission_type,
@@ -31,7 +33,8 @@ QuicTransmissionInfo::QuicTransmissionInfo(EncryptionLevel level,
       in_flight(false),
       state(OUTSTANDING),
       has_crypto_handshake(has_crypto_handshake),
-      has_ack_frequency(has_ack_frequency) {}
+      has_ack_frequency(has_ack_frequency),
+      path_id(kDefaultPathId) {}
 
 QuicTransmissionInfo::QuicTransmissionInfo(const QuicTransmissionInfo& other) =
     default;
@@ -47,6 +50,7 @@ std::string QuicTransmissionInfo::DebugString() const {
       ", in_flight: ", in_flight, ", state: ", state,
       ", has_crypto_handshake: ", has_crypto_handshake,
       ", has_ack_frequency: ", has_ack_frequency,
+      ", path_id: ", static_cast<int>(path_id),
       ", first_sent_after_loss: ", first_sent_after_loss.ToString(),
       ", largest_acked: ", largest_acked.ToString(),
       ", retransmittable_frames: ", QuicFramesToString(retransmittable_frames),
@@ -46,6 +46,8 @@ struct QUIC_EXPORT_PRIVATE QuicTransmissionInfo {
   bool has_crypto_handshake;
   // True if the packet contains ack frequency frame.
   bool has_ack_frequency;
+  // The path this packet was sent on when multipath is in use.
+  QuicPathId path_id;
   // Records the first sent packet after this packet was detected lost. Zero if
   // this packet has not been detected lost. This is used to keep lost packet
   // for another RTT (for potential spurious loss detection)
@@ -406,15 +406,21 @@ bool operator==(const ParsedClientHello& a, const ParsedClientHello& b) {
              b.legacy_version_encapsulation_inner_packet &&
          a.retry_token == b.retry_token &&
          a.resumption_attempted == b.resumption_attempted &&
-         a.early_data_attempted == b.early_data_attempted;
+         a.early_data_attempted == b.early_data_attempted &&
+         a.retry_original_destination_connection_id ==
+             b.retry_original_destination_connection_id;
 }
 
 std::ostream& operator<<(std::ostream& os,
                          const ParsedClientHello& parsed_chlo) {
   os << "{ sni:" << parsed_chlo.sni << ", uaid:" << parsed_chlo.uaid
      << ", alpns:" << quiche::PrintElements(parsed_chlo.alpns)
-     << ", len(retry_token):" << parsed_chlo.retry_token.size()
-     << ", len(inner_packet):"
+     << ", len(retry_token):" << parsed_chlo.retry_token.size();
+  if (parsed_chlo.retry_original_destination_connection_id.has_value()) {
+    os << ", retry_odcid:"
+       << *parsed_chlo.retry_original_destination_connection_id;
+  }
+  os << ", len(inner_packet):"
      << parsed_chlo.legacy_version_encapsulation_inner_packet.size() << " }";
   return os;
 }
@@ -27,6 +27,8 @@ namespace quic {
 using QuicPacketLength = uint16_t;
 using QuicControlFrameId = uint32_t;
 using QuicMessageId = uint32_t;
+// Identifies a path of a multipath connection.
+using QuicPathId = uint8_t;
 
 // IMPORTANT: IETF QUIC defines stream IDs and stream counts as being unsigned
 // 62-bit numbers. However, we have decided to only support up to 2^32-1 streams
@@ -867,6 +869,9 @@ struct QUIC_NO_EXPORT ParsedClientHello {
   std::string retry_token;
   bool resumption_attempted = false;  // TLS only.
   bool early_data_attempted = false;  // TLS only.
+  // Set by QuicDispatcher if |retry_token| is a valid retry token, to the
+  // destination connection ID of the client Initial which was retried.
+  absl::optional<QuicConnectionId> retry_original_destination_connection_id;
 };
 
 QUIC_EXPORT_PRIVATE bool operator==(const ParsedClientHello& a,
@@ -34,6 +34,7 @@ enum class QuicUdpPacketInfoBit : uint8_t {
   RECV_TIMESTAMP,        // Read
   TTL,                   // Read & Write
   GOOGLE_PACKET_HEADER,  // Read
+  GRO_SEGMENT_SIZE,      // Read
   NUM_BITS,
 };
 static_assert(static_cast<size_t>(QuicUdpPacketInfoBit::NUM_BITS) <=
@@ -142,6 +143,18 @@ class QUIC_EXPORT_PRIVATE QuicUdpPacketInfo {
     bitmask_.Set(QuicUdpPacketInfoBit::GOOGLE_PACKET_HEADER);
   }
 
+  // Set if the kernel coalesced several datagrams into the packet buffer, see
+  // QuicUdpSocketApi::EnableGro().
+  size_t gro_segment_size() const {
+    QUICHE_DCHECK(HasValue(QuicUdpPacketInfoBit::GRO_SEGMENT_SIZE));
+    return gro_segment_size_;
+  }
+
+  void SetGroSegmentSize(size_t gro_segment_size) {
+    gro_segment_size_ = gro_segment_size;
+    bitmask_.Set(QuicUdpPacketInfoBit::GRO_SEGMENT_SIZE);
+  }
+
  private:
   BitMask64 bitmask_;
   QuicPacketCount dropped_packets_;
@@ -151,6 +164,7 @@ class QUIC_EXPORT_PRIVATE QuicUdpPacketInfo {
   QuicWallTime receive_timestamp_ = QuicWallTime::Zero();
   int ttl_;
   BufferSpan google_packet_headers_;
+  size_t gro_segment_size_;
 };
 
 // QuicUdpSocketApi provides a minimal set of apis for sending and receiving
@@ -184,6 +198,13 @@ class QUIC_EXPORT_PRIVATE QuicUdpSocketApi {
   bool EnableReceiveTtlForV4(QuicUdpSocketFd fd);
   bool EnableReceiveTtlForV6(QuicUdpSocketFd fd);
 
+  // Enable UDP generic receive offload on |fd|, which lets the kernel
+  // coalesce consecutive datagrams of the same flow into a single read. A
+  // coalesced packet buffer holds datagrams of gro_segment_size() bytes each,
+  // except the last one which may be shorter, and needs to be large enough
+  // for all of them: up to 64 KB. Return false if GRO is not supported.
+  bool EnableGro(QuicUdpSocketFd fd);
+
   // Wait for |fd| to become readable, up to |timeout|.
   // Return true if |fd| is readable upon return.
   bool WaitUntilReadable(QuicUdpSocketFd fd, QuicTime::Delta timeout);
@@ -26,6 +26,13 @@
 
 #if defined(__linux__) && !defined(__ANDROID__)
 #define QUIC_UDP_SOCKET_SUPPORT_TTL 1
+#define QUIC_UDP_SOCKET_SUPPORT_GRO 1
+#ifndef SOL_UDP
+#define SOL_UDP 17
+#endif
+#ifndef UDP_GRO
+#define UDP_GRO 104
+#endif
 #endif
 
 namespace quic {
@@ -56,7 +63,8 @@ const size_t kMinCmsgSpaceForRead =
     + CMSG_SPACE(sizeof(in_pktinfo))   // V4 Self IP
     + CMSG_SPACE(sizeof(in6_pktinfo))  // V6 Self IP
     + kCmsgSpaceForRecvTimestamp + CMSG_SPACE(sizeof(int))  // TTL
-    + kCmsgSpaceForGooglePacketHeader;
+    + kCmsgSpaceForGooglePacketHeader +
+    CMSG_SPACE(sizeof(int));  // GRO segment size
 
 QuicUdpSocketFd CreateNonblockingSocket(int address_family) {
 #if defined(__linux__) && defined(SOCK_NONBLOCK)
@@ -179,6 +187,16 @@ void PopulatePacketInfoFromControlMessage(struct cmsghdr* cmsg,
     return;
   }
 
+#if defined(QUIC_UDP_SOCKET_SUPPORT_GRO)
+  if (cmsg->cmsg_level == SOL_UDP && cmsg->cmsg_type == UDP_GRO) {
+    if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::GRO_SEGMENT_SIZE)) {
+      packet_info->SetGroSegmentSize(
+          *(reinterpret_cast<int*>(CMSG_DATA(cmsg))));
+    }
+    return;
+  }
+#endif
+
   if ((cmsg->cmsg_level == IPPROTO_IP && cmsg->cmsg_type == IP_TTL) ||
       (cmsg->cmsg_level == IPPROTO_IPV6 && cmsg->cmsg_type == IPV6_HOPLIMIT)) {
     if (packet_info_interested.IsSet(QuicUdpPacketInfoBit::TTL)) {
@@ -356,6 +374,16 @@ bool QuicUdpSocketApi::EnableReceiveTtlForV6(QuicUdpSocketFd fd) {
 #endif
 }
 
+bool QuicUdpSocketApi::EnableGro(QuicUdpSocketFd fd) {
+#if defined(QUIC_UDP_SOCKET_SUPPORT_GRO)
+  int gro = 1;
+  return 0 == setsockopt(fd, SOL_UDP, UDP_GRO, &gro, sizeof(gro));
+#else
+  (void)fd;
+  return false;
+#endif
+}
+
 bool QuicUdpSocketApi::WaitUntilReadable(QuicUdpSocketFd fd,
                                          QuicTime::Delta timeout) {
   fd_set read_fds;
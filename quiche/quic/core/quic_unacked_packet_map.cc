@@ -117,6 +117,7 @@ QuicUnackedPacketMap::QuicUnackedPacketMap(Perspective perspective)
       least_unacked_(FirstSendingPacketNumber()),
       bytes_in_flight_(0),
       bytes_in_flight_per_packet_number_space_{0, 0, 0},
+      bytes_in_flight_per_path_{0, 0, 0, 0},
       packets_in_flight_(0),
       last_inflight_packet_sent_time_(QuicTime::Zero()),
       last_inflight_packets_sent_time_{
@@ -153,6 +154,13 @@ void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* mutable_packet,
                             sent_time, bytes_sent, has_crypto_handshake,
                             packet.has_ack_frequency);
   info.largest_acked = packet.largest_acked;
+  if (packet.path_id < kMaxNumMultipathPaths) {
+    info.path_id = packet.path_id;
+  } else {
+    QUIC_BUG(quic_bug_12645_5)
+        << "Packet " << packet_number << " sent on invalid path "
+        << static_cast<int>(packet.path_id);
+  }
   largest_sent_largest_acked_.UpdateMax(packet.largest_acked);
 
   if (!measure_rtt) {
@@ -172,6 +180,7 @@ void QuicUnackedPacketMap::AddSentPacket(SerializedPacket* mutable_packet,
         GetPacketNumberSpace(info.encryption_level);
     bytes_in_flight_ += bytes_sent;
     bytes_in_flight_per_packet_number_space_[packet_number_space] += bytes_sent;
+    bytes_in_flight_per_path_[info.path_id] += bytes_sent;
     ++packets_in_flight_;
     info.in_flight = true;
     largest_sent_retransmittable_packets_[packet_number_space] = packet_number;
@@ -313,6 +322,15 @@ void QuicUnackedPacketMap::RemoveFromInFlight(QuicTransmissionInfo* info) {
     if (bytes_in_flight_per_packet_number_space_[packet_number_space] == 0) {
       last_inflight_packets_sent_time_[packet_number_space] = QuicTime::Zero();
     }
+    if (bytes_in_flight_per_path_[info->path_id] < info->bytes_sent) {
+      QUIC_BUG(quic_bug_10518_9)
+          << "bytes_in_flight: " << bytes_in_flight_per_path_[info->path_id]
+          << " is smaller than bytes_sent: " << info->bytes_sent
+          << " for path: " << static_cast<int>(info->path_id);
+      bytes_in_flight_per_path_[info->path_id] = 0;
+    } else {
+      bytes_in_flight_per_path_[info->path_id] -= info->bytes_sent;
+    }
 
     info->in_flight = false;
   }
@@ -444,6 +462,16 @@ QuicPacketNumber QuicUnackedPacketMap::GetLeastUnacked() const {
   return least_unacked_;
 }
 
+QuicByteCount QuicUnackedPacketMap::GetBytesInFlightOnPath(
+    QuicPathId path_id) const {
+  if (path_id >= kMaxNumMultipathPaths) {
+    QUIC_BUG(quic_bug_10518_10)
+        << "Invalid path: " << static_cast<int>(path_id);
+    return 0;
+  }
+  return bytes_in_flight_per_path_[path_id];
+}
+
 void QuicUnackedPacketMap::SetSessionNotifier(
     SessionNotifierInterface* session_notifier) {
   session_notifier_ = session_notifier;
@@ -106,6 +106,10 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   QuicByteCount bytes_in_flight() const { return bytes_in_flight_; }
   QuicPacketCount packets_in_flight() const { return packets_in_flight_; }
 
+  // Returns the sum of bytes from all packets in flight which were sent on
+  // |path_id|.
+  QuicByteCount GetBytesInFlightOnPath(QuicPathId path_id) const;
+
   // Returns the smallest packet number of a serialized packet which has not
   // been acked by the peer.  If there are no unacked packets, returns 0.
   QuicPacketNumber GetLeastUnacked() const;
@@ -306,6 +310,8 @@ class QUIC_EXPORT_PRIVATE QuicUnackedPacketMap {
   // Bytes in flight per packet number space.
   QuicByteCount
       bytes_in_flight_per_packet_number_space_[NUM_PACKET_NUMBER_SPACES];
+  // Bytes in flight per multipath path, indexed by path ID.
+  QuicByteCount bytes_in_flight_per_path_[kMaxNumMultipathPaths];
   QuicPacketCount packets_in_flight_;
 
   // Time that the last inflight packet was sent.
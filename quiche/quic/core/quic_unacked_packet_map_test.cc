@@ -667,6 +667,36 @@ TEST_P(QuicUnackedPacketMapTest, ReserveInitialCapacityTest) {
   ASSERT_EQ(QuicUnackedPacketMapPeer::GetCapacity(unacked_packets), 16u);
 }
 
+TEST_P(QuicUnackedPacketMapTest, BytesInFlightPerPath) {
+  SerializedPacket packet1(CreateRetransmittablePacket(1));
+  unacked_packets_.AddSentPacket(&packet1, NOT_RETRANSMISSION, now_, true,
+                                 true);
+  SerializedPacket packet2(CreateRetransmittablePacket(2));
+  packet2.path_id = 1;
+  unacked_packets_.AddSentPacket(&packet2, NOT_RETRANSMISSION, now_, true,
+                                 true);
+  SerializedPacket packet3(CreateRetransmittablePacket(3));
+  packet3.path_id = 1;
+  unacked_packets_.AddSentPacket(&packet3, NOT_RETRANSMISSION, now_, true,
+                                 true);
+  EXPECT_EQ(kDefaultPathId,
+            unacked_packets_.GetTransmissionInfo(QuicPacketNumber(1)).path_id);
+  EXPECT_EQ(1u,
+            unacked_packets_.GetTransmissionInfo(QuicPacketNumber(2)).path_id);
+  EXPECT_EQ(3 * kDefaultLength, unacked_packets_.bytes_in_flight());
+  EXPECT_EQ(kDefaultLength,
+            unacked_packets_.GetBytesInFlightOnPath(kDefaultPathId));
+  EXPECT_EQ(2 * kDefaultLength, unacked_packets_.GetBytesInFlightOnPath(1));
+  EXPECT_EQ(0u, unacked_packets_.GetBytesInFlightOnPath(2));
+
+  unacked_packets_.RemoveFromInFlight(QuicPacketNumber(2));
+  EXPECT_EQ(kDefaultLength,
+            unacked_packets_.GetBytesInFlightOnPath(kDefaultPathId));
+  EXPECT_EQ(kDefaultLength, unacked_packets_.GetBytesInFlightOnPath(1));
+  unacked_packets_.RemoveFromInFlight(QuicPacketNumber(1));
+  EXPECT_EQ(0u, unacked_packets_.GetBytesInFlightOnPath(kDefaultPathId));
+}
+
 TEST_P(QuicUnackedPacketMapTest, DebugString) {
   EXPECT_EQ(unacked_packets_.DebugString(),
             "{size: 0, least_unacked: 1, largest_sent_packet: uninitialized, "
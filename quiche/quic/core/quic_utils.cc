@@ -15,6 +15,7 @@
 #include "absl/numeric/int128.h"
 #include "absl/strings/string_view.h"
 #include "openssl/sha.h"
+#include "openssl/siphash.h"
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_constants.h"
 #include "quiche/quic/core/quic_types.h"
@@ -481,6 +482,26 @@ QuicConnectionId QuicUtils::CreateReplacementConnectionId(
                           expected_connection_id_length);
 }
 
+// static
+QuicConnectionId QuicUtils::CreateKeyedReplacementConnectionId(
+    const QuicConnectionId& connection_id, const uint64_t key[2],
+    uint8_t expected_connection_id_length) {
+  char new_connection_id_data[255] = {};
+  uint64_t block = SIPHASH_24(
+      key, reinterpret_cast<const uint8_t*>(connection_id.data()),
+      connection_id.length());
+  // Each further block is the hash of the previous one.
+  for (size_t offset = 0; offset < expected_connection_id_length;
+       offset += sizeof(block)) {
+    memcpy(new_connection_id_data + offset, &block,
+           std::min(sizeof(block), expected_connection_id_length - offset));
+    block = SIPHASH_24(key, reinterpret_cast<const uint8_t*>(&block),
+                       sizeof(block));
+  }
+  return QuicConnectionId(new_connection_id_data,
+                          expected_connection_id_length);
+}
+
 // static
 QuicConnectionId QuicUtils::CreateRandomConnectionId() {
   return CreateRandomConnectionId(kQuicDefaultConnectionIdLength,
@@ -167,6 +167,13 @@ class QUIC_EXPORT_PRIVATE QuicUtils {
       const QuicConnectionId& connection_id,
       uint8_t expected_connection_id_length);
 
+  // Like CreateReplacementConnectionId(), but derived with SipHash-2-4 under
+  // |key|, so that the result cannot be predicted from |connection_id|
+  // without the key.
+  static QuicConnectionId CreateKeyedReplacementConnectionId(
+      const QuicConnectionId& connection_id, const uint64_t key[2],
+      uint8_t expected_connection_id_length);
+
   // Generates a 64bit connection ID derived from |connection_id|.
   // This is guaranteed to be deterministic (calling this method with two
   // connection IDs that are equal is guaranteed to produce the same result).
@@ -200,6 +200,29 @@ TEST_F(QuicUtilsTest, ReplacementConnectionIdIsDeterministic) {
             QuicUtils::CreateReplacementConnectionId(connection_id72b, 255));
 }
 
+TEST_F(QuicUtilsTest, KeyedReplacementConnectionId) {
+  const uint64_t key[2] = {1, 2};
+  const uint64_t other_key[2] = {1, 3};
+  const QuicConnectionId connection_id = TestConnectionId(33);
+  for (uint8_t length : {0, 1, 8, 9, 20, 255}) {
+    const QuicConnectionId replacement =
+        QuicUtils::CreateKeyedReplacementConnectionId(connection_id, key,
+                                                      length);
+    EXPECT_EQ(length, replacement.length());
+    EXPECT_EQ(replacement, QuicUtils::CreateKeyedReplacementConnectionId(
+                               TestConnectionId(33), key, length));
+    if (length < 8) {
+      continue;
+    }
+    EXPECT_NE(replacement, QuicUtils::CreateKeyedReplacementConnectionId(
+                               connection_id, other_key, length));
+    EXPECT_NE(replacement, QuicUtils::CreateKeyedReplacementConnectionId(
+                               TestConnectionId(34), key, length));
+    EXPECT_NE(replacement,
+              QuicUtils::CreateReplacementConnectionId(connection_id, length));
+  }
+}
+
 TEST_F(QuicUtilsTest, ReplacementConnectionIdLengthIsCorrect) {
   // Verify that all lengths get replaced by kQuicDefaultConnectionIdLength.
   const char connection_id_bytes[255] = {};
@@ -10,6 +10,7 @@
 #include "absl/strings/str_cat.h"
 #include "absl/strings/string_view.h"
 #include "openssl/ssl.h"
+#include "quiche/quic/core/crypto/tls_client_hello_parser.h"
 #include "quiche/quic/core/frames/quic_crypto_frame.h"
 #include "quiche/quic/core/quic_data_reader.h"
 #include "quiche/quic/core/quic_error_codes.h"
@@ -18,6 +19,8 @@
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/core/quic_versions.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
+#include "quiche/quic/platform/api/quic_flag_utils.h"
+#include "quiche/quic/platform/api/quic_flags.h"
 
 namespace quic {
 
@@ -49,6 +52,7 @@ TlsChloExtractor& TlsChloExtractor::operator=(TlsChloExtractor&& other) {
   crypto_stream_sequencer_ = std::move(other.crypto_stream_sequencer_);
   crypto_stream_sequencer_.set_stream(this);
   ssl_ = std::move(other.ssl_);
+  chlo_buffer_ = std::move(other.chlo_buffer_);
   if (ssl_) {
     std::pair<SSL_CTX*, int> shared_handles = GetSharedSslHandles();
     int ex_data_index = shared_handles.second;
@@ -179,6 +183,12 @@ bool TlsChloExtractor::OnCryptoFrame(const QuicCryptoFrame& frame) {
 // Called by the QuicStreamSequencer when it receives a CRYPTO frame that
 // advances the amount of contiguous data we now have starting from offset 0.
 void TlsChloExtractor::OnDataAvailable() {
+  if (GetQuicReloadableFlag(quic_parse_chlo_without_ssl)) {
+    QUIC_RELOADABLE_FLAG_COUNT(quic_parse_chlo_without_ssl);
+    ParseChloWithoutSsl();
+    return;
+  }
+
   // Lazily set up BoringSSL handle.
   SetupSslHandle();
 
@@ -201,6 +211,48 @@ void TlsChloExtractor::OnDataAvailable() {
   (void)SSL_do_handshake(ssl_.get());
 }
 
+void TlsChloExtractor::ParseChloWithoutSsl() {
+  if (HasParsedFullChlo() || state_ == State::kUnrecoverableFailure) {
+    return;
+  }
+
+  // Parse the CHLO in place when it is contiguous in the sequencer's buffer,
+  // which is the common case, and from a copy of the crypto stream otherwise.
+  absl::string_view chlo;
+  struct iovec iov;
+  if (chlo_buffer_.empty() &&
+      crypto_stream_sequencer_.GetReadableRegion(&iov)) {
+    chlo = absl::string_view(static_cast<const char*>(iov.iov_base),
+                             iov.iov_len);
+  }
+  const size_t chlo_length = TlsClientHelloParser::MessageLength(chlo);
+  if (chlo_length == 0 || chlo.length() < chlo_length) {
+    crypto_stream_sequencer_.Read(&chlo_buffer_);
+    chlo = chlo_buffer_;
+  }
+
+  TlsClientHelloParser parser;
+  switch (parser.Parse(chlo)) {
+    case TlsClientHelloParser::Result::kIncomplete:
+      return;
+    case TlsClientHelloParser::Result::kError:
+      HandleUnrecoverableError(
+          absl::StrCat("Failed to parse CHLO: ", parser.error_details()));
+      return;
+    case TlsClientHelloParser::Result::kParsed:
+      break;
+  }
+
+  server_name_ = std::string(parser.server_name());
+  for (absl::string_view alpn : parser.alpns()) {
+    alpns_.emplace_back(alpn);
+  }
+  resumption_attempted_ = parser.resumption_attempted();
+  early_data_attempted_ = parser.early_data_attempted();
+  chlo_buffer_.clear();
+  UpdateStateOnFullChlo();
+}
+
 // static
 TlsChloExtractor* TlsChloExtractor::GetInstanceFromSSL(SSL* ssl) {
   std::pair<SSL_CTX*, int> shared_handles = GetSharedSslHandles();
@@ -313,7 +365,10 @@ void TlsChloExtractor::HandleParsedChlo(const SSL_CLIENT_HELLO* client_hello) {
     }
   }
 
-  // Update our state now that we've parsed a full CHLO.
+  UpdateStateOnFullChlo();
+}
+
+void TlsChloExtractor::UpdateStateOnFullChlo() {
   if (state_ == State::kInitial) {
     state_ = State::kParsedFullSinglePacketChlo;
   } else if (state_ == State::kParsedPartialChloFragment) {
@@ -195,6 +195,10 @@ class QUIC_NO_EXPORT TlsChloExtractor
   bool MaybeAttemptToParseChloLength();
   // Parses the full CHLO message if enough data has been received.
   void AttemptToParseFullChlo();
+  // Parses the CHLO with TlsClientHelloParser once it has been fully received.
+  void ParseChloWithoutSsl();
+  // Advances the state once a full CHLO has been parsed.
+  void UpdateStateOnFullChlo();
   // Moves to the failed state and records the error details.
   void HandleUnrecoverableError(const std::string& error_details);
   // Lazily sets up shared SSL handles if needed.
@@ -233,6 +237,9 @@ class QUIC_NO_EXPORT TlsChloExtractor
   QuicStreamSequencer crypto_stream_sequencer_;
   // BoringSSL handle required to parse the CHLO.
   bssl::UniquePtr<SSL> ssl_;
+  // Copy of the crypto stream, used by ParseChloWithoutSsl when the CHLO is not
+  // contiguous in the sequencer's buffer.
+  std::string chlo_buffer_;
   // State of this TlsChloExtractor.
   State state_;
   // Detail string that can be logged in the presence of unrecoverable errors.
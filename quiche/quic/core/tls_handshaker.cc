@@ -9,6 +9,7 @@
 #include "absl/strings/string_view.h"
 #include "openssl/crypto.h"
 #include "openssl/ssl.h"
+#include "quiche/quic/core/crypto/tls_cert_compression.h"
 #include "quiche/quic/core/quic_crypto_stream.h"
 #include "quiche/quic/core/tls_client_handshaker.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
@@ -358,6 +359,11 @@ void TlsHandshaker::WriteMessage(EncryptionLevel level,
 
 void TlsHandshaker::FlushFlight() {}
 
+bool TlsHandshaker::CompressCertificate(absl::string_view certificate_message,
+                                        std::string* compressed) {
+  return TlsCompressCertificate(certificate_message, compressed);
+}
+
 void TlsHandshaker::SendAlert(EncryptionLevel level, uint8_t desc) {
   std::string error_details = absl::StrCat(
       "TLS handshake failure (", EncryptionLevelToString(level), ") ",
@@ -166,6 +166,11 @@ class QUIC_EXPORT_PRIVATE TlsHandshaker : public TlsConnection::Delegate,
   // See |SSL_CTX_set_info_callback| for the meaning of |type| and |value|.
   void InfoCallback(int /*type*/, int /*value*/) override {}
 
+  // Compresses |certificate_message| with zlib. Subclasses can override it to
+  // serve the compressed message from a cache.
+  bool CompressCertificate(absl::string_view certificate_message,
+                           std::string* compressed) override;
+
  private:
   // ProofVerifierCallbackImpl handles the result of an asynchronous certificate
   // verification operation.
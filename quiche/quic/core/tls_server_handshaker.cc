@@ -252,6 +252,15 @@ void TlsServerHandshaker::InfoCallback(int type, int value) {
   }
 }
 
+bool TlsServerHandshaker::CompressCertificate(
+    absl::string_view certificate_message, std::string* compressed) {
+  if (selected_cert_chain_ == nullptr) {
+    return TlsHandshaker::CompressCertificate(certificate_message, compressed);
+  }
+  return crypto_config_->tls_compressed_certs_cache()->GetOrCompress(
+      selected_cert_chain_, certificate_message, compressed);
+}
+
 std::unique_ptr<ProofSourceHandle>
 TlsServerHandshaker::MaybeCreateProofSourceHandle() {
   return std::make_unique<DefaultProofSourceHandle>(this, proof_source_);
@@ -774,6 +783,9 @@ ssl_ticket_aead_result_t TlsServerHandshaker::SessionTicketOpen(
 
   ssl_ticket_aead_result_t result =
       FinalizeSessionTicketOpen(out, out_len, max_out_len);
+  if (result == ssl_ticket_aead_success) {
+    MaybeRejectReplayedEarlyData(in);
+  }
 
   QuicConnectionStats::TlsServerOperationStats decrypt_ticket_stats;
   decrypt_ticket_stats.success = (result == ssl_ticket_aead_success);
@@ -812,6 +824,17 @@ ssl_ticket_aead_result_t TlsServerHandshaker::FinalizeSessionTicketOpen(
   return ssl_ticket_aead_success;
 }
 
+void TlsServerHandshaker::MaybeRejectReplayedEarlyData(
+    absl::string_view ticket) {
+  if (!early_data_attempted_ ||
+      proof_source_->GetTicketCrypter()->ShouldAcceptEarlyData(ticket)) {
+    return;
+  }
+  QUIC_CODE_COUNT(quic_tls_server_rejected_replayed_early_data);
+  QUIC_DVLOG(1) << "Rejecting early data of a possibly replayed ClientHello";
+  SSL_set_early_data_enabled(ssl(), 0);
+}
+
 ssl_select_cert_result_t TlsServerHandshaker::EarlySelectCertCallback(
     const SSL_CLIENT_HELLO* client_hello) {
   // EarlySelectCertCallback can be called twice from BoringSSL: If the first
@@ -981,6 +1004,7 @@ void TlsServerHandshaker::OnSelectCertificateDone(
   if (ok) {
     if (chain && !chain->certs.empty()) {
       tls_connection_.SetCertChain(chain->ToCryptoBuffers().value);
+      selected_cert_chain_ = chain;
       if (!handshake_hints.empty() &&
           !SSL_set_handshake_hints(
               ssl(), reinterpret_cast<const uint8_t*>(handshake_hints.data()),
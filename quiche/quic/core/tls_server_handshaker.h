@@ -107,6 +107,11 @@ class QUIC_EXPORT_PRIVATE TlsServerHandshaker
   // Override for tracing.
   void InfoCallback(int type, int value) override;
 
+  // Override to serve the compressed certificate chain from the
+  // TlsCompressedCertsCache of |crypto_config_|.
+  bool CompressCertificate(absl::string_view certificate_message,
+                           std::string* compressed) override;
+
   // Creates a proof source handle for selecting cert and computing signature.
   virtual std::unique_ptr<ProofSourceHandle> MaybeCreateProofSourceHandle();
 
@@ -309,6 +314,10 @@ class QUIC_EXPORT_PRIVATE TlsServerHandshaker
   };
   SetApplicationSettingsResult SetApplicationSettings(absl::string_view alpn);
 
+  // Called once |ticket| is decrypted. Disables early data if the ClientHello
+  // offers it and the ticket crypter considers it a replay.
+  void MaybeRejectReplayedEarlyData(absl::string_view ticket);
+
   QuicConnectionStats& connection_stats() {
     return session()->connection()->mutable_stats();
   }
@@ -366,6 +375,9 @@ class QUIC_EXPORT_PRIVATE TlsServerHandshaker
       crypto_negotiated_params_;
   TlsServerConnection tls_connection_;
   const QuicCryptoServerConfig* crypto_config_;  // Unowned.
+  // The chain passed to OnSelectCertificateDone, used as the key of the
+  // compressed certs cache. Never dereferenced.
+  const ProofSource::Chain* selected_cert_chain_ = nullptr;
   // The last received CachedNetworkParameters from a validated address token.
   mutable std::unique_ptr<CachedNetworkParameters>
       last_received_cached_network_params_;
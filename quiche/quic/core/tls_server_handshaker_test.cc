@@ -911,6 +911,61 @@ TEST_P(TlsServerHandshakerTest, ZeroRttRejectOnApplicationStateChange) {
   EXPECT_FALSE(server_stream()->IsZeroRtt());
 }
 
+TEST_P(TlsServerHandshakerTest, ZeroRttRejectedAsReplay) {
+  std::vector<uint8_t> application_state = {0, 1, 2, 3};
+
+  // Do the first handshake
+  server_stream()->SetServerApplicationStateForResumption(
+      std::make_unique<ApplicationState>(application_state));
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_FALSE(client_stream()->IsResumption());
+  EXPECT_EQ(0u, ticket_crypter_->num_early_data_checks());
+
+  // Do another handshake, with the ticket crypter considering the ClientHello
+  // a replay.
+  ticket_crypter_->set_reject_early_data(true);
+  InitializeServer();
+  server_stream()->SetServerApplicationStateForResumption(
+      std::make_unique<ApplicationState>(application_state));
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_NE(client_stream()->IsResumption(), GetParam().disable_resumption);
+  EXPECT_FALSE(server_stream()->IsZeroRtt());
+  EXPECT_EQ(GetParam().disable_resumption ? 0u : 1u,
+            ticket_crypter_->num_early_data_checks());
+}
+
+TEST_P(TlsServerHandshakerTest, ZeroRttReplayCheckAfterTicketDecryption) {
+  if (GetParam().disable_resumption) {
+    return;
+  }
+  std::vector<uint8_t> application_state = {0, 1, 2, 3};
+
+  // Do the first handshake
+  server_stream()->SetServerApplicationStateForResumption(
+      std::make_unique<ApplicationState>(application_state));
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+
+  // Do another handshake with a ticket which fails to decrypt. It must not be
+  // recorded as used, or anyone could fill the replay state of the crypter
+  // with forged tickets.
+  ticket_crypter_->set_fail_decrypt(true);
+  InitializeServer();
+  server_stream()->SetServerApplicationStateForResumption(
+      std::make_unique<ApplicationState>(application_state));
+  InitializeFakeClient();
+  CompleteCryptoHandshake();
+  ExpectHandshakeSuccessful();
+  EXPECT_TRUE(server_stream()->ResumptionAttempted());
+  EXPECT_FALSE(server_stream()->IsZeroRtt());
+  EXPECT_EQ(0u, ticket_crypter_->num_early_data_checks());
+}
+
 TEST_P(TlsServerHandshakerTest, RequestClientCert) {
   ASSERT_TRUE(SetupClientCert());
   InitializeFakeClient();
@@ -1047,6 +1102,51 @@ TEST_P(TlsServerHandshakerTest, CloseConnectionBeforeSelectCert) {
                   .empty());
 }
 
+TEST_P(TlsServerHandshakerTest, CertificateCompression) {
+  // Restarts the handshake from scratch, with SSL_CTXs created under the
+  // current flag values, and returns the number of round trips it took.
+  auto do_full_handshake = [this]() {
+    client_crypto_config_ = std::make_unique<QuicCryptoClientConfig>(
+        crypto_test_utils::ProofVerifierForTesting(),
+        std::make_unique<test::SimpleSessionCache>());
+    InitializeServer();
+    InitializeFakeClient();
+    int round_trips = 0;
+    while ((!client_stream()->one_rtt_keys_available() ||
+            !server_stream()->one_rtt_keys_available()) &&
+           round_trips < 10) {
+      AdvanceHandshakeWithFakeClient();
+      ++round_trips;
+    }
+    ExpectHandshakeSuccessful();
+    return round_trips;
+  };
+
+  SetQuicReloadableFlag(quic_tls_compress_certificates, false);
+  InitializeServerConfig();
+  const int uncompressed_round_trips = do_full_handshake();
+  const QuicByteCount uncompressed_bytes =
+      client_stream()->BytesReadOnLevel(ENCRYPTION_HANDSHAKE);
+
+  SetQuicReloadableFlag(quic_tls_compress_certificates, true);
+  InitializeServerConfig();
+  const int compressed_round_trips = do_full_handshake();
+  const QuicByteCount compressed_bytes =
+      client_stream()->BytesReadOnLevel(ENCRYPTION_HANDSHAKE);
+
+  // The server's first flight shrinks, so it fits the anti-amplification
+  // limit in no more round trips than before.
+  EXPECT_LT(compressed_bytes, uncompressed_bytes);
+  EXPECT_LE(compressed_round_trips, uncompressed_round_trips);
+  EXPECT_EQ(1u, server_crypto_config_->tls_compressed_certs_cache()->Size());
+
+  // A second handshake is served from the cache.
+  EXPECT_EQ(compressed_round_trips, do_full_handshake());
+  EXPECT_LT(client_stream()->BytesReadOnLevel(ENCRYPTION_HANDSHAKE),
+            uncompressed_bytes);
+  EXPECT_EQ(1u, server_crypto_config_->tls_compressed_certs_cache()->Size());
+}
+
 }  // namespace
 }  // namespace test
 }  // namespace quic
@@ -8,6 +8,7 @@
 #include <string_view>
 
 #include "openssl/aes.h"
+#include "openssl/cipher.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
 
 namespace quic {
@@ -50,6 +51,34 @@ absl::optional<AES_KEY> BuildKey(absl::string_view key, bool encrypt) {
   return raw_key;
 }
 
+// Initializes an AES-ECB context without padding for the batched functions.
+bssl::UniquePtr<EVP_CIPHER_CTX> BuildBatchContext(absl::string_view key,
+                                                  bool encrypt) {
+  if (key.empty()) {
+    return nullptr;
+  }
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
+  if (ctx == nullptr ||
+      !EVP_CipherInit_ex(ctx.get(), EVP_aes_128_ecb(), nullptr,
+                         reinterpret_cast<const uint8_t *>(key.data()),
+                         nullptr, encrypt ? 1 : 0) ||
+      !EVP_CIPHER_CTX_set_padding(ctx.get(), 0)) {
+    return nullptr;
+  }
+  return ctx;
+}
+
+bssl::UniquePtr<EVP_CIPHER_CTX> CopyBatchContext(const EVP_CIPHER_CTX *from) {
+  if (from == nullptr) {
+    return nullptr;
+  }
+  bssl::UniquePtr<EVP_CIPHER_CTX> ctx(EVP_CIPHER_CTX_new());
+  if (ctx == nullptr || !EVP_CIPHER_CTX_copy(ctx.get(), from)) {
+    return nullptr;
+  }
+  return ctx;
+}
+
 // Functions to handle 4-pass encryption/decryption.
 // TakePlaintextFrom{Left,Right}() reads the left or right half of 'from' and
 // expands it into a full encryption block ('to') in accordance with the
@@ -160,6 +189,52 @@ bool LoadBalancerConfig::EncryptionPass(absl::Span<uint8_t> target,
   return true;
 }
 
+bool LoadBalancerConfig::BatchEncryptionPass(absl::Span<uint8_t> targets,
+                                             const uint8_t stride,
+                                             const uint8_t index) const {
+  if (batch_encrypt_ctx_ == nullptr || stride < plaintext_len() ||
+      targets.size() % stride != 0 ||
+      targets.size() / stride > kLoadBalancerMaxBatchSize) {
+    return false;
+  }
+  const size_t num_targets = targets.size() / stride;
+  uint8_t buf[kLoadBalancerMaxBatchSize * kLoadBalancerBlockSize];
+  for (size_t i = 0; i < num_targets; ++i) {
+    uint8_t *target = targets.data() + i * stride;
+    uint8_t *block = buf + i * kLoadBalancerBlockSize;
+    if (index % 2) {
+      TakePlaintextFromLeft(block, target, plaintext_len(), index);
+    } else {
+      TakePlaintextFromRight(block, target, plaintext_len(), index);
+    }
+  }
+  int out_len;
+  if (!EVP_EncryptUpdate(batch_encrypt_ctx_.get(), buf, &out_len, buf,
+                         num_targets * kLoadBalancerBlockSize)) {
+    return false;
+  }
+  for (size_t i = 0; i < num_targets; ++i) {
+    uint8_t *target = targets.data() + i * stride;
+    uint8_t *block = buf + i * kLoadBalancerBlockSize;
+    if (index % 2) {
+      CiphertextXorWithRight(target, block, plaintext_len());
+    } else {
+      CiphertextXorWithLeft(target, block, plaintext_len());
+    }
+  }
+  return true;
+}
+
+bool LoadBalancerConfig::BatchBlockDecrypt(absl::Span<uint8_t> blocks) const {
+  if (batch_decrypt_ctx_ == nullptr ||
+      blocks.size() % kLoadBalancerBlockSize != 0) {
+    return false;
+  }
+  int out_len;
+  return EVP_DecryptUpdate(batch_decrypt_ctx_.get(), blocks.data(), &out_len,
+                           blocks.data(), blocks.size());
+}
+
 bool LoadBalancerConfig::BlockEncrypt(
     const uint8_t plaintext[kLoadBalancerBlockSize],
     uint8_t ciphertext[kLoadBalancerBlockSize]) const {
@@ -190,6 +265,34 @@ LoadBalancerConfig::LoadBalancerConfig(const uint8_t config_id,
       key_(BuildKey(key, /* encrypt = */ true)),
       block_decrypt_key_((server_id_len + nonce_len == kLoadBalancerBlockSize)
                              ? BuildKey(key, /* encrypt = */ false)
-                             : absl::optional<AES_KEY>()) {}
+                             : absl::optional<AES_KEY>()),
+      batch_encrypt_ctx_(BuildBatchContext(key, /* encrypt = */ true)),
+      batch_decrypt_ctx_(
+          (server_id_len + nonce_len == kLoadBalancerBlockSize)
+              ? BuildBatchContext(key, /* encrypt = */ false)
+              : nullptr) {}
+
+LoadBalancerConfig::LoadBalancerConfig(const LoadBalancerConfig &other)
+    : config_id_(other.config_id_),
+      server_id_len_(other.server_id_len_),
+      nonce_len_(other.nonce_len_),
+      key_(other.key_),
+      block_decrypt_key_(other.block_decrypt_key_),
+      batch_encrypt_ctx_(CopyBatchContext(other.batch_encrypt_ctx_.get())),
+      batch_decrypt_ctx_(CopyBatchContext(other.batch_decrypt_ctx_.get())) {}
+
+LoadBalancerConfig &LoadBalancerConfig::operator=(
+    const LoadBalancerConfig &other) {
+  if (this != &other) {
+    config_id_ = other.config_id_;
+    server_id_len_ = other.server_id_len_;
+    nonce_len_ = other.nonce_len_;
+    key_ = other.key_;
+    block_decrypt_key_ = other.block_decrypt_key_;
+    batch_encrypt_ctx_ = CopyBatchContext(other.batch_encrypt_ctx_.get());
+    batch_decrypt_ctx_ = CopyBatchContext(other.batch_decrypt_ctx_.get());
+  }
+  return *this;
+}
 
 }  // namespace quic
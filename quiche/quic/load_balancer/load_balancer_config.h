@@ -5,7 +5,9 @@
 #ifndef QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_CONFIG_H_
 #define QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_CONFIG_H_
 
+#include "absl/types/span.h"
 #include "openssl/aes.h"
+#include "openssl/cipher.h"
 #include "quiche/quic/core/quic_types.h"
 #include "quiche/quic/platform/api/quic_export.h"
 
@@ -19,6 +21,9 @@ inline constexpr uint8_t kLoadBalancerBlockSize = 16;
 inline constexpr uint8_t kLoadBalancerMaxNonceLen = 16;
 inline constexpr uint8_t kLoadBalancerMinNonceLen = 4;
 inline constexpr uint8_t kNumLoadBalancerCryptoPasses = 4;
+// Maximum number of connection IDs processed by one call to
+// LoadBalancerConfig::BatchEncryptionPass().
+inline constexpr uint8_t kLoadBalancerMaxBatchSize = 64;
 
 // This the base class for QUIC-LB configuration. It contains configuration
 // elements usable by both encoders (servers) and decoders (load balancers).
@@ -45,6 +50,10 @@ class QUIC_EXPORT_PRIVATE LoadBalancerConfig {
       const uint8_t config_id, const uint8_t server_id_len,
       const uint8_t nonce_len);
 
+  // Copies duplicate the cipher contexts, which cannot be shared.
+  LoadBalancerConfig(const LoadBalancerConfig& other);
+  LoadBalancerConfig& operator=(const LoadBalancerConfig& other);
+
   // Handles one pass of 4-pass encryption. Encoder and decoder use of this
   // function varies substantially, so they are not implemented here.
   // Returns false if the config is not encrypted, or if |target| isn't long
@@ -61,6 +70,26 @@ class QUIC_EXPORT_PRIVATE LoadBalancerConfig {
       const uint8_t ciphertext[kLoadBalancerBlockSize],
       uint8_t plaintext[kLoadBalancerBlockSize]) const;
 
+  // Batched versions of EncryptionPass() and BlockDecrypt() for load balancers
+  // decoding many connection IDs at once. They encrypt or decrypt all the
+  // blocks with a single call into BoringSSL, which pipelines the AES
+  // instructions of the blocks. Unlike the other functions, they use cipher
+  // contexts owned by the config, so they must not be called concurrently on
+  // the same config.
+  //
+  // Handles one pass of 4-pass encryption for the connection IDs in |targets|,
+  // the plaintexts of which are |stride| bytes apart. Returns false if the
+  // config is not encrypted, if |stride| is shorter than plaintext_len() or
+  // does not divide the size of |targets|, or if |targets| holds more than
+  // kLoadBalancerMaxBatchSize connection IDs.
+  ABSL_MUST_USE_RESULT bool BatchEncryptionPass(absl::Span<uint8_t> targets,
+                                                uint8_t stride,
+                                                uint8_t index) const;
+  // Decrypts |blocks| in place. Returns false if the config does not require
+  // block decryption or the size of |blocks| is not a multiple of
+  // kLoadBalancerBlockSize.
+  ABSL_MUST_USE_RESULT bool BatchBlockDecrypt(absl::Span<uint8_t> blocks) const;
+
   uint8_t config_id() const { return config_id_; }
   uint8_t server_id_len() const { return server_id_len_; }
   uint8_t nonce_len() const { return nonce_len_; }
@@ -87,6 +116,11 @@ class QUIC_EXPORT_PRIVATE LoadBalancerConfig {
   // AES_decrypt requires an AES_KEY that is initialized differently. In all
   // other cases, block_decrypt_key_ is empty.
   absl::optional<AES_KEY> block_decrypt_key_;
+  // AES-ECB contexts for the batched functions, holding the same key schedules
+  // as key_ and block_decrypt_key_ respectively. Null when the corresponding
+  // key is empty.
+  bssl::UniquePtr<EVP_CIPHER_CTX> batch_encrypt_ctx_;
+  bssl::UniquePtr<EVP_CIPHER_CTX> batch_decrypt_ctx_;
 };
 
 }  // namespace quic
@@ -149,6 +149,71 @@ TEST_F(LoadBalancerConfigTest, BlockEncryptionExample) {
   EXPECT_EQ(memcmp(result, ptext, sizeof(ptext)), 0);
 }
 
+// The batched functions give the same results as the single ones, also on a
+// copy of the config.
+TEST_F(LoadBalancerConfigTest, BatchEncryptionPass) {
+  auto config =
+      LoadBalancerConfig::Create(0, 3, 4, absl::string_view(raw_key, 16));
+  ASSERT_TRUE(config.has_value());
+  const LoadBalancerConfig copy = *config;
+  // Three connection IDs, one spare byte apart.
+  constexpr uint8_t kStride = 8;
+  std::array<uint8_t, 3 * kStride> batch;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i] = static_cast<uint8_t>(i * 37);
+  }
+  std::array<uint8_t, 3 * kStride> expected = batch;
+  for (uint8_t index = 1; index <= kNumLoadBalancerCryptoPasses; ++index) {
+    for (size_t i = 0; i < 3; ++i) {
+      EXPECT_TRUE(config->EncryptionPass(
+          absl::Span<uint8_t>(expected.data() + i * kStride, kStride), index));
+    }
+    EXPECT_TRUE(copy.BatchEncryptionPass(absl::Span<uint8_t>(batch), kStride,
+                                         index));
+    EXPECT_EQ(batch, expected);
+  }
+
+  // Stride too short, or not dividing the batch.
+  EXPECT_FALSE(config->BatchEncryptionPass(absl::Span<uint8_t>(batch), 6, 1));
+  EXPECT_FALSE(config->BatchEncryptionPass(
+      absl::Span<uint8_t>(batch.data(), batch.size() - 1), kStride, 1));
+  // Too many connection IDs.
+  std::vector<uint8_t> large_batch((kLoadBalancerMaxBatchSize + 1) * kStride);
+  EXPECT_FALSE(config->BatchEncryptionPass(absl::Span<uint8_t>(large_batch),
+                                           kStride, 1));
+  auto pt_config = LoadBalancerConfig::CreateUnencrypted(0, 3, 4);
+  EXPECT_FALSE(
+      pt_config->BatchEncryptionPass(absl::Span<uint8_t>(batch), kStride, 1));
+}
+
+TEST_F(LoadBalancerConfigTest, BatchBlockDecrypt) {
+  auto config =
+      LoadBalancerConfig::Create(0, 8, 8, absl::string_view(raw_key, 16));
+  ASSERT_TRUE(config.has_value());
+  LoadBalancerConfig copy =
+      *LoadBalancerConfig::Create(1, 8, 8, absl::string_view(raw_key, 16));
+  copy = *config;
+  std::array<uint8_t, 3 * kLoadBalancerBlockSize> batch;
+  for (size_t i = 0; i < batch.size(); ++i) {
+    batch[i] = static_cast<uint8_t>(i * 37);
+  }
+  std::array<uint8_t, 3 * kLoadBalancerBlockSize> expected;
+  for (size_t i = 0; i < 3; ++i) {
+    EXPECT_TRUE(config->BlockDecrypt(
+        batch.data() + i * kLoadBalancerBlockSize,
+        expected.data() + i * kLoadBalancerBlockSize));
+  }
+  EXPECT_TRUE(copy.BatchBlockDecrypt(absl::Span<uint8_t>(batch)));
+  EXPECT_EQ(batch, expected);
+  EXPECT_EQ(copy.config_id(), 0);
+
+  EXPECT_FALSE(config->BatchBlockDecrypt(
+      absl::Span<uint8_t>(batch.data(), batch.size() - 1)));
+  auto small_cid_config =
+      LoadBalancerConfig::Create(0, 3, 4, absl::string_view(raw_key, 16));
+  EXPECT_FALSE(small_cid_config->BatchBlockDecrypt(absl::Span<uint8_t>(batch)));
+}
+
 }  // namespace
 
 }  // namespace test
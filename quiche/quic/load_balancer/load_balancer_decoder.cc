@@ -8,6 +8,47 @@
 
 namespace quic {
 
+namespace {
+
+// Connection IDs of one config waiting to be decrypted together.
+struct DecryptionBatch {
+  // Index of each connection ID in the input of GetServerIds().
+  size_t indices[kLoadBalancerMaxBatchSize];
+  // The plaintext_len() bytes following the first byte of each connection ID.
+  uint8_t plaintexts[kLoadBalancerMaxBatchSize *
+                     (kQuicMaxConnectionIdWithLengthPrefixLength - 1)];
+  size_t size = 0;
+};
+
+// Decrypts the connection IDs in |batch| with |config|, writes their server
+// IDs to |server_ids|, and empties |batch|.
+void DecryptBatch(const LoadBalancerConfig& config, DecryptionBatch& batch,
+                  absl::Span<absl::optional<LoadBalancerServerId>> server_ids) {
+  const uint8_t stride = config.plaintext_len();
+  absl::Span<uint8_t> plaintexts(batch.plaintexts, batch.size * stride);
+  bool success = true;
+  if (config.plaintext_len() == kLoadBalancerKeyLen) {  // single pass
+    success = config.BatchBlockDecrypt(plaintexts);
+  } else {
+    // As in GetServerId(), the last pass is only needed if the server ID
+    // extends into the second half of the connection ID.
+    uint8_t end = (config.server_id_len() > config.nonce_len()) ? 1 : 2;
+    for (uint8_t i = kNumLoadBalancerCryptoPasses; success && i >= end; i--) {
+      success = config.BatchEncryptionPass(plaintexts, stride, i);
+    }
+  }
+  if (success) {
+    for (size_t i = 0; i < batch.size; ++i) {
+      server_ids[batch.indices[i]] = LoadBalancerServerId::Create(
+          absl::Span<const uint8_t>(plaintexts.data() + i * stride,
+                                    config.server_id_len()));
+    }
+  }
+  batch.size = 0;
+}
+
+}  // namespace
+
 bool LoadBalancerDecoder::AddConfig(const LoadBalancerConfig& config) {
   if (config_[config.config_id()].has_value()) {
     return false;
@@ -34,7 +75,7 @@ absl::optional<LoadBalancerServerId> LoadBalancerDecoder::GetServerId(
   if (!config_id.has_value()) {
     return absl::optional<LoadBalancerServerId>();
   }
-  absl::optional<LoadBalancerConfig> config = config_[*config_id];
+  const absl::optional<LoadBalancerConfig>& config = config_[*config_id];
   if (!config.has_value()) {
     return absl::optional<LoadBalancerServerId>();
   }
@@ -70,6 +111,47 @@ absl::optional<LoadBalancerServerId> LoadBalancerDecoder::GetServerId(
       absl::Span<const uint8_t>(result, config->server_id_len()));
 }
 
+void LoadBalancerDecoder::GetServerIds(
+    absl::Span<const QuicConnectionId> connection_ids,
+    absl::Span<absl::optional<LoadBalancerServerId>> server_ids) const {
+  if (connection_ids.size() != server_ids.size()) {
+    QUIC_BUG(quic_bug_438896865_02)
+        << "GetServerIds called with " << connection_ids.size()
+        << " connection IDs and " << server_ids.size() << " server IDs";
+    return;
+  }
+  DecryptionBatch batches[kNumLoadBalancerConfigs];
+  for (size_t i = 0; i < connection_ids.size(); ++i) {
+    const QuicConnectionId& connection_id = connection_ids[i];
+    server_ids[i].reset();
+    absl::optional<uint8_t> config_id = GetConfigId(connection_id);
+    if (!config_id.has_value()) {
+      continue;
+    }
+    const absl::optional<LoadBalancerConfig>& config = config_[*config_id];
+    if (!config.has_value() || connection_id.length() < config->total_len()) {
+      continue;
+    }
+    if (!config->IsEncrypted()) {
+      server_ids[i] = GetServerId(connection_id);
+      continue;
+    }
+    DecryptionBatch& batch = batches[*config_id];
+    batch.indices[batch.size] = i;
+    memcpy(batch.plaintexts + batch.size * config->plaintext_len(),
+           connection_id.data() + 1, config->plaintext_len());
+    if (++batch.size == kLoadBalancerMaxBatchSize) {
+      DecryptBatch(*config, batch, server_ids);
+    }
+  }
+  for (uint8_t config_id = 0; config_id < kNumLoadBalancerConfigs;
+       ++config_id) {
+    if (batches[config_id].size > 0) {
+      DecryptBatch(*config_[config_id], batches[config_id], server_ids);
+    }
+  }
+}
+
 absl::optional<uint8_t> LoadBalancerDecoder::GetConfigId(
     const QuicConnectionId& connection_id) {
   if (connection_id.IsEmpty()) {
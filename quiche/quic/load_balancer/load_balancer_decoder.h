@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_DECODER_H_
 #define QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_DECODER_H_
 
+#include "absl/types/span.h"
 #include "quiche/quic/load_balancer/load_balancer_config.h"
 #include "quiche/quic/load_balancer/load_balancer_server_id.h"
 
@@ -29,6 +30,15 @@ class QUIC_EXPORT_PRIVATE LoadBalancerDecoder {
   absl::optional<LoadBalancerServerId> GetServerId(
       const QuicConnectionId& connection_id) const;
 
+  // Batched version of GetServerId(), for load balancers which receive many
+  // packets at once: sets each element of |server_ids| to the server ID of
+  // the corresponding element of |connection_ids|. The connection IDs of each
+  // encrypted config are decrypted together, kLoadBalancerMaxBatchSize at a
+  // time. |server_ids| must be as long as |connection_ids|.
+  void GetServerIds(
+      absl::Span<const QuicConnectionId> connection_ids,
+      absl::Span<absl::optional<LoadBalancerServerId>> server_ids) const;
+
   // Returns the config ID stored in the first two bits of |connection_id|, or
   // empty if |connection_id| is empty.
   static absl::optional<uint8_t> GetConfigId(
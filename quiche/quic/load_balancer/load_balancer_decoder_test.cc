@@ -4,6 +4,9 @@
 
 #include "quiche/quic/load_balancer/load_balancer_decoder.h"
 
+#include <vector>
+
+#include "absl/types/span.h"
 #include "quiche/quic/load_balancer/load_balancer_server_id.h"
 #include "quiche/quic/platform/api/quic_expect_bug.h"
 #include "quiche/quic/platform/api/quic_test.h"
@@ -204,6 +207,48 @@ TEST_F(LoadBalancerDecoderTest, TwoServerIds) {
             server_id2);
 }
 
+// GetServerIds() gives the same results as GetServerId(), across configs and
+// batches.
+TEST_F(LoadBalancerDecoderTest, GetServerIds) {
+  LoadBalancerDecoder decoder;
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(0, 3, 4, kKey)));
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(1, 10, 5, kKey)));
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(2, 8, 8, kKey)));
+  const QuicConnectionId connection_ids[] = {
+      QuicConnectionId({0x07, 0xfb, 0xfe, 0x05, 0xf7, 0x31, 0xb4, 0x25}),
+      QuicConnectionId({0x4f, 0x01, 0x09, 0x56, 0xfb, 0x5c, 0x1d, 0x4d, 0x86,
+                        0xe0, 0x10, 0x18, 0x3e, 0x0b, 0x7d, 0x1e}),
+      QuicConnectionId({0x90, 0x4d, 0xd2, 0xd0, 0x5a, 0x7b, 0x0d, 0xe9, 0xb2,
+                        0xb9, 0x90, 0x7a, 0xfb, 0x5e, 0xcf, 0x8c, 0xc3}),
+      // Too short.
+      QuicConnectionId({0x07, 0xfb, 0xfe, 0x05, 0xf7, 0x31, 0xb4}),
+      // Unroutable.
+      QuicConnectionId({0xc0, 0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07}),
+      QuicConnectionId(),
+  };
+  // Enough connection IDs of each config to fill more than two batches.
+  std::vector<QuicConnectionId> input;
+  for (int i = 0; i < 2 * kLoadBalancerMaxBatchSize + 1; ++i) {
+    for (const QuicConnectionId& connection_id : connection_ids) {
+      input.push_back(connection_id);
+    }
+  }
+  std::vector<absl::optional<LoadBalancerServerId>> server_ids(
+      input.size(), MakeServerId(kServerId, 1));
+  decoder.GetServerIds(input, absl::MakeSpan(server_ids));
+  for (size_t i = 0; i < input.size(); ++i) {
+    EXPECT_EQ(server_ids[i], decoder.GetServerId(input[i])) << i;
+  }
+  EXPECT_EQ(server_ids[0], MakeServerId(kServerId, 3));
+  EXPECT_EQ(server_ids[1], MakeServerId(kServerId, 10));
+  EXPECT_EQ(server_ids[2], MakeServerId(kServerId, 8));
+  EXPECT_FALSE(server_ids[3].has_value());
+
+  EXPECT_QUIC_BUG(
+      decoder.GetServerIds(input, absl::MakeSpan(server_ids.data(), 1)),
+      "GetServerIds called with");
+}
+
 TEST_F(LoadBalancerDecoderTest, GetConfigId) {
   EXPECT_FALSE(
       LoadBalancerDecoder::GetConfigId(QuicConnectionId()).has_value());
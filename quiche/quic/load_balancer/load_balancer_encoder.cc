@@ -4,7 +4,10 @@
 
 #include "quiche/quic/load_balancer/load_balancer_encoder.h"
 
+#include <cstdint>
+
 #include "absl/numeric/int128.h"
+#include "openssl/siphash.h"
 #include "quiche/quic/core/quic_connection_id.h"
 #include "quiche/quic/core/quic_data_reader.h"
 #include "quiche/quic/core/quic_data_writer.h"
@@ -83,6 +86,9 @@ bool LoadBalancerEncoder::UpdateConfig(const LoadBalancerConfig &config,
       visitor_->OnConfigAdded(config.config_id());
     }
   }
+  previous_config_ = config_;
+  previous_server_id_ = server_id_;
+  has_previous_config_ = true;
   config_ = config;
   server_id_ = server_id;
 
@@ -93,77 +99,165 @@ bool LoadBalancerEncoder::UpdateConfig(const LoadBalancerConfig &config,
 }
 
 void LoadBalancerEncoder::DeleteConfig() {
-  if (visitor_ != nullptr && config_.has_value()) {
+  if (!config_.has_value()) {
+    return;
+  }
+  if (visitor_ != nullptr) {
     visitor_->OnConfigDeleted(config_->config_id());
   }
+  previous_config_ = config_;
+  previous_server_id_ = server_id_;
+  has_previous_config_ = true;
   config_.reset();
   server_id_.reset();
   num_nonces_left_ = 0;
 }
 
 QuicConnectionId LoadBalancerEncoder::GenerateConnectionId() {
-  uint8_t length = (config_.has_value()) ? config_->total_len()
-                                         : unroutable_connection_id_len_;
-  uint8_t config_id = config_.has_value() ? (config_->config_id() << 6)
-                                          : kLoadBalancerUnroutableConfigId;
   if (config_.has_value() != server_id_.has_value()) {
     QUIC_BUG(quic_bug_435375038_04)
         << "Existence of config and server_id are out of sync";
     return QuicConnectionId();
   }
-  uint8_t first_byte;
-  // first byte
-  if (len_self_encoded_) {
-    first_byte = config_id | (length - 1);
-  } else {
-    random_.RandBytes(static_cast<void *>(&first_byte), 1);
-    first_byte = config_id | (first_byte & kLoadBalancerLengthMask);
+  uint8_t random_byte = 0;
+  if (!len_self_encoded_) {
+    random_.RandBytes(static_cast<void *>(&random_byte), 1);
+  }
+  if (!config_.has_value()) {
+    return MakeUnroutableConnectionId(FirstByte(config_, random_byte));
+  }
+  absl::uint128 next_nonce =
+      (seed_ + num_nonces_left_--) % NumberOfNonces(config_->nonce_len());
+  QuicConnectionId id = MakeRoutableConnectionId(
+      *config_, *server_id_, FirstByte(config_, random_byte), next_nonce);
+  if (id.IsEmpty()) {
+    return id;
+  }
+  if (num_nonces_left_ == 0) {
+    DeleteConfig();
+  }
+  return id;
+}
+
+absl::optional<QuicConnectionId> LoadBalancerEncoder::GenerateNextConnectionId(
+    const QuicConnectionId & /*original*/) {
+  QuicConnectionId id = GenerateConnectionId();
+  if (id.IsEmpty()) {
+    return absl::nullopt;
+  }
+  return id;
+}
+
+absl::optional<QuicConnectionId> LoadBalancerEncoder::MaybeReplaceConnectionId(
+    const QuicConnectionId &original, const ParsedQuicVersion &version) {
+  // Connections without IETF QUIC frames never issue new connection IDs, so
+  // they keep the one chosen by the client.
+  if (!version.HasIetfQuicFrames()) {
+    return absl::nullopt;
+  }
+  if (config_.has_value() != server_id_.has_value()) {
+    QUIC_BUG(quic_bug_435375038_06)
+        << "Existence of config and server_id are out of sync";
+    return absl::nullopt;
   }
-  if (config_id == kLoadBalancerUnroutableConfigId) {
-    return MakeUnroutableConnectionId(first_byte);
+  return ReplaceConnectionId(original, config_, server_id_);
+}
+
+absl::optional<QuicConnectionId>
+LoadBalancerEncoder::GetPreviousReplacementConnectionId(
+    const QuicConnectionId &original, const ParsedQuicVersion &version) {
+  if (!version.HasIetfQuicFrames() || !has_previous_config_) {
+    return absl::nullopt;
   }
+  return ReplaceConnectionId(original, previous_config_, previous_server_id_);
+}
+
+absl::optional<QuicConnectionId> LoadBalancerEncoder::ReplaceConnectionId(
+    const QuicConnectionId &original,
+    const absl::optional<LoadBalancerConfig> &config,
+    const absl::optional<LoadBalancerServerId> &server_id) {
+  if (!replacement_key_drawn_) {
+    random_.RandBytes(replacement_key_, sizeof(replacement_key_));
+    replacement_key_drawn_ = true;
+  }
+  // SipHash is a PRF, so that the nonces of different connection IDs only
+  // collide by chance, whichever connection IDs clients choose.
+  const uint8_t *input = reinterpret_cast<const uint8_t *>(original.data());
+  const absl::uint128 hash =
+      absl::MakeUint128(SIPHASH_24(replacement_key_, input, original.length()),
+                        SIPHASH_24(replacement_key_ + 2, input,
+                                   original.length()));
+  const uint8_t first_byte =
+      FirstByte(config, static_cast<uint8_t>(absl::Uint128High64(hash) >> 56));
+  if (!config.has_value()) {
+    QuicConnectionId id = QuicUtils::CreateKeyedReplacementConnectionId(
+        original, replacement_key_, unroutable_connection_id_len_);
+    id.mutable_data()[0] = first_byte;
+    return id;
+  }
+  QuicConnectionId id =
+      MakeRoutableConnectionId(*config, *server_id, first_byte,
+                               hash % NumberOfNonces(config->nonce_len()));
+  if (id.IsEmpty()) {
+    return absl::nullopt;
+  }
+  return id;
+}
+
+uint8_t LoadBalancerEncoder::FirstByte(
+    const absl::optional<LoadBalancerConfig> &config,
+    uint8_t random_byte) const {
+  uint8_t length = (config.has_value()) ? config->total_len()
+                                        : unroutable_connection_id_len_;
+  uint8_t config_id = config.has_value() ? (config->config_id() << 6)
+                                         : kLoadBalancerUnroutableConfigId;
+  if (len_self_encoded_) {
+    return config_id | (length - 1);
+  }
+  return config_id | (random_byte & kLoadBalancerLengthMask);
+}
+
+QuicConnectionId LoadBalancerEncoder::MakeRoutableConnectionId(
+    const LoadBalancerConfig &config, const LoadBalancerServerId &server_id,
+    uint8_t first_byte, absl::uint128 nonce) const {
+  uint8_t length = config.total_len();
   QuicConnectionId id;
   id.set_length(length);
   QuicDataWriter writer(length, id.mutable_data(), quiche::HOST_BYTE_ORDER);
   writer.WriteUInt8(first_byte);
-  absl::uint128 next_nonce =
-      (seed_ + num_nonces_left_--) % NumberOfNonces(config_->nonce_len());
-  writer.WriteBytes(server_id_->data().data(), server_id_->length());
-  if (!WriteUint128(next_nonce, config_->nonce_len(), writer)) {
+  writer.WriteBytes(server_id.data().data(), server_id.length());
+  if (!WriteUint128(nonce, config.nonce_len(), writer)) {
     return QuicConnectionId();
   }
   uint8_t *block_start = reinterpret_cast<uint8_t *>(writer.data() + 1);
-  if (!config_->IsEncrypted()) {
+  if (!config.IsEncrypted()) {
     // Fill the nonce field with a hash of the Connection ID to avoid the nonce
     // visibly increasing by one. This would allow observers to correlate
     // connection IDs as being sequential and likely from the same connection,
     // not just the same server.
     absl::uint128 nonce_hash =
         QuicUtils::FNV1a_128_Hash(absl::string_view(writer.data(), length));
-    QuicDataWriter rewriter(config_->nonce_len(),
-                            id.mutable_data() + config_->server_id_len() + 1,
+    QuicDataWriter rewriter(config.nonce_len(),
+                            id.mutable_data() + config.server_id_len() + 1,
                             quiche::HOST_BYTE_ORDER);
-    if (!WriteUint128(nonce_hash, config_->nonce_len(), rewriter)) {
+    if (!WriteUint128(nonce_hash, config.nonce_len(), rewriter)) {
       return QuicConnectionId();
     }
-  } else if (config_->plaintext_len() == kLoadBalancerBlockSize) {
+  } else if (config.plaintext_len() == kLoadBalancerBlockSize) {
     // Use one encryption pass.
-    if (!config_->BlockEncrypt(block_start, block_start)) {
+    if (!config.BlockEncrypt(block_start, block_start)) {
       QUIC_LOG(ERROR) << "Block encryption failed";
       return QuicConnectionId();
     }
   } else {
     for (uint8_t i = 1; i <= kNumLoadBalancerCryptoPasses; i++) {
-      if (!config_->EncryptionPass(absl::Span<uint8_t>(block_start, length - 1),
+      if (!config.EncryptionPass(absl::Span<uint8_t>(block_start, length - 1),
                                    i)) {
         QUIC_LOG(ERROR) << "Block encryption failed";
         return QuicConnectionId();
       }
     }
   }
-  if (num_nonces_left_ == 0) {
-    DeleteConfig();
-  }
   return id;
 }
 
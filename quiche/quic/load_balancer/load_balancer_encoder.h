@@ -5,6 +5,10 @@
 #ifndef QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ENCODER_H_
 #define QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ENCODER_H_
 
+#include <cstdint>
+
+#include "absl/numeric/int128.h"
+#include "quiche/quic/core/connection_id_generator.h"
 #include "quiche/quic/core/crypto/quic_random.h"
 #include "quiche/quic/load_balancer/load_balancer_config.h"
 #include "quiche/quic/load_balancer/load_balancer_server_id.h"
@@ -49,8 +53,10 @@ class QUIC_EXPORT_PRIVATE LoadBalancerEncoderVisitorInterface {
 };
 
 // Manages QUIC-LB configurations to properly encode a given server ID in a
-// QUIC Connection ID.
-class QUIC_EXPORT_PRIVATE LoadBalancerEncoder {
+// QUIC Connection ID. Servers set it as the connection ID generator of their
+// QuicDispatcher so that all the connection IDs they use are routable.
+class QUIC_EXPORT_PRIVATE LoadBalancerEncoder
+    : public ConnectionIdGeneratorInterface {
  public:
   // Returns a newly created encoder with no active config, if
   // |unroutable_connection_id_length| is valid. |visitor| specifies an optional
@@ -94,6 +100,29 @@ class QUIC_EXPORT_PRIVATE LoadBalancerEncoder {
   // length Connection ID.
   QuicConnectionId GenerateConnectionId();
 
+  // ConnectionIdGeneratorInterface implementation.
+  // Returns empty if GenerateConnectionId() fails.
+  absl::optional<QuicConnectionId> GenerateNextConnectionId(
+      const QuicConnectionId& original) override;
+  // Replaces the connection IDs of connections with IETF QUIC frames, which
+  // can later issue connection IDs from GenerateConnectionId(). As this must
+  // be deterministic, the nonce is a keyed PRF of |original| rather than the
+  // next one, so it does not count against num_nonces_left(), and is only
+  // unique with high probability: configs for busy servers should use long
+  // nonces. The replacement depends on the current config and server ID, so
+  // it changes with UpdateConfig() and DeleteConfig().
+  absl::optional<QuicConnectionId> MaybeReplaceConnectionId(
+      const QuicConnectionId& original,
+      const ParsedQuicVersion& version) override;
+  // Returns the replacement of |original| with the config and server ID which
+  // were current before the last UpdateConfig() or DeleteConfig(), so that the
+  // handshakes started before a change keep reaching their connection. Those
+  // started before the change before that are not covered, so configs should
+  // not change more often than handshakes take to complete.
+  absl::optional<QuicConnectionId> GetPreviousReplacementConnectionId(
+      const QuicConnectionId& original,
+      const ParsedQuicVersion& version) override;
+
  private:
   friend class test::LoadBalancerEncoderPeer;
 
@@ -106,7 +135,21 @@ class QUIC_EXPORT_PRIVATE LoadBalancerEncoder {
         visitor_(visitor),
         unroutable_connection_id_len_(unroutable_connection_id_len) {}
 
+  // Returns the first byte of a connection ID encoded with |config|, or of an
+  // unroutable one if |config| is nullopt, taking the bits which do not
+  // encode the config ID or the length from |random_byte|.
+  uint8_t FirstByte(const absl::optional<LoadBalancerConfig>& config,
+                    uint8_t random_byte) const;
+  // Encodes |server_id| and |nonce| with |config|.
+  QuicConnectionId MakeRoutableConnectionId(
+      const LoadBalancerConfig& config, const LoadBalancerServerId& server_id,
+      uint8_t first_byte, absl::uint128 nonce) const;
   QuicConnectionId MakeUnroutableConnectionId(uint8_t first_byte);
+  // Implements MaybeReplaceConnectionId() with |config| and |server_id|.
+  absl::optional<QuicConnectionId> ReplaceConnectionId(
+      const QuicConnectionId& original,
+      const absl::optional<LoadBalancerConfig>& config,
+      const absl::optional<LoadBalancerServerId>& server_id);
 
   QuicRandom& random_;
   const bool len_self_encoded_;
@@ -116,6 +159,16 @@ class QUIC_EXPORT_PRIVATE LoadBalancerEncoder {
   absl::optional<LoadBalancerConfig> config_;
   absl::uint128 seed_, num_nonces_left_ = 0;
   absl::optional<LoadBalancerServerId> server_id_;
+  // The config and server ID before the last change, for
+  // GetPreviousReplacementConnectionId().
+  absl::optional<LoadBalancerConfig> previous_config_;
+  absl::optional<LoadBalancerServerId> previous_server_id_;
+  bool has_previous_config_ = false;
+  // SipHash keys of the two halves of the PRF which MaybeReplaceConnectionId()
+  // derives nonces from, so that clients cannot choose connection IDs that
+  // collide. Drawn on first use.
+  uint64_t replacement_key_[4];
+  bool replacement_key_drawn_ = false;
 };
 
 }  // namespace quic
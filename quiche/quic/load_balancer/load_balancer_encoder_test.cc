@@ -7,6 +7,8 @@
 #include <cstdint>
 
 #include "absl/numeric/int128.h"
+#include "quiche/quic/core/quic_versions.h"
+#include "quiche/quic/load_balancer/load_balancer_decoder.h"
 #include "quiche/quic/platform/api/quic_expect_bug.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
@@ -359,6 +361,112 @@ TEST_F(LoadBalancerEncoderTest, DeleteConfigNoVisitor) {
   EXPECT_EQ(encoder->num_nonces_left(), 0);
 }
 
+TEST_F(LoadBalancerEncoderTest, GenerateNextConnectionId) {
+  auto encoder = LoadBalancerEncoder::Create(random_, nullptr, true);
+  EXPECT_TRUE(encoder->UpdateConfig(*LoadBalancerConfig::Create(0, 3, 4, kKey),
+                                    MakeServerId(kServerId, 3)));
+  const QuicConnectionId original = TestConnectionId(1);
+  const absl::uint128 nonces_left = encoder->num_nonces_left();
+  absl::optional<QuicConnectionId> id1 =
+      encoder->GenerateNextConnectionId(original);
+  absl::optional<QuicConnectionId> id2 =
+      encoder->GenerateNextConnectionId(original);
+  ASSERT_TRUE(id1.has_value());
+  ASSERT_TRUE(id2.has_value());
+  EXPECT_NE(*id1, *id2);
+  EXPECT_EQ(encoder->num_nonces_left(), nonces_left - 2);
+  LoadBalancerDecoder decoder;
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(0, 3, 4, kKey)));
+  EXPECT_EQ(decoder.GetServerId(*id1), MakeServerId(kServerId, 3));
+  EXPECT_EQ(decoder.GetServerId(*id2), MakeServerId(kServerId, 3));
+}
+
+TEST_F(LoadBalancerEncoderTest, MaybeReplaceConnectionId) {
+  const ParsedQuicVersion version = ParsedQuicVersion::RFCv1();
+  LoadBalancerDecoder decoder;
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(1, 8, 8, kKey)));
+  auto encoder = LoadBalancerEncoder::Create(random_, nullptr, true);
+  EXPECT_TRUE(encoder->UpdateConfig(*LoadBalancerConfig::Create(1, 8, 8, kKey),
+                                    MakeServerId(kServerId, 8)));
+  const absl::uint128 nonces_left = encoder->num_nonces_left();
+  const QuicConnectionId original1 = TestConnectionId(1);
+  const QuicConnectionId original2 = TestConnectionId(2);
+  absl::optional<QuicConnectionId> id1 =
+      encoder->MaybeReplaceConnectionId(original1, version);
+  absl::optional<QuicConnectionId> id2 =
+      encoder->MaybeReplaceConnectionId(original2, version);
+  ASSERT_TRUE(id1.has_value());
+  ASSERT_TRUE(id2.has_value());
+  EXPECT_NE(*id1, *id2);
+  EXPECT_EQ(id1->length(), 17);
+  EXPECT_EQ(decoder.GetServerId(*id1), MakeServerId(kServerId, 8));
+  EXPECT_EQ(decoder.GetServerId(*id2), MakeServerId(kServerId, 8));
+  // Replacement is deterministic and does not use up nonces.
+  EXPECT_EQ(encoder->MaybeReplaceConnectionId(original1, version), id1);
+  EXPECT_EQ(encoder->num_nonces_left(), nonces_left);
+
+  // Connections without IETF QUIC frames keep their connection ID.
+  EXPECT_FALSE(
+      encoder->MaybeReplaceConnectionId(original1, ParsedQuicVersion::Q050())
+          .has_value());
+
+  // Without a config, the replacement is unroutable.
+  encoder->DeleteConfig();
+  id1 = encoder->MaybeReplaceConnectionId(original1, version);
+  ASSERT_TRUE(id1.has_value());
+  EXPECT_EQ(id1->length(), kLoadBalancerUnroutableLen);
+  EXPECT_EQ(id1->data()[0] & 0xff, 0xc7);
+  EXPECT_EQ(encoder->MaybeReplaceConnectionId(original1, version), id1);
+  EXPECT_FALSE(decoder.GetServerId(*id1).has_value());
+}
+
+TEST_F(LoadBalancerEncoderTest, MaybeReplaceConnectionIdAcrossConfigChanges) {
+  const ParsedQuicVersion version = ParsedQuicVersion::RFCv1();
+  const uint8_t kOtherServerId[] = {0x01, 0x02, 0x03, 0x04,
+                                    0x05, 0x06, 0x07, 0x08};
+  LoadBalancerDecoder decoder;
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(0, 8, 8, kKey)));
+  EXPECT_TRUE(decoder.AddConfig(*LoadBalancerConfig::Create(1, 8, 8, kKey)));
+  auto encoder = LoadBalancerEncoder::Create(random_, nullptr, true);
+  const QuicConnectionId original = TestConnectionId(1);
+  EXPECT_TRUE(encoder->UpdateConfig(*LoadBalancerConfig::Create(0, 8, 8, kKey),
+                                    MakeServerId(kServerId, 8)));
+  absl::optional<QuicConnectionId> id1 =
+      encoder->MaybeReplaceConnectionId(original, version);
+  ASSERT_TRUE(id1.has_value());
+  // Before the first config, connection IDs were unroutable.
+  absl::optional<QuicConnectionId> previous =
+      encoder->GetPreviousReplacementConnectionId(original, version);
+  ASSERT_TRUE(previous.has_value());
+  EXPECT_EQ(previous->length(), kLoadBalancerUnroutableLen);
+
+  // A new config changes the replacement, and the previous one remains
+  // available for the handshakes in flight.
+  EXPECT_TRUE(encoder->UpdateConfig(*LoadBalancerConfig::Create(1, 8, 8, kKey),
+                                    MakeServerId(kOtherServerId, 8)));
+  absl::optional<QuicConnectionId> id2 =
+      encoder->MaybeReplaceConnectionId(original, version);
+  ASSERT_TRUE(id2.has_value());
+  EXPECT_NE(*id1, *id2);
+  EXPECT_EQ(decoder.GetServerId(*id2), MakeServerId(kOtherServerId, 8));
+  EXPECT_EQ(encoder->GetPreviousReplacementConnectionId(original, version),
+            id1);
+  EXPECT_EQ(decoder.GetServerId(*id1), MakeServerId(kServerId, 8));
+
+  // Only the config before the last change is kept.
+  encoder->DeleteConfig();
+  EXPECT_EQ(encoder->GetPreviousReplacementConnectionId(original, version),
+            id2);
+  // Deleting no config changes nothing.
+  encoder->DeleteConfig();
+  EXPECT_EQ(encoder->GetPreviousReplacementConnectionId(original, version),
+            id2);
+  EXPECT_FALSE(encoder
+                   ->GetPreviousReplacementConnectionId(
+                       original, ParsedQuicVersion::Q050())
+                   .has_value());
+}
+
 }  // namespace
 
 }  // namespace test
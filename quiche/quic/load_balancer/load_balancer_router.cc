@@ -0,0 +1,86 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/load_balancer/load_balancer_router.h"
+
+#include <memory>
+
+#include "quiche/quic/platform/api/quic_bug_tracker.h"
+
+namespace quic {
+
+LoadBalancerRouter::LoadBalancerRouter(size_t cache_size)
+    : cache_(cache_size) {}
+
+bool LoadBalancerRouter::AddConfig(const LoadBalancerConfig& config) {
+  // Connection IDs of a config the decoder did not have were not cached, so
+  // the cache remains valid.
+  return decoder_.AddConfig(config);
+}
+
+void LoadBalancerRouter::DeleteConfig(uint8_t config_id) {
+  decoder_.DeleteConfig(config_id);
+  cache_.Clear();
+}
+
+absl::optional<LoadBalancerServerId> LoadBalancerRouter::GetServerId(
+    const QuicConnectionId& connection_id) {
+  absl::optional<LoadBalancerServerId> server_id = Lookup(connection_id);
+  if (server_id.has_value()) {
+    return server_id;
+  }
+  server_id = decoder_.GetServerId(connection_id);
+  if (server_id.has_value()) {
+    cache_.Insert(connection_id,
+                  std::make_unique<LoadBalancerServerId>(*server_id));
+  }
+  return server_id;
+}
+
+void LoadBalancerRouter::GetServerIds(
+    absl::Span<const QuicConnectionId> connection_ids,
+    absl::Span<absl::optional<LoadBalancerServerId>> server_ids) {
+  if (connection_ids.size() != server_ids.size()) {
+    QUIC_BUG(quic_bug_load_balancer_router_size_mismatch)
+        << "GetServerIds called with " << connection_ids.size()
+        << " connection IDs and " << server_ids.size() << " server IDs";
+    return;
+  }
+  miss_indices_.clear();
+  miss_connection_ids_.clear();
+  for (size_t i = 0; i < connection_ids.size(); ++i) {
+    server_ids[i] = Lookup(connection_ids[i]);
+    if (!server_ids[i].has_value()) {
+      miss_indices_.push_back(i);
+      miss_connection_ids_.push_back(connection_ids[i]);
+    }
+  }
+  if (miss_indices_.empty()) {
+    return;
+  }
+  miss_server_ids_.resize(miss_indices_.size());
+  decoder_.GetServerIds(miss_connection_ids_,
+                        absl::MakeSpan(miss_server_ids_));
+  for (size_t i = 0; i < miss_indices_.size(); ++i) {
+    if (!miss_server_ids_[i].has_value()) {
+      continue;
+    }
+    server_ids[miss_indices_[i]] = miss_server_ids_[i];
+    cache_.Insert(miss_connection_ids_[i],
+                  std::make_unique<LoadBalancerServerId>(*miss_server_ids_[i]));
+  }
+}
+
+absl::optional<LoadBalancerServerId> LoadBalancerRouter::Lookup(
+    const QuicConnectionId& connection_id) {
+  auto it = cache_.Lookup(connection_id);
+  if (it == cache_.end()) {
+    ++num_cache_misses_;
+    return absl::nullopt;
+  }
+  ++num_cache_hits_;
+  return *it->second;
+}
+
+}  // namespace quic
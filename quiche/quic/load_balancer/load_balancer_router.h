@@ -0,0 +1,83 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ROUTER_H_
+#define QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ROUTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "absl/types/span.h"
+#include "quiche/quic/core/quic_connection_id.h"
+#include "quiche/quic/core/quic_lru_cache.h"
+#include "quiche/quic/load_balancer/load_balancer_config.h"
+#include "quiche/quic/load_balancer/load_balancer_decoder.h"
+#include "quiche/quic/load_balancer/load_balancer_server_id.h"
+#include "quiche/quic/platform/api/quic_export.h"
+
+namespace quic {
+
+// Default number of connection IDs whose server ID a LoadBalancerRouter
+// remembers.
+inline constexpr size_t kDefaultLoadBalancerRouterCacheSize = 16384;
+
+// Finds the server ID of the connection IDs of incoming packets on behalf of
+// a load balancer. Wraps a LoadBalancerDecoder with a cache of the server IDs
+// of recently decoded connection IDs, so that the packets of active
+// connections skip decryption, and decodes the connection IDs missing from
+// the cache in batches.
+// Connection IDs which cannot be decoded are not cached, as they are usually
+// random connection IDs chosen by clients for their first packets.
+class QUIC_EXPORT_PRIVATE LoadBalancerRouter {
+ public:
+  explicit LoadBalancerRouter(
+      size_t cache_size = kDefaultLoadBalancerRouterCacheSize);
+  LoadBalancerRouter(const LoadBalancerRouter&) = delete;
+  LoadBalancerRouter& operator=(const LoadBalancerRouter&) = delete;
+
+  // Same as the LoadBalancerDecoder functions. Deleting a config empties the
+  // cache.
+  bool AddConfig(const LoadBalancerConfig& config);
+  void DeleteConfig(uint8_t config_id);
+
+  // Returns the server ID of |connection_id|, or empty if it cannot be
+  // decoded.
+  absl::optional<LoadBalancerServerId> GetServerId(
+      const QuicConnectionId& connection_id);
+
+  // Batched version of GetServerId(). |server_ids| must be as long as
+  // |connection_ids|.
+  void GetServerIds(
+      absl::Span<const QuicConnectionId> connection_ids,
+      absl::Span<absl::optional<LoadBalancerServerId>> server_ids);
+
+  const LoadBalancerDecoder& decoder() const { return decoder_; }
+
+  uint64_t num_cache_hits() const { return num_cache_hits_; }
+  uint64_t num_cache_misses() const { return num_cache_misses_; }
+
+ private:
+  // Returns the cached server ID of |connection_id|, if any, and updates the
+  // cache statistics.
+  absl::optional<LoadBalancerServerId> Lookup(
+      const QuicConnectionId& connection_id);
+
+  LoadBalancerDecoder decoder_;
+  QuicLRUCache<QuicConnectionId, LoadBalancerServerId, QuicConnectionIdHash>
+      cache_;
+  uint64_t num_cache_hits_ = 0;
+  uint64_t num_cache_misses_ = 0;
+
+  // Scratch space of GetServerIds() for the connection IDs missing from the
+  // cache, kept across calls to avoid allocations.
+  std::vector<size_t> miss_indices_;
+  std::vector<QuicConnectionId> miss_connection_ids_;
+  std::vector<absl::optional<LoadBalancerServerId>> miss_server_ids_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_LOAD_BALANCER_LOAD_BALANCER_ROUTER_H_
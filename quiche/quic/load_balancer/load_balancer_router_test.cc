@@ -0,0 +1,89 @@
+// Copyright (c) 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/load_balancer/load_balancer_router.h"
+
+#include <vector>
+
+#include "absl/types/span.h"
+#include "quiche/quic/platform/api/quic_expect_bug.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+
+namespace quic {
+
+namespace test {
+
+namespace {
+
+constexpr char kRawKey[] = {0x8f, 0x95, 0xf0, 0x92, 0x45, 0x76, 0x5f, 0x80,
+                            0x25, 0x69, 0x34, 0xe5, 0x0c, 0x66, 0x20, 0x7f};
+constexpr absl::string_view kKey(kRawKey, kLoadBalancerKeyLen);
+constexpr uint8_t kServerId[] = {0xed, 0x79, 0x3a};
+
+class LoadBalancerRouterTest : public QuicTest {
+ protected:
+  LoadBalancerRouterTest()
+      : router_(/*cache_size=*/2),
+        server_id_(*LoadBalancerServerId::Create(kServerId)),
+        // Test vector from draft-ietf-quic-load-balancers-12, Appendix B.
+        connection_id_({0x07, 0xfb, 0xfe, 0x05, 0xf7, 0x31, 0xb4, 0x25}) {
+    EXPECT_TRUE(router_.AddConfig(*LoadBalancerConfig::Create(0, 3, 4, kKey)));
+  }
+
+  LoadBalancerRouter router_;
+  const LoadBalancerServerId server_id_;
+  const QuicConnectionId connection_id_;
+};
+
+TEST_F(LoadBalancerRouterTest, GetServerId) {
+  EXPECT_EQ(router_.GetServerId(connection_id_), server_id_);
+  EXPECT_EQ(router_.num_cache_misses(), 1u);
+  EXPECT_EQ(router_.GetServerId(connection_id_), server_id_);
+  EXPECT_EQ(router_.num_cache_hits(), 1u);
+
+  // Connection IDs which cannot be decoded are not cached.
+  const QuicConnectionId unroutable({0xc0, 0x01, 0x02, 0x03, 0x04, 0x05});
+  EXPECT_FALSE(router_.GetServerId(unroutable).has_value());
+  EXPECT_FALSE(router_.GetServerId(unroutable).has_value());
+  EXPECT_EQ(router_.num_cache_misses(), 3u);
+  EXPECT_EQ(router_.GetServerId(connection_id_), server_id_);
+  EXPECT_EQ(router_.num_cache_hits(), 2u);
+}
+
+TEST_F(LoadBalancerRouterTest, DeleteConfigEmptiesCache) {
+  EXPECT_EQ(router_.GetServerId(connection_id_), server_id_);
+  router_.DeleteConfig(0);
+  EXPECT_FALSE(router_.GetServerId(connection_id_).has_value());
+  EXPECT_EQ(router_.num_cache_hits(), 0u);
+}
+
+TEST_F(LoadBalancerRouterTest, GetServerIds) {
+  const QuicConnectionId unroutable({0xc0, 0x01, 0x02, 0x03, 0x04, 0x05});
+  std::vector<QuicConnectionId> connection_ids = {connection_id_, unroutable,
+                                                  connection_id_};
+  std::vector<absl::optional<LoadBalancerServerId>> server_ids(3);
+  router_.GetServerIds(connection_ids, absl::MakeSpan(server_ids));
+  EXPECT_EQ(server_ids[0], server_id_);
+  EXPECT_FALSE(server_ids[1].has_value());
+  EXPECT_EQ(server_ids[2], server_id_);
+  EXPECT_EQ(router_.num_cache_misses(), 3u);
+
+  router_.GetServerIds(connection_ids, absl::MakeSpan(server_ids));
+  EXPECT_EQ(server_ids[0], server_id_);
+  EXPECT_FALSE(server_ids[1].has_value());
+  EXPECT_EQ(server_ids[2], server_id_);
+  EXPECT_EQ(router_.num_cache_hits(), 2u);
+  EXPECT_EQ(router_.num_cache_misses(), 4u);
+
+  EXPECT_QUIC_BUG(router_.GetServerIds(connection_ids,
+                                       absl::MakeSpan(server_ids.data(), 1)),
+                  "GetServerIds called with");
+}
+
+}  // namespace
+
+}  // namespace test
+
+}  // namespace quic
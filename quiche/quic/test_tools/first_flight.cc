@@ -5,8 +5,11 @@
 #include "quiche/quic/test_tools/first_flight.h"
 
 #include <memory>
+#include <string>
 #include <vector>
 
+#include "absl/strings/string_view.h"
+
 #include "quiche/quic/core/crypto/quic_crypto_client_config.h"
 #include "quiche/quic/core/http/quic_client_push_promise_index.h"
 #include "quiche/quic/core/http/quic_spdy_client_session.h"
@@ -62,6 +65,9 @@ class FirstFlightExtractor : public DelegatedPacketWriter::Delegate {
                            /*owns_writer=*/false, Perspective::IS_CLIENT,
                            ParsedQuicVersionVector{version_});
     connection_->set_client_connection_id(client_connection_id_);
+    if (!token_.empty()) {
+      connection_->SetSourceAddressTokenToSend(token_);
+    }
     session_ = std::make_unique<QuicSpdyClientSession>(
         config_, ParsedQuicVersionVector{version_},
         connection_,  // session_ takes ownership of connection_ here.
@@ -81,6 +87,8 @@ class FirstFlightExtractor : public DelegatedPacketWriter::Delegate {
             .Clone());
   }
 
+  void set_token(absl::string_view token) { token_ = std::string(token); }
+
   std::vector<std::unique_ptr<QuicReceivedPacket>>&& ConsumePackets() {
     return std::move(packets_);
   }
@@ -89,6 +97,7 @@ class FirstFlightExtractor : public DelegatedPacketWriter::Delegate {
   ParsedQuicVersion version_;
   QuicConnectionId server_connection_id_;
   QuicConnectionId client_connection_id_;
+  std::string token_;
   MockQuicConnectionHelper connection_helper_;
   MockAlarmFactory alarm_factory_;
   DelegatedPacketWriter writer_;
@@ -112,6 +121,18 @@ std::vector<std::unique_ptr<QuicReceivedPacket>> GetFirstFlightOfPackets(
   return first_flight_extractor.ConsumePackets();
 }
 
+std::vector<std::unique_ptr<QuicReceivedPacket>>
+GetFirstFlightOfPacketsWithToken(const ParsedQuicVersion& version,
+                                 const QuicConnectionId& server_connection_id,
+                                 absl::string_view token) {
+  FirstFlightExtractor first_flight_extractor(
+      version, DefaultQuicConfig(), server_connection_id,
+      EmptyQuicConnectionId());
+  first_flight_extractor.set_token(token);
+  first_flight_extractor.GenerateFirstFlight();
+  return first_flight_extractor.ConsumePackets();
+}
+
 std::vector<std::unique_ptr<QuicReceivedPacket>> GetFirstFlightOfPackets(
     const ParsedQuicVersion& version, const QuicConfig& config,
     const QuicConnectionId& server_connection_id,
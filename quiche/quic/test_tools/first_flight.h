@@ -8,6 +8,7 @@
 #include <memory>
 #include <vector>
 
+#include "absl/strings/string_view.h"
 #include "quiche/quic/core/crypto/quic_crypto_client_config.h"
 #include "quiche/quic/core/quic_config.h"
 #include "quiche/quic/core/quic_connection_id.h"
@@ -81,6 +82,14 @@ std::vector<std::unique_ptr<QuicReceivedPacket>> GetFirstFlightOfPackets(
     const QuicConnectionId& client_connection_id,
     std::unique_ptr<QuicCryptoClientConfig> crypto_config);
 
+// Same as GetFirstFlightOfPackets() with default values, but the Initial
+// packets carry |token|, as if it was received in a RETRY packet or in a
+// NEW_TOKEN frame. Only used with TLS versions.
+std::vector<std::unique_ptr<QuicReceivedPacket>>
+GetFirstFlightOfPacketsWithToken(const ParsedQuicVersion& version,
+                                 const QuicConnectionId& server_connection_id,
+                                 absl::string_view token);
+
 // Below are various convenience overloads that use default values for the
 // omitted parameters:
 // |config| = DefaultQuicConfig(),
@@ -132,5 +132,14 @@ QuicAlarm* QuicDispatcherPeer::GetClearResetAddressesAlarm(
   return dispatcher->clear_stateless_reset_addresses_alarm_.get();
 }
 
+// static
+QuicConnectionId QuicDispatcherPeer::MaybeReplaceServerConnectionId(
+    const QuicDispatcher* dispatcher,
+    const QuicConnectionId& server_connection_id,
+    const ParsedQuicVersion& version) {
+  return dispatcher->MaybeReplaceServerConnectionId(server_connection_id,
+                                                    version);
+}
+
 }  // namespace test
 }  // namespace quic
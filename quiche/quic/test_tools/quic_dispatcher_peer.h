@@ -74,6 +74,11 @@ class QuicDispatcherPeer {
                                         QuicConnectionId id);
 
   static QuicAlarm* GetClearResetAddressesAlarm(QuicDispatcher* dispatcher);
+
+  static QuicConnectionId MaybeReplaceServerConnectionId(
+      const QuicDispatcher* dispatcher,
+      const QuicConnectionId& server_connection_id,
+      const ParsedQuicVersion& version);
 };
 
 }  // namespace test
@@ -50,6 +50,15 @@ WriteStreamDataResult SimpleDataProducer::WriteStreamData(
   return WRITE_FAILED;
 }
 
+absl::string_view SimpleDataProducer::GetContiguousStreamData(
+    QuicStreamId id, QuicStreamOffset offset, QuicByteCount data_length) {
+  auto iter = send_buffer_map_.find(id);
+  if (iter == send_buffer_map_.end()) {
+    return absl::string_view();
+  }
+  return iter->second->GetContiguousStreamData(offset, data_length);
+}
+
 bool SimpleDataProducer::WriteCryptoData(EncryptionLevel level,
                                          QuicStreamOffset offset,
                                          QuicByteCount data_length,
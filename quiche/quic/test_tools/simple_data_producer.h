@@ -35,6 +35,9 @@ class SimpleDataProducer : public QuicStreamFrameDataProducer {
                                         QuicStreamOffset offset,
                                         QuicByteCount data_length,
                                         QuicDataWriter* writer) override;
+  absl::string_view GetContiguousStreamData(QuicStreamId id,
+                                            QuicStreamOffset offset,
+                                            QuicByteCount data_length) override;
   bool WriteCryptoData(EncryptionLevel level, QuicStreamOffset offset,
                        QuicByteCount data_length,
                        QuicDataWriter* writer) override;
@@ -141,11 +141,12 @@ void SimpleSessionNotifier::WriteOrBufferAckFrequency(
   const bool had_buffered_data =
       HasBufferedStreamData() || HasBufferedControlFrames();
   QuicControlFrameId control_frame_id = ++last_control_frame_id_;
-  control_frames_.emplace_back((
-      QuicFrame(new QuicAckFrequencyFrame(control_frame_id,
+  auto* frame = new QuicAckFrequencyFrame(control_frame_id,
                                           /*sequence_number=*/control_frame_id,
                                           ack_frequency_frame.packet_tolerance,
-                                          ack_frequency_frame.max_ack_delay))));
+                                          ack_frequency_frame.max_ack_delay);
+  frame->ignore_order = ack_frequency_frame.ignore_order;
+  control_frames_.emplace_back(QuicFrame(frame));
   if (had_buffered_data) {
     QUIC_DLOG(WARNING) << "Connection is write blocked";
     return;
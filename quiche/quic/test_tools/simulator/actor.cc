@@ -13,7 +13,7 @@ Actor::Actor(Simulator* simulator, std::string name)
     : simulator_(simulator),
       clock_(simulator->GetClock()),
       name_(std::move(name)) {
-  simulator_->AddActor(this);
+  scheduler_index_ = simulator_->AddActor(this);
 }
 
 Actor::~Actor() { simulator_->RemoveActor(this); }
@@ -5,6 +5,7 @@
 #ifndef QUICHE_QUIC_TEST_TOOLS_SIMULATOR_ACTOR_H_
 #define QUICHE_QUIC_TEST_TOOLS_SIMULATOR_ACTOR_H_
 
+#include <cstddef>
 #include <string>
 
 #include "quiche/quic/core/quic_clock.h"
@@ -52,12 +53,17 @@ class Actor {
   std::string name_;
 
  private:
+  friend class Simulator;
+
   // Since the Actor object registers itself with a simulator using a pointer to
   // itself, do not allow it to be moved.
   Actor(Actor&&) = delete;
   Actor(const Actor&) = delete;
   Actor& operator=(const Actor&) = delete;
   Actor& operator=(Actor&&) = delete;
+
+  // Index of the actor's scheduling state in the simulator.
+  size_t scheduler_index_;
 };
 
 }  // namespace simulator
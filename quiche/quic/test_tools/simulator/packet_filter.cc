@@ -4,6 +4,8 @@
 
 #include "quiche/quic/test_tools/simulator/packet_filter.h"
 
+#include "quiche/quic/test_tools/simulator/simulator.h"
+
 namespace quic {
 namespace simulator {
 
@@ -18,6 +20,8 @@ PacketFilter::~PacketFilter() {}
 void PacketFilter::AcceptPacket(std::unique_ptr<Packet> packet) {
   if (FilterPacket(*packet)) {
     output_tx_port_->AcceptPacket(std::move(packet));
+  } else {
+    simulator_->ReleasePacket(std::move(packet));
   }
 }
 
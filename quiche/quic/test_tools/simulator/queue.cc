@@ -37,6 +37,7 @@ void Queue::AcceptPacket(std::unique_ptr<Packet> packet) {
                   << "] which is over capacity.  Dropping it.";
     QUIC_DVLOG(1) << "Queue size: " << bytes_queued_ << " out of " << capacity_
                   << ".  Packet size: " << packet->size;
+    simulator_->ReleasePacket(std::move(packet));
     return;
   }
 
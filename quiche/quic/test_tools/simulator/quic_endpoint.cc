@@ -62,6 +62,11 @@ QuicEndpoint::QuicEndpoint(Simulator* simulator, std::string name,
   // primarily because
   //  - this enables pacing, and
   //  - this sets the non-handshake timeouts.
+  connection_->SetFromConfig(NegotiatedConfig());
+  connection_->DisableMtuDiscovery();
+}
+
+QuicConfig QuicEndpoint::NegotiatedConfig() const {
   std::string error;
   CryptoHandshakeMessage peer_hello;
   peer_hello.SetValue(kICSL,
@@ -70,7 +75,8 @@ QuicEndpoint::QuicEndpoint(Simulator* simulator, std::string name,
                       static_cast<uint32_t>(kDefaultMaxStreamsPerConnection));
   QuicConfig config;
   QuicErrorCode error_code = config.ProcessPeerHello(
-      peer_hello, perspective == Perspective::IS_CLIENT ? SERVER : CLIENT,
+      peer_hello,
+      connection_->perspective() == Perspective::IS_CLIENT ? SERVER : CLIENT,
       &error);
   QUICHE_DCHECK_EQ(error_code, QUIC_NO_ERROR)
       << "Configuration failed: " << error;
@@ -85,8 +91,40 @@ QuicEndpoint::QuicEndpoint(Simulator* simulator, std::string name,
           &config, connection_->client_connection_id());
     }
   }
+  return config;
+}
+
+void QuicEndpoint::EnableAckFrequency(
+    const QuicTagVector& client_connection_options) {
+  QuicConfig config = NegotiatedConfig();
+  test::QuicConfigPeer::SetReceivedMinAckDelayMs(&config,
+                                                 kDefaultMinAckDelayTimeMs);
+  if (connection_->perspective() == Perspective::IS_CLIENT) {
+    config.SetConnectionOptionsToSend(client_connection_options);
+  } else {
+    test::QuicConfigPeer::SetReceivedConnectionOptions(
+        &config, client_connection_options);
+  }
+  connection_->set_can_receive_ack_frequency_frame();
   connection_->SetFromConfig(config);
-  connection_->DisableMtuDiscovery();
+}
+
+void QuicEndpoint::EnableMultipath(QuicTag multipath_option) {
+  QuicConfig config = NegotiatedConfig();
+  if (connection_->perspective() == Perspective::IS_CLIENT) {
+    config.SetConnectionOptionsToSend({multipath_option});
+  } else {
+    test::QuicConfigPeer::SetReceivedConnectionOptions(&config,
+                                                       {multipath_option});
+  }
+  handshake_state_ = HANDSHAKE_CONFIRMED;
+  connection_->SetFromConfig(config);
+}
+
+void QuicEndpoint::SendAckFrequency(const QuicAckFrequencyFrame& frame) {
+  if (notifier_ != nullptr) {
+    notifier_->WriteOrBufferAckFrequency(frame);
+  }
 }
 
 QuicByteCount QuicEndpoint::bytes_received() const {
@@ -204,7 +242,7 @@ bool QuicEndpoint::HasUnackedStreamData() const {
 }
 
 HandshakeState QuicEndpoint::GetHandshakeState() const {
-  return HANDSHAKE_COMPLETE;
+  return handshake_state_;
 }
 
 WriteStreamDataResult QuicEndpoint::DataProducer::WriteStreamData(
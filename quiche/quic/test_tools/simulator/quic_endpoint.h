@@ -8,6 +8,7 @@
 #include "absl/strings/string_view.h"
 #include "quiche/quic/core/crypto/null_decrypter.h"
 #include "quiche/quic/core/crypto/null_encrypter.h"
+#include "quiche/quic/core/quic_config.h"
 #include "quiche/quic/core/quic_connection.h"
 #include "quiche/quic/core/quic_packet_writer.h"
 #include "quiche/quic/core/quic_packets.h"
@@ -42,6 +43,16 @@ class QuicEndpoint : public QuicEndpointBase,
   // progress.
   void AddBytesToTransfer(QuicByteCount bytes);
 
+  // Reconfigures the connection as if both endpoints had advertised support
+  // for ACK_FREQUENCY frames and the client had sent
+  // |client_connection_options|.
+  void EnableAckFrequency(const QuicTagVector& client_connection_options);
+
+  // Reconfigures the connection as if the client had sent |multipath_option|,
+  // e.g. kMPTH, and the handshake had been confirmed, which multipath paths
+  // require.  Only takes effect if --quic_enable_multipath_experiment is set.
+  void EnableMultipath(QuicTag multipath_option);
+
   // Begin QuicConnectionVisitorInterface implementation.
   void OnStreamFrame(const QuicStreamFrame& frame) override;
   void OnCryptoFrame(const QuicCryptoFrame& frame) override;
@@ -71,7 +82,7 @@ class QuicEndpoint : public QuicEndpointBase,
   void OnPathDegrading() override {}
   void OnForwardProgressMadeAfterPathDegrading() override {}
   void OnAckNeedsRetransmittableFrame() override {}
-  void SendAckFrequency(const QuicAckFrequencyFrame& /*frame*/) override {}
+  void SendAckFrequency(const QuicAckFrequencyFrame& frame) override;
   void SendNewConnectionId(const QuicNewConnectionIdFrame& /*frame*/) override {
   }
   void SendRetireConnectionId(uint64_t /*sequence_number*/) override {}
@@ -123,6 +134,11 @@ class QuicEndpoint : public QuicEndpointBase,
   bool HasUnackedStreamData() const override;
   // End SessionNotifierInterface implementation.
 
+ protected:
+  // Allows subclasses to send data on streams other than the one used by
+  // AddBytesToTransfer().
+  test::SimpleSessionNotifier* notifier() { return notifier_.get(); }
+
  private:
   // The producer outputs the repetition of the same byte.  That sequence is
   // verified by the receiver.
@@ -137,6 +153,10 @@ class QuicEndpoint : public QuicEndpointBase,
                          QuicDataWriter* writer) override;
   };
 
+  // Returns the config the connection is set up with, as if it had completed
+  // a handshake.
+  QuicConfig NegotiatedConfig() const;
+
   std::unique_ptr<QuicConnection> CreateConnection(
       Simulator* simulator, std::string name, std::string peer_name,
       Perspective perspective, QuicConnectionId connection_id);
@@ -158,6 +178,8 @@ class QuicEndpoint : public QuicEndpointBase,
   QuicIntervalSet<QuicStreamOffset> offsets_received_;
 
   std::unique_ptr<test::SimpleSessionNotifier> notifier_;
+
+  HandshakeState handshake_state_ = HANDSHAKE_COMPLETE;
 };
 
 }  // namespace simulator
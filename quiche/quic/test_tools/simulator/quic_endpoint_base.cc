@@ -79,6 +79,26 @@ QuicEndpointBase::~QuicEndpointBase() {
 
 void QuicEndpointBase::DropNextIncomingPacket() { drop_next_packet_ = true; }
 
+QuicEndpointBase::Interface* QuicEndpointBase::AddInterface(std::string name) {
+  interfaces_.push_back(std::make_unique<Interface>(this, name));
+  return interfaces_.back().get();
+}
+
+void QuicEndpointBase::AddPeerInterface(std::string interface_name) {
+  peer_interfaces_.emplace_back(interface_name,
+                                GetAddressFromName(interface_name));
+}
+
+std::string QuicEndpointBase::GetPeerName(
+    const QuicSocketAddress& peer_address) const {
+  for (const auto& peer_interface : peer_interfaces_) {
+    if (peer_interface.second == peer_address) {
+      return peer_interface.first;
+    }
+  }
+  return peer_name_;
+}
+
 void QuicEndpointBase::RecordTrace() {
   trace_visitor_ = std::make_unique<QuicTraceVisitor>(connection_.get());
   connection_->set_debug_visitor(trace_visitor_.get());
@@ -86,17 +106,26 @@ void QuicEndpointBase::RecordTrace() {
 
 void QuicEndpointBase::AcceptPacket(std::unique_ptr<Packet> packet) {
   if (packet->destination != name_) {
+    simulator_->ReleasePacket(std::move(packet));
     return;
   }
   if (drop_next_packet_) {
     drop_next_packet_ = false;
+    simulator_->ReleasePacket(std::move(packet));
     return;
   }
 
+  QuicSocketAddress peer_address = connection_->peer_address();
+  for (const auto& peer_interface : peer_interfaces_) {
+    if (peer_interface.first == packet->source) {
+      peer_address = peer_interface.second;
+    }
+  }
   QuicReceivedPacket received_packet(packet->contents.data(),
                                      packet->contents.size(), clock_->Now());
-  connection_->ProcessUdpPacket(connection_->self_address(),
-                                connection_->peer_address(), received_packet);
+  connection_->ProcessUdpPacket(connection_->self_address(), peer_address,
+                                received_packet);
+  simulator_->ReleasePacket(std::move(packet));
 }
 
 UnconstrainedPortInterface* QuicEndpointBase::GetRxPort() { return this; }
@@ -116,34 +145,43 @@ void QuicEndpointBase::OnPacketDequeued() {
 }
 
 QuicEndpointBase::Writer::Writer(QuicEndpointBase* endpoint)
-    : endpoint_(endpoint), is_blocked_(false) {}
+    : Writer(endpoint, endpoint->name(), &endpoint->nic_tx_queue_) {}
+
+QuicEndpointBase::Writer::Writer(QuicEndpointBase* endpoint, std::string source,
+                                 Queue* tx_queue)
+    : endpoint_(endpoint),
+      source_(source),
+      tx_queue_(tx_queue),
+      is_blocked_(false) {}
 
 QuicEndpointBase::Writer::~Writer() {}
 
 WriteResult QuicEndpointBase::Writer::WritePacket(
     const char* buffer, size_t buf_len, const QuicIpAddress& /*self_address*/,
-    const QuicSocketAddress& /*peer_address*/, PerPacketOptions* options) {
+    const QuicSocketAddress& peer_address, PerPacketOptions* options) {
   QUICHE_DCHECK(!IsWriteBlocked());
   QUICHE_DCHECK(options == nullptr);
   QUICHE_DCHECK(buf_len <= kMaxOutgoingPacketSize);
 
   // Instead of losing a packet, become write-blocked when the egress queue is
   // full.
-  if (endpoint_->nic_tx_queue_.packets_queued() > kTxQueueSize) {
+  if (tx_queue_->packets_queued() > kTxQueueSize) {
     is_blocked_ = true;
     endpoint_->write_blocked_count_++;
     return WriteResult(WRITE_STATUS_BLOCKED, 0);
   }
 
-  auto packet = std::make_unique<Packet>();
-  packet->source = endpoint_->name();
-  packet->destination = endpoint_->peer_name_;
+  // Reuse a packet, and its buffers, released by the receiver of an earlier
+  // one.
+  std::unique_ptr<Packet> packet = endpoint_->simulator()->AllocatePacket();
+  packet->source = source_;
+  packet->destination = endpoint_->GetPeerName(peer_address);
   packet->tx_timestamp = endpoint_->clock_->Now();
 
-  packet->contents = std::string(buffer, buf_len);
+  packet->contents.assign(buffer, buf_len);
   packet->size = buf_len;
 
-  endpoint_->nic_tx_queue_.AcceptPacket(std::move(packet));
+  tx_queue_->AcceptPacket(std::move(packet));
 
   return WriteResult(WRITE_STATUS_OK, buf_len);
 }
@@ -175,6 +213,50 @@ WriteResult QuicEndpointBase::Writer::Flush() {
   return WriteResult(WRITE_STATUS_OK, 0);
 }
 
+QuicEndpointBase::Interface::Interface(QuicEndpointBase* endpoint,
+                                       std::string name)
+    : Endpoint(endpoint->simulator(), name),
+      endpoint_(endpoint),
+      address_(GetAddressFromName(name)),
+      writer_(endpoint, name, &tx_queue_),
+      tx_queue_(endpoint->simulator(), absl::StrCat(name, " (TX Queue)"),
+                kMaxOutgoingPacketSize * kTxQueueSize) {
+  tx_queue_.set_listener_interface(this);
+}
+
+QuicEndpointBase::Interface::~Interface() {}
+
+void QuicEndpointBase::Interface::AcceptPacket(std::unique_ptr<Packet> packet) {
+  if (packet->destination != name_) {
+    simulator_->ReleasePacket(std::move(packet));
+    return;
+  }
+
+  QuicConnection* connection = endpoint_->connection();
+  QuicReceivedPacket received_packet(packet->contents.data(),
+                                     packet->contents.size(), clock_->Now());
+  connection->ProcessUdpPacket(address_, connection->peer_address(),
+                               received_packet);
+  simulator_->ReleasePacket(std::move(packet));
+}
+
+UnconstrainedPortInterface* QuicEndpointBase::Interface::GetRxPort() {
+  return this;
+}
+
+void QuicEndpointBase::Interface::SetTxPort(ConstrainedPortInterface* port) {
+  tx_queue_.set_tx_port(port);
+}
+
+void QuicEndpointBase::Interface::OnPacketDequeued() {
+  if (writer_.IsWriteBlocked() &&
+      (tx_queue_.capacity() - tx_queue_.bytes_queued()) >=
+          kMaxOutgoingPacketSize) {
+    writer_.SetWritable();
+    endpoint_->connection()->OnCanWrite();
+  }
+}
+
 QuicEndpointMultiplexer::QuicEndpointMultiplexer(
     std::string name, const std::vector<QuicEndpointBase*>& endpoints)
     : Endpoint((*endpoints.begin())->simulator(), name) {
@@ -188,6 +270,7 @@ QuicEndpointMultiplexer::~QuicEndpointMultiplexer() {}
 void QuicEndpointMultiplexer::AcceptPacket(std::unique_ptr<Packet> packet) {
   auto key_value_pair_it = mapping_.find(packet->destination);
   if (key_value_pair_it == mapping_.end()) {
+    simulator_->ReleasePacket(std::move(packet));
     return;
   }
 
@@ -6,6 +6,9 @@
 #define QUICHE_QUIC_TEST_TOOLS_SIMULATOR_QUIC_ENDPOINT_BASE_H_
 
 #include <memory>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include "absl/container/flat_hash_map.h"
 #include "quiche/quic/core/crypto/null_decrypter.h"
@@ -38,6 +41,8 @@ class QuicEndpointBase : public Endpoint,
                          public UnconstrainedPortInterface,
                          public Queue::ListenerInterface {
  public:
+  class Interface;
+
   // Does not create the connection; the subclass has to create connection by
   // itself.
   QuicEndpointBase(Simulator* simulator, std::string name,
@@ -57,6 +62,16 @@ class QuicEndpointBase : public Endpoint,
   // Enables logging of the connection trace at the end of the unit test.
   void RecordTrace();
 
+  // Adds a network interface named |name| to the endpoint, e.g., a cellular
+  // interface next to the Wi-Fi one.  The interface is owned by the endpoint
+  // and has to be connected to the network separately.
+  Interface* AddInterface(std::string name);
+
+  // Makes the packets written to the address of the peer's interface
+  // |interface_name| go to that interface, and the packets received from it be
+  // processed with its address as the peer address.
+  void AddPeerInterface(std::string interface_name);
+
   // Begin Endpoint implementation.
   UnconstrainedPortInterface* GetRxPort() override;
   void SetTxPort(ConstrainedPortInterface* port) override;
@@ -73,6 +88,8 @@ class QuicEndpointBase : public Endpoint,
   class Writer : public QuicPacketWriter {
    public:
     explicit Writer(QuicEndpointBase* endpoint);
+    // Writes into |tx_queue| packets originating from |source|.
+    Writer(QuicEndpointBase* endpoint, std::string source, Queue* tx_queue);
     ~Writer() override;
 
     WriteResult WritePacket(const char* buffer, size_t buf_len,
@@ -93,6 +110,8 @@ class QuicEndpointBase : public Endpoint,
 
    private:
     QuicEndpointBase* endpoint_;
+    std::string source_;
+    Queue* tx_queue_;
 
     bool is_blocked_;
   };
@@ -110,7 +129,12 @@ class QuicEndpointBase : public Endpoint,
                          QuicDataWriter* writer) override;
   };
 
+  // Returns the name of the peer's interface which has |peer_address|.
+  std::string GetPeerName(const QuicSocketAddress& peer_address) const;
+
   std::string peer_name_;
+  // Additional interfaces of the peer, and their addresses.
+  std::vector<std::pair<std::string, QuicSocketAddress>> peer_interfaces_;
 
   Writer writer_;
   // The queue for the outgoing packets.  In reality, this might be either on
@@ -127,6 +151,42 @@ class QuicEndpointBase : public Endpoint,
   bool drop_next_packet_;
 
   std::unique_ptr<QuicTraceVisitor> trace_visitor_;
+
+  std::vector<std::unique_ptr<Interface>> interfaces_;
+};
+
+// An additional network interface of a QuicEndpointBase.  It has its own
+// address and egress queue, and passes the packets it receives to the
+// endpoint's connection.
+class QuicEndpointBase::Interface : public Endpoint,
+                                    public UnconstrainedPortInterface,
+                                    public Queue::ListenerInterface {
+ public:
+  Interface(QuicEndpointBase* endpoint, std::string name);
+  ~Interface() override;
+
+  const QuicSocketAddress& address() const { return address_; }
+  QuicPacketWriter* writer() { return &writer_; }
+
+  // UnconstrainedPortInterface method.
+  void AcceptPacket(std::unique_ptr<Packet> packet) override;
+
+  // Begin Endpoint implementation.
+  UnconstrainedPortInterface* GetRxPort() override;
+  void SetTxPort(ConstrainedPortInterface* port) override;
+  // End Endpoint implementation.
+
+  // Actor method.
+  void Act() override {}
+
+  // Queue::ListenerInterface method.
+  void OnPacketDequeued() override;
+
+ private:
+  QuicEndpointBase* endpoint_;
+  const QuicSocketAddress address_;
+  Writer writer_;
+  Queue tx_queue_;
 };
 
 // Multiplexes multiple connections at the same host on the network.
@@ -6,6 +6,7 @@
 
 #include <utility>
 
+#include "quiche/quic/core/crypto/crypto_protocol.h"
 #include "quiche/quic/platform/api/quic_flags.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/quic_connection_peer.h"
@@ -203,5 +204,114 @@ TEST_F(QuicEndpointTest, Competition) {
   }
 }
 
+namespace {
+
+// Returns the number of packets, almost all of them ACK-only, sent by the
+// receiver of a 10 MiB bulk transfer over a 100 Mbps path with an 80ms RTT.
+QuicPacketCount ReceiverPacketsForBulkTransfer(bool adapt_ack_frequency) {
+  const QuicBandwidth bandwidth = QuicBandwidth::FromKBitsPerSecond(100 * 1000);
+  const QuicTime::Delta delay = QuicTime::Delta::FromMilliseconds(20);
+  const QuicByteCount bytes_to_transfer = 10 * 1024 * 1024;
+  Simulator simulator;
+  Switch network_switch(&simulator, "Switch", 8, bandwidth * (8 * delay));
+  QuicEndpoint client(&simulator, "Client", "Server", Perspective::IS_CLIENT,
+                      test::TestConnectionId(42));
+  QuicEndpoint server(&simulator, "Server", "Client", Perspective::IS_SERVER,
+                      test::TestConnectionId(42));
+  SymmetricLink client_link(&client, network_switch.port(1), bandwidth, delay);
+  SymmetricLink server_link(&server, network_switch.port(2), bandwidth, delay);
+  if (adapt_ack_frequency) {
+    client.EnableAckFrequency({kAFF3});
+    server.EnableAckFrequency({kAFF3});
+  }
+
+  server.AddBytesToTransfer(bytes_to_transfer);
+  EXPECT_TRUE(simulator.RunUntilOrTimeout(
+      [&client, bytes_to_transfer]() {
+        return client.bytes_received() == bytes_to_transfer;
+      },
+      QuicTime::Delta::FromSeconds(30)));
+  EXPECT_FALSE(client.wrong_data_received());
+  EXPECT_EQ(adapt_ack_frequency,
+            server.connection()->GetStats().num_ack_frequency_frames_sent > 0);
+  return client.connection()->GetStats().packets_sent;
+}
+
+}  // namespace
+
+// Once the sender knows the bandwidth-delay product, it asks the receiver to
+// ACK every 64 packets instead of every 10.
+TEST_F(QuicEndpointTest, AdaptiveAckFrequencyReducesAcks) {
+  const QuicPacketCount default_acks = ReceiverPacketsForBulkTransfer(false);
+  const QuicPacketCount adaptive_acks = ReceiverPacketsForBulkTransfer(true);
+  EXPECT_LT(adaptive_acks, default_acks / 2);
+}
+
+namespace {
+
+// Returns how long it takes a client to upload 4 MiB to a server over Wi-Fi,
+// 10 Mbps with a 40ms RTT, while also sending on its cellular interface, 5 Mbps
+// with an 80ms RTT, if |use_cellular| is true.
+QuicTime::Delta UploadTime(bool use_cellular) {
+  const QuicBandwidth wifi_bandwidth =
+      QuicBandwidth::FromKBitsPerSecond(10 * 1000);
+  const QuicBandwidth cellular_bandwidth =
+      QuicBandwidth::FromKBitsPerSecond(5 * 1000);
+  const QuicBandwidth server_bandwidth =
+      QuicBandwidth::FromKBitsPerSecond(100 * 1000);
+  const QuicTime::Delta wifi_delay = QuicTime::Delta::FromMilliseconds(15);
+  const QuicTime::Delta cellular_delay = QuicTime::Delta::FromMilliseconds(35);
+  const QuicTime::Delta server_delay = QuicTime::Delta::FromMilliseconds(5);
+  const QuicByteCount bytes_to_transfer = 4 * 1024 * 1024;
+  Simulator simulator;
+  Switch network_switch(&simulator, "Switch", 8,
+                        server_bandwidth * (8 * cellular_delay));
+  QuicEndpoint client(&simulator, "Client", "Server", Perspective::IS_CLIENT,
+                      test::TestConnectionId(42));
+  QuicEndpoint server(&simulator, "Server", "Client", Perspective::IS_SERVER,
+                      test::TestConnectionId(42));
+  QuicEndpointBase::Interface* cellular =
+      client.AddInterface("Client (cellular)");
+  SymmetricLink wifi_link(&client, network_switch.port(1), wifi_bandwidth,
+                          wifi_delay);
+  SymmetricLink cellular_link(cellular, network_switch.port(2),
+                              cellular_bandwidth, cellular_delay);
+  SymmetricLink server_link(&server, network_switch.port(3), server_bandwidth,
+                            server_delay);
+  if (use_cellular) {
+    client.EnableMultipath(kMPTH);
+    server.EnableMultipath(kMPTH);
+    server.AddPeerInterface("Client (cellular)");
+    EXPECT_NE(kInvalidPathId,
+              client.connection()->AddMultipathPath(
+                  cellular->address(), client.connection()->peer_address(),
+                  cellular->writer(), /*owns_writer=*/false));
+  }
+
+  const QuicTime start_time = simulator.GetClock()->Now();
+  client.AddBytesToTransfer(bytes_to_transfer);
+  EXPECT_TRUE(simulator.RunUntilOrTimeout(
+      [&server, bytes_to_transfer]() {
+        return server.bytes_received() == bytes_to_transfer;
+      },
+      QuicTime::Delta::FromSeconds(30)));
+  EXPECT_FALSE(server.wrong_data_received());
+  EXPECT_EQ(
+      use_cellular,
+      client.connection()->GetStats().num_packets_sent_on_additional_paths > 0);
+  return simulator.GetClock()->Now() - start_time;
+}
+
+}  // namespace
+
+// Spreading an upload over Wi-Fi and cellular, each path with its own
+// congestion controller, beats using Wi-Fi alone.
+TEST_F(QuicEndpointTest, MultipathUploadUsesBothInterfaces) {
+  SetQuicReloadableFlag(quic_enable_multipath_experiment, true);
+  const QuicTime::Delta wifi_only_time = UploadTime(false);
+  const QuicTime::Delta multipath_time = UploadTime(true);
+  EXPECT_LT(multipath_time, 0.85 * wifi_only_time);
+}
+
 }  // namespace simulator
 }  // namespace quic
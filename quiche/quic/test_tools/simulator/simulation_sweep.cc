@@ -0,0 +1,407 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/test_tools/simulator/simulation_sweep.h"
+
+#include <algorithm>
+#include <atomic>
+#include <limits>
+#include <memory>
+#include <utility>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_join.h"
+#include "quiche/quic/core/congestion_control/rtt_stats.h"
+#include "quiche/quic/core/quic_config.h"
+#include "quiche/quic/test_tools/quic_config_peer.h"
+#include "quiche/quic/test_tools/quic_connection_peer.h"
+#include "quiche/quic/test_tools/quic_sent_packet_manager_peer.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+#include "quiche/quic/test_tools/simulator/actor.h"
+#include "quiche/quic/test_tools/simulator/link.h"
+#include "quiche/quic/test_tools/simulator/packet_filter.h"
+#include "quiche/quic/test_tools/simulator/quic_endpoint.h"
+#include "quiche/quic/test_tools/simulator/simulator.h"
+#include "quiche/quic/test_tools/simulator/switch.h"
+#include "quiche/quic/test_tools/simulator/traffic_policer.h"
+#include "quiche/common/platform/api/quiche_logging.h"
+#include "quiche/common/platform/api/quiche_thread.h"
+
+namespace quic {
+namespace simulator {
+namespace {
+
+const char* CongestionControlTypeToString(CongestionControlType type) {
+  switch (type) {
+    case kCubicBytes:
+      return "CUBIC_BYTES";
+    case kRenoBytes:
+      return "RENO_BYTES";
+    case kBBR:
+      return "BBR";
+    case kPCC:
+      return "PCC";
+    case kGoogCC:
+      return "GOOGCC";
+    case kBBRv2:
+      return "BBRv2";
+  }
+  return "???";
+}
+
+std::string ConnectionOptionsToString(const QuicTagVector& options) {
+  std::vector<std::string> tags;
+  for (QuicTag tag : options) {
+    tags.push_back(QuicTagToString(tag));
+  }
+  return absl::StrJoin(tags, "+");
+}
+
+// Drops each packet with probability |loss_rate|, using the simulator's
+// random generator so that the losses are determined by the seed.
+class RandomLossFilter : public PacketFilter {
+ public:
+  RandomLossFilter(Simulator* simulator, std::string name, float loss_rate,
+                   Endpoint* input)
+      : PacketFilter(simulator, name, input), loss_rate_(loss_rate) {}
+
+ protected:
+  bool FilterPacket(const Packet& /*packet*/) override {
+    const uint64_t random = simulator_->GetRandomGenerator()->RandUint64();
+    return static_cast<double>(random) /
+               std::numeric_limits<uint64_t>::max() >=
+           loss_rate_;
+  }
+
+ private:
+  const float loss_rate_;
+};
+
+// Records the sender's latest RTT and the bottleneck queue occupancy at a
+// fixed interval, so that both are weighted by time rather than by packet.
+class Sampler : public Actor {
+ public:
+  Sampler(Simulator* simulator, std::string name, const RttStats* rtt_stats,
+          const Queue* queue, QuicTime::Delta interval)
+      : Actor(simulator, name),
+        rtt_stats_(rtt_stats),
+        queue_(queue),
+        interval_(interval) {
+    Schedule(clock_->Now());
+  }
+
+  void Act() override {
+    if (!rtt_stats_->latest_rtt().IsZero()) {
+      rtt_samples_.push_back(rtt_stats_->latest_rtt());
+    }
+    queue_samples_.push_back(queue_->bytes_queued());
+    Schedule(clock_->Now() + interval_);
+  }
+
+  std::vector<QuicTime::Delta>* rtt_samples() { return &rtt_samples_; }
+  std::vector<QuicByteCount>* queue_samples() { return &queue_samples_; }
+
+ private:
+  const RttStats* rtt_stats_;
+  const Queue* queue_;
+  const QuicTime::Delta interval_;
+
+  std::vector<QuicTime::Delta> rtt_samples_;
+  std::vector<QuicByteCount> queue_samples_;
+};
+
+// Returns the |percentile|th percentile of the non-empty |samples|, reordering
+// them.
+template <typename T>
+T Percentile(std::vector<T>* samples, double percentile) {
+  QUICHE_DCHECK(!samples->empty());
+  const size_t index = std::min(
+      samples->size() - 1, static_cast<size_t>(samples->size() * percentile));
+  std::nth_element(samples->begin(), samples->begin() + index, samples->end());
+  return (*samples)[index];
+}
+
+float Ratio(QuicTime::Delta numerator, QuicTime::Delta denominator) {
+  if (denominator.IsZero()) {
+    return 0;
+  }
+  return static_cast<float>(numerator.ToMicroseconds()) /
+         denominator.ToMicroseconds();
+}
+
+class SweepWorker : public quiche::QuicheThread {
+ public:
+  SweepWorker(const std::vector<SweepScenario>* scenarios,
+              std::vector<SweepResult>* results, std::atomic<size_t>* next)
+      : QuicheThread("SweepWorker"),
+        scenarios_(scenarios),
+        results_(results),
+        next_(next) {}
+
+ protected:
+  void Run() override {
+    for (size_t i = next_->fetch_add(1); i < scenarios_->size();
+         i = next_->fetch_add(1)) {
+      (*results_)[i] = RunSweepScenario((*scenarios_)[i]);
+    }
+  }
+
+ private:
+  const std::vector<SweepScenario>* scenarios_;
+  std::vector<SweepResult>* results_;
+  std::atomic<size_t>* next_;
+};
+
+// A scenario under construction by SweepMatrix::Expand(), with the
+// description of each parameter set so far.
+struct PartialScenario {
+  SweepScenario scenario;
+  std::vector<std::string> name_parts;
+};
+
+// Replaces every scenario in |scenarios| with one copy per value in |values|,
+// or leaves |scenarios| unchanged if |values| is empty.
+template <typename T, typename Setter, typename Formatter>
+void ExpandDimension(const std::vector<T>& values, Setter set,
+                     Formatter format,
+                     std::vector<PartialScenario>* scenarios) {
+  if (values.empty()) {
+    return;
+  }
+  std::vector<PartialScenario> expanded;
+  expanded.reserve(scenarios->size() * values.size());
+  for (const PartialScenario& partial : *scenarios) {
+    for (const T& value : values) {
+      expanded.push_back(partial);
+      set(value, &expanded.back().scenario);
+      expanded.back().name_parts.push_back(format(value));
+    }
+  }
+  *scenarios = std::move(expanded);
+}
+
+}  // namespace
+
+std::vector<SweepScenario> SweepMatrix::Expand() const {
+  std::vector<PartialScenario> partials = {{base, {}}};
+  if (!base.name.empty()) {
+    partials[0].name_parts.push_back(base.name);
+  }
+
+  ExpandDimension(
+      bandwidths,
+      [](QuicBandwidth value, SweepScenario* s) { s->bandwidth = value; },
+      [](QuicBandwidth value) {
+        return absl::StrCat("bw=", value.ToKBitsPerSecond(), "kbps");
+      },
+      &partials);
+  ExpandDimension(
+      rtts, [](QuicTime::Delta value, SweepScenario* s) { s->rtt = value; },
+      [](QuicTime::Delta value) {
+        return absl::StrCat("rtt=", value.ToMicroseconds(), "us");
+      },
+      &partials);
+  ExpandDimension(
+      buffer_bdps, [](float value, SweepScenario* s) { s->buffer_bdp = value; },
+      [](float value) { return absl::StrCat("buffer=", value, "bdp"); },
+      &partials);
+  ExpandDimension(
+      policer_bandwidths,
+      [](QuicBandwidth value, SweepScenario* s) {
+        s->policer_bandwidth = value;
+      },
+      [](QuicBandwidth value) {
+        return absl::StrCat("policer=", value.ToKBitsPerSecond(), "kbps");
+      },
+      &partials);
+  ExpandDimension(
+      loss_rates, [](float value, SweepScenario* s) { s->loss_rate = value; },
+      [](float value) { return absl::StrCat("loss=", value); }, &partials);
+  ExpandDimension(
+      congestion_controls,
+      [](CongestionControlType value, SweepScenario* s) {
+        s->congestion_control = value;
+      },
+      [](CongestionControlType value) {
+        return absl::StrCat("cc=", CongestionControlTypeToString(value));
+      },
+      &partials);
+  ExpandDimension(
+      connection_options,
+      [](const QuicTagVector& value, SweepScenario* s) {
+        s->connection_options = value;
+      },
+      [](const QuicTagVector& value) {
+        return absl::StrCat("options=", ConnectionOptionsToString(value));
+      },
+      &partials);
+  ExpandDimension(
+      seeds, [](uint64_t value, SweepScenario* s) { s->seed = value; },
+      [](uint64_t value) { return absl::StrCat("seed=", value); }, &partials);
+
+  std::vector<SweepScenario> scenarios;
+  scenarios.reserve(partials.size());
+  for (PartialScenario& partial : partials) {
+    partial.scenario.name = absl::StrJoin(partial.name_parts, "/");
+    scenarios.push_back(std::move(partial.scenario));
+  }
+  return scenarios;
+}
+
+SweepResult RunSweepScenario(const SweepScenario& scenario) {
+  test::SimpleRandom random;
+  random.set_seed(scenario.seed);
+  Simulator simulator(&random);
+
+  QuicEndpoint sender(&simulator, "Sender", "Receiver", Perspective::IS_CLIENT,
+                      test::TestConnectionId(42));
+  QuicEndpoint receiver(&simulator, "Receiver", "Sender",
+                        Perspective::IS_SERVER, test::TestConnectionId(42));
+
+  QuicSentPacketManager* sent_packet_manager =
+      test::QuicConnectionPeer::GetSentPacketManager(sender.connection());
+  sent_packet_manager->SetSendAlgorithm(scenario.congestion_control);
+  if (!scenario.connection_options.empty()) {
+    QuicConfig config;
+    test::QuicConfigPeer::SetReceivedConnectionOptions(
+        &config, scenario.connection_options);
+    test::QuicSentPacketManagerPeer::GetSendAlgorithm(*sent_packet_manager)
+        ->SetFromConfig(config, Perspective::IS_SERVER);
+  }
+
+  const QuicByteCount bdp = scenario.bandwidth * scenario.rtt;
+  const QuicByteCount queue_capacity =
+      std::max(kMaxOutgoingPacketSize,
+               static_cast<QuicByteCount>(scenario.buffer_bdp * bdp));
+  Switch network_switch(&simulator, "Switch", 2, queue_capacity);
+
+  SymmetricLink local_link(&sender, network_switch.port(1),
+                           scenario.bandwidth * 10, QuicTime::Delta::Zero());
+
+  Endpoint* receiver_side = network_switch.port(2);
+  std::unique_ptr<TrafficPolicer> policer;
+  if (!scenario.policer_bandwidth.IsZero()) {
+    policer = std::make_unique<TrafficPolicer>(
+        &simulator, "Policer", scenario.policer_bucket_size,
+        scenario.policer_bucket_size, scenario.policer_bandwidth,
+        receiver_side);
+    receiver_side = policer.get();
+  }
+  std::unique_ptr<RandomLossFilter> loss_filter;
+  if (scenario.loss_rate > 0) {
+    loss_filter = std::make_unique<RandomLossFilter>(
+        &simulator, "Loss filter", scenario.loss_rate, receiver_side);
+    receiver_side = loss_filter.get();
+  }
+  SymmetricLink bottleneck_link(&receiver, receiver_side, scenario.bandwidth,
+                                scenario.rtt * 0.5);
+
+  Sampler sampler(&simulator, "Sampler", sent_packet_manager->GetRttStats(),
+                  network_switch.port_queue(2), scenario.sample_interval);
+
+  const QuicTime start = simulator.GetClock()->Now();
+  sender.AddBytesToTransfer(scenario.transfer_bytes);
+  SweepResult result;
+  result.scenario = scenario;
+  result.completed = simulator.RunUntilOrTimeout(
+      [&receiver, &scenario]() {
+        return receiver.bytes_received() >= scenario.transfer_bytes;
+      },
+      scenario.max_duration);
+
+  result.duration = simulator.GetClock()->Now() - start;
+  result.bytes_received = receiver.bytes_received();
+  if (!result.duration.IsZero()) {
+    result.goodput = QuicBandwidth::FromBytesAndTimeDelta(
+        result.bytes_received, result.duration);
+  }
+
+  result.min_rtt = sent_packet_manager->GetRttStats()->min_rtt();
+  std::vector<QuicTime::Delta>* rtt_samples = sampler.rtt_samples();
+  if (!rtt_samples->empty()) {
+    result.p50_rtt = Percentile(rtt_samples, 0.5);
+    result.p99_rtt = Percentile(rtt_samples, 0.99);
+    result.p50_rtt_inflation = Ratio(result.p50_rtt, result.min_rtt);
+    result.p99_rtt_inflation = Ratio(result.p99_rtt, result.min_rtt);
+  }
+
+  const QuicConnectionStats& stats = sender.connection()->GetStats();
+  result.packets_sent = stats.packets_sent;
+  result.packets_lost = stats.packets_lost;
+  if (stats.packets_sent > 0) {
+    result.loss_rate =
+        static_cast<float>(stats.packets_lost) / stats.packets_sent;
+  }
+
+  std::vector<QuicByteCount>* queue_samples = sampler.queue_samples();
+  if (!queue_samples->empty()) {
+    QuicByteCount total = 0;
+    for (QuicByteCount sample : *queue_samples) {
+      total += sample;
+      result.max_queue_bytes = std::max(result.max_queue_bytes, sample);
+    }
+    result.mean_queue_bytes = total / queue_samples->size();
+    result.p99_queue_bytes = Percentile(queue_samples, 0.99);
+  }
+  return result;
+}
+
+std::vector<SweepResult> RunSweep(const std::vector<SweepScenario>& scenarios,
+                                  int num_threads) {
+  std::vector<SweepResult> results(scenarios.size());
+  std::atomic<size_t> next(0);
+  std::vector<std::unique_ptr<SweepWorker>> workers;
+  for (int i = 0; i < std::max(1, num_threads); ++i) {
+    workers.push_back(
+        std::make_unique<SweepWorker>(&scenarios, &results, &next));
+    workers.back()->Start();
+  }
+  for (auto& worker : workers) {
+    worker->Join();
+  }
+  return results;
+}
+
+std::string SweepResultsToCsv(const std::vector<SweepResult>& results) {
+  std::string csv =
+      "name,bandwidth_kbps,rtt_us,buffer_bdp,policer_kbps,configured_loss,"
+      "congestion_control,connection_options,seed,completed,duration_us,"
+      "bytes_received,goodput_kbps,min_rtt_us,p50_rtt_us,p99_rtt_us,"
+      "p50_rtt_inflation,p99_rtt_inflation,packets_sent,packets_lost,"
+      "loss_rate,mean_queue_bytes,p99_queue_bytes,max_queue_bytes\n";
+  for (const SweepResult& result : results) {
+    const SweepScenario& scenario = result.scenario;
+    std::string name = scenario.name;
+    if (name.find_first_of(",\"\n") != std::string::npos) {
+      std::string quoted = "\"";
+      for (char c : name) {
+        if (c == '"') {
+          quoted += '"';
+        }
+        quoted += c;
+      }
+      name = quoted + "\"";
+    }
+    absl::StrAppend(
+        &csv, name, ",", scenario.bandwidth.ToKBitsPerSecond(), ",",
+        scenario.rtt.ToMicroseconds(), ",", scenario.buffer_bdp, ",",
+        scenario.policer_bandwidth.ToKBitsPerSecond(), ",",
+        scenario.loss_rate, ",",
+        CongestionControlTypeToString(scenario.congestion_control), ",",
+        ConnectionOptionsToString(scenario.connection_options), ",",
+        scenario.seed, ",", result.completed ? "true" : "false", ",",
+        result.duration.ToMicroseconds(), ",", result.bytes_received, ",",
+        result.goodput.ToKBitsPerSecond(), ",",
+        result.min_rtt.ToMicroseconds(), ",", result.p50_rtt.ToMicroseconds(),
+        ",", result.p99_rtt.ToMicroseconds(), ",", result.p50_rtt_inflation,
+        ",", result.p99_rtt_inflation, ",", result.packets_sent, ",",
+        result.packets_lost, ",", result.loss_rate, ",",
+        result.mean_queue_bytes, ",", result.p99_queue_bytes, ",",
+        result.max_queue_bytes, "\n");
+  }
+  return csv;
+}
+
+}  // namespace simulator
+}  // namespace quic
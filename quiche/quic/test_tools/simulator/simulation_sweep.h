@@ -0,0 +1,131 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_SIMULATOR_SIMULATION_SWEEP_H_
+#define QUICHE_QUIC_TEST_TOOLS_SIMULATOR_SIMULATION_SWEEP_H_
+
+#include <cstdint>
+#include <string>
+#include <vector>
+
+#include "quiche/quic/core/quic_bandwidth.h"
+#include "quiche/quic/core/quic_tag.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/core/quic_types.h"
+
+namespace quic {
+namespace simulator {
+
+// A parameter sweep runs many independent simulations of a single bulk
+// transfer, each in its own Simulator, on a pool of threads.  Every scenario
+// uses the following topology:
+//
+//   Sender --- local link --- Switch *--- [policer] --- [loss] --- Receiver
+//
+// The local link is ten times faster than the bottleneck and adds no
+// propagation delay, the switch queue in the direction of the receiver is the
+// bottleneck queue, and the optional traffic policer and random loss filter
+// apply to the traffic towards the receiver.
+//
+// The outcome of a scenario depends only on its parameters, including its
+// seed, and not on the number of threads or on the other scenarios in the
+// sweep.  Scenarios must not change QUIC flags while a sweep is running; set
+// them (e.g. FLAGS_quic_max_tracked_packet_count for long transfers) before
+// starting the sweep.
+
+struct SweepScenario {
+  // Free form label copied into the result.
+  std::string name;
+
+  // Bottleneck link.
+  QuicBandwidth bandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  QuicTime::Delta rtt = QuicTime::Delta::FromMilliseconds(100);
+  // Bottleneck queue capacity, in multiples of the bandwidth-delay product.
+  float buffer_bdp = 1;
+
+  // Traffic policer in front of the receiver.  Disabled if zero.
+  QuicBandwidth policer_bandwidth = QuicBandwidth::Zero();
+  QuicByteCount policer_bucket_size = 100 * 1000;
+
+  // Probability that a packet towards the receiver is dropped at random.
+  float loss_rate = 0;
+
+  // Sender configuration.
+  CongestionControlType congestion_control = kBBRv2;
+  QuicTagVector connection_options;
+
+  // The scenario ends when |transfer_bytes| have been received, or when
+  // |max_duration| of simulated time has elapsed.
+  QuicByteCount transfer_bytes = 10 * 1000 * 1000;
+  QuicTime::Delta max_duration = QuicTime::Delta::FromSeconds(60);
+
+  // How often the RTT and the bottleneck queue are sampled.
+  QuicTime::Delta sample_interval = QuicTime::Delta::FromMilliseconds(1);
+
+  uint64_t seed = 0;
+};
+
+// Declares a sweep as the cartesian product of its non-empty dimensions.
+// Parameters without a dimension, or whose dimension is empty, are taken from
+// |base|.
+struct SweepMatrix {
+  SweepScenario base;
+
+  std::vector<QuicBandwidth> bandwidths;
+  std::vector<QuicTime::Delta> rtts;
+  std::vector<float> buffer_bdps;
+  std::vector<QuicBandwidth> policer_bandwidths;
+  std::vector<float> loss_rates;
+  std::vector<CongestionControlType> congestion_controls;
+  std::vector<QuicTagVector> connection_options;
+  std::vector<uint64_t> seeds;
+
+  // Returns every combination, with the name of each scenario describing its
+  // swept parameters.  The last dimension (seeds) varies fastest.
+  std::vector<SweepScenario> Expand() const;
+};
+
+struct SweepResult {
+  SweepScenario scenario;
+
+  // True if all of |transfer_bytes| were received before |max_duration|.
+  bool completed = false;
+  QuicTime::Delta duration = QuicTime::Delta::Zero();
+  QuicByteCount bytes_received = 0;
+  QuicBandwidth goodput = QuicBandwidth::Zero();
+
+  // The sender's minimum RTT and the percentiles of its latest RTT sampled
+  // every |sample_interval|, and their ratio to the minimum.
+  QuicTime::Delta min_rtt = QuicTime::Delta::Zero();
+  QuicTime::Delta p50_rtt = QuicTime::Delta::Zero();
+  QuicTime::Delta p99_rtt = QuicTime::Delta::Zero();
+  float p50_rtt_inflation = 0;
+  float p99_rtt_inflation = 0;
+
+  QuicPacketCount packets_sent = 0;
+  QuicPacketCount packets_lost = 0;
+  float loss_rate = 0;
+
+  // Occupancy of the bottleneck queue, sampled every |sample_interval|.
+  QuicByteCount mean_queue_bytes = 0;
+  QuicByteCount p99_queue_bytes = 0;
+  QuicByteCount max_queue_bytes = 0;
+};
+
+// Runs a single scenario on the calling thread.
+SweepResult RunSweepScenario(const SweepScenario& scenario);
+
+// Runs |scenarios| on |num_threads| threads and returns their results in the
+// same order.
+std::vector<SweepResult> RunSweep(const std::vector<SweepScenario>& scenarios,
+                                  int num_threads);
+
+// Formats |results| as CSV, with a header line followed by one line per
+// result.
+std::string SweepResultsToCsv(const std::vector<SweepResult>& results);
+
+}  // namespace simulator
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_SIMULATOR_SIMULATION_SWEEP_H_
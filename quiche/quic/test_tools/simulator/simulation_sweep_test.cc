@@ -0,0 +1,155 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/test_tools/simulator/simulation_sweep.h"
+
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_split.h"
+#include "quiche/quic/core/crypto/crypto_protocol.h"
+#include "quiche/quic/platform/api/quic_test.h"
+
+namespace quic {
+namespace simulator {
+namespace {
+
+SweepScenario ShortScenario() {
+  SweepScenario scenario;
+  scenario.bandwidth = QuicBandwidth::FromKBitsPerSecond(10000);
+  scenario.rtt = QuicTime::Delta::FromMilliseconds(20);
+  scenario.transfer_bytes = 1000 * 1000;
+  scenario.max_duration = QuicTime::Delta::FromSeconds(10);
+  return scenario;
+}
+
+void ExpectSameResult(const SweepResult& expected, const SweepResult& actual) {
+  EXPECT_EQ(expected.scenario.name, actual.scenario.name);
+  EXPECT_EQ(expected.completed, actual.completed);
+  EXPECT_EQ(expected.duration, actual.duration);
+  EXPECT_EQ(expected.bytes_received, actual.bytes_received);
+  EXPECT_EQ(expected.min_rtt, actual.min_rtt);
+  EXPECT_EQ(expected.p50_rtt, actual.p50_rtt);
+  EXPECT_EQ(expected.p99_rtt, actual.p99_rtt);
+  EXPECT_EQ(expected.packets_sent, actual.packets_sent);
+  EXPECT_EQ(expected.packets_lost, actual.packets_lost);
+  EXPECT_EQ(expected.mean_queue_bytes, actual.mean_queue_bytes);
+  EXPECT_EQ(expected.max_queue_bytes, actual.max_queue_bytes);
+}
+
+class SimulationSweepTest : public quic::test::QuicTest {};
+
+TEST_F(SimulationSweepTest, Expand) {
+  SweepMatrix matrix;
+  matrix.base.name = "base";
+  matrix.base.transfer_bytes = 1234;
+  matrix.bandwidths = {QuicBandwidth::FromKBitsPerSecond(1000),
+                       QuicBandwidth::FromKBitsPerSecond(2000)};
+  matrix.congestion_controls = {kBBRv2, kCubicBytes};
+  matrix.seeds = {1, 2, 3};
+
+  const std::vector<SweepScenario> scenarios = matrix.Expand();
+  ASSERT_EQ(12u, scenarios.size());
+  EXPECT_EQ("base/bw=1000kbps/cc=BBRv2/seed=1", scenarios[0].name);
+  EXPECT_EQ("base/bw=1000kbps/cc=BBRv2/seed=2", scenarios[1].name);
+  EXPECT_EQ("base/bw=1000kbps/cc=CUBIC_BYTES/seed=1", scenarios[3].name);
+  EXPECT_EQ("base/bw=2000kbps/cc=CUBIC_BYTES/seed=3", scenarios[11].name);
+  EXPECT_EQ(QuicBandwidth::FromKBitsPerSecond(2000), scenarios[11].bandwidth);
+  EXPECT_EQ(kCubicBytes, scenarios[11].congestion_control);
+  EXPECT_EQ(3u, scenarios[11].seed);
+  for (const SweepScenario& scenario : scenarios) {
+    EXPECT_EQ(1234u, scenario.transfer_bytes);
+    EXPECT_EQ(matrix.base.rtt, scenario.rtt);
+  }
+}
+
+TEST_F(SimulationSweepTest, ExpandWithoutDimensions) {
+  SweepMatrix matrix;
+  const std::vector<SweepScenario> scenarios = matrix.Expand();
+  ASSERT_EQ(1u, scenarios.size());
+  EXPECT_EQ("", scenarios[0].name);
+}
+
+TEST_F(SimulationSweepTest, SimpleTransfer) {
+  const SweepResult result = RunSweepScenario(ShortScenario());
+  EXPECT_TRUE(result.completed);
+  EXPECT_GE(result.bytes_received, 1000u * 1000u);
+  EXPECT_LT(QuicBandwidth::Zero(), result.goodput);
+  EXPECT_GE(QuicBandwidth::FromKBitsPerSecond(10000), result.goodput);
+  EXPECT_LE(QuicTime::Delta::FromMilliseconds(20), result.min_rtt);
+  EXPECT_LE(result.p50_rtt, result.p99_rtt);
+  EXPECT_LE(1.0f, result.p50_rtt_inflation);
+  EXPECT_LT(0u, result.packets_sent);
+  EXPECT_LT(0u, result.max_queue_bytes);
+}
+
+TEST_F(SimulationSweepTest, RandomLoss) {
+  SweepScenario scenario = ShortScenario();
+  scenario.loss_rate = 0.05;
+  const SweepResult result = RunSweepScenario(scenario);
+  EXPECT_TRUE(result.completed);
+  EXPECT_LT(0u, result.packets_lost);
+  EXPECT_LT(0, result.loss_rate);
+}
+
+TEST_F(SimulationSweepTest, Policer) {
+  SweepScenario scenario = ShortScenario();
+  scenario.policer_bandwidth = QuicBandwidth::FromKBitsPerSecond(2000);
+  scenario.policer_bucket_size = 20 * 1000;
+  const SweepResult result = RunSweepScenario(scenario);
+  EXPECT_TRUE(result.completed);
+  EXPECT_GE(QuicBandwidth::FromKBitsPerSecond(2500), result.goodput);
+}
+
+TEST_F(SimulationSweepTest, ConnectionOptions) {
+  SweepScenario scenario = ShortScenario();
+  scenario.connection_options = {kBBQ1};
+  EXPECT_TRUE(RunSweepScenario(scenario).completed);
+}
+
+TEST_F(SimulationSweepTest, DeterministicPerSeed) {
+  SweepScenario scenario = ShortScenario();
+  scenario.loss_rate = 0.01;
+  scenario.seed = 42;
+  ExpectSameResult(RunSweepScenario(scenario), RunSweepScenario(scenario));
+}
+
+// Results do not depend on the number of threads or on the order in which the
+// scenarios happen to run.
+TEST_F(SimulationSweepTest, IndependentOfThreads) {
+  SweepMatrix matrix;
+  matrix.base = ShortScenario();
+  matrix.loss_rates = {0, 0.02};
+  matrix.seeds = {1, 2, 3};
+  const std::vector<SweepScenario> scenarios = matrix.Expand();
+
+  const std::vector<SweepResult> serial = RunSweep(scenarios, 1);
+  const std::vector<SweepResult> parallel = RunSweep(scenarios, 4);
+  ASSERT_EQ(scenarios.size(), serial.size());
+  ASSERT_EQ(scenarios.size(), parallel.size());
+  for (size_t i = 0; i < scenarios.size(); ++i) {
+    EXPECT_EQ(scenarios[i].name, serial[i].scenario.name);
+    ExpectSameResult(serial[i], parallel[i]);
+  }
+}
+
+TEST_F(SimulationSweepTest, Csv) {
+  SweepMatrix matrix;
+  matrix.base = ShortScenario();
+  matrix.base.name = "a,b";
+  matrix.seeds = {1, 2};
+  const std::string csv = SweepResultsToCsv(RunSweep(matrix.Expand(), 2));
+
+  const std::vector<std::string> lines =
+      absl::StrSplit(csv, '\n', absl::SkipEmpty());
+  ASSERT_EQ(3u, lines.size());
+  const std::vector<std::string> columns = absl::StrSplit(lines[0], ',');
+  EXPECT_EQ(24u, columns.size());
+  EXPECT_EQ(0u, lines[1].find("\"a,b/seed=1\",10000,20000,"));
+  EXPECT_EQ(0u, lines[2].find("\"a,b/seed=2\","));
+}
+
+}  // namespace
+}  // namespace simulator
+}  // namespace quic
@@ -4,6 +4,9 @@
 
 #include "quiche/quic/test_tools/simulator/simulator.h"
 
+#include <algorithm>
+
+#include "absl/numeric/bits.h"
 #include "quiche/quic/core/crypto/quic_random.h"
 #include "quiche/quic/platform/api/quic_logging.h"
 
@@ -38,63 +41,89 @@ QuicWallTime Simulator::Clock::WallNow() const {
       (now_ - QuicTime::Zero()).ToMicroseconds());
 }
 
-void Simulator::AddActor(Actor* actor) {
-  auto emplace_times_result =
-      scheduled_times_.insert(std::make_pair(actor, QuicTime::Infinite()));
+size_t Simulator::AddActor(Actor* actor) {
   auto emplace_names_result = actor_names_.insert(actor->name());
-
-  // Ensure that the object was actually placed into the map.
-  QUICHE_DCHECK(emplace_times_result.second);
+  // Ensure that the object was actually placed into the set.
   QUICHE_DCHECK(emplace_names_result.second);
+
+  size_t index;
+  if (free_actor_indices_.empty()) {
+    index = actor_states_.size();
+    actor_states_.emplace_back();
+  } else {
+    index = free_actor_indices_.back();
+    free_actor_indices_.pop_back();
+    actor_states_[index] = ActorState();
+  }
+  actor_states_[index].actor = actor;
+  return index;
 }
 
 void Simulator::RemoveActor(Actor* actor) {
-  auto scheduled_time_it = scheduled_times_.find(actor);
   auto actor_names_it = actor_names_.find(actor->name());
-  QUICHE_DCHECK(scheduled_time_it != scheduled_times_.end());
   QUICHE_DCHECK(actor_names_it != actor_names_.end());
+  ActorState& state = actor_states_[actor->scheduler_index_];
+  QUICHE_DCHECK_EQ(state.actor, actor);
 
-  QuicTime scheduled_time = scheduled_time_it->second;
-  if (scheduled_time != QuicTime::Infinite()) {
+  if (state.scheduled_time != QuicTime::Infinite()) {
     Unschedule(actor);
   }
 
-  scheduled_times_.erase(scheduled_time_it);
+  // Any events left in the schedule for this actor are stale, and remain so
+  // when the index is reused since sequence numbers are never reused.
+  state.actor = nullptr;
+  free_actor_indices_.push_back(actor->scheduler_index_);
   actor_names_.erase(actor_names_it);
 }
 
 void Simulator::Schedule(Actor* actor, QuicTime new_time) {
-  auto scheduled_time_it = scheduled_times_.find(actor);
-  QUICHE_DCHECK(scheduled_time_it != scheduled_times_.end());
-  QuicTime scheduled_time = scheduled_time_it->second;
+  ActorState& state = actor_states_[actor->scheduler_index_];
+  QUICHE_DCHECK_EQ(state.actor, actor);
 
-  if (scheduled_time <= new_time) {
+  if (state.scheduled_time <= new_time) {
     return;
   }
 
-  if (scheduled_time != QuicTime::Infinite()) {
-    Unschedule(actor);
+  if (state.scheduled_time == QuicTime::Infinite()) {
+    ++num_scheduled_actors_;
   }
-
-  scheduled_time_it->second = new_time;
-  schedule_.insert(std::make_pair(new_time, actor));
+  state.scheduled_time = new_time;
+  state.sequence = next_event_sequence_++;
+  const uint64_t time = (new_time - QuicTime::Zero()).ToMicroseconds();
+  PushEvent({time, state.sequence, actor->scheduler_index_});
 }
 
 void Simulator::Unschedule(Actor* actor) {
-  auto scheduled_time_it = scheduled_times_.find(actor);
-  QUICHE_DCHECK(scheduled_time_it != scheduled_times_.end());
-  QuicTime scheduled_time = scheduled_time_it->second;
-
-  QUICHE_DCHECK(scheduled_time != QuicTime::Infinite());
-  auto range = schedule_.equal_range(scheduled_time);
-  for (auto it = range.first; it != range.second; ++it) {
-    if (it->second == actor) {
-      schedule_.erase(it);
-      scheduled_time_it->second = QuicTime::Infinite();
-      return;
-    }
+  ActorState& state = actor_states_[actor->scheduler_index_];
+  QUICHE_DCHECK_EQ(state.actor, actor);
+
+  QUICHE_DCHECK(state.scheduled_time != QuicTime::Infinite());
+  if (state.scheduled_time == QuicTime::Infinite()) {
+    return;
+  }
+  // The actor's event becomes stale.
+  state.scheduled_time = QuicTime::Infinite();
+  --num_scheduled_actors_;
+}
+
+std::unique_ptr<Packet> Simulator::AllocatePacket() {
+  if (packet_pool_.empty()) {
+    return std::make_unique<Packet>();
+  }
+  std::unique_ptr<Packet> packet = std::move(packet_pool_.back());
+  packet_pool_.pop_back();
+  packet->source.clear();
+  packet->destination.clear();
+  packet->tx_timestamp = QuicTime::Zero();
+  packet->contents.clear();
+  packet->size = 0;
+  return packet;
+}
+
+void Simulator::ReleasePacket(std::unique_ptr<Packet> packet) {
+  if (packet != nullptr) {
+    packet_pool_.push_back(std::move(packet));
   }
-  QUICHE_DCHECK(false);
 }
 
 const QuicClock* Simulator::GetClock() const { return &clock_; }
@@ -136,9 +165,17 @@ void Simulator::RunFor(QuicTime::Delta time_span) {
 }
 
 void Simulator::HandleNextScheduledActor() {
-  const auto current_event_it = schedule_.begin();
-  QuicTime event_time = current_event_it->first;
-  Actor* actor = current_event_it->second;
+  QUICHE_DCHECK_GT(num_scheduled_actors_, 0u);
+  Event event;
+  do {
+    event = PopEvent();
+  } while (actor_states_[event.actor_index].scheduled_time ==
+               QuicTime::Infinite() ||
+           actor_states_[event.actor_index].sequence != event.sequence);
+
+  ActorState& state = actor_states_[event.actor_index];
+  const QuicTime event_time = state.scheduled_time;
+  Actor* actor = state.actor;
   QUIC_DVLOG(3) << "At t = " << event_time.ToDebuggingValue() << ", calling "
                 << actor->name();
 
@@ -153,8 +190,59 @@ void Simulator::HandleNextScheduledActor() {
   }
   clock_.now_ = event_time;
 
+  ++num_events_handled_;
   actor->Act();
 }
 
+size_t Simulator::BucketFor(uint64_t time) const {
+  if (time == last_event_time_) {
+    return 0;
+  }
+  return 64 - absl::countl_zero(time ^ last_event_time_);
+}
+
+void Simulator::PushEvent(Event event) {
+  // An event in the past is handled as if it was scheduled for the time of
+  // the last event; HandleNextScheduledActor() reports it.
+  event.time = std::max(event.time, last_event_time_);
+  schedule_[BucketFor(event.time)].push_back(event);
+  ++num_events_;
+}
+
+Simulator::Event Simulator::PopEvent() {
+  QUICHE_DCHECK_GT(num_events_, 0u);
+  std::vector<Event>& first_bucket = schedule_[0];
+  if (first_event_index_ == first_bucket.size()) {
+    first_bucket.clear();
+    first_event_index_ = 0;
+
+    // Move the events of the lowest non-empty bucket, which contains the
+    // earliest event, to lower buckets relative to the earliest event.
+    size_t i = 1;
+    while (schedule_[i].empty()) {
+      ++i;
+    }
+    std::vector<Event> events;
+    events.swap(schedule_[i]);
+    last_event_time_ = events.front().time;
+    for (const Event& event : events) {
+      last_event_time_ = std::min(last_event_time_, event.time);
+    }
+    for (const Event& event : events) {
+      schedule_[BucketFor(event.time)].push_back(event);
+    }
+    // Keep the vector's capacity for the bucket.
+    events.clear();
+    events.swap(schedule_[i]);
+
+    std::sort(first_bucket.begin(), first_bucket.end(),
+              [](const Event& a, const Event& b) {
+                return a.sequence < b.sequence;
+              });
+  }
+  --num_events_;
+  return first_bucket[first_event_index_++];
+}
+
 }  // namespace simulator
 }  // namespace quic
@@ -5,14 +5,17 @@
 #ifndef QUICHE_QUIC_TEST_TOOLS_SIMULATOR_SIMULATOR_H_
 #define QUICHE_QUIC_TEST_TOOLS_SIMULATOR_SIMULATOR_H_
 
-#include <map>
+#include <array>
+#include <cstdint>
+#include <memory>
+#include <vector>
 
-#include "absl/container/flat_hash_map.h"
 #include "absl/container/flat_hash_set.h"
 #include "quiche/quic/core/quic_connection.h"
 #include "quiche/quic/platform/api/quic_bug_tracker.h"
 #include "quiche/quic/test_tools/simulator/actor.h"
 #include "quiche/quic/test_tools/simulator/alarm_factory.h"
+#include "quiche/quic/test_tools/simulator/port.h"
 #include "quiche/common/simple_buffer_allocator.h"
 
 namespace quic {
@@ -65,6 +68,18 @@ class Simulator : public QuicConnectionHelperInterface {
   // Runs the simulation for exactly the specified |time_span|.
   void RunFor(QuicTime::Delta time_span);
 
+  // Returns a packet with empty contents for an endpoint to send.  Packets
+  // returned by ReleasePacket() are reused, along with their buffers, so that
+  // packets can be sent without allocating memory.
+  std::unique_ptr<Packet> AllocatePacket();
+
+  // Called by the component that consumes or drops |packet|, to make it
+  // available to AllocatePacket().
+  void ReleasePacket(std::unique_ptr<Packet> packet);
+
+  // Number of times an actor has been called since the simulator was created.
+  uint64_t num_events_handled() const { return num_events_handled_; }
+
  private:
   friend class Actor;
 
@@ -95,8 +110,30 @@ class Simulator : public QuicConnectionHelperInterface {
     bool* run_for_should_stop_;
   };
 
-  // Register an actor with the simulator. Invoked by Actor constructor.
-  void AddActor(Actor* actor);
+  // Scheduling state of an actor.  Events refer to actors by the index of
+  // their state, so that events of actors which no longer exist are recognized
+  // without accessing the actor.
+  struct ActorState {
+    Actor* actor = nullptr;
+    // QuicTime::Infinite() if the actor is not scheduled.
+    QuicTime scheduled_time = QuicTime::Infinite();
+    // Sequence number of the actor's event if it is scheduled.
+    uint64_t sequence = 0;
+  };
+
+  // An entry in the schedule.  Unscheduling or rescheduling an actor leaves
+  // its previous event in the schedule, where it is recognized as stale by its
+  // sequence number and skipped.
+  struct Event {
+    // Microseconds since QuicTime::Zero().
+    uint64_t time;
+    uint64_t sequence;
+    size_t actor_index;
+  };
+
+  // Register an actor with the simulator and returns the index of its
+  // scheduling state. Invoked by Actor constructor.
+  size_t AddActor(Actor* actor);
 
   // Unregister an actor with the simulator. Invoked by Actor destructor.
   void RemoveActor(Actor* actor);
@@ -105,6 +142,17 @@ class Simulator : public QuicConnectionHelperInterface {
   // notifies the actor.
   void HandleNextScheduledActor();
 
+  // Adds |event| to the schedule.
+  void PushEvent(Event event);
+
+  // Removes and returns the earliest event in the schedule, which must not be
+  // empty.  Events with the same time are returned in the order in which they
+  // were pushed.
+  Event PopEvent();
+
+  // Returns the bucket of |schedule_| for an event at |time|.
+  size_t BucketFor(uint64_t time) const;
+
   Clock clock_;
   QuicRandom* random_generator_;
   quiche::SimpleBufferAllocator buffer_allocator_;
@@ -125,12 +173,32 @@ class Simulator : public QuicConnectionHelperInterface {
   //   schedule.
   // - An actor is removed from schedule either immediately before Act() is
   //   called or by explicitly calling Unschedule().
-  // - Each Actor appears in the map at most once.
-  std::multimap<QuicTime, Actor*> schedule_;
-  // For each actor, maintain the time it is scheduled at.  The value for
-  // unscheduled actors is QuicTime::Infinite().
-  absl::flat_hash_map<Actor*, QuicTime> scheduled_times_;
+  // - Each Actor has at most one event which is not stale.
+  //
+  // Since events are never scheduled before the current time, the schedule is
+  // a radix heap: bucket 0 holds the events at |last_event_time_|, in the
+  // order of their sequence numbers starting at |first_event_index_|, and
+  // bucket i > 0 holds the events whose time differs from |last_event_time_|
+  // in bit i - 1 and no higher bit.  Scheduling an event takes constant time,
+  // and each event moves to a lower bucket at most 64 times.
+  std::array<std::vector<Event>, 65> schedule_;
+  size_t first_event_index_ = 0;
+  uint64_t last_event_time_ = 0;
+  // Number of events in |schedule_|, including stale ones.
+  size_t num_events_ = 0;
+  uint64_t next_event_sequence_ = 1;
+
+  // Indexed by Actor::scheduler_index_.
+  std::vector<ActorState> actor_states_;
+  // Indices of |actor_states_| not used by any actor.
+  std::vector<size_t> free_actor_indices_;
+  // Number of actors currently scheduled.
+  size_t num_scheduled_actors_ = 0;
   absl::flat_hash_set<std::string> actor_names_;
+  uint64_t num_events_handled_ = 0;
+
+  // Packets available to AllocatePacket().
+  std::vector<std::unique_ptr<Packet>> packet_pool_;
 };
 
 template <class TerminationPredicate>
@@ -138,7 +206,7 @@ bool Simulator::RunUntil(TerminationPredicate termination_predicate) {
   bool predicate_value = false;
   while (true) {
     predicate_value = termination_predicate();
-    if (predicate_value || schedule_.empty()) {
+    if (predicate_value || num_scheduled_actors_ == 0) {
       break;
     }
     HandleNextScheduledActor();
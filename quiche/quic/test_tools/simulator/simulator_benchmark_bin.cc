@@ -0,0 +1,143 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures how fast the Simulator runs a network of many QUIC connections
+// sharing a bottleneck, reporting simulated events per second of wall time.
+// Each flow is a bulk transfer from its own sender, connected to a switch by
+// its own link, to a receiver behind the switch's bottleneck port.
+//
+// Usage: simulator_benchmark [--flows=10,100,1000] [--duration_ms=N]
+
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "quiche/quic/core/quic_bandwidth.h"
+#include "quiche/quic/platform/api/quic_flags.h"
+#include "quiche/quic/test_tools/quic_test_utils.h"
+#include "quiche/quic/test_tools/simulator/link.h"
+#include "quiche/quic/test_tools/simulator/quic_endpoint.h"
+#include "quiche/quic/test_tools/simulator/simulator.h"
+#include "quiche/quic/test_tools/simulator/switch.h"
+#include "quiche/common/platform/api/quiche_command_line_flags.h"
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, flows, "10,100,1000",
+    "Comma-separated list of the numbers of flows to simulate.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, duration_ms, 10000,
+                                "Simulated time per run, in milliseconds.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, bottleneck_mbps, 1000,
+                                "Bandwidth of the shared bottleneck link.");
+
+namespace quic {
+namespace simulator {
+namespace {
+
+void RunBenchmark(int num_flows, QuicTime::Delta duration,
+                  QuicBandwidth bottleneck_bandwidth) {
+  const QuicTime::Delta one_way_delay = QuicTime::Delta::FromMilliseconds(10);
+  const QuicBandwidth access_bandwidth = bottleneck_bandwidth * 2;
+
+  Simulator simulator;
+  std::vector<std::unique_ptr<QuicEndpoint>> senders;
+  std::vector<std::unique_ptr<QuicEndpoint>> receivers;
+  std::vector<QuicEndpointBase*> receiver_pointers;
+  for (int i = 0; i < num_flows; ++i) {
+    const std::string sender_name = absl::StrCat("sender", i);
+    const std::string receiver_name = absl::StrCat("receiver", i);
+    senders.push_back(std::make_unique<QuicEndpoint>(
+        &simulator, sender_name, receiver_name, Perspective::IS_CLIENT,
+        test::TestConnectionId(i)));
+    receivers.push_back(std::make_unique<QuicEndpoint>(
+        &simulator, receiver_name, sender_name, Perspective::IS_SERVER,
+        test::TestConnectionId(i)));
+    receiver_pointers.push_back(receivers.back().get());
+  }
+  QuicEndpointMultiplexer receiver_multiplexer("Receiver multiplexer",
+                                               receiver_pointers);
+
+  const QuicByteCount bdp = bottleneck_bandwidth * (4 * one_way_delay);
+  Switch network_switch(&simulator, "Switch", num_flows + 1, bdp);
+  std::vector<std::unique_ptr<SymmetricLink>> links;
+  links.push_back(std::make_unique<SymmetricLink>(
+      &receiver_multiplexer, network_switch.port(1), bottleneck_bandwidth,
+      one_way_delay));
+  for (int i = 0; i < num_flows; ++i) {
+    links.push_back(std::make_unique<SymmetricLink>(
+        senders[i].get(), network_switch.port(i + 2), access_bandwidth,
+        one_way_delay));
+  }
+
+  // More than can be sent in |duration|, so that every flow stays busy.
+  const QuicByteCount bytes_per_flow =
+      bottleneck_bandwidth.ToBytesPerPeriod(duration) / num_flows * 2;
+  for (auto& sender : senders) {
+    sender->AddBytesToTransfer(bytes_per_flow);
+  }
+
+  const uint64_t events_before = simulator.num_events_handled();
+  const absl::Time start = absl::Now();
+  simulator.RunFor(duration);
+  const double seconds = absl::ToDoubleSeconds(absl::Now() - start);
+  const uint64_t events = simulator.num_events_handled() - events_before;
+
+  QuicByteCount bytes_received = 0;
+  for (auto& receiver : receivers) {
+    bytes_received += receiver->bytes_received();
+  }
+  std::cout << num_flows << " flows: " << events << " events in " << seconds
+            << " s, " << events / seconds << " events/s, "
+            << bytes_received * 8 / (duration.ToMicroseconds() / 1e6) / 1e6
+            << " Mbps goodput" << std::endl;
+}
+
+}  // namespace
+}  // namespace simulator
+}  // namespace quic
+
+int main(int argc, char* argv[]) {
+  const char* usage =
+      "Usage: simulator_benchmark [--flows=10,100,1000] [--duration_ms=N]";
+  std::vector<std::string> args =
+      quiche::QuicheParseCommandLineFlags(usage, argc, argv);
+  if (!args.empty()) {
+    quiche::QuichePrintCommandLineFlagHelp(usage);
+    return 1;
+  }
+
+  std::vector<int> flow_counts;
+  for (absl::string_view flows : absl::StrSplit(
+           quiche::GetQuicheCommandLineFlag(FLAGS_flows), ',')) {
+    int num_flows;
+    if (!absl::SimpleAtoi(flows, &num_flows) || num_flows <= 0) {
+      quiche::QuichePrintCommandLineFlagHelp(usage);
+      return 1;
+    }
+    flow_counts.push_back(num_flows);
+  }
+
+  // Receivers only send acks, so they must not close their connections for
+  // tracking too many packets.
+  SetQuicFlag(FLAGS_quic_max_tracked_packet_count, 1000000);
+
+  const quic::QuicTime::Delta duration =
+      quic::QuicTime::Delta::FromMilliseconds(
+          quiche::GetQuicheCommandLineFlag(FLAGS_duration_ms));
+  const quic::QuicBandwidth bottleneck_bandwidth =
+      quic::QuicBandwidth::FromKBitsPerSecond(
+          quiche::GetQuicheCommandLineFlag(FLAGS_bottleneck_mbps) * 1000);
+  for (int num_flows : flow_counts) {
+    quic::simulator::RunBenchmark(num_flows, duration, bottleneck_bandwidth);
+  }
+  return 0;
+}
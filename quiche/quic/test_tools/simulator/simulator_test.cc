@@ -4,9 +4,13 @@
 
 #include "quiche/quic/test_tools/simulator/simulator.h"
 
+#include <memory>
+#include <string>
 #include <utility>
+#include <vector>
 
 #include "absl/container/node_hash_map.h"
+#include "absl/strings/str_cat.h"
 #include "quiche/quic/platform/api/quic_logging.h"
 #include "quiche/quic/platform/api/quic_test.h"
 #include "quiche/quic/test_tools/quic_test_utils.h"
@@ -67,6 +71,100 @@ TEST_F(SimulatorTest, Counters) {
   }
 }
 
+// An actor which records the order in which actors are called.
+class RecordingActor : public Actor {
+ public:
+  RecordingActor(Simulator* simulator, std::string name,
+                 std::vector<std::string>* log)
+      : Actor(simulator, name), log_(log) {}
+
+  void ScheduleAt(QuicTime time) { Schedule(time); }
+  void Cancel() { Unschedule(); }
+
+  void Act() override { log_->push_back(name_); }
+
+ private:
+  std::vector<std::string>* log_;
+};
+
+// Test that actors scheduled for the same time are called in the order in
+// which they were scheduled, and that rescheduling and unscheduling an actor
+// is reflected in the order.
+TEST_F(SimulatorTest, EventOrder) {
+  Simulator simulator;
+  std::vector<std::string> log;
+  RecordingActor a(&simulator, "a", &log);
+  RecordingActor b(&simulator, "b", &log);
+  RecordingActor c(&simulator, "c", &log);
+  RecordingActor d(&simulator, "d", &log);
+  const QuicTime start = simulator.GetClock()->Now();
+  const QuicTime::Delta ms = QuicTime::Delta::FromMilliseconds(1);
+
+  c.ScheduleAt(start + 2 * ms);
+  a.ScheduleAt(start + 2 * ms);
+  d.ScheduleAt(start + 1000 * ms);
+  b.ScheduleAt(start + 1000 * ms);
+  // Scheduling for a later time does nothing.
+  a.ScheduleAt(start + 5 * ms);
+  // Scheduling for an earlier time moves b ahead of c and a.
+  b.ScheduleAt(start + 2 * ms);
+  b.ScheduleAt(start + ms);
+  d.Cancel();
+  simulator.RunUntil([]() { return false; });
+  EXPECT_EQ((std::vector<std::string>{"b", "c", "a"}), log);
+  EXPECT_EQ(start + 2 * ms, simulator.GetClock()->Now());
+  EXPECT_EQ(3u, simulator.num_events_handled());
+
+  // Actors destroyed while scheduled are never called.
+  log.clear();
+  {
+    RecordingActor e(&simulator, "e", &log);
+    e.ScheduleAt(start + 3 * ms);
+  }
+  RecordingActor f(&simulator, "f", &log);
+  f.ScheduleAt(start + 4 * ms);
+  simulator.RunUntil([]() { return false; });
+  EXPECT_EQ((std::vector<std::string>{"f"}), log);
+}
+
+// Test that the schedule works with many actors at widely different periods.
+TEST_F(SimulatorTest, ManyCounters) {
+  Simulator simulator;
+  std::vector<std::unique_ptr<Counter>> counters;
+  for (int i = 1; i <= 1000; ++i) {
+    counters.push_back(std::make_unique<Counter>(
+        &simulator, absl::StrCat("counter", i),
+        QuicTime::Delta::FromMicroseconds(i * i)));
+  }
+  simulator.RunFor(QuicTime::Delta::FromSeconds(1));
+  // The counters which would act at exactly one second are scheduled after the
+  // alarm that ends RunFor(), and so do not act.
+  for (int i = 1; i <= 1000; ++i) {
+    EXPECT_EQ((1000 * 1000 - 1) / (i * i), counters[i - 1]->get_value()) << i;
+  }
+}
+
+TEST_F(SimulatorTest, PacketPool) {
+  Simulator simulator;
+  std::unique_ptr<Packet> packet = simulator.AllocatePacket();
+  packet->source = "source";
+  packet->destination = "destination";
+  packet->contents = std::string(1000, 'a');
+  packet->size = 1000;
+  const Packet* const raw_packet = packet.get();
+  simulator.ReleasePacket(std::move(packet));
+
+  packet = simulator.AllocatePacket();
+  EXPECT_EQ(raw_packet, packet.get());
+  EXPECT_TRUE(packet->source.empty());
+  EXPECT_TRUE(packet->destination.empty());
+  EXPECT_TRUE(packet->contents.empty());
+  EXPECT_LE(1000u, packet->contents.capacity());
+  EXPECT_EQ(0u, packet->size);
+
+  EXPECT_NE(raw_packet, simulator.AllocatePacket().get());
+}
+
 // A port which counts the number of packets received on it, both total and
 // per-destination.
 class CounterPort : public UnconstrainedPortInterface {
@@ -64,6 +64,12 @@ void TestTicketCrypter::Decrypt(
   }
 }
 
+bool TestTicketCrypter::ShouldAcceptEarlyData(
+    absl::string_view /*ticket*/) {
+  ++num_early_data_checks_;
+  return !reject_early_data_;
+}
+
 void TestTicketCrypter::SetRunCallbacksAsync(bool run_async) {
   run_async_ = run_async;
 }
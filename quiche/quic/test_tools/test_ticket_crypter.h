@@ -23,6 +23,7 @@ class TestTicketCrypter : public ProofSource::TicketCrypter {
                                absl::string_view encryption_key) override;
   void Decrypt(absl::string_view in,
                std::shared_ptr<ProofSource::DecryptCallback> callback) override;
+  bool ShouldAcceptEarlyData(absl::string_view ticket) override;
 
   void SetRunCallbacksAsync(bool run_async);
   size_t NumPendingCallbacks();
@@ -31,6 +32,15 @@ class TestTicketCrypter : public ProofSource::TicketCrypter {
   // Allows configuring this TestTicketCrypter to fail decryption.
   void set_fail_decrypt(bool fail_decrypt) { fail_decrypt_ = fail_decrypt; }
 
+  // Allows configuring this TestTicketCrypter to reject all early data as
+  // replayed.
+  void set_reject_early_data(bool reject_early_data) {
+    reject_early_data_ = reject_early_data;
+  }
+
+  // Number of calls to ShouldAcceptEarlyData.
+  size_t num_early_data_checks() const { return num_early_data_checks_; }
+
  private:
   // Performs the Decrypt operation synchronously.
   std::vector<uint8_t> Decrypt(absl::string_view in);
@@ -41,6 +51,8 @@ class TestTicketCrypter : public ProofSource::TicketCrypter {
   };
 
   bool fail_decrypt_ = false;
+  bool reject_early_data_ = false;
+  size_t num_early_data_checks_ = 0;
   bool run_async_ = false;
   std::vector<PendingCallback> pending_callbacks_;
   std::vector<uint8_t> ticket_prefix_;
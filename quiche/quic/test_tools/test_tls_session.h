@@ -0,0 +1,20 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TEST_TOOLS_TEST_TLS_SESSION_H_
+#define QUICHE_QUIC_TEST_TOOLS_TEST_TLS_SESSION_H_
+
+#include "openssl/ssl.h"
+
+namespace quic {
+namespace test {
+
+// Returns a 0-RTT capable TLS 1.3 session received by a client, parsed with
+// |ctx|. Tests of session caches usually reset its time and timeout.
+bssl::UniquePtr<SSL_SESSION> MakeTestTlsSession(const SSL_CTX* ctx);
+
+}  // namespace test
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TEST_TOOLS_TEST_TLS_SESSION_H_
@@ -0,0 +1,456 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/persistent_session_cache.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <cstring>
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "openssl/mem.h"
+#include "quiche/quic/core/crypto/transport_parameters.h"
+#include "quiche/quic/core/quic_data_reader.h"
+#include "quiche/quic/core/quic_data_writer.h"
+#include "quiche/quic/core/quic_utils.h"
+#include "quiche/quic/core/quic_versions.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// Identifies an initialized file, and changes with its layout.
+constexpr uint64_t kFileMagic = UINT64_C(0x5153455353303031);
+
+// Size reserved for the FileHeader at the start of the file.
+constexpr size_t kFileHeaderSize = 64;
+
+struct FileHeader {
+  uint64_t magic;
+  uint64_t num_slots;
+  uint64_t slot_size;
+};
+
+// Each slot starts with a SlotHeader, followed by |payload_length| bytes of
+// payload. The checksum detects slots which were being written when the
+// process died.
+struct SlotHeader {
+  uint32_t payload_length;
+  uint32_t reserved;
+  uint64_t checksum;
+};
+
+// Values of Record::flags.
+constexpr uint8_t kPrivacyModeEnabled = 1 << 0;
+constexpr uint8_t kHasApplicationState = 1 << 1;
+// The serialized transport parameters have placeholder legacy version
+// information, see SerializeServerParams.
+constexpr uint8_t kAddedLegacyVersionInformation = 1 << 2;
+
+// The payload of a slot.
+struct Record {
+  bool Matches(const QuicServerId& server_id) const {
+    return host == server_id.host() && port == server_id.port() &&
+           ((flags & kPrivacyModeEnabled) != 0) ==
+               server_id.privacy_mode_enabled();
+  }
+
+  // Leads the payload so that RemoveExpiredEntries only reads it.
+  uint64_t expiry_unix_seconds = 0;
+  std::string host;
+  uint16_t port = 0;
+  uint8_t flags = 0;
+  std::string session;
+  std::string params;
+  std::string application_state;
+  std::string token;
+};
+
+bool SerializeRecord(const Record& record, size_t max_size,
+                     std::string* payload) {
+  std::string buffer(max_size, '\0');
+  QuicDataWriter writer(buffer.size(), buffer.data());
+  if (!writer.WriteUInt64(record.expiry_unix_seconds) ||
+      !writer.WriteStringPieceVarInt62(record.host) ||
+      !writer.WriteUInt16(record.port) || !writer.WriteUInt8(record.flags) ||
+      !writer.WriteStringPieceVarInt62(record.session) ||
+      !writer.WriteStringPieceVarInt62(record.params) ||
+      !writer.WriteStringPieceVarInt62(record.application_state) ||
+      !writer.WriteStringPieceVarInt62(record.token)) {
+    return false;
+  }
+  buffer.resize(writer.length());
+  *payload = std::move(buffer);
+  return true;
+}
+
+bool ParseRecord(absl::string_view payload, Record* record) {
+  QuicDataReader reader(payload);
+  absl::string_view host, session, params, application_state, token;
+  if (!reader.ReadUInt64(&record->expiry_unix_seconds) ||
+      !reader.ReadStringPieceVarInt62(&host) ||
+      !reader.ReadUInt16(&record->port) || !reader.ReadUInt8(&record->flags) ||
+      !reader.ReadStringPieceVarInt62(&session) ||
+      !reader.ReadStringPieceVarInt62(&params) ||
+      !reader.ReadStringPieceVarInt62(&application_state) ||
+      !reader.ReadStringPieceVarInt62(&token) || !reader.IsDoneReading()) {
+    return false;
+  }
+  record->host = std::string(host);
+  record->session = std::string(session);
+  record->params = std::string(params);
+  record->application_state = std::string(application_state);
+  record->token = std::string(token);
+  return true;
+}
+
+void RemoveGreaseParameters(TransportParameters* params) {
+  std::vector<TransportParameters::TransportParameterId> grease_ids;
+  for (const auto& kv : params->custom_parameters) {
+    // See the "Reserved Transport Parameters" section of RFC 9000.
+    if (kv.first % 31 == 27) {
+      grease_ids.push_back(kv.first);
+    }
+  }
+  for (TransportParameters::TransportParameterId id : grease_ids) {
+    params->custom_parameters.erase(id);
+  }
+}
+
+// SerializeTransportParameters refuses parameters without legacy version
+// information or with GREASE custom parameters, which the parameters received
+// from a server may lack or have. Serializes a copy of |params| with
+// placeholder version information, which ParseServerParams removes, and
+// without the GREASE parameters.
+bool SerializeServerParams(const TransportParameters& params,
+                           std::string* out, uint8_t* flags) {
+  TransportParameters copy(params);
+  if (!copy.legacy_version_information.has_value()) {
+    TransportParameters::LegacyVersionInformation legacy_version_information;
+    legacy_version_information.version =
+        CreateQuicVersionLabel(ParsedQuicVersion::RFCv1());
+    legacy_version_information.supported_versions.push_back(
+        legacy_version_information.version);
+    copy.legacy_version_information = legacy_version_information;
+    *flags |= kAddedLegacyVersionInformation;
+  }
+  RemoveGreaseParameters(&copy);
+  std::vector<uint8_t> bytes;
+  if (!SerializeTransportParameters(copy, &bytes)) {
+    return false;
+  }
+  out->assign(reinterpret_cast<const char*>(bytes.data()), bytes.size());
+  return true;
+}
+
+bool ParseServerParams(const Record& record, TransportParameters* params) {
+  std::string error_details;
+  // The version only matters for the validation of connection IDs, whose
+  // length limits are the same in all the IETF versions.
+  if (!ParseTransportParameters(
+          ParsedQuicVersion::RFCv1(), Perspective::IS_SERVER,
+          reinterpret_cast<const uint8_t*>(record.params.data()),
+          record.params.size(), params, &error_details)) {
+    QUIC_DLOG(ERROR) << "Failed to parse stored transport parameters: "
+                     << error_details;
+    return false;
+  }
+  if (record.flags & kAddedLegacyVersionInformation) {
+    params->legacy_version_information.reset();
+  }
+  RemoveGreaseParameters(params);
+  return true;
+}
+
+// Holds a flock(2) lock on |fd| until it is closed. Returns false if another
+// process holds one.
+bool LockFile(int fd) {
+  while (flock(fd, LOCK_EX | LOCK_NB) != 0) {
+    if (errno != EINTR) {
+      return false;
+    }
+  }
+  return true;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<PersistentSessionCache> PersistentSessionCache::Create(
+    const std::string& path, const Options& options,
+    std::unique_ptr<SessionCache> cache) {
+  static_assert(sizeof(FileHeader) <= kFileHeaderSize,
+                "FileHeader overlaps the first slot");
+  if (options.num_slots == 0 || options.slot_size <= sizeof(SlotHeader) ||
+      options.slot_size % sizeof(uint64_t) != 0) {
+    QUIC_LOG(ERROR) << "Invalid options for " << path;
+    return nullptr;
+  }
+  const size_t mapping_size =
+      kFileHeaderSize + options.num_slots * options.slot_size;
+
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    QUIC_LOG(ERROR) << "Failed to open " << path << ": " << strerror(errno);
+    return nullptr;
+  }
+  if (!LockFile(fd)) {
+    QUIC_LOG(ERROR) << path << " is used by another process";
+    close(fd);
+    return nullptr;
+  }
+
+  void* mapping = MAP_FAILED;
+  struct stat file_stat;
+  if (fstat(fd, &file_stat) != 0) {
+    QUIC_LOG(ERROR) << "Failed to stat " << path << ": " << strerror(errno);
+  } else if (file_stat.st_size == 0 && ftruncate(fd, mapping_size) != 0) {
+    QUIC_LOG(ERROR) << "Failed to resize " << path << ": " << strerror(errno);
+  } else if (file_stat.st_size != 0 &&
+             static_cast<size_t>(file_stat.st_size) != mapping_size) {
+    QUIC_LOG(ERROR) << path << " has " << file_stat.st_size
+                    << " bytes instead of " << mapping_size
+                    << ", it is used with different options";
+  } else {
+    mapping =
+        mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    if (mapping == MAP_FAILED) {
+      QUIC_LOG(ERROR) << "Failed to map " << path << ": " << strerror(errno);
+    }
+  }
+
+  if (mapping != MAP_FAILED) {
+    auto* header = static_cast<FileHeader*>(mapping);
+    if (header->magic != kFileMagic) {
+      // A new file, which ftruncate zero-filled, so all the slots are empty.
+      header->num_slots = options.num_slots;
+      header->slot_size = options.slot_size;
+      header->magic = kFileMagic;
+    } else if (header->num_slots != options.num_slots ||
+               header->slot_size != options.slot_size) {
+      QUIC_LOG(ERROR) << path << " is used with different options";
+      munmap(mapping, mapping_size);
+      mapping = MAP_FAILED;
+    }
+  }
+
+  if (mapping == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  return std::unique_ptr<PersistentSessionCache>(new PersistentSessionCache(
+      fd, mapping, mapping_size, options, std::move(cache)));
+}
+
+PersistentSessionCache::PersistentSessionCache(
+    int fd, void* mapping, size_t mapping_size, const Options& options,
+    std::unique_ptr<SessionCache> cache)
+    : fd_(fd),
+      mapping_(mapping),
+      mapping_size_(mapping_size),
+      num_slots_(options.num_slots),
+      slot_size_(options.slot_size),
+      cache_(std::move(cache)) {}
+
+PersistentSessionCache::~PersistentSessionCache() {
+  munmap(mapping_, mapping_size_);
+  close(fd_);
+}
+
+void PersistentSessionCache::Insert(const QuicServerId& server_id,
+                                    bssl::UniquePtr<SSL_SESSION> session,
+                                    const TransportParameters& params,
+                                    const ApplicationState* application_state) {
+  QUICHE_DCHECK(session);
+  Record record;
+  record.expiry_unix_seconds = SSL_SESSION_get_time(session.get()) +
+                               SSL_SESSION_get_timeout(session.get());
+  record.host = server_id.host();
+  record.port = server_id.port();
+  if (server_id.privacy_mode_enabled()) {
+    record.flags |= kPrivacyModeEnabled;
+  }
+  if (application_state != nullptr) {
+    record.flags |= kHasApplicationState;
+    record.application_state.assign(application_state->begin(),
+                                    application_state->end());
+  }
+  uint8_t* session_bytes = nullptr;
+  size_t session_length = 0;
+  const bool serialized =
+      SSL_SESSION_to_bytes(session.get(), &session_bytes, &session_length) &&
+      SerializeServerParams(params, &record.params, &record.flags);
+  if (session_bytes != nullptr) {
+    record.session.assign(reinterpret_cast<const char*>(session_bytes),
+                          session_length);
+    OPENSSL_free(session_bytes);
+  }
+
+  const size_t slot = SlotIndex(server_id);
+  QuicWriterMutexLock lock(SlotMutex(slot));
+  Record stored;
+  const bool has_stored = ParseRecord(SlotPayload(slot), &stored) &&
+                          stored.Matches(server_id);
+  if (has_stored) {
+    // Keep the token, which arrives independently of the sessions.
+    record.token = std::move(stored.token);
+  }
+  std::string payload;
+  if (serialized &&
+      SerializeRecord(record, slot_size_ - sizeof(SlotHeader), &payload)) {
+    WriteSlot(slot, payload);
+  } else if (has_stored) {
+    // Do not leave an older session behind.
+    ClearSlot(slot);
+  }
+  cache_->Insert(server_id, std::move(session), params, application_state);
+}
+
+std::unique_ptr<QuicResumptionState> PersistentSessionCache::Lookup(
+    const QuicServerId& server_id, QuicWallTime now, const SSL_CTX* ctx) {
+  const size_t slot = SlotIndex(server_id);
+  QuicWriterMutexLock lock(SlotMutex(slot));
+  std::unique_ptr<QuicResumptionState> state =
+      cache_->Lookup(server_id, now, ctx);
+  Record record;
+  if (!ParseRecord(SlotPayload(slot), &record) || !record.Matches(server_id)) {
+    return state;
+  }
+  ClearSlot(slot);
+  if (state != nullptr || ctx == nullptr) {
+    return state;
+  }
+
+  // The session was inserted before the process restarted. Let the wrapped
+  // cache check that it is still valid.
+  bssl::UniquePtr<SSL_SESSION> session(SSL_SESSION_from_bytes(
+      reinterpret_cast<const uint8_t*>(record.session.data()),
+      record.session.size(), ctx));
+  TransportParameters params;
+  if (session == nullptr || !ParseServerParams(record, &params)) {
+    QUIC_DLOG(INFO) << "Failed to restore TLS session for host: "
+                    << server_id.host();
+    return nullptr;
+  }
+  ApplicationState application_state(record.application_state.begin(),
+                                     record.application_state.end());
+  cache_->Insert(
+      server_id, std::move(session), params,
+      (record.flags & kHasApplicationState) ? &application_state : nullptr);
+  cache_->OnNewTokenReceived(server_id, record.token);
+  return cache_->Lookup(server_id, now, ctx);
+}
+
+void PersistentSessionCache::ClearEarlyData(const QuicServerId& server_id) {
+  const size_t slot = SlotIndex(server_id);
+  QuicWriterMutexLock lock(SlotMutex(slot));
+  cache_->ClearEarlyData(server_id);
+  // The stored session can not be modified without an SSL_CTX to parse it.
+  Record record;
+  if (ParseRecord(SlotPayload(slot), &record) && record.Matches(server_id)) {
+    ClearSlot(slot);
+  }
+}
+
+void PersistentSessionCache::OnNewTokenReceived(const QuicServerId& server_id,
+                                                absl::string_view token) {
+  const size_t slot = SlotIndex(server_id);
+  QuicWriterMutexLock lock(SlotMutex(slot));
+  cache_->OnNewTokenReceived(server_id, token);
+  if (token.empty()) {
+    return;
+  }
+  Record record;
+  if (!ParseRecord(SlotPayload(slot), &record) || !record.Matches(server_id)) {
+    return;
+  }
+  record.token = std::string(token);
+  std::string payload;
+  if (SerializeRecord(record, slot_size_ - sizeof(SlotHeader), &payload)) {
+    WriteSlot(slot, payload);
+  }
+}
+
+void PersistentSessionCache::RemoveExpiredEntries(QuicWallTime now) {
+  cache_->RemoveExpiredEntries(now);
+  for (size_t slot = 0; slot < num_slots_; ++slot) {
+    QuicWriterMutexLock lock(SlotMutex(slot));
+    QuicDataReader reader(SlotPayload(slot));
+    uint64_t expiry_unix_seconds;
+    if (reader.ReadUInt64(&expiry_unix_seconds) &&
+        now.ToUNIXSeconds() >= expiry_unix_seconds) {
+      ClearSlot(slot);
+    }
+  }
+}
+
+void PersistentSessionCache::Clear() {
+  cache_->Clear();
+  for (size_t slot = 0; slot < num_slots_; ++slot) {
+    QuicWriterMutexLock lock(SlotMutex(slot));
+    ClearSlot(slot);
+  }
+}
+
+size_t PersistentSessionCache::SlotIndex(const QuicServerId& server_id) const {
+  // QuicServerIdHash is not stable across processes.
+  return QuicUtils::FNV1a_64_Hash(absl::StrCat(
+             server_id.host(), ":", server_id.port(),
+             server_id.privacy_mode_enabled() ? "/private" : "")) %
+         num_slots_;
+}
+
+QuicMutex* PersistentSessionCache::SlotMutex(size_t slot) {
+  return &slot_mutexes_[slot % kNumSlotMutexes];
+}
+
+char* PersistentSessionCache::Slot(size_t slot) const {
+  QUICHE_DCHECK_LT(slot, num_slots_);
+  return static_cast<char*>(mapping_) + kFileHeaderSize + slot * slot_size_;
+}
+
+void PersistentSessionCache::WriteSlot(size_t slot,
+                                       absl::string_view payload) {
+  if (payload.empty() || payload.size() > slot_size_ - sizeof(SlotHeader)) {
+    ClearSlot(slot);
+    return;
+  }
+  SlotHeader header;
+  header.payload_length = payload.size();
+  header.reserved = 0;
+  header.checksum = QuicUtils::FNV1a_64_Hash(payload);
+  char* data = Slot(slot);
+  memcpy(data + sizeof(SlotHeader), payload.data(), payload.size());
+  memcpy(data, &header, sizeof(header));
+}
+
+void PersistentSessionCache::ClearSlot(size_t slot) {
+  memset(Slot(slot), 0, sizeof(SlotHeader));
+}
+
+absl::string_view PersistentSessionCache::SlotPayload(size_t slot) const {
+  const char* data = Slot(slot);
+  SlotHeader header;
+  memcpy(&header, data, sizeof(header));
+  if (header.payload_length == 0 ||
+      header.payload_length > slot_size_ - sizeof(SlotHeader)) {
+    return absl::string_view();
+  }
+  absl::string_view payload(data + sizeof(SlotHeader), header.payload_length);
+  if (QuicUtils::FNV1a_64_Hash(payload) != header.checksum) {
+    return absl::string_view();
+  }
+  return payload;
+}
+
+}  // namespace quic
@@ -0,0 +1,106 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_PERSISTENT_SESSION_CACHE_H_
+#define QUICHE_QUIC_TOOLS_PERSISTENT_SESSION_CACHE_H_
+
+#include <cstddef>
+#include <memory>
+#include <string>
+
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/crypto/quic_crypto_client_config.h"
+#include "quiche/quic/core/quic_server_id.h"
+#include "quiche/quic/platform/api/quic_mutex.h"
+
+namespace quic {
+
+// PersistentSessionCache is a SessionCache which keeps a copy of the latest
+// session inserted for each server ID in a memory mapped file, so that a
+// client which restarts can resume sessions, and send early data, on its first
+// connection to each server.
+//
+// Lookups go to the wrapped cache first. When it has nothing for a server ID,
+// which is the case after a restart, the session stored in the file is parsed
+// with the SSL_CTX passed to Lookup, inserted into the wrapped cache and
+// returned from there. Either way the file copy is then dropped, so that a
+// session ticket is not used again after another restart.
+//
+// The file is divided into fixed size slots indexed by a hash of the server
+// ID; a server ID whose slot is taken by another one replaces it. Sessions
+// which do not fit in a slot, e.g. because of a long certificate chain, are
+// only kept in memory.
+//
+// PersistentSessionCache is thread safe if the wrapped cache is, e.g. a
+// ShardedQuicClientSessionCache. Only one process can use a file at a time.
+class QUIC_NO_EXPORT PersistentSessionCache : public SessionCache {
+ public:
+  struct QUIC_NO_EXPORT Options {
+    size_t num_slots = 1024;
+    // Sessions from QUICHE servers are usually 3 to 4 KB, most of which is
+    // the server's certificate chain.
+    size_t slot_size = 8192;
+  };
+
+  // Maps the file at |path|, creating it if needed, in front of |cache|. A
+  // file must always be used with the same |options|. Returns nullptr on
+  // failure, including if another process uses the file.
+  static std::unique_ptr<PersistentSessionCache> Create(
+      const std::string& path, const Options& options,
+      std::unique_ptr<SessionCache> cache);
+
+  ~PersistentSessionCache() override;
+
+  void Insert(const QuicServerId& server_id,
+              bssl::UniquePtr<SSL_SESSION> session,
+              const TransportParameters& params,
+              const ApplicationState* application_state) override;
+
+  std::unique_ptr<QuicResumptionState> Lookup(const QuicServerId& server_id,
+                                              QuicWallTime now,
+                                              const SSL_CTX* ctx) override;
+
+  void ClearEarlyData(const QuicServerId& server_id) override;
+
+  void OnNewTokenReceived(const QuicServerId& server_id,
+                          absl::string_view token) override;
+
+  void RemoveExpiredEntries(QuicWallTime now) override;
+
+  void Clear() override;
+
+  SessionCache* cache() { return cache_.get(); }
+
+ private:
+  // Number of locks protecting the slots; slot i is protected by
+  // slot_mutexes_[i % kNumSlotMutexes].
+  static constexpr size_t kNumSlotMutexes = 64;
+
+  PersistentSessionCache(int fd, void* mapping, size_t mapping_size,
+                         const Options& options,
+                         std::unique_ptr<SessionCache> cache);
+
+  size_t SlotIndex(const QuicServerId& server_id) const;
+  QuicMutex* SlotMutex(size_t slot);
+  char* Slot(size_t slot) const;
+
+  // Stores |payload| in |slot|, or empties the slot if it does not fit.
+  void WriteSlot(size_t slot, absl::string_view payload);
+  void ClearSlot(size_t slot);
+  // Returns the payload stored in |slot|, or an empty string if the slot is
+  // empty or corrupted.
+  absl::string_view SlotPayload(size_t slot) const;
+
+  const int fd_;
+  void* const mapping_;
+  const size_t mapping_size_;
+  const size_t num_slots_;
+  const size_t slot_size_;
+  std::unique_ptr<SessionCache> cache_;
+  QuicMutex slot_mutexes_[kNumSlotMutexes];
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_PERSISTENT_SESSION_CACHE_H_
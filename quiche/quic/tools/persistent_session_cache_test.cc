@@ -0,0 +1,220 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/persistent_session_cache.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/core/crypto/sharded_quic_client_session_cache.h"
+#include "quiche/quic/core/quic_versions.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+#include "quiche/quic/test_tools/test_tls_session.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+const QuicTime::Delta kTimeout = QuicTime::Delta::FromSeconds(1000);
+
+class PersistentSessionCacheTest : public QuicTest {
+ public:
+  PersistentSessionCacheTest()
+      : path_(absl::StrCat(
+            ::testing::TempDir(), "/persistent_session_cache_",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())),
+        ssl_ctx_(SSL_CTX_new(TLS_method())),
+        server_id_("test.example.com", 443),
+        application_state_({1, 2, 3}) {
+    unlink(path_.c_str());
+    clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1000));
+    options_.num_slots = 16;
+
+    params_.perspective = Perspective::IS_SERVER;
+    params_.max_idle_timeout_ms.set_value(30000);
+    params_.initial_max_data.set_value(1000000);
+    params_.initial_max_streams_bidi.set_value(100);
+    params_.custom_parameters[static_cast<
+        TransportParameters::TransportParameterId>(0xffcd)] = "foo";
+  }
+
+  ~PersistentSessionCacheTest() override { unlink(path_.c_str()); }
+
+ protected:
+  // Creates a cache over the file, as the client does when it starts.
+  std::unique_ptr<PersistentSessionCache> CreateCache() {
+    return PersistentSessionCache::Create(
+        path_, options_, std::make_unique<ShardedQuicClientSessionCache>());
+  }
+
+  bssl::UniquePtr<SSL_SESSION> MakeTestSession(
+      QuicTime::Delta timeout = kTimeout) {
+    bssl::UniquePtr<SSL_SESSION> session = MakeTestTlsSession(ssl_ctx_.get());
+    SSL_SESSION_set_time(session.get(), clock_.WallNow().ToUNIXSeconds());
+    SSL_SESSION_set_timeout(session.get(), timeout.ToSeconds());
+    return session;
+  }
+
+  std::unique_ptr<QuicResumptionState> Lookup(PersistentSessionCache* cache) {
+    return cache->Lookup(server_id_, clock_.WallNow(), ssl_ctx_.get());
+  }
+
+  const std::string path_;
+  PersistentSessionCache::Options options_;
+  bssl::UniquePtr<SSL_CTX> ssl_ctx_;
+  MockClock clock_;
+  const QuicServerId server_id_;
+  TransportParameters params_;
+  const ApplicationState application_state_;
+};
+
+TEST_F(PersistentSessionCacheTest, SessionSurvivesRestart) {
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, &application_state_);
+  }
+
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  std::unique_ptr<QuicResumptionState> state = Lookup(cache.get());
+  ASSERT_NE(nullptr, state);
+  EXPECT_NE(nullptr, state->tls_session);
+  EXPECT_TRUE(SSL_SESSION_early_data_capable(state->tls_session.get()));
+  ASSERT_NE(nullptr, state->transport_params);
+  EXPECT_EQ(params_, *state->transport_params);
+  ASSERT_NE(nullptr, state->application_state);
+  EXPECT_EQ(application_state_, *state->application_state);
+  // The session is used once.
+  EXPECT_EQ(nullptr, Lookup(cache.get()));
+}
+
+TEST_F(PersistentSessionCacheTest, LegacyVersionInformation) {
+  TransportParameters::LegacyVersionInformation legacy_version_information;
+  legacy_version_information.version =
+      CreateQuicVersionLabel(ParsedQuicVersion::Q050());
+  legacy_version_information.supported_versions.push_back(
+      legacy_version_information.version);
+  params_.legacy_version_information = legacy_version_information;
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+  }
+
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  std::unique_ptr<QuicResumptionState> state = Lookup(cache.get());
+  ASSERT_NE(nullptr, state);
+  EXPECT_EQ(params_, *state->transport_params);
+  EXPECT_EQ(nullptr, state->application_state);
+}
+
+TEST_F(PersistentSessionCacheTest, StoredSessionIsUsedOnce) {
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+    // Resuming the session in this process drops the stored copy as well.
+    EXPECT_NE(nullptr, Lookup(cache.get()));
+  }
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ(nullptr, Lookup(cache.get()));
+}
+
+TEST_F(PersistentSessionCacheTest, TokenSurvivesRestart) {
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+    cache->OnNewTokenReceived(server_id_, "token");
+    // A later session keeps the token.
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+  }
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  std::unique_ptr<QuicResumptionState> state = Lookup(cache.get());
+  ASSERT_NE(nullptr, state);
+  EXPECT_EQ("token", state->token);
+}
+
+TEST_F(PersistentSessionCacheTest, ClearEarlyData) {
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+    cache->ClearEarlyData(server_id_);
+  }
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ(nullptr, Lookup(cache.get()));
+}
+
+TEST_F(PersistentSessionCacheTest, RemoveExpiredEntries) {
+  const QuicServerId other_server_id("www.example.org", 443);
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+    cache->Insert(other_server_id, MakeTestSession(3 * kTimeout), params_,
+                  nullptr);
+    clock_.AdvanceTime(2 * kTimeout);
+    cache->RemoveExpiredEntries(clock_.WallNow());
+  }
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ(nullptr, Lookup(cache.get()));
+  EXPECT_NE(nullptr, cache->Lookup(other_server_id, clock_.WallNow(),
+                                   ssl_ctx_.get()));
+}
+
+TEST_F(PersistentSessionCacheTest, ExpiredAfterRestart) {
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+  }
+  clock_.AdvanceTime(2 * kTimeout);
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ(nullptr, Lookup(cache.get()));
+}
+
+TEST_F(PersistentSessionCacheTest, SessionTooLargeForSlot) {
+  options_.slot_size = 1024;
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+    cache->Insert(server_id_, MakeTestSession(), params_, nullptr);
+    // Still cached in memory.
+    EXPECT_NE(nullptr, Lookup(cache.get()));
+  }
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ(nullptr, Lookup(cache.get()));
+}
+
+TEST_F(PersistentSessionCacheTest, OneProcessAtATime) {
+  std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+  ASSERT_NE(nullptr, cache);
+  EXPECT_EQ(nullptr, CreateCache());
+}
+
+TEST_F(PersistentSessionCacheTest, MismatchedOptions) {
+  {
+    std::unique_ptr<PersistentSessionCache> cache = CreateCache();
+    ASSERT_NE(nullptr, cache);
+  }
+  options_.num_slots *= 2;
+  EXPECT_EQ(nullptr, CreateCache());
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -0,0 +1,116 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// Measures the CPU cost of extracting the SNI and ALPN from a client's first
+// flight with TlsChloExtractor, as QuicDispatcher does for each new
+// connection, both with a BoringSSL SSL object and with TlsClientHelloParser
+// (--quic_reloadable_flag_quic_parse_chlo_without_ssl).  The cost includes
+// removing header protection and decrypting the Initial packets.
+//
+// The first flight is generated once by a test client.  With --large_chlo,
+// the ClientHello carries a 2000 byte transport parameter, so that it spans
+// two Initial packets.
+//
+// Reported for each run and each parser: CHLOs per second and CPU time per
+// CHLO.
+//
+// Usage: quic_chlo_extractor_benchmark [--num_chlos=N] [--iterations=N]
+//                                      [--large_chlo]
+
+#include <ctime>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/time/clock.h"
+#include "absl/time/time.h"
+#include "quiche/quic/core/crypto/transport_parameters.h"
+#include "quiche/quic/core/quic_config.h"
+#include "quiche/quic/core/quic_packets.h"
+#include "quiche/quic/core/quic_versions.h"
+#include "quiche/quic/core/tls_chlo_extractor.h"
+#include "quiche/quic/platform/api/quic_flags.h"
+#include "quiche/quic/test_tools/first_flight.h"
+#include "quiche/common/platform/api/quiche_command_line_flags.h"
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, num_chlos, 100000,
+                                "Number of CHLOs parsed in each run.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, iterations, 3, "Number of runs.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    bool, large_chlo, false,
+    "If true, the CHLO is large enough to span two Initial packets.");
+
+namespace quic {
+namespace {
+
+void RunBenchmark(
+    const ParsedQuicVersion& version,
+    const std::vector<std::unique_ptr<QuicReceivedPacket>>& packets,
+    int num_chlos, bool without_ssl) {
+  SetQuicReloadableFlag(quic_parse_chlo_without_ssl, without_ssl);
+
+  const absl::Time wall_start = absl::Now();
+  const std::clock_t cpu_start = std::clock();
+  int num_parsed = 0;
+  for (int i = 0; i < num_chlos; ++i) {
+    TlsChloExtractor extractor;
+    for (const std::unique_ptr<QuicReceivedPacket>& packet : packets) {
+      extractor.IngestPacket(version, *packet);
+    }
+    if (extractor.HasParsedFullChlo()) {
+      ++num_parsed;
+    }
+  }
+  const double seconds = absl::ToDoubleSeconds(absl::Now() - wall_start);
+  const double cpu_seconds =
+      static_cast<double>(std::clock() - cpu_start) / CLOCKS_PER_SEC;
+
+  if (num_parsed != num_chlos) {
+    std::cout << "Only " << num_parsed << " of " << num_chlos
+              << " CHLOs parsed" << std::endl;
+  }
+  std::cout << (without_ssl ? "TlsClientHelloParser" : "BoringSSL") << ": "
+            << num_chlos / seconds << " CHLOs/s, "
+            << cpu_seconds * 1e6 / num_chlos << " CPU-us/CHLO" << std::endl;
+}
+
+}  // namespace
+}  // namespace quic
+
+int main(int argc, char* argv[]) {
+  const char* usage =
+      "Usage: quic_chlo_extractor_benchmark [--num_chlos=N] [--iterations=N] "
+      "[--large_chlo]";
+  std::vector<std::string> args =
+      quiche::QuicheParseCommandLineFlags(usage, argc, argv);
+  const int num_chlos = quiche::GetQuicheCommandLineFlag(FLAGS_num_chlos);
+  if (!args.empty() || num_chlos <= 0) {
+    quiche::QuichePrintCommandLineFlagHelp(usage);
+    return 1;
+  }
+
+  const quic::ParsedQuicVersion version =
+      quic::CurrentSupportedHttp3Versions().front();
+  quic::QuicConfig config;
+  if (quiche::GetQuicheCommandLineFlag(FLAGS_large_chlo)) {
+    constexpr auto kCustomParameterId =
+        static_cast<quic::TransportParameters::TransportParameterId>(0xff33);
+    config.custom_transport_parameters_to_send()[kCustomParameterId] =
+        std::string(2000, '-');
+  }
+  const std::vector<std::unique_ptr<quic::QuicReceivedPacket>> packets =
+      quic::test::GetFirstFlightOfPackets(version, config);
+  std::cout << quic::ParsedQuicVersionToString(version) << ", "
+            << packets.size() << " Initial packet(s)" << std::endl;
+
+  const int iterations = quiche::GetQuicheCommandLineFlag(FLAGS_iterations);
+  for (int i = 0; i < iterations; ++i) {
+    quic::RunBenchmark(version, packets, num_chlos, /*without_ssl=*/false);
+    quic::RunBenchmark(version, packets, num_chlos, /*without_ssl=*/true);
+  }
+  return 0;
+}
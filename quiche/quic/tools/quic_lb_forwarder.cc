@@ -0,0 +1,966 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/quic_lb_forwarder.h"
+
+#include <sched.h>
+#include <sys/socket.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <cstring>
+#include <functional>
+#include <iterator>
+#include <string>
+#include <utility>
+
+#include "absl/container/flat_hash_map.h"
+#include "absl/container/inlined_vector.h"
+#include "absl/memory/memory.h"
+#include "absl/strings/ascii.h"
+#include "absl/strings/escaping.h"
+#include "absl/strings/numbers.h"
+#include "absl/strings/str_cat.h"
+#include "absl/strings/str_split.h"
+#include "absl/types/span.h"
+#include "quiche/quic/core/quic_connection_id.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_linux_socket_utils.h"
+#include "quiche/quic/core/quic_types.h"
+#include "quiche/quic/core/quic_udp_socket.h"
+#include "quiche/quic/core/quic_utils.h"
+#include "quiche/quic/load_balancer/load_balancer_decoder.h"
+#include "quiche/quic/platform/api/quic_epoll.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+#include "quiche/quic/platform/api/quic_thread.h"
+#include "quiche/common/quiche_linked_hash_map.h"
+
+namespace quic {
+
+namespace {
+
+// Number of packets, or of groups of packets coalesced by GRO, that a worker
+// reads with a single recvmmsg call.
+constexpr size_t kPacketsPerRead = 16;
+// Number of reads from a socket before a worker handles other events.
+constexpr int kMaxReadsPerEvent = 8;
+// Large enough for all the datagrams GRO can coalesce into a single read.
+constexpr size_t kGroPacketBufferSize = 64 * 1024;
+// Same limit as QuicGsoBatchWriter, for datagrams of typical sizes.
+constexpr size_t kMaxGsoSegments = 45;
+// How often idle workers wake up to close idle flows.
+constexpr int64_t kWorkerWakeupIntervalUs = 100 * 1000;
+// Offset of the connection ID length in a long header, after the first byte
+// and the version.
+constexpr size_t kLongHeaderConnectionIdLengthOffset = 5;
+// Number of backends a flow accepts packets from. A client reaches a second
+// backend when its connection ID changes routing, e.g. after a routing table
+// update.
+constexpr size_t kMaxBackendsPerFlow = 4;
+
+// Finalizer of SplitMix64, which spreads the bits of |x| over the result.
+uint64_t Mix64(uint64_t x) {
+  x ^= x >> 30;
+  x *= 0xbf58476d1ce4e5b9;
+  x ^= x >> 27;
+  x *= 0x94d049bb133111eb;
+  return x ^ (x >> 31);
+}
+
+// Copies the IP address and port of |address| to |buffer|, and returns the end
+// of the copied bytes.
+char* CopyAddress(const QuicSocketAddress& address, char* buffer) {
+  if (address.host().IsIPv4()) {
+    const in_addr ip = address.host().GetIPv4();
+    memcpy(buffer, &ip, sizeof(ip));
+    buffer += sizeof(ip);
+  } else if (address.host().IsIPv6()) {
+    const in6_addr ip = address.host().GetIPv6();
+    memcpy(buffer, &ip, sizeof(ip));
+    buffer += sizeof(ip);
+  }
+  const uint16_t port = address.port();
+  memcpy(buffer, &port, sizeof(port));
+  return buffer + sizeof(port);
+}
+
+uint64_t HashAddresses(const QuicSocketAddress& peer_address,
+                       const QuicSocketAddress& self_address) {
+  char buffer[2 * (sizeof(in6_addr) + sizeof(uint16_t))];
+  char* end = CopyAddress(peer_address, buffer);
+  end = CopyAddress(self_address, end);
+  return QuicUtils::FNV1a_64_Hash(absl::string_view(buffer, end - buffer));
+}
+
+bool ParseUint8(absl::string_view text, uint8_t* value) {
+  uint32_t parsed;
+  if (!absl::SimpleAtoi(text, &parsed) || parsed > UINT8_MAX) {
+    return false;
+  }
+  *value = parsed;
+  return true;
+}
+
+bool ParseHex(absl::string_view text, std::string* bytes) {
+  if (text.empty() || text.size() % 2 != 0 ||
+      !std::all_of(text.begin(), text.end(),
+                   [](char c) { return absl::ascii_isxdigit(c); })) {
+    return false;
+  }
+  *bytes = absl::HexStringToBytes(text);
+  return true;
+}
+
+// Parses "<IPv4>:<port>" or "[<IPv6>]:<port>".
+bool ParseSocketAddress(absl::string_view text, QuicSocketAddress* address) {
+  const size_t colon = text.rfind(':');
+  if (colon == absl::string_view::npos) {
+    return false;
+  }
+  absl::string_view host = text.substr(0, colon);
+  if (host.size() > 2 && host.front() == '[' && host.back() == ']') {
+    host = host.substr(1, host.size() - 2);
+  } else if (host.find(':') != absl::string_view::npos) {
+    return false;
+  }
+  QuicIpAddress ip;
+  uint32_t port;
+  if (!ip.FromString(std::string(host)) ||
+      !absl::SimpleAtoi(text.substr(colon + 1), &port) || port == 0 ||
+      port > UINT16_MAX) {
+    return false;
+  }
+  *address = QuicSocketAddress(ip, port);
+  return true;
+}
+
+// Sets |connection_id| to the destination connection ID of |packet|, using
+// the version-independent properties of QUIC (RFC 8999). Short headers do not
+// carry the length of the connection ID, which is implied by its config.
+// Returns false if |packet| has a short header and the connection ID does not
+// belong to a config of |routing_table|, or if |packet| is too short.
+bool ExtractDestinationConnectionId(const char* packet, size_t length,
+                                    const QuicLbRoutingTable& routing_table,
+                                    QuicConnectionId* connection_id) {
+  if (length == 0) {
+    return false;
+  }
+  if (static_cast<uint8_t>(packet[0]) & FLAGS_LONG_HEADER) {
+    if (length <= kLongHeaderConnectionIdLengthOffset) {
+      return false;
+    }
+    const uint8_t connection_id_length =
+        packet[kLongHeaderConnectionIdLengthOffset];
+    if (connection_id_length > kQuicMaxConnectionIdWithLengthPrefixLength ||
+        length <
+            kLongHeaderConnectionIdLengthOffset + 1 + connection_id_length) {
+      return false;
+    }
+    *connection_id =
+        QuicConnectionId(packet + kLongHeaderConnectionIdLengthOffset + 1,
+                         connection_id_length);
+    return true;
+  }
+  if (length < 2) {
+    return false;
+  }
+  const absl::optional<uint8_t> config_id =
+      LoadBalancerDecoder::GetConfigId(QuicConnectionId(packet + 1, 1));
+  if (!config_id.has_value()) {
+    return false;
+  }
+  const LoadBalancerConfig* config = routing_table.GetConfig(*config_id);
+  if (config == nullptr || length < 1u + config->total_len()) {
+    return false;
+  }
+  *connection_id = QuicConnectionId(packet + 1, config->total_len());
+  return true;
+}
+
+}  // namespace
+
+// static
+std::unique_ptr<QuicLbRoutingTable> QuicLbRoutingTable::Parse(
+    absl::string_view contents) {
+  struct Server {
+    LoadBalancerServerId server_id;
+    QuicSocketAddress address;
+    bool draining;
+    int line_number;
+  };
+  auto table = absl::WrapUnique(new QuicLbRoutingTable());
+  std::vector<Server> servers;
+  int line_number = 0;
+  for (absl::string_view line : absl::StrSplit(contents, '\n')) {
+    ++line_number;
+    const std::vector<absl::string_view> fields =
+        absl::StrSplit(line.substr(0, line.find('#')),
+                       absl::ByAnyChar(" \t\r"), absl::SkipEmpty());
+    if (fields.empty()) {
+      continue;
+    }
+    if (fields[0] == "config" && (fields.size() == 4 || fields.size() == 5)) {
+      uint8_t config_id, server_id_len, nonce_len;
+      std::string key;
+      if (!ParseUint8(fields[1], &config_id) ||
+          !ParseUint8(fields[2], &server_id_len) ||
+          !ParseUint8(fields[3], &nonce_len) ||
+          config_id >= kNumLoadBalancerConfigs || server_id_len == 0 ||
+          server_id_len > kLoadBalancerMaxServerIdLen ||
+          nonce_len < kLoadBalancerMinNonceLen ||
+          nonce_len > kLoadBalancerMaxNonceLen ||
+          1 + server_id_len + nonce_len >
+              kQuicMaxConnectionIdWithLengthPrefixLength ||
+          (fields.size() == 5 && (!ParseHex(fields[4], &key) ||
+                                  key.size() != kLoadBalancerKeyLen)) ||
+          table->configs_[config_id].has_value()) {
+        QUIC_LOG(ERROR) << "Invalid config on line " << line_number << ": "
+                        << line;
+        return nullptr;
+      }
+      table->configs_[config_id] =
+          key.empty() ? LoadBalancerConfig::CreateUnencrypted(
+                            config_id, server_id_len, nonce_len)
+                      : LoadBalancerConfig::Create(config_id, server_id_len,
+                                                   nonce_len, key);
+      continue;
+    }
+    if (fields[0] == "server" &&
+        (fields.size() == 3 ||
+         (fields.size() == 4 && fields[3] == "draining"))) {
+      std::string server_id;
+      QuicSocketAddress address;
+      if (!ParseHex(fields[1], &server_id) ||
+          server_id.size() > kLoadBalancerMaxServerIdLen ||
+          !ParseSocketAddress(fields[2], &address)) {
+        QUIC_LOG(ERROR) << "Invalid server on line " << line_number << ": "
+                        << line;
+        return nullptr;
+      }
+      servers.push_back(
+          {*LoadBalancerServerId::Create(absl::MakeConstSpan(
+               reinterpret_cast<const uint8_t*>(server_id.data()),
+               server_id.size())),
+           address, fields.size() == 4, line_number});
+      continue;
+    }
+    QUIC_LOG(ERROR) << "Invalid directive on line " << line_number << ": "
+                    << line;
+    return nullptr;
+  }
+
+  for (const Server& server : servers) {
+    const uint8_t server_id_len = server.server_id.length();
+    if (std::none_of(std::begin(table->configs_), std::end(table->configs_),
+                     [server_id_len](const auto& config) {
+                       return config.has_value() &&
+                              config->server_id_len() == server_id_len;
+                     })) {
+      QUIC_LOG(ERROR) << "Server ID on line " << server.line_number
+                      << " does not have the server ID length of any config";
+      return nullptr;
+    }
+    auto& backends = table->backends_[server_id_len];
+    if (backends == nullptr) {
+      backends =
+          LoadBalancerServerIdMap<QuicSocketAddress>::Create(server_id_len);
+    }
+    if (backends->LookupNoCopy(server.server_id) != nullptr) {
+      QUIC_LOG(ERROR) << "Duplicate server ID on line " << server.line_number;
+      return nullptr;
+    }
+    backends->AddOrReplace(server.server_id, server.address);
+    if (!server.draining) {
+      table->hashed_backends_.push_back(
+          {server.address,
+           QuicUtils::FNV1a_64_Hash(server.address.ToString())});
+    }
+  }
+  table->num_servers_ = servers.size();
+  return table;
+}
+
+const LoadBalancerConfig* QuicLbRoutingTable::GetConfig(
+    uint8_t config_id) const {
+  if (config_id >= kNumLoadBalancerConfigs ||
+      !configs_[config_id].has_value()) {
+    return nullptr;
+  }
+  return &*configs_[config_id];
+}
+
+const QuicSocketAddress* QuicLbRoutingTable::GetBackend(
+    const LoadBalancerServerId& server_id) const {
+  const auto& backends = backends_[server_id.length()];
+  if (backends == nullptr) {
+    return nullptr;
+  }
+  return backends->LookupNoCopy(server_id);
+}
+
+QuicSocketAddress QuicLbRoutingTable::SelectBackend(
+    const QuicSocketAddress& peer_address,
+    const QuicSocketAddress& self_address) const {
+  const uint64_t hash = HashAddresses(peer_address, self_address);
+  const HashedBackend* selected = nullptr;
+  uint64_t selected_weight = 0;
+  for (const HashedBackend& backend : hashed_backends_) {
+    const uint64_t weight = Mix64(hash ^ backend.seed);
+    if (selected == nullptr || weight > selected_weight) {
+      selected = &backend;
+      selected_weight = weight;
+    }
+  }
+  return selected == nullptr ? QuicSocketAddress() : selected->address;
+}
+
+void QuicLbRoutingTable::AddConfigsTo(LoadBalancerRouter* router) const {
+  for (const absl::optional<LoadBalancerConfig>& config : configs_) {
+    if (config.has_value()) {
+      router->AddConfig(*config);
+    }
+  }
+}
+
+// Forwards the packets received on one listening socket, on its own thread.
+class QuicLbForwarder::Worker : public QuicThread,
+                                public QuicEpollCallbackInterface {
+ public:
+  Worker(QuicLbForwarder* forwarder, int index, QuicUdpSocketFd listen_fd);
+  Worker(const Worker&) = delete;
+  Worker& operator=(const Worker&) = delete;
+  ~Worker() override;
+
+  // Makes Run() return. Thread-safe.
+  void Stop();
+
+  // Thread-safe.
+  void AddStatsTo(Stats* stats) const;
+
+  // From QuicThread.
+  void Run() override;
+
+  // From QuicEpollCallbackInterface.
+  std::string Name() const override { return "QuicLbForwarder::Worker"; }
+  void OnRegistration(QuicEpollServer* /*eps*/, int /*fd*/,
+                      int /*event_mask*/) override {}
+  void OnModification(int /*fd*/, int /*event_mask*/) override {}
+  void OnEvent(int fd, QuicEpollEvent* event) override;
+  void OnUnregistration(int /*fd*/, bool /*replaced*/) override {}
+  void OnShutdown(QuicEpollServer* /*eps*/, int /*fd*/) override {}
+
+ private:
+  // The traffic of one client address. The worker sends the client's packets
+  // to backends from |fd|, and relays the packets received on |fd| back to the
+  // client.
+  struct Flow {
+    QuicSocketAddress client_address;
+    // The address the client sends to.
+    QuicIpAddress self_ip;
+    QuicUdpSocketFd fd;
+    int address_family;
+    int64_t last_active_us;
+    // The batch of datagrams from clients which last used the flow, which
+    // holds pointers to it until the batch is sent.
+    uint64_t last_batch = 0;
+    // The backends the client's packets were sent to, oldest first. Packets
+    // from other addresses are dropped, so that the flow's socket does not
+    // relay arbitrary traffic to the client.
+    absl::InlinedVector<QuicSocketAddress, 2> backends;
+  };
+
+  using FlowMap = quiche::QuicheLinkedHashMap<QuicSocketAddress,
+                                              std::unique_ptr<Flow>,
+                                              QuicSocketAddressHash>;
+
+  // A received datagram, and where to send it.
+  struct Datagram {
+    char* data;
+    size_t length;
+    QuicSocketAddress peer_address;
+    QuicIpAddress self_ip;
+    QuicSocketAddress destination;
+    Flow* flow = nullptr;
+  };
+
+  void MaybeUpdateRoutingTable();
+
+  // Reads the datagrams available on |fd| into |datagrams_|, up to
+  // kPacketsPerRead reads. Returns the number of reads.
+  size_t ReadDatagrams(QuicUdpSocketFd fd);
+
+  // Sends the datagrams read from the listening socket to their backends.
+  void ForwardToBackends();
+
+  // Sends the datagrams read from the socket of |flow| to its client.
+  void ForwardToClient(Flow* flow);
+
+  // Returns the flow of the client which sent |datagram|, creating it if
+  // needed, or nullptr if the flow cannot send to the destination.
+  Flow* GetOrCreateFlow(const Datagram& datagram);
+
+  // Moves |it| to the back of |flows_|, which is ordered from the least to
+  // the most recently used flow.
+  void MarkFlowUsed(FlowMap::iterator it);
+
+  void CloseFlowSocket(const Flow& flow);
+  void MaybeCloseIdleFlows();
+
+  // Sends the datagrams listed in |send_order_|, grouping consecutive ones
+  // with the same flow and destination into GSO writes.
+  void SendDatagrams(bool to_clients);
+
+  // Sends the datagrams listed in |send_order_| from |begin| to |end| with a
+  // single write. They must all have the same flow and destination, and all
+  // but the last must have the same length.
+  void WriteDatagrams(QuicUdpSocketFd fd, const QuicIpAddress& self_ip,
+                      size_t begin, size_t end);
+
+  QuicLbForwarder* const forwarder_;  // Not owned.
+  const int index_;
+  const QuicUdpSocketFd listen_fd_;
+  const size_t packet_buffer_size_;
+  const BitMask64 packet_info_interested_;
+  bool use_gso_;
+  std::atomic<bool> stop_{false};
+  QuicEpollServer epoll_server_;
+  QuicUdpSocketApi socket_api_;
+
+  uint64_t routing_table_generation_ = 0;
+  std::shared_ptr<const QuicLbRoutingTable> routing_table_;
+  std::unique_ptr<LoadBalancerRouter> router_;
+
+  FlowMap flows_;
+  absl::flat_hash_map<QuicUdpSocketFd, Flow*> flows_by_fd_;
+  // Number of batches of datagrams read from the listening socket.
+  uint64_t num_batches_ = 0;
+  int64_t next_idle_check_us_ = 0;
+
+  // Buffers, kept across events to avoid allocations.
+  std::unique_ptr<char[]> packet_buffers_;
+  std::unique_ptr<char[]> control_buffers_;
+  QuicUdpSocketApi::ReadPacketResults read_results_;
+  std::unique_ptr<char[]> send_buffer_;
+  std::vector<Datagram> datagrams_;
+  std::vector<QuicConnectionId> connection_ids_;
+  std::vector<size_t> connection_id_datagrams_;
+  std::vector<absl::optional<LoadBalancerServerId>> server_ids_;
+  std::vector<size_t> send_order_;
+
+  // Counted by the worker thread, and published to |stats_| after each event.
+  Stats pending_stats_;
+  mutable QuicMutex stats_mutex_;
+  Stats stats_ QUIC_GUARDED_BY(stats_mutex_);
+};
+
+QuicLbForwarder::Worker::Worker(QuicLbForwarder* forwarder, int index,
+                                QuicUdpSocketFd listen_fd)
+    : QuicThread(absl::StrCat("QuicLbForwarder worker ", index)),
+      forwarder_(forwarder),
+      index_(index),
+      listen_fd_(listen_fd),
+      packet_buffer_size_(forwarder->options_.use_gro ? kGroPacketBufferSize
+                                                      : kMaxIncomingPacketSize),
+      packet_info_interested_(QuicUdpPacketInfoBit::PEER_ADDRESS,
+                              QuicUdpPacketInfoBit::V4_SELF_IP,
+                              QuicUdpPacketInfoBit::V6_SELF_IP,
+                              QuicUdpPacketInfoBit::GRO_SEGMENT_SIZE),
+      use_gso_(forwarder->options_.use_gso),
+      packet_buffers_(new char[kPacketsPerRead * packet_buffer_size_]),
+      control_buffers_(
+          new char[kPacketsPerRead * kDefaultUdpPacketControlBufferSize]),
+      read_results_(kPacketsPerRead),
+      send_buffer_(new char[kMaxGsoPacketSize]) {
+  for (size_t i = 0; i < kPacketsPerRead; ++i) {
+    read_results_[i].packet_buffer = BufferSpan(
+        packet_buffers_.get() + i * packet_buffer_size_, packet_buffer_size_);
+    read_results_[i].control_buffer = BufferSpan(
+        control_buffers_.get() + i * kDefaultUdpPacketControlBufferSize,
+        kDefaultUdpPacketControlBufferSize);
+  }
+}
+
+QuicLbForwarder::Worker::~Worker() { socket_api_.Destroy(listen_fd_); }
+
+void QuicLbForwarder::Worker::Stop() {
+  stop_.store(true, std::memory_order_relaxed);
+  epoll_server_.Wake();
+}
+
+void QuicLbForwarder::Worker::AddStatsTo(Stats* stats) const {
+  QuicReaderMutexLock lock(&stats_mutex_);
+  stats->packets_from_clients += stats_.packets_from_clients;
+  stats->packets_routed_by_server_id += stats_.packets_routed_by_server_id;
+  stats->packets_routed_by_hash += stats_.packets_routed_by_hash;
+  stats->packets_from_backends += stats_.packets_from_backends;
+  stats->packets_from_unknown_peers += stats_.packets_from_unknown_peers;
+  stats->packets_dropped += stats_.packets_dropped;
+  stats->writes += stats_.writes;
+  stats->flows_created += stats_.flows_created;
+  stats->flows_evicted += stats_.flows_evicted;
+  stats->flows_refused += stats_.flows_refused;
+}
+
+void QuicLbForwarder::Worker::Run() {
+#if defined(__linux__)
+  if (forwarder_->options_.pin_threads) {
+    const long num_cpus = sysconf(_SC_NPROCESSORS_ONLN);
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(index_ % std::max(num_cpus, 1L), &cpus);
+    if (sched_setaffinity(0, sizeof(cpus), &cpus) != 0) {
+      QUIC_LOG(WARNING) << "Failed to pin worker " << index_
+                        << " to a CPU: " << strerror(errno);
+    }
+  }
+#endif
+  epoll_server_.set_timeout_in_us(kWorkerWakeupIntervalUs);
+  epoll_server_.RegisterFDForRead(listen_fd_, this);
+  while (!stop_.load(std::memory_order_relaxed)) {
+    epoll_server_.WaitForEventsAndExecuteCallbacks();
+    MaybeCloseIdleFlows();
+  }
+  for (const auto& flow : flows_) {
+    CloseFlowSocket(*flow.second);
+  }
+  flows_.clear();
+  epoll_server_.UnregisterFD(listen_fd_);
+}
+
+void QuicLbForwarder::Worker::OnEvent(int fd, QuicEpollEvent* event) {
+  event->out_ready_mask = 0;
+  MaybeUpdateRoutingTable();
+  Flow* flow = nullptr;
+  if (fd != listen_fd_) {
+    auto it = flows_by_fd_.find(fd);
+    if (it == flows_by_fd_.end()) {
+      return;
+    }
+    flow = it->second;
+  }
+  // The sockets are level-triggered, so leaving packets unread after
+  // kMaxReadsPerEvent reads only lets other sockets go first.
+  for (int i = 0; i < kMaxReadsPerEvent; ++i) {
+    const size_t num_reads = ReadDatagrams(fd);
+    if (flow == nullptr) {
+      ForwardToBackends();
+    } else {
+      ForwardToClient(flow);
+    }
+    if (num_reads < kPacketsPerRead) {
+      break;
+    }
+  }
+  QuicWriterMutexLock lock(&stats_mutex_);
+  stats_ = pending_stats_;
+}
+
+void QuicLbForwarder::Worker::MaybeUpdateRoutingTable() {
+  const uint64_t generation =
+      forwarder_->routing_table_generation_.load(std::memory_order_acquire);
+  if (generation == routing_table_generation_) {
+    return;
+  }
+  routing_table_generation_ = generation;
+  routing_table_ = forwarder_->routing_table();
+  // Cached server IDs of deleted configs must not outlive them.
+  router_ =
+      std::make_unique<LoadBalancerRouter>(forwarder_->options_.cache_size);
+  routing_table_->AddConfigsTo(router_.get());
+}
+
+size_t QuicLbForwarder::Worker::ReadDatagrams(QuicUdpSocketFd fd) {
+  datagrams_.clear();
+  for (QuicUdpSocketApi::ReadPacketResult& result : read_results_) {
+    result.Reset(packet_buffer_size_);
+  }
+  const size_t num_reads = socket_api_.ReadMultiplePackets(
+      fd, packet_info_interested_, &read_results_);
+  for (size_t i = 0; i < num_reads; ++i) {
+    const QuicUdpSocketApi::ReadPacketResult& result = read_results_[i];
+    if (!result.ok) {
+      continue;
+    }
+    const QuicUdpPacketInfo& info = result.packet_info;
+    Datagram datagram;
+    datagram.peer_address = info.peer_address();
+    const bool prefer_v6_ip = datagram.peer_address.host().IsIPv6();
+    if (info.HasValue(QuicUdpPacketInfoBit::V6_SELF_IP) &&
+        (prefer_v6_ip || !info.HasValue(QuicUdpPacketInfoBit::V4_SELF_IP))) {
+      datagram.self_ip = info.self_v6_ip();
+    } else if (info.HasValue(QuicUdpPacketInfoBit::V4_SELF_IP)) {
+      datagram.self_ip = info.self_v4_ip();
+    }
+    const size_t length = result.packet_buffer.buffer_len;
+    size_t segment_size = length;
+    if (info.HasValue(QuicUdpPacketInfoBit::GRO_SEGMENT_SIZE) &&
+        info.gro_segment_size() > 0) {
+      segment_size = info.gro_segment_size();
+    }
+    for (size_t offset = 0; offset < length; offset += segment_size) {
+      datagram.data = result.packet_buffer.buffer + offset;
+      datagram.length = std::min(segment_size, length - offset);
+      datagrams_.push_back(datagram);
+    }
+  }
+  return num_reads;
+}
+
+void QuicLbForwarder::Worker::ForwardToBackends() {
+  ++num_batches_;
+  pending_stats_.packets_from_clients += datagrams_.size();
+
+  // Decode the server IDs of all the datagrams at once.
+  connection_ids_.clear();
+  connection_id_datagrams_.clear();
+  for (size_t i = 0; i < datagrams_.size(); ++i) {
+    QuicConnectionId connection_id;
+    if (ExtractDestinationConnectionId(datagrams_[i].data,
+                                       datagrams_[i].length, *routing_table_,
+                                       &connection_id)) {
+      connection_ids_.push_back(connection_id);
+      connection_id_datagrams_.push_back(i);
+    }
+  }
+  server_ids_.resize(connection_ids_.size());
+  router_->GetServerIds(connection_ids_, absl::MakeSpan(server_ids_));
+  for (size_t i = 0; i < server_ids_.size(); ++i) {
+    if (!server_ids_[i].has_value()) {
+      continue;
+    }
+    const QuicSocketAddress* backend =
+        routing_table_->GetBackend(*server_ids_[i]);
+    if (backend != nullptr) {
+      datagrams_[connection_id_datagrams_[i]].destination = *backend;
+      ++pending_stats_.packets_routed_by_server_id;
+    }
+  }
+
+  send_order_.clear();
+  for (size_t i = 0; i < datagrams_.size(); ++i) {
+    Datagram& datagram = datagrams_[i];
+    if (!datagram.destination.IsInitialized()) {
+      datagram.destination = routing_table_->SelectBackend(
+          datagram.peer_address,
+          QuicSocketAddress(datagram.self_ip,
+                            forwarder_->listen_address().port()));
+      if (!datagram.destination.IsInitialized()) {
+        ++pending_stats_.packets_dropped;
+        continue;
+      }
+      ++pending_stats_.packets_routed_by_hash;
+    }
+    datagram.flow = GetOrCreateFlow(datagram);
+    if (datagram.flow == nullptr) {
+      ++pending_stats_.packets_dropped;
+      continue;
+    }
+    send_order_.push_back(i);
+  }
+  // Make the datagrams of each flow to each backend adjacent, so that they can
+  // be sent together, without reordering the datagrams of a flow.
+  std::sort(send_order_.begin(), send_order_.end(),
+            [this](size_t a, size_t b) {
+              const Datagram& lhs = datagrams_[a];
+              const Datagram& rhs = datagrams_[b];
+              if (lhs.flow != rhs.flow) {
+                return std::less<Flow*>()(lhs.flow, rhs.flow);
+              }
+              const uint32_t lhs_hash = lhs.destination.Hash();
+              const uint32_t rhs_hash = rhs.destination.Hash();
+              if (lhs_hash != rhs_hash) {
+                return lhs_hash < rhs_hash;
+              }
+              return a < b;
+            });
+  SendDatagrams(/*to_clients=*/false);
+}
+
+void QuicLbForwarder::Worker::ForwardToClient(Flow* flow) {
+  send_order_.clear();
+  for (size_t i = 0; i < datagrams_.size(); ++i) {
+    if (std::find(flow->backends.begin(), flow->backends.end(),
+                  datagrams_[i].peer_address) == flow->backends.end()) {
+      ++pending_stats_.packets_from_unknown_peers;
+      continue;
+    }
+    datagrams_[i].destination = flow->client_address;
+    datagrams_[i].flow = flow;
+    send_order_.push_back(i);
+  }
+  if (send_order_.empty()) {
+    return;
+  }
+  pending_stats_.packets_from_backends += send_order_.size();
+  flow->last_active_us = epoll_server_.ApproximateNowInUsec();
+  MarkFlowUsed(flows_.find(flow->client_address));
+  SendDatagrams(/*to_clients=*/true);
+}
+
+QuicLbForwarder::Worker::Flow* QuicLbForwarder::Worker::GetOrCreateFlow(
+    const Datagram& datagram) {
+  const int address_family = datagram.destination.host().AddressFamilyToInt();
+  Flow* flow;
+  auto it = flows_.find(datagram.peer_address);
+  if (it != flows_.end()) {
+    flow = it->second.get();
+    MarkFlowUsed(it);
+  } else {
+    if (flows_.size() >= forwarder_->options_.max_flows_per_worker) {
+      // The least recently used flow cannot be closed while datagrams of the
+      // current batch refer to it, and then neither can any other.
+      if (flows_.empty() ||
+          flows_.front().second->last_batch == num_batches_) {
+        ++pending_stats_.flows_refused;
+        return nullptr;
+      }
+      // Bounds the sockets a flood of spoofed client addresses can open. The
+      // genuine clients which are active keep their flows.
+      CloseFlowSocket(*flows_.front().second);
+      flows_.pop_front();
+      ++pending_stats_.flows_evicted;
+    }
+    const QuicUdpSocketFd fd =
+        socket_api_.Create(address_family, kDefaultSocketReceiveBuffer,
+                           kDefaultSocketReceiveBuffer);
+    if (fd == kQuicInvalidSocketFd) {
+      ++pending_stats_.flows_refused;
+      return nullptr;
+    }
+    if (forwarder_->options_.use_gro) {
+      socket_api_.EnableGro(fd);
+    }
+    auto new_flow = std::make_unique<Flow>();
+    new_flow->client_address = datagram.peer_address;
+    new_flow->fd = fd;
+    new_flow->address_family = address_family;
+    flow = new_flow.get();
+    flows_.emplace(datagram.peer_address, std::move(new_flow));
+    flows_by_fd_[fd] = flow;
+    epoll_server_.RegisterFDForRead(fd, this);
+    ++pending_stats_.flows_created;
+  }
+  if (flow->address_family != address_family) {
+    QUIC_LOG_FIRST_N(WARNING, 10)
+        << "Cannot forward the packets of " << datagram.peer_address
+        << " to backends of different address families";
+    return nullptr;
+  }
+  if (std::find(flow->backends.begin(), flow->backends.end(),
+                datagram.destination) == flow->backends.end()) {
+    if (flow->backends.size() == kMaxBackendsPerFlow) {
+      flow->backends.erase(flow->backends.begin());
+    }
+    flow->backends.push_back(datagram.destination);
+  }
+  flow->self_ip = datagram.self_ip;
+  flow->last_active_us = epoll_server_.ApproximateNowInUsec();
+  flow->last_batch = num_batches_;
+  return flow;
+}
+
+void QuicLbForwarder::Worker::MarkFlowUsed(FlowMap::iterator it) {
+  if (it == flows_.end() || std::next(it) == flows_.end()) {
+    return;
+  }
+  const QuicSocketAddress client_address = it->first;
+  std::unique_ptr<Flow> flow = std::move(it->second);
+  flows_.erase(it);
+  flows_.emplace(client_address, std::move(flow));
+}
+
+void QuicLbForwarder::Worker::CloseFlowSocket(const Flow& flow) {
+  epoll_server_.UnregisterFD(flow.fd);
+  flows_by_fd_.erase(flow.fd);
+  socket_api_.Destroy(flow.fd);
+}
+
+void QuicLbForwarder::Worker::MaybeCloseIdleFlows() {
+  const int64_t now_us = epoll_server_.NowInUsec();
+  if (now_us < next_idle_check_us_) {
+    return;
+  }
+  const int64_t idle_timeout_us =
+      forwarder_->options_.idle_timeout.ToMicroseconds();
+  next_idle_check_us_ =
+      now_us + std::max(idle_timeout_us / 2, kWorkerWakeupIntervalUs);
+  for (auto it = flows_.begin(); it != flows_.end();) {
+    if (now_us - it->second->last_active_us < idle_timeout_us) {
+      ++it;
+      continue;
+    }
+    CloseFlowSocket(*it->second);
+    it = flows_.erase(it);
+  }
+}
+
+void QuicLbForwarder::Worker::SendDatagrams(bool to_clients) {
+  size_t begin = 0;
+  while (begin < send_order_.size()) {
+    const Datagram& first = datagrams_[send_order_[begin]];
+    size_t end = begin + 1;
+    size_t total_length = first.length;
+    while (use_gso_ && end < send_order_.size() &&
+           end - begin < kMaxGsoSegments) {
+      const Datagram& next = datagrams_[send_order_[end]];
+      if (next.flow != first.flow || next.destination != first.destination ||
+          next.length > first.length ||
+          total_length + next.length > kMaxGsoPacketSize) {
+        break;
+      }
+      total_length += next.length;
+      ++end;
+      // Only the last segment of a GSO write may be shorter.
+      if (next.length < first.length) {
+        break;
+      }
+    }
+    if (to_clients) {
+      WriteDatagrams(listen_fd_, first.flow->self_ip, begin, end);
+    } else {
+      WriteDatagrams(first.flow->fd, QuicIpAddress(), begin, end);
+    }
+    begin = end;
+  }
+}
+
+void QuicLbForwarder::Worker::WriteDatagrams(QuicUdpSocketFd fd,
+                                             const QuicIpAddress& self_ip,
+                                             size_t begin, size_t end) {
+  const Datagram& first = datagrams_[send_order_[begin]];
+  // The datagrams of a GRO read are contiguous, and sent in place. Others are
+  // copied to |send_buffer_|.
+  const char* buffer = first.data;
+  size_t length = 0;
+  for (size_t i = begin; i < end; ++i) {
+    const Datagram& datagram = datagrams_[send_order_[i]];
+    if (buffer != send_buffer_.get() && datagram.data != buffer + length) {
+      memcpy(send_buffer_.get(), buffer, length);
+      buffer = send_buffer_.get();
+    }
+    if (buffer == send_buffer_.get()) {
+      memcpy(send_buffer_.get() + length, datagram.data, datagram.length);
+    }
+    length += datagram.length;
+  }
+
+  char cbuf[kCmsgSpaceForIp + kCmsgSpaceForSegmentSize];
+  QuicMsgHdr hdr(buffer, length, first.destination, cbuf, sizeof(cbuf));
+  hdr.SetIpInNextCmsg(self_ip);
+  if (end - begin > 1) {
+    *hdr.GetNextCmsgData<uint16_t>(SOL_UDP, UDP_SEGMENT) = first.length;
+  }
+  const WriteResult result = QuicLinuxSocketUtils::WritePacket(fd, hdr);
+  ++pending_stats_.writes;
+  if (result.status == WRITE_STATUS_OK) {
+    return;
+  }
+  if (end - begin > 1 && result.error_code == EIO) {
+    // The kernel or the device cannot segment this write.
+    QUIC_LOG_FIRST_N(WARNING, 1) << "GSO write failed, disabling GSO";
+    use_gso_ = false;
+    for (size_t i = begin; i < end; ++i) {
+      WriteDatagrams(fd, self_ip, i, i + 1);
+    }
+    return;
+  }
+  if (result.status != WRITE_STATUS_BLOCKED) {
+    QUIC_LOG_FIRST_N(ERROR, 100) << "Failed to send to " << first.destination
+                                 << ": " << strerror(result.error_code);
+  }
+  // Like a router with a full queue, drop the datagrams rather than buffering
+  // them.
+  pending_stats_.packets_dropped += end - begin;
+}
+
+QuicLbForwarder::QuicLbForwarder(
+    const Options& options, std::unique_ptr<QuicLbRoutingTable> routing_table)
+    : options_(options),
+      listen_address_(options.listen_address),
+      routing_table_(std::move(routing_table)) {}
+
+QuicLbForwarder::~QuicLbForwarder() { Stop(); }
+
+bool QuicLbForwarder::Start() {
+  QUICHE_DCHECK(workers_.empty());
+  QuicUdpSocketApi socket_api;
+  for (int i = 0; i < options_.num_threads; ++i) {
+    const QuicUdpSocketFd fd = socket_api.Create(
+        listen_address_.host().AddressFamilyToInt(),
+        kDefaultSocketReceiveBuffer, kDefaultSocketReceiveBuffer);
+    if (fd == kQuicInvalidSocketFd) {
+      workers_.clear();
+      return false;
+    }
+    int reuse_port = 1;
+    if (setsockopt(fd, SOL_SOCKET, SO_REUSEPORT, &reuse_port,
+                   sizeof(reuse_port)) != 0 ||
+        !socket_api.Bind(fd, listen_address_)) {
+      QUIC_LOG(ERROR) << "Failed to bind to " << listen_address_ << ": "
+                      << strerror(errno);
+      socket_api.Destroy(fd);
+      workers_.clear();
+      return false;
+    }
+    if (listen_address_.port() == 0) {
+      // Bind the sockets of the other workers to the port the kernel picked.
+      if (listen_address_.FromSocket(fd) != 0) {
+        QUIC_LOG(ERROR) << "Failed to get the listening address: "
+                        << strerror(errno);
+        socket_api.Destroy(fd);
+        workers_.clear();
+        return false;
+      }
+    }
+    if (options_.use_gro && !socket_api.EnableGro(fd) && i == 0) {
+      QUIC_LOG(WARNING) << "UDP GRO is not supported";
+    }
+    workers_.push_back(std::make_unique<Worker>(this, i, fd));
+  }
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->Start();
+  }
+  running_ = true;
+  QUIC_LOG(INFO) << "Forwarding from " << listen_address_ << " with "
+                 << workers_.size() << " threads";
+  return true;
+}
+
+void QuicLbForwarder::Stop() {
+  if (!running_) {
+    return;
+  }
+  running_ = false;
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->Stop();
+  }
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->Join();
+  }
+}
+
+void QuicLbForwarder::UpdateRoutingTable(
+    std::unique_ptr<QuicLbRoutingTable> routing_table) {
+  {
+    QuicWriterMutexLock lock(&routing_table_mutex_);
+    routing_table_ = std::move(routing_table);
+  }
+  routing_table_generation_.fetch_add(1, std::memory_order_release);
+}
+
+QuicLbForwarder::Stats QuicLbForwarder::GetStats() const {
+  Stats stats;
+  for (const std::unique_ptr<Worker>& worker : workers_) {
+    worker->AddStatsTo(&stats);
+  }
+  return stats;
+}
+
+std::shared_ptr<const QuicLbRoutingTable> QuicLbForwarder::routing_table()
+    const {
+  QuicReaderMutexLock lock(&routing_table_mutex_);
+  return routing_table_;
+}
+
+}  // namespace quic
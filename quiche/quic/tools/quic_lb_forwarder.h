@@ -0,0 +1,197 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A QUIC-LB forwarder: a layer 4 load balancer for QUIC that routes each
+// packet to the backend whose server ID is encoded in the packet's destination
+// connection ID, as specified in draft-ietf-quic-load-balancers. Connections
+// keep reaching the same backend when the client address changes and when
+// backends are added to or removed from the pool.
+//
+// The first packets of a connection carry a connection ID chosen by the
+// client, which does not encode a server ID. These packets, and any others
+// whose server ID is unknown, go to a backend selected by a consistent hash of
+// the client and forwarder addresses, so that all the packets of a handshake
+// reach the same backend.
+//
+// The forwarder relays the traffic in both directions: it sends the packets of
+// each client to the backends from a socket of its own, and sends the packets
+// that backends return to that socket back to the client from the listening
+// address. Backends therefore see the forwarder as their peer and need no
+// changes.
+//
+// Each worker thread has its own listening socket, bound to the same address
+// with SO_REUSEPORT so that the kernel spreads clients over the threads, and
+// its own flows and cache of decoded server IDs, so that workers share
+// nothing but the routing table. Workers read packets with recvmmsg and UDP
+// GRO, decode the connection IDs of each batch together, and send consecutive
+// packets to the same destination with a single UDP GSO write.
+
+#ifndef QUICHE_QUIC_TOOLS_QUIC_LB_FORWARDER_H_
+#define QUICHE_QUIC_TOOLS_QUIC_LB_FORWARDER_H_
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <vector>
+
+#include "absl/strings/string_view.h"
+#include "absl/types/optional.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/load_balancer/load_balancer_config.h"
+#include "quiche/quic/load_balancer/load_balancer_router.h"
+#include "quiche/quic/load_balancer/load_balancer_server_id.h"
+#include "quiche/quic/load_balancer/load_balancer_server_id_map.h"
+#include "quiche/quic/platform/api/quic_export.h"
+#include "quiche/quic/platform/api/quic_ip_address.h"
+#include "quiche/quic/platform/api/quic_mutex.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+
+namespace quic {
+
+// The backends of a QuicLbForwarder and the QUIC-LB configs used to decode
+// their server IDs. A table is immutable: the forwarder replaces the whole
+// table to change its backends.
+//
+// The text format has one directive per line, and '#' starts a comment:
+//   config <config ID> <server ID length> <nonce length> [<hex key>]
+//   server <hex server ID> <IP>:<port> [draining]
+// IPv6 addresses are enclosed in brackets. Each server ID must have the server
+// ID length of a config. Draining servers keep receiving the packets of their
+// connections, but are not selected for new connections.
+class QUIC_EXPORT_PRIVATE QuicLbRoutingTable {
+ public:
+  // Returns nullptr, and logs the offending line, if |contents| is invalid.
+  static std::unique_ptr<QuicLbRoutingTable> Parse(absl::string_view contents);
+
+  QuicLbRoutingTable(const QuicLbRoutingTable&) = delete;
+  QuicLbRoutingTable& operator=(const QuicLbRoutingTable&) = delete;
+
+  // Returns the config with |config_id|, or nullptr if there is none.
+  const LoadBalancerConfig* GetConfig(uint8_t config_id) const;
+
+  // Returns the address of the backend with |server_id|, or nullptr if there
+  // is none.
+  const QuicSocketAddress* GetBackend(
+      const LoadBalancerServerId& server_id) const;
+
+  // Returns the backend of a packet from |peer_address| to |self_address|
+  // whose connection ID does not identify one. The backend is chosen among
+  // the servers which are not draining by rendezvous hashing of the addresses,
+  // so that adding or removing a server only moves the clients hashed to that
+  // server. Returns an uninitialized address if all servers are draining.
+  QuicSocketAddress SelectBackend(const QuicSocketAddress& peer_address,
+                                  const QuicSocketAddress& self_address) const;
+
+  // Adds all the configs of this table to |router|.
+  void AddConfigsTo(LoadBalancerRouter* router) const;
+
+  size_t num_servers() const { return num_servers_; }
+
+ private:
+  struct QUIC_EXPORT_PRIVATE HashedBackend {
+    QuicSocketAddress address;
+    uint64_t seed;
+  };
+
+  QuicLbRoutingTable() = default;
+
+  absl::optional<LoadBalancerConfig> configs_[kNumLoadBalancerConfigs];
+  // Indexed by server ID length.
+  std::shared_ptr<LoadBalancerServerIdMap<QuicSocketAddress>>
+      backends_[kLoadBalancerMaxServerIdLen + 1];
+  std::vector<HashedBackend> hashed_backends_;
+  size_t num_servers_ = 0;
+};
+
+class QUIC_EXPORT_PRIVATE QuicLbForwarder {
+ public:
+  struct QUIC_EXPORT_PRIVATE Options {
+    // Address clients send to. If the port is 0, the kernel picks one, which
+    // listen_address() returns.
+    QuicSocketAddress listen_address;
+    int num_threads = 1;
+    // If true, worker i only runs on CPU i, modulo the number of CPUs.
+    bool pin_threads = false;
+    // Number of connection IDs whose server ID each worker caches.
+    size_t cache_size = kDefaultLoadBalancerRouterCacheSize;
+    // Flows which carried no packet in either direction for this long are
+    // closed.
+    QuicTime::Delta idle_timeout = QuicTime::Delta::FromSeconds(60);
+    // Each flow holds a socket, so the process needs a file descriptor limit
+    // above num_threads * max_flows_per_worker. A worker at the limit closes
+    // the flow which has been idle the longest to make room for a new client,
+    // or refuses the client if all its flows relay packets of the same batch.
+    size_t max_flows_per_worker = 10000;
+    bool use_gro = true;
+    bool use_gso = true;
+  };
+
+  // Counters summed over the workers.
+  struct QUIC_EXPORT_PRIVATE Stats {
+    uint64_t packets_from_clients = 0;
+    uint64_t packets_routed_by_server_id = 0;
+    uint64_t packets_routed_by_hash = 0;
+    uint64_t packets_from_backends = 0;
+    // Packets received on the socket of a flow from an address the flow never
+    // sent to, which were dropped.
+    uint64_t packets_from_unknown_peers = 0;
+    // Packets in either direction which could not be routed or sent.
+    uint64_t packets_dropped = 0;
+    // Number of sendmsg calls in either direction. With GSO, a call sends
+    // several packets.
+    uint64_t writes = 0;
+    uint64_t flows_created = 0;
+    // Flows closed to make room for new ones, before their idle timeout.
+    uint64_t flows_evicted = 0;
+    // New clients whose packets were dropped because their flow could not be
+    // created.
+    uint64_t flows_refused = 0;
+  };
+
+  QuicLbForwarder(const Options& options,
+                  std::unique_ptr<QuicLbRoutingTable> routing_table);
+  QuicLbForwarder(const QuicLbForwarder&) = delete;
+  QuicLbForwarder& operator=(const QuicLbForwarder&) = delete;
+  ~QuicLbForwarder();
+
+  // Creates the listening sockets and starts the worker threads. Returns false
+  // if a socket cannot be created or bound. Must be called at most once.
+  bool Start();
+
+  // Stops the worker threads and closes the sockets of their flows. Stats
+  // remain available.
+  void Stop();
+
+  // Replaces the routing table. Workers switch to the new table before
+  // processing their next packets, and keep their flows: connections keep
+  // reaching their backend as long as its server ID is in the new table.
+  // Thread-safe.
+  void UpdateRoutingTable(std::unique_ptr<QuicLbRoutingTable> routing_table);
+
+  // Valid after Start().
+  const QuicSocketAddress& listen_address() const { return listen_address_; }
+
+  Stats GetStats() const;
+
+ private:
+  class Worker;
+
+  std::shared_ptr<const QuicLbRoutingTable> routing_table() const;
+
+  const Options options_;
+  QuicSocketAddress listen_address_;
+  mutable QuicMutex routing_table_mutex_;
+  std::shared_ptr<const QuicLbRoutingTable> routing_table_
+      QUIC_GUARDED_BY(routing_table_mutex_);
+  // Incremented by each update, so that workers only take the lock when the
+  // table changed.
+  std::atomic<uint64_t> routing_table_generation_{1};
+  std::vector<std::unique_ptr<Worker>> workers_;
+  bool running_ = false;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_QUIC_LB_FORWARDER_H_
@@ -0,0 +1,162 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+// A binary wrapper for QuicLbForwarder. It forwards the QUIC packets received
+// on --port to the backends of --routing_table until it receives SIGINT or
+// SIGTERM. On SIGHUP, it reloads the routing table, and keeps the current one
+// if the file is invalid. See QuicLbRoutingTable for the file format.
+
+#include <signal.h>
+#include <unistd.h>
+
+#include <algorithm>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>  // NOLINT: only used for hardware_concurrency().
+#include <vector>
+
+#include "absl/types/optional.h"
+#include "quiche/quic/core/quic_time.h"
+#include "quiche/quic/platform/api/quic_ip_address.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+#include "quiche/quic/tools/quic_lb_forwarder.h"
+#include "quiche/common/platform/api/quiche_command_line_flags.h"
+#include "quiche/common/platform/api/quiche_file_utils.h"
+#include "quiche/common/platform/api/quiche_system_event_loop.h"
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(int32_t, port, 443,
+                                "The port the forwarder listens on.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(bool, ipv6, false,
+                                "If true, listen on IPv6 instead of IPv4.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    std::string, routing_table, "",
+    "Path of the file listing the QUIC-LB configs and backends.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, num_threads, 0,
+    "Number of worker threads, each with its own socket. 0 runs one per CPU.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(bool, pin_threads, false,
+                                "If true, pin each worker thread to a CPU.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, cache_size, 16384,
+    "Number of connection IDs whose server ID each worker caches.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, idle_timeout_s, 60,
+    "Seconds after which the flow of an idle client is closed.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(
+    int32_t, max_flows_per_worker, 10000,
+    "Number of clients each worker thread relays at most. Each needs a file "
+    "descriptor.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(bool, gro, true,
+                                "If true, receive packets with UDP GRO.");
+
+DEFINE_QUICHE_COMMAND_LINE_FLAG(bool, gso, true,
+                                "If true, send packets with UDP GSO.");
+
+namespace {
+
+std::unique_ptr<quic::QuicLbRoutingTable> LoadRoutingTable(
+    const std::string& path) {
+  absl::optional<std::string> contents = quiche::ReadFileContents(path);
+  if (!contents.has_value()) {
+    QUIC_LOG(ERROR) << "Failed to read " << path;
+    return nullptr;
+  }
+  return quic::QuicLbRoutingTable::Parse(*contents);
+}
+
+}  // namespace
+
+int main(int argc, char* argv[]) {
+  quiche::QuicheSystemEventLoop event_loop("quic_lb_forwarder");
+  const char* usage =
+      "Usage: quic_lb_forwarder --routing_table=<path> [options]";
+  std::vector<std::string> non_option_args =
+      quiche::QuicheParseCommandLineFlags(usage, argc, argv);
+  const std::string path =
+      quiche::GetQuicheCommandLineFlag(FLAGS_routing_table);
+  const int port = quiche::GetQuicheCommandLineFlag(FLAGS_port);
+  if (!non_option_args.empty() || path.empty() || port <= 0 || port > 65535) {
+    quiche::QuichePrintCommandLineFlagHelp(usage);
+    return 1;
+  }
+
+  std::unique_ptr<quic::QuicLbRoutingTable> routing_table =
+      LoadRoutingTable(path);
+  if (routing_table == nullptr) {
+    return 1;
+  }
+
+  quic::QuicLbForwarder::Options options;
+  options.listen_address = quic::QuicSocketAddress(
+      quiche::GetQuicheCommandLineFlag(FLAGS_ipv6)
+          ? quic::QuicIpAddress::Any6()
+          : quic::QuicIpAddress::Any4(),
+      port);
+  options.num_threads = quiche::GetQuicheCommandLineFlag(FLAGS_num_threads);
+  if (options.num_threads <= 0) {
+    options.num_threads = std::max(1u, std::thread::hardware_concurrency());
+  }
+  options.pin_threads = quiche::GetQuicheCommandLineFlag(FLAGS_pin_threads);
+  options.cache_size = quiche::GetQuicheCommandLineFlag(FLAGS_cache_size);
+  options.idle_timeout = quic::QuicTime::Delta::FromSeconds(
+      quiche::GetQuicheCommandLineFlag(FLAGS_idle_timeout_s));
+  options.max_flows_per_worker =
+      quiche::GetQuicheCommandLineFlag(FLAGS_max_flows_per_worker);
+  options.use_gro = quiche::GetQuicheCommandLineFlag(FLAGS_gro);
+  options.use_gso = quiche::GetQuicheCommandLineFlag(FLAGS_gso);
+
+  // Block the signals before starting the workers, which inherit the mask, so
+  // that only sigwait() below receives them.
+  sigset_t signals;
+  sigemptyset(&signals);
+  sigaddset(&signals, SIGHUP);
+  sigaddset(&signals, SIGINT);
+  sigaddset(&signals, SIGTERM);
+  pthread_sigmask(SIG_BLOCK, &signals, nullptr);
+
+  quic::QuicLbForwarder forwarder(options, std::move(routing_table));
+  if (!forwarder.Start()) {
+    return 1;
+  }
+  while (true) {
+    int signal_number;
+    if (sigwait(&signals, &signal_number) != 0 || signal_number != SIGHUP) {
+      break;
+    }
+    routing_table = LoadRoutingTable(path);
+    if (routing_table == nullptr) {
+      QUIC_LOG(ERROR) << "Keeping the current routing table";
+      continue;
+    }
+    QUIC_LOG(INFO) << "Loaded " << routing_table->num_servers()
+                   << " servers from " << path;
+    forwarder.UpdateRoutingTable(std::move(routing_table));
+  }
+  forwarder.Stop();
+
+  const quic::QuicLbForwarder::Stats stats = forwarder.GetStats();
+  std::cout << "Packets from clients: " << stats.packets_from_clients
+            << " (by server ID: " << stats.packets_routed_by_server_id
+            << ", by hash: " << stats.packets_routed_by_hash << ")"
+            << std::endl
+            << "Packets from backends: " << stats.packets_from_backends
+            << " (from unknown peers: " << stats.packets_from_unknown_peers
+            << ")" << std::endl
+            << "Packets dropped: " << stats.packets_dropped << std::endl
+            << "Writes: " << stats.writes << std::endl
+            << "Flows: " << stats.flows_created
+            << " (evicted: " << stats.flows_evicted
+            << ", refused: " << stats.flows_refused << ")" << std::endl;
+  return 0;
+}
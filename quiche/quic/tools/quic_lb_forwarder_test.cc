@@ -0,0 +1,417 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/quic_lb_forwarder.h"
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "absl/strings/string_view.h"
+#include "quiche/quic/core/quic_constants.h"
+#include "quiche/quic/core/quic_udp_socket.h"
+#include "quiche/quic/load_balancer/load_balancer_server_id.h"
+#include "quiche/quic/platform/api/quic_socket_address.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/platform/api/quic_test_loopback.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr char kRoutingTable[] =
+    "# Two configs.\n"
+    "config 0 2 4\n"
+    "config 1 3 8 000102030405060708090a0b0c0d0e0f\n"
+    "\n"
+    "server 0a0b 127.0.0.1:4433\n"
+    "server 0c0d 127.0.0.1:4434  # Trailing comment.\n"
+    "server 010203 [::1]:4435 draining\n";
+
+LoadBalancerServerId MakeServerId(std::vector<uint8_t> bytes) {
+  return *LoadBalancerServerId::Create(absl::MakeConstSpan(bytes));
+}
+
+QuicSocketAddress MakeAddress(absl::string_view ip, uint16_t port) {
+  QuicIpAddress address;
+  QUICHE_CHECK(address.FromString(std::string(ip)));
+  return QuicSocketAddress(address, port);
+}
+
+TEST(QuicLbRoutingTableTest, Parse) {
+  std::unique_ptr<QuicLbRoutingTable> table =
+      QuicLbRoutingTable::Parse(kRoutingTable);
+  ASSERT_NE(table, nullptr);
+  EXPECT_EQ(table->num_servers(), 3u);
+
+  ASSERT_NE(table->GetConfig(0), nullptr);
+  EXPECT_EQ(table->GetConfig(0)->server_id_len(), 2);
+  EXPECT_FALSE(table->GetConfig(0)->IsEncrypted());
+  ASSERT_NE(table->GetConfig(1), nullptr);
+  EXPECT_EQ(table->GetConfig(1)->total_len(), 12);
+  EXPECT_TRUE(table->GetConfig(1)->IsEncrypted());
+  EXPECT_EQ(table->GetConfig(2), nullptr);
+
+  const QuicSocketAddress* backend =
+      table->GetBackend(MakeServerId({0x0c, 0x0d}));
+  ASSERT_NE(backend, nullptr);
+  EXPECT_EQ(*backend, MakeAddress("127.0.0.1", 4434));
+  backend = table->GetBackend(MakeServerId({0x01, 0x02, 0x03}));
+  ASSERT_NE(backend, nullptr);
+  EXPECT_EQ(*backend, MakeAddress("::1", 4435));
+  EXPECT_EQ(table->GetBackend(MakeServerId({0x0a, 0x0c})), nullptr);
+  EXPECT_EQ(table->GetBackend(MakeServerId({0x0a})), nullptr);
+}
+
+TEST(QuicLbRoutingTableTest, ParseInvalid) {
+  const char* kInvalidTables[] = {
+      "bogus\n",
+      "config 3 2 4\n",
+      "config 0 0 4\n",
+      "config 0 2 3\n",
+      "config 0 8 16\n",
+      "config 0 2 4 0011\n",
+      "config 0 2 4 000102030405060708090a0b0c0d0e0z\n",
+      "config 0 2 4\nconfig 0 3 4\n",
+      "config 0 2 4\nserver 0a 127.0.0.1:4433\n",
+      "config 0 2 4\nserver 0a0 127.0.0.1:4433\n",
+      "config 0 2 4\nserver 0a0b 127.0.0.1\n",
+      "config 0 2 4\nserver 0a0b 127.0.0.1:0\n",
+      "config 0 2 4\nserver 0a0b 127.0.0.1:4433 drain\n",
+      "config 0 2 4\nserver 0a0b ::1:4433\n",
+      "config 0 2 4\nserver 0a0b 127.0.0.1:4433\nserver 0a0b 127.0.0.1:4434\n",
+  };
+  for (const char* contents : kInvalidTables) {
+    EXPECT_EQ(QuicLbRoutingTable::Parse(contents), nullptr) << contents;
+  }
+}
+
+TEST(QuicLbRoutingTableTest, SelectBackendIsConsistent) {
+  std::unique_ptr<QuicLbRoutingTable> table = QuicLbRoutingTable::Parse(
+      "config 0 1 4\n"
+      "server 01 127.0.0.1:1001\n"
+      "server 02 127.0.0.1:1002\n"
+      "server 03 127.0.0.1:1003\n"
+      "server 04 127.0.0.1:1004\n");
+  std::unique_ptr<QuicLbRoutingTable> fewer_servers = QuicLbRoutingTable::Parse(
+      "config 0 1 4\n"
+      "server 01 127.0.0.1:1001\n"
+      "server 02 127.0.0.1:1002\n"
+      "server 03 127.0.0.1:1003 draining\n"
+      "server 04 127.0.0.1:1004\n");
+  ASSERT_NE(table, nullptr);
+  ASSERT_NE(fewer_servers, nullptr);
+
+  const QuicSocketAddress self_address = MakeAddress("127.0.0.1", 443);
+  const QuicSocketAddress removed_backend = MakeAddress("127.0.0.1", 1003);
+  int num_moved = 0;
+  for (uint16_t port = 1; port <= 1000; ++port) {
+    const QuicSocketAddress peer_address = MakeAddress("192.0.2.1", port);
+    const QuicSocketAddress backend =
+        table->SelectBackend(peer_address, self_address);
+    EXPECT_EQ(backend, table->SelectBackend(peer_address, self_address));
+    const QuicSocketAddress new_backend =
+        fewer_servers->SelectBackend(peer_address, self_address);
+    EXPECT_NE(new_backend, removed_backend);
+    if (backend == removed_backend) {
+      ++num_moved;
+    } else {
+      // Only the clients of the removed server move.
+      EXPECT_EQ(backend, new_backend);
+    }
+  }
+  // Each server gets about a quarter of the clients.
+  EXPECT_GT(num_moved, 150);
+  EXPECT_LT(num_moved, 350);
+}
+
+TEST(QuicLbRoutingTableTest, SelectBackendWithoutServers) {
+  std::unique_ptr<QuicLbRoutingTable> table = QuicLbRoutingTable::Parse(
+      "config 0 1 4\n"
+      "server 01 127.0.0.1:1001 draining\n");
+  ASSERT_NE(table, nullptr);
+  EXPECT_FALSE(table
+                   ->SelectBackend(MakeAddress("192.0.2.1", 1),
+                                   MakeAddress("127.0.0.1", 443))
+                   .IsInitialized());
+}
+
+// A UDP socket bound to a loopback address.
+class TestSocket {
+ public:
+  TestSocket() {
+    fd_ = api_.Create(TestLoopback().AddressFamilyToInt(),
+                      kDefaultSocketReceiveBuffer,
+                      kDefaultSocketReceiveBuffer);
+    QUICHE_CHECK_NE(fd_, kQuicInvalidSocketFd);
+    QUICHE_CHECK(api_.Bind(fd_, QuicSocketAddress(TestLoopback(), 0)));
+    QUICHE_CHECK_EQ(address_.FromSocket(fd_), 0);
+  }
+  TestSocket(const TestSocket&) = delete;
+  TestSocket& operator=(const TestSocket&) = delete;
+  ~TestSocket() { api_.Destroy(fd_); }
+
+  QuicUdpSocketFd fd() const { return fd_; }
+  const QuicSocketAddress& address() const { return address_; }
+
+  void Send(absl::string_view packet, const QuicSocketAddress& destination) {
+    QuicUdpPacketInfo packet_info;
+    packet_info.SetPeerAddress(destination);
+    EXPECT_EQ(
+        api_.WritePacket(fd_, packet.data(), packet.size(), packet_info).status,
+        WRITE_STATUS_OK);
+  }
+
+  // Returns the next packet, or an empty string if none arrives in time, and
+  // sets |peer_address| to its sender.
+  std::string Receive(QuicSocketAddress* peer_address) {
+    if (!api_.WaitUntilReadable(fd_, QuicTime::Delta::FromSeconds(5))) {
+      return "";
+    }
+    char packet[kMaxIncomingPacketSize];
+    char control[kDefaultUdpPacketControlBufferSize];
+    QuicUdpSocketApi::ReadPacketResult result;
+    result.packet_buffer = BufferSpan(packet, sizeof(packet));
+    result.control_buffer = BufferSpan(control, sizeof(control));
+    api_.ReadPacket(fd_, BitMask64(QuicUdpPacketInfoBit::PEER_ADDRESS),
+                    &result);
+    if (!result.ok) {
+      return "";
+    }
+    *peer_address = result.packet_info.peer_address();
+    return std::string(packet, result.packet_buffer.buffer_len);
+  }
+
+ private:
+  QuicUdpSocketApi api_;
+  QuicUdpSocketFd fd_;
+  QuicSocketAddress address_;
+};
+
+// Returns a short header packet whose connection ID has |config_id|, and
+// server ID |server_id| in plaintext.
+std::string MakeShortHeaderPacket(uint8_t config_id,
+                                  absl::string_view server_id,
+                                  absl::string_view payload) {
+  return absl::StrCat(std::string(1, '\x40'),
+                      std::string(1, static_cast<char>(config_id << 6)),
+                      server_id, "nonc", payload);
+}
+
+class QuicLbForwarderTest : public QuicTest {
+ protected:
+  static QuicLbForwarder::Options DefaultOptions() {
+    QuicLbForwarder::Options options;
+    options.num_threads = 2;
+    return options;
+  }
+
+  std::unique_ptr<QuicLbRoutingTable> MakeRoutingTable(
+      const TestSocket& backend_a, const TestSocket& backend_b,
+      absl::string_view extra_servers = "") {
+    std::unique_ptr<QuicLbRoutingTable> table =
+        QuicLbRoutingTable::Parse(absl::StrCat(
+            "config 0 2 4\n",
+            "server 0a0a ", backend_a.address().ToString(), "\n",
+            "server 0b0b ", backend_b.address().ToString(), " draining\n",
+            extra_servers));
+    QUICHE_CHECK(table != nullptr);
+    return table;
+  }
+
+  std::unique_ptr<QuicLbForwarder> StartForwarder(
+      std::unique_ptr<QuicLbRoutingTable> routing_table,
+      QuicLbForwarder::Options options = DefaultOptions()) {
+    options.listen_address = QuicSocketAddress(TestLoopback(), 0);
+    auto forwarder = std::make_unique<QuicLbForwarder>(
+        options, std::move(routing_table));
+    QUICHE_CHECK(forwarder->Start());
+    return forwarder;
+  }
+
+  TestSocket client_;
+  TestSocket backend_a_;
+  TestSocket backend_b_;
+};
+
+TEST_F(QuicLbForwarderTest, RelaysPacketsInBothDirections) {
+  std::unique_ptr<QuicLbForwarder> forwarder =
+      StartForwarder(MakeRoutingTable(backend_a_, backend_b_));
+
+  // Routed by server ID, to a draining backend.
+  const std::string packet =
+      MakeShortHeaderPacket(0, "\x0b\x0b", "to backend b");
+  client_.Send(packet, forwarder->listen_address());
+  QuicSocketAddress forwarder_flow_address;
+  EXPECT_EQ(backend_b_.Receive(&forwarder_flow_address), packet);
+
+  backend_b_.Send("to client", forwarder_flow_address);
+  QuicSocketAddress peer_address;
+  EXPECT_EQ(client_.Receive(&peer_address), "to client");
+  EXPECT_EQ(peer_address, forwarder->listen_address());
+
+  // Routed by hash, to the only backend which is not draining.
+  const std::string initial_packet("\xc0\x00\x00\x00\x01\x08random88", 14);
+  client_.Send(initial_packet, forwarder->listen_address());
+  QuicSocketAddress same_flow_address;
+  EXPECT_EQ(backend_a_.Receive(&same_flow_address), initial_packet);
+  EXPECT_EQ(same_flow_address, forwarder_flow_address);
+
+  forwarder->Stop();
+  const QuicLbForwarder::Stats stats = forwarder->GetStats();
+  EXPECT_EQ(stats.packets_from_clients, 2u);
+  EXPECT_EQ(stats.packets_routed_by_server_id, 1u);
+  EXPECT_EQ(stats.packets_routed_by_hash, 1u);
+  EXPECT_EQ(stats.packets_from_backends, 1u);
+  EXPECT_EQ(stats.packets_dropped, 0u);
+  EXPECT_EQ(stats.flows_created, 1u);
+}
+
+TEST_F(QuicLbForwarderTest, DropsPacketsFromUnknownPeers) {
+  std::unique_ptr<QuicLbForwarder> forwarder =
+      StartForwarder(MakeRoutingTable(backend_a_, backend_b_));
+  const std::string packet =
+      MakeShortHeaderPacket(0, "\x0a\x0a", "to backend a");
+  client_.Send(packet, forwarder->listen_address());
+  QuicSocketAddress forwarder_flow_address;
+  EXPECT_EQ(backend_a_.Receive(&forwarder_flow_address), packet);
+
+  // Neither an arbitrary host nor a backend the flow did not send to can
+  // reach the client through the flow.
+  TestSocket stranger;
+  stranger.Send("from stranger", forwarder_flow_address);
+  backend_b_.Send("from backend b", forwarder_flow_address);
+  backend_a_.Send("from backend a", forwarder_flow_address);
+  QuicSocketAddress peer_address;
+  EXPECT_EQ(client_.Receive(&peer_address), "from backend a");
+
+  forwarder->Stop();
+  const QuicLbForwarder::Stats stats = forwarder->GetStats();
+  EXPECT_EQ(stats.packets_from_backends, 1u);
+  EXPECT_EQ(stats.packets_from_unknown_peers, 2u);
+}
+
+TEST_F(QuicLbForwarderTest, UpdateRoutingTable) {
+  std::unique_ptr<QuicLbForwarder> forwarder =
+      StartForwarder(MakeRoutingTable(backend_a_, backend_b_));
+  QuicSocketAddress peer_address;
+
+  // Unknown server IDs are routed by hash.
+  const std::string packet =
+      MakeShortHeaderPacket(0, "\x0c\x0c", "to backend c");
+  client_.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_a_.Receive(&peer_address), packet);
+
+  TestSocket backend_c;
+  forwarder->UpdateRoutingTable(
+      MakeRoutingTable(backend_a_, backend_b_,
+                       absl::StrCat("server 0c0c ",
+                                    backend_c.address().ToString(), "\n")));
+  client_.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_c.Receive(&peer_address), packet);
+}
+
+TEST_F(QuicLbForwarderTest, EvictsLeastRecentlyUsedFlow) {
+  QuicLbForwarder::Options options;
+  options.num_threads = 1;
+  options.max_flows_per_worker = 2;
+  std::unique_ptr<QuicLbForwarder> forwarder =
+      StartForwarder(MakeRoutingTable(backend_a_, backend_b_), options);
+  TestSocket client_b;
+  TestSocket client_c;
+  const std::string packet =
+      MakeShortHeaderPacket(0, "\x0a\x0a", "to backend a");
+  QuicSocketAddress flow_a_address;
+  QuicSocketAddress flow_b_address;
+  QuicSocketAddress flow_c_address;
+  QuicSocketAddress peer_address;
+
+  client_.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_a_.Receive(&flow_a_address), packet);
+  client_b.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_a_.Receive(&flow_b_address), packet);
+  // Makes the flow of |client_b| the least recently used.
+  client_.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_a_.Receive(&peer_address), packet);
+  EXPECT_EQ(peer_address, flow_a_address);
+
+  // Exceeds the limit: the flow of |client_b| is closed.
+  client_c.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_a_.Receive(&flow_c_address), packet);
+  EXPECT_NE(flow_c_address, flow_a_address);
+  EXPECT_NE(flow_c_address, flow_b_address);
+
+  // The flow of |client_| survived.
+  backend_a_.Send("to client a", flow_a_address);
+  EXPECT_EQ(client_.Receive(&peer_address), "to client a");
+
+  // |client_b| gets a new flow, and the flow of |client_c| is closed.
+  client_b.Send(packet, forwarder->listen_address());
+  EXPECT_EQ(backend_a_.Receive(&peer_address), packet);
+  EXPECT_NE(peer_address, flow_b_address);
+
+  forwarder->Stop();
+  const QuicLbForwarder::Stats stats = forwarder->GetStats();
+  EXPECT_EQ(stats.flows_created, 4u);
+  EXPECT_EQ(stats.flows_evicted, 2u);
+  EXPECT_EQ(stats.flows_refused, 0u);
+  EXPECT_EQ(stats.packets_dropped, 0u);
+}
+
+TEST_F(QuicLbForwarderTest, BurstFromMoreClientsThanLimit) {
+  QuicLbForwarder::Options options;
+  options.num_threads = 1;
+  options.max_flows_per_worker = 2;
+  std::unique_ptr<QuicLbForwarder> forwarder =
+      StartForwarder(MakeRoutingTable(backend_a_, backend_b_), options);
+  constexpr size_t kNumClients = 8;
+  std::vector<std::unique_ptr<TestSocket>> clients;
+  for (size_t i = 0; i < kNumClients; ++i) {
+    clients.push_back(std::make_unique<TestSocket>());
+  }
+  // Sent back to back, so that the worker likely reads several in one batch.
+  // Flows used by the batch must survive until it is sent.
+  const std::string packet =
+      MakeShortHeaderPacket(0, "\x0a\x0a", "to backend a");
+  for (const auto& client : clients) {
+    client->Send(packet, forwarder->listen_address());
+  }
+  size_t num_received = 0;
+  QuicSocketAddress peer_address;
+  const QuicTime::Delta timeout = QuicTime::Delta::FromMilliseconds(200);
+  while (QuicUdpSocketApi().WaitUntilReadable(backend_a_.fd(), timeout)) {
+    EXPECT_EQ(backend_a_.Receive(&peer_address), packet);
+    ++num_received;
+  }
+
+  forwarder->Stop();
+  const QuicLbForwarder::Stats stats = forwarder->GetStats();
+  EXPECT_EQ(stats.packets_from_clients, kNumClients);
+  EXPECT_EQ(stats.packets_dropped, stats.flows_refused);
+  EXPECT_EQ(num_received + stats.packets_dropped, kNumClients);
+  EXPECT_EQ(stats.flows_created, num_received);
+  EXPECT_LE(stats.flows_created - stats.flows_evicted, 2u);
+}
+
+TEST_F(QuicLbForwarderTest, RefusesFlowsWithoutLimit) {
+  QuicLbForwarder::Options options;
+  options.max_flows_per_worker = 0;
+  std::unique_ptr<QuicLbForwarder> forwarder =
+      StartForwarder(MakeRoutingTable(backend_a_, backend_b_), options);
+  client_.Send(MakeShortHeaderPacket(0, "\x0a\x0a", "to backend a"),
+               forwarder->listen_address());
+  const QuicTime::Delta timeout = QuicTime::Delta::FromMilliseconds(200);
+  EXPECT_FALSE(QuicUdpSocketApi().WaitUntilReadable(backend_a_.fd(), timeout));
+
+  forwarder->Stop();
+  const QuicLbForwarder::Stats stats = forwarder->GetStats();
+  EXPECT_EQ(stats.flows_created, 0u);
+  EXPECT_EQ(stats.flows_refused, 1u);
+  EXPECT_EQ(stats.packets_dropped, 1u);
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
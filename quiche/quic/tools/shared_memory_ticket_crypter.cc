@@ -0,0 +1,298 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/shared_memory_ticket_crypter.h"
+
+#include <errno.h>
+#include <fcntl.h>
+#include <sys/file.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <atomic>
+#include <cstring>
+
+#include "openssl/aead.h"
+#include "openssl/mem.h"
+#include "openssl/rand.h"
+#include "quiche/quic/platform/api/quic_logging.h"
+
+namespace quic {
+
+namespace {
+
+// The format of an encrypted ticket is the same as SimpleTicketCrypter's:
+// 1 byte for the key epoch, followed by 16 bytes of IV, followed by the output
+// from the AES-GCM Seal operation, which has an overhead of 16 bytes for its
+// auth tag.
+constexpr size_t kEpochSize = 1;
+constexpr size_t kIVSize = 16;
+constexpr size_t kAuthTagSize = 16;
+
+// Offsets into the ciphertext to make message parsing easier.
+constexpr size_t kIVOffset = kEpochSize;
+constexpr size_t kMessageOffset = kIVOffset + kIVSize;
+
+// Identifies an initialized file, and changes with its layout.
+constexpr uint64_t kSharedStateMagic = UINT64_C(0x5154494b30310001);
+
+// Offset of the replay filter in the file.
+constexpr size_t kReplayFilterOffset = 256;
+
+// Holds a flock(2) lock on a file for its lifetime.
+class ScopedFileLock {
+ public:
+  // |operation| is LOCK_SH or LOCK_EX.
+  ScopedFileLock(int fd, int operation) : fd_(fd) {
+    while (flock(fd_, operation) != 0) {
+      if (errno != EINTR) {
+        QUIC_LOG(DFATAL) << "flock failed: " << strerror(errno);
+        break;
+      }
+    }
+  }
+  ScopedFileLock(const ScopedFileLock&) = delete;
+  ScopedFileLock& operator=(const ScopedFileLock&) = delete;
+  ~ScopedFileLock() { flock(fd_, LOCK_UN); }
+
+ private:
+  const int fd_;
+};
+
+}  // namespace
+
+// Layout of the start of the shared file. Except for |sequence|, the fields
+// are only accessed while holding a lock on the file: a shared lock to read
+// them, an exclusive one to write them.
+struct SharedMemoryTicketCrypter::SharedState {
+  uint64_t magic;
+  uint64_t replay_filter_num_words;
+  // Incremented whenever the keys change, so that processes only need to take
+  // the lock when they do.
+  std::atomic<uint64_t> sequence;
+  // UNIX time in microseconds when the current key expires.
+  uint64_t rotation_time_us;
+  uint8_t current_epoch;
+  uint8_t has_previous_key;
+  uint8_t current_key[kKeySize];
+  uint8_t previous_key[kKeySize];
+};
+
+static_assert(sizeof(std::atomic<uint64_t>) == sizeof(uint64_t) &&
+                  std::atomic<uint64_t>::is_always_lock_free,
+              "SharedState needs lock free atomics to be shared between "
+              "processes");
+
+// static
+std::unique_ptr<SharedMemoryTicketCrypter> SharedMemoryTicketCrypter::Create(
+    const std::string& path, QuicClock* clock) {
+  return Create(path, clock, Options());
+}
+
+// static
+std::unique_ptr<SharedMemoryTicketCrypter> SharedMemoryTicketCrypter::Create(
+    const std::string& path, QuicClock* clock, const Options& options) {
+  static_assert(sizeof(SharedState) <= kReplayFilterOffset,
+                "SharedState overlaps the replay filter");
+  const size_t mapping_size =
+      kReplayFilterOffset +
+      ZeroRttReplayFilter::MemorySize(options.replay_filter_num_words);
+
+  const int fd = open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0600);
+  if (fd < 0) {
+    QUIC_LOG(ERROR) << "Failed to open " << path << ": " << strerror(errno);
+    return nullptr;
+  }
+
+  void* mapping = MAP_FAILED;
+  {
+    ScopedFileLock lock(fd, LOCK_EX);
+    struct stat file_stat;
+    if (fstat(fd, &file_stat) != 0) {
+      QUIC_LOG(ERROR) << "Failed to stat " << path << ": " << strerror(errno);
+    } else if (file_stat.st_size == 0 && ftruncate(fd, mapping_size) != 0) {
+      // A new file: ftruncate zero-fills it, as the replay filter requires.
+      QUIC_LOG(ERROR) << "Failed to resize " << path << ": "
+                      << strerror(errno);
+    } else if (file_stat.st_size != 0 &&
+               static_cast<size_t>(file_stat.st_size) != mapping_size) {
+      QUIC_LOG(ERROR) << path << " has " << file_stat.st_size
+                      << " bytes instead of " << mapping_size
+                      << ", it is used with different options";
+    } else {
+      mapping = mmap(nullptr, mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED,
+                     fd, 0);
+      if (mapping == MAP_FAILED) {
+        QUIC_LOG(ERROR) << "Failed to map " << path << ": " << strerror(errno);
+      }
+    }
+
+    if (mapping != MAP_FAILED) {
+      auto* state = static_cast<SharedState*>(mapping);
+      if (state->magic != kSharedStateMagic) {
+        // This is the first process to use the file.
+        state->replay_filter_num_words = options.replay_filter_num_words;
+        RAND_bytes(&state->current_epoch, 1);
+        RAND_bytes(state->current_key, kKeySize);
+        state->has_previous_key = 0;
+        state->rotation_time_us = clock->WallNow()
+                                      .Add(options.key_lifetime)
+                                      .ToUNIXMicroseconds();
+        state->sequence.store(1, std::memory_order_release);
+        state->magic = kSharedStateMagic;
+      } else if (state->replay_filter_num_words !=
+                 options.replay_filter_num_words) {
+        QUIC_LOG(ERROR) << path << " is used with different options";
+        munmap(mapping, mapping_size);
+        mapping = MAP_FAILED;
+      }
+    }
+  }
+
+  if (mapping == MAP_FAILED) {
+    close(fd);
+    return nullptr;
+  }
+  return std::unique_ptr<SharedMemoryTicketCrypter>(
+      new SharedMemoryTicketCrypter(fd, mapping, mapping_size, clock, options));
+}
+
+SharedMemoryTicketCrypter::SharedMemoryTicketCrypter(int fd, void* mapping,
+                                                     size_t mapping_size,
+                                                     QuicClock* clock,
+                                                     const Options& options)
+    : fd_(fd),
+      mapping_(mapping),
+      mapping_size_(mapping_size),
+      clock_(clock),
+      key_lifetime_(options.key_lifetime),
+      replay_filter_(static_cast<char*>(mapping) + kReplayFilterOffset,
+                     options.replay_filter_num_words, options.replay_window) {
+  LoadKeys();
+}
+
+SharedMemoryTicketCrypter::~SharedMemoryTicketCrypter() {
+  munmap(mapping_, mapping_size_);
+  close(fd_);
+}
+
+size_t SharedMemoryTicketCrypter::MaxOverhead() {
+  return kEpochSize + kIVSize + kAuthTagSize;
+}
+
+std::vector<uint8_t> SharedMemoryTicketCrypter::Encrypt(
+    absl::string_view in, absl::string_view encryption_key) {
+  // The keys come from the shared file; a per-connection |encryption_key|
+  // from a ProofSourceHandle is not supported.
+  QUICHE_DCHECK(encryption_key.empty());
+  MaybeRefreshKeys();
+  std::vector<uint8_t> out(in.size() + MaxOverhead());
+  out[0] = current_epoch_;
+  RAND_bytes(out.data() + kIVOffset, kIVSize);
+  size_t out_len;
+  if (!EVP_AEAD_CTX_seal(current_aead_ctx_.get(), out.data() + kMessageOffset,
+                         &out_len, out.size() - kMessageOffset,
+                         out.data() + kIVOffset, kIVSize,
+                         reinterpret_cast<const uint8_t*>(in.data()),
+                         in.size(), nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  out.resize(out_len + kMessageOffset);
+  return out;
+}
+
+std::vector<uint8_t> SharedMemoryTicketCrypter::Decrypt(absl::string_view in) {
+  MaybeRefreshKeys();
+  if (in.size() < kMessageOffset) {
+    return std::vector<uint8_t>();
+  }
+  const uint8_t* input = reinterpret_cast<const uint8_t*>(in.data());
+  const EVP_AEAD_CTX* ctx = current_aead_ctx_.get();
+  if (input[0] != current_epoch_) {
+    if (input[0] == static_cast<uint8_t>(current_epoch_ - 1) &&
+        has_previous_key_) {
+      ctx = previous_aead_ctx_.get();
+    } else {
+      return std::vector<uint8_t>();
+    }
+  }
+  std::vector<uint8_t> out(in.size() - kMessageOffset);
+  size_t out_len;
+  if (!EVP_AEAD_CTX_open(ctx, out.data(), &out_len, out.size(),
+                         input + kIVOffset, kIVSize, input + kMessageOffset,
+                         in.size() - kMessageOffset, nullptr, 0)) {
+    return std::vector<uint8_t>();
+  }
+  out.resize(out_len);
+  return out;
+}
+
+void SharedMemoryTicketCrypter::Decrypt(
+    absl::string_view in,
+    std::shared_ptr<quic::ProofSource::DecryptCallback> callback) {
+  callback->Run(Decrypt(in));
+}
+
+bool SharedMemoryTicketCrypter::ShouldAcceptEarlyData(
+    absl::string_view ticket) {
+  return replay_filter_.CheckAndInsert(ticket, clock_->WallNow());
+}
+
+void SharedMemoryTicketCrypter::MaybeRefreshKeys() {
+  const QuicWallTime now = clock_->WallNow();
+  if (!now.IsBefore(loaded_rotation_time_)) {
+    ScopedFileLock lock(fd_, LOCK_EX);
+    SharedState* state = shared_state();
+    // Another process may have rotated the keys since they were loaded.
+    if (now.ToUNIXMicroseconds() >= state->rotation_time_us) {
+      memcpy(state->previous_key, state->current_key, kKeySize);
+      state->has_previous_key = 1;
+      RAND_bytes(state->current_key, kKeySize);
+      ++state->current_epoch;
+      state->rotation_time_us = now.Add(key_lifetime_).ToUNIXMicroseconds();
+      state->sequence.fetch_add(1, std::memory_order_release);
+    }
+  }
+  if (shared_state()->sequence.load(std::memory_order_acquire) !=
+      loaded_sequence_) {
+    LoadKeys();
+  }
+}
+
+void SharedMemoryTicketCrypter::LoadKeys() {
+  uint8_t current_key[kKeySize];
+  uint8_t previous_key[kKeySize];
+  {
+    ScopedFileLock lock(fd_, LOCK_SH);
+    const SharedState* state = shared_state();
+    loaded_sequence_ = state->sequence.load(std::memory_order_relaxed);
+    loaded_rotation_time_ =
+        QuicWallTime::FromUNIXMicroseconds(state->rotation_time_us);
+    current_epoch_ = state->current_epoch;
+    has_previous_key_ = state->has_previous_key != 0;
+    memcpy(current_key, state->current_key, kKeySize);
+    memcpy(previous_key, state->previous_key, kKeySize);
+  }
+
+  current_aead_ctx_.Reset();
+  EVP_AEAD_CTX_init(current_aead_ctx_.get(), EVP_aead_aes_128_gcm(),
+                    current_key, kKeySize, EVP_AEAD_DEFAULT_TAG_LENGTH,
+                    nullptr);
+  previous_aead_ctx_.Reset();
+  if (has_previous_key_) {
+    EVP_AEAD_CTX_init(previous_aead_ctx_.get(), EVP_aead_aes_128_gcm(),
+                      previous_key, kKeySize, EVP_AEAD_DEFAULT_TAG_LENGTH,
+                      nullptr);
+  }
+  OPENSSL_cleanse(current_key, kKeySize);
+  OPENSSL_cleanse(previous_key, kKeySize);
+}
+
+SharedMemoryTicketCrypter::SharedState*
+SharedMemoryTicketCrypter::shared_state() const {
+  return static_cast<SharedState*>(mapping_);
+}
+
+}  // namespace quic
@@ -0,0 +1,105 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_QUIC_TOOLS_SHARED_MEMORY_TICKET_CRYPTER_H_
+#define QUICHE_QUIC_TOOLS_SHARED_MEMORY_TICKET_CRYPTER_H_
+
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "openssl/aead.h"
+#include "quiche/quic/core/crypto/proof_source.h"
+#include "quiche/quic/core/crypto/zero_rtt_replay_filter.h"
+#include "quiche/quic/core/quic_clock.h"
+#include "quiche/quic/core/quic_time.h"
+
+namespace quic {
+
+// SharedMemoryTicketCrypter implements the QUIC ProofSource::TicketCrypter
+// interface with keys kept in a memory mapped file, so that all the processes
+// of a server which map the same file can resume each other's sessions. Like
+// SimpleTicketCrypter, it rotates the key every |key_lifetime| and keeps the
+// previous key to decrypt older tickets; whichever process first notices that
+// the current key expired generates the next one.
+//
+// The file also holds a ZeroRttReplayFilter shared by all the processes, which
+// ShouldAcceptEarlyData consults so that a ticket replayed to another process
+// does not get its early data accepted again.
+//
+// The file holds the ticket keys in the clear: it should be on a tmpfs, e.g.
+// under /dev/shm, only readable by the server. A SharedMemoryTicketCrypter is
+// not thread safe; each thread of a process should create its own.
+class QUIC_NO_EXPORT SharedMemoryTicketCrypter
+    : public quic::ProofSource::TicketCrypter {
+ public:
+  struct QUIC_NO_EXPORT Options {
+    QuicTime::Delta key_lifetime =
+        QuicTime::Delta::FromSeconds(60 * 60 * 24 * 7);
+    // Number of 64-bit words in each generation of the replay filter, about
+    // the number of tickets used for early data expected per |replay_window|.
+    size_t replay_filter_num_words = 1 << 17;
+    // BoringSSL accepts early data from tickets whose age is off by up to a
+    // minute either way, so a replay can arrive up to two minutes later.
+    QuicTime::Delta replay_window = QuicTime::Delta::FromSeconds(120);
+  };
+
+  // Maps the file at |path|, creating and initializing it if needed. All the
+  // processes sharing the file must use the same |options|. Returns nullptr
+  // on failure.
+  static std::unique_ptr<SharedMemoryTicketCrypter> Create(
+      const std::string& path, QuicClock* clock, const Options& options);
+  static std::unique_ptr<SharedMemoryTicketCrypter> Create(
+      const std::string& path, QuicClock* clock);
+
+  ~SharedMemoryTicketCrypter() override;
+
+  size_t MaxOverhead() override;
+  std::vector<uint8_t> Encrypt(absl::string_view in,
+                               absl::string_view encryption_key) override;
+  void Decrypt(
+      absl::string_view in,
+      std::shared_ptr<quic::ProofSource::DecryptCallback> callback) override;
+  bool ShouldAcceptEarlyData(absl::string_view ticket) override;
+
+ private:
+  struct SharedState;
+
+  static constexpr size_t kKeySize = 16;
+
+  SharedMemoryTicketCrypter(int fd, void* mapping, size_t mapping_size,
+                            QuicClock* clock, const Options& options);
+
+  std::vector<uint8_t> Decrypt(absl::string_view in);
+
+  // Rotates the shared keys if they expired, then reloads them into the AEAD
+  // contexts below if another process rotated them.
+  void MaybeRefreshKeys();
+
+  // Reads the shared keys into the AEAD contexts below.
+  void LoadKeys();
+
+  SharedState* shared_state() const;
+
+  const int fd_;
+  void* const mapping_;
+  const size_t mapping_size_;
+  QuicClock* const clock_;
+  const QuicTime::Delta key_lifetime_;
+  ZeroRttReplayFilter replay_filter_;
+
+  // Copy of the shared keys as of |loaded_sequence_|.
+  uint64_t loaded_sequence_ = 0;
+  QuicWallTime loaded_rotation_time_ = QuicWallTime::Zero();
+  uint8_t current_epoch_ = 0;
+  bssl::ScopedEVP_AEAD_CTX current_aead_ctx_;
+  bool has_previous_key_ = false;
+  bssl::ScopedEVP_AEAD_CTX previous_aead_ctx_;
+};
+
+}  // namespace quic
+
+#endif  // QUICHE_QUIC_TOOLS_SHARED_MEMORY_TICKET_CRYPTER_H_
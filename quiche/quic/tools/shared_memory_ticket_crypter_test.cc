@@ -0,0 +1,172 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/quic/tools/shared_memory_ticket_crypter.h"
+
+#include <unistd.h>
+
+#include <memory>
+#include <string>
+#include <vector>
+
+#include "absl/strings/str_cat.h"
+#include "quiche/quic/platform/api/quic_test.h"
+#include "quiche/quic/test_tools/mock_clock.h"
+
+namespace quic {
+namespace test {
+namespace {
+
+constexpr QuicTime::Delta kOneDay = QuicTime::Delta::FromSeconds(60 * 60 * 24);
+
+class DecryptCallback : public quic::ProofSource::DecryptCallback {
+ public:
+  explicit DecryptCallback(std::vector<uint8_t>* out) : out_(out) {}
+
+  void Run(std::vector<uint8_t> plaintext) override { *out_ = plaintext; }
+
+ private:
+  std::vector<uint8_t>* out_;
+};
+
+absl::string_view StringPiece(const std::vector<uint8_t>& in) {
+  return absl::string_view(reinterpret_cast<const char*>(in.data()), in.size());
+}
+
+std::vector<uint8_t> Decrypt(SharedMemoryTicketCrypter* crypter,
+                             const std::vector<uint8_t>& ciphertext) {
+  std::vector<uint8_t> plaintext;
+  crypter->Decrypt(StringPiece(ciphertext),
+                   std::make_unique<DecryptCallback>(&plaintext));
+  return plaintext;
+}
+
+class SharedMemoryTicketCrypterTest : public QuicTest {
+ public:
+  SharedMemoryTicketCrypterTest()
+      : path_(absl::StrCat(
+            ::testing::TempDir(), "/shared_memory_ticket_crypter_",
+            ::testing::UnitTest::GetInstance()->current_test_info()->name())) {
+    unlink(path_.c_str());
+    mock_clock_.AdvanceTime(QuicTime::Delta::FromSeconds(1000));
+    options_.key_lifetime = kOneDay;
+    options_.replay_filter_num_words = 1024;
+    options_.replay_window = QuicTime::Delta::FromSeconds(10);
+  }
+
+  ~SharedMemoryTicketCrypterTest() override { unlink(path_.c_str()); }
+
+  // Creates a crypter over the shared file, as another server process would.
+  std::unique_ptr<SharedMemoryTicketCrypter> CreateCrypter() {
+    return SharedMemoryTicketCrypter::Create(path_, &mock_clock_, options_);
+  }
+
+ protected:
+  const std::string path_;
+  MockClock mock_clock_;
+  SharedMemoryTicketCrypter::Options options_;
+};
+
+TEST_F(SharedMemoryTicketCrypterTest, EncryptDecrypt) {
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter = CreateCrypter();
+  ASSERT_NE(nullptr, crypter);
+  std::vector<uint8_t> plaintext = {1, 2, 3, 4, 5};
+  std::vector<uint8_t> ciphertext =
+      crypter->Encrypt(StringPiece(plaintext), {});
+  EXPECT_NE(plaintext, ciphertext);
+  EXPECT_EQ(plaintext, Decrypt(crypter.get(), ciphertext));
+}
+
+TEST_F(SharedMemoryTicketCrypterTest, DecryptWithOtherProcess) {
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter1 = CreateCrypter();
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter2 = CreateCrypter();
+  ASSERT_NE(nullptr, crypter1);
+  ASSERT_NE(nullptr, crypter2);
+
+  std::vector<uint8_t> plaintext = {1, 2, 3, 4, 5};
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter2.get(),
+                    crypter1->Encrypt(StringPiece(plaintext), {})));
+  EXPECT_EQ(plaintext,
+            Decrypt(crypter1.get(),
+                    crypter2->Encrypt(StringPiece(plaintext), {})));
+}
+
+TEST_F(SharedMemoryTicketCrypterTest, DecryptionFailureWithModifiedCiphertext) {
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter = CreateCrypter();
+  ASSERT_NE(nullptr, crypter);
+  std::vector<uint8_t> plaintext = {1, 2, 3, 4, 5};
+  std::vector<uint8_t> ciphertext =
+      crypter->Encrypt(StringPiece(plaintext), {});
+
+  // Check that a bit flip in any byte will cause a decryption failure.
+  for (size_t i = 0; i < ciphertext.size(); i++) {
+    SCOPED_TRACE(i);
+    std::vector<uint8_t> munged_ciphertext = ciphertext;
+    munged_ciphertext[i] ^= 1;
+    EXPECT_TRUE(Decrypt(crypter.get(), munged_ciphertext).empty());
+  }
+}
+
+TEST_F(SharedMemoryTicketCrypterTest, KeyRotationIsShared) {
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter1 = CreateCrypter();
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter2 = CreateCrypter();
+  ASSERT_NE(nullptr, crypter1);
+  ASSERT_NE(nullptr, crypter2);
+  std::vector<uint8_t> plaintext = {1, 2, 3, 4, 5};
+  std::vector<uint8_t> old_ciphertext =
+      crypter1->Encrypt(StringPiece(plaintext), {});
+
+  // crypter1 rotates the key. crypter2 picks up the new key, and both can
+  // still decrypt tickets encrypted with the previous one.
+  mock_clock_.AdvanceTime(kOneDay + QuicTime::Delta::FromSeconds(1));
+  std::vector<uint8_t> new_ciphertext =
+      crypter1->Encrypt(StringPiece(plaintext), {});
+  EXPECT_NE(old_ciphertext[0], new_ciphertext[0]);
+  EXPECT_EQ(plaintext, Decrypt(crypter2.get(), new_ciphertext));
+  EXPECT_EQ(plaintext, Decrypt(crypter2.get(), old_ciphertext));
+  EXPECT_EQ(plaintext, Decrypt(crypter1.get(), old_ciphertext));
+
+  // After a second rotation, tickets from the first key are rejected.
+  mock_clock_.AdvanceTime(kOneDay + QuicTime::Delta::FromSeconds(1));
+  EXPECT_TRUE(Decrypt(crypter2.get(), old_ciphertext).empty());
+  EXPECT_EQ(plaintext, Decrypt(crypter1.get(), new_ciphertext));
+}
+
+TEST_F(SharedMemoryTicketCrypterTest, RejectsReplayedEarlyData) {
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter1 = CreateCrypter();
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter2 = CreateCrypter();
+  ASSERT_NE(nullptr, crypter1);
+  ASSERT_NE(nullptr, crypter2);
+
+  EXPECT_TRUE(crypter1->ShouldAcceptEarlyData("ticket 1"));
+  EXPECT_FALSE(crypter2->ShouldAcceptEarlyData("ticket 1"));
+  EXPECT_FALSE(crypter1->ShouldAcceptEarlyData("ticket 1"));
+  EXPECT_TRUE(crypter2->ShouldAcceptEarlyData("ticket 2"));
+}
+
+TEST_F(SharedMemoryTicketCrypterTest, MismatchedOptions) {
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter = CreateCrypter();
+  ASSERT_NE(nullptr, crypter);
+  options_.replay_filter_num_words *= 2;
+  EXPECT_EQ(nullptr, CreateCrypter());
+}
+
+TEST_F(SharedMemoryTicketCrypterTest, ReopenKeepsKeys) {
+  std::vector<uint8_t> plaintext = {1, 2, 3, 4, 5};
+  std::vector<uint8_t> ciphertext;
+  {
+    std::unique_ptr<SharedMemoryTicketCrypter> crypter = CreateCrypter();
+    ASSERT_NE(nullptr, crypter);
+    ciphertext = crypter->Encrypt(StringPiece(plaintext), {});
+  }
+  // A restarted process keeps resuming sessions.
+  std::unique_ptr<SharedMemoryTicketCrypter> crypter = CreateCrypter();
+  ASSERT_NE(nullptr, crypter);
+  EXPECT_EQ(plaintext, Decrypt(crypter.get(), ciphertext));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace quic
@@ -85,6 +85,12 @@ class QUICHE_EXPORT_PRIVATE HpackDecoderAdapter {
   // accepted.
   void set_max_header_block_bytes(size_t max_header_block_bytes);
 
+  // Enables caching of decoded Huffman encoded literals in |cache|, which may
+  // be shared with other decoders.  |cache| must outlive this object.
+  void set_huffman_literal_cache(http2::HpackHuffmanLiteralCache* cache) {
+    hpack_decoder_.set_huffman_literal_cache(cache);
+  }
+
   // Error code if an error has occurred, Error::kOk otherwise.
   http2::HpackDecodingError error() const { return error_; }
 
@@ -119,27 +119,47 @@ void HpackEncoder::ApplyHeaderTableSizeSetting(size_t size_setting) {
   should_emit_table_size_ = true;
 }
 
+void HpackEncoder::SetIndexingPolicy(
+    std::unique_ptr<HpackIndexingPolicyInterface> policy) {
+  indexing_policy_ = std::move(policy);
+  HpackIndexingPolicyInterface* indexing_policy = indexing_policy_.get();
+  should_index_ = [this, indexing_policy](absl::string_view name,
+                                          absl::string_view value) {
+    return indexing_policy->ShouldIndex(name, value, header_table_.max_size());
+  };
+}
+
 std::string HpackEncoder::EncodeRepresentations(RepresentationIterator* iter) {
   MaybeEmitTableSize();
   while (iter->HasNext()) {
-    const auto header = iter->Next();
-    listener_(header.first, header.second);
-    if (enable_compression_) {
-      size_t index =
-          header_table_.GetByNameAndValue(header.first, header.second);
-      if (index != kHpackEntryNotFound) {
-        EmitIndex(index);
-      } else if (should_index_(header.first, header.second)) {
-        EmitIndexedLiteral(header);
-      } else {
-        EmitNonIndexedLiteral(header, enable_compression_);
-      }
+    EncodeRepresentation(iter->Next());
+  }
+
+  return output_stream_.TakeString();
+}
+
+void HpackEncoder::EncodeRepresentation(const Representation& header) {
+  listener_(header.first, header.second);
+  const size_t initial_size = output_stream_.size();
+  if (enable_compression_) {
+    size_t index = header_table_.GetByNameAndValue(header.first, header.second);
+    if (index != kHpackEntryNotFound) {
+      EmitIndex(index);
+      ++stats_.num_indexed;
+    } else if (should_index_(header.first, header.second)) {
+      EmitIndexedLiteral(header);
+      ++stats_.num_literal_with_indexing;
     } else {
       EmitNonIndexedLiteral(header, enable_compression_);
+      ++stats_.num_literal_without_indexing;
     }
+  } else {
+    EmitNonIndexedLiteral(header, enable_compression_);
+    ++stats_.num_literal_without_indexing;
   }
-
-  return output_stream_.TakeString();
+  ++stats_.num_header_fields;
+  stats_.uncompressed_bytes += header.first.size() + header.second.size();
+  stats_.encoded_bytes += output_stream_.size() - initial_size;
 }
 
 void HpackEncoder::EmitIndex(size_t index) {
@@ -335,26 +355,11 @@ HpackEncoder::Encoderator::Encoderator(const Representations& representations,
 std::string HpackEncoder::Encoderator::Next(size_t max_encoded_bytes) {
   QUICHE_BUG_IF(spdy_bug_61_1, !has_next_)
       << "Encoderator::Next called with nothing left to encode.";
-  const bool enable_compression = encoder_->enable_compression_;
 
   // Encode up to max_encoded_bytes of headers.
   while (header_it_->HasNext() &&
          encoder_->output_stream_.size() <= max_encoded_bytes) {
-    const Representation header = header_it_->Next();
-    encoder_->listener_(header.first, header.second);
-    if (enable_compression) {
-      size_t index = encoder_->header_table_.GetByNameAndValue(header.first,
-                                                               header.second);
-      if (index != kHpackEntryNotFound) {
-        encoder_->EmitIndex(index);
-      } else if (encoder_->should_index_(header.first, header.second)) {
-        encoder_->EmitIndexedLiteral(header);
-      } else {
-        encoder_->EmitNonIndexedLiteral(header, enable_compression);
-      }
-    } else {
-      encoder_->EmitNonIndexedLiteral(header, enable_compression);
-    }
+    encoder_->EncodeRepresentation(header_it_->Next());
   }
 
   has_next_ = encoder_->output_stream_.size() > max_encoded_bytes;
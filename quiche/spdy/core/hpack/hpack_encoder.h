@@ -17,6 +17,7 @@
 #include "absl/strings/string_view.h"
 #include "quiche/common/platform/api/quiche_export.h"
 #include "quiche/spdy/core/hpack/hpack_header_table.h"
+#include "quiche/spdy/core/hpack/hpack_indexing_policy.h"
 #include "quiche/spdy/core/hpack/hpack_output_stream.h"
 #include "quiche/spdy/core/spdy_protocol.h"
 
@@ -44,6 +45,31 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
   using IndexingPolicy =
       std::function<bool(absl::string_view, absl::string_view)>;
 
+  // Counters describing how well this encoder has compressed the header
+  // fields it has processed so far.
+  struct QUICHE_EXPORT_PRIVATE Stats {
+    // Number of header field representations emitted, after cookie crumbling.
+    size_t num_header_fields = 0;
+    // Of those, fields encoded as a static or dynamic table index, as a
+    // literal inserted into the dynamic table, and as a literal not inserted.
+    size_t num_indexed = 0;
+    size_t num_literal_with_indexing = 0;
+    size_t num_literal_without_indexing = 0;
+    // Sum of the lengths of names and values, before encoding.
+    size_t uncompressed_bytes = 0;
+    // Bytes emitted for the header field representations, excluding dynamic
+    // table size updates.
+    size_t encoded_bytes = 0;
+
+    // Returns encoded_bytes / uncompressed_bytes, or 1 if nothing has been
+    // encoded yet.
+    double CompressionRatio() const {
+      return uncompressed_bytes == 0
+                 ? 1.0
+                 : static_cast<double>(encoded_bytes) / uncompressed_bytes;
+    }
+  };
+
   HpackEncoder();
   HpackEncoder(const HpackEncoder&) = delete;
   HpackEncoder& operator=(const HpackEncoder&) = delete;
@@ -88,6 +114,11 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
   // name-value pairs into the dynamic table.
   void SetIndexingPolicy(IndexingPolicy policy) { should_index_ = policy; }
 
+  // This HpackEncoder will use |policy|, which may keep per-connection state,
+  // to determine whether to insert header name-value pairs into the dynamic
+  // table.  See HpackAdaptiveIndexingPolicy.
+  void SetIndexingPolicy(std::unique_ptr<HpackIndexingPolicyInterface> policy);
+
   // |listener| will be invoked for each header name-value pair processed by
   // this encoder.
   void SetHeaderListener(HeaderListener listener) { listener_ = listener; }
@@ -98,6 +129,8 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
   // overhead mentioned in RFC 7541 section 4.1.
   size_t GetDynamicTableSize() const { return header_table_.size(); }
 
+  const Stats& stats() const { return stats_; }
+
  private:
   friend class test::HpackEncoderPeer;
 
@@ -107,6 +140,9 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
   // Encodes a sequence of header name-value pairs as a single header block.
   std::string EncodeRepresentations(RepresentationIterator* iter);
 
+  // Encodes a single header name-value pair and updates |stats_|.
+  void EncodeRepresentation(const Representation& header);
+
   // Emits a static/dynamic indexed representation (Section 7.1).
   void EmitIndex(size_t index);
 
@@ -137,8 +173,10 @@ class QUICHE_EXPORT_PRIVATE HpackEncoder {
   size_t min_table_size_setting_received_;
   HeaderListener listener_;
   IndexingPolicy should_index_;
+  std::unique_ptr<HpackIndexingPolicyInterface> indexing_policy_;
   bool enable_compression_;
   bool should_emit_table_size_;
+  Stats stats_;
 };
 
 }  // namespace spdy
@@ -10,6 +10,7 @@
 #include "quiche/http2/hpack/huffman/hpack_huffman_encoder.h"
 #include "quiche/http2/test_tools/http2_random.h"
 #include "quiche/common/platform/api/quiche_test.h"
+#include "quiche/spdy/core/hpack/hpack_indexing_policy.h"
 #include "quiche/spdy/core/hpack/hpack_static_table.h"
 #include "quiche/spdy/core/spdy_simple_arena.h"
 
@@ -749,6 +750,59 @@ TEST_P(HpackEncoderTest, HeaderTableSizeUpdatesWithGreaterSize) {
   EXPECT_EQ(new_entry->value(), "value3");
 }
 
+TEST_P(HpackEncoderTest, Stats) {
+  ExpectIndex(DynamicIndexToWireIndex(key_1_index_));
+  ExpectIndexedLiteral("key3", "value3");
+  encoder_.SetIndexingPolicy(
+      [](absl::string_view name, absl::string_view /*value*/) {
+        return name != "key4";
+      });
+  ExpectNonIndexedLiteral("key4", "value4");
+
+  SpdyHeaderBlock headers;
+  headers["key1"] = "value1";
+  headers["key3"] = "value3";
+  headers["key4"] = "value4";
+  const std::string expected_out = expected_.TakeString();
+  expected_.AppendBytes(expected_out);
+  CompareWithExpectedEncoding(headers);
+
+  const HpackEncoder::Stats& stats = encoder_.stats();
+  EXPECT_EQ(3u, stats.num_header_fields);
+  EXPECT_EQ(1u, stats.num_indexed);
+  EXPECT_EQ(1u, stats.num_literal_with_indexing);
+  EXPECT_EQ(1u, stats.num_literal_without_indexing);
+  EXPECT_EQ(30u, stats.uncompressed_bytes);
+  EXPECT_EQ(expected_out.size(), stats.encoded_bytes);
+  EXPECT_DOUBLE_EQ(expected_out.size() / 30.0, stats.CompressionRatio());
+}
+
+TEST_P(HpackEncoderTest, AdaptiveIndexingPolicy) {
+  peer_.table()->SetMaxSize(4096);
+  encoder_.SetIndexingPolicy(std::make_unique<HpackAdaptiveIndexingPolicy>());
+  const std::string token = "3f2504e0-4f89-11d3-9a0c-0305e82c3301";
+
+  // A random-looking value is not indexed the first time it is seen...
+  ExpectNonIndexedLiteral("x-token", token);
+  ExpectNonIndexedLiteralWithNameIndex(peer_.table()->GetByName("date"),
+                                       "Mon, 17 Oct 2022 10:00:00 GMT");
+  SpdyHeaderBlock headers;
+  headers["x-token"] = token;
+  headers["date"] = "Mon, 17 Oct 2022 10:00:00 GMT";
+  CompareWithExpectedEncoding(headers);
+
+  // ...but it is once it repeats.  Dates are never indexed.
+  ExpectIndexedLiteral("x-token", token);
+  ExpectNonIndexedLiteralWithNameIndex(peer_.table()->GetByName("date"),
+                                       "Mon, 17 Oct 2022 10:00:01 GMT");
+  headers["date"] = "Mon, 17 Oct 2022 10:00:01 GMT";
+  CompareWithExpectedEncoding(headers);
+
+  ExpectIndex(DynamicIndexToWireIndex(dynamic_table_insertions_++));
+  headers.erase("date");
+  CompareWithExpectedEncoding(headers);
+}
+
 }  // namespace
 
 }  // namespace spdy
@@ -0,0 +1,142 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/spdy/core/hpack/hpack_indexing_policy.h"
+
+#include <algorithm>
+#include <utility>
+
+#include "absl/hash/hash.h"
+#include "absl/strings/ascii.h"
+#include "quiche/spdy/core/hpack/hpack_constants.h"
+#include "quiche/spdy/core/hpack/hpack_entry.h"
+
+namespace spdy {
+
+uint32_t HpackFrequencySketch::Increment(uint64_t hash) {
+  uint32_t estimate = 255;
+  for (size_t row = 0; row < kDepth; ++row) {
+    uint8_t& counter = counters_[row][Column(hash, row)];
+    if (counter < 255) {
+      ++counter;
+    }
+    estimate = std::min<uint32_t>(estimate, counter);
+  }
+  return estimate;
+}
+
+uint32_t HpackFrequencySketch::Estimate(uint64_t hash) const {
+  uint32_t estimate = 255;
+  for (size_t row = 0; row < kDepth; ++row) {
+    estimate = std::min<uint32_t>(estimate, counters_[row][Column(hash, row)]);
+  }
+  return estimate;
+}
+
+void HpackFrequencySketch::Decay() {
+  for (auto& row : counters_) {
+    for (uint8_t& counter : row) {
+      counter >>= 1;
+    }
+  }
+}
+
+bool HpackAdaptiveIndexingPolicy::ShouldIndex(absl::string_view name,
+                                              absl::string_view value,
+                                              size_t dynamic_table_capacity) {
+  if (name.empty()) {
+    return false;
+  }
+  // :authority is always present and rarely changes, while the other
+  // pseudo-headers either are in the static table or vary per request.
+  if (name[0] == kPseudoHeaderPrefix) {
+    return name == ":authority";
+  }
+
+  const size_t entry_size =
+      name.size() + value.size() + kHpackEntrySizeOverhead;
+  if (entry_size >
+      options_.max_entry_fraction_of_table * dynamic_table_capacity) {
+    return false;
+  }
+  if (IsUniquePerMessageHeader(name)) {
+    return false;
+  }
+
+  if (++observations_since_decay_ >= options_.decay_interval) {
+    sketch_.Decay();
+    observations_since_decay_ = 0;
+  }
+  const uint32_t occurrences = sketch_.Increment(
+      absl::Hash<std::pair<absl::string_view, absl::string_view>>()(
+          std::make_pair(name, value)));
+
+  if (value.size() >= options_.large_value_size || LooksHighEntropy(value)) {
+    return occurrences >= options_.min_occurrences_for_large_value;
+  }
+  return true;
+}
+
+// static
+bool HpackAdaptiveIndexingPolicy::IsUniquePerMessageHeader(
+    absl::string_view name) {
+  // Names are lowercase in HTTP/2.
+  static constexpr absl::string_view kNames[] = {
+      "age",
+      "content-length",
+      "date",
+      "etag",
+      "expires",
+      "last-modified",
+      "request-id",
+      "traceparent",
+      "tracestate",
+      "x-amzn-trace-id",
+      "x-b3-spanid",
+      "x-b3-traceid",
+      "x-cloud-trace-context",
+      "x-correlation-id",
+      "x-request-id",
+  };
+  return std::find(std::begin(kNames), std::end(kNames), name) !=
+         std::end(kNames);
+}
+
+// static
+bool HpackAdaptiveIndexingPolicy::LooksHighEntropy(absl::string_view value) {
+  // Skip an authentication scheme or similar prefix, as in "Bearer <token>".
+  const size_t last_space = value.rfind(' ');
+  if (last_space != absl::string_view::npos) {
+    value.remove_prefix(last_space + 1);
+  }
+  // Shorter tokens cost little to send as literals.
+  constexpr size_t kMinTokenLength = 16;
+  if (value.size() < kMinTokenLength) {
+    return false;
+  }
+  size_t digits = 0;
+  size_t lowercase = 0;
+  size_t uppercase = 0;
+  for (char c : value) {
+    if (absl::ascii_isdigit(c)) {
+      ++digits;
+    } else if (absl::ascii_islower(c)) {
+      ++lowercase;
+    } else if (absl::ascii_isupper(c)) {
+      ++uppercase;
+    } else if (c != '-' && c != '_' && c != '+' && c != '/' && c != '=' &&
+               c != '.') {
+      // Other punctuation is typical of structured values, such as lists.
+      return false;
+    }
+  }
+  // Random tokens mix character classes evenly; words and paths mostly do
+  // not.  Count the classes that make up at least an eighth of the token.
+  const auto is_common = [&value](size_t count) {
+    return count * 8 >= value.size();
+  };
+  return is_common(digits) + is_common(lowercase) + is_common(uppercase) >= 2;
+}
+
+}  // namespace spdy
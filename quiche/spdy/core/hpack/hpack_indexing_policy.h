@@ -0,0 +1,109 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#ifndef QUICHE_SPDY_CORE_HPACK_HPACK_INDEXING_POLICY_H_
+#define QUICHE_SPDY_CORE_HPACK_HPACK_INDEXING_POLICY_H_
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#include "absl/strings/string_view.h"
+#include "quiche/common/platform/api/quiche_export.h"
+
+namespace spdy {
+
+// Decides which header fields an HpackEncoder inserts into the HPACK dynamic
+// table.  An instance belongs to a single encoder, and thus to a single
+// connection, so implementations may keep per-connection state.
+class QUICHE_EXPORT_PRIVATE HpackIndexingPolicyInterface {
+ public:
+  virtual ~HpackIndexingPolicyInterface() = default;
+
+  // Called for every header field that is not already present in the static
+  // or dynamic table.  |dynamic_table_capacity| is the current maximum size of
+  // the dynamic table.  Returns true if the field should be inserted.
+  virtual bool ShouldIndex(absl::string_view name, absl::string_view value,
+                           size_t dynamic_table_capacity) = 0;
+};
+
+// A count-min sketch estimating how often a header field has been seen, in a
+// fixed 1 kB of memory regardless of the number of distinct fields.  Counters
+// saturate at 255; Decay() halves them so that fields that stop appearing are
+// eventually forgotten.
+class QUICHE_EXPORT_PRIVATE HpackFrequencySketch {
+ public:
+  static constexpr size_t kDepth = 4;
+  static constexpr size_t kWidth = 256;
+
+  // Records one occurrence of the field with |hash|, and returns the estimated
+  // number of occurrences including this one.
+  uint32_t Increment(uint64_t hash);
+
+  // Returns the estimated number of occurrences of the field with |hash|.
+  uint32_t Estimate(uint64_t hash) const;
+
+  void Decay();
+
+ private:
+  static size_t Column(uint64_t hash, size_t row) {
+    return (hash >> (16 * row)) % kWidth;
+  }
+
+  std::array<std::array<uint8_t, kWidth>, kDepth> counters_ = {};
+};
+
+// An indexing policy tuned for long-lived connections carrying many requests,
+// such as those between a gateway and its upstreams.
+//
+// - Fields that are large relative to the dynamic table are never indexed,
+//   since inserting them would evict many smaller, useful entries.
+// - Fields whose values are unique per message, such as dates and request or
+//   trace identifiers, are never indexed.
+// - Large values (cookies, authorization tokens) and values that look like
+//   random tokens are indexed only once they have been seen repeatedly on the
+//   connection, at which point indexing them saves the most bytes.
+// - Everything else is indexed, as with the default policy.
+class QUICHE_EXPORT_PRIVATE HpackAdaptiveIndexingPolicy
+    : public HpackIndexingPolicyInterface {
+ public:
+  struct QUICHE_EXPORT_PRIVATE Options {
+    // Number of occurrences, including the current one, after which a large
+    // or high-entropy field is indexed.
+    uint32_t min_occurrences_for_large_value = 2;
+    // Values at least this long are considered large.
+    size_t large_value_size = 64;
+    // Fields whose HPACK entry size exceeds this fraction of the dynamic table
+    // capacity are never indexed.
+    double max_entry_fraction_of_table = 0.5;
+    // The frequency sketch is decayed after this many observations.
+    size_t decay_interval = 4096;
+  };
+
+  HpackAdaptiveIndexingPolicy() : HpackAdaptiveIndexingPolicy(Options()) {}
+  explicit HpackAdaptiveIndexingPolicy(const Options& options)
+      : options_(options) {}
+
+  bool ShouldIndex(absl::string_view name, absl::string_view value,
+                   size_t dynamic_table_capacity) override;
+
+  // Returns true if |name| identifies a header whose value is expected to
+  // change with every message.
+  static bool IsUniquePerMessageHeader(absl::string_view name);
+
+  // Returns true if |value| looks like a random token, for example a UUID, a
+  // hex digest or a base64 blob.
+  static bool LooksHighEntropy(absl::string_view value);
+
+  const HpackFrequencySketch& sketch() const { return sketch_; }
+
+ private:
+  const Options options_;
+  HpackFrequencySketch sketch_;
+  size_t observations_since_decay_ = 0;
+};
+
+}  // namespace spdy
+
+#endif  // QUICHE_SPDY_CORE_HPACK_HPACK_INDEXING_POLICY_H_
@@ -0,0 +1,117 @@
+// Copyright 2022 The Chromium Authors. All rights reserved.
+// Use of this source code is governed by a BSD-style license that can be
+// found in the LICENSE file.
+
+#include "quiche/spdy/core/hpack/hpack_indexing_policy.h"
+
+#include <string>
+
+#include "quiche/common/platform/api/quiche_test.h"
+
+namespace spdy {
+namespace test {
+namespace {
+
+constexpr size_t kTableCapacity = 4096;
+
+TEST(HpackFrequencySketchTest, CountsAndDecays) {
+  HpackFrequencySketch sketch;
+  EXPECT_EQ(0u, sketch.Estimate(42));
+  EXPECT_EQ(1u, sketch.Increment(42));
+  EXPECT_EQ(2u, sketch.Increment(42));
+  EXPECT_EQ(3u, sketch.Increment(42));
+  EXPECT_EQ(3u, sketch.Estimate(42));
+  EXPECT_EQ(0u, sketch.Estimate(0x123456789));
+
+  sketch.Decay();
+  EXPECT_EQ(1u, sketch.Estimate(42));
+  sketch.Decay();
+  EXPECT_EQ(0u, sketch.Estimate(42));
+}
+
+TEST(HpackFrequencySketchTest, Saturates) {
+  HpackFrequencySketch sketch;
+  for (int i = 0; i < 1000; ++i) {
+    sketch.Increment(7);
+  }
+  EXPECT_EQ(255u, sketch.Estimate(7));
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, PseudoHeaders) {
+  HpackAdaptiveIndexingPolicy policy;
+  EXPECT_TRUE(policy.ShouldIndex(":authority", "www.example.com",
+                                 kTableCapacity));
+  EXPECT_FALSE(policy.ShouldIndex(":path", "/index.html", kTableCapacity));
+  EXPECT_FALSE(policy.ShouldIndex("", "value", kTableCapacity));
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, UniquePerMessageHeaders) {
+  HpackAdaptiveIndexingPolicy policy;
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(policy.ShouldIndex("date", "Mon, 17 Oct 2022 10:00:00 GMT",
+                                    kTableCapacity));
+    EXPECT_FALSE(policy.ShouldIndex("x-request-id", "abc", kTableCapacity));
+  }
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, SmallValuesIndexedImmediately) {
+  HpackAdaptiveIndexingPolicy policy;
+  EXPECT_TRUE(policy.ShouldIndex("accept-encoding", "gzip, deflate",
+                                 kTableCapacity));
+  EXPECT_TRUE(policy.ShouldIndex("user-agent", "curl/7.85.0", kTableCapacity));
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, LargeValuesIndexedOnceRepeated) {
+  HpackAdaptiveIndexingPolicy policy;
+  const std::string cookie(200, 'c');
+  EXPECT_FALSE(policy.ShouldIndex("cookie", cookie, kTableCapacity));
+  EXPECT_TRUE(policy.ShouldIndex("cookie", cookie, kTableCapacity));
+
+  const std::string authorization = "Bearer a1b2c3d4e5f6g7h8i9";
+  EXPECT_FALSE(
+      policy.ShouldIndex("authorization", authorization, kTableCapacity));
+  EXPECT_TRUE(
+      policy.ShouldIndex("authorization", authorization, kTableCapacity));
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, EntriesTooLargeForTable) {
+  HpackAdaptiveIndexingPolicy policy;
+  const std::string value(1000, 'v');
+  for (int i = 0; i < 3; ++i) {
+    EXPECT_FALSE(policy.ShouldIndex("name", value, /*capacity=*/1024));
+  }
+  // Occurrences that were rejected for their size are not counted.
+  EXPECT_FALSE(policy.ShouldIndex("name", value, kTableCapacity));
+  EXPECT_TRUE(policy.ShouldIndex("name", value, kTableCapacity));
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, CustomOptions) {
+  HpackAdaptiveIndexingPolicy::Options options;
+  options.min_occurrences_for_large_value = 3;
+  options.large_value_size = 8;
+  HpackAdaptiveIndexingPolicy policy(options);
+  EXPECT_FALSE(policy.ShouldIndex("name", "long value", kTableCapacity));
+  EXPECT_FALSE(policy.ShouldIndex("name", "long value", kTableCapacity));
+  EXPECT_TRUE(policy.ShouldIndex("name", "long value", kTableCapacity));
+  EXPECT_TRUE(policy.ShouldIndex("name", "short", kTableCapacity));
+}
+
+TEST(HpackAdaptiveIndexingPolicyTest, LooksHighEntropy) {
+  EXPECT_TRUE(HpackAdaptiveIndexingPolicy::LooksHighEntropy(
+      "3f2504e0-4f89-11d3-9a0c-0305e82c3301"));
+  EXPECT_TRUE(HpackAdaptiveIndexingPolicy::LooksHighEntropy(
+      "dGhlIHF1aWNrIGJyb3duIGZveCAxMjM0NTY3ODk="));
+  EXPECT_TRUE(HpackAdaptiveIndexingPolicy::LooksHighEntropy(
+      "Basic dXNlcjpwYXNzd29yZDEyMzQ1Ng=="));
+  EXPECT_FALSE(HpackAdaptiveIndexingPolicy::LooksHighEntropy("a1b2c3"));
+  EXPECT_FALSE(
+      HpackAdaptiveIndexingPolicy::LooksHighEntropy("/images/logo-large.png"));
+  EXPECT_FALSE(HpackAdaptiveIndexingPolicy::LooksHighEntropy(
+      "Mon, 17 Oct 2022 10:00:00 GMT"));
+  EXPECT_FALSE(HpackAdaptiveIndexingPolicy::LooksHighEntropy(
+      "text/html,application/xhtml+xml"));
+}
+
+}  // namespace
+}  // namespace test
+}  // namespace spdy
@@ -423,6 +423,26 @@ void Http2DecoderAdapter::OnDataEnd() {
   opt_pad_length_.reset();
 }
 
+void Http2DecoderAdapter::OnDataFrame(const Http2FrameHeader& header,
+                                      const char* data, size_t len) {
+  QUICHE_DVLOG(1) << "OnDataFrame: " << header << "; len=" << len;
+  if (!IsOkToStartFrame(header) || !HasRequiredStreamId(header)) {
+    return;
+  }
+  frame_header_ = header;
+  has_frame_header_ = true;
+  visitor()->OnDataFrameHeader(header.stream_id, header.payload_length,
+                               header.IsEndStream());
+  // The visitor may stop processing from any of these calls, after which no
+  // further events are delivered.
+  if (len > 0 && !HasError()) {
+    visitor()->OnStreamFrameData(header.stream_id, data, len);
+  }
+  if (header.IsEndStream() && !HasError()) {
+    visitor()->OnStreamEnd(header.stream_id);
+  }
+}
+
 void Http2DecoderAdapter::OnHeadersStart(const Http2FrameHeader& header) {
   QUICHE_DVLOG(1) << "OnHeadersStart: " << header;
   if (IsOkToStartFrame(header) && HasRequiredStreamId(header)) {
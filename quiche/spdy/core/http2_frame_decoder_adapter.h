@@ -171,6 +171,8 @@ class QUICHE_EXPORT_PRIVATE Http2DecoderAdapter
   void OnDataStart(const Http2FrameHeader& header) override;
   void OnDataPayload(const char* data, size_t len) override;
   void OnDataEnd() override;
+  void OnDataFrame(const Http2FrameHeader& header, const char* data,
+                   size_t len) override;
   void OnHeadersStart(const Http2FrameHeader& header) override;
   void OnHeadersPriority(const Http2PriorityFields& priority) override;
   void OnHpackFragment(const char* data, size_t len) override;